@@ -23,7 +23,7 @@
 using namespace std;
 using namespace caret;
 
-AbstractAlgorithm::AbstractAlgorithm(ProgressObject* myProgressObject)
+AbstractAlgorithm::AbstractAlgorithm(ProgressObject* myProgressObject) : m_traceSpan("algorithm", "algorithm")
 {
     m_progObj = myProgressObject;
     m_finish = true;
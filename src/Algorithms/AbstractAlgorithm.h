@@ -26,6 +26,7 @@
 #include "CaretAssert.h"
 #include "OperationParameters.h"
 #include "AbstractOperation.h"
+#include "CaretTrace.h"
 
 namespace caret {
 
@@ -34,6 +35,7 @@ namespace caret {
     {
         ProgressObject* m_progObj;//so that the destructor can make sure the bar finishes
         bool m_finish;
+        CaretTraceSpan m_traceSpan;//the base class can't know the algorithm's name, the command's span (see TemplateAutoOperation) names the outermost one
         AbstractAlgorithm();//prevent default construction
     protected:
         ///override this with the weights of the algorithms this algorithm will call
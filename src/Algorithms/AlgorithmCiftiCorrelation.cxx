@@ -34,10 +34,24 @@
 #include <fstream>
 #include <utility>
 #include <algorithm>
+#include <cmath>
 
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    const double FISHER_Z_MAX_R = 0.999999;//prevent inf
+    
+    void setExpectedRange(CiftiFile* myCiftiOut, const bool& fisherZ, const bool& covariance)
+    {//correlation has a known range, so compact output types can be scaled before any rows are computed
+        if (covariance) return;
+        double maxVal = 1.0;
+        if (fisherZ) maxVal = 0.5 * log((1 + FISHER_Z_MAX_R) / (1 - FISHER_Z_MAX_R));
+        myCiftiOut->setWritingExpectedRange(-maxVal, maxVal);
+    }
+}
+
 AString AlgorithmCiftiCorrelation::getCommandSwitch()
 {
     return "-cifti-correlation";
@@ -199,6 +213,7 @@ AlgorithmCiftiCorrelation::AlgorithmCiftiCorrelation(ProgressObject* myProgObj,
     int numRows = myCifti->getNumberOfRows();
     CiftiXMLOld newXML = myCifti->getCiftiXMLOld();
     newXML.applyColumnMapToRows();
+    setExpectedRange(myCiftiOut, fisherZ, covariance);
     myCiftiOut->setCiftiXML(newXML);
     int numCacheRows;
     bool cacheFullInput = true;
@@ -216,6 +231,7 @@ AlgorithmCiftiCorrelation::AlgorithmCiftiCorrelation(ProgressObject* myProgObj,
         CaretLogInfo("computing " + AString::number(numCacheRows) + " rows at a time, reading rows as needed during processing");
     }
     vector<CaretArray<float> > outRows;
+    allocateCache(cacheFullInput ? numRows : numCacheRows);
     if (cacheFullInput)
     {
         for (int i = 0; i < numRows; ++i)
@@ -384,6 +400,7 @@ AlgorithmCiftiCorrelation::AlgorithmCiftiCorrelation(ProgressObject* myProgObj,
             }
         }
     }
+    setExpectedRange(myCiftiOut, fisherZ, covariance);
     myCiftiOut->setCiftiXML(newXML);
     int numSelected = (int)ciftiIndexList.size(), numRows = myCifti->getNumberOfRows();
     int numCacheRows;
@@ -402,6 +419,7 @@ AlgorithmCiftiCorrelation::AlgorithmCiftiCorrelation(ProgressObject* myProgObj,
         CaretLogInfo("computing " + AString::number(numCacheRows) + " rows at a time, reading rows as needed during processing");
     }
     vector<CaretArray<float> > outRows;
+    allocateCache(cacheFullInput ? numRows : numCacheRows);
     if (cacheFullInput)
     {
         for (int i = 0; i < numRows; ++i)
@@ -553,8 +571,8 @@ float AlgorithmCiftiCorrelation::correlate(const float* row1, const float& rrs1,
     {
         if (fisherZ)
         {
-            if (r > 0.999999) r = 0.999999;//prevent inf
-            if (r < -0.999999) r = -0.999999;//prevent -inf
+            if (r > FISHER_Z_MAX_R) r = FISHER_Z_MAX_R;//prevent inf
+            if (r < -FISHER_Z_MAX_R) r = -FISHER_Z_MAX_R;//prevent -inf
             r = 0.5 * log((1 + r) / (1 - r));
         } else {
             if (r > 1.0) r = 1.0;//don't output anything silly
@@ -607,6 +625,18 @@ void AlgorithmCiftiCorrelation::init(const CiftiFile* input, const vector<float>
     }
 }
 
+void AlgorithmCiftiCorrelation::allocateCache(const int& numRows)
+{//every thread reads the whole cache, so allocate rows from all threads to spread it across NUMA nodes, instead of leaving it all on the first one
+    const int oldSize = (int)m_rowCache.size();
+    if (numRows <= oldSize) return;
+    m_rowCache.resize(numRows);
+#pragma omp CARET_PARFOR schedule(static)
+    for (int i = oldSize; i < numRows; ++i)
+    {
+        m_rowCache[i].m_row.resize(m_numCols);
+    }
+}
+
 void AlgorithmCiftiCorrelation::cacheRow(const int& ciftiIndex)
 {
     CaretAssertVectorIndex(m_rowInfo, ciftiIndex);
@@ -55,6 +55,7 @@ namespace caret {
         int m_cacheUsed;//reuse cache entries instead of reallocating them
         int m_numCols;
         const CiftiFile* m_inputCifti;//so that accesses work through the cache functions
+        void allocateCache(const int& numRows);
         void cacheRow(const int& ciftiIndex);
         void computeRowStats(const float* row, float& mean, float& rootResidSqr);
         void doSubtract(float* row, const float& mean);
@@ -21,6 +21,7 @@
 #include "AlgorithmCiftiCorrelationGradient.h"
 #include "AlgorithmException.h"
 #include "AlgorithmMetricGradient.h"
+#include "MetricGradientObject.h"
 #include "MetricSmoothingObject.h"
 #include "AlgorithmVolumeGradient.h"
 #include "CaretLogger.h"
@@ -505,6 +506,8 @@ void AlgorithmCiftiCorrelationGradient::processSurfaceComponent(StructureEnum::E
     {
         mySmooth.grabNew(new MetricSmoothingObject(mySurf, surfKern, &myRoi, MetricSmoothingObject::GEO_GAUSS_AREA, areaData));//computes the smoothing weights only once per surface
     }
+    MetricGradientObject myGradient(mySurf, myRoi.getValuePointerForColumn(0), false, areaData);//solves the gradient regressions only once per surface
+    vector<float> gradScratch(mySurf->getNumberOfNodes());
     for (int startpos = 0; startpos < mapSize; startpos += numCacheRows)
     {
         int endpos = startpos + numCacheRows;
@@ -565,19 +568,19 @@ void AlgorithmCiftiCorrelationGradient::processSurfaceComponent(StructureEnum::E
             }
         }
         int numMetricCols = endpos - startpos;
-        MetricFile outputMetric, outputMetric2;
+        MetricFile outputMetric;
         for (int j = 0; j < numMetricCols; ++j)
         {
-            const float* myCol;
+            const float* inCol;
             if (surfKern > 0.0f)
             {
                 mySmooth->smoothColumn(&computeMetric, j, &outputMetric);
-                AlgorithmMetricGradient(NULL, mySurf, &outputMetric, &outputMetric2, NULL, -1.0f, &myRoi, false, -1, myAreas);
-                myCol = outputMetric2.getValuePointerForColumn(0);
+                inCol = outputMetric.getValuePointerForColumn(0);
             } else {
-                AlgorithmMetricGradient(NULL, mySurf, &computeMetric, &outputMetric, NULL, -1.0f, &myRoi, false, j, myAreas);
-                myCol = outputMetric.getValuePointerForColumn(0);
+                inCol = computeMetric.getValuePointerForColumn(j);
             }
+            myGradient.gradientColumn(inCol, gradScratch.data());
+            const float* myCol = gradScratch.data();
             for (int i = 0; i < mapSize; ++i)
             {
                 const float* roiColumn = myRoi.getValuePointerForColumn(0);
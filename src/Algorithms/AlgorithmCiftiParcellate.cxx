@@ -21,6 +21,7 @@
 #include "AlgorithmCiftiParcellate.h"
 #include "AlgorithmException.h"
 #include "CaretLogger.h"
+#include "CaretOMP.h"
 #include "CiftiFile.h"
 #include "GiftiLabel.h"
 #include "GiftiLabelTable.h"
@@ -29,6 +30,7 @@
 #include "ReductionOperation.h"
 #include "SurfaceFile.h"
 
+#include <algorithm>
 #include <cmath>
 #include <map>
 
@@ -238,269 +240,301 @@ void AlgorithmCiftiParcellate::useParameters(OperationParameters* myParams, Prog
                              legacyMode, emptyFillValue, emptyMaskOut);
 }
 
-AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, const CiftiFile* myCiftiIn, const CiftiFile* myCiftiLabel, const int& direction, CiftiFile* myCiftiOut,
-                                                   const ReductionEnum::Enum& method, const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric,
-                                                   const bool& legacyMode, const float& emptyFillVal, CiftiFile* emptyMaskOut) : AbstractAlgorithm(myProgObj)
+namespace
 {
-    LevelProgress myProgress(myProgObj);
-    CaretAssert(direction >= 0);
-    const CiftiXML& myInputXML = myCiftiIn->getCiftiXML();
-    const CiftiXML& myLabelXML = myCiftiLabel->getCiftiXML();
-    vector<int64_t> dims = myInputXML.getDimensions();
-    if (direction >= (int)dims.size()) throw AlgorithmException("specified direction doesn't exist in input file");
-    if (myInputXML.getMappingType(direction) != CiftiMappingType::BRAIN_MODELS)
-    {
-        throw AlgorithmException("input cifti file does not have brain models mapping type in specified direction");
-    }
-    if (myLabelXML.getNumberOfDimensions() != 2 ||
-        myLabelXML.getMappingType(CiftiXML::ALONG_ROW) != CiftiMappingType::LABELS ||
-        myLabelXML.getMappingType(CiftiXML::ALONG_COLUMN) != CiftiMappingType::BRAIN_MODELS)
-    {
-        throw AlgorithmException("input cifti label file has the wrong mapping types");
-    }
-    const CiftiBrainModelsMap& inputDense = myInputXML.getBrainModelsMap(direction);
-    const CiftiBrainModelsMap& labelDense = myLabelXML.getBrainModelsMap(CiftiXML::ALONG_COLUMN);
-    if (inputDense.hasVolumeData())
-    {//don't check volume space if direction doesn't have volume data
-        if (labelDense.hasVolumeData() && !inputDense.getVolumeSpace().matches(labelDense.getVolumeSpace()))
-        {
-            throw AlgorithmException("input cifti files must have the same volume space");
-        }
-    }
-    vector<int> indexToParcel;
-    CiftiXML myOutXML = myInputXML;
-    CiftiParcelsMap outParcelMap = parcellateMapping(myCiftiLabel, inputDense, indexToParcel, legacyMode);
-    int numParcels = outParcelMap.getLength();
-    if (numParcels < 1)
-    {
-        throw AlgorithmException("no parcels found, output file would be empty, aborting");
-    }
-    myOutXML.setMap(direction, outParcelMap);
-    myCiftiOut->setCiftiXML(myOutXML);
-    int64_t numCols = myInputXML.getDimensionLength(CiftiXML::ALONG_ROW);
-    vector<float> scratchRow(numCols);
-    vector<int64_t> parcelCounts(numParcels, 0);
-    for (int64_t j = 0; j < (int64_t)indexToParcel.size(); ++j)
+    ///parcel membership in compressed sparse row form, built once per parcellation: the indices along the parcellated dimension
+    ///that belong to parcel p are m_members[m_start[p]] through m_members[m_start[p + 1] - 1], in increasing order, which is the order their values are reduced in
+    struct ParcelIndexCSR
     {
-        int parcel = indexToParcel[j];
-        CaretAssert(parcel > -2 && parcel < numParcels);
-        if (parcel != -1)
-        {
-            ++parcelCounts[parcel];
-        }
-    }
-    if (emptyMaskOut != NULL)
-    {
-        CiftiXML maskOutXML;
-        maskOutXML.setNumberOfDimensions(2);
-        maskOutXML.setMap(CiftiXML::ALONG_COLUMN, outParcelMap);
-        CiftiScalarsMap maskNameMap;
-        maskNameMap.setLength(1);
-        maskNameMap.setMapName(0, "parcel not empty");
-        maskOutXML.setMap(CiftiXML::ALONG_ROW, maskNameMap);
-        emptyMaskOut->setCiftiXML(maskOutXML);
-        vector<float> emptyMaskData(numParcels, 1.0f);
-        for (int i = 0; i < numParcels; ++i)
+        vector<int64_t> m_start, m_members;
+        vector<int64_t> m_position;//inverse of m_members, -1 for indices that are not in a parcel
+        vector<float> m_weights;//same layout as m_members, empty when unweighted
+        vector<double> m_weightSums;//per parcel, summed in the same order as ReductionOperation does
+        
+        ParcelIndexCSR(const vector<int>& indexToParcel, const int& numParcels, const vector<vector<float> >* parcelWeights)
         {
-            if (parcelCounts[i] == 0)
+            m_start.resize(numParcels + 1, 0);
+            for (int64_t i = 0; i < (int64_t)indexToParcel.size(); ++i)
+            {
+                int parcel = indexToParcel[i];
+                CaretAssert(parcel > -2 && parcel < numParcels);
+                if (parcel != -1)
+                {
+                    ++m_start[parcel + 1];
+                }
+            }
+            for (int p = 0; p < numParcels; ++p)
+            {
+                m_start[p + 1] += m_start[p];
+            }
+            m_members.resize(m_start[numParcels]);
+            m_position.resize(indexToParcel.size(), -1);
+            vector<int64_t> next(m_start.begin(), m_start.end() - 1);
+            for (int64_t i = 0; i < (int64_t)indexToParcel.size(); ++i)
+            {
+                int parcel = indexToParcel[i];
+                if (parcel != -1)
+                {
+                    m_position[i] = next[parcel];
+                    m_members[next[parcel]] = i;
+                    ++next[parcel];
+                }
+            }
+            if (parcelWeights != NULL)
             {
-                emptyMaskData[i] = 0.0f;
+                CaretAssert((int)parcelWeights->size() == numParcels);
+                m_weights.resize(m_members.size());
+                m_weightSums.resize(numParcels, 0.0);
+                for (int p = 0; p < numParcels; ++p)
+                {
+                    const vector<float>& thisWeights = (*parcelWeights)[p];
+                    CaretAssert((int64_t)thisWeights.size() == count(p));
+                    for (int64_t k = 0; k < (int64_t)thisWeights.size(); ++k)
+                    {
+                        m_weights[m_start[p] + k] = thisWeights[k];
+                        m_weightSums[p] += thisWeights[k];
+                    }
+                }
             }
         }
-        emptyMaskOut->setColumn(emptyMaskData.data(), 0);
-    }
-    bool isLabel = false;
-    int labelDir = -1;
-    for (int i = 0; i < (int)dims.size(); ++i)
-    {
-        if (myInputXML.getMappingType(i) == CiftiMappingType::LABELS)
+        
+        int getNumberOfParcels() const { return (int)m_start.size() - 1; }
+        
+        int64_t count(const int& parcel) const { return m_start[parcel + 1] - m_start[parcel]; }
+        
+        const float* weights(const int& parcel) const
         {
-            isLabel = true;
-            labelDir = i;
-            break;//there should never be more than one dimension with LABEL type, and if there is, just use the first one, i guess...
+            if (m_weights.empty()) return NULL;
+            return m_weights.data() + m_start[parcel];
         }
-    }
-    if (isLabel && method != ReductionEnum::MODE)
-    {
-        CaretLogWarning(ReductionEnum::toName(method) + " reduction requested while parcellating label data");
-    }
-    if (direction == CiftiXML::ALONG_ROW)
+    };
+    
+    ///applies the requested reduction to parcels, multithreaded with one ReductionOperation::Scratch per thread
+    class ParcelReducer
     {
-        vector<float> scratchOutRow(numParcels);
-        vector<vector<float> > parcelData(numParcels);//float so we can use ReductionOperation
-        for (int j = 0; j < numParcels; ++j)
-        {
-            parcelData[j].reserve(parcelCounts[j]);
-        }
-        for (MultiDimIterator<int64_t> iter(vector<int64_t>(dims.begin() + 1, dims.end())); !iter.atEnd(); ++iter)
+        const ParcelIndexCSR& m_csr;
+        ReductionEnum::Enum m_method;
+        float m_excludeLow, m_excludeHigh;
+        bool m_onlyNumeric, m_isLabel;
+        
+        float reduce(const float* values, const float* weights, const int64_t& count, ReductionOperation::Scratch& scratch) const
         {
-            for (int j = 0; j < numParcels; ++j)
+            if (m_excludeLow > 0.0f && m_excludeHigh > 0.0f)
             {
-                parcelData[j].clear();//doesn't change allocation
+                if (weights != NULL)
+                {
+                    return ReductionOperation::reduceWeightedExcludeDev(values, weights, count, m_method, m_excludeLow, m_excludeHigh);
+                }
+                return ReductionOperation::reduceExcludeDev(values, count, m_method, m_excludeLow, m_excludeHigh);
             }
-            myCiftiIn->getRow(scratchRow.data(), *iter);
-            for (int64_t j = 0; j < numCols; ++j)
+            if (m_onlyNumeric)
             {
-                int parcel = indexToParcel[j];
-                if (parcel != -1)
+                if (weights != NULL)
                 {
-                    if (isLabel)
-                    {
-                        parcelData[parcel].push_back(floor(scratchRow[j] + 0.5f));//round to nearest integer to be safe
-                    } else {
-                        parcelData[parcel].push_back(scratchRow[j]);
-                    }
+                    return ReductionOperation::reduceWeightedOnlyNumeric(values, weights, count, m_method, scratch);
                 }
+                return ReductionOperation::reduceOnlyNumeric(values, count, m_method, scratch);
+            }
+            if (weights != NULL)
+            {
+                return ReductionOperation::reduceWeighted(values, weights, count, m_method, scratch);
             }
-            for (int j = 0; j < numParcels; ++j)
+            return ReductionOperation::reduce(values, count, m_method, scratch);
+        }
+        
+        ///turn a sum from accumulate() into the output value, the same way ReductionOperation does
+        float finishAccumulation(const double& accum, const int& parcel) const
+        {
+            if (m_method == ReductionEnum::SUM) return accum;
+            if (m_csr.m_weights.empty()) return accum / m_csr.count(parcel);
+            return accum / m_csr.m_weightSums[parcel];
+        }
+    public:
+        ParcelReducer(const ParcelIndexCSR& csr, const ReductionEnum::Enum& method, const float& excludeLow, const float& excludeHigh,
+                      const bool& onlyNumeric, const bool& isLabel) : m_csr(csr)
+        {
+            m_method = method;
+            m_excludeLow = excludeLow;
+            m_excludeHigh = excludeHigh;
+            m_onlyNumeric = onlyNumeric;
+            m_isLabel = isLabel;
+        }
+        
+        ///whether the parcel has enough elements for the method, parcels that don't get the fill value
+        bool canReduce(const int& parcel) const
+        {
+            int64_t count = m_csr.count(parcel);
+            return count > 0 && (m_method != ReductionEnum::SAMPSTDEV || count > 1);
+        }
+        
+        ///sum and mean don't need the values of a parcel gathered together, so they can be accumulated a row at a time
+        bool isAccumulable() const
+        {
+            return (m_method == ReductionEnum::MEAN || m_method == ReductionEnum::SUM) &&
+                   !(m_excludeLow > 0.0f && m_excludeHigh > 0.0f) && !m_onlyNumeric;
+        }
+        
+        float prepare(const float& value) const
+        {
+            if (m_isLabel) return floor(value + 0.5f);//round to nearest integer to be safe
+            return value;
+        }
+        
+        ///parcellating along row: reduce each of numRows rows into numParcels values, parcels that can't be reduced are not written
+        void reduceRows(const float* rows, const int64_t& numRows, const int64_t& rowLength, float* outRows) const
+        {
+            const int numParcels = m_csr.getNumberOfParcels();
+            const int64_t numJobs = numRows * numParcels;
+            const bool accumulate = isAccumulable();
+            bool failed = false;
+            CaretException failure;
+#pragma omp CARET_PAR
             {
-                CaretAssert(parcelCounts[j] == (int64_t)parcelData[j].size());
-                if (parcelCounts[j] > 0 && (method != ReductionEnum::SAMPSTDEV || parcelCounts[j] > 1))
+                ReductionOperation::Scratch scratch;
+                vector<float> values;
+#pragma omp CARET_FOR schedule(dynamic, 16)
+                for (int64_t job = 0; job < numJobs; ++job)
                 {
-                    if (excludeLow > 0.0f && excludeHigh > 0.0f)
+                    const int64_t row = job / numParcels;
+                    const int parcel = job % numParcels;
+                    if (!canReduce(parcel)) continue;
+                    const float* rowData = rows + row * rowLength;
+                    const int64_t* members = m_csr.m_members.data() + m_csr.m_start[parcel];
+                    const int64_t count = m_csr.count(parcel);
+                    const float* weights = m_csr.weights(parcel);
+                    if (accumulate)
                     {
-                        scratchOutRow[j] = ReductionOperation::reduceExcludeDev(parcelData[j].data(), parcelData[j].size(), method, excludeLow, excludeHigh);
-                    } else {
-                        if (onlyNumeric)
+                        double accum = 0.0;
+                        if (weights != NULL)
                         {
-                            scratchOutRow[j] = ReductionOperation::reduceOnlyNumeric(parcelData[j].data(), parcelData[j].size(), method);
+                            for (int64_t k = 0; k < count; ++k)
+                            {
+                                accum += prepare(rowData[members[k]]) * weights[k];
+                            }
                         } else {
-                            scratchOutRow[j] = ReductionOperation::reduce(parcelData[j].data(), parcelData[j].size(), method);
+                            for (int64_t k = 0; k < count; ++k)
+                            {
+                                accum += prepare(rowData[members[k]]);
+                            }
                         }
+                        outRows[job] = finishAccumulation(accum, parcel);
+                        continue;
                     }
-                } else {//labelDir can't be 0 (row) because we are parcellating along row, so row must be dense
-                    if (isLabel)
+                    values.resize(count);
+                    for (int64_t k = 0; k < count; ++k)
                     {
-                        scratchOutRow[j] = myOutXML.getLabelsMap(labelDir).getMapLabelTable((*iter)[labelDir - 1])->getUnassignedLabelKey();
-                    } else {
-                        scratchOutRow[j] = emptyFillVal;//odd corner case, but probably fine: with nonzero empty fill value and SAMPSTDEV, parcels with only one element get the fill value, but aren't technically empty
+                        values[k] = prepare(rowData[members[k]]);
+                    }
+                    try
+                    {
+                        outRows[job] = reduce(values.data(), weights, count, scratch);
+                    } catch (CaretException& e) {//can't throw out of an openmp region
+#pragma omp critical
+                        {
+                            if (!failed)
+                            {
+                                failed = true;
+                                failure = e;
+                            }
+                        }
                     }
                 }
             }
-            myCiftiOut->setRow(scratchOutRow.data(), *iter);
-        }
-    } else {
-        vector<float> scratchOutRow(numCols);
-        vector<int64_t> otherDims = dims;
-        otherDims.erase(otherDims.begin() + direction);//direction being parcellated
-        otherDims.erase(otherDims.begin());//row
-        vector<vector<vector<float> > > parcelData(numParcels, vector<vector<float> >(numCols));//float so we can use ReductionOperation
-        for (int i = 0; i < numParcels; ++i)
-        {
-            for (int j = 0; j < numCols; ++j)
-            {
-                parcelData[i][j].reserve(parcelCounts[i]);
-            }
+            if (failed) throw AlgorithmException(failure);
         }
-        for (MultiDimIterator<int64_t> iter(otherDims); !iter.atEnd(); ++iter)
+        
+        ///parcellating along another dimension: add one (member) row into the per-parcel sums, numCols each, for accumulable methods
+        void accumulate(const float* row, const int64_t& numCols, const int64_t& parcellatedIndex, double* accumOut) const
         {
-            vector<int64_t> indices(dims.size() - 1);//we need to add the parcellated direction index back into the index list to use it in getRow/setRow
-            for (int i = 0; i < (int)otherDims.size(); ++i)
+            const int64_t position = m_csr.m_position[parcellatedIndex];
+            CaretAssert(position >= 0);
+            const int parcel = upper_bound(m_csr.m_start.begin(), m_csr.m_start.end(), position) - m_csr.m_start.begin() - 1;
+            double* parcelAccum = accumOut + parcel * numCols;
+            if (m_csr.m_weights.empty())
             {
-                if (i < direction - 1)
+                for (int64_t j = 0; j < numCols; ++j)
                 {
-                    indices[i] = (*iter)[i];
-                } else {
-                    indices[i + 1] = (*iter)[i];
+                    parcelAccum[j] += prepare(row[j]);
                 }
-            }//indices[direction - 1] is uninitialized, as it is the dimension to be parcellated
-            for (int i = 0; i < numParcels; ++i)
-            {
-                for (int j = 0; j < numCols; ++j)
+            } else {
+                const float weight = m_csr.m_weights[position];
+                for (int64_t j = 0; j < numCols; ++j)
                 {
-                    parcelData[i][j].clear();//doesn't change allocation
+                    parcelAccum[j] += prepare(row[j]) * weight;
                 }
             }
-            for (int64_t i = 0; i < dims[direction]; ++i)
+        }
+        
+        ///parcellating along another dimension: turn the sums from accumulate() into numCols output values per parcel
+        void finishAccumulation(const double* accum, const int64_t& numCols, float* outRows) const
+        {
+            const int numParcels = m_csr.getNumberOfParcels();
+#pragma omp CARET_PARFOR schedule(dynamic)
+            for (int parcel = 0; parcel < numParcels; ++parcel)
             {
-                int parcel = indexToParcel[i];
-                if (parcel != -1)
+                if (!canReduce(parcel)) continue;
+                for (int64_t j = 0; j < numCols; ++j)
                 {
-                    indices[direction - 1] = i;
-                    myCiftiIn->getRow(scratchRow.data(), indices);
-                    vector<vector<float> >& parcelRef = parcelData[parcel];
-                    for (int j = 0; j < numCols; ++j)
-                    {
-                        if (isLabel)
-                        {
-                            parcelRef[j].push_back(floor(scratchRow[j] + 0.5f));
-                        } else {
-                            parcelRef[j].push_back(scratchRow[j]);
-                        }
-                    }
+                    outRows[parcel * numCols + j] = finishAccumulation(accum[parcel * numCols + j], parcel);
                 }
             }
-            for (int i = 0; i < numParcels; ++i)
+        }
+        
+        ///parcellating along another dimension: memberRows has the rows of all parcel members in the order of the CSR, numCols each,
+        ///reduce into numCols values per parcel, parcels that can't be reduced are not written
+        void reduceColumns(const float* memberRows, const int64_t& numCols, float* outRows) const
+        {
+            const int numParcels = m_csr.getNumberOfParcels();
+            const int64_t numJobs = numParcels * numCols;
+            bool failed = false;
+            CaretException failure;
+#pragma omp CARET_PAR
             {
-                indices[direction - 1] = i;
-                int64_t count = parcelCounts[i];
-                vector<vector<float> >& parcelRef = parcelData[i];
-                if (count > 0 && (method != ReductionEnum::SAMPSTDEV || count > 1))
+                ReductionOperation::Scratch scratch;
+                vector<float> values;
+#pragma omp CARET_FOR schedule(dynamic, 64)
+                for (int64_t job = 0; job < numJobs; ++job)
                 {
-                    for (int j = 0; j < numCols; ++j)
+                    const int parcel = job / numCols;
+                    const int64_t col = job % numCols;
+                    if (!canReduce(parcel)) continue;
+                    const int64_t count = m_csr.count(parcel);
+                    const float* parcelStart = memberRows + m_csr.m_start[parcel] * numCols + col;
+                    values.resize(count);
+                    for (int64_t k = 0; k < count; ++k)
                     {
-                        CaretAssert((int64_t)parcelRef[j].size() == count);
-                        if (excludeLow > 0.0f && excludeHigh > 0.0f)
-                        {
-                            scratchOutRow[j] = ReductionOperation::reduceExcludeDev(parcelRef[j].data(), parcelRef[j].size(), method, excludeLow, excludeHigh);
-                        } else {
-                            if (onlyNumeric)
-                            {
-                                scratchOutRow[j] = ReductionOperation::reduceOnlyNumeric(parcelRef[j].data(), parcelRef[j].size(), method);
-                            } else {
-                                scratchOutRow[j] = ReductionOperation::reduce(parcelRef[j].data(), parcelRef[j].size(), method);
-                            }
-                        }
+                        values[k] = parcelStart[k * numCols];
                     }
-                } else {
-                    for (int j = 0; j < numCols; ++j)
+                    try
                     {
-                        CaretAssert((int64_t)parcelRef[j].size() == count);
-                        if (isLabel)
+                        outRows[job] = reduce(values.data(), m_csr.weights(parcel), count, scratch);
+                    } catch (CaretException& e) {//can't throw out of an openmp region
+#pragma omp critical
                         {
-                            if (labelDir == CiftiXML::ALONG_ROW)
+                            if (!failed)
                             {
-                                scratchOutRow[j] = myOutXML.getLabelsMap(CiftiXML::ALONG_ROW).getMapLabelTable(j)->getUnassignedLabelKey();
-                            } else {
-                                scratchOutRow[j] = myOutXML.getLabelsMap(labelDir).getMapLabelTable(indices[labelDir - 1])->getUnassignedLabelKey();
+                                failed = true;
+                                failure = e;
                             }
-                        } else {
-                            scratchOutRow[j] = emptyFillVal;
                         }
                     }
                 }
-                myCiftiOut->setRow(scratchOutRow.data(), indices);
             }
+            if (failed) throw AlgorithmException(failure);
         }
-    }
-}
-
-namespace
-{
-    void doWeightedParcellation(const CiftiFile* myCiftiIn, const int& direction, CiftiFile* myCiftiOut, const vector<int>& indexToParcel,
-                                const vector<vector<float> >& parcelWeights, const ReductionEnum::Enum& method, const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric,
-                                const float& emptyFillVal, CiftiFile* emptyMaskOut)
+    };
+    
+    ///parcellateMapping and the weights (if any) are done, the output XML is set, now do the data
+    void doParcellation(const CiftiFile* myCiftiIn, const int& direction, CiftiFile* myCiftiOut, const vector<int>& indexToParcel,
+                        const vector<vector<float> >* parcelWeights, const ReductionEnum::Enum& method, const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric,
+                        const float& emptyFillVal, CiftiFile* emptyMaskOut)
     {
         const CiftiXML& myInputXML = myCiftiIn->getCiftiXML();
         const CiftiXML& myOutXML = myCiftiOut->getCiftiXML();
         vector<int64_t> dims = myInputXML.getDimensions();
         CaretAssert(direction < (int)dims.size());
-        bool isLabel = false;
-        int labelDir = -1;
-        for (int i = 0; i < (int)dims.size(); ++i)
-        {
-            if (myInputXML.getMappingType(i) == CiftiMappingType::LABELS)
-            {
-                isLabel = true;
-                labelDir = i;
-                break;//there should never be more than one dimension with LABEL type, and if there is, just use the first one, i guess...
-            }
-        }
-        if (isLabel && method != ReductionEnum::MODE)
-        {
-            CaretLogWarning(ReductionEnum::toName(method) + " reduction requested while parcellating label data");
-        }
         int numParcels = myOutXML.getDimensionLength(direction);
+        const ParcelIndexCSR parcelCSR(indexToParcel, numParcels, parcelWeights);
         if (emptyMaskOut != NULL)
         {
             CiftiXML maskOutXML;
@@ -514,83 +548,78 @@ namespace
             vector<float> emptyMaskData(numParcels, 1.0f);
             for (int i = 0; i < numParcels; ++i)
             {
-                if (parcelWeights[i].size() == 0)
+                if (parcelCSR.count(i) == 0)
                 {
                     emptyMaskData[i] = 0.0f;
                 }
             }
             emptyMaskOut->setColumn(emptyMaskData.data(), 0);
         }
-        int64_t numCols = myInputXML.getDimensionLength(CiftiXML::ALONG_ROW);
-        vector<float> scratchRow(numCols);
-        if (direction == CiftiXML::ALONG_ROW)
+        bool isLabel = false;
+        int labelDir = -1;
+        for (int i = 0; i < (int)dims.size(); ++i)
         {
-            vector<float> scratchOutRow(numParcels);
-            vector<vector<float> > parcelData(numParcels);//float so we can use ReductionOperation
-            for (int j = 0; j < numParcels; ++j)
+            if (myInputXML.getMappingType(i) == CiftiMappingType::LABELS)
             {
-                parcelData[j].reserve(parcelWeights[j].size());
+                isLabel = true;
+                labelDir = i;
+                break;//there should never be more than one dimension with LABEL type, and if there is, just use the first one, i guess...
             }
-            for (MultiDimIterator<int64_t> iter(vector<int64_t>(dims.begin() + 1, dims.end())); !iter.atEnd(); ++iter)
+        }
+        if (isLabel && method != ReductionEnum::MODE)
+        {
+            CaretLogWarning(ReductionEnum::toName(method) + " reduction requested while parcellating label data");
+        }
+        const ParcelReducer reducer(parcelCSR, method, excludeLow, excludeHigh, onlyNumeric, isLabel);
+        int64_t numCols = myInputXML.getDimensionLength(CiftiXML::ALONG_ROW);
+        if (direction == CiftiXML::ALONG_ROW)
+        {//read a block of rows, reduce all of their parcels in parallel, then write them
+            const int64_t rowsPerBlock = max<int64_t>(1, (1 << 22) / numCols);
+            vector<float> blockRows(rowsPerBlock * numCols), blockOut(rowsPerBlock * numParcels);
+            vector<vector<int64_t> > blockIndices;
+            MultiDimIterator<int64_t> iter(vector<int64_t>(dims.begin() + 1, dims.end()));
+            while (!iter.atEnd())
             {
-                for (int j = 0; j < numParcels; ++j)
-                {
-                    parcelData[j].clear();//doesn't change allocation
-                }
-                myCiftiIn->getRow(scratchRow.data(), *iter);
-                for (int64_t j = 0; j < numCols; ++j)
+                blockIndices.clear();
+                for (; !iter.atEnd() && (int64_t)blockIndices.size() < rowsPerBlock; ++iter)
                 {
-                    int parcel = indexToParcel[j];
-                    if (parcel != -1)
-                    {
-                        if (isLabel)
-                        {
-                            parcelData[parcel].push_back(floor(scratchRow[j] + 0.5f));//round to nearest integer to be safe
-                        } else {
-                            parcelData[parcel].push_back(scratchRow[j]);
-                        }
-                    }
+                    myCiftiIn->getRow(blockRows.data() + blockIndices.size() * numCols, *iter);
+                    blockIndices.push_back(*iter);
                 }
-                for (int j = 0; j < numParcels; ++j)
+                reducer.reduceRows(blockRows.data(), blockIndices.size(), numCols, blockOut.data());
+                for (int64_t row = 0; row < (int64_t)blockIndices.size(); ++row)
                 {
-                    CaretAssert(parcelWeights[j].size() == parcelData[j].size());
-                    if (parcelData[j].size() > 0 && (method != ReductionEnum::SAMPSTDEV || parcelData[j].size() > 1))
+                    float* outRow = blockOut.data() + row * numParcels;
+                    for (int j = 0; j < numParcels; ++j)
                     {
-                        if (excludeLow > 0.0f && excludeHigh > 0.0f)
-                        {
-                            scratchOutRow[j] = ReductionOperation::reduceWeightedExcludeDev(parcelData[j].data(), parcelWeights[j].data(), parcelData[j].size(), method, excludeLow, excludeHigh);
-                        } else {
-                            if (onlyNumeric)
+                        if (!reducer.canReduce(j))
+                        {//labelDir can't be 0 (row) because we are parcellating along row, so row must be dense
+                            if (isLabel)
                             {
-                                scratchOutRow[j] = ReductionOperation::reduceWeightedOnlyNumeric(parcelData[j].data(), parcelWeights[j].data(), parcelData[j].size(), method);
+                                outRow[j] = myOutXML.getLabelsMap(labelDir).getMapLabelTable(blockIndices[row][labelDir - 1])->getUnassignedLabelKey();
                             } else {
-                                scratchOutRow[j] = ReductionOperation::reduceWeighted(parcelData[j].data(), parcelWeights[j].data(), parcelData[j].size(), method);
+                                outRow[j] = emptyFillVal;//odd corner case, but probably fine: with nonzero empty fill value and SAMPSTDEV, parcels with only one element get the fill value, but aren't technically empty
                             }
                         }
-                    } else {//labelDir can't be 0 (row) because we are parcellating along row, so row must be dense
-                        if (isLabel)
-                        {
-                            scratchOutRow[j] = myOutXML.getLabelsMap(labelDir).getMapLabelTable((*iter)[labelDir - 1])->getUnassignedLabelKey();
-                        } else {
-                            scratchOutRow[j] = emptyFillVal;
-                        }
                     }
+                    myCiftiOut->setRow(outRow, blockIndices[row]);
                 }
-                myCiftiOut->setRow(scratchOutRow.data(), *iter);
             }
         } else {
-            vector<float> scratchOutRow(numCols);
+            vector<float> scratchRow(numCols);
             vector<int64_t> otherDims = dims;
             otherDims.erase(otherDims.begin() + direction);//direction being parcellated
             otherDims.erase(otherDims.begin());//row
-            vector<vector<vector<float> > > parcelData(numParcels, vector<vector<float> >(numCols));//float so we can use ReductionOperation
-            for (int i = 0; i < numParcels; ++i)
+            const bool accumulate = reducer.isAccumulable();
+            vector<double> accum;
+            vector<float> memberRows;
+            if (accumulate)
             {
-                for (int j = 0; j < numCols; ++j)
-                {
-                    parcelData[i][j].reserve(parcelWeights[i].size());
-                }
+                accum.resize(numParcels * numCols);
+            } else {
+                memberRows.resize(parcelCSR.m_members.size() * numCols);
             }
+            vector<float> outRows(numParcels * numCols);
             for (MultiDimIterator<int64_t> iter(otherDims); !iter.atEnd(); ++iter)
             {
                 vector<int64_t> indices(dims.size() - 1);//we need to add the parcellated direction index back into the index list to use it in getRow/setRow
@@ -603,78 +632,106 @@ namespace
                         indices[i + 1] = (*iter)[i];
                     }
                 }//indices[direction - 1] is uninitialized, as it is the dimension to be parcellated
-                for (int i = 0; i < numParcels; ++i)
+                if (accumulate)
                 {
-                    for (int j = 0; j < numCols; ++j)
-                    {
-                        parcelData[i][j].clear();//doesn't change allocation
-                    }
+                    accum.assign(accum.size(), 0.0);
                 }
                 for (int64_t i = 0; i < dims[direction]; ++i)
-                {
-                    int parcel = indexToParcel[i];
-                    if (parcel != -1)
+                {//read in file order, put each row where the CSR says
+                    const int64_t position = parcelCSR.m_position[i];
+                    if (position != -1)
                     {
                         indices[direction - 1] = i;
-                        myCiftiIn->getRow(scratchRow.data(), indices);
-                        vector<vector<float> >& parcelRef = parcelData[parcel];
-                        for (int j = 0; j < numCols; ++j)
+                        if (accumulate)
                         {
-                            if (isLabel)
+                            myCiftiIn->getRow(scratchRow.data(), indices);
+                            reducer.accumulate(scratchRow.data(), numCols, i, accum.data());
+                        } else {
+                            float* memberRow = memberRows.data() + position * numCols;
+                            myCiftiIn->getRow(memberRow, indices);
+                            for (int64_t j = 0; j < numCols; ++j)
                             {
-                                parcelRef[j].push_back(floor(scratchRow[j] + 0.5f));
-                            } else {
-                                parcelRef[j].push_back(scratchRow[j]);
+                                memberRow[j] = reducer.prepare(memberRow[j]);
                             }
                         }
                     }
                 }
+                if (accumulate)
+                {
+                    reducer.finishAccumulation(accum.data(), numCols, outRows.data());
+                } else {
+                    reducer.reduceColumns(memberRows.data(), numCols, outRows.data());
+                }
                 for (int i = 0; i < numParcels; ++i)
                 {
                     indices[direction - 1] = i;
-                    int64_t count = (int64_t)parcelWeights[i].size();
-                    vector<vector<float> >& parcelRef = parcelData[i];
-                    if (count > 0 && (method != ReductionEnum::SAMPSTDEV || count > 1))
+                    float* outRow = outRows.data() + i * numCols;
+                    if (!reducer.canReduce(i))
                     {
                         for (int j = 0; j < numCols; ++j)
                         {
-                            CaretAssert((int64_t)parcelRef[j].size() == count);
-                            if (excludeLow > 0.0f && excludeHigh > 0.0f)
-                            {
-                                scratchOutRow[j] = ReductionOperation::reduceWeightedExcludeDev(parcelRef[j].data(), parcelWeights[i].data(), parcelRef[j].size(), method, excludeLow, excludeHigh);
-                            } else {
-                                if (onlyNumeric)
-                                {
-                                    scratchOutRow[j] = ReductionOperation::reduceWeightedOnlyNumeric(parcelRef[j].data(), parcelWeights[i].data(), parcelRef[j].size(), method);
-                                } else {
-                                    scratchOutRow[j] = ReductionOperation::reduceWeighted(parcelRef[j].data(), parcelWeights[i].data(), parcelRef[j].size(), method);
-                                }
-                            }
-                        }
-                    } else {
-                        for (int j = 0; j < numCols; ++j)
-                        {
-                            CaretAssert((int64_t)parcelRef[j].size() == count);
                             if (isLabel)
                             {
                                 if (labelDir == CiftiXML::ALONG_ROW)
                                 {
-                                    scratchOutRow[j] = myOutXML.getLabelsMap(CiftiXML::ALONG_ROW).getMapLabelTable(j)->getUnassignedLabelKey();
+                                    outRow[j] = myOutXML.getLabelsMap(CiftiXML::ALONG_ROW).getMapLabelTable(j)->getUnassignedLabelKey();
                                 } else {
-                                    scratchOutRow[j] = myOutXML.getLabelsMap(labelDir).getMapLabelTable(indices[labelDir - 1])->getUnassignedLabelKey();
+                                    outRow[j] = myOutXML.getLabelsMap(labelDir).getMapLabelTable(indices[labelDir - 1])->getUnassignedLabelKey();
                                 }
                             } else {
-                                scratchOutRow[j] = emptyFillVal;
+                                outRow[j] = emptyFillVal;
                             }
                         }
                     }
-                    myCiftiOut->setRow(scratchOutRow.data(), indices);
+                    myCiftiOut->setRow(outRow, indices);
                 }
             }
         }
     }
 }
 
+AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, const CiftiFile* myCiftiIn, const CiftiFile* myCiftiLabel, const int& direction, CiftiFile* myCiftiOut,
+                                                   const ReductionEnum::Enum& method, const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric,
+                                                   const bool& legacyMode, const float& emptyFillVal, CiftiFile* emptyMaskOut) : AbstractAlgorithm(myProgObj)
+{
+    LevelProgress myProgress(myProgObj);
+    CaretAssert(direction >= 0);
+    const CiftiXML& myInputXML = myCiftiIn->getCiftiXML();
+    const CiftiXML& myLabelXML = myCiftiLabel->getCiftiXML();
+    vector<int64_t> dims = myInputXML.getDimensions();
+    if (direction >= (int)dims.size()) throw AlgorithmException("specified direction doesn't exist in input file");
+    if (myInputXML.getMappingType(direction) != CiftiMappingType::BRAIN_MODELS)
+    {
+        throw AlgorithmException("input cifti file does not have brain models mapping type in specified direction");
+    }
+    if (myLabelXML.getNumberOfDimensions() != 2 ||
+        myLabelXML.getMappingType(CiftiXML::ALONG_ROW) != CiftiMappingType::LABELS ||
+        myLabelXML.getMappingType(CiftiXML::ALONG_COLUMN) != CiftiMappingType::BRAIN_MODELS)
+    {
+        throw AlgorithmException("input cifti label file has the wrong mapping types");
+    }
+    const CiftiBrainModelsMap& inputDense = myInputXML.getBrainModelsMap(direction);
+    const CiftiBrainModelsMap& labelDense = myLabelXML.getBrainModelsMap(CiftiXML::ALONG_COLUMN);
+    if (inputDense.hasVolumeData())
+    {//don't check volume space if direction doesn't have volume data
+        if (labelDense.hasVolumeData() && !inputDense.getVolumeSpace().matches(labelDense.getVolumeSpace()))
+        {
+            throw AlgorithmException("input cifti files must have the same volume space");
+        }
+    }
+    vector<int> indexToParcel;
+    CiftiXML myOutXML = myInputXML;
+    CiftiParcelsMap outParcelMap = parcellateMapping(myCiftiLabel, inputDense, indexToParcel, legacyMode);
+    int numParcels = outParcelMap.getLength();
+    if (numParcels < 1)
+    {
+        throw AlgorithmException("no parcels found, output file would be empty, aborting");
+    }
+    myOutXML.setMap(direction, outParcelMap);
+    myCiftiOut->setCiftiXML(myOutXML);
+    doParcellation(myCiftiIn, direction, myCiftiOut, indexToParcel, NULL, method, excludeLow, excludeHigh, onlyNumeric, emptyFillVal, emptyMaskOut);
+}
+
 AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, const CiftiFile* myCiftiIn, const CiftiFile* myCiftiLabel, const int& direction, CiftiFile* myCiftiOut,
                                                    const MetricFile* leftWeights, const MetricFile* rightWeights, const MetricFile* cerebWeights, const ReductionEnum::Enum& method,
                                                    const float& excludeLow, const float& excludeHigh, const bool& onlyNumeric,
@@ -774,7 +831,7 @@ AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, co
             }
         }
     }
-    doWeightedParcellation(myCiftiIn, direction, myCiftiOut, indexToParcel, parcelWeights, method, excludeLow, excludeHigh, onlyNumeric, emptyFillVal, emptyMaskOut);
+    doParcellation(myCiftiIn, direction, myCiftiOut, indexToParcel, &parcelWeights, method, excludeLow, excludeHigh, onlyNumeric, emptyFillVal, emptyMaskOut);
 }
 
 AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, const CiftiFile* myCiftiIn, const CiftiFile* myCiftiLabel, const int& direction, CiftiFile* myCiftiOut,
@@ -863,7 +920,7 @@ AlgorithmCiftiParcellate::AlgorithmCiftiParcellate(ProgressObject* myProgObj, co
             parcelWeights[parcel].push_back(weightCol[weightIndex]);
         }
     }
-    doWeightedParcellation(myCiftiIn, direction, myCiftiOut, indexToParcel, parcelWeights, method, excludeLow, excludeHigh, onlyNumeric, emptyFillVal, emptyMaskOut);
+    doParcellation(myCiftiIn, direction, myCiftiOut, indexToParcel, &parcelWeights, method, excludeLow, excludeHigh, onlyNumeric, emptyFillVal, emptyMaskOut);
 }
 
 CiftiParcelsMap AlgorithmCiftiParcellate::parcellateMapping(const CiftiFile* myCiftiLabel, const CiftiBrainModelsMap& toParcellate, vector<int>& indexToParcelOut, const bool& legacyMode)
@@ -26,6 +26,7 @@
 #include "MultiDimIterator.h"
 #include "ReductionOperation.h"
 
+#include <algorithm>
 #include <vector>
 
 using namespace caret;
@@ -112,18 +113,28 @@ AlgorithmCiftiReduce::AlgorithmCiftiReduce(ProgressObject* myProgObj, const Cift
         {
             CaretLogWarning("-cifti-reduce is being used for a length=1 reduction on file '" + ciftiIn->getFileName() + "'");
         }
-        vector<float> scratchInRow(inDims[0]);
-        for (MultiDimIterator<int64_t> iter(vector<int64_t>(inDims.begin() + 1, inDims.end())); !iter.atEnd(); ++iter)
+        const int64_t blockRows = max((int64_t)1, (int64_t)(1<<22) / inDims[0]);//read rows serially, but reduce a block of them in parallel
+        vector<float> blockData(blockRows * inDims[0]), blockResults(blockRows);
+        vector<vector<int64_t> > blockIndices;
+        blockIndices.reserve(blockRows);
+        for (MultiDimIterator<int64_t> iter(vector<int64_t>(inDims.begin() + 1, inDims.end())); ; ++iter)
         {// + 1 to exclude row dimension, because getRow/setRow
-            ciftiIn->getRow(scratchInRow.data(), *iter);
-            float result = -1;
-            if (onlyNumeric)
+            bool done = iter.atEnd();
+            if (!done)
             {
-                result = ReductionOperation::reduceOnlyNumeric(scratchInRow.data(), inDims[0], myReduce);
-            } else {
-                result = ReductionOperation::reduce(scratchInRow.data(), inDims[0], myReduce);
+                ciftiIn->getRow(blockData.data() + blockIndices.size() * inDims[0], *iter);
+                blockIndices.push_back(*iter);
             }
-            ciftiOut->setRow(&result, *iter);//if reducing along row, length of output row is 1
+            if (!blockIndices.empty() && (done || (int64_t)blockIndices.size() == blockRows))
+            {
+                ReductionOperation::reduceRows(blockData.data(), blockIndices.size(), inDims[0], myReduce, blockResults.data(), onlyNumeric);
+                for (int64_t i = 0; i < (int64_t)blockIndices.size(); ++i)
+                {
+                    ciftiOut->setRow(&(blockResults[i]), blockIndices[i]);//if reducing along row, length of output row is 1
+                }
+                blockIndices.clear();
+            }
+            if (done) break;
         }
     } else {
         if (inDims[direction] == 1 && ! ReductionOperation::isLengthOneReasonable(myReduce))
@@ -131,7 +142,7 @@ AlgorithmCiftiReduce::AlgorithmCiftiReduce(ProgressObject* myProgObj, const Cift
             CaretLogWarning("-cifti-reduce is being used for a length=1 reduction on file '" + ciftiIn->getFileName() + "'");
         }
         vector<vector<float> > scratchInRows(inDims[direction], vector<float>(inDims[0]));
-        vector<float> outRow(inDims[0]), reduceScratch(inDims[direction]);//reduction isn't along row, so out rows will be same length as in rows
+        vector<float> outRow(inDims[0]), reduceScratch(inDims[0] * inDims[direction]);//reduction isn't along row, so out rows will be same length as in rows
         vector<int64_t> otherDims = inDims;
         otherDims.erase(otherDims.begin() + direction);//direction isn't 0
         otherDims.erase(otherDims.begin());//remove row direction because getRow/setRow
@@ -147,16 +158,11 @@ AlgorithmCiftiReduce::AlgorithmCiftiReduce(ProgressObject* myProgObj, const Cift
             for (int64_t i = 0; i < inDims[0]; ++i)
             {
                 for (int64_t j = 0; j < inDims[direction]; ++j)
-                {//need reduction input in contiguous array
-                    reduceScratch[j] = scratchInRows[j][i];
-                }
-                if (onlyNumeric)
-                {
-                    outRow[i] = ReductionOperation::reduceOnlyNumeric(reduceScratch.data(), inDims[direction], myReduce);
-                } else {
-                    outRow[i] = ReductionOperation::reduce(reduceScratch.data(), inDims[direction], myReduce);
+                {//need reduction inputs in contiguous rows
+                    reduceScratch[i * inDims[direction] + j] = scratchInRows[j][i];
                 }
             }
+            ReductionOperation::reduceRows(reduceScratch.data(), inDims[0], inDims[direction], myReduce, outRow.data(), onlyNumeric);
             indexvec[direction - 1] = 0;//only one element along reduce output direction
             ciftiOut->setRow(outRow.data(), indexvec);
         }
@@ -29,6 +29,7 @@
 #include "AlgorithmMetricResample.h"
 #include "AlgorithmVolumeAffineResample.h"
 #include "AlgorithmVolumeWarpfieldResample.h"
+#include "CaretTaskPool.h"
 #include "CiftiFile.h"
 #include "LabelFile.h"
 #include "MetricFile.h"
@@ -895,12 +896,14 @@ AlgorithmCiftiResample::AlgorithmCiftiResample(ProgressObject* myProgObj, const
     vector<StructureEnum::Enum> surfList = outModels.getSurfaceStructureList(), volList = outModels.getVolumeStructureList();
     myCiftiOut->setCiftiXML(myOutXML);
     if (direction == CiftiXML::ALONG_COLUMN)
-    {
+    {//structures are independent, so resample them concurrently
+        CaretTaskGroup structureTasks((int)(surfList.size() + volList.size()));
         for (int i = 0; i < (int)surfList.size(); ++i)//and now, resampling
         {
+            const StructureEnum::Enum myStruct = surfList[i];
             const SurfaceFile* curSphere = NULL, *newSphere = NULL;
             const MetricFile* curAreas = NULL, *newAreas = NULL;
-            switch (surfList[i])
+            switch (myStruct)
             {
                 case StructureEnum::CORTEX_LEFT:
                     curSphere = curLeftSphere;
@@ -921,15 +924,23 @@ AlgorithmCiftiResample::AlgorithmCiftiResample(ProgressObject* myProgObj, const
                     newAreas = newCerebAreas;
                     break;
                 default:
-                    throw AlgorithmException("unsupported surface structure: " + StructureEnum::toGuiName(surfList[i]));
+                    throw AlgorithmException("unsupported surface structure: " + StructureEnum::toGuiName(myStruct));
                     break;
             }
-            processSurfaceComponent(myCiftiIn, direction, surfList[i], mySurfMethod, myCiftiOut, surfLargest, surfdilatemm, curSphere, newSphere, curAreas, newAreas, surfDilateMethod, surfDilateExponent, surfLegacyCutoff);
+            structureTasks.run([&, myStruct, curSphere, newSphere, curAreas, newAreas]()
+            {
+                processSurfaceComponent(myCiftiIn, direction, myStruct, mySurfMethod, myCiftiOut, surfLargest, surfdilatemm, curSphere, newSphere, curAreas, newAreas, surfDilateMethod, surfDilateExponent, surfLegacyCutoff);
+            });
         }
         for (int i = 0; i < (int)volList.size(); ++i)
         {
-            processVolume(myCiftiIn, direction, volList[i], myVolMethod, myCiftiOut, voldilatemm, warpfield, NULL, volDilateMethod, volDilateExponent, volLegacyCutoff);
+            const StructureEnum::Enum myStruct = volList[i];
+            structureTasks.run([&, myStruct]()
+            {
+                processVolume(myCiftiIn, direction, myStruct, myVolMethod, myCiftiOut, voldilatemm, warpfield, NULL, volDilateMethod, volDilateExponent, volLegacyCutoff);
+            });
         }
+        structureTasks.wait();
     } else {//avoid cifti separate/replace with ALONG_ROW
         bool labelMode = (myInputXML.getMappingType(CiftiXML::ALONG_COLUMN) == CiftiMappingType::LABELS);
         vector<StructureEnum::Enum> surfList = outModels.getSurfaceStructureList(), volList = outModels.getVolumeStructureList();
@@ -995,12 +1006,14 @@ AlgorithmCiftiResample::AlgorithmCiftiResample(ProgressObject* myProgObj, const
     vector<StructureEnum::Enum> surfList = outModels.getSurfaceStructureList(), volList = outModels.getVolumeStructureList();
     myCiftiOut->setCiftiXML(myOutXML);
     if (direction == CiftiXML::ALONG_COLUMN)
-    {
+    {//structures are independent, so resample them concurrently
+        CaretTaskGroup structureTasks((int)(surfList.size() + volList.size()));
         for (int i = 0; i < (int)surfList.size(); ++i)//and now, resampling
         {
+            const StructureEnum::Enum myStruct = surfList[i];
             const SurfaceFile* curSphere = NULL, *newSphere = NULL;
             const MetricFile* curAreas = NULL, *newAreas = NULL;
-            switch (surfList[i])
+            switch (myStruct)
             {
                 case StructureEnum::CORTEX_LEFT:
                     curSphere = curLeftSphere;
@@ -1021,15 +1034,23 @@ AlgorithmCiftiResample::AlgorithmCiftiResample(ProgressObject* myProgObj, const
                     newAreas = newCerebAreas;
                     break;
                 default:
-                    throw AlgorithmException("unsupported surface structure: " + StructureEnum::toGuiName(surfList[i]));
+                    throw AlgorithmException("unsupported surface structure: " + StructureEnum::toGuiName(myStruct));
                     break;
             }
-            processSurfaceComponent(myCiftiIn, direction, surfList[i], mySurfMethod, myCiftiOut, surfLargest, surfdilatemm, curSphere, newSphere, curAreas, newAreas, surfDilateMethod, surfDilateExponent, surfLegacyCutoff);
+            structureTasks.run([&, myStruct, curSphere, newSphere, curAreas, newAreas]()
+            {
+                processSurfaceComponent(myCiftiIn, direction, myStruct, mySurfMethod, myCiftiOut, surfLargest, surfdilatemm, curSphere, newSphere, curAreas, newAreas, surfDilateMethod, surfDilateExponent, surfLegacyCutoff);
+            });
         }
         for (int i = 0; i < (int)volList.size(); ++i)
         {
-            processVolume(myCiftiIn, direction, volList[i], myVolMethod, myCiftiOut, voldilatemm, NULL, &affine, volDilateMethod, volDilateExponent, volLegacyCutoff);
+            const StructureEnum::Enum myStruct = volList[i];
+            structureTasks.run([&, myStruct]()
+            {
+                processVolume(myCiftiIn, direction, myStruct, myVolMethod, myCiftiOut, voldilatemm, NULL, &affine, volDilateMethod, volDilateExponent, volLegacyCutoff);
+            });
         }
+        structureTasks.wait();
     } else {//avoid cifti separate/replace with ALONG_ROW
         bool labelMode = (myInputXML.getMappingType(CiftiXML::ALONG_COLUMN) == CiftiMappingType::LABELS);
         vector<StructureEnum::Enum> surfList = outModels.getSurfaceStructureList(), volList = outModels.getVolumeStructureList();
@@ -1103,6 +1124,7 @@ void AlgorithmCiftiResample::processSurfaceComponent(const CiftiFile* myCiftiIn,
         } else {
             newUse = &origLabel;
         }
+        CaretMutexLocker locked(&m_outputMutex);
         AlgorithmCiftiReplaceStructure(NULL, myCiftiOut, direction, myStruct, newUse);
     } else {
         MetricFile origMetric, origROI;
@@ -1128,6 +1150,7 @@ void AlgorithmCiftiResample::processSurfaceComponent(const CiftiFile* myCiftiIn,
         } else {
             newUse = &origMetric;
         }
+        CaretMutexLocker locked(&m_outputMutex);
         AlgorithmCiftiReplaceStructure(NULL, myCiftiOut, direction, myStruct, newUse);
     }
 }
@@ -1284,6 +1307,7 @@ void AlgorithmCiftiResample::processVolume(const CiftiFile* myCiftiIn, const int
             newVolume.setFrame(scratchframe.data(), b);
         }
     }
+    CaretMutexLocker locked(&m_outputMutex);//replacing is read-modify-write of rows shared with other structures
     AlgorithmCiftiReplaceStructure(NULL, myCiftiOut, direction, myStruct, &newVolume, true);
 }
 
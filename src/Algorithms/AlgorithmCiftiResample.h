@@ -24,6 +24,7 @@
 #include "AbstractAlgorithm.h"
 #include "AlgorithmMetricDilate.h" //for dilate method enums
 #include "AlgorithmVolumeDilate.h"
+#include "CaretMutex.h"
 #include "FloatMatrix.h"
 #include "StructureEnum.h"
 #include "SurfaceResamplingMethodEnum.h"
@@ -36,6 +37,7 @@ namespace caret {
     class AlgorithmCiftiResample : public AbstractAlgorithm
     {
         AlgorithmCiftiResample();
+        CaretMutex m_outputMutex;//structures are processed concurrently, but written to the output one at a time
         void processSurfaceComponent(const CiftiFile* myCiftiIn, const int& direction, const StructureEnum::Enum& myStruct, const SurfaceResamplingMethodEnum::Enum& mySurfMethod,
                                      CiftiFile* myCiftiOut, const bool& surfLargest, const float& surfdilatemm, const SurfaceFile* curSphere, const SurfaceFile* newSphere,
                                      const MetricFile* curAreas, const MetricFile* newAreas,
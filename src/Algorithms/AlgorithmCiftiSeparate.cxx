@@ -22,6 +22,7 @@
 #include "AlgorithmException.h"
 #include "CaretLogger.h"
 #include "CaretPointer.h"
+#include "CaretTaskPool.h"
 #include "CiftiFile.h"
 #include "GiftiLabelTable.h"
 #include "LabelFile.h"
@@ -108,7 +109,8 @@ void AlgorithmCiftiSeparate::useParameters(OperationParameters* myParams, Progre
     } else {
         throw AlgorithmException("incorrect string for direction, use ROW or COLUMN");
     }
-    bool outputRequested = false;
+    bool outputRequested = false;//parse serially, but separate the requested structures concurrently, as they read from the same input into different outputs
+    CaretTaskGroup separateTasks;
     const vector<ParameterComponent*>& labelInstances = myParams->getRepeatableParameterInstances(3);
     for (int i = 0; i < (int)labelInstances.size(); ++i)
     {
@@ -127,7 +129,7 @@ void AlgorithmCiftiSeparate::useParameters(OperationParameters* myParams, Progre
         {
             roiOut = labelRoiOpt->getOutputMetric(1);
         }
-        AlgorithmCiftiSeparate(NULL, ciftiIn, myDir, myStruct, labelOut, roiOut);
+        separateTasks.run([=]() { AlgorithmCiftiSeparate(NULL, ciftiIn, myDir, myStruct, labelOut, roiOut); });
     }
     const vector<ParameterComponent*>& metricInstances = myParams->getRepeatableParameterInstances(4);
     for (int i = 0; i < (int)metricInstances.size(); ++i)
@@ -147,7 +149,7 @@ void AlgorithmCiftiSeparate::useParameters(OperationParameters* myParams, Progre
         {
             roiOut = metricRoiOpt->getOutputMetric(1);
         }
-        AlgorithmCiftiSeparate(NULL, ciftiIn, myDir, myStruct, metricOut, roiOut);
+        separateTasks.run([=]() { AlgorithmCiftiSeparate(NULL, ciftiIn, myDir, myStruct, metricOut, roiOut); });
     }
     const vector<ParameterComponent*>& volumeInstances = myParams->getRepeatableParameterInstances(5);
     for (int i = 0; i < (int)volumeInstances.size(); ++i)
@@ -168,8 +170,11 @@ void AlgorithmCiftiSeparate::useParameters(OperationParameters* myParams, Progre
             roiOut = volumeRoiOpt->getOutputVolume(1);
         }
         bool cropVol = volumeInstances[i]->getOptionalParameter(4)->m_present;
-        int64_t offset[3];
-        AlgorithmCiftiSeparate(NULL, ciftiIn, myDir, myStruct, volOut, offset, roiOut, cropVol);
+        separateTasks.run([=]()
+        {
+            int64_t offset[3];
+            AlgorithmCiftiSeparate(NULL, ciftiIn, myDir, myStruct, volOut, offset, roiOut, cropVol);
+        });
     }
     OptionalParameter* volumeAllOpt = myParams->getOptionalParameter(6);
     if (volumeAllOpt->m_present)
@@ -189,9 +194,13 @@ void AlgorithmCiftiSeparate::useParameters(OperationParameters* myParams, Progre
         {
             labelOut = volumeAllLabelOpt->getOutputVolume(1);
         }
-        int64_t offset[3];
-        AlgorithmCiftiSeparate(NULL, ciftiIn, myDir, volOut, offset, roiOut, cropVol, labelOut);
+        separateTasks.run([=]()
+        {
+            int64_t offset[3];
+            AlgorithmCiftiSeparate(NULL, ciftiIn, myDir, volOut, offset, roiOut, cropVol, labelOut);
+        });
     }
+    separateTasks.wait();
     if (!outputRequested)
     {
         CaretLogWarning("no output requested from -cifti-separate, command will do nothing");
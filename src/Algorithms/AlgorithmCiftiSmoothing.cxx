@@ -22,6 +22,8 @@
 #include "AlgorithmException.h"
 #include "AlgorithmMetricSmoothing.h"
 #include "AlgorithmVolumeSmoothing.h"
+#include "CaretMutex.h"
+#include "CaretTaskPool.h"
 #include "CiftiFile.h"
 #include "MetricFile.h"
 #include "VolumeFile.h"
@@ -235,76 +237,95 @@ AlgorithmCiftiSmoothing::AlgorithmCiftiSmoothing(ProgressObject* myProgObj, cons
         }
     }
     myCiftiOut->setCiftiXML(myXML);
+    //structures are independent, so smooth them concurrently, but replacing a structure is read-modify-write when smoothing along rows, so do that one at a time
+    CaretMutex outputMutex;
+    CaretTaskGroup structureTasks((int)surfaceList.size() + (mergedVolume ? 1 : (int)volumeList.size()));
     for (int whichStruct = 0; whichStruct < (int)surfaceList.size(); ++whichStruct)
     {
-        const SurfaceFile* mySurf = NULL;
-        const MetricFile* myAreas = NULL;
-        switch (surfaceList[whichStruct])
-        {
-            case StructureEnum::CORTEX_LEFT:
-                mySurf = myLeftSurf;
-                myAreas = myLeftAreas;
-                break;
-            case StructureEnum::CORTEX_RIGHT:
-                mySurf = myRightSurf;
-                myAreas = myRightAreas;
-                break;
-            case StructureEnum::CEREBELLUM:
-                mySurf = myCerebSurf;
-                myAreas = myCerebAreas;
-                break;
-            default:
-                break;
-        }
-        MetricFile myMetric, myRoi, myMetricOut;
-        AlgorithmCiftiSeparate(NULL, myCifti, myDir, surfaceList[whichStruct], &myMetric, &myRoi);
-        if (surfKern > 0.0f)
+        structureTasks.run([&, whichStruct]()
         {
-            if (roiCifti != NULL)
-            {//due to above testing, we know the structure mask is the same, so just overwrite the ROI from the mask
-                AlgorithmCiftiSeparate(NULL, roiCifti, CiftiXMLOld::ALONG_COLUMN, surfaceList[whichStruct], &myRoi);
+            const SurfaceFile* mySurf = NULL;
+            const MetricFile* myAreas = NULL;
+            switch (surfaceList[whichStruct])
+            {
+                case StructureEnum::CORTEX_LEFT:
+                    mySurf = myLeftSurf;
+                    myAreas = myLeftAreas;
+                    break;
+                case StructureEnum::CORTEX_RIGHT:
+                    mySurf = myRightSurf;
+                    myAreas = myRightAreas;
+                    break;
+                case StructureEnum::CEREBELLUM:
+                    mySurf = myCerebSurf;
+                    myAreas = myCerebAreas;
+                    break;
+                default:
+                    break;
             }
-            AlgorithmMetricSmoothing(NULL, mySurf, &myMetric, surfKern, &myMetricOut, &myRoi, false, fixZerosSurf, -1, myAreas);
-            AlgorithmCiftiReplaceStructure(NULL, myCiftiOut, myDir, surfaceList[whichStruct], &myMetricOut);
-        } else {
-            AlgorithmCiftiReplaceStructure(NULL, myCiftiOut, myDir, surfaceList[whichStruct], &myMetric);
-        }
+            MetricFile myMetric, myRoi, myMetricOut;
+            AlgorithmCiftiSeparate(NULL, myCifti, myDir, surfaceList[whichStruct], &myMetric, &myRoi);
+            if (surfKern > 0.0f)
+            {
+                if (roiCifti != NULL)
+                {//due to above testing, we know the structure mask is the same, so just overwrite the ROI from the mask
+                    AlgorithmCiftiSeparate(NULL, roiCifti, CiftiXMLOld::ALONG_COLUMN, surfaceList[whichStruct], &myRoi);
+                }
+                AlgorithmMetricSmoothing(NULL, mySurf, &myMetric, surfKern, &myMetricOut, &myRoi, false, fixZerosSurf, -1, myAreas);
+                CaretMutexLocker locked(&outputMutex);
+                AlgorithmCiftiReplaceStructure(NULL, myCiftiOut, myDir, surfaceList[whichStruct], &myMetricOut);
+            } else {
+                CaretMutexLocker locked(&outputMutex);
+                AlgorithmCiftiReplaceStructure(NULL, myCiftiOut, myDir, surfaceList[whichStruct], &myMetric);
+            }
+        });
     }
     if (mergedVolume)
     {
-        VolumeFile myVol, myRoi, myVolOut;
-        int64_t offset[3];
-        AlgorithmCiftiSeparate(NULL, myCifti, myDir, &myVol, offset, &myRoi, true);
-        if (volKern > 0.0f)
-        {
-            if (roiCifti != NULL)
-            {//due to above testing, we know the structure mask is the same, so just overwrite the ROI from the mask
-                AlgorithmCiftiSeparate(NULL, roiCifti, CiftiXMLOld::ALONG_COLUMN, &myRoi, offset, NULL, true);
-            }
-            AlgorithmVolumeSmoothing(NULL, &myVol, volKern, &myVolOut, &myRoi, fixZerosVol);
-            AlgorithmCiftiReplaceStructure(NULL, myCiftiOut, myDir, &myVolOut, true);
-        } else {
-            AlgorithmCiftiReplaceStructure(NULL, myCiftiOut, myDir, &myVol, true);
-        }
-    } else {
-        for (int whichStruct = 0; whichStruct < (int)volumeList.size(); ++whichStruct)
+        structureTasks.run([&]()
         {
             VolumeFile myVol, myRoi, myVolOut;
             int64_t offset[3];
-            AlgorithmCiftiSeparate(NULL, myCifti, myDir, volumeList[whichStruct], &myVol, offset, &myRoi, true);
+            AlgorithmCiftiSeparate(NULL, myCifti, myDir, &myVol, offset, &myRoi, true);
             if (volKern > 0.0f)
             {
                 if (roiCifti != NULL)
                 {//due to above testing, we know the structure mask is the same, so just overwrite the ROI from the mask
-                    AlgorithmCiftiSeparate(NULL, roiCifti, CiftiXMLOld::ALONG_COLUMN, volumeList[whichStruct], &myRoi, offset, NULL, true);
+                    AlgorithmCiftiSeparate(NULL, roiCifti, CiftiXMLOld::ALONG_COLUMN, &myRoi, offset, NULL, true);
                 }
                 AlgorithmVolumeSmoothing(NULL, &myVol, volKern, &myVolOut, &myRoi, fixZerosVol);
-                AlgorithmCiftiReplaceStructure(NULL, myCiftiOut, myDir, volumeList[whichStruct], &myVolOut, true);
+                CaretMutexLocker locked(&outputMutex);
+                AlgorithmCiftiReplaceStructure(NULL, myCiftiOut, myDir, &myVolOut, true);
             } else {
-                AlgorithmCiftiReplaceStructure(NULL, myCiftiOut, myDir, volumeList[whichStruct], &myVol, true);
+                CaretMutexLocker locked(&outputMutex);
+                AlgorithmCiftiReplaceStructure(NULL, myCiftiOut, myDir, &myVol, true);
             }
+        });
+    } else {
+        for (int whichStruct = 0; whichStruct < (int)volumeList.size(); ++whichStruct)
+        {
+            structureTasks.run([&, whichStruct]()
+            {
+                VolumeFile myVol, myRoi, myVolOut;
+                int64_t offset[3];
+                AlgorithmCiftiSeparate(NULL, myCifti, myDir, volumeList[whichStruct], &myVol, offset, &myRoi, true);
+                if (volKern > 0.0f)
+                {
+                    if (roiCifti != NULL)
+                    {//due to above testing, we know the structure mask is the same, so just overwrite the ROI from the mask
+                        AlgorithmCiftiSeparate(NULL, roiCifti, CiftiXMLOld::ALONG_COLUMN, volumeList[whichStruct], &myRoi, offset, NULL, true);
+                    }
+                    AlgorithmVolumeSmoothing(NULL, &myVol, volKern, &myVolOut, &myRoi, fixZerosVol);
+                    CaretMutexLocker locked(&outputMutex);
+                    AlgorithmCiftiReplaceStructure(NULL, myCiftiOut, myDir, volumeList[whichStruct], &myVolOut, true);
+                } else {
+                    CaretMutexLocker locked(&outputMutex);
+                    AlgorithmCiftiReplaceStructure(NULL, myCiftiOut, myDir, volumeList[whichStruct], &myVol, true);
+                }
+            });
         }
     }
+    structureTasks.wait();
 }
 
 float AlgorithmCiftiSmoothing::getAlgorithmInternalWeight()
@@ -21,12 +21,15 @@
 #include "AlgorithmMetricFindClusters.h"
 #include "AlgorithmException.h"
 
+#include "CaretConnectedComponents.h"
 #include "CaretLogger.h"
+#include "CaretOMP.h"
 #include "GeodesicHelper.h"
 #include "MetricFile.h"
 #include "SurfaceFile.h"
 #include "TopologyHelper.h"
 
+#include <algorithm>
 #include <vector>
 
 using namespace caret;
@@ -153,12 +156,13 @@ namespace
         double area;
     };
     
-    void processColumn(const float* data, const float* roiData, const float* nodeAreas, TopologyHelper* myTopoHelp, GeodesicHelper* myGeoHelp,
-                       const float& threshVal, const float& minArea, const bool& lessThan, const float& areaRatio, const float& distanceCutoff,
-                       float* outData, int& markVal)
+    ///finds the clusters to keep in one column, in marking order, returns false if clusters were found but none had positive area
+    bool findColumnClusters(const float* data, const float* roiData, const float* nodeAreas, const int& numNodes, const vector<int64_t>& adjStart, const vector<int32_t>& adjNeighbors,
+                            GeodesicHelper* myGeoHelp, CaretConnectedComponents& myComponents, const float& threshVal, const float& minArea, const bool& lessThan,
+                            const float& areaRatio, const float& distanceCutoff, vector<Cluster>& clusters)
     {
-        int numNodes = myTopoHelp->getNumberOfNodes();
-        vector<int> marked(numNodes, 0);
+        clusters.clear();
+        vector<char> marked(numNodes, 0);
         if (lessThan)
         {
             for (int i = 0; i < numNodes; ++i)
@@ -177,46 +181,40 @@ namespace
                 }
             }
         }
-        vector<Cluster> clusters;
+        vector<int64_t> labels;
+        int64_t numComponents = myComponents.labelGraph(adjStart.data(), adjNeighbors.data(), numNodes, marked.data(), labels);
+        vector<double> componentAreas(numComponents, 0.0);
+        for (int i = 0; i < numNodes; ++i)
+        {
+            if (labels[i] >= 0) componentAreas[labels[i]] += nodeAreas[i];
+        }
+        vector<int64_t> keepIndex(numComponents, -1);//components are numbered by lowest vertex, the same order the flood fill used to find them
         float biggestSize = 0.0f;
         int biggestCluster = -1;
-        for (int i = 0; i < numNodes; ++i)
+        for (int64_t i = 0; i < numComponents; ++i)
         {
-            if (marked[i])
+            if (componentAreas[i] > minArea)
             {
-                Cluster newCluster;
-                newCluster.members.push_back(i);
-                marked[i] = 0;//unmark it when added to list to prevent multiples
-                for (int index = 0; index < (int)newCluster.members.size(); ++index)//NOTE: vector grows inside loop
-                {
-                    int node = newCluster.members[index];//keep list around so we can put it into the output immediately if it is large enough
-                    newCluster.area += nodeAreas[node];
-                    const vector<int32_t>& neighbors = myTopoHelp->getNodeNeighbors(node);
-                    int numNeigh = (int)neighbors.size();
-                    for (int n = 0; n < numNeigh; ++n)
-                    {
-                        const int32_t& neighbor = neighbors[n];
-                        if (marked[neighbor])
-                        {
-                            newCluster.members.push_back(neighbor);
-                            marked[neighbor] = 0;
-                        }
-                    }
-                }
-                if (newCluster.area > minArea)
+                if (componentAreas[i] > biggestSize)
                 {
-                    if (newCluster.area > biggestSize)
-                    {
-                        biggestSize = newCluster.area;
-                        biggestCluster = (int)clusters.size();
-                    }
-                    clusters.push_back(newCluster);
+                    biggestSize = componentAreas[i];
+                    biggestCluster = (int)clusters.size();
                 }
+                keepIndex[i] = (int64_t)clusters.size();
+                clusters.push_back(Cluster());
+                clusters.back().area = componentAreas[i];
+            }
+        }
+        for (int i = 0; i < numNodes; ++i)
+        {
+            if (labels[i] >= 0 && keepIndex[labels[i]] != -1)
+            {
+                clusters[keepIndex[labels[i]]].members.push_back(i);
             }
         }
         vector<int32_t> pathScratch;
         vector<float> distScratch;
-        if (!clusters.empty() && biggestCluster == -1) CaretLogWarning("clusters found, but none have positive area, check your vertex areas for negatives");
+        if (!clusters.empty() && biggestCluster == -1) return false;
         if (biggestCluster != -1 && (distanceCutoff > 0.0f || areaRatio > 0.0f))
         {
             for (size_t i = 0; i < clusters.size(); ++i)
@@ -249,6 +247,11 @@ namespace
                 }
             }
         }
+        return true;
+    }
+    
+    void markClusters(const vector<Cluster>& clusters, float* outData, int& markVal)
+    {
         for (size_t i = 0; i < clusters.size(); ++i)
         {
             if (markVal == 0)
@@ -303,41 +306,70 @@ AlgorithmMetricFindClusters::AlgorithmMetricFindClusters(ProgressObject* myProgO
     } else {
         nodeAreas = myAreas->getValuePointerForColumn(0);
     }
-    CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();
-    CaretPointer<GeodesicHelper> myGeoHelp;
+    vector<int64_t> adjStart;
+    vector<int32_t> adjNeighbors;
+    mySurf->getTopologyHelper()->getNeighborAdjacency(adjStart, adjNeighbors);
+    int batchSize = 1;//columns are clustered in parallel batches, then marked in order so numbering doesn't depend on threading
+#ifdef CARET_OMP
+    batchSize = omp_get_max_threads();
+#endif
+    batchSize = max(1, min(batchSize, (columnNum == -1 ? numCols : 1)));
+    vector<CaretPointer<GeodesicHelper> > myGeoHelps(batchSize);
     CaretPointer<GeodesicHelperBase> myGeoBase;
-    if (distanceCutoff > 0.0f)//geodesic is only needed for distance cutoff
+    if (distanceCutoff > 0.0f)//geodesic is only needed for distance cutoff, and each thread needs its own
     {
-        if (myAreas == NULL)
+        if (myAreas != NULL)
         {
-            myGeoHelp = mySurf->getGeodesicHelper();
-        } else {
             myGeoBase.grabNew(new GeodesicHelperBase(mySurf, myAreas->getValuePointerForColumn(0)));
-            myGeoHelp.grabNew(new GeodesicHelper(myGeoBase));
+        }
+        for (int i = 0; i < batchSize; ++i)
+        {
+            if (myAreas == NULL)
+            {
+                myGeoHelps[i] = mySurf->getGeodesicHelper();
+            } else {
+                myGeoHelps[i].grabNew(new GeodesicHelper(myGeoBase));
+            }
         }
     }
-    vector<int> toSearch;
-    int markVal = startVal;//give each cluster a different value, including across maps
+    vector<CaretConnectedComponents> myComponents(batchSize);
+    vector<int> columnList;
     if (columnNum == -1)
     {
         myMetricOut->setNumberOfNodesAndColumns(numNodes, numCols);
-        myMetricOut->setStructure(mySurf->getStructure());
         for (int c = 0; c < numCols; ++c)
         {
-            myMetricOut->setColumnName(c, myMetric->getColumnName(c));
-            vector<float> outData(numNodes, 0.0f);
-            const float* data = myMetric->getValuePointerForColumn(c);
-            processColumn(data, roiData, nodeAreas, myTopoHelp, myGeoHelp, threshVal, minArea, lessThan, areaRatio, distanceCutoff, outData.data(), markVal);
-            myMetricOut->setValuesForColumn(c, outData.data());
+            columnList.push_back(c);
         }
     } else {
         myMetricOut->setNumberOfNodesAndColumns(numNodes, 1);
-        myMetricOut->setStructure(mySurf->getStructure());
-        myMetricOut->setColumnName(0, myMetric->getColumnName(columnNum));
-        vector<float> outData(numNodes, 0.0f);
-        const float* data = myMetric->getValuePointerForColumn(columnNum);
-        processColumn(data, roiData, nodeAreas, myTopoHelp, myGeoHelp, threshVal, minArea, lessThan, areaRatio, distanceCutoff, outData.data(), markVal);
-        myMetricOut->setValuesForColumn(0, outData.data());
+        columnList.push_back(columnNum);
+    }
+    myMetricOut->setStructure(mySurf->getStructure());
+    int markVal = startVal;//give each cluster a different value, including across maps
+    int numOutCols = (int)columnList.size();
+    vector<vector<Cluster> > batchClusters(batchSize);
+    vector<char> batchPositive(batchSize);
+    for (int batchStart = 0; batchStart < numOutCols; batchStart += batchSize)
+    {
+        int batchEnd = min(numOutCols, batchStart + batchSize);
+#pragma omp CARET_PARFOR schedule(dynamic)
+        for (int outCol = batchStart; outCol < batchEnd; ++outCol)
+        {
+            int slot = outCol - batchStart;
+            const float* data = myMetric->getValuePointerForColumn(columnList[outCol]);
+            batchPositive[slot] = findColumnClusters(data, roiData, nodeAreas, numNodes, adjStart, adjNeighbors, myGeoHelps[slot], myComponents[slot],
+                                                     threshVal, minArea, lessThan, areaRatio, distanceCutoff, batchClusters[slot]);
+        }
+        for (int outCol = batchStart; outCol < batchEnd; ++outCol)
+        {
+            int slot = outCol - batchStart;
+            if (!batchPositive[slot]) CaretLogWarning("clusters found, but none have positive area, check your vertex areas for negatives");
+            myMetricOut->setColumnName(outCol, myMetric->getColumnName(columnList[outCol]));
+            vector<float> outData(numNodes, 0.0f);
+            markClusters(batchClusters[slot], outData.data(), markVal);
+            myMetricOut->setValuesForColumn(outCol, outData.data());
+        }
     }
     if (endVal != NULL) *endVal = markVal;
 }
@@ -23,15 +23,12 @@
 #include "AlgorithmMetricGradient.h"
 #include "AlgorithmMetricSmoothing.h"
 #include "AlgorithmException.h"
-#include "CaretOMP.h"
 #include "CaretLogger.h"
-#include "FloatMatrix.h"
-#include "MathFunctions.h"
+#include "CaretPointer.h"
 #include "MetricFile.h"
+#include "MetricGradientObject.h"
 #include "PaletteColorMapping.h"
 #include "SurfaceFile.h"
-#include "TopologyHelper.h"
-#include "Vector3D.h"
 
 #include <cmath>
 
@@ -197,428 +194,72 @@ AlgorithmMetricGradient::AlgorithmMetricGradient(ProgressObject* myProgObj,
             useColumn = 0;
         }
     }
-    const float* myNormals = NULL;
-    vector<float> avgNormalStorage;
-    if (myAvgNormals)
+    const float* corrAreaData = NULL;
+    if (corrAreaMetric != NULL)
     {
-        avgNormalStorage = mySurf->computeAverageNormals();
-        myNormals = avgNormalStorage.data();
-    } else {
-        mySurf->computeNormals();
-        myNormals = mySurf->getNormalData();
+        corrAreaData = corrAreaMetric->getValuePointerForColumn(0);
     }
-    vector<float> sqrtCorrAreas;//same logic as GeodesicHelper
-    vector<float> sqrtVertAreas;
-    const float* vertAreas = NULL;
-    vector<float> areaData;
-    if (corrAreaMetric != NULL)
+    CaretPointer<MetricGradientObject> myGradient;//the per-vertex regressions only depend on the surface and roi, so solve them once unless the roi changes per column
+    if (myRoi == NULL || !matchRoiColumns)
     {
-        sqrtCorrAreas.resize(numNodes);
-        mySurf->computeNodeAreas(sqrtVertAreas);
-        const float* corrAreaData = corrAreaMetric->getValuePointerForColumn(0);
-        for (int i = 0; i < numNodes; ++i)
-        {
-            sqrtCorrAreas[i] = sqrt(corrAreaData[i]);
-            sqrtVertAreas[i] = sqrt(sqrtVertAreas[i]);
-        }
-        vertAreas = corrAreaData;
-    } else {
-        mySurf->computeNodeAreas(areaData);
-        vertAreas = areaData.data();
+        myGradient.grabNew(new MetricGradientObject(mySurf, (myRoi == NULL ? NULL : myRoi->getValuePointerForColumn(0)), myAvgNormals, corrAreaData));
     }
-    const float* myCoords = mySurf->getCoordinateData();
-    bool haveWarned = false, haveFailed = false;//print warning or failure messages only once
+    vector<int32_t> columnList;
     if (myColumn == -1)
     {
-        myMetricOut->setNumberOfNodesAndColumns(numNodes, numColumns);
-        myMetricOut->setStructure(mySurf->getStructure());
-        float* myVecScratch = NULL;
-        if (myVectorsOut != NULL)
-        {
-            myVectorsOut->setNumberOfNodesAndColumns(numNodes, numColumns * 3);
-            myVectorsOut->setStructure(mySurf->getStructure());
-            myVecScratch = new float[numNodes * 3];
-        }
-        float* myScratch = new float[numNodes];
         for (int32_t col = 0; col < numColumns; ++col)
         {
-            const float* myRoiColumn = NULL;
-            if (myRoi != NULL)
-            {
-                if (matchRoiColumns)
-                {
-                    myRoiColumn = myRoi->getValuePointerForColumn(col);
-                } else {
-                    myRoiColumn = myRoi->getValuePointerForColumn(0);
-                }
-            }
-            const float* myMetricColumn = toProcess->getValuePointerForColumn(col);
-            myMetricOut->setColumnName(col, toProcess->getColumnName(col) + ", gradient");
-            *(myMetricOut->getPaletteColorMapping(col)) = *(toProcess->getPaletteColorMapping(col));//copy the palette settings
-            if (myVectorsOut != NULL)
-            {
-                myVectorsOut->setColumnName(col * 3, toProcess->getColumnName(col) + ", gradient vector X");
-                myVectorsOut->setColumnName(col * 3 + 1, toProcess->getColumnName(col) + ", gradient vector Y");
-                myVectorsOut->setColumnName(col * 3 + 2, toProcess->getColumnName(col) + ", gradient vector Z");
-            }
-#pragma omp CARET_PAR
-            {
-                Vector3D somevec, xhat, yhat;
-                float sanity = 0.0f;
-                CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();//this stores and reuses helpers, so it isn't really a problem to call inside the loop
-#pragma omp CARET_FOR schedule(dynamic)
-                for (int32_t i = 0; i < numNodes; ++i)
-                {
-                    if (myRoiColumn != NULL && myRoiColumn[i] <= 0.0f)
-                    {
-                        myScratch[i] = 0.0f;
-                        if (myVecScratch != NULL)
-                        {
-                            myVecScratch[i] = 0.0f;
-                            myVecScratch[i + numNodes] = 0.0f;
-                            myVecScratch[i + numNodes * 2] = 0.0f;
-                        }
-                        continue;
-                    }
-                    int32_t numNeigh;
-                    int32_t i3 = i * 3;
-                    const int32_t* myNeighbors = myTopoHelp->getNodeNeighbors(i, numNeigh);//one function call isn't that bad, most time spent is floating point math anyway
-                    Vector3D myNormal = Vector3D(myNormals + i3).normal();//should already be normalized, but just in case
-                    Vector3D myCoord = myCoords + i3;
-                    float nodeValue = myMetricColumn[i];
-                    somevec[2] = 0.0;
-                    if (abs(myNormal[0]) > abs(myNormal[1]))
-                    {//generate a vector not parallel to normal
-                        somevec[0] = 0.0;
-                        somevec[1] = 1.0;
-                    } else {
-                        somevec[0] = 1.0;
-                        somevec[1] = 0.0;
-                    }
-                    xhat = myNormal.cross(somevec).normal();
-                    yhat = myNormal.cross(xhat).normal();//xhat, yhat are orthogonal unit vectors describing a coord system with k = surface normal
-                    int neighCount = 0;//count within-roi neighbors, not simply surface neighbors
-                    if (numNeigh >= 2)
-                    {
-                        FloatMatrix myRegress = FloatMatrix::zeros(3, 4);
-                        for (int32_t j = 0; j < numNeigh; ++j)
-                        {
-                            int32_t whichNode = myNeighbors[j];
-                            int32_t whichNode3 = whichNode * 3;
-                            if (myRoiColumn == NULL || myRoiColumn[whichNode] > 0.0f)
-                            {
-                                ++neighCount;
-                                float tempf = myMetricColumn[whichNode] - nodeValue;
-                                Vector3D neighCoord = myCoords + whichNode3;
-                                somevec = neighCoord - myCoord;
-                                float origMag = somevec.length();//save the original length
-                                float unrollMag = origMag;
-                                float opposite = somevec.dot(myNormal);//check for division by close to zero
-                                if (abs(opposite) > 0.035f * origMag)//do not do unrolling on very small angles - this is ~2 degrees
-                                {
-                                    unrollMag = origMag * asin(opposite / origMag) * origMag / opposite;
-                                }
-                                if (corrAreaMetric != NULL)
-                                {
-                                    unrollMag *= (sqrtCorrAreas[i] + sqrtCorrAreas[whichNode]) / (sqrtVertAreas[i] + sqrtVertAreas[whichNode]);
-                                }
-                                float xmag = xhat.dot(somevec);//dot product to get the direction in 2d
-                                float ymag = yhat.dot(somevec);
-                                float mag2d = sqrt(xmag * xmag + ymag * ymag);//get the new magnitude, to divide out
-                                xmag *= unrollMag / mag2d;//normalize the 2d vector and multiply by unrolled length
-                                ymag *= unrollMag / mag2d;
-                                myRegress[0][0] += xmag * xmag * vertAreas[whichNode];//gather A'A and A'b sums for regression, weighted by vertex area
-                                myRegress[0][1] += xmag * ymag * vertAreas[whichNode];
-                                myRegress[0][2] += xmag * vertAreas[whichNode];
-                                myRegress[1][1] += ymag * ymag * vertAreas[whichNode];
-                                myRegress[1][2] += ymag * vertAreas[whichNode];
-                                myRegress[2][2] += vertAreas[whichNode];
-                                myRegress[0][3] += xmag * tempf * vertAreas[whichNode];
-                                myRegress[1][3] += ymag * tempf * vertAreas[whichNode];
-                                myRegress[2][3] += tempf * vertAreas[whichNode];
-                            }
-                        }
-                        if (neighCount >= 2)
-                        {
-                            myRegress[1][0] = myRegress[0][1];//complete the symmetric elements
-                            myRegress[2][0] = myRegress[0][2];
-                            myRegress[2][1] = myRegress[1][2];
-                            myRegress[2][2] += vertAreas[i];//include center (metric and coord differences will be zero, so this is all that is needed)
-                            FloatMatrix myRref = myRegress.reducedRowEchelon();
-                            somevec = xhat * myRref[0][3] + yhat * myRref[1][3];//somevec is now our surface gradient
-                            sanity = somevec[0] + somevec[1] + somevec[2];
-                        }
-                    }
-                    if (neighCount > 0 && (neighCount < 2 || sanity != sanity))
-                    {
-                        if (!haveWarned && myRoi == NULL)
-                        {//don't issue this warning with an ROI, because it is somewhat expected
-                            haveWarned = true;
-                            CaretLogWarning("WARNING: gradient calculation found a NaN/inf with regression method for at least vertex " + AString::number(i));
-                        }
-                        float xgrad = 0.0f, ygrad = 0.0f, totalWeight = 0.0f;
-                        for (int32_t j = 0; j < numNeigh; ++j)
-                        {
-                            int32_t whichNode = myNeighbors[j];
-                            int32_t whichNode3 = whichNode * 3;
-                            if (myRoiColumn == NULL || myRoiColumn[whichNode] > 0.0f)
-                            {
-                                float tempf = myMetricColumn[whichNode] - nodeValue;
-                                Vector3D neighCoord = myCoords + whichNode3;
-                                somevec = neighCoord - myCoord;
-                                float origMag = somevec.length();//save the original length
-                                float unrollMag = origMag;
-                                float opposite = somevec.dot(myNormal);//check for division by close to zero
-                                if (abs(opposite) > 0.035f * origMag)//do not do unrolling on very small angles - this is ~2 degrees
-                                {
-                                    unrollMag = origMag * asin(opposite / origMag) * origMag / opposite;
-                                }
-                                if (corrAreaMetric != NULL)
-                                {
-                                    unrollMag *= (sqrtCorrAreas[i] + sqrtCorrAreas[whichNode]) / (sqrtVertAreas[i] + sqrtVertAreas[whichNode]);
-                                }
-                                float xmag = xhat.dot(somevec);//dot product to get the direction in 2d
-                                float ymag = yhat.dot(somevec);
-                                float mag2d = sqrt(xmag * xmag + ymag * ymag);//get the new magnitude, to divide out
-                                tempf /= unrollMag * mag2d;//difference divided by distance gives point estimate of gradient magnitude, also divide by magnitude of 2d vector to normalize the next step at the same time
-                                xgrad += xmag * tempf * vertAreas[whichNode];//point estimate of gradient magnitude times normalized projected direction gives 2d estimate of gradient
-                                ygrad += ymag * tempf * vertAreas[whichNode];//average point estimates for each neighbor to estimate local gradient
-                                totalWeight += vertAreas[whichNode];
-                            }
-                        }
-                        xgrad /= totalWeight;//weighted average
-                        ygrad /= totalWeight;
-                        somevec = xhat * xgrad + yhat * ygrad;//unproject back into 3d
-                        sanity = somevec[0] + somevec[1] + somevec[2];
-                    }
-                    if (neighCount <= 0 || sanity != sanity)
-                    {
-                        if (!haveFailed && myRoiColumn == NULL)
-                        {//don't warn with an roi, they can be strange
-                            haveFailed = true;
-                            CaretLogWarning("Failed to compute gradient for at least vertex " + AString::number(i) +
-                            " with standard and fallback methods, outputting ZERO, check your surface for disconnected vertices or other strangeness");
-                        }
-                        somevec[0] = 0.0f;
-                        somevec[1] = 0.0f;
-                        somevec[2] = 0.0f;
-                    }
-                    if (myVecScratch != NULL)
-                    {
-                        myVecScratch[i] = somevec[0];//split them up far, so that they can be set to columns easily
-                        myVecScratch[numNodes + i] = somevec[1];
-                        myVecScratch[numNodes * 2 + i] = somevec[2];
-                    }
-                    myScratch[i] = MathFunctions::vectorLength(somevec);
-                }
-            }
-            if (myVectorsOut != NULL)
-            {
-                myVectorsOut->setValuesForColumn(col * 3, myVecScratch);
-                myVectorsOut->setValuesForColumn(col * 3 + 1, myVecScratch + numNodes);
-                myVectorsOut->setValuesForColumn(col * 3 + 2, myVecScratch + (numNodes * 2));
-            }
-            myMetricOut->setValuesForColumn(col, myScratch);
-            myProgress.reportProgress(((float)col + 1) / numColumns);
-        }
-        delete[] myScratch;
-        if (myVecScratch != NULL)
-        {
-            delete[] myVecScratch;
+            columnList.push_back(col);
         }
     } else {
-        myMetricOut->setNumberOfNodesAndColumns(numNodes, 1);
-        myMetricOut->setStructure(mySurf->getStructure());
-        float* myVecScratch = NULL;
-        if (myVectorsOut != NULL)
-        {
-            myVectorsOut->setNumberOfNodesAndColumns(numNodes, 3);
-            myVectorsOut->setStructure(mySurf->getStructure());
-            myVectorsOut->setColumnName(0, toProcess->getColumnName(useColumn) + ", gradient vector X");
-            myVectorsOut->setColumnName(1, toProcess->getColumnName(useColumn) + ", gradient vector Y");
-            myVectorsOut->setColumnName(2, toProcess->getColumnName(useColumn) + ", gradient vector Z");
-            myVecScratch = new float[numNodes * 3];
+        columnList.push_back(useColumn);
+    }
+    int32_t numOutColumns = (int32_t)columnList.size();
+    myMetricOut->setNumberOfNodesAndColumns(numNodes, numOutColumns);
+    myMetricOut->setStructure(mySurf->getStructure());
+    vector<float> myVecScratch;
+    if (myVectorsOut != NULL)
+    {
+        myVectorsOut->setNumberOfNodesAndColumns(numNodes, numOutColumns * 3);
+        myVectorsOut->setStructure(mySurf->getStructure());
+        myVecScratch.resize(numNodes * 3);
+    }
+    vector<float> myScratch(numNodes);
+    bool haveFailed = false;//print failure message only once
+    for (int32_t outCol = 0; outCol < numOutColumns; ++outCol)
+    {
+        int32_t col = columnList[outCol];
+        if (myRoi != NULL && matchRoiColumns)
+        {//use the ORIGINAL column number, not the one that has been modified due to a presmoothing step that generated a new single column metric
+            int32_t roiColumn = (myColumn == -1 ? col : myColumn);
+            myGradient.grabNew(new MetricGradientObject(mySurf, myRoi->getValuePointerForColumn(roiColumn), myAvgNormals, corrAreaData));
         }
-        float* myScratch = new float[numNodes];
-        const float* myRoiColumn = NULL;
-        if (myRoi != NULL)
+        myMetricOut->setColumnName(outCol, toProcess->getColumnName(col) + ", gradient");
+        *(myMetricOut->getPaletteColorMapping(outCol)) = *(toProcess->getPaletteColorMapping(col));//copy the palette settings
+        if (myVectorsOut != NULL)
         {
-            if (matchRoiColumns)
-            {
-                myRoiColumn = myRoi->getValuePointerForColumn(myColumn);//use the ORIGINAL column number, not the one that has been modified due to a presmoothing step that generated a new single column metric
-            } else {
-                myRoiColumn = myRoi->getValuePointerForColumn(0);
-            }
+            myVectorsOut->setColumnName(outCol * 3, toProcess->getColumnName(col) + ", gradient vector X");
+            myVectorsOut->setColumnName(outCol * 3 + 1, toProcess->getColumnName(col) + ", gradient vector Y");
+            myVectorsOut->setColumnName(outCol * 3 + 2, toProcess->getColumnName(col) + ", gradient vector Z");
         }
-        const float* myMetricColumn = toProcess->getValuePointerForColumn(useColumn);
-        myMetricOut->setColumnName(0, toProcess->getColumnName(useColumn) + ", gradient");
-        *(myMetricOut->getPaletteColorMapping(0)) = *(toProcess->getPaletteColorMapping(useColumn));//copy the palette settings
-#pragma omp CARET_PAR
-        {
-            Vector3D somevec, xhat, yhat;
-            float sanity = 0.0f;
-            CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();
-#pragma omp CARET_FOR schedule(dynamic)
-            for (int32_t i = 0; i < numNodes; ++i)
-            {
-                if (myRoiColumn != NULL && myRoiColumn[i] <= 0.0f)
-                {
-                    myScratch[i] = 0.0f;
-                    if (myVecScratch != NULL)
-                    {
-                        myVecScratch[i] = 0.0f;
-                        myVecScratch[i + numNodes] = 0.0f;
-                        myVecScratch[i + numNodes * 2] = 0.0f;
-                    }
-                    continue;
-                }
-                int32_t numNeigh;
-                int32_t i3 = i * 3;
-                const int32_t* myNeighbors = myTopoHelp->getNodeNeighbors(i, numNeigh);
-                Vector3D myNormal = Vector3D(myNormals + i3).normal();//should already be normalized, but just in case
-                Vector3D myCoord = myCoords + i3;
-                float nodeValue = myMetricColumn[i];
-                somevec[2] = 0.0;
-                if (myNormal[0] > myNormal[1])
-                {//generate a vector not parallel to normal
-                    somevec[0] = 0.0;
-                    somevec[1] = 1.0;
-                } else {
-                    somevec[0] = 1.0;
-                    somevec[1] = 0.0;
-                }
-                xhat = myNormal.cross(somevec).normal();
-                yhat = myNormal.cross(xhat).normal();//xhat, yhat are orthogonal unit vectors describing a coord system with k = surface normal
-                int neighCount = 0;//count within-roi neighbors, not simply surface neighbors
-                if (numNeigh >= 2)
-                {
-                    FloatMatrix myRegress = FloatMatrix::zeros(3, 4);
-                    for (int32_t j = 0; j < numNeigh; ++j)
-                    {
-                        int32_t whichNode = myNeighbors[j];
-                        int32_t whichNode3 = whichNode * 3;
-                        if (myRoiColumn == NULL || myRoiColumn[whichNode] > 0.0f)
-                        {
-                            ++neighCount;
-                            float tempf = myMetricColumn[whichNode] - nodeValue;
-                            Vector3D neighCoord = myCoords + whichNode3;
-                            somevec = neighCoord - myCoord;
-                            float origMag = somevec.length();//save the original length
-                            float unrollMag = origMag;
-                            float opposite = somevec.dot(myNormal);//check for division by close to zero
-                            if (abs(opposite) > 0.035f * origMag)//do not do unrolling on very small angles - this is ~2 degrees
-                            {
-                                unrollMag = origMag * asin(opposite / origMag) * origMag / opposite;
-                            }
-                            if (corrAreaMetric != NULL)
-                            {
-                                unrollMag *= (sqrtCorrAreas[i] + sqrtCorrAreas[whichNode]) / (sqrtVertAreas[i] + sqrtVertAreas[whichNode]);
-                            }
-                            float xmag = xhat.dot(somevec);//dot product to get the direction in 2d
-                            float ymag = yhat.dot(somevec);
-                            float mag2d = sqrt(xmag * xmag + ymag * ymag);//get the new magnitude, to divide out
-                            xmag *= unrollMag / mag2d;//normalize the 2d vector and multiply by unrolled length
-                            ymag *= unrollMag / mag2d;
-                            myRegress[0][0] += xmag * xmag * vertAreas[whichNode];//gather A'A and A'b sums for regression, weighted by vertex area
-                            myRegress[0][1] += xmag * ymag * vertAreas[whichNode];
-                            myRegress[0][2] += xmag * vertAreas[whichNode];
-                            myRegress[1][1] += ymag * ymag * vertAreas[whichNode];
-                            myRegress[1][2] += ymag * vertAreas[whichNode];
-                            myRegress[2][2] += vertAreas[whichNode];
-                            myRegress[0][3] += xmag * tempf * vertAreas[whichNode];
-                            myRegress[1][3] += ymag * tempf * vertAreas[whichNode];
-                            myRegress[2][3] += tempf * vertAreas[whichNode];
-                        }
-                    }
-                    if (neighCount >= 2)
-                    {
-                        myRegress[1][0] = myRegress[0][1];//complete the symmetric elements
-                        myRegress[2][0] = myRegress[0][2];
-                        myRegress[2][1] = myRegress[1][2];
-                        myRegress[2][2] += vertAreas[i];//include center (metric and coord differences will be zero, so this is all that is needed)
-                        FloatMatrix myRref = myRegress.reducedRowEchelon();
-                        somevec = xhat * myRref[0][3] + yhat * myRref[1][3];//somevec is now our surface gradient
-                        sanity = somevec[0] + somevec[1] + somevec[2];
-                    }
-                }
-                if (neighCount > 0 && (neighCount < 2 || sanity != sanity))
-                {
-                    if (!haveWarned && myRoi == NULL)
-                    {//don't issue this warning with an ROI, because it is somewhat expected
-                        haveWarned = true;
-                        CaretLogWarning("WARNING: gradient calculation found a NaN/inf with regression method for at least vertex " + AString::number(i));
-                    }
-                    float xgrad = 0.0f, ygrad = 0.0f, totalWeight = 0.0f;
-                    for (int32_t j = 0; j < numNeigh; ++j)
-                    {
-                        int32_t whichNode = myNeighbors[j];
-                        int32_t whichNode3 = whichNode * 3;
-                        if (myRoiColumn == NULL || myRoiColumn[whichNode] > 0.0f)
-                        {
-                            float tempf = myMetricColumn[whichNode] - nodeValue;
-                            Vector3D neighCoord = myCoords + whichNode3;
-                            somevec = neighCoord - myCoord;
-                            float origMag = somevec.length();//save the original length
-                            float unrollMag = origMag;
-                            float opposite = somevec.dot(myNormal);//check for division by close to zero
-                            if (abs(opposite) > 0.035f * origMag)//do not do unrolling on very small angles - this is ~2 degrees
-                            {
-                                unrollMag = origMag * asin(opposite / origMag) * origMag / opposite;
-                            }
-                            if (corrAreaMetric != NULL)
-                            {
-                                unrollMag *= (sqrtCorrAreas[i] + sqrtCorrAreas[whichNode]) / (sqrtVertAreas[i] + sqrtVertAreas[whichNode]);
-                            }
-                            float xmag = xhat.dot(somevec);//dot product to get the direction in 2d
-                            float ymag = yhat.dot(somevec);
-                            float mag2d = sqrt(xmag * xmag + ymag * ymag);//get the new magnitude, to divide out
-                            tempf /= unrollMag * mag2d;//difference divided by distance gives point estimate of gradient magnitude, also divide by magnitude of 2d vector to normalize the next step at the same time
-                            xgrad += xmag * tempf * vertAreas[whichNode];//point estimate of gradient magnitude times normalized projected direction gives 2d estimate of gradient
-                            ygrad += ymag * tempf * vertAreas[whichNode];//average point estimates for each neighbor to estimate local gradient
-                            totalWeight += vertAreas[whichNode];
-                        }
-                    }
-                    xgrad /= totalWeight;//weighted average
-                    ygrad /= totalWeight;
-                    somevec = xhat * xgrad + yhat * ygrad;//unproject back into 3d
-                    sanity = somevec[0] + somevec[1] + somevec[2];
-                }
-                if (neighCount <= 0 || sanity != sanity)
-                {
-                    if (!haveFailed && myRoiColumn == NULL)
-                    {//don't warn with an roi, they can be strange
-                        haveFailed = true;
-                        CaretLogWarning("Failed to compute gradient for at least vertex " + AString::number(i) +
-                            " with standard and fallback methods, outputting ZERO, check your surface for disconnected vertices or other strangeness");
-                    }
-                    somevec[0] = 0.0f;
-                    somevec[1] = 0.0f;
-                    somevec[2] = 0.0f;
-                }
-                if (myVecScratch != NULL)
-                {
-                    myVecScratch[i] = somevec[0];//split them up far, so that they can be set to columns easily
-                    myVecScratch[numNodes + i] = somevec[1];
-                    myVecScratch[numNodes * 2 + i] = somevec[2];
-                }
-                myScratch[i] = MathFunctions::vectorLength(somevec);
-            }
+        bool allNumeric = myGradient->gradientColumn(toProcess->getValuePointerForColumn(col), myScratch.data(), (myVectorsOut == NULL ? NULL : myVecScratch.data()));
+        if (!allNumeric && !haveFailed && myRoi == NULL)
+        {//don't warn with an roi, they can be strange
+            haveFailed = true;
+            CaretLogWarning("Failed to compute gradient for at least one vertex, outputting ZERO, check your input for NaN/inf values");
         }
         if (myVectorsOut != NULL)
         {
-            myVectorsOut->setValuesForColumn(0, myVecScratch);
-            myVectorsOut->setValuesForColumn(1, myVecScratch + numNodes);
-            myVectorsOut->setValuesForColumn(2, myVecScratch + (numNodes * 2));
-        }
-        myMetricOut->setValuesForColumn(0, myScratch);
-        delete[] myScratch;
-        if (myVecScratch != NULL)
-        {
-            delete[] myVecScratch;
+            myVectorsOut->setValuesForColumn(outCol * 3, myVecScratch.data());
+            myVectorsOut->setValuesForColumn(outCol * 3 + 1, myVecScratch.data() + numNodes);
+            myVectorsOut->setValuesForColumn(outCol * 3 + 2, myVecScratch.data() + (numNodes * 2));
         }
+        myMetricOut->setValuesForColumn(outCol, myScratch.data());
+        myProgress.reportProgress(((float)outCol + 1) / numOutColumns);
     }
 }
 
+
 float AlgorithmMetricGradient::getAlgorithmInternalWeight()
 {
     return 1.0f;//override this if needed, if the progress bar isn't smooth
@@ -24,6 +24,7 @@
 #include "MetricFile.h"
 #include "ReductionOperation.h"
 
+#include <algorithm>
 #include <vector>
 
 using namespace caret;
@@ -93,18 +94,23 @@ AlgorithmMetricReduce::AlgorithmMetricReduce(ProgressObject* myProgObj, const Me
     metricOut->setNumberOfNodesAndColumns(numNodes, 1);
     metricOut->setStructure(metricIn->getStructure());
     metricOut->setColumnName(0, ReductionEnum::toName(myReduce));
-    vector<float> scratch(numCols);
-    for (int node = 0; node < numNodes; ++node)
+    const int blockNodes = max(1, (1<<22) / numCols);//gather a block of vertices into contiguous rows, then reduce them in parallel
+    vector<float> scratch(min(blockNodes, numNodes) * (int64_t)numCols), results(min(blockNodes, numNodes));
+    for (int start = 0; start < numNodes; start += blockNodes)
     {
+        int count = min(blockNodes, numNodes - start);
         for (int col = 0; col < numCols; ++col)
         {
-            scratch[col] = metricIn->getValue(node, col);
+            const float* colData = metricIn->getValuePointerForColumn(col);
+            for (int i = 0; i < count; ++i)
+            {
+                scratch[i * (int64_t)numCols + col] = colData[start + i];
+            }
         }
-        if (onlyNumeric)
+        ReductionOperation::reduceRows(scratch.data(), count, numCols, myReduce, results.data(), onlyNumeric);
+        for (int i = 0; i < count; ++i)
         {
-            metricOut->setValue(node, 0, ReductionOperation::reduceOnlyNumeric(scratch.data(), numCols, myReduce));
-        } else {
-            metricOut->setValue(node, 0, ReductionOperation::reduce(scratch.data(), numCols, myReduce));
+            metricOut->setValue(start + i, 0, results[i]);
         }
     }
 }
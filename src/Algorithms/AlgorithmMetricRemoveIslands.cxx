@@ -21,11 +21,13 @@
 #include "AlgorithmMetricRemoveIslands.h"
 #include "AlgorithmException.h"
 
+#include "CaretConnectedComponents.h"
+#include "CaretOMP.h"
 #include "MetricFile.h"
 #include "SurfaceFile.h"
 #include "TopologyHelper.h"
 
-#include <utility>
+#include <algorithm>
 #include <vector>
 
 using namespace caret;
@@ -73,6 +75,48 @@ void AlgorithmMetricRemoveIslands::useParameters(OperationParameters* myParams,
     AlgorithmMetricRemoveIslands(myProgObj, mySurf, myMetric, myMetricOut, corrAreaMetric);
 }
 
+namespace
+{
+    void removeColumnIslands(const float* roiData, const float* areaData, const int& numNodes, const vector<int64_t>& adjStart, const vector<int32_t>& adjNeighbors,
+                             CaretConnectedComponents& myComponents, float* outData)
+    {
+        vector<char> mask(numNodes);
+        for (int i = 0; i < numNodes; ++i)
+        {
+            mask[i] = (roiData[i] > 0.0f ? 1 : 0);
+        }
+        vector<int64_t> labels;
+        int64_t numAreas = myComponents.labelGraph(adjStart.data(), adjNeighbors.data(), numNodes, mask.data(), labels);
+        vector<float> areas(numAreas, 0.0f);
+        for (int i = 0; i < numNodes; ++i)
+        {
+            if (labels[i] >= 0) areas[labels[i]] += areaData[i];
+        }
+        for (int i = 0; i < numNodes; ++i)
+        {
+            outData[i] = 0.0f;
+        }
+        if (numAreas > 0)
+        {
+            int64_t bestIndex = 0;
+            float bestArea = areas[0];
+            for (int64_t i = 1; i < numAreas; ++i)
+            {
+                float thisArea = (int)areas[i];
+                if (thisArea > bestArea)
+                {
+                    bestIndex = i;
+                    bestArea = thisArea;
+                }
+            }
+            for (int i = 0; i < numNodes; ++i)
+            {
+                if (labels[i] == bestIndex) outData[i] = 1.0f;//make it into a simple 0/1 metric, even if it wasn't before
+            }
+        }
+    }
+}
+
 AlgorithmMetricRemoveIslands::AlgorithmMetricRemoveIslands(ProgressObject* myProgObj, const SurfaceFile* mySurf, const MetricFile* myMetric,
                                                            MetricFile* myMetricOut, const MetricFile* corrAreaMetric) : AbstractAlgorithm(myProgObj)
 {
@@ -89,71 +133,33 @@ AlgorithmMetricRemoveIslands::AlgorithmMetricRemoveIslands(ProgressObject* myPro
         mySurf->computeNodeAreas(surfAreaData);
         areaData = surfAreaData.data();
     }
+    vector<int64_t> adjStart;
+    vector<int32_t> adjNeighbors;
+    mySurf->getTopologyHelper()->getNeighborAdjacency(adjStart, adjNeighbors);
     int numCols = myMetric->getNumberOfColumns();
     myMetricOut->setNumberOfNodesAndColumns(numNodes, numCols);
     myMetricOut->setStructure(myMetric->getStructure());
-    for (int col = 0; col < numCols; ++col)
+    int batchSize = 1;
+#ifdef CARET_OMP
+    batchSize = omp_get_max_threads();
+#endif
+    batchSize = max(1, min(batchSize, numCols));
+    vector<CaretConnectedComponents> myComponents(batchSize);
+    vector<vector<float> > batchOut(batchSize, vector<float>(numNodes));
+    for (int batchStart = 0; batchStart < numCols; batchStart += batchSize)
     {
-        vector<pair<float, vector<int> > > areas;
-        vector<int> used(numNodes, 0);
-        CaretPointer<TopologyHelper> myHelp = mySurf->getTopologyHelper();
-        const float* roiData = myMetric->getValuePointerForColumn(col);
-        myMetricOut->setColumnName(col, myMetric->getColumnName(col));
-        for (int i = 0; i < numNodes; ++i)
+        int batchEnd = min(numCols, batchStart + batchSize);
+#pragma omp CARET_PARFOR schedule(dynamic)
+        for (int col = batchStart; col < batchEnd; ++col)
         {
-            if (used[i] == 0 && roiData[i] > 0.0f)
-            {
-                areas.push_back(make_pair(0.0f, vector<int>()));
-                vector<int>& thisAreaMembers = areas.back().second;
-                float& thisSurfArea = areas.back().first;
-                thisAreaMembers.push_back(i);
-                thisSurfArea += areaData[i];
-                used[i] = 1;
-                vector<int> mystack;
-                mystack.push_back(i);
-                while (!mystack.empty())
-                {
-                    int curnode = mystack.back();
-                    mystack.pop_back();
-                    const vector<int32_t>& neighbors = myHelp->getNodeNeighbors(curnode);
-                    int numNeigh = (int)neighbors.size();
-                    for (int j = 0; j < numNeigh; ++j)
-                    {
-                        int thisneigh = neighbors[j];
-                        if (used[thisneigh] == 0 && roiData[thisneigh] > 0.0f)
-                        {
-                            used[thisneigh] = 1;
-                            thisAreaMembers.push_back(thisneigh);
-                            thisSurfArea += areaData[thisneigh];
-                            mystack.push_back(thisneigh);
-                        }
-                    }
-                }
-            }
+            int slot = col - batchStart;
+            removeColumnIslands(myMetric->getValuePointerForColumn(col), areaData, numNodes, adjStart, adjNeighbors, myComponents[slot], batchOut[slot].data());
         }
-        vector<float> outscratch(numNodes, 0.0f);
-        int numAreas = (int)areas.size();
-        if (numAreas > 0)
+        for (int col = batchStart; col < batchEnd; ++col)
         {
-            int bestIndex = 0;
-            float bestArea = areas[0].first;
-            for (int i = 1; i < numAreas; ++i)
-            {
-                float thisArea = (int)areas[i].first;
-                if (thisArea > bestArea)
-                {
-                    bestIndex = i;
-                    bestArea = thisArea;
-                }
-            }
-            const vector<int>& thisArea = areas[bestIndex].second;
-            int numAreaNodes = (int)thisArea.size();
-            for (int i = 0; i < numAreaNodes; ++i)
-            {
-                outscratch[thisArea[i]] = 1.0f;//make it into a simple 0/1 metric, even if it wasn't before
-            }
+            myMetricOut->setColumnName(col, myMetric->getColumnName(col));
+            myMetricOut->setValuesForColumn(col, batchOut[col - batchStart].data());
         }
-        myMetricOut->setValuesForColumn(col, outscratch.data());
     }
 }
 
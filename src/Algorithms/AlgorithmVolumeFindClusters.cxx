@@ -22,12 +22,15 @@
 #include "AlgorithmException.h"
 
 #include "CaretAssert.h"
+#include "CaretConnectedComponents.h"
 #include "CaretLogger.h"
+#include "CaretOMP.h"
 #include "CaretPointer.h"
 #include "CaretPointLocator.h"
 #include "VolumeFile.h"
 #include "VoxelIJK.h"
 
+#include <algorithm>
 #include <cmath>
 #include <vector>
 
@@ -136,23 +139,24 @@ void AlgorithmVolumeFindClusters::useParameters(OperationParameters* myParams, P
 
 namespace
 {
-    void processSubvol(const float* inFrame, VolumeFile* volOut, const int64_t& outSubvol, const int64_t& outComponent, const float& threshValue, const float& minVolume,
-                       const bool& lessThan, const float* roiFrame, const float& sizeRatio, const float& distanceCutoff, int& markVal)
+    struct FrameInfo
     {
-        vector<int64_t> dims = volOut->getDimensions();
+        int64_t inSubvol, outSubvol, component;
+        FrameInfo(const int64_t& inSubvolIn, const int64_t& outSubvolIn, const int64_t& componentIn) : inSubvol(inSubvolIn), outSubvol(outSubvolIn), component(componentIn) { }
+    };
+    
+    VoxelIJK indexToIJK(const int64_t& index, const int64_t dims[3])
+    {
+        return VoxelIJK(index % dims[0], (index / dims[0]) % dims[1], index / (dims[0] * dims[1]));
+    }
+    
+    ///finds the clusters to keep in one frame, as voxel indexes, in marking order
+    void findFrameClusters(const float* inFrame, const VolumeSpace& mySpace, const int64_t& minVoxels, const float& threshValue, const bool& lessThan, const float* roiFrame,
+                           const float& sizeRatio, const float& distanceCutoff, CaretConnectedComponents& myComponents, vector<vector<int64_t> >& clusters)
+    {
+        clusters.clear();
+        const int64_t* dims = mySpace.getDims();
         int64_t frameSize = dims[0] * dims[1] * dims[2];
-        const VolumeSpace& mySpace = volOut->getVolumeSpace();
-        Vector3D ivec, jvec, kvec, origin;
-        mySpace.getSpacingVectors(ivec, jvec, kvec, origin);
-        float voxelVolume = abs(ivec.dot(jvec.cross(kvec)));
-        int64_t minVoxels = (int64_t)ceil(minVolume / voxelVolume);
-        vector<VoxelIJK> neighbors;
-        neighbors.push_back(VoxelIJK(1, 0, 0));
-        neighbors.push_back(VoxelIJK(-1, 0, 0));
-        neighbors.push_back(VoxelIJK(0, 1, 0));
-        neighbors.push_back(VoxelIJK(0, -1, 0));
-        neighbors.push_back(VoxelIJK(0, 0, 1));
-        neighbors.push_back(VoxelIJK(0, 0, -1));
         vector<char> marked(frameSize, 0);
         if (lessThan)
         {
@@ -172,51 +176,35 @@ namespace
                 }
             }
         }
-        vector<vector<VoxelIJK> > clusters;
+        vector<int64_t> labels;
+        int64_t numComponents = myComponents.labelVolume(dims, marked.data(), labels);
+        vector<int64_t> counts(numComponents, 0);
+        for (int64_t i = 0; i < frameSize; ++i)
+        {
+            if (labels[i] >= 0) ++counts[labels[i]];
+        }
+        vector<int64_t> keepIndex(numComponents, -1);//components are numbered by lowest voxel index, the same order the flood fill used to find them
         size_t biggestCount = 0;
         int64_t biggestCluster = -1;
-        for (int64_t k = 0; k < dims[2]; ++k)
+        for (int64_t i = 0; i < numComponents; ++i)
         {
-            for (int64_t j = 0; j < dims[1]; ++j)
+            if (counts[i] >= minVoxels)
             {
-                for (int64_t i = 0; i < dims[0]; ++i)
+                if ((size_t)counts[i] > biggestCount)
                 {
-                    int64_t myIndex = mySpace.getIndex(i, j, k);
-                    if (marked[myIndex])
-                    {
-                        vector<VoxelIJK> voxelList;
-                        voxelList.push_back(VoxelIJK(i, j, k));
-                        marked[myIndex] = 0;//don't let voxels get duplicated in the list
-                        for (int64_t index = 0; index < (int64_t)voxelList.size(); ++index)//NOTE: vector grows inside loop
-                        {
-                            const VoxelIJK& thisVoxel = voxelList[index];
-                            for (int n = 0; n < (int)neighbors.size(); ++n)
-                            {
-                                VoxelIJK neighVox(thisVoxel.m_ijk[0] + neighbors[n].m_ijk[0],
-                                                    thisVoxel.m_ijk[1] + neighbors[n].m_ijk[1],
-                                                    thisVoxel.m_ijk[2] + neighbors[n].m_ijk[2]);
-                                if (mySpace.indexValid(neighVox.m_ijk))
-                                {
-                                    int64_t neighIndex = mySpace.getIndex(neighVox.m_ijk);
-                                    if (marked[neighIndex])
-                                    {
-                                        voxelList.push_back(neighVox);
-                                        marked[neighIndex] = 0;
-                                    }
-                                }
-                            }
-                        }
-                        if ((int64_t)voxelList.size() >= minVoxels)
-                        {
-                            if (voxelList.size() > biggestCount)
-                            {
-                                biggestCount = voxelList.size();
-                                biggestCluster = (int64_t)clusters.size();
-                            }
-                            clusters.push_back(voxelList);
-                        }
-                    }
+                    biggestCount = counts[i];
+                    biggestCluster = (int64_t)clusters.size();
                 }
+                keepIndex[i] = (int64_t)clusters.size();
+                clusters.push_back(vector<int64_t>());
+                clusters.back().reserve(counts[i]);
+            }
+        }
+        for (int64_t i = 0; i < frameSize; ++i)
+        {
+            if (labels[i] >= 0 && keepIndex[labels[i]] != -1)
+            {
+                clusters[keepIndex[labels[i]]].push_back(i);
             }
         }
         if (!clusters.empty()) CaretAssert(biggestCluster != -1);
@@ -230,7 +218,7 @@ namespace
                 for (size_t i = 0; i < clusters[biggestCluster].size(); ++i)
                 {
                     float thisCoord[3];
-                    mySpace.indexToSpace(clusters[biggestCluster][i].m_ijk, thisCoord);
+                    mySpace.indexToSpace(indexToIJK(clusters[biggestCluster][i], dims).m_ijk, thisCoord);
                     biggestCoords.push_back(thisCoord[0]);
                     biggestCoords.push_back(thisCoord[1]);
                     biggestCoords.push_back(thisCoord[2]);
@@ -252,7 +240,7 @@ namespace
                         for (size_t j = 0; j < clusters[i].size(); ++j)
                         {
                             float thisCoord[3];
-                            mySpace.indexToSpace(clusters[i][j].m_ijk, thisCoord);
+                            mySpace.indexToSpace(indexToIJK(clusters[i][j], dims).m_ijk, thisCoord);
                             int32_t ret = myLocator->closestPointLimited(thisCoord, distanceCutoff);
                             if (ret == -1)
                             {
@@ -270,6 +258,11 @@ namespace
                 }
             }
         }
+    }
+    
+    void markClusters(const vector<vector<int64_t> >& clusters, VolumeFile* volOut, const int64_t& outSubvol, const int64_t& outComponent, int& markVal)
+    {
+        const int64_t* dims = volOut->getVolumeSpace().getDims();
         for (size_t i = 0; i < clusters.size(); ++i)
         {
             if (markVal == 0)
@@ -281,7 +274,7 @@ namespace
             if ((int)tempVal != markVal) throw AlgorithmException("too many clusters, unable to mark them uniquely");
             for (size_t index = 0; index < clusters[i].size(); ++index)
             {
-                volOut->setValue(tempVal, clusters[i][index].m_ijk, outSubvol, outComponent);
+                volOut->setValue(tempVal, indexToIJK(clusters[i][index], dims).m_ijk, outSubvol, outComponent);
             }
             ++markVal;
         }
@@ -305,28 +298,53 @@ AlgorithmVolumeFindClusters::AlgorithmVolumeFindClusters(ProgressObject* myProgO
         roiFrame = myRoi->getFrame();
     }
     vector<int64_t> dims = volIn->getDimensions();
-    int markVal = startVal;
+    Vector3D ivec, jvec, kvec, origin;
+    mySpace.getSpacingVectors(ivec, jvec, kvec, origin);
+    float voxelVolume = abs(ivec.dot(jvec.cross(kvec)));
+    int64_t minVoxels = (int64_t)ceil(minVolume / voxelVolume);
+    vector<FrameInfo> frameList;//in marking order
     if (subvolNum == -1)
     {
         volOut->reinitialize(volIn->getOriginalDimensions(), volIn->getSform(), dims[4], SubvolumeAttributes::ANATOMY, volIn->m_header);
-        volOut->setValueAllVoxels(0.0f);
         for (int64_t c = 0; c < dims[4]; ++c)
         {
             for (int64_t s = 0; s < dims[3]; ++s)
             {
-                const float* inFrame = volIn->getFrame(s, c);
-                processSubvol(inFrame, volOut, s, c, threshValue, minVolume, lessThan, roiFrame, sizeRatio, distanceCutoff, markVal);
+                frameList.push_back(FrameInfo(s, s, c));
             }
         }
     } else {
         vector<int64_t> outDims = volIn->getOriginalDimensions();
         outDims.resize(3);
         volOut->reinitialize(outDims, volIn->getSform(), dims[4], SubvolumeAttributes::ANATOMY, volIn->m_header);
-        volOut->setValueAllVoxels(0.0f);
         for (int64_t c = 0; c < dims[4]; ++c)
         {
-            const float* inFrame = volIn->getFrame(subvolNum, c);
-            processSubvol(inFrame, volOut, 0, c, threshValue, minVolume, lessThan, roiFrame, sizeRatio, distanceCutoff, markVal);
+            frameList.push_back(FrameInfo(subvolNum, 0, c));
+        }
+    }
+    volOut->setValueAllVoxels(0.0f);
+    int batchSize = 1;//frames are clustered in parallel batches, then marked in order so numbering doesn't depend on threading
+#ifdef CARET_OMP
+    batchSize = omp_get_max_threads();
+#endif
+    batchSize = max(1, min(batchSize, (int)frameList.size()));
+    vector<CaretConnectedComponents> myComponents(batchSize);
+    vector<vector<vector<int64_t> > > batchClusters(batchSize);
+    int markVal = startVal;
+    int64_t numFrames = (int64_t)frameList.size();
+    for (int64_t batchStart = 0; batchStart < numFrames; batchStart += batchSize)
+    {
+        int64_t batchEnd = min(numFrames, batchStart + batchSize);
+#pragma omp CARET_PARFOR schedule(dynamic) if (batchEnd - batchStart > 1)
+        for (int64_t frame = batchStart; frame < batchEnd; ++frame)
+        {
+            int64_t slot = frame - batchStart;
+            const float* inFrame = volIn->getFrame(frameList[frame].inSubvol, frameList[frame].component);
+            findFrameClusters(inFrame, mySpace, minVoxels, threshValue, lessThan, roiFrame, sizeRatio, distanceCutoff, myComponents[slot], batchClusters[slot]);
+        }
+        for (int64_t frame = batchStart; frame < batchEnd; ++frame)
+        {
+            markClusters(batchClusters[frame - batchStart], volOut, frameList[frame].outSubvol, frameList[frame].component, markVal);
         }
     }
     if (endVal != NULL) *endVal = markVal;
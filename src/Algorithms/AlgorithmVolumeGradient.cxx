@@ -29,6 +29,9 @@
 
 #include <algorithm>
 #include <cmath>
+#include <map>
+#include <utility>
+#include <vector>
 
 using namespace caret;
 using namespace std;
@@ -110,6 +113,182 @@ void AlgorithmVolumeGradient::useParameters(OperationParameters* myParams, Progr
     AlgorithmVolumeGradient(myProgObj, volIn, volOut, presmooth, myRoi, vectorsOut, subvolNum);
 }
 
+namespace
+{
+    ///the gradient at a voxel as weights on the values in its 3x3x3 neighborhood, position is (di + 1) + 3 * (dj + 1) + 9 * (dk + 1)
+    ///because the regression only depends on the voxel spacing and which neighbors are usable, voxels with the same neighbor pattern share a stencil
+    struct GradientStencil
+    {
+        vector<int> m_positions;
+        vector<Vector3D> m_weights;
+    };
+    
+    const int CENTER_POSITION = 13;
+    const int FACE_POSITIONS[6] = { 22, 4, 16, 10, 14, 12 };//+k, -k, +j, -j, +i, -i, ordering is used to map neighbor to direction
+    const uint32_t FACE_MASK = (1u << 22) | (1u << 4) | (1u << 16) | (1u << 10) | (1u << 14) | (1u << 12);
+    
+    Vector3D positionToDir(const int position)
+    {
+        return Vector3D(position % 3 - 1, (position / 3) % 3 - 1, position / 9 - 1);
+    }
+    
+    int faceDirCheck(const uint32_t available)
+    {
+        int dircheck = 0;
+        for (int n = 0; n < 6; ++n)
+        {
+            if (available & (1u << FACE_POSITIONS[n])) dircheck |= 1<<(2 - (n / 2));//bit 0 is i, bit 1 is j, bit 2 is k
+        }
+        return dircheck;
+    }
+    
+    ///affine regression over the center and the given neighbors, solved with the neighbor displacements as right hand sides, so the result multiplies value differences
+    bool solveRegression(const vector<int>& positions, const Vector3D& ivec, const Vector3D& jvec, const Vector3D& kvec, GradientStencil& stencilOut)
+    {
+        int numUsed = (int)positions.size();
+        FloatMatrix regress = FloatMatrix::zeros(4, 4 + numUsed);
+        regress[3][3] = 1;//count the center voxel in case neighbors are missing (displacement and valdiff are zero, cancelling all other terms)
+        for (int n = 0; n < numUsed; ++n)
+        {
+            Vector3D voxelDir = positionToDir(positions[n]);
+            Vector3D displacement = ivec * voxelDir[0] + jvec * voxelDir[1] + kvec * voxelDir[2];
+            regress[0][0] += displacement[0] * displacement[0];
+            regress[0][1] += displacement[0] * displacement[1];
+            regress[0][2] += displacement[0] * displacement[2];
+            regress[0][3] += displacement[0];
+            regress[1][1] += displacement[1] * displacement[1];
+            regress[1][2] += displacement[1] * displacement[2];
+            regress[1][3] += displacement[1];
+            regress[2][2] += displacement[2] * displacement[2];
+            regress[2][3] += displacement[2];
+            regress[3][3] += 1;
+            regress[0][4 + n] = displacement[0];
+            regress[1][4 + n] = displacement[1];
+            regress[2][4 + n] = displacement[2];
+            regress[3][4 + n] = 1;
+        }
+        regress[1][0] = regress[0][1];//finish the symmetric part of the matrix
+        regress[2][0] = regress[0][2];
+        regress[2][1] = regress[1][2];
+        regress[3][0] = regress[0][3];
+        regress[3][1] = regress[1][3];
+        regress[3][2] = regress[2][3];
+        FloatMatrix result = regress.reducedRowEchelon();
+        Vector3D centerWeight;
+        for (int n = 0; n < numUsed; ++n)
+        {
+            Vector3D weight(result[0][4 + n], result[1][4 + n], result[2][4 + n]);//row 3 is the constant part of the regression
+            stencilOut.m_positions.push_back(positions[n]);
+            stencilOut.m_weights.push_back(weight);
+            centerWeight -= weight;
+        }
+        stencilOut.m_positions.push_back(CENTER_POSITION);
+        stencilOut.m_weights.push_back(centerWeight);
+        return MathFunctions::isNumeric(centerWeight.length());
+    }
+    
+    ///available has bit (position) set for each in-bounds, in-roi neighbor, an empty stencil means output zero
+    GradientStencil computeStencil(const uint32_t available, const Vector3D& ivec, const Vector3D& jvec, const Vector3D& kvec)
+    {
+        GradientStencil ret;
+        vector<int> positions;
+        for (int n = 0; n < 6; ++n)
+        {
+            if (available & (1u << FACE_POSITIONS[n])) positions.push_back(FACE_POSITIONS[n]);
+        }
+        int dircheck = faceDirCheck(available);
+        if (dircheck == 7)//have at least one neighbor in every index axis, continue
+        {
+            if (!solveRegression(positions, ivec, jvec, kvec, ret)) ret = GradientStencil();
+            return ret;
+        }
+        //fallback 1: regression with 26-neighbors
+        Vector3D directions[3];//track the displacements in index space for simplicity
+        int dirUsed = 0;
+        if (dircheck & 1)
+        {
+            directions[dirUsed][0] = 1;
+            ++dirUsed;
+        }
+        if (dircheck & 2)
+        {
+            directions[dirUsed][1] = 1;
+            ++dirUsed;
+        }
+        if (dircheck & 4)
+        {
+            directions[dirUsed][2] = 1;
+            ++dirUsed;
+        }
+        for (int position = 0; position < 27; ++position)
+        {
+            Vector3D voxelDir = positionToDir(position);
+            int dirabs = (int)(abs(voxelDir[0]) + abs(voxelDir[1]) + abs(voxelDir[2]));
+            if (dirabs > 1 && (available & (1u << position)))//only add non-face neighbors
+            {
+                if (dirUsed < 3)//check for singularity via base vectors being dependent
+                {
+                    bool newDir = true;
+                    switch (dirUsed)
+                    {
+                        case 0:
+                        default:
+                            break;
+                        case 1:
+                            if (voxelDir.cross(directions[0]).length() < 0.01f) newDir = false;
+                            break;
+                        case 2:
+                            if (voxelDir.cross(directions[0]).cross(voxelDir.cross(directions[1])).length() < 0.01f)
+                                newDir = false;
+                            break;
+                    }
+                    if (newDir)
+                    {
+                        directions[dirUsed] = voxelDir;
+                        ++dirUsed;
+                    }
+                }
+                positions.push_back(position);
+            }
+        }
+        if (dirUsed == 3)
+        {
+            if (!solveRegression(positions, ivec, jvec, kvec, ret)) ret = GradientStencil();
+            return ret;
+        }
+        //fallback 2: average forward differences in 26-neighborhood
+        positions.clear();
+        vector<Vector3D> weights;
+        for (int position = 0; position < 27; ++position)
+        {
+            if (position == CENTER_POSITION || !(available & (1u << position))) continue;
+            Vector3D voxelDir = positionToDir(position);
+            Vector3D displacement = ivec * voxelDir[0] + jvec * voxelDir[1] + kvec * voxelDir[2];
+            float length = displacement.length();
+            if (length > 0.0f)
+            {
+                positions.push_back(position);
+                weights.push_back(displacement / (length * length));//once to normalize vector, and once to find gradient magnitude
+            }
+        }
+        int accumCount = (int)positions.size();
+        if (accumCount > 0)
+        {
+            Vector3D centerWeight;
+            for (int n = 0; n < accumCount; ++n)
+            {
+                ret.m_positions.push_back(positions[n]);
+                ret.m_weights.push_back(weights[n] / accumCount);
+                centerWeight -= weights[n] / accumCount;
+            }
+            ret.m_positions.push_back(CENTER_POSITION);
+            ret.m_weights.push_back(centerWeight);
+            if (!MathFunctions::isNumeric(centerWeight.length())) ret = GradientStencil();
+        }
+        return ret;
+    }
+}
+
 AlgorithmVolumeGradient::AlgorithmVolumeGradient(ProgressObject* myProgObj, const VolumeFile* volIn, VolumeFile* volOut, const float& presmooth,
                                                        const VolumeFile* myRoi, VolumeFile* vectorsOut, const int& subvolNum) : AbstractAlgorithm(myProgObj)
 {
@@ -141,12 +320,6 @@ AlgorithmVolumeGradient::AlgorithmVolumeGradient(ProgressObject* myProgObj, cons
     }
     vector<int64_t> origDims = volIn->getOriginalDimensions(), myDims;
     volIn->getDimensions(myDims);
-    int stencil[] = { 0, 0, 1,
-                    0, 0, -1,
-                    0, 1, 0,
-                    0, -1, 0,
-                    1, 0, 0,
-                    -1, 0, 0 };//WARNING: ordering of these neighbors is used in checking for singular regression conditions
     vector<vector<float> > volSpace = volIn->getSform();
     Vector3D ivec, jvec, kvec, origin;
     ivec[0] = volSpace[0][0]; jvec[0] = volSpace[0][1]; kvec[0] = volSpace[0][2]; origin[0] = volSpace[0][3];
@@ -157,6 +330,81 @@ AlgorithmVolumeGradient::AlgorithmVolumeGradient(ProgressObject* myProgObj, cons
     {
         roiFrame = myRoi->getFrame();
     }
+    const int64_t frameSize = myDims[0] * myDims[1] * myDims[2];
+    int64_t positionOffsets[27];
+    for (int position = 0; position < 27; ++position)
+    {
+        positionOffsets[position] = (position % 3 - 1) + myDims[0] * ((position / 3) % 3 - 1 + myDims[1] * (position / 9 - 1));
+    }
+    vector<int32_t> stencilIndex(frameSize, -1);//the regression only depends on the roi, not the data, so classify every voxel once for all frames
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int64_t k = 0; k < myDims[2]; ++k)
+    {
+        for (int64_t j = 0; j < myDims[1]; ++j)
+        {
+            for (int64_t i = 0; i < myDims[0]; ++i)
+            {
+                int64_t index = volIn->getIndex(i, j, k);
+                if (roiFrame != NULL && !(roiFrame[index] > 0.0f)) continue;
+                uint32_t available = 0;
+                for (int position = 0; position < 27; ++position)
+                {
+                    if (position == CENTER_POSITION) continue;
+                    int64_t ikern = i + position % 3 - 1, jkern = j + (position / 3) % 3 - 1, kkern = k + position / 9 - 1;
+                    if (volIn->indexValid(ikern, jkern, kkern) && (roiFrame == NULL || roiFrame[index + positionOffsets[position]] > 0.0f))
+                    {
+                        available |= 1u << position;
+                    }
+                }
+                if (faceDirCheck(available) == 7)
+                {
+                    available &= FACE_MASK;//the main regression only uses face neighbors, so don't make extra patterns
+                }
+                stencilIndex[index] = (int32_t)available;//temporarily store the pattern
+            }
+        }
+    }
+    map<uint32_t, int32_t> patternLookup;
+    vector<uint32_t> patterns;
+    {
+        uint32_t lastPattern = 0;
+        int32_t lastIndex = -1;
+        for (int64_t index = 0; index < frameSize; ++index)
+        {
+            if (stencilIndex[index] == -1) continue;//bit 31 is never used by a pattern, so -1 is unambiguous
+            uint32_t pattern = (uint32_t)stencilIndex[index];
+            if (lastIndex == -1 || pattern != lastPattern)
+            {
+                map<uint32_t, int32_t>::iterator iter = patternLookup.find(pattern);
+                if (iter == patternLookup.end())
+                {
+                    lastIndex = (int32_t)patterns.size();
+                    patternLookup[pattern] = lastIndex;
+                    patterns.push_back(pattern);
+                } else {
+                    lastIndex = iter->second;
+                }
+                lastPattern = pattern;
+            }
+            stencilIndex[index] = lastIndex;
+        }
+    }
+    int32_t numPatterns = (int32_t)patterns.size();
+    vector<GradientStencil> stencils(numPatterns);
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int32_t p = 0; p < numPatterns; ++p)
+    {
+        stencils[p] = computeStencil(patterns[p], ivec, jvec, kvec);
+    }
+    vector<vector<int64_t> > stencilOffsets(numPatterns);
+    for (int32_t p = 0; p < numPatterns; ++p)
+    {
+        for (size_t n = 0; n < stencils[p].m_positions.size(); ++n)
+        {
+            stencilOffsets[p].push_back(positionOffsets[stencils[p].m_positions[n]]);
+        }
+    }
+    vector<pair<int64_t, int64_t> > frameList;//input subvolume, output subvolume
     if (subvolNum == -1)
     {
         volOut->reinitialize(origDims, volIn->getSform(), myDims[4], volIn->getType(), volIn->m_header);
@@ -169,244 +417,9 @@ AlgorithmVolumeGradient::AlgorithmVolumeGradient(ProgressObject* myProgObj, cons
             origDims[3] *= 3;
             vectorsOut->reinitialize(origDims, volIn->getSform(), myDims[4], volIn->getType());
         }
-        for (int c = 0; c < myDims[4]; ++c)
+        for (int64_t s = 0; s < myDims[3]; ++s)
         {
-            for (int s = 0; s < myDims[3]; ++s)
-            {
-                const float* inFrame = processVol->getFrame(s, c);
-#pragma omp CARET_PARFOR schedule(dynamic)
-                for (int k = 0; k < myDims[2]; ++k)
-                {
-                    for (int j = 0; j < myDims[1]; ++j)
-                    {
-                        for (int i = 0; i < myDims[0]; ++i)
-                        {
-                            float magnitude;
-                            Vector3D gradient;
-                            if (myRoi == NULL || myRoi->getValue(i, j, k) > 0.0f)
-                            {
-                                float curval = processVol->getValue(i, j, k, s, c);
-                                FloatMatrix regress = FloatMatrix::zeros(4, 5);
-                                regress[3][3] = 1;//count the center voxel in case neighbors are missing (displacement and valdiff are zero, cancelling all other terms)
-                                int dircheck = 0;
-                                for (int neighbase = 0; neighbase < 18; neighbase += 3)
-                                {
-                                    int ikern = i + stencil[neighbase];
-                                    int jkern = j + stencil[neighbase + 1];
-                                    int kkern = k + stencil[neighbase + 2];
-                                    if (volIn->indexValid(ikern, jkern, kkern))
-                                    {
-                                        int64_t kernIndex = volIn->getIndex(ikern, jkern, kkern);
-                                        if (roiFrame == NULL || roiFrame[kernIndex] > 0.0f)
-                                        {
-                                            dircheck |= 1<<(2 - (neighbase / 6));//NOTE: uses the ordering of the neighbors to map neighbor to direction
-                                            float valdiff = inFrame[kernIndex] - curval;
-                                            Vector3D displacement = ivec * stencil[neighbase] + jvec * stencil[neighbase + 1] + kvec * stencil[neighbase + 2];
-                                            regress[0][0] += displacement[0] * displacement[0];//note: this is the generic code, built to handle strange volumes, to get more speed, test
-                                            regress[0][1] += displacement[0] * displacement[1];// for orthogonal volume, and use central differences (if no ROI, could special case for even more speed)
-                                            regress[0][2] += displacement[0] * displacement[2];//but, seems reasonably fast anyway
-                                            regress[0][3] += displacement[0];
-                                            regress[0][4] += displacement[0] * valdiff;
-                                            regress[1][1] += displacement[1] * displacement[1];
-                                            regress[1][2] += displacement[1] * displacement[2];
-                                            regress[1][3] += displacement[1];
-                                            regress[1][4] += displacement[1] * valdiff;
-                                            regress[2][2] += displacement[2] * displacement[2];
-                                            regress[2][3] += displacement[2];
-                                            regress[2][4] += displacement[2] * valdiff;
-                                            regress[3][3] += 1;
-                                            regress[3][4] += valdiff;
-                                        }
-                                    }
-                                }
-                                if (dircheck == 7)//have at least one neighbor in every index axis, continue
-                                {
-                                    regress[1][0] = regress[0][1];//finish the symmetric part of the matrix
-                                    regress[2][0] = regress[0][2];
-                                    regress[2][1] = regress[1][2];
-                                    regress[3][0] = regress[0][3];
-                                    regress[3][1] = regress[1][3];
-                                    regress[3][2] = regress[2][3];
-                                    FloatMatrix result = regress.reducedRowEchelon();
-                                    gradient[0] = result[0][4];
-                                    gradient[1] = result[1][4];
-                                    gradient[2] = result[2][4];//[3][4] is the constant part of the regression
-                                    magnitude = gradient.length();
-                                    if (!MathFunctions::isNumeric(magnitude))
-                                    {
-                                        magnitude = 0.0f;
-                                        gradient[0] = 0.0f;
-                                        gradient[1] = 0.0f;
-                                        gradient[2] = 0.0f;
-                                    }
-                                } else {//fallback 1: regression with 26-neighbors
-                                    Vector3D directions[3];//track the displacements in index space for simplicity
-                                    int dirUsed = 0;
-                                    if (dircheck & 1)
-                                    {
-                                        directions[dirUsed][0] = 1;
-                                        ++dirUsed;
-                                    }
-                                    if (dircheck & 2)
-                                    {
-                                        directions[dirUsed][1] = 1;
-                                        ++dirUsed;
-                                    }
-                                    if (dircheck & 4)
-                                    {
-                                        directions[dirUsed][2] = 1;
-                                        ++dirUsed;
-                                    }
-                                    int imin = max(i - 1, 0), jmin = max(j - 1, 0), kmin = max(k - 1, 0);
-                                    int imax = min(i + 2, (int)myDims[0]), jmax = min(j + 2, (int)myDims[1]), kmax = min(k + 2, (int)myDims[2]);
-                                    Vector3D voxelDir;
-                                    for (int kkern = kmin; kkern < kmax; ++kkern)
-                                    {
-                                        voxelDir[2] = kkern - k;
-                                        int kabs = abs(kkern - k);
-                                        int64_t kindpart = kkern * myDims[1];
-                                        for (int jkern = jmin; jkern < jmax; ++jkern)
-                                        {
-                                            int jabs = abs(jkern - j) + kabs;
-                                            if (jabs > 0)//skip inner loop if it won't get any new neighbors
-                                            {
-                                                int64_t jindpart = (kindpart + jkern) * myDims[0];
-                                                voxelDir[1] = jkern - j;
-                                                for (int ikern = imin; ikern < imax; ++ikern)
-                                                {
-                                                    int64_t kernIndex = jindpart + ikern;
-                                                    if (jabs + abs(ikern - i) > 1 && (roiFrame == NULL || roiFrame[kernIndex] > 0.0f))//only add non-face neighbors
-                                                    {
-                                                        voxelDir[0] = ikern - i;
-                                                        if (dirUsed < 3)//check for singularity via base vectors being dependent
-                                                        {
-                                                            bool newDir = true;
-                                                            switch (dirUsed)
-                                                            {
-                                                                case 0:
-                                                                default:
-                                                                    break;
-                                                                case 1:
-                                                                    if (voxelDir.cross(directions[0]).length() < 0.01f) newDir = false;
-                                                                    break;
-                                                                case 2:
-                                                                    if (voxelDir.cross(directions[0]).cross(voxelDir.cross(directions[1])).length() < 0.01f)
-                                                                        newDir = false;
-                                                                    break;
-                                                            }
-                                                            if (newDir)
-                                                            {
-                                                                directions[dirUsed] = voxelDir;
-                                                                ++dirUsed;
-                                                            }
-                                                        }
-                                                        Vector3D displacement = ivec * voxelDir[0] + jvec * voxelDir[1] + kvec * voxelDir[2];
-                                                        float valdiff = inFrame[kernIndex] - curval;
-                                                        regress[0][0] += displacement[0] * displacement[0];
-                                                        regress[0][1] += displacement[0] * displacement[1];
-                                                        regress[0][2] += displacement[0] * displacement[2];
-                                                        regress[0][3] += displacement[0];
-                                                        regress[0][4] += displacement[0] * valdiff;
-                                                        regress[1][1] += displacement[1] * displacement[1];
-                                                        regress[1][2] += displacement[1] * displacement[2];
-                                                        regress[1][3] += displacement[1];
-                                                        regress[1][4] += displacement[1] * valdiff;
-                                                        regress[2][2] += displacement[2] * displacement[2];
-                                                        regress[2][3] += displacement[2];
-                                                        regress[2][4] += displacement[2] * valdiff;
-                                                        regress[3][3] += 1;
-                                                        regress[3][4] += valdiff;
-                                                    }
-                                                }
-                                            }
-                                        }
-                                    }
-                                    if (dirUsed == 3)
-                                    {
-                                        regress[1][0] = regress[0][1];//finish the symmetric part of the matrix
-                                        regress[2][0] = regress[0][2];
-                                        regress[2][1] = regress[1][2];
-                                        regress[3][0] = regress[0][3];
-                                        regress[3][1] = regress[1][3];
-                                        regress[3][2] = regress[2][3];
-                                        FloatMatrix result = regress.reducedRowEchelon();
-                                        gradient[0] = result[0][4];
-                                        gradient[1] = result[1][4];
-                                        gradient[2] = result[2][4];//[3][4] is the constant part of the regression
-                                        magnitude = gradient.length();
-                                        if (!MathFunctions::isNumeric(magnitude))
-                                        {
-                                            magnitude = 0.0f;
-                                            gradient[0] = 0.0f;
-                                            gradient[1] = 0.0f;
-                                            gradient[2] = 0.0f;
-                                        }
-                                    } else {//fallback 2: average forward differences in 26-neighborhood
-                                        Vector3D accum;
-                                        int accumCount = 0;
-                                        for (int kkern = kmin; kkern < kmax; ++kkern)
-                                        {
-                                            voxelDir[2] = kkern - k;
-                                            int64_t kindpart = kkern * myDims[1];
-                                            for (int jkern = jmin; jkern < jmax; ++jkern)
-                                            {
-                                                int64_t jindpart = (kindpart + jkern) * myDims[0];
-                                                voxelDir[1] = jkern - j;
-                                                for (int ikern = imin; ikern < imax; ++ikern)
-                                                {
-                                                    int64_t kernIndex = jindpart + ikern;
-                                                    if (roiFrame == NULL || roiFrame[kernIndex] > 0.0f)
-                                                    {
-                                                        float valdiff = inFrame[kernIndex] - curval;
-                                                        voxelDir[0] = ikern - i;
-                                                        Vector3D displacement = ivec * voxelDir[0] + jvec * voxelDir[1] + kvec * voxelDir[2];
-                                                        float length = displacement.length();
-                                                        if (length > 0.0f)
-                                                        {
-                                                            accum += displacement * (valdiff / (length * length));//once to normalize vector, and once to find gradient magnitude
-                                                            ++accumCount;
-                                                        }
-                                                    }
-                                                }
-                                            }
-                                        }
-                                        if (accumCount > 0)
-                                        {
-                                            gradient = accum / accumCount;
-                                            magnitude = gradient.length();
-                                            if (!MathFunctions::isNumeric(magnitude))
-                                            {
-                                                magnitude = 0.0f;
-                                                gradient[0] = 0.0f;
-                                                gradient[1] = 0.0f;
-                                                gradient[2] = 0.0f;
-                                            }
-                                        } else {
-                                            magnitude = 0.0f;
-                                            gradient[0] = 0.0f;
-                                            gradient[1] = 0.0f;
-                                            gradient[2] = 0.0f;
-                                        }
-                                    }
-                                }
-                            } else {
-                                magnitude = 0.0f;
-                                gradient[0] = 0.0f;
-                                gradient[1] = 0.0f;
-                                gradient[2] = 0.0f;
-                            }
-                            volOut->setValue(magnitude, i, j, k, s, c);
-                            if (vectorsOut != NULL)
-                            {
-                                int subvolbase = s * 3;
-                                vectorsOut->setValue(gradient[0], i, j, k, subvolbase, c);
-                                vectorsOut->setValue(gradient[1], i, j, k, subvolbase + 1, c);
-                                vectorsOut->setValue(gradient[2], i, j, k, subvolbase + 2, c);
-                            }
-                        }
-                    }
-                }
-            }
+            frameList.push_back(make_pair(s, s));
         }
     } else {
         origDims.resize(3);
@@ -416,244 +429,71 @@ AlgorithmVolumeGradient::AlgorithmVolumeGradient(ProgressObject* myProgObj, cons
             origDims.push_back(3);
             vectorsOut->reinitialize(origDims, volIn->getSform(), myDims[4], volIn->getType());
         }
-        for (int c = 0; c < myDims[4]; ++c)
+        frameList.push_back(make_pair((int64_t)useSubvol, (int64_t)0));
+    }
+    vector<float> magScratch(frameSize), vecScratch;
+    if (vectorsOut != NULL)
+    {
+        vecScratch.resize(frameSize * 3);
+    }
+    for (int c = 0; c < myDims[4]; ++c)
+    {
+        for (size_t f = 0; f < frameList.size(); ++f)
         {
-            const float* inFrame = processVol->getFrame(useSubvol, c);
+            const float* inFrame = processVol->getFrame(frameList[f].first, c);
 #pragma omp CARET_PARFOR schedule(dynamic)
-            for (int k = 0; k < myDims[2]; ++k)
+            for (int64_t k = 0; k < myDims[2]; ++k)
             {
-                for (int j = 0; j < myDims[1]; ++j)
+                int64_t index = k * myDims[0] * myDims[1];
+                for (int64_t ij = 0; ij < myDims[0] * myDims[1]; ++ij, ++index)
                 {
-                    for (int i = 0; i < myDims[0]; ++i)
+                    float magnitude = 0.0f;
+                    Vector3D gradient;
+                    int32_t whichStencil = stencilIndex[index];
+                    if (whichStencil != -1)
                     {
-                        float magnitude;
-                        Vector3D gradient;
-                        if (myRoi == NULL || myRoi->getValue(i, j, k) > 0.0f)
+                        const vector<Vector3D>& weights = stencils[whichStencil].m_weights;
+                        const vector<int64_t>& offsets = stencilOffsets[whichStencil];
+                        int numEntries = (int)offsets.size();
+                        for (int n = 0; n < numEntries; ++n)
+                        {
+                            float value = inFrame[index + offsets[n]];
+                            gradient[0] += weights[n][0] * value;
+                            gradient[1] += weights[n][1] * value;
+                            gradient[2] += weights[n][2] * value;
+                        }
+                        magnitude = gradient.length();
+                        if (!MathFunctions::isNumeric(magnitude))
                         {
-                            float curval = processVol->getValue(i, j, k, useSubvol, c);
-                            FloatMatrix regress = FloatMatrix::zeros(4, 5);
-                            regress[3][3] = 1;//count the center voxel in case neighbors are missing (displacement and valdiff are zero, cancelling all other terms)
-                            int dircheck = 0;
-                            for (int neighbase = 0; neighbase < 18; neighbase += 3)
-                            {
-                                int ikern = i + stencil[neighbase];
-                                int jkern = j + stencil[neighbase + 1];
-                                int kkern = k + stencil[neighbase + 2];
-                                if (volIn->indexValid(ikern, jkern, kkern))
-                                {
-                                    int64_t kernIndex = volIn->getIndex(ikern, jkern, kkern);
-                                    if (roiFrame == NULL || roiFrame[kernIndex] > 0.0f)
-                                    {
-                                        dircheck |= 1<<(2 - (neighbase / 6));//NOTE: uses the ordering of the neighbors to map neighbor to direction
-                                        float valdiff = inFrame[kernIndex] - curval;
-                                        Vector3D displacement = ivec * stencil[neighbase] + jvec * stencil[neighbase + 1] + kvec * stencil[neighbase + 2];
-                                        regress[0][0] += displacement[0] * displacement[0];//note: this is the generic code, built to handle strange volumes, to get more speed, test
-                                        regress[0][1] += displacement[0] * displacement[1];// for orthogonal volume, and use central differences (if no ROI, could special case for even more speed)
-                                        regress[0][2] += displacement[0] * displacement[2];
-                                        regress[0][3] += displacement[0];
-                                        regress[0][4] += displacement[0] * valdiff;
-                                        regress[1][1] += displacement[1] * displacement[1];
-                                        regress[1][2] += displacement[1] * displacement[2];
-                                        regress[1][3] += displacement[1];
-                                        regress[1][4] += displacement[1] * valdiff;
-                                        regress[2][2] += displacement[2] * displacement[2];
-                                        regress[2][3] += displacement[2];
-                                        regress[2][4] += displacement[2] * valdiff;
-                                        regress[3][3] += 1;
-                                        regress[3][4] += valdiff;
-                                    }
-                                }
-                            }
-                            if (dircheck == 7)//have at least one neighbor in every index axis, continue
-                            {
-                                regress[1][0] = regress[0][1];//finish the symmetric part of the matrix
-                                regress[2][0] = regress[0][2];
-                                regress[2][1] = regress[1][2];
-                                regress[3][0] = regress[0][3];
-                                regress[3][1] = regress[1][3];
-                                regress[3][2] = regress[2][3];
-                                FloatMatrix result = regress.reducedRowEchelon();
-                                gradient[0] = result[0][4];
-                                gradient[1] = result[1][4];
-                                gradient[2] = result[2][4];//[3][4] is the constant part of the regression
-                                magnitude = gradient.length();
-                                if (!MathFunctions::isNumeric(magnitude))
-                                {
-                                    magnitude = 0.0f;
-                                    gradient[0] = 0.0f;
-                                    gradient[1] = 0.0f;
-                                    gradient[2] = 0.0f;
-                                }
-                            } else {//fallback 1: regression with 26-neighbors
-                                Vector3D directions[3];//track the displacements in index space for simplicity
-                                int dirUsed = 0;
-                                if (dircheck & 1)
-                                {
-                                    directions[dirUsed][0] = 1;
-                                    ++dirUsed;
-                                }
-                                if (dircheck & 2)
-                                {
-                                    directions[dirUsed][1] = 1;
-                                    ++dirUsed;
-                                }
-                                if (dircheck & 4)
-                                {
-                                    directions[dirUsed][2] = 1;
-                                    ++dirUsed;
-                                }
-                                int imin = max(i - 1, 0), jmin = max(j - 1, 0), kmin = max(k - 1, 0);
-                                int imax = min(i + 2, (int)myDims[0]), jmax = min(j + 2, (int)myDims[1]), kmax = min(k + 2, (int)myDims[2]);
-                                Vector3D voxelDir;
-                                for (int kkern = kmin; kkern < kmax; ++kkern)
-                                {
-                                    voxelDir[2] = kkern - k;
-                                    int kabs = abs(kkern - k);
-                                    int64_t kindpart = kkern * myDims[1];
-                                    for (int jkern = jmin; jkern < jmax; ++jkern)
-                                    {
-                                        int jabs = abs(jkern - j) + kabs;
-                                        if (jabs > 0)//skip inner loop if it won't get any new neighbors
-                                        {
-                                            int64_t jindpart = (kindpart + jkern) * myDims[0];
-                                            voxelDir[1] = jkern - j;
-                                            for (int ikern = imin; ikern < imax; ++ikern)
-                                            {
-                                                int64_t kernIndex = jindpart + ikern;
-                                                if (jabs + abs(ikern - i) > 1 && (roiFrame == NULL || roiFrame[kernIndex] > 0.0f))//only add non-face neighbors
-                                                {
-                                                    voxelDir[0] = ikern - i;
-                                                    if (dirUsed < 3)//check for singularity via base vectors being dependent
-                                                    {
-                                                        bool newDir = true;
-                                                        switch (dirUsed)
-                                                        {
-                                                            case 0:
-                                                            default:
-                                                                break;
-                                                            case 1:
-                                                                if (voxelDir.cross(directions[0]).length() < 0.01f) newDir = false;
-                                                                break;
-                                                            case 2:
-                                                                if (voxelDir.cross(directions[0]).cross(voxelDir.cross(directions[1])).length() < 0.01f)
-                                                                    newDir = false;
-                                                                break;
-                                                        }
-                                                        if (newDir)
-                                                        {
-                                                            directions[dirUsed] = voxelDir;
-                                                            ++dirUsed;
-                                                        }
-                                                    }
-                                                    Vector3D displacement = ivec * voxelDir[0] + jvec * voxelDir[1] + kvec * voxelDir[2];
-                                                    float valdiff = inFrame[kernIndex] - curval;
-                                                    regress[0][0] += displacement[0] * displacement[0];
-                                                    regress[0][1] += displacement[0] * displacement[1];
-                                                    regress[0][2] += displacement[0] * displacement[2];
-                                                    regress[0][3] += displacement[0];
-                                                    regress[0][4] += displacement[0] * valdiff;
-                                                    regress[1][1] += displacement[1] * displacement[1];
-                                                    regress[1][2] += displacement[1] * displacement[2];
-                                                    regress[1][3] += displacement[1];
-                                                    regress[1][4] += displacement[1] * valdiff;
-                                                    regress[2][2] += displacement[2] * displacement[2];
-                                                    regress[2][3] += displacement[2];
-                                                    regress[2][4] += displacement[2] * valdiff;
-                                                    regress[3][3] += 1;
-                                                    regress[3][4] += valdiff;
-                                                }
-                                            }
-                                        }
-                                    }
-                                }
-                                if (dirUsed == 3)
-                                {
-                                    regress[1][0] = regress[0][1];//finish the symmetric part of the matrix
-                                    regress[2][0] = regress[0][2];
-                                    regress[2][1] = regress[1][2];
-                                    regress[3][0] = regress[0][3];
-                                    regress[3][1] = regress[1][3];
-                                    regress[3][2] = regress[2][3];
-                                    FloatMatrix result = regress.reducedRowEchelon();
-                                    gradient[0] = result[0][4];
-                                    gradient[1] = result[1][4];
-                                    gradient[2] = result[2][4];//[3][4] is the constant part of the regression
-                                    magnitude = gradient.length();
-                                    if (!MathFunctions::isNumeric(magnitude))
-                                    {
-                                        magnitude = 0.0f;
-                                        gradient[0] = 0.0f;
-                                        gradient[1] = 0.0f;
-                                        gradient[2] = 0.0f;
-                                    }
-                                } else {//fallback 2: average forward differences in 26-neighborhood
-                                    Vector3D accum;
-                                    int accumCount = 0;
-                                    for (int kkern = kmin; kkern < kmax; ++kkern)
-                                    {
-                                        voxelDir[2] = kkern - k;
-                                        int64_t kindpart = kkern * myDims[1];
-                                        for (int jkern = jmin; jkern < jmax; ++jkern)
-                                        {
-                                            int64_t jindpart = (kindpart + jkern) * myDims[0];
-                                            voxelDir[1] = jkern - j;
-                                            for (int ikern = imin; ikern < imax; ++ikern)
-                                            {
-                                                int64_t kernIndex = jindpart + ikern;
-                                                if (roiFrame == NULL || roiFrame[kernIndex] > 0.0f)
-                                                {
-                                                    float valdiff = inFrame[kernIndex] - curval;
-                                                    voxelDir[0] = ikern - i;
-                                                    Vector3D displacement = ivec * voxelDir[0] + jvec * voxelDir[1] + kvec * voxelDir[2];
-                                                    float length = displacement.length();
-                                                    if (length > 0.0f)
-                                                    {
-                                                        accum += displacement * (valdiff / (length * length));//once to normalize vector, and once to find gradient magnitude
-                                                        ++accumCount;
-                                                    }
-                                                }
-                                            }
-                                        }
-                                    }
-                                    if (accumCount > 0)
-                                    {
-                                        gradient = accum / accumCount;
-                                        magnitude = gradient.length();
-                                        if (!MathFunctions::isNumeric(magnitude))
-                                        {
-                                            magnitude = 0.0f;
-                                            gradient[0] = 0.0f;
-                                            gradient[1] = 0.0f;
-                                            gradient[2] = 0.0f;
-                                        }
-                                    } else {
-                                        magnitude = 0.0f;
-                                        gradient[0] = 0.0f;
-                                        gradient[1] = 0.0f;
-                                        gradient[2] = 0.0f;
-                                    }
-                                }
-                            }
-                        } else {
                             magnitude = 0.0f;
                             gradient[0] = 0.0f;
                             gradient[1] = 0.0f;
                             gradient[2] = 0.0f;
                         }
-                        volOut->setValue(magnitude, i, j, k, 0, c);
-                        if (vectorsOut != NULL)
-                        {
-                            vectorsOut->setValue(gradient[0], i, j, k, 0, c);
-                            vectorsOut->setValue(gradient[1], i, j, k, 1, c);
-                            vectorsOut->setValue(gradient[2], i, j, k, 2, c);
-                        }
+                    }
+                    magScratch[index] = magnitude;
+                    if (vectorsOut != NULL)
+                    {
+                        vecScratch[index] = gradient[0];
+                        vecScratch[frameSize + index] = gradient[1];
+                        vecScratch[frameSize * 2 + index] = gradient[2];
                     }
                 }
             }
+            int64_t outSubvol = frameList[f].second;
+            volOut->setFrame(magScratch.data(), outSubvol, c);
+            if (vectorsOut != NULL)
+            {
+                int64_t subvolbase = outSubvol * 3;
+                vectorsOut->setFrame(vecScratch.data(), subvolbase, c);
+                vectorsOut->setFrame(vecScratch.data() + frameSize, subvolbase + 1, c);
+                vectorsOut->setFrame(vecScratch.data() + frameSize * 2, subvolbase + 2, c);
+            }
         }
     }
 }
 
+
 float AlgorithmVolumeGradient::getAlgorithmInternalWeight()
 {
     return 1.0f;//override this if needed, if the progress bar isn't smooth
@@ -25,6 +25,7 @@
 #include "ReductionOperation.h"
 #include "VolumeFile.h"
 
+#include <algorithm>
 #include <vector>
 
 using namespace caret;
@@ -98,22 +99,22 @@ AlgorithmVolumeReduce::AlgorithmVolumeReduce(ProgressObject* myProgObj, const Vo
         *(volumeOut->getMapLabelTable(0)) = *(volumeIn->getMapLabelTable(0));
     }
     int64_t frameSize = myDims[0] * myDims[1] * myDims[2];
-    vector<float> scratchArray(myDims[3]), outFrame(frameSize);
+    const int64_t blockVoxels = max((int64_t)1, (int64_t)(1<<22) / myDims[3]);//gather a block of voxels into contiguous rows, then reduce them in parallel
+    vector<float> scratchArray(min(blockVoxels, frameSize) * myDims[3]), outFrame(frameSize);
     for (int c = 0; c < myDims[4]; ++c)
     {
-        for (int64_t i = 0; i < frameSize; ++i)
+        for (int64_t start = 0; start < frameSize; start += blockVoxels)
         {
+            int64_t count = min(blockVoxels, frameSize - start);
             for (int b = 0; b < myDims[3]; ++b)
             {
                 const float* tempFrame = volumeIn->getFrame(b, c);
-                scratchArray[b] = tempFrame[i];
-            }
-            if (onlyNumeric)
-            {
-                outFrame[i] = ReductionOperation::reduceOnlyNumeric(scratchArray.data(), myDims[3], myReduce);
-            } else {
-                outFrame[i] = ReductionOperation::reduce(scratchArray.data(), myDims[3], myReduce);
+                for (int64_t i = 0; i < count; ++i)
+                {
+                    scratchArray[i * myDims[3] + b] = tempFrame[start + i];
+                }
             }
+            ReductionOperation::reduceRows(scratchArray.data(), count, myDims[3], myReduce, outFrame.data() + start, onlyNumeric);
         }
         volumeOut->setFrame(outFrame.data(), 0, c);
     }
@@ -24,6 +24,7 @@
 #include <new>
 
 #include <QCollator>
+#include <QtConcurrent/QtConcurrent>
 
 #include "AnnotationFile.h"
 #include "AnnotationManager.h"
@@ -587,6 +588,7 @@ Brain::resetBrain(const ResetBrainKeepSceneFiles keepSceneFiles,
 {
     m_isSpecFileBeingRead = false;
     m_activeScene = NULL;
+    deleteConcurrentlyReadDataFiles();
     SessionManager::get()->resetSceneWithChartOld();
     SessionManager::get()->resetSceneWithMprOld();
     
@@ -6377,6 +6379,19 @@ Brain::readDataFile(const DataFileTypeEnum::Enum dataFileType,
      */
     dataFileName = convertFilePathNameToAbsolutePathName(dataFileName);
     
+    /*
+     * File may have been read by another thread
+     */
+    bool concurrentlyReadFlag(false);
+    CaretDataFile* concurrentlyReadFile = addConcurrentlyReadDataFile(dataFileType,
+                                                                      structure,
+                                                                      dataFileName,
+                                                                      markDataFileAsModified,
+                                                                      concurrentlyReadFlag);
+    if (concurrentlyReadFlag) {
+        return concurrentlyReadFile;
+    }
+    
     /*
      * Since file is being read, it must exist
      */
@@ -6398,6 +6413,286 @@ Brain::readDataFile(const DataFileTypeEnum::Enum dataFileType,
     return caretDataFileRead;
 }
 
+/**
+ * Read data files using other threads.  Files are only read by this
+ * method, they are added to the brain, in the order they appear in the
+ * spec file, when readDataFile() is called with the file's type and name.
+ * Only types of files that can be read without accessing the brain
+ * (surfaces, GIFTI, CIFTI brainordinate and parcel mapped files, and
+ * volumes) that are on the local file system are read by this method.
+ * Other files are read, as before, by readDataFile().
+ *
+ * @param dataFileTypesAndNames
+ *    Types and names of data files.
+ * @param progressEvent
+ *    Event for reporting progress.
+ * @return
+ *    True if successful, false if the user cancelled reading.
+ */
+bool
+Brain::readDataFilesConcurrently(const std::vector<std::pair<DataFileTypeEnum::Enum, AString>>& dataFileTypesAndNames,
+                                 EventProgressUpdate& progressEvent)
+{
+    deleteConcurrentlyReadDataFiles();
+    
+    ElapsedTimer timer;
+    timer.start();
+    
+    /*
+     * Files are created on this thread and only the reading
+     * of the files is performed by the other threads.
+     */
+    std::vector<QFuture<AString>> readFutures;
+    for (const auto& typeAndName : dataFileTypesAndNames) {
+        const DataFileTypeEnum::Enum dataFileType = typeAndName.first;
+        const AString dataFileName = convertFilePathNameToAbsolutePathName(typeAndName.second);
+        if (DataFile::isFileOnNetwork(dataFileName)) {
+            continue;
+        }
+        if ( ! FileInformation(dataFileName).exists()) {
+            continue;
+        }
+        
+        /*
+         * A file listed more than once is read concurrently only once
+         */
+        bool duplicateFlag(false);
+        for (const auto& crdf : m_concurrentlyReadDataFiles) {
+            if ((crdf.m_dataFileType == dataFileType)
+                && (crdf.m_dataFileName == dataFileName)) {
+                duplicateFlag = true;
+                break;
+            }
+        }
+        if (duplicateFlag) {
+            continue;
+        }
+        
+        CaretDataFile* caretDataFile(NULL);
+        switch (dataFileType) {
+            case DataFileTypeEnum::CONNECTIVITY_DENSE_LABEL:
+                caretDataFile = new CiftiBrainordinateLabelFile();
+                break;
+            case DataFileTypeEnum::CONNECTIVITY_DENSE_SCALAR:
+                caretDataFile = new CiftiBrainordinateScalarFile();
+                break;
+            case DataFileTypeEnum::CONNECTIVITY_DENSE_TIME_SERIES:
+                caretDataFile = new CiftiBrainordinateDataSeriesFile();
+                break;
+            case DataFileTypeEnum::CONNECTIVITY_PARCEL_LABEL:
+                caretDataFile = new CiftiParcelLabelFile();
+                break;
+            case DataFileTypeEnum::CONNECTIVITY_PARCEL_SCALAR:
+                caretDataFile = new CiftiParcelScalarFile();
+                break;
+            case DataFileTypeEnum::CONNECTIVITY_PARCEL_SERIES:
+                caretDataFile = new CiftiParcelSeriesFile();
+                break;
+            case DataFileTypeEnum::LABEL:
+                caretDataFile = new LabelFile();
+                break;
+            case DataFileTypeEnum::METRIC:
+                caretDataFile = new MetricFile();
+                break;
+            case DataFileTypeEnum::RGBA:
+                caretDataFile = new RgbaFile();
+                break;
+            case DataFileTypeEnum::SURFACE:
+                caretDataFile = new Surface();
+                break;
+            case DataFileTypeEnum::VOLUME:
+                caretDataFile = new VolumeFile();
+                break;
+            default:
+                break;
+        }
+        
+        if (caretDataFile != NULL) {
+            m_concurrentlyReadDataFiles.push_back(ConcurrentlyReadDataFile(dataFileType,
+                                                                           dataFileName,
+                                                                           caretDataFile));
+            readFutures.push_back(QtConcurrent::run(&Brain::readDataFileInThread,
+                                                    caretDataFile,
+                                                    dataFileName));
+        }
+    }
+    
+    /*
+     * Wait for the files in the order they were listed
+     */
+    bool cancelledFlag(false);
+    const int32_t numFiles = static_cast<int32_t>(readFutures.size());
+    CaretAssert(numFiles == static_cast<int32_t>(m_concurrentlyReadDataFiles.size()));
+    for (int32_t i = 0; i < numFiles; i++) {
+        CaretAssertVectorIndex(m_concurrentlyReadDataFiles, i);
+        ConcurrentlyReadDataFile& crdf = m_concurrentlyReadDataFiles[i];
+        
+        if ( ! cancelledFlag) {
+            progressEvent.setProgressMessage("Reading ("
+                                             + AString::number(i + 1)
+                                             + " of "
+                                             + AString::number(numFiles)
+                                             + ") "
+                                             + FileInformation(crdf.m_dataFileName).getFileName());
+            EventManager::get()->sendEvent(progressEvent.getPointer());
+            cancelledFlag = progressEvent.isCancelled();
+        }
+        
+        /*
+         * Always wait so that no thread is reading a file that is deleted
+         */
+        CaretAssertVectorIndex(readFutures, i);
+        readFutures[i].waitForFinished();
+        crdf.m_errorMessage = readFutures[i].result();
+        if ( ! crdf.m_errorMessage.isEmpty()) {
+            delete crdf.m_caretDataFile;
+            crdf.m_caretDataFile = NULL;
+        }
+    }
+    
+    if (cancelledFlag) {
+        deleteConcurrentlyReadDataFiles();
+        return false;
+    }
+    
+    if (numFiles > 0) {
+        CaretLogInfo("Time to concurrently read "
+                     + AString::number(numFiles)
+                     + " files was "
+                     + AString::number(timer.getElapsedTimeSeconds())
+                     + " seconds.");
+    }
+    
+    return true;
+}
+
+/**
+ * Read a data file.  This method is run by another thread
+ * and must not access the brain.
+ *
+ * @param caretDataFile
+ *    File that is read.
+ * @param dataFileName
+ *    Name of the data file.
+ * @return
+ *    Empty string if successful, otherwise an error message.
+ */
+AString
+Brain::readDataFileInThread(CaretDataFile* caretDataFile,
+                            const AString dataFileName)
+{
+    CaretAssert(caretDataFile);
+    
+    try {
+        try {
+            caretDataFile->readFile(dataFileName);
+        }
+        catch (const std::bad_alloc&) {
+            throw DataFileException(dataFileName,
+                                    CaretDataFileHelper::createBadAllocExceptionMessage(dataFileName));
+        }
+    }
+    catch (const DataFileException& dfe) {
+        return dfe.whatString();
+    }
+    
+    return "";
+}
+
+/**
+ * If a data file with the given type and name was read by
+ * readDataFilesConcurrently(), add it to the brain.
+ *
+ * @param dataFileType
+ *    Type of data file.
+ * @param structure
+ *    Struture of file (used if not invalid)
+ * @param dataFileName
+ *    Absolute path name of data file.
+ * @param markDataFileAsModified
+ *    If file has invalid structure and settings structure, mark file modified
+ * @param foundOut
+ *    True if the file was read concurrently (output).
+ * @throws DataFileException
+ *    If there was an error reading the file or adding it to the brain.
+ * @return
+ *    Pointer to file that was added.
+ */
+CaretDataFile*
+Brain::addConcurrentlyReadDataFile(const DataFileTypeEnum::Enum dataFileType,
+                                   const StructureEnum::Enum structure,
+                                   const AString& dataFileName,
+                                   const bool markDataFileAsModified,
+                                   bool& foundOut)
+{
+    foundOut = false;
+    
+    for (std::vector<ConcurrentlyReadDataFile>::iterator iter = m_concurrentlyReadDataFiles.begin();
+         iter != m_concurrentlyReadDataFiles.end();
+         iter++) {
+        if ((iter->m_dataFileType == dataFileType)
+            && (iter->m_dataFileName == dataFileName)) {
+            foundOut = true;
+            
+            CaretDataFile* caretDataFile = iter->m_caretDataFile;
+            const AString errorMessage = iter->m_errorMessage;
+            m_concurrentlyReadDataFiles.erase(iter);
+            
+            if (caretDataFile == NULL) {
+                throw DataFileException(errorMessage);
+            }
+            
+            try {
+                /*
+                 * Validation is performed here since it requires
+                 * the surfaces that have been added to the brain
+                 */
+                CiftiMappableDataFile* ciftiMapFile = dynamic_cast<CiftiMappableDataFile*>(caretDataFile);
+                if (ciftiMapFile != NULL) {
+                    validateCiftiMappableDataFile(ciftiMapFile);
+                }
+                
+                return addReadOrReloadDataFile(FILE_MODE_ADD,
+                                               caretDataFile,
+                                               dataFileType,
+                                               structure,
+                                               dataFileName,
+                                               markDataFileAsModified);
+            }
+            catch (const DataFileException& dfe) {
+                /*
+                 * File may not have been added (invalid structure)
+                 */
+                std::vector<CaretDataFile*> allFiles;
+                getAllDataFiles(allFiles);
+                if (std::find(allFiles.begin(),
+                              allFiles.end(),
+                              caretDataFile) == allFiles.end()) {
+                    delete caretDataFile;
+                }
+                throw dfe;
+            }
+        }
+    }
+    
+    return NULL;
+}
+
+/**
+ * Delete any files read by readDataFilesConcurrently() that
+ * were not added to the brain.
+ */
+void
+Brain::deleteConcurrentlyReadDataFiles()
+{
+    for (auto& crdf : m_concurrentlyReadDataFiles) {
+        if (crdf.m_caretDataFile != NULL) {
+            delete crdf.m_caretDataFile;
+        }
+    }
+    m_concurrentlyReadDataFiles.clear();
+}
+
 /**
  * Processing performed after adding or removing a data file.
  */
@@ -6477,11 +6772,34 @@ Brain::loadFilesSelectedInSpecFile(EventSpecFileReadDataFiles* readSpecFileDataF
                                        "Starting to read selected files");
     EventManager::get()->sendEvent(progressUpdate.getPointer());
 
+    const int32_t numFileGroups = sf->getNumberOfDataFileTypeGroups();
+    
+    /*
+     * Files that do not depend upon other files are read concurrently
+     * and then added to the brain, in order, by the loop that follows.
+     */
+    std::vector<std::pair<DataFileTypeEnum::Enum, AString>> concurrentFileTypesAndNames;
+    for (int32_t ig = 0; ig < numFileGroups; ig++) {
+        const SpecFileDataFileTypeGroup* group = sf->getDataFileTypeGroupByIndex(ig);
+        const int32_t numFiles = group->getNumberOfFiles();
+        for (int32_t iFile = 0; iFile < numFiles; iFile++) {
+            const SpecFileDataFile* dataFileInfo = group->getFileInformation(iFile);
+            if (dataFileInfo->isLoadingSelected()) {
+                concurrentFileTypesAndNames.push_back(std::make_pair(group->getDataFileType(),
+                                                                     dataFileInfo->getFileName()));
+            }
+        }
+    }
+    if ( ! readDataFilesConcurrently(concurrentFileTypesAndNames,
+                                     progressUpdate)) {
+        resetBrain();
+        return;
+    }
+    
     /*
      * Note: Need to read palette first since some of the individual file
      * reading routines update palette coloring when file is read
      */
-    const int32_t numFileGroups = sf->getNumberOfDataFileTypeGroups();
     for (int32_t ig = -1; ig < numFileGroups; ig++) {
         const SpecFileDataFileTypeGroup* group = ((ig == -1)
                                                ? sf->getDataFileTypeGroupByType(DataFileTypeEnum::PALETTE)
@@ -6534,6 +6852,8 @@ Brain::loadFilesSelectedInSpecFile(EventSpecFileReadDataFiles* readSpecFileDataF
         }
     }
     
+    deleteConcurrentlyReadDataFiles();
+    
     m_specFile->clearModified();
     
     if (errorMessage.isEmpty() == false) {
@@ -6751,12 +7071,42 @@ Brain::loadSpecFileFromScene(const SceneAttributes* sceneAttributes,
     m_nonModifiedFilesForRestoringScene.clear();
     
     
+    const int32_t numFileGroups = specFileToLoad->getNumberOfDataFileTypeGroups();
+    
+    /*
+     * Files that are not already in memory are read concurrently
+     * and then added to the brain, in order, by the loop that follows.
+     * Relative names of files with a scene file on the network are
+     * changed in that loop so those files are not read concurrently.
+     */
+    if ( ! sceneFileOnNetwork) {
+        std::vector<std::pair<DataFileTypeEnum::Enum, AString>> concurrentFileTypesAndNames;
+        for (int32_t ig = 0; ig < numFileGroups; ig++) {
+            const SpecFileDataFileTypeGroup* group = specFileToLoad->getDataFileTypeGroupByIndex(ig);
+            const int32_t numFiles = group->getNumberOfFiles();
+            for (int32_t iFile = 0; iFile < numFiles; iFile++) {
+                const SpecFileDataFile* fileInfo = group->getFileInformation(iFile);
+                if (fileInfo->isLoadingSelected()) {
+                    if (specFilesEntryToNonModifiedFile.find(fileInfo) == specFilesEntryToNonModifiedFile.end()) {
+                        concurrentFileTypesAndNames.push_back(std::make_pair(group->getDataFileType(),
+                                                                             fileInfo->getFileName()));
+                    }
+                }
+            }
+        }
+        if ( ! readDataFilesConcurrently(concurrentFileTypesAndNames,
+                                         progressEvent)) {
+            resetBrain(keepSceneFiles,
+                       keepSpecFile);
+            return;
+        }
+    }
+    
     /*
      * Load new files and add existing files that were previously loaded.
      */
     const int64_t numberOfFilesToLoad(specFileToLoad->getNumberOfFilesSelectedForLoading());
     int64_t fileLoadingCounter(1);
-    const int32_t numFileGroups = specFileToLoad->getNumberOfDataFileTypeGroups();
     for (int32_t ig = 0; ig < numFileGroups; ig++) {
         const SpecFileDataFileTypeGroup* group = specFileToLoad->getDataFileTypeGroupByIndex(ig);
         const DataFileTypeEnum::Enum dataFileType = group->getDataFileType();
@@ -6831,6 +7181,8 @@ Brain::loadSpecFileFromScene(const SceneAttributes* sceneAttributes,
         }
     }
     
+    deleteConcurrentlyReadDataFiles();
+    
     m_isSpecFileBeingRead = false;
     
     if (m_paletteFile != NULL) {
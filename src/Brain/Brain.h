@@ -22,6 +22,7 @@
 /*LICENSE_END*/
 
 #include <memory>
+#include <utility>
 #include <vector>
 #include <stdint.h>
 
@@ -89,6 +90,7 @@ namespace caret {
     class EventDataFileRead;
     class EventDataFileReload;
     class EventDataFileReloadAll;
+    class EventProgressUpdate;
     class EventSpecFileReadDataFiles;
     class GapsAndMargins;
     class HistologySlicesFile;
@@ -583,6 +585,42 @@ namespace caret {
                           const AString& dataFileName,
                           const bool markDataFileAsModified);
         
+        /**
+         * A data file that was read by another thread and is
+         * waiting to be added to the brain.
+         */
+        class ConcurrentlyReadDataFile {
+        public:
+            ConcurrentlyReadDataFile(const DataFileTypeEnum::Enum dataFileType,
+                                     const AString& dataFileName,
+                                     CaretDataFile* caretDataFile)
+            : m_dataFileType(dataFileType),
+            m_dataFileName(dataFileName),
+            m_caretDataFile(caretDataFile) { }
+            
+            DataFileTypeEnum::Enum m_dataFileType;
+            
+            AString m_dataFileName;
+            
+            CaretDataFile* m_caretDataFile;
+            
+            AString m_errorMessage;
+        };
+        
+        bool readDataFilesConcurrently(const std::vector<std::pair<DataFileTypeEnum::Enum, AString>>& dataFileTypesAndNames,
+                                       EventProgressUpdate& progressEvent);
+        
+        static AString readDataFileInThread(CaretDataFile* caretDataFile,
+                                            const AString dataFileName);
+        
+        CaretDataFile* addConcurrentlyReadDataFile(const DataFileTypeEnum::Enum dataFileType,
+                                                   const StructureEnum::Enum structure,
+                                                   const AString& dataFileName,
+                                                   const bool markDataFileAsModified,
+                                                   bool& foundOut);
+        
+        void deleteConcurrentlyReadDataFiles();
+        
         void sortDataFilesByFileNameNoPath();
         
         void createModelChartTwo();
@@ -897,6 +935,9 @@ namespace caret {
         
         std::vector<CaretDataFile*> m_nonModifiedFilesForRestoringScene;
         
+        /** Files read by other threads while loading a spec file or scene */
+        std::vector<ConcurrentlyReadDataFile> m_concurrentlyReadDataFiles;
+        
         mutable AString m_currentDirectory;
         
         SpecFile* m_specFile;
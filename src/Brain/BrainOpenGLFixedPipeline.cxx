@@ -71,6 +71,7 @@
 #include "CaretLogger.h"
 #include "CaretMappableDataFile.h"
 #include "CaretPreferences.h"
+#include "CaretTriangleLocator.h"
 #include "ChartableMatrixInterface.h"
 #include "ChartableMatrixSeriesInterface.h"
 #include "ChartModelDataSeries.h"
@@ -116,6 +117,7 @@
 #include "GraphicsEngineDataOpenGL.h"
 #include "GraphicsFramesPerSecond.h"
 #include "GraphicsObjectToWindowTransform.h"
+#include "GraphicsOpenGLSurfaceBuffers.h"
 #include "GraphicsOrthographicProjection.h"
 #include "GraphicsPrimitiveV3fC4f.h"
 #include "GraphicsPrimitiveV3fC4ub.h"
@@ -3073,7 +3075,6 @@ BrainOpenGLFixedPipeline::drawSurfaceTriangles(Surface* surface,
     
     const int32_t* triangles = surface->getTriangle(0);
     const float* coordinates = surface->getCoordinate(0);
-    const float* normals     = surface->getNormalVector(0);
 
     SelectionItemSurfaceTriangle* triangleID = NULL;
     /*
@@ -3099,52 +3100,23 @@ BrainOpenGLFixedPipeline::drawSurfaceTriangles(Surface* surface,
             break;
     }
     
-    if (isSelect) {
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    }
-    
-    uint8_t rgba[4];
-    
-    glBegin(GL_TRIANGLES);
-    for (int32_t i = 0; i < numTriangles; i++) {
-        const int32_t i3 = i * 3;
-        const int32_t n1 = triangles[i3];
-        const int32_t n2 = triangles[i3+1];
-        const int32_t n3 = triangles[i3+2];
-        
-        if (isSelect) {
-            this->colorIdentification->addItem(rgba, SelectionItemDataTypeEnum::SURFACE_TRIANGLE, i);
-            glColor3ubv(rgba);
-            glNormal3fv(&normals[n1*3]);
-            glVertex3fv(&coordinates[n1*3]);
-            glNormal3fv(&normals[n2*3]);
-            glVertex3fv(&coordinates[n2*3]);
-            glNormal3fv(&normals[n3*3]);
-            glVertex3fv(&coordinates[n3*3]);
-        }
-        else {
-            glColor4fv(&nodeColoringRGBA[n1*4]);
-            glNormal3fv(&normals[n1*3]);
-            glVertex3fv(&coordinates[n1*3]);
-            glColor4fv(&nodeColoringRGBA[n2*4]);
-            glNormal3fv(&normals[n2*3]);
-            glVertex3fv(&coordinates[n2*3]);
-            glColor4fv(&nodeColoringRGBA[n3*4]);
-            glNormal3fv(&normals[n3*3]);
-            glVertex3fv(&coordinates[n3*3]);
-        }
+    if ( ! isSelect) {
+        this->drawSurfaceTrianglesWithVertexArrays(surface,
+                                                   nodeColoringRGBA);
+        return;
     }
-    glEnd();
     
     if (isSelect) {
+        /*
+         * Intersect a ray through the mouse with the surface's triangles
+         * instead of drawing every triangle with a unique color and
+         * reading the pixel under the mouse.
+         */
         int32_t triangleIndex = -1;
         float depth = -1.0;
-        this->getIndexFromColorSelection(SelectionItemDataTypeEnum::SURFACE_TRIANGLE, 
-                                         this->mouseX, 
-                                         this->mouseY,
-                                         triangleIndex,
-                                         depth);
-        
+        this->getSurfaceTriangleAtMouseWithRay(surface,
+                                               triangleIndex,
+                                               depth);
         
         if (triangleIndex >= 0) {
             bool isTriangleIdAccepted = false;
@@ -3431,7 +3403,6 @@ BrainOpenGLFixedPipeline::drawSurfaceNodes(Surface* surface,
         case MODE_IDENTIFICATION:
             if (nodeID->isEnabledForSelection()) {
                 isSelect = true;
-                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);            
             }
             else {
                 return;
@@ -3441,42 +3412,57 @@ BrainOpenGLFixedPipeline::drawSurfaceNodes(Surface* surface,
             break;
     }
     
-    uint8_t rgba[4];
-
-    float pointSize = dps->getNodeSize();
     if (isSelect) {
-        if (pointSize < 2.0) {
-            pointSize = 2.0;
+        /*
+         * Use the vertex, of the triangle under the mouse, that is
+         * nearest to the mouse instead of drawing every vertex with
+         * a unique color and reading the pixel under the mouse.
+         */
+        int32_t triangleIndex = -1;
+        float triangleDepth = -1.0;
+        this->getSurfaceTriangleAtMouseWithRay(surface,
+                                               triangleIndex,
+                                               triangleDepth);
+        if (triangleIndex < 0) {
+            return;
         }
-    }
-    setPointSize(pointSize);
-    
-    glBegin(GL_POINTS);
-    for (int32_t i = 0; i < numNodes; i++) {
-        const int32_t i3 = i * 3;
         
-        if (isSelect) {
-            this->colorIdentification->addItem(rgba, SelectionItemDataTypeEnum::SURFACE_NODE, i);
-            glColor3ubv(rgba);
-            glNormal3fv(&normals[i3]);
-            glVertex3fv(&coordinates[i3]);
-        }
-        else {
-            glColor4fv(&nodeColoringRGBA[i*4]);
-            glNormal3fv(&normals[i3]);
-            glVertex3fv(&coordinates[i3]);
-        }
-    }
-    glEnd();
-    
-    if (isSelect) {
-        int nodeIndex = -1;
+        GLdouble modelviewMatrix[16];
+        glGetDoublev(GL_MODELVIEW_MATRIX, modelviewMatrix);
+        GLdouble projectionMatrix[16];
+        glGetDoublev(GL_PROJECTION_MATRIX, projectionMatrix);
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        
+        int32_t nodeIndex = -1;
         float depth = -1.0;
-        this->getIndexFromColorSelection(SelectionItemDataTypeEnum::SURFACE_NODE, 
-                                         this->mouseX, 
-                                         this->mouseY,
-                                         nodeIndex,
-                                         depth);
+        double nearestDistanceSquared = 0.0;
+        const int32_t* triangleNodes = surface->getTriangle(triangleIndex);
+        for (int32_t i = 0; i < 3; i++) {
+            const float* xyz = &coordinates[triangleNodes[i] * 3];
+            double windowXYZ[3];
+            if (gluProject(xyz[0],
+                           xyz[1],
+                           xyz[2],
+                           modelviewMatrix,
+                           projectionMatrix,
+                           viewport,
+                           &windowXYZ[0],
+                           &windowXYZ[1],
+                           &windowXYZ[2])) {
+                const double distanceSquared = MathFunctions::distanceSquared2D(windowXYZ[0],
+                                                                                windowXYZ[1],
+                                                                                this->mouseX,
+                                                                                this->mouseY);
+                if ((nodeIndex < 0)
+                    || (distanceSquared < nearestDistanceSquared)) {
+                    nodeIndex = triangleNodes[i];
+                    depth     = windowXYZ[2];
+                    nearestDistanceSquared = distanceSquared;
+                }
+            }
+        }
+        
         if (nodeIndex >= 0) {
             if (nodeID->isOtherScreenDepthCloserToViewer(depth)) {
                 nodeID->setBrain(surface->getBrainStructure()->getBrain());
@@ -3490,6 +3476,128 @@ BrainOpenGLFixedPipeline::drawSurfaceNodes(Surface* surface,
                 CaretLogFine("Rejecting Selected Vertex: " + nodeID->toString());
             }
         }
+        return;
+    }
+    
+    float pointSize = dps->getNodeSize();
+    setPointSize(pointSize);
+    
+    glBegin(GL_POINTS);
+    for (int32_t i = 0; i < numNodes; i++) {
+        const int32_t i3 = i * 3;
+        glColor4fv(&nodeColoringRGBA[i*4]);
+        glNormal3fv(&normals[i3]);
+        glVertex3fv(&coordinates[i3]);
+    }
+    glEnd();
+}
+
+/**
+ * Find the surface triangle under the mouse by intersecting a ray,
+ * from the near to the far clipping plane through the mouse position,
+ * with the surface's triangles.  Triangles are searched with a
+ * bounding volume hierarchy that is cached with the surface so this
+ * is much faster than drawing the triangles with identification colors,
+ * especially with software (Mesa) rendering.  Intersections removed
+ * by clipping planes are ignored.
+ *
+ * @param surface
+ *    The surface.
+ * @param triangleIndexOut
+ *    Output with index of triangle nearest the viewer under the mouse,
+ *    or -1 if there is no triangle under the mouse.
+ * @param depthOut
+ *    Output with window depth of the intersection (same as the
+ *    value that would have been read from the depth buffer).
+ */
+void
+BrainOpenGLFixedPipeline::getSurfaceTriangleAtMouseWithRay(Surface* surface,
+                                                           int32_t& triangleIndexOut,
+                                                           float& depthOut)
+{
+    triangleIndexOut = -1;
+    depthOut = -1.0;
+    
+    if (surface->getNumberOfTriangles() <= 0) {
+        return;
+    }
+    
+    GLdouble modelviewMatrix[16];
+    glGetDoublev(GL_MODELVIEW_MATRIX, modelviewMatrix);
+    GLdouble projectionMatrix[16];
+    glGetDoublev(GL_PROJECTION_MATRIX, projectionMatrix);
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    
+    double nearXYZ[3];
+    double farXYZ[3];
+    if ( ! gluUnProject(this->mouseX,
+                        this->mouseY,
+                        0.0,
+                        modelviewMatrix,
+                        projectionMatrix,
+                        viewport,
+                        &nearXYZ[0],
+                        &nearXYZ[1],
+                        &nearXYZ[2])) {
+        return;
+    }
+    if ( ! gluUnProject(this->mouseX,
+                        this->mouseY,
+                        1.0,
+                        modelviewMatrix,
+                        projectionMatrix,
+                        viewport,
+                        &farXYZ[0],
+                        &farXYZ[1],
+                        &farXYZ[2])) {
+        return;
+    }
+    
+    const float rayStart[3] = {
+        static_cast<float>(nearXYZ[0]),
+        static_cast<float>(nearXYZ[1]),
+        static_cast<float>(nearXYZ[2])
+    };
+    const float rayVector[3] = {
+        static_cast<float>(farXYZ[0] - nearXYZ[0]),
+        static_cast<float>(farXYZ[1] - nearXYZ[1]),
+        static_cast<float>(farXYZ[2] - nearXYZ[2])
+    };
+    
+    const StructureEnum::Enum structure = surface->getStructure();
+    const bool clippingFlag = m_clippingPlaneGroup->isSurfaceSelected();
+    
+    /*
+     * Ray vector spans near to far clipping planes so limit distance to one
+     */
+    TriangleRayHit rayHit;
+    if ( ! surface->getTriangleLocator()->closestRayIntersection(rayStart,
+                                                                 rayVector,
+                                                                 rayHit,
+                                                                 1.0f,
+                                                                 [&](const TriangleRayHit& hit) {
+                                                                     if (clippingFlag) {
+                                                                         return isCoordinateInsideClippingPlanesForStructure(structure,
+                                                                                                                             hit.xyz);
+                                                                     }
+                                                                     return true;
+                                                                 })) {
+        return;
+    }
+    
+    double windowXYZ[3];
+    if (gluProject(rayHit.xyz[0],
+                   rayHit.xyz[1],
+                   rayHit.xyz[2],
+                   modelviewMatrix,
+                   projectionMatrix,
+                   viewport,
+                   &windowXYZ[0],
+                   &windowXYZ[1],
+                   &windowXYZ[2])) {
+        triangleIndexOut = static_cast<int32_t>(rayHit.triangle);
+        depthOut = windowXYZ[2];
     }
 }
 
@@ -3542,9 +3650,35 @@ BrainOpenGLFixedPipeline::drawSurfaceCutEdges(Surface* surface,
  *    RGBA coloring for the nodes.
  */
 void 
-BrainOpenGLFixedPipeline::drawSurfaceTrianglesWithVertexArrays(const Surface* surface,
+BrainOpenGLFixedPipeline::drawSurfaceTrianglesWithVertexArrays(Surface* surface,
                                                                const float* nodeColoringRGBA)
 {
+    if (nodeColoringRGBA == NULL) {
+        glColor3fv(m_backgroundColorFloat);
+    }
+    
+    const int32_t numNodes     = surface->getNumberOfNodes();
+    const int32_t numTriangles = surface->getNumberOfTriangles();
+    
+    /*
+     * Coordinates, normals, and triangles remain in buffer objects
+     * cached with the surface and only the coloring is reloaded
+     * when it changes.
+     */
+    if (isVertexBuffersSupported()) {
+        GraphicsOpenGLSurfaceBuffers* surfaceBuffers = surface->getOpenGLSurfaceBuffers();
+        CaretAssert(surfaceBuffers);
+        if (surfaceBuffers->draw(getContextSharingGroupPointer(),
+                                 numNodes,
+                                 surface->getCoordinate(0),
+                                 surface->getNormalVector(0),
+                                 numTriangles,
+                                 surface->getTriangle(0),
+                                 nodeColoringRGBA)) {
+            return;
+        }
+    }
+    
     glEnableClientState(GL_VERTEX_ARRAY);
     if (nodeColoringRGBA != NULL) {
         glEnableClientState(GL_COLOR_ARRAY);
@@ -3560,14 +3694,10 @@ BrainOpenGLFixedPipeline::drawSurfaceTrianglesWithVertexArrays(const Surface* su
                        0,
                        reinterpret_cast<const GLvoid*>(nodeColoringRGBA));
     }
-    else {
-        glColor3fv(m_backgroundColorFloat);
-    }
     glNormalPointer(GL_FLOAT,
                     0, 
                     reinterpret_cast<const GLvoid*>(surface->getNormalVector(0)));
     
-    const int numTriangles = surface->getNumberOfTriangles();
     glDrawElements(GL_TRIANGLES, 
                    (3 * numTriangles), 
                    GL_UNSIGNED_INT,
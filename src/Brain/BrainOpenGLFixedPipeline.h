@@ -244,12 +244,16 @@ namespace caret {
         void drawSurfaceCutEdges(Surface* surface,
                                  const float* nodeColoringRGBA);
         
-        void drawSurfaceTrianglesWithVertexArrays(const Surface* surface,
+        void drawSurfaceTrianglesWithVertexArrays(Surface* surface,
                                                   const float* nodeColoringRGBA);
         
         void drawSurfaceTriangles(Surface* surface,
                                   const float* nodeColoringRGBA);
         
+        void getSurfaceTriangleAtMouseWithRay(Surface* surface,
+                                              int32_t& triangleIndexOut,
+                                              float& depthOut);
+        
         void drawSurfaceNodeAttributes(Surface* surface,
                                        const int32_t viewportHeight);
         
@@ -452,7 +452,10 @@ BrainOpenGLHistologySliceDrawing::drawModelLayers(const GraphicsOrthographicProj
                                                      transform);
         }
         else if (imageFile != NULL) {
-            /* nothing */
+            imageFile->updateImageForDrawingInTab(drawingData.m_tabIndex,
+                                                  drawingData.m_overlayIndex,
+                                                  MediaDisplayCoordinateModeEnum::PLANE,
+                                                  transform);
         }
         else {
             CaretAssertMessage(0, ("Unrecognized file type "
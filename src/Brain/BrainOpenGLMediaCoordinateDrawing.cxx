@@ -366,7 +366,10 @@ BrainOpenGLMediaCoordinateDrawing::drawModelLayers(const BrainOpenGLViewportCont
                                                      transform);
         }
         else if (imageFile != NULL) {
-            /* nothing */
+            imageFile->updateImageForDrawingInTab(selectionData.m_tabIndex,
+                                                  selectionData.m_overlayIndex,
+                                                  MediaDisplayCoordinateModeEnum::PLANE,
+                                                  transform);
         }
         else {
             CaretAssertMessage(0, ("Unrecognized file type "
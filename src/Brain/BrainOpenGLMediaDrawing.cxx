@@ -340,6 +340,10 @@ BrainOpenGLMediaDrawing::drawModelLayers(const BrainOpenGLViewportContent* viewp
                      * Image is drawn using a primitive in which
                      * the image is a texture
                      */
+                    imageFile->updateImageForDrawingInTab(tabIndex,
+                                                          iOverlay,
+                                                          MediaDisplayCoordinateModeEnum::PIXEL,
+                                                          transform);
                     primitive = imageFile->getGraphicsPrimitiveForMediaDrawing(tabIndex,
                                                                                iOverlay);
                     
@@ -23,6 +23,8 @@
 #include "SurfaceNodeColoring.h"
 #undef __SURFACE_NODE_COLORING_DECLARE__
 
+#include <algorithm>
+
 #include "Brain.h"
 #include "BrainordinateRegionOfInterest.h"
 #include "BrainStructure.h"
@@ -59,6 +61,7 @@
 #include "Overlay.h"
 #include "OverlaySet.h"
 #include "Palette.h"
+#include "PaletteColorLookupTable.h"
 #include "PaletteColorMapping.h"
 #include "PaletteScalarAndColor.h"
 #include "RgbaFile.h"
@@ -947,6 +950,7 @@ SurfaceNodeColoring::assignMetricColoring(const BrainStructure* brainStructure,
     const float* metricDisplayData = metricFile->getValuePointerForColumn(displayColumn);
     float* metricThresholdData = const_cast<float*>(metricDisplayData);
     PaletteColorMapping* thresholdPaletteColorMapping = paletteColorMapping;
+    const MetricFile* thresholdMetricFile = metricFile;
     
     if (useThreshMapFileFlag) {
         const CaretMappableDataFileAndMapSelectionModel* threshFileModel = metricFile->getMapThresholdFileSelectionModel(displayColumn);
@@ -961,6 +965,7 @@ SurfaceNodeColoring::assignMetricColoring(const BrainStructure* brainStructure,
                     metricThresholdData = const_cast<float*>(threshMetricFile->getValuePointerForColumn(threshMapIndex));
                     thresholdPaletteColorMapping = const_cast<PaletteColorMapping*>(threshMapFile->getMapPaletteColorMapping(threshMapIndex));
                     CaretAssert(thresholdPaletteColorMapping);
+                    thresholdMetricFile = threshMetricFile;
                 }
             }
         }
@@ -994,6 +999,48 @@ SurfaceNodeColoring::assignMetricColoring(const BrainStructure* brainStructure,
     CaretAssert(statistics);
     
     if (statistics != NULL) {
+        /*
+         * Key for cached coloring
+         */
+        MetricColoringCacheEntry cacheKey;
+        cacheKey.m_metricFile = metricFile;
+        cacheKey.m_metricFileModificationStamp = metricFile->getModificationStamp();
+        cacheKey.m_mapIndex = displayColumn;
+        cacheKey.m_numberOfNodes = numberOfNodes;
+        cacheKey.m_paletteColorMapping = paletteColorMapping;
+        cacheKey.m_paletteColorMappingModificationStamp = paletteColorMapping->getModificationStamp();
+        cacheKey.m_thresholdPaletteColorMapping = thresholdPaletteColorMapping;
+        cacheKey.m_thresholdPaletteColorMappingModificationStamp = thresholdPaletteColorMapping->getModificationStamp();
+        cacheKey.m_thresholdData = metricThresholdData;
+        cacheKey.m_thresholdMetricFile = thresholdMetricFile;
+        cacheKey.m_thresholdMetricFileModificationStamp = thresholdMetricFile->getModificationStamp();
+        cacheKey.m_statistics = statistics;
+        
+        /*
+         * The palette's lookup table changes if the palette is edited
+         */
+        const Palette* palette = paletteColorMapping->getPalette();
+        if (palette != NULL) {
+            cacheKey.m_colorLookupTable = palette->getColorLookupTable(paletteColorMapping->isInterpolatePaletteFlag());
+        }
+        
+        for (auto iter = m_metricColoringCache.begin();
+             iter != m_metricColoringCache.end();
+             iter++) {
+            if (iter->isSameKey(cacheKey)) {
+                CaretAssert(static_cast<int32_t>(iter->m_rgba.size()) == (numberOfNodes * 4));
+                std::copy(iter->m_rgba.begin(),
+                          iter->m_rgba.end(),
+                          rgbv);
+                if (iter != m_metricColoringCache.begin()) {
+                    MetricColoringCacheEntry entry(std::move(*iter));
+                    m_metricColoringCache.erase(iter);
+                    m_metricColoringCache.push_front(std::move(entry));
+                }
+                return true;
+            }
+        }
+        
         NodeAndVoxelColoring::colorScalarsWithPalette(statistics, 
                                                       paletteColorMapping, 
                                                       metricDisplayData,
@@ -1001,11 +1048,45 @@ SurfaceNodeColoring::assignMetricColoring(const BrainStructure* brainStructure,
                                                       metricThresholdData, 
                                                       numberOfNodes, 
                                                       rgbv);
+        
+        if (palette != NULL) {
+            cacheKey.m_rgba.assign(rgbv,
+                                   rgbv + (numberOfNodes * 4));
+            m_metricColoringCache.push_front(std::move(cacheKey));
+            while (static_cast<int32_t>(m_metricColoringCache.size()) > s_maximumMetricColoringCacheEntries) {
+                m_metricColoringCache.pop_back();
+            }
+        }
     }
     
     return true;
 }
 
+/**
+ * @return True if the given entry is for the same metric map with the same
+ * palette, thresholding, and data (ignores the coloring).
+ *
+ * @param entry
+ *     Entry compared to this entry.
+ */
+bool
+SurfaceNodeColoring::MetricColoringCacheEntry::isSameKey(const MetricColoringCacheEntry& entry) const
+{
+    return ((m_metricFile == entry.m_metricFile)
+            && (m_metricFileModificationStamp == entry.m_metricFileModificationStamp)
+            && (m_mapIndex == entry.m_mapIndex)
+            && (m_numberOfNodes == entry.m_numberOfNodes)
+            && (m_paletteColorMapping == entry.m_paletteColorMapping)
+            && (m_paletteColorMappingModificationStamp == entry.m_paletteColorMappingModificationStamp)
+            && (m_thresholdPaletteColorMapping == entry.m_thresholdPaletteColorMapping)
+            && (m_thresholdPaletteColorMappingModificationStamp == entry.m_thresholdPaletteColorMappingModificationStamp)
+            && (m_thresholdData == entry.m_thresholdData)
+            && (m_thresholdMetricFile == entry.m_thresholdMetricFile)
+            && (m_thresholdMetricFileModificationStamp == entry.m_thresholdMetricFileModificationStamp)
+            && (m_statistics == entry.m_statistics)
+            && (m_colorLookupTable == entry.m_colorLookupTable));
+}
+
 /**
  * Assign cifti scalar coloring to nodes
  * @param brainStructure
@@ -22,6 +22,9 @@
 /*LICENSE_END*/
 
 #include <array>
+#include <deque>
+#include <memory>
+#include <vector>
 
 #include "CaretColorEnum.h"
 #include "CaretObject.h"
@@ -42,12 +45,14 @@ namespace caret {
     class CiftiParcelScalarFile;
     class CiftiParcelSeriesFile;
     class DisplayPropertiesLabels;
+    class FastStatistics;
     class GiftiLabelTable;
     class Model;
     class LabelFile;
     class MetricFile;
     class OverlaySet;
     class Palette;
+    class PaletteColorLookupTable;
     class PaletteColorMapping;
     class RgbaFile;
     class Surface;
@@ -170,9 +175,41 @@ namespace caret {
         void showBrainordinateHighlightRegionOfInterest(const Brain* brain,
                                                         const Surface* surface,
                                                         float* rgbaNodeColors);
+        
+        /**
+         * Metric coloring that is saved so that it does not need to be recomputed
+         * when the metric map is displayed in more than one tab or when the
+         * surface is redrawn and the metric and its palette have not changed.
+         */
+        class MetricColoringCacheEntry {
+        public:
+            const MetricFile* m_metricFile = NULL;
+            int64_t m_metricFileModificationStamp = 0;
+            int32_t m_mapIndex = -1;
+            int32_t m_numberOfNodes = 0;
+            const PaletteColorMapping* m_paletteColorMapping = NULL;
+            int64_t m_paletteColorMappingModificationStamp = 0;
+            const PaletteColorMapping* m_thresholdPaletteColorMapping = NULL;
+            int64_t m_thresholdPaletteColorMappingModificationStamp = 0;
+            const float* m_thresholdData = NULL;
+            const MetricFile* m_thresholdMetricFile = NULL;
+            int64_t m_thresholdMetricFileModificationStamp = 0;
+            const FastStatistics* m_statistics = NULL;
+            std::shared_ptr<const PaletteColorLookupTable> m_colorLookupTable;
+            std::vector<float> m_rgba;
+            
+            bool isSameKey(const MetricColoringCacheEntry& entry) const;
+        };
+        
+        /** Cached metric coloring, most recently used first */
+        std::deque<MetricColoringCacheEntry> m_metricColoringCache;
+        
+        /** Maximum number of entries in the metric coloring cache */
+        static const int32_t s_maximumMetricColoringCacheEntries;
     };
     
 #ifdef __SURFACE_NODE_COLORING_DECLARE__
+    const int32_t SurfaceNodeColoring::s_maximumMetricColoringCacheEntries = 8;
 #endif // __SURFACE_NODE_COLORING_DECLARE__
 
 } // namespace
@@ -21,6 +21,11 @@
 //******************************************************************************
 
 #include "stdafx.h"
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include "SingleChannelScalingTileAccessor.h"
 #include "utilities.h"
 #include "BitmapOperations.h"
@@ -83,7 +88,7 @@ CSingleChannelScalingTileAccessor::CSingleChannelScalingTileAccessor(std::shared
 	return IntSize{ (uint32_t)(roi.w*zoom),(uint32_t)(roi.h*zoom) };
 }
 
-void CSingleChannelScalingTileAccessor::ScaleBlt(libCZI::IBitmapData* bmDest, float /*zoom*/, const libCZI::IntRect&  roi, const SbInfo& sbInfo)
+void CSingleChannelScalingTileAccessor::ScaleBlt(libCZI::IBitmapData* bmDest, float /*zoom*/, const libCZI::IntRect&  roi, const SbInfo& sbInfo, libCZI::IBitmapData* bmSubBlock)
 {
 	// calculate the intersection of the with the subblock (logical rect) and the destination
 	auto intersect = Utilities::Intersect(sbInfo.logicalRect, roi);
@@ -111,6 +116,20 @@ void CSingleChannelScalingTileAccessor::ScaleBlt(libCZI::IBitmapData* bmDest, fl
 	dstRoi.w *= bmDest->GetWidth();
 	dstRoi.h *= bmDest->GetHeight();
 
+	CBitmapOperations::NNResize(bmSubBlock, bmDest, srcRoi, dstRoi);
+}
+
+void CSingleChannelScalingTileAccessor::ScaleBlt(libCZI::IBitmapData* bmDest, float zoom, const libCZI::IntRect&  roi, const SbInfo& sbInfo)
+{
+	auto spBm = this->DecodeSubBlock(sbInfo);
+	this->ScaleBlt(bmDest, zoom, roi, sbInfo, spBm.get());
+}
+
+/// <summary>	Reads the subblock from the repository and decodes (decompresses) it into a bitmap. </summary>
+/// <param name="sbInfo">	Information describing the subblock. </param>
+/// <returns>	The bitmap of the subblock. </returns>
+std::shared_ptr<libCZI::IBitmapData> CSingleChannelScalingTileAccessor::DecodeSubBlock(const SbInfo& sbInfo)
+{
 	auto sb = this->sbBlkRepository->ReadSubBlock(sbInfo.index);
 	if (GetSite()->IsEnabled(LOGLEVEL_CHATTYINFORMATION))
 	{
@@ -119,9 +138,137 @@ void CSingleChannelScalingTileAccessor::ScaleBlt(libCZI::IBitmapData* bmDest, fl
 		GetSite()->Log(LOGLEVEL_CHATTYINFORMATION, ss);
 	}
 
-	auto spBm = sb->CreateBitmap();
+	return sb->CreateBitmap();
+}
+
+/// <summary>	
+/// Decodes the subblocks with a pool of threads and draws them into the destination bitmap on the calling thread.
+/// Subblocks may overlap, so they are drawn in the order given, exactly as if they were decoded and drawn one after
+/// the other. Decoding may run ahead of drawing by a small number of subblocks so that the memory used for decoded
+/// bitmaps is bounded.
+/// </summary>
+/// <param name="bmDest">			The destination bitmap. </param>
+/// <param name="zoom">				The zoom. </param>
+/// <param name="roi">				The ROI. </param>
+/// <param name="sbInfos">			The subblocks in the order in which they are drawn. </param>
+/// <param name="maxDecodeThreads">	The maximum number of threads used for decoding. </param>
+void CSingleChannelScalingTileAccessor::DecodeAndScaleBltConcurrently(libCZI::IBitmapData* bmDest, float zoom, const libCZI::IntRect&  roi, const std::vector<const SbInfo*>& sbInfos, int maxDecodeThreads)
+{
+	struct DecodedSubBlock
+	{
+		std::shared_ptr<libCZI::IBitmapData> bitmap;
+		std::exception_ptr error;
+		bool done = false;
+	};
+
+	const size_t count = sbInfos.size();
+	const size_t threadCount = (std::min)(static_cast<size_t>(maxDecodeThreads), count);
+	const size_t maxDecodedAhead = 2 * threadCount;
+
+	std::vector<DecodedSubBlock> decoded(count);
+	std::mutex mutex;
+	std::condition_variable decodedCondition;
+	std::condition_variable drawnCondition;
+	size_t nextToDecode = 0;
+	size_t nextToDraw = 0;
+	bool stop = false;
+
+	auto decodeSubBlocks = [&]()->void
+	{
+		for (;;)
+		{
+			size_t idx;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				drawnCondition.wait(lock, [&]()->bool { return stop || nextToDecode >= count || nextToDecode < nextToDraw + maxDecodedAhead; });
+				if (stop || nextToDecode >= count)
+				{
+					return;
+				}
+
+				idx = nextToDecode++;
+			}
+
+			std::shared_ptr<libCZI::IBitmapData> bitmap;
+			std::exception_ptr error;
+			try
+			{
+				bitmap = this->DecodeSubBlock(*sbInfos[idx]);
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				decoded[idx].bitmap = std::move(bitmap);
+				decoded[idx].error = error;
+				decoded[idx].done = true;
+			}
+
+			decodedCondition.notify_all();
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; ++i)
+	{
+		threads.emplace_back(decodeSubBlocks);
+	}
+
+	std::exception_ptr error;
+	for (size_t i = 0; i < count; ++i)
+	{
+		std::shared_ptr<libCZI::IBitmapData> bitmap;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			decodedCondition.wait(lock, [&]()->bool { return decoded[i].done; });
+			bitmap = std::move(decoded[i].bitmap);
+			error = decoded[i].error;
+		}
+
+		if (!error)
+		{
+			try
+			{
+				this->ScaleBlt(bmDest, zoom, roi, *sbInfos[i], bitmap.get());
+			}
+			catch (...)
+			{
+				error = std::current_exception();
+			}
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (error)
+			{
+				stop = true;
+			}
+			else
+			{
+				nextToDraw = i + 1;
+			}
+		}
+
+		drawnCondition.notify_all();
+		if (error)
+		{
+			break;
+		}
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
 
-	CBitmapOperations::NNResize(spBm.get(), bmDest, srcRoi, dstRoi);
+	if (error)
+	{
+		std::rethrow_exception(error);
+	}
 }
 
 int CSingleChannelScalingTileAccessor::GetIdxOf1stSubBlockWithZoomGreater(const std::vector<SbInfo>& sbBlks, const std::vector<int>& byZoom, float zoom)
@@ -224,19 +371,19 @@ void CSingleChannelScalingTileAccessor::InternalGet(libCZI::IBitmapData* bmDest,
 	{
 		// we only have to deal with a single scene (or: the document does not include a scene-dimension at all)
 		auto sbSetsortedByZoom = this->GetSubSetSortedByZoom(roi, planeCoordinate);
-		this->Paint(bmDest, roi, sbSetsortedByZoom, zoom);
+		this->Paint(bmDest, roi, sbSetsortedByZoom, zoom, options.maxDecodeThreads);
 	}
 	else
 	{
 		auto sbSetSortedByZoomPerScene = this->GetSubSetSortedByZoomPerScene(scenesInvolved, roi, planeCoordinate);
 		for (const auto& it : sbSetSortedByZoomPerScene)
 		{
-			this->Paint(bmDest, roi, get<1>(it), zoom);
+			this->Paint(bmDest, roi, get<1>(it), zoom, options.maxDecodeThreads);
 		}
 	}
 }
 
-void CSingleChannelScalingTileAccessor::Paint(libCZI::IBitmapData* bmDest, const libCZI::IntRect&  roi, const SubSetSortedByZoom& sbSetSortedByZoom, float zoom)
+void CSingleChannelScalingTileAccessor::Paint(libCZI::IBitmapData* bmDest, const libCZI::IntRect&  roi, const SubSetSortedByZoom& sbSetSortedByZoom, float zoom, int maxDecodeThreads)
 {
 	int idxOf1stSSubBlockOfZoomGreater = this->GetIdxOf1stSubBlockWithZoomGreater(sbSetSortedByZoom.subBlocks, sbSetSortedByZoom.sortedByZoom, zoom);
 	if (idxOf1stSSubBlockOfZoomGreater < 0)
@@ -254,6 +401,7 @@ void CSingleChannelScalingTileAccessor::Paint(libCZI::IBitmapData* bmDest, const
 
 	float startZoom = sbSetSortedByZoom.subBlocks.at(*it).GetZoom();
 
+	std::vector<const SbInfo*> sbInfosToDraw;
 	for (; it != sbSetSortedByZoom.sortedByZoom.cend(); ++it)
 	{
 		const SbInfo& sbInfo = sbSetSortedByZoom.subBlocks.at(*it);
@@ -271,7 +419,19 @@ void CSingleChannelScalingTileAccessor::Paint(libCZI::IBitmapData* bmDest, const
 			GetSite()->Log(LOGLEVEL_CHATTYINFORMATION, ss);
 		}
 
-		this->ScaleBlt(bmDest, zoom, roi, sbInfo);
+		sbInfosToDraw.push_back(&sbInfo);
+	}
+
+	if (maxDecodeThreads > 1 && sbInfosToDraw.size() > 1)
+	{
+		this->DecodeAndScaleBltConcurrently(bmDest, zoom, roi, sbInfosToDraw, maxDecodeThreads);
+	}
+	else
+	{
+		for (const SbInfo* sbInfo : sbInfosToDraw)
+		{
+			this->ScaleBlt(bmDest, zoom, roi, *sbInfo);
+		}
 	}
 }
 
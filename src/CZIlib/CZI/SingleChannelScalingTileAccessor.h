@@ -56,6 +56,9 @@ private:
 	std::vector<SbInfo> GetSubSet(const libCZI::IntRect& roi, const libCZI::IDimCoordinate* planeCoordinate);
 	int GetIdxOf1stSubBlockWithZoomGreater(const std::vector<SbInfo>& sbBlks, const std::vector<int>& byZoom, float zoom);
 	void ScaleBlt(libCZI::IBitmapData* bmDest, float zoom, const libCZI::IntRect&  roi, const SbInfo& sbInfo);
+	void ScaleBlt(libCZI::IBitmapData* bmDest, float zoom, const libCZI::IntRect&  roi, const SbInfo& sbInfo, libCZI::IBitmapData* bmSubBlock);
+	std::shared_ptr<libCZI::IBitmapData> DecodeSubBlock(const SbInfo& sbInfo);
+	void DecodeAndScaleBltConcurrently(libCZI::IBitmapData* bmDest, float zoom, const libCZI::IntRect&  roi, const std::vector<const SbInfo*>& sbInfos, int maxDecodeThreads);
 
 	void InternalGet(libCZI::IBitmapData* bmDest, const libCZI::IntRect&  roi, const libCZI::IDimCoordinate* planeCoordinate, float zoom, const libCZI::ISingleChannelScalingTileAccessor::Options& options);
 
@@ -70,5 +73,5 @@ private:
 	SubSetSortedByZoom GetSubSetSortedByZoom(const libCZI::IntRect& roi, const libCZI::IDimCoordinate* planeCoordinate);
 
 	std::vector<std::tuple<int, SubSetSortedByZoom>> GetSubSetSortedByZoomPerScene(const std::vector<int>& scenes, const libCZI::IntRect& roi, const libCZI::IDimCoordinate* planeCoordinate);
-	void Paint(libCZI::IBitmapData* bmDest, const libCZI::IntRect&  roi,const SubSetSortedByZoom& sbSetSortedByZoom, float zoom);
+	void Paint(libCZI::IBitmapData* bmDest, const libCZI::IntRect&  roi,const SubSetSortedByZoom& sbSetSortedByZoom, float zoom, int maxDecodeThreads);
 };
@@ -255,12 +255,20 @@ namespace libCZI
 			/// If specified, only subblocks with a scene-index contained in the set will be considered.
 			std::shared_ptr<libCZI::IIndexSet> sceneFilter;
 
+			/// The maximum number of threads used for decoding subblocks. Subblocks are decoded
+			/// concurrently and composed in their original order, so the result does not depend on
+			/// the number of threads. Values less than 2 decode all subblocks on the calling thread.
+			/// The stream used by the reader must allow concurrent calls to IStream::Read if this
+			/// is greater than one.
+			int maxDecodeThreads;
+
 			/// Clears this object to its blank state.
 			void Clear()
 			{
 				this->drawTileBorder = false;
 				this->backGroundColor.r = this->backGroundColor.g = this->backGroundColor.b = std::numeric_limits<float>::quiet_NaN();
 				this->sceneFilter.reset();
+				this->maxDecodeThreads = 1;
 			}
 		};
 
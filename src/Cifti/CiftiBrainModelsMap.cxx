@@ -22,10 +22,8 @@
 
 #include "DataFileException.h"
 
-#include <QRegularExpression>
-#include <QStringList>
-
 #include <algorithm>
+#include <limits>
 
 using namespace std;
 using namespace caret;
@@ -56,7 +54,7 @@ void CiftiBrainModelsMap::addSurfaceModel(const int64_t& numberOfNodes, const St
     myModel.m_surfaceNumberOfNodes = numberOfNodes;
     myModel.m_nodeIndices = nodeList;
     myModel.setupSurface(getNextStart());//do internal setup - also does error checking
-    m_modelsInfo.push_back(myModel);
+    m_modelsInfo.push_back(std::move(myModel));
     m_surfUsed[structure] = m_modelsInfo.size() - 1;
 }
 
@@ -73,8 +71,18 @@ void CiftiBrainModelsMap::BrainModelPriv::setupSurface(const int64_t& start)
         throw DataFileException("vertex list must have nonzero length");//NOTE: technically not required by Cifti-1, remove if problematic
     }
     m_modelEnd = start + listSize;//one after last
-    vector<bool> used(m_surfaceNumberOfNodes, false);
-    m_nodeToIndexLookup = vector<int64_t>(m_surfaceNumberOfNodes, -1);//reset all to -1 to start
+    if (m_surfaceNumberOfNodes > numeric_limits<int32_t>::max())
+    {
+        throw DataFileException("surface has too many vertices: " + AString::number(m_surfaceNumberOfNodes));
+    }
+    m_nodeToOffsetLookup.clear();
+    bool isAllNodes = (listSize == m_surfaceNumberOfNodes);
+    for (int64_t i = 0; isAllNodes && i < listSize; ++i)
+    {
+        isAllNodes = (m_nodeIndices[i] == i);
+    }
+    if (isAllNodes) return;//common for full surfaces, index is just start + node, skip the lookup
+    m_nodeToOffsetLookup.resize(m_surfaceNumberOfNodes, -1);//doubles as the reuse check
     for (int64_t i = 0; i < listSize; ++i)
     {
         if (m_nodeIndices[i] < 0)
@@ -85,12 +93,11 @@ void CiftiBrainModelsMap::BrainModelPriv::setupSurface(const int64_t& start)
         {
             throw DataFileException("vertex list contains an index that don't exist in the surface");
         }
-        if (used[m_nodeIndices[i]])
+        if (m_nodeToOffsetLookup[m_nodeIndices[i]] != -1)
         {
             throw DataFileException("vertex list contains reused index");
         }
-        used[m_nodeIndices[i]] = true;
-        m_nodeToIndexLookup[m_nodeIndices[i]] = start + i;
+        m_nodeToOffsetLookup[m_nodeIndices[i]] = (int32_t)i;
     }
 }
 
@@ -119,39 +126,59 @@ void CiftiBrainModelsMap::addVolumeModel(const StructureEnum::Enum& structure, c
         }
         dims = m_volSpace.getDims();
     }
-    CaretCompact3DLookup<std::pair<int64_t, StructureEnum::Enum> > tempLookup = m_voxelToIndexLookup;//a copy of the lookup should be faster than other methods of checking for overlap and repeat
     int64_t nextStart = getNextStart();
-    for (int64_t index = 0; index < numElems; ++index)//do all error checking before adding to lookup
-    {
-        int64_t index3 = index * 3;
-        if (ijkList[index3] < 0 || ijkList[index3 + 1] < 0 || ijkList[index3 + 2] < 0)
-        {
-            throw DataFileException("found negative index in voxel list");
-        }
-        if (!m_ignoreVolSpace && (ijkList[index3] >= dims[0] ||
-                                    ijkList[index3 + 1] >= dims[1] ||
-                                    ijkList[index3 + 2] >= dims[2]))
-        {
-            throw DataFileException("found invalid index triple in voxel list: (" + AString::number(ijkList[index3]) + ", "
-                                  + AString::number(ijkList[index3 + 1]) + ", " + AString::number(ijkList[index3 + 2]) + ")");
-        }
-        if (tempLookup.find(ijkList[index3], ijkList[index3 + 1], ijkList[index3 + 2]) != NULL)
+    try
+    {//insert directly, copying the whole lookup for every structure is slow for high-res volumes
+        for (int64_t index = 0; index < numElems; ++index)
         {
-            throw DataFileException("volume models may not reuse voxels, either internally or from other structures");
+            int64_t index3 = index * 3;
+            if (ijkList[index3] < 0 || ijkList[index3 + 1] < 0 || ijkList[index3 + 2] < 0)
+            {
+                throw DataFileException("found negative index in voxel list");
+            }
+            if (!m_ignoreVolSpace && (ijkList[index3] >= dims[0] ||
+                                        ijkList[index3 + 1] >= dims[1] ||
+                                        ijkList[index3 + 2] >= dims[2]))
+            {
+                throw DataFileException("found invalid index triple in voxel list: (" + AString::number(ijkList[index3]) + ", "
+                                      + AString::number(ijkList[index3 + 1]) + ", " + AString::number(ijkList[index3 + 2]) + ")");
+            }
+            if (m_voxelToIndexLookup.find(ijkList[index3], ijkList[index3 + 1], ijkList[index3 + 2]) != NULL)
+            {
+                throw DataFileException("volume models may not reuse voxels, either internally or from other structures");
+            }
+            m_voxelToIndexLookup.at(ijkList[index3], ijkList[index3 + 1], ijkList[index3 + 2]) = pair<int64_t, StructureEnum::Enum>(nextStart + index, structure);
         }
-        tempLookup.at(ijkList[index3], ijkList[index3 + 1], ijkList[index3 + 2]) = pair<int64_t, StructureEnum::Enum>(nextStart + index, structure);
+    } catch (...) {
+        rebuildVoxelLookup();//drop what we added, so a failed add leaves the mapping unchanged
+        throw;
     }
-    m_voxelToIndexLookup = tempLookup;
     BrainModelPriv myModel;
     myModel.m_type = VOXELS;
     myModel.m_brainStructure = structure;
     myModel.m_voxelIndicesIJK = ijkList;
     myModel.m_modelStart = nextStart;
     myModel.m_modelEnd = nextStart + numElems;//one after last
-    m_modelsInfo.push_back(myModel);
+    m_modelsInfo.push_back(std::move(myModel));
     m_volUsed[structure] = m_modelsInfo.size() - 1;
 }
 
+void CiftiBrainModelsMap::rebuildVoxelLookup()
+{
+    m_voxelToIndexLookup.clear();
+    for (int i = 0; i < (int)m_modelsInfo.size(); ++i)
+    {
+        const BrainModelPriv& myModel = m_modelsInfo[i];
+        if (myModel.m_type != VOXELS) continue;
+        int64_t numElems = (int64_t)myModel.m_voxelIndicesIJK.size() / 3;
+        for (int64_t index = 0; index < numElems; ++index)
+        {
+            const int64_t* ijk = myModel.m_voxelIndicesIJK.data() + index * 3;
+            m_voxelToIndexLookup.at(ijk[0], ijk[1], ijk[2]) = pair<int64_t, StructureEnum::Enum>(myModel.m_modelStart + index, myModel.m_brainStructure);
+        }
+    }
+}
+
 void CiftiBrainModelsMap::clear()
 {
     m_modelsInfo.clear();
@@ -173,8 +200,11 @@ int64_t CiftiBrainModelsMap::getIndexForNode(const int64_t& node, const Structur
     CaretAssertVectorIndex(m_modelsInfo, iter->second);
     const BrainModelPriv& myModel = m_modelsInfo[iter->second];
     if (node >= myModel.m_surfaceNumberOfNodes) return -1;
-    CaretAssertVectorIndex(myModel.m_nodeToIndexLookup, node);
-    return myModel.m_nodeToIndexLookup[node];
+    if (myModel.m_nodeToOffsetLookup.empty()) return myModel.m_modelStart + node;//model has every vertex in order
+    CaretAssertVectorIndex(myModel.m_nodeToOffsetLookup, node);
+    int32_t offset = myModel.m_nodeToOffsetLookup[node];
+    if (offset < 0) return -1;
+    return myModel.m_modelStart + offset;
 }
 
 int64_t CiftiBrainModelsMap::getIndexForVoxel(const int64_t* ijk, StructureEnum::Enum* structureOut) const
@@ -888,36 +918,73 @@ void CiftiBrainModelsMap::ParseHelperModel::parseBrainModel2(QXmlStreamReader& x
     CaretAssert(xml.isEndElement() && xml.name() == QLatin1String("BrainModel"));
 }
 
-vector<int64_t> CiftiBrainModelsMap::ParseHelperModel::readIndexArray(QXmlStreamReader& xml)
+namespace
 {
+    inline bool isIndexSeparator(const ushort c)
+    {//same as the \s the old regex split used, with the common ascii cases first
+        if (c == ' ' || c == '\n' || c == '\t' || c == '\r') return true;
+        if (c < 128) return c == '\v' || c == '\f';
+        return QChar(c).isSpace();
+    }
+}
+
+vector<int64_t> CiftiBrainModelsMap::ParseHelperModel::readIndexArray(QXmlStreamReader& xml)
+{//high-res files have megabytes of these, so tokenize and convert in place instead of splitting into strings
     vector<int64_t> ret;
     QString text = xml.readElementText();//raises error if it encounters a start element
     if (xml.hasError()) return ret;
-#if QT_VERSION >= 0x060102
-    QStringView textView(text);
-    auto separated = textView.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
-#elif QT_VERSION >= 0x060000
-    auto separated = text.tokenize(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
-    //can't do an exact reserve, tokenize is one at a time, there is no splitRef in qt6
-#else
-    //in QT5, QRegExp is slightly faster
-    auto separated = text.splitRef(QRegExp("\\s+"), QString::SkipEmptyParts);
-    ret.reserve(separated.size());
-#endif
-    for (const auto& elem : separated)
+    const ushort* data = text.utf16();
+    const int64_t length = text.size();
+    int64_t numTokens = 0;
+    bool inToken = false;
+    for (int64_t i = 0; i < length; ++i)
     {
-        bool ok = false;
-        ret.push_back(elem.toLongLong(&ok));
-        if (!ok)
+        bool separator = isIndexSeparator(data[i]);
+        if (!separator && !inToken) ++numTokens;
+        inToken = !separator;
+    }
+    ret.reserve(numTokens);
+    const int64_t maxBeforeDigit = numeric_limits<int64_t>::max() / 10;
+    int64_t pos = 0;
+    while (true)
+    {
+        while (pos < length && isIndexSeparator(data[pos])) ++pos;
+        if (pos >= length) break;
+        int64_t tokenStart = pos;
+        bool negative = false, ok = true;
+        if (data[pos] == '+' || data[pos] == '-')
+        {
+            negative = (data[pos] == '-');
+            ++pos;
+        }
+        int64_t value = 0, numDigits = 0;
+        for (; pos < length && !isIndexSeparator(data[pos]); ++pos)
+        {
+            ushort c = data[pos];
+            if (c < '0' || c > '9')
+            {
+                ok = false;
+                continue;//find the end of the token for the error message
+            }
+            int digit = c - '0';
+            if (value > maxBeforeDigit || (value == maxBeforeDigit && digit > numeric_limits<int64_t>::max() % 10))
+            {
+                ok = false;
+                continue;
+            }
+            value = value * 10 + digit;
+            ++numDigits;
+        }
+        if (!ok || numDigits == 0)
         {
-            throw DataFileException("found noninteger in index array: " + elem.toString());
+            throw DataFileException("found noninteger in index array: " + text.mid(tokenStart, pos - tokenStart));
         }
-        if (ret.back() < 0)
+        if (negative && value != 0)
         {
-            throw DataFileException("found negative integer in index array: " + elem.toString());
+            throw DataFileException("found negative integer in index array: " + text.mid(tokenStart, pos - tokenStart));
         }
+        ret.push_back(value);
     }
-    ret.shrink_to_fit();//qt6 can't predict in advance without making QStrings, so try not to have a bunch of unused memory allocated
     return ret;
 }
 
@@ -115,7 +115,7 @@ namespace caret
             std::vector<int64_t> m_voxelIndicesIJK;
             
             int64_t m_modelStart, m_modelEnd;//stuff only needed for optimization - models are kept in sorted order by their index ranges
-            std::vector<int64_t> m_nodeToIndexLookup;
+            std::vector<int32_t> m_nodeToOffsetLookup;//offset within the model, -1 for unused, empty when the vertex list is every vertex in order
             bool operator==(const BrainModelPriv& rhs) const;
             bool operator!=(const BrainModelPriv& rhs) const { return !((*this) == rhs); }
             void setupSurface(const int64_t& start);
@@ -126,6 +126,7 @@ namespace caret
         std::map<StructureEnum::Enum, int> m_surfUsed, m_volUsed;
         CaretCompact3DLookup<std::pair<int64_t, StructureEnum::Enum> > m_voxelToIndexLookup;//make one unified lookup rather than separate lookups per volume structure
         int64_t getNextStart() const;
+        void rebuildVoxelLookup();
         struct ParseHelperModel
         {//specifically to allow the parsed elements to be sorted before using addSurfaceModel/addVolumeModel
             ModelType m_type;
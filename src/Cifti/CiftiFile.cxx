@@ -25,27 +25,62 @@
 #include "CaretAssert.h"
 #include "CaretHttpManager.h"
 #include "CaretLogger.h"
+#include "CaretLruCache.h"
+#include "CaretMutex.h"
 #include "DataFileException.h"
 #include "FileInformation.h"
 #include "MultiDimArray.h"
 #include "MultiDimIterator.h"
 #include "NiftiIO.h"
 
+#include <QCryptographicHash>
+
+#include <algorithm>
+#include <limits>
+
 using namespace std;
 using namespace caret;
 
 //private implementation classes
 namespace
 {
+    struct CachedXML
+    {
+        QByteArray m_text;//compared in full, so a hash collision can't give the wrong mappings
+        CaretPointer<CiftiXML> m_xml;
+    };
+    
+    //commands that open many cifti files usually see the same few headers (same grayordinates, same number of maps),
+    //and parsing high-res dense mappings is most of the time spent opening a file, so keep the last few parsed
+    CaretLruCache<QByteArray, CachedXML> s_xmlCache(8);
+    
+    void readXMLCached(CiftiXML& xmlOut, const QByteArray& text)
+    {
+        const QByteArray key = QCryptographicHash::hash(text, QCryptographicHash::Sha1);
+        CachedXML entry;
+        if (s_xmlCache.find(key, entry) && entry.m_text == text)
+        {
+            xmlOut = *(entry.m_xml);
+            return;
+        }
+        entry.m_xml.grabNew(new CiftiXML());
+        entry.m_xml->readXML(text);
+        entry.m_text = text;
+        s_xmlCache.insert(key, entry);
+        xmlOut = *(entry.m_xml);
+    }
+    
     class CiftiOnDiskImpl : public CiftiFile::WriteImplInterface
     {
         mutable NiftiIO m_nifti;//because file objects aren't stateless (current position), so reading "changes" them
+        mutable CaretMutex m_mutex;//...and so seek and read must be done together, for algorithms that process structures concurrently
         vector<int64_t> m_matrixDims;//store the dimensions even if the xml is forgotten
         CiftiXML m_xml;//we need to store the xml somewhere before it gets put into CiftiFile's copy
     public:
         CiftiOnDiskImpl(const QString& filename);//read-only
         CiftiOnDiskImpl(const QString& filename, const CiftiXML& xml, const CiftiVersion& version, const bool& swapEndian,
-                        const int16_t& datatype, const bool& rescale, const double& minval, const double& maxval);//make new empty file with read/write
+                        const int16_t& datatype, const bool& rescale, const double& minval, const double& maxval,
+                        const bool& rangeFromData = false);//make new empty file with read/write
         void getRow(float* dataOut, const std::vector<int64_t>& indexSelect, const bool& tolerateShortRead) const;
         void getColumn(float* dataOut, const int64_t& index) const;
         const CiftiXML& getCiftiXML() const { return m_xml; }
@@ -114,6 +149,7 @@ CiftiFile::CiftiFile(const QString& fileName)
 {
     m_endianPref = NATIVE;
     setWritingDataTypeNoScaling();//default argument is float32
+    m_haveExpectedRange = false;
     openFile(fileName);
 }
 
@@ -166,6 +202,7 @@ void CiftiFile::setWritingDataTypeNoScaling(const int16_t& type)
 {
     m_writingDataType = type;//could do some validation here
     m_doWriteScaling = false;
+    m_autoWriteScaling = false;
     m_minScalingVal = -1.0;
     m_maxScalingVal = 1.0;
     m_writingImpl.grabNew(NULL);//prevent writing to previous writing implementation, let the next set...() set up for writing
@@ -175,11 +212,30 @@ void CiftiFile::setWritingDataTypeAndScaling(const int16_t& type, const double&
 {
     m_writingDataType = type;//could do some validation here
     m_doWriteScaling = true;
+    m_autoWriteScaling = false;
     m_minScalingVal = minval;
     m_maxScalingVal = maxval;
     m_writingImpl.grabNew(NULL);//prevent writing to previous writing implementation, let the next set...() set up for writing
 }
 
+void CiftiFile::setWritingDataTypeAutoScaling(const int16_t& type)
+{
+    m_writingDataType = type;
+    m_doWriteScaling = true;
+    m_autoWriteScaling = true;
+    m_minScalingVal = -1.0;//found when writing
+    m_maxScalingVal = 1.0;
+    m_writingImpl.grabNew(NULL);//prevent writing to previous writing implementation, let the next set...() set up for writing
+}
+
+void CiftiFile::setWritingExpectedRange(const double& minval, const double& maxval)
+{
+    m_haveExpectedRange = true;
+    m_expectedMinVal = minval;
+    m_expectedMaxVal = maxval;
+    m_writingImpl.grabNew(NULL);//prevent writing to previous writing implementation, let the next set...() set up for writing
+}
+
 void CiftiFile::writeFile(const QString& fileName, const CiftiVersion& writingVersion, const ENDIAN& endian)
 {
     if (m_readingImpl == NULL || m_dims.empty()) throw DataFileException("writeFile called on uninitialized CiftiFile");
@@ -198,8 +254,13 @@ void CiftiFile::writeFile(const QString& fileName, const CiftiVersion& writingVe
         m_readingImpl = tempMemory;//we are about to make the old reading impl very unhappy, replace it so that if we get an error while writing, we hang onto the memory version
         m_writingImpl.grabNew(NULL);//and make it re-magic the writing implementation again if data is set
     }
+    double minScale = m_minScalingVal, maxScale = m_maxScalingVal;
+    if (m_autoWriteScaling)
+    {//all the data exists already, so use its actual range rather than the expected one
+        findDataRange(m_readingImpl, m_dims, minScale, maxScale);
+    }
     CaretPointer<WriteImplInterface> tempWrite(new CiftiOnDiskImpl(myInfo.getAbsoluteFilePath(), m_xml, writingVersion, writeSwapped,
-                                                                   m_writingDataType, m_doWriteScaling, m_minScalingVal, m_maxScalingVal));
+                                                                   m_writingDataType, m_doWriteScaling, minScale, maxScale, m_autoWriteScaling));
     copyImplData(m_readingImpl, tempWrite, m_dims);
     if (collision)//if we rewrote the file, we need the handle to the new file, and to dump the temporary in-memory version
     {
@@ -229,6 +290,7 @@ void CiftiFile::close()
     m_onDiskVersion = CiftiVersion();//for completeness, it gets reset on open anyway
     m_endianPref = NATIVE;//reset things to defaults
     setWritingDataTypeNoScaling();//default argument is float32
+    m_haveExpectedRange = false;
 }
 
 void CiftiFile::convertToInMemory()
@@ -410,8 +472,23 @@ void CiftiFile::verifyWriteImpl()
                 }
             }
         }
+        int16_t writingType = m_writingDataType;
+        bool doScaling = m_doWriteScaling;
+        double minScale = m_minScalingVal, maxScale = m_maxScalingVal;
+        if (m_autoWriteScaling)
+        {//rows are written as they are computed, so we can't look at the data first
+            if (m_haveExpectedRange)
+            {
+                minScale = m_expectedMinVal;
+                maxScale = m_expectedMaxVal;
+            } else {
+                CaretLogInfo("range of cifti file '" + m_writingFile + "' isn't known before it is written, writing it as FLOAT32");
+                writingType = NIFTI_TYPE_FLOAT32;
+                doScaling = false;
+            }
+        }
         m_writingImpl.grabNew(new CiftiOnDiskImpl(m_writingFile, m_xml, m_onDiskVersion, shouldSwap(m_endianPref),
-                                                  m_writingDataType, m_doWriteScaling, m_minScalingVal, m_maxScalingVal));//this constructor makes new file for writing
+                                                  writingType, doScaling, minScale, maxScale, m_autoWriteScaling));//this constructor makes new file for writing
         m_xml.clearMutablesModified(); //we just wrote this version of the xml, so mark it as not modified
         if (m_readingImpl != NULL)
         {
@@ -421,6 +498,28 @@ void CiftiFile::verifyWriteImpl()
     m_readingImpl = m_writingImpl;//read-only implementations are set up in specialized functions
 }
 
+void CiftiFile::findDataRange(const ReadImplInterface* from, const vector<int64_t>& dims, double& minOut, double& maxOut)
+{//ignores NaN and inf, if there are no finite values, minOut ends up greater than maxOut
+    minOut = numeric_limits<float>::max();
+    maxOut = -numeric_limits<float>::max();
+    vector<int64_t> iterateDims(dims.begin() + 1, dims.end());
+    vector<float> scratchRow(dims[0]);
+    for (MultiDimIterator<int64_t> iter(iterateDims); !iter.atEnd(); ++iter)
+    {
+        from->getRow(scratchRow.data(), *iter, false);
+        float rowMin = numeric_limits<float>::max(), rowMax = -numeric_limits<float>::max();
+        for (int64_t i = 0; i < dims[0]; ++i)
+        {
+            float value = scratchRow[i];
+            if (value - value != 0.0f) continue;//NaN or inf
+            rowMin = min(rowMin, value);
+            rowMax = max(rowMax, value);
+        }
+        minOut = min(minOut, (double)rowMin);
+        maxOut = max(maxOut, (double)rowMax);
+    }
+}
+
 void CiftiFile::copyImplData(const ReadImplInterface* from, WriteImplInterface* to, const vector<int64_t>& dims)
 {
     if (dims.size() == 2 && dims[0] == 1)
@@ -508,7 +607,7 @@ CiftiOnDiskImpl::CiftiOnDiskImpl(const QString& filename)
     if (whichExt == -1) throw DataFileException("no cifti extension found in file '" + filename + "'");
     try
     {
-        m_xml.readXML(QByteArray(myHeader.m_extensions[whichExt]->m_bytes.data(), myHeader.m_extensions[whichExt]->m_bytes.size()));//CiftiXML should be under 2GB
+        readXMLCached(m_xml, QByteArray(myHeader.m_extensions[whichExt]->m_bytes.data(), myHeader.m_extensions[whichExt]->m_bytes.size()));//CiftiXML should be under 2GB
     } catch (CaretException& e) {
         throw DataFileException("XML parsing error in cifti file '" + filename + "': " + e.whatString());
     } catch (exception& e) {//use a different message for std::exception, as this probably isn't from our code
@@ -655,13 +754,19 @@ namespace
 }
 
 CiftiOnDiskImpl::CiftiOnDiskImpl(const QString& filename, const CiftiXML& xml, const CiftiVersion& version, const bool& swapEndian,
-                                 const int16_t& datatype, const bool& rescale, const double& minval, const double& maxval)
+                                 const int16_t& datatype, const bool& rescale, const double& minval, const double& maxval,
+                                 const bool& rangeFromData)
 {//starts writing new file
     warnForBadExtension(filename, xml);
     NiftiHeader outHeader;
     if (rescale)
     {
-        outHeader.setDataTypeAndScaleRange(datatype, minval, maxval);
+        if (rangeFromData)
+        {
+            outHeader.setDataTypeAndDataRange(datatype, minval, maxval);
+        } else {
+            outHeader.setDataTypeAndScaleRange(datatype, minval, maxval);
+        }
     } else {
         outHeader.setDataType(datatype);
     }
@@ -706,6 +811,7 @@ CiftiOnDiskImpl::CiftiOnDiskImpl(const QString& filename, const CiftiXML& xml, c
 
 void CiftiOnDiskImpl::close()
 {
+    CaretMutexLocker locked(&m_mutex);
     m_nifti.close();//lets this throw when there is a writing problem
     dropXML();
 }
@@ -713,6 +819,7 @@ void CiftiOnDiskImpl::close()
 
 void CiftiOnDiskImpl::getRow(float* dataOut, const vector<int64_t>& indexSelect, const bool& tolerateShortRead) const
 {
+    CaretMutexLocker locked(&m_mutex);
     m_nifti.readData(dataOut, 5, indexSelect, tolerateShortRead);//5 means 4 reserved (space and time) plus the first cifti dimension
 }
 
@@ -720,6 +827,7 @@ void CiftiOnDiskImpl::getColumn(float* dataOut, const int64_t& index) const
 {
     CaretAssert(m_matrixDims.size() == 2);//otherwise this shouldn't be called
     CaretAssert(index >= 0 && index < m_matrixDims[0]);
+    CaretMutexLocker locked(&m_mutex);
     if (m_matrixDims[0] > 1)
     {
         CaretLogFine("getColumn called on CiftiOnDiskImpl with multiple columns, this will be slow");//generate logging messages at a low priority
@@ -738,6 +846,7 @@ void CiftiOnDiskImpl::getColumn(float* dataOut, const int64_t& index) const
 
 void CiftiOnDiskImpl::setRow(const float* dataIn, const vector<int64_t>& indexSelect)
 {
+    CaretMutexLocker locked(&m_mutex);
     m_nifti.writeData(dataIn, 5, indexSelect);
 }
 
@@ -746,6 +855,7 @@ void CiftiOnDiskImpl::setColumn(const float* dataIn, const int64_t& index)
     CaretAssert(m_matrixDims.size() == 2);//otherwise this shouldn't be called
     CaretAssert(index >= 0 && index < m_matrixDims[0]);
     CaretLogFine("setColumn called on CiftiOnDiskImpl, this will be slow");//generate logging messages at a low priority
+    CaretMutexLocker locked(&m_mutex);
     vector<int64_t> indexSelect(2);
     indexSelect[0] = index;
     int64_t colLength = m_matrixDims[1];
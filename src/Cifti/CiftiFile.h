@@ -50,6 +50,7 @@ namespace caret
         {
             m_endianPref = NATIVE;
             setWritingDataTypeNoScaling();//default argument is float32
+            m_haveExpectedRange = false;
             m_xmlBroken = false;
         }
         explicit CiftiFile(const QString &fileName);//calls openFile
@@ -79,6 +80,11 @@ namespace caret
         ///data type and scaling options - should be set before setRow, etc, to avoid rewriting of file
         void setWritingDataTypeNoScaling(const int16_t& type = NIFTI_TYPE_FLOAT32);
         void setWritingDataTypeAndScaling(const int16_t& type, const double& minval, const double& maxval);
+        ///integer types get scaled to the range of the data, found when the file is written from memory - when writing on-disk,
+        ///the range can't be known ahead of time, so the expected range is used if one was set, otherwise float32 is written instead
+        void setWritingDataTypeAutoScaling(const int16_t& type);
+        ///for algorithms whose output range is known (correlation, etc), lets auto scaling write compact types on-disk
+        void setWritingExpectedRange(const double& minval, const double& maxval);
         
         void getRow(float* dataOut, const int64_t& index, const bool& tolerateShortRead) const;//backwards compatibility for old CiftiFile/CiftiInterface
         void getRow(float* dataOut, const int64_t& index) const;
@@ -114,13 +120,14 @@ namespace caret
         //CiftiXML m_xml;//uncomment when we drop CiftiInterface
         CiftiVersion m_onDiskVersion;
         ENDIAN m_endianPref;
-        bool m_doWriteScaling;
+        bool m_doWriteScaling, m_autoWriteScaling, m_haveExpectedRange;
         int16_t m_writingDataType;
-        double m_minScalingVal, m_maxScalingVal;
+        double m_minScalingVal, m_maxScalingVal, m_expectedMinVal, m_expectedMaxVal;
         bool m_xmlBroken;//sentinel for forgetMapping hack
         
         void verifyWriteImpl();
         static void copyImplData(const ReadImplInterface* from, WriteImplInterface* to, const std::vector<int64_t>& dims);
+        static void findDataRange(const ReadImplInterface* from, const std::vector<int64_t>& dims, double& minOut, double& maxOut);
     };
     
 }
@@ -23,6 +23,7 @@
 #include "CaretAssert.h"
 #include "DataFileException.h"
 #include "CaretLogger.h"
+#include "CaretTrace.h"
 #include "GiftiMetaData.h"
 #include "PaletteColorMapping.h"
 
@@ -279,6 +280,8 @@ void CiftiXML::readXML(const QString& text)
 
 void CiftiXML::readXML(const QByteArray& data)
 {
+    CaretTraceSpan traceSpan("xml", "parse CIFTI XML");
+    traceSpan.setBytes(data.size());
     QString text(data);//constructing a qstring appears to be the simplest way to remove trailing nulls, which otherwise trip an "Extra content at end of document" error
     readXML(text);//then put it through the string reader, just to simplify code paths
 }
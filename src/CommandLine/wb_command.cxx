@@ -29,6 +29,7 @@
 #include "CaretHttpManager.h"
 #include "CaretCommandLine.h"
 #include "CaretLogger.h"
+#include "CommandDaemon.h"
 #include "CommandOperationManager.h"
 #include "ProgramParameters.h"
 #include "SessionManager.h"
@@ -123,6 +124,11 @@ int main(int argc, char* argv[]) {
     {
         return doCompletion(argc, argv);
     }
+    //likewise, a daemon client only forwards its arguments, starting anything else would defeat the purpose
+    if (argc > 1 && AString::fromLocal8Bit(argv[1]) == "-daemon-client")
+    {
+        return CommandDaemon::runClient(argc, argv);
+    }
     int result = 0;
     {
         /*
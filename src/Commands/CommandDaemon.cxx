@@ -0,0 +1,628 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CommandDaemon.h"
+
+#include "CaretAssert.h"
+#include "CaretCommandLine.h"
+#include "CaretException.h"
+#include "CaretLogger.h"
+#include "CaretMutex.h"
+#include "CaretOMP.h"
+#include "CommandException.h"
+#include "CommandOperationManager.h"
+#include "CommandParser.h"
+#include "ProgramParameters.h"
+#include "SurfaceFileCache.h"
+#include "SurfaceResamplingHelper.h"
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#ifndef CARET_OS_WINDOWS
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    const char DAEMON_MAGIC[4] = { 'W', 'B', 'D', '1' };
+    const uint32_t MAX_REQUEST_STRINGS = 1 << 20;
+    const uint32_t MAX_STRING_BYTES = 1 << 28;
+    
+    //text written to cout or cerr by a thread that is running a request goes to that request, anything else goes to the daemon's own output
+    thread_local string* t_capturedOutput[2] = { NULL, NULL };
+    
+    class ThreadOutputBuffer : public streambuf
+    {
+        streambuf* m_fallback;
+        int m_which;
+        CaretMutex m_fallbackMutex;
+    public:
+        ThreadOutputBuffer(streambuf* fallback, const int which) : m_fallback(fallback), m_which(which) { }
+    protected:
+        //no put area, so every write comes through here, and threads never share buffer state
+        int overflow(int c)
+        {
+            if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+            string* target = t_capturedOutput[m_which];
+            if (target != NULL)
+            {
+                target->push_back((char)c);
+                return c;
+            }
+            CaretMutexLocker locked(&m_fallbackMutex);
+            return m_fallback->sputc((char)c);
+        }
+        streamsize xsputn(const char* s, streamsize n)
+        {
+            string* target = t_capturedOutput[m_which];
+            if (target != NULL)
+            {
+                target->append(s, n);
+                return n;
+            }
+            CaretMutexLocker locked(&m_fallbackMutex);
+            return m_fallback->sputn(s, n);
+        }
+        int sync()
+        {
+            if (t_capturedOutput[m_which] != NULL) return 0;
+            CaretMutexLocker locked(&m_fallbackMutex);
+            return m_fallback->pubsync();
+        }
+    };
+    
+    class OutputRedirect
+    {
+        ThreadOutputBuffer m_outBuffer, m_errBuffer;
+        streambuf* m_oldOut, *m_oldErr;
+    public:
+        OutputRedirect() : m_outBuffer(cout.rdbuf(), 0), m_errBuffer(cerr.rdbuf(), 1)
+        {
+            m_oldOut = cout.rdbuf(&m_outBuffer);
+            m_oldErr = cerr.rdbuf(&m_errBuffer);
+        }
+        ~OutputRedirect()
+        {
+            cout.rdbuf(m_oldOut);
+            cerr.rdbuf(m_oldErr);
+        }
+    };
+    
+    class OutputCapture
+    {
+    public:
+        OutputCapture(string* outText, string* errText)
+        {
+            t_capturedOutput[0] = outText;
+            t_capturedOutput[1] = errText;
+        }
+        ~OutputCapture()
+        {
+            t_capturedOutput[0] = NULL;
+            t_capturedOutput[1] = NULL;
+        }
+    };
+    
+    //the working directory belongs to the whole process, so requests from different directories take turns
+    class WorkingDirectoryGate
+    {
+        QMutex m_mutex;
+        QWaitCondition m_released;
+        AString m_current;
+        int m_users, m_waiting;
+    public:
+        WorkingDirectoryGate() : m_current(QDir::currentPath()), m_users(0), m_waiting(0) { }
+        void enter(const AString& dir)
+        {
+            QMutexLocker locked(&m_mutex);
+            if (!(m_users == 0 || (dir == m_current && m_waiting == 0)))
+            {//don't let a stream of requests from one directory starve the others
+                ++m_waiting;
+                do
+                {
+                    m_released.wait(&m_mutex);
+                } while (!(m_users == 0 || dir == m_current));
+                --m_waiting;
+            }
+            if (dir != m_current)
+            {
+                if (!QDir::setCurrent(dir))
+                {
+                    m_released.wakeAll();//we didn't take it, let someone else
+                    throw CommandException("unable to change to working directory '" + dir + "'");
+                }
+                m_current = dir;
+            }
+            ++m_users;
+        }
+        void leave()
+        {
+            QMutexLocker locked(&m_mutex);
+            CaretAssert(m_users > 0);
+            --m_users;
+            if (m_users == 0) m_released.wakeAll();
+        }
+    };
+    
+    class WorkingDirectoryUser
+    {
+        WorkingDirectoryGate* m_gate;
+    public:
+        WorkingDirectoryUser(WorkingDirectoryGate* gate, const AString& dir) : m_gate(gate) { m_gate->enter(dir); }
+        ~WorkingDirectoryUser() { m_gate->leave(); }
+    };
+    
+#ifndef CARET_OS_WINDOWS
+    bool writeBytes(const int fd, const char* data, size_t length)
+    {
+        while (length > 0)
+        {
+            const ssize_t written = write(fd, data, length);
+            if (written < 0)
+            {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += written;
+            length -= written;
+        }
+        return true;
+    }
+    
+    bool readBytes(const int fd, char* data, size_t length)
+    {
+        while (length > 0)
+        {
+            const ssize_t numRead = read(fd, data, length);
+            if (numRead < 0)
+            {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            if (numRead == 0) return false;//closed early
+            data += numRead;
+            length -= numRead;
+        }
+        return true;
+    }
+    
+    //both ends are on the same machine, so native byte order is fine
+    bool writeUint32(const int fd, const uint32_t value)
+    {
+        return writeBytes(fd, (const char*)&value, sizeof(value));
+    }
+    
+    bool readUint32(const int fd, uint32_t& valueOut)
+    {
+        return readBytes(fd, (char*)&valueOut, sizeof(valueOut));
+    }
+    
+    bool writeString(const int fd, const string& text)
+    {
+        if (text.size() > MAX_STRING_BYTES) return writeString(fd, text.substr(0, MAX_STRING_BYTES));
+        return writeUint32(fd, (uint32_t)text.size()) && writeBytes(fd, text.data(), text.size());
+    }
+    
+    bool readString(const int fd, string& textOut)
+    {
+        uint32_t length = 0;
+        if (!readUint32(fd, length) || length > MAX_STRING_BYTES) return false;
+        textOut.resize(length);
+        return length == 0 || readBytes(fd, &(textOut[0]), length);
+    }
+    
+    bool makeSocketAddress(const AString& socketName, sockaddr_un& addrOut)
+    {
+        const QByteArray pathBytes = QFile::encodeName(socketName);
+        memset(&addrOut, 0, sizeof(addrOut));
+        addrOut.sun_family = AF_UNIX;
+        if (pathBytes.isEmpty() || pathBytes.size() >= (int)sizeof(addrOut.sun_path)) return false;
+        memcpy(addrOut.sun_path, pathBytes.constData(), pathBytes.size());
+        return true;
+    }
+    
+    int connectToDaemon(const sockaddr_un& addr)
+    {
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        if (::connect(fd, (const sockaddr*)&addr, sizeof(addr)) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+#endif
+    
+    struct DaemonState
+    {
+        bool m_doProvenance;
+        CaretMutex m_parseMutex;//parsers keep some state while parsing, but running a parsed command doesn't touch the parser
+        WorkingDirectoryGate m_workingDirGate;
+        QMutex m_stopMutex;
+        bool m_stopRequested;
+        int m_threadsPerJob;
+        DaemonState() : m_doProvenance(true), m_stopRequested(false), m_threadsPerJob(1) { }
+        bool stopRequested()
+        {
+            QMutexLocker locked(&m_stopMutex);
+            return m_stopRequested;
+        }
+        void requestStop()
+        {
+            QMutexLocker locked(&m_stopMutex);
+            m_stopRequested = true;
+        }
+    };
+    
+    void runDaemonCommand(DaemonState* state, const vector<AString>& args, const AString& commandLine, const AString& workingDir)
+    {
+        if (args.empty()) throw CommandException("no command given");
+        CommandOperation* operation = CommandOperationManager::getCommandOperationManager()->findCommandOperation(args[0]);
+        CommandParser* parser = dynamic_cast<CommandParser*>(operation);
+        if (parser == NULL)
+        {
+            if (operation == NULL)
+            {
+                throw CommandException("unknown command '" + args[0] + "', note that global options must be given when starting the daemon");
+            }
+            throw CommandException("command '" + args[0] + "' can't be run by the daemon");
+        }
+        WorkingDirectoryUser inDir(&(state->m_workingDirGate), workingDir);//relative filenames are relative to the client
+        ProgramParameters parameters;
+        for (size_t i = 1; i < args.size(); ++i)
+        {
+            parameters.addParameter(args[i]);
+        }
+        CommandParser::PipelineStep step;//a single-step pipeline, so that the provenance and parsing state are per-request
+        {
+            CaretMutexLocker locked(&(state->m_parseMutex));
+            if (!state->m_doProvenance) parser->disableProvenance();
+            parser->parsePipelineStep(parameters, commandLine, step);
+        }
+        for (size_t i = 0; i < step.m_outAssoc.size(); ++i)
+        {
+            if (CommandParser::isInMemoryName(step.m_outAssoc[i].m_fileName))
+            {
+                throw CommandException("in-memory output '" + step.m_outAssoc[i].m_fileName + "' can only be used in -pipeline");
+            }
+        }
+        parser->executePipelineStep(step);
+    }
+    
+    int runDaemonRequest(DaemonState* state, const vector<AString>& args, const AString& commandLine, const AString& workingDir, string& outText, string& errText)
+    {
+        OutputCapture captured(&outText, &errText);
+        const AString errorPrefix = "\nWhile running:\n" + commandLine + "\n\nERROR: ";
+        try
+        {
+            runDaemonCommand(state, args, commandLine, workingDir);
+        } catch (const CaretException& e) {
+            cerr << (errorPrefix + e.whatString()).toLocal8Bit().constData() << endl << endl;
+            return -1;
+        } catch (const bad_alloc& e) {
+            cerr << errorPrefix.toLocal8Bit().constData() << e.what() << endl << endl << "OUT OF MEMORY" << endl << endl;
+            return -1;
+        } catch (const exception& e) {
+            cerr << errorPrefix.toLocal8Bit().constData() << e.what() << endl << endl;
+            return -1;
+        }
+        return 0;
+    }
+    
+#ifndef CARET_OS_WINDOWS
+    class DaemonRequest : public QRunnable
+    {
+        DaemonState* m_state;
+        int m_fd;
+    public:
+        DaemonRequest(DaemonState* state, const int fd) : m_state(state), m_fd(fd) { }
+        void run()
+        {
+#ifdef CARET_OMP
+            omp_set_num_threads(m_state->m_threadsPerJob);//per-thread setting, so concurrent requests share the cores
+#endif
+            handle();
+            close(m_fd);
+        }
+        void handle()
+        {
+            char magic[sizeof(DAEMON_MAGIC)];
+            uint32_t numStrings = 0;
+            if (!readBytes(m_fd, magic, sizeof(magic)) || memcmp(magic, DAEMON_MAGIC, sizeof(magic)) != 0 ||
+                !readUint32(m_fd, numStrings) || numStrings < 2 || numStrings > MAX_REQUEST_STRINGS)
+            {
+                CaretLogWarning("ignoring malformed daemon request");
+                return;
+            }
+            vector<AString> strings(numStrings);
+            for (uint32_t i = 0; i < numStrings; ++i)
+            {
+                string temp;
+                if (!readString(m_fd, temp))
+                {
+                    CaretLogWarning("ignoring truncated daemon request");
+                    return;
+                }
+                strings[i] = AString::fromUtf8(temp.data(), temp.size());
+            }
+            const AString commandLine = strings[0], workingDir = strings[1];
+            const vector<AString> args(strings.begin() + 2, strings.end());
+            string outText, errText;
+            int32_t status = 0;
+            if (!args.empty() && args[0] == "-daemon-stop")
+            {
+                m_state->requestStop();
+                CaretLogInfo("stop requested, finishing running commands");
+            } else {
+                CaretLogFine("daemon running: " + commandLine);
+                status = runDaemonRequest(m_state, args, commandLine, workingDir, outText, errText);
+            }
+            if (!writeString(m_fd, outText) || !writeString(m_fd, errText) || !writeUint32(m_fd, (uint32_t)status))
+            {
+                CaretLogWarning("client disconnected before receiving the result of: " + commandLine);
+            }
+        }
+    };
+#endif
+}
+
+/**
+ * Constructor.
+ */
+CommandDaemon::CommandDaemon()
+: CommandOperation("-daemon",
+                   "RUN COMMANDS SENT FROM OTHER PROCESSES")
+{
+    m_doProvenance = true;
+}
+
+/**
+ * Destructor.
+ */
+CommandDaemon::~CommandDaemon()
+{
+}
+
+void CommandDaemon::disableProvenance()
+{
+    m_doProvenance = false;
+}
+
+AString
+CommandDaemon::getHelpInformation(const AString& programName)
+{
+    return "RUN COMMANDS SENT FROM OTHER PROCESSES\n"
+           "   " + programName + " -daemon\n"
+           "      <socket> - filename for the local socket to listen on\n"
+           "\n"
+           "      [-jobs] - number of commands to run at the same time\n"
+           "         <num> - default 4\n"
+           "\n"
+           "      [-cache-entries] - number of surfaces and resampling weights to keep\n"
+           "         <num> - default 32 of each\n"
+           "\n"
+           "   Keeps running and executes commands sent by '" + programName + " -daemon-client',\n"
+           "   which avoids starting up wb_command for every command, and lets\n"
+           "   commands reuse surfaces (and their topology and geodesic helpers) and\n"
+           "   surface resampling weights computed by earlier commands.  Surfaces are\n"
+           "   read again if the file changes.\n"
+           "\n"
+           "   To run a command with a daemon, insert '-daemon-client <socket>' after\n"
+           "   '" + programName + "', for example:\n"
+           "\n"
+           "   " + programName + " -daemon-client /tmp/wb.sock -metric-resample ...\n"
+           "\n"
+           "   The client prints the command's output and returns its exit status.\n"
+           "   Relative filenames are relative to the client's working directory.\n"
+           "   Global options like -logging must be given when starting the daemon,\n"
+           "   and apply to all commands it runs.  Only processing commands can be\n"
+           "   run this way, not help or informational switches like -version.\n"
+           "\n"
+           "   Commands from clients in different directories take turns, since the\n"
+           "   working directory belongs to the whole process.  Each running command\n"
+           "   gets an equal share of the available threads.  Output that commands\n"
+           "   print from inside their own parallel loops goes to the daemon's output\n"
+           "   instead of the client's.\n"
+           "\n"
+           "   To stop the daemon after running commands finish, use:\n"
+           "\n"
+           "   " + programName + " -daemon-client <socket> -daemon-stop\n"
+           "\n"
+           "   The socket is only accessible to the user that started the daemon.\n"
+           "   This command is not available on Windows.\n";
+}
+
+/**
+ * Execute the operation.
+ * 
+ * @param parameters
+ *   Parameters for the operation.
+ * @throws CommandException
+ *   If the command failed.
+ * @throws ProgramParametersException
+ *   If there is an error in the parameters.
+ */
+void 
+CommandDaemon::executeOperation(ProgramParameters& parameters)
+{
+    const AString socketName = parameters.nextString("socket filename");
+    int numJobs = 4;
+    int64_t cacheEntries = 32;
+    while (parameters.hasNext())
+    {
+        const AString option = parameters.nextString("option");
+        if (option == "-jobs")
+        {
+            numJobs = (int)parameters.nextLong("number of jobs");
+            if (numJobs < 1) throw ProgramParametersException("-jobs must be at least 1");
+        } else if (option == "-cache-entries") {
+            cacheEntries = parameters.nextLong("number of cache entries");
+            if (cacheEntries < 0) throw ProgramParametersException("-cache-entries must not be negative");
+        } else {
+            throw ProgramParametersException("unrecognized option: '" + option + "'");
+        }
+    }
+#ifdef CARET_OS_WINDOWS
+    throw CommandException("-daemon is not available on Windows");
+#else
+    sockaddr_un addr;
+    if (!makeSocketAddress(socketName, addr))
+    {
+        throw CommandException("socket filename '" + socketName + "' is empty or too long");
+    }
+    if (QFile::exists(socketName))
+    {
+        const int existing = connectToDaemon(addr);
+        if (existing >= 0)
+        {
+            close(existing);
+            throw CommandException("a daemon is already listening on '" + socketName + "'");
+        }
+        unlink(addr.sun_path);//left over from a daemon that didn't exit cleanly
+    }
+    const int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) throw CommandException("unable to create socket: " + AString(strerror(errno)));
+    const mode_t oldMask = umask(0077);//only this user can connect
+    const int bindResult = ::bind(listenFd, (const sockaddr*)&addr, sizeof(addr));
+    umask(oldMask);
+    if (bindResult != 0 || listen(listenFd, 64) != 0)
+    {
+        const AString errorText = strerror(errno);
+        close(listenFd);
+        throw CommandException("unable to listen on '" + socketName + "': " + errorText);
+    }
+    signal(SIGPIPE, SIG_IGN);//clients that go away shouldn't kill the daemon
+    
+    DaemonState state;
+    state.m_doProvenance = m_doProvenance;
+#ifdef CARET_OMP
+    state.m_threadsPerJob = max(1, omp_get_max_threads() / numJobs);
+#endif
+    SurfaceFileCache::setMaximumEntries(cacheEntries);
+    SurfaceResamplingHelper::setCacheEntries(cacheEntries);
+    QThreadPool pool;
+    pool.setMaxThreadCount(numJobs);
+    {
+        OutputRedirect redirected;//so each request's output goes back to its client
+        CaretLogInfo("daemon listening on '" + socketName + "'");
+        while (!state.stopRequested())
+        {
+            pollfd waitFor;
+            waitFor.fd = listenFd;
+            waitFor.events = POLLIN;
+            waitFor.revents = 0;
+            const int ready = poll(&waitFor, 1, 500);//wake up regularly to check for a stop request
+            if (ready <= 0) continue;
+            const int clientFd = accept(listenFd, NULL, NULL);
+            if (clientFd < 0) continue;
+            pool.start(new DaemonRequest(&state, clientFd));//the pool deletes it when done
+        }
+        pool.waitForDone();
+    }
+    close(listenFd);
+    unlink(addr.sun_path);
+    SurfaceFileCache::setMaximumEntries(0);
+    SurfaceResamplingHelper::setCacheEntries(0);
+#endif
+}
+
+/**
+ * Send a command to a daemon and show its output.  Deliberately doesn't start the
+ * session manager or the command manager, as avoiding that is the point of the daemon.
+ *
+ * @return
+ *   The exit status of the command.
+ */
+int
+CommandDaemon::runClient(int argc, char* argv[])
+{
+    if (argc < 4)
+    {
+        cerr << "usage: wb_command -daemon-client <socket> <command> [arguments...]" << endl;
+        return 1;
+    }
+#ifdef CARET_OS_WINDOWS
+    cerr << "-daemon-client is not available on Windows" << endl;
+    return 1;
+#else
+    const AString socketName = AString::fromLocal8Bit(argv[2]);
+    vector<const char*> forwarded(1, "wb_command");
+    forwarded.insert(forwarded.end(), argv + 3, argv + argc);
+    caret_global_commandLine_init((int)forwarded.size(), forwarded.data());//the provenance the command would have had without the daemon
+    sockaddr_un addr;
+    if (!makeSocketAddress(socketName, addr))
+    {
+        cerr << "socket filename '" << argv[2] << "' is empty or too long" << endl;
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    const int fd = connectToDaemon(addr);
+    if (fd < 0)
+    {
+        cerr << "unable to connect to a daemon on '" << argv[2] << "': " << strerror(errno) << endl;
+        return 1;
+    }
+    bool ok = writeBytes(fd, DAEMON_MAGIC, sizeof(DAEMON_MAGIC)) &&
+              writeUint32(fd, (uint32_t)(argc - 1)) &&
+              writeString(fd, caret_global_commandLine.toUtf8().constData()) &&
+              writeString(fd, QDir::currentPath().toUtf8().constData());
+    for (int i = 3; ok && i < argc; ++i)
+    {
+        ok = writeString(fd, AString::fromLocal8Bit(argv[i]).toUtf8().constData());
+    }
+    string outText, errText;
+    uint32_t status = 0;
+    ok = ok && readString(fd, outText) && readString(fd, errText) && readUint32(fd, status);
+    close(fd);
+    if (!ok)
+    {
+        cerr << "lost connection to the daemon on '" << argv[2] << "'" << endl;
+        return 1;
+    }
+    cout << outText << flush;
+    cerr << errText << flush;
+    return (int32_t)status;
+#endif
+}
@@ -0,0 +1,59 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#ifndef __COMMAND_DAEMON_H__
+#define __COMMAND_DAEMON_H__
+
+#include "CommandOperation.h"
+
+namespace caret {
+
+    /// Command that keeps wb_command running, executing commands sent over a local socket, with caches shared between them.
+    class CommandDaemon : public CommandOperation {
+        
+    public:
+        CommandDaemon();
+        
+        virtual ~CommandDaemon();
+
+        virtual void executeOperation(ProgramParameters& parameters);
+        
+        AString getHelpInformation(const AString& programName);
+        
+        virtual bool takesParameters() { return true; }
+        
+        ///forward a command line (wb_command -daemon-client <socket> <command> ...) to a running daemon, without starting anything else
+        static int runClient(int argc, char* argv[]);
+        
+    protected:
+        virtual void disableProvenance();
+        
+    private:
+        
+        CommandDaemon(const CommandDaemon&);
+
+        CommandDaemon& operator=(const CommandDaemon&);
+        
+        bool m_doProvenance;
+    };
+    
+} // namespace
+
+#endif // __COMMAND_DAEMON_H__
@@ -249,10 +249,15 @@
 #include "CommandClassCreateEnum.h"
 #include "CommandClassCreateOperation.h"
 #include "CommandC11xTesting.h"
+#include "CommandDaemon.h"
+#include "CommandPipeline.h"
 #include "CommandUnitTest.h"
 #include "ProgramParameters.h"
 
 #include "CaretLogger.h"
+#include "CaretOMP.h"
+#include "CaretOMPBinding.h"
+#include "CaretTrace.h"
 #include "dot_wrapper.h"
 #include "CaretCommandGlobalOptions.h"
 
@@ -508,6 +513,8 @@ CommandOperationManager::CommandOperationManager()
 #ifdef WORKBENCH_HAVE_C11X
     this->commandOperations.push_back(new CommandC11xTesting());
 #endif // WORKBENCH_HAVE_C11X
+    this->commandOperations.push_back(new CommandDaemon());
+    this->commandOperations.push_back(new CommandPipeline());
     this->commandOperations.push_back(new CommandUnitTest());
     
     this->deprecatedOperations.push_back(new CommandParser(new AutoOperationCiftiChangeTimestep()));
@@ -614,6 +621,11 @@ CommandOperationManager::runCommand(ProgramParameters& parameters)
             caret_global_command_options.m_volumeMax = globalOptionArgs[1].toDouble(&valid);
         if (!valid) throw CommandException("non-numeric option to -nifti-output-range: '" + globalOptionArgs[1] + "'");
     }
+    if (getGlobalOption(parameters, "-nifti-output-auto-range", 0, globalOptionArgs))
+    {
+        caret_global_command_options.m_ciftiAutoRange =
+            caret_global_command_options.m_volumeAutoRange = true;
+    }
     if (getGlobalOption(parameters, "-cifti-output-datatype", 1, globalOptionArgs))
     {
         caret_global_command_options.m_ciftiDType = stringToNiftiType(globalOptionArgs[0]);
@@ -631,9 +643,24 @@ CommandOperationManager::runCommand(ProgramParameters& parameters)
     {
         caret_global_command_options.m_ciftiReadMemory = true;
     }
-
-    const uint64_t numberOfCommands = this->commandOperations.size();
-    const uint64_t numberOfDeprecated = this->deprecatedOperations.size();
+    if (getGlobalOption(parameters, "-trace", 1, globalOptionArgs))
+    {
+        CaretTrace::start(globalOptionArgs[0]);
+    }
+    if (getGlobalOption(parameters, "-threads", 1, globalOptionArgs))
+    {
+        bool valid = false;
+        const int numThreads = globalOptionArgs[0].toInt(&valid);
+        if (!valid || numThreads < 1) throw CommandException("number of threads must be a positive integer: '" + globalOptionArgs[0] + "'");
+        CaretOMP::setNumThreads(numThreads);
+    }
+    if (getGlobalOption(parameters, "-thread-binding", 1, globalOptionArgs))
+    {//after -threads, binding applies to the current team
+        bool valid = false;
+        const CaretOMPBinding::BindPolicy policy = CaretOMPBinding::stringToBindPolicy(globalOptionArgs[0], &valid);
+        if (!valid) throw CommandException("unrecognized thread binding: '" + globalOptionArgs[0] + "'");
+        CaretOMPBinding::setBindPolicy(policy);
+    }
 
     if (parameters.hasNext() == false) {
         printHelpInfo();
@@ -670,68 +697,94 @@ CommandOperationManager::runCommand(ProgramParameters& parameters)
         printAllCommandsHelpInfo(myProgramName);
     } else {
         
-        CommandOperation* operation = NULL, *compatOperation = NULL; //separate so we can do both in one pass while giving priority on collision
+        CommandOperation* operation = findCommandOperation(commandSwitch);
         
-        for (uint64_t i = 0; i < numberOfCommands; i++)
-        {
-            if (this->commandOperations[i]->getCommandLineSwitch() == commandSwitch)
+        if (operation == NULL) {
+            if (!parameters.hasNext())
             {
-                operation = this->commandOperations[i];
-                break;
+                printAllCommandsMatching(commandSwitch);
+            } else {
+                throw CommandException("Command \"" + commandSwitch + "\" not found.");
             }
-            for (const AString compatSwitch : this->commandOperations[i]->getCompatibilitySwitches())
+        } else {
+            if (!parameters.hasNext() && operation->takesParameters())
             {
-                if (compatSwitch == commandSwitch)
+                cout << operation->getHelpInformation(myProgramName) << endl;
+            } else {
+                try
                 {
-                    CaretAssert(compatOperation == NULL); //try to catch switch collisions in debug builds
-                    compatOperation = this->commandOperations[i];
-                    break; //do NOT break outer loop, we want to give priority to non-compat switches
+                    CaretTraceSpan traceSpan("command", commandSwitch);
+                    operation->execute(parameters, preventProvenance);
+                } catch (...) {
+                    CaretTrace::finish();//the trace of a failed command is still useful
+                    throw;
                 }
+                CaretTrace::finish();
             }
         }
-        if (operation == NULL)
+    }
+}
+
+/**
+ * Find the command operation for a command switch, including deprecated
+ * and compatibility switches.
+ *
+ * @param commandSwitch
+ *    The switch of the command.
+ * @return
+ *    The command operation, or NULL if no command has the switch.
+ */
+CommandOperation*
+CommandOperationManager::findCommandOperation(const AString& commandSwitch)
+{
+    const uint64_t numberOfCommands = this->commandOperations.size();
+    const uint64_t numberOfDeprecated = this->deprecatedOperations.size();
+    CommandOperation* operation = NULL, *compatOperation = NULL; //separate so we can do both in one pass while giving priority on collision
+    
+    for (uint64_t i = 0; i < numberOfCommands; i++)
+    {
+        if (this->commandOperations[i]->getCommandLineSwitch() == commandSwitch)
+        {
+            operation = this->commandOperations[i];
+            break;
+        }
+        for (const AString compatSwitch : this->commandOperations[i]->getCompatibilitySwitches())
         {
-            for (uint64_t i = 0; i < numberOfDeprecated; i++)
+            if (compatSwitch == commandSwitch)
             {
-                if (this->deprecatedOperations[i]->getCommandLineSwitch() == commandSwitch)
-                {
-                    operation = this->deprecatedOperations[i];
-                    break;
-                }
-                for (const AString compatSwitch : this->deprecatedOperations[i]->getCompatibilitySwitches())
-                {
-                    if (compatSwitch == commandSwitch)
-                    {
-                        CaretAssert(compatOperation == NULL); //try to catch switch collisions in debug builds
-                        compatOperation = this->deprecatedOperations[i];
-                        break; //do NOT break outer loop, we want to give priority to non-compat switches
-                    }
-                }
+                CaretAssert(compatOperation == NULL); //try to catch switch collisions in debug builds
+                compatOperation = this->commandOperations[i];
+                break; //do NOT break outer loop, we want to give priority to non-compat switches
             }
         }
-        if (operation == NULL)
+    }
+    if (operation == NULL)
+    {
+        for (uint64_t i = 0; i < numberOfDeprecated; i++)
         {
-            operation = compatOperation; //may also be null, but that is fine
-        } else {
-            CaretAssert(compatOperation == NULL); //try to catch switch collisions in debug builds
-        }
-        
-        if (operation == NULL) {
-            if (!parameters.hasNext())
+            if (this->deprecatedOperations[i]->getCommandLineSwitch() == commandSwitch)
             {
-                printAllCommandsMatching(commandSwitch);
-            } else {
-                throw CommandException("Command \"" + commandSwitch + "\" not found.");
+                operation = this->deprecatedOperations[i];
+                break;
             }
-        } else {
-            if (!parameters.hasNext() && operation->takesParameters())
+            for (const AString compatSwitch : this->deprecatedOperations[i]->getCompatibilitySwitches())
             {
-                cout << operation->getHelpInformation(myProgramName) << endl;
-            } else {
-                operation->execute(parameters, preventProvenance);
+                if (compatSwitch == commandSwitch)
+                {
+                    CaretAssert(compatOperation == NULL); //try to catch switch collisions in debug builds
+                    compatOperation = this->deprecatedOperations[i];
+                    break; //do NOT break outer loop, we want to give priority to non-compat switches
+                }
             }
         }
     }
+    if (operation == NULL)
+    {
+        operation = compatOperation; //may also be null, but that is fine
+    } else {
+        CaretAssert(compatOperation == NULL); //try to catch switch collisions in debug builds
+    }
+    return operation;
 }
 
 AString CommandOperationManager::doCompletion(ProgramParameters& parameters, const bool& useExtGlob)
@@ -784,8 +837,24 @@ AString CommandOperationManager::doCompletion(ProgramParameters& parameters, con
     {
         return "";
     }
+    /*OptionInfo niftiAutoRangeInfo = */parseGlobalOption(parameters, "-nifti-output-auto-range", 0, globalOptionArgs, true);
     /*OptionInfo ciftiReadMemInfo = */parseGlobalOption(parameters, "-cifti-read-memory", 0, globalOptionArgs, true);
-    ret = "wordlist -disable-provenance\\ -logging\\ -simd\\ -cifti-output-datatype\\ -cifti-output-range\\ -nifti-output-datatype\\ -nifti-output-range\\ -cifti-read-memory";//we could prevent suggesting an already-provided global option, but that would be a bit surprising
+    OptionInfo traceInfo = parseGlobalOption(parameters, "-trace", 1, globalOptionArgs, true);
+    if (traceInfo.specified && !traceInfo.complete)
+    {
+        return "fileglob *.json";
+    }
+    OptionInfo threadsInfo = parseGlobalOption(parameters, "-threads", 1, globalOptionArgs, true);
+    if (threadsInfo.specified && !threadsInfo.complete)
+    {
+        return "";
+    }
+    OptionInfo bindingInfo = parseGlobalOption(parameters, "-thread-binding", 1, globalOptionArgs, true);
+    if (bindingInfo.specified && !bindingInfo.complete)
+    {
+        return "wordlist NONE\\ CLOSE\\ SPREAD";
+    }
+    ret = "wordlist -disable-provenance\\ -logging\\ -simd\\ -cifti-output-datatype\\ -cifti-output-range\\ -nifti-output-datatype\\ -nifti-output-range\\ -nifti-output-auto-range\\ -cifti-read-memory\\ -trace\\ -threads\\ -thread-binding";//we could prevent suggesting an already-provided global option, but that would be a bit surprising
     const uint64_t numberOfCommands = this->commandOperations.size();
     const uint64_t numberOfDeprecated = this->deprecatedOperations.size();
     if (!parameters.hasNext())
@@ -1159,6 +1228,13 @@ void CommandOperationManager::printGlobalOptions()
     cout << "                                        recommended with floating point types" << endl;
     cout << "                                        (see above)" << endl;
     cout << endl;
+    cout << "   -nifti-output-auto-range          with an integer -nifti-output-datatype," << endl;
+    cout << "                                        scale each output file to the range of" << endl;
+    cout << "                                        its data (e.g., INT16 for half the size" << endl;
+    cout << "                                        of FLOAT32), cifti files written while" << endl;
+    cout << "                                        computing are written as FLOAT32 unless" << endl;
+    cout << "                                        the command knows its output range" << endl;
+    cout << endl;
     cout << "   -logging <level>                  set the logging level, valid values are:" << endl;
     vector<LogLevelEnum::Enum> logLevels;
     LogLevelEnum::getAllEnums(logLevels);
@@ -1184,6 +1260,24 @@ void CommandOperationManager::printGlobalOptions()
     cout << "                                        avoid hitting limits on number of open" << endl;
     cout << "                                        files" << endl;
     cout << endl;
+    //guide for wrap, assuming 80 columns:                                                  |
+    cout << "   -trace <file>                     write a Chrome trace-event JSON file of" << endl;
+    cout << "                                        where the command spent its time (file" << endl;
+    cout << "                                        reading and writing, XML parsing," << endl;
+    cout << "                                        helpers, algorithms), with bytes read" << endl;
+    cout << "                                        and written and peak memory, view it" << endl;
+    cout << "                                        in ui.perfetto.dev or chrome://tracing" << endl;
+    cout << endl;
+    cout << "   -threads <num>                    use at most <num> threads, overrides" << endl;
+    cout << "                                        OMP_NUM_THREADS" << endl;
+    cout << endl;
+    cout << "   -thread-binding <policy>          bind threads to NUMA nodes (sockets), so" << endl;
+    cout << "                                        large data stays near the threads that" << endl;
+    cout << "                                        use it, valid values are:" << endl;
+    cout << "            NONE" << endl;
+    cout << "            CLOSE  - fill one node before using the next" << endl;
+    cout << "            SPREAD - alternate between nodes" << endl;
+    cout << endl;
     cout << "   -cifti-output-datatype <type>     deprecated, only affects cifti outputs" << endl;
     cout << "   -cifti-output-range <min> <max>   deprecated, only affects cifti outputs" << endl;
     cout << endl;
@@ -1333,11 +1427,17 @@ void CommandOperationManager::printParallelHelp(const AString& programName)
     cout << endl;//guide for wrap, assuming 80 columns:                                     |
     cout << "$ OMP_NUM_THREADS=4 "<< programName << " -volume-smoothing input.nii.gz 4 output.nii.gz" << endl;
     cout << endl;//guide for wrap, assuming 80 columns:                                     |
+    cout << "   The global option '-threads' does the same for one command, and takes" << endl;
+    cout << "   precedence over the environment variable." << endl;
+    cout << endl;//guide for wrap, assuming 80 columns:                                     |
     cout << "   If you have a multi-socket system, be aware that the parallelization can be" << endl;
     cout << "   much slower when threads are on different sockets, and this interacts badly" << endl;
-    cout << "   with the default behavior of using all available cores.  It is advisable to" << endl;
-    cout << "   use other tools to restrict the entire script to execute on a single socket," << endl;
-    cout << "   especially if a queueing system is involved." << endl;
+    cout << "   with the default behavior of using all available cores.  The global option" << endl;
+    cout << "   '-thread-binding' keeps each thread on one socket (NUMA node), and large" << endl;
+    cout << "   data arrays are then initialized by the threads that use them, so that" << endl;
+    cout << "   their memory is spread across the sockets.  Alternatively, use other tools" << endl;
+    cout << "   to restrict the entire script to execute on a single socket, especially if" << endl;
+    cout << "   a queueing system is involved." << endl;
     cout << endl;//guide for wrap, assuming 80 columns:                                     |
     cout << "   Also note that wb_view contains a few features that use multithreading" << endl;
     cout << "   (dynamic connectivity, border optimize), which can be controlled by setting" << endl;
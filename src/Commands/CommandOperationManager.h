@@ -48,6 +48,8 @@ namespace caret {
         
         std::vector<CommandOperation*> getCommandOperations();
         
+        CommandOperation* findCommandOperation(const AString& commandSwitch);
+        
     private:
         CommandOperationManager();
         
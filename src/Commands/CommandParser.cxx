@@ -29,6 +29,7 @@
 #include "CaretCommandGlobalOptions.h"
 #include "CaretDataFileHelper.h"
 #include "CaretLogger.h"
+#include "CaretTrace.h"
 #include "CiftiFile.h"
 #include "DataFileException.h"
 #include "FileInformation.h"
@@ -47,6 +48,119 @@
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    AString getParameterFileName(AbstractParameter* myParam)
+    {
+        switch (myParam->getType())
+        {
+            case OperationParametersEnum::ANNOTATION:
+                return ((AnnotationParameter*)myParam)->m_filename;
+            case OperationParametersEnum::BORDER:
+                return ((BorderParameter*)myParam)->m_filename;
+            case OperationParametersEnum::CIFTI:
+                return ((CiftiParameter*)myParam)->m_filename;
+            case OperationParametersEnum::FOCI:
+                return ((FociParameter*)myParam)->m_filename;
+            case OperationParametersEnum::LABEL:
+                return ((LabelParameter*)myParam)->m_filename;
+            case OperationParametersEnum::METRIC:
+                return ((MetricParameter*)myParam)->m_filename;
+            case OperationParametersEnum::SURFACE:
+                return ((SurfaceParameter*)myParam)->m_filename;
+            case OperationParametersEnum::VOLUME:
+                return ((VolumeParameter*)myParam)->m_filename;
+            default:
+                CaretAssert(false);
+                return "";
+        }
+    }
+    
+    const GiftiMetaData* getParameterFileMetaData(AbstractParameter* myParam)
+    {//returns NULL if the parameter doesn't have a file yet
+        switch (myParam->getType())
+        {
+            case OperationParametersEnum::ANNOTATION:
+            {
+                AnnotationFile* myFile = ((AnnotationParameter*)myParam)->m_parameter;
+                return (myFile == NULL ? NULL : myFile->getFileMetaData());
+            }
+            case OperationParametersEnum::BORDER:
+            {
+                BorderFile* myFile = ((BorderParameter*)myParam)->m_parameter;
+                return (myFile == NULL ? NULL : myFile->getFileMetaData());
+            }
+            case OperationParametersEnum::CIFTI:
+            {
+                CiftiFile* myFile = ((CiftiParameter*)myParam)->m_parameter;
+                return (myFile == NULL ? NULL : myFile->getCiftiXML().getFileMetaData());
+            }
+            case OperationParametersEnum::FOCI:
+            {
+                FociFile* myFile = ((FociParameter*)myParam)->m_parameter;
+                return (myFile == NULL ? NULL : myFile->getFileMetaData());
+            }
+            case OperationParametersEnum::LABEL:
+            {
+                LabelFile* myFile = ((LabelParameter*)myParam)->m_parameter;
+                return (myFile == NULL ? NULL : myFile->getFileMetaData());
+            }
+            case OperationParametersEnum::METRIC:
+            {
+                MetricFile* myFile = ((MetricParameter*)myParam)->m_parameter;
+                return (myFile == NULL ? NULL : myFile->getFileMetaData());
+            }
+            case OperationParametersEnum::SURFACE:
+            {
+                SurfaceFile* myFile = ((SurfaceParameter*)myParam)->m_parameter;
+                return (myFile == NULL ? NULL : myFile->getFileMetaData());
+            }
+            case OperationParametersEnum::VOLUME:
+            {
+                VolumeFile* myFile = ((VolumeParameter*)myParam)->m_parameter;
+                return (myFile == NULL ? NULL : myFile->getFileMetaData());
+            }
+            default:
+                return NULL;
+        }
+    }
+    
+    void shareParameterFile(AbstractParameter* from, AbstractParameter* to)
+    {//CaretPointer shares the reference count, so the file lives as long as any parameter holds it
+        CaretAssert(from->getType() == to->getType());
+        switch (to->getType())
+        {
+            case OperationParametersEnum::ANNOTATION:
+                ((AnnotationParameter*)to)->m_parameter = ((AnnotationParameter*)from)->m_parameter;
+                break;
+            case OperationParametersEnum::BORDER:
+                ((BorderParameter*)to)->m_parameter = ((BorderParameter*)from)->m_parameter;
+                break;
+            case OperationParametersEnum::CIFTI:
+                ((CiftiParameter*)to)->m_parameter = ((CiftiParameter*)from)->m_parameter;
+                break;
+            case OperationParametersEnum::FOCI:
+                ((FociParameter*)to)->m_parameter = ((FociParameter*)from)->m_parameter;
+                break;
+            case OperationParametersEnum::LABEL:
+                ((LabelParameter*)to)->m_parameter = ((LabelParameter*)from)->m_parameter;
+                break;
+            case OperationParametersEnum::METRIC:
+                ((MetricParameter*)to)->m_parameter = ((MetricParameter*)from)->m_parameter;
+                break;
+            case OperationParametersEnum::SURFACE:
+                ((SurfaceParameter*)to)->m_parameter = ((SurfaceParameter*)from)->m_parameter;
+                break;
+            case OperationParametersEnum::VOLUME:
+                ((VolumeParameter*)to)->m_parameter = ((VolumeParameter*)from)->m_parameter;
+                break;
+            default:
+                CaretAssert(false);
+                throw CommandException("Internal parsing error, attempted to share a non-file parameter");
+        }
+    }
+}
+
 CommandParser::CommandParser(AutoOperationInterface* myAutoOper) :
     CommandOperation(myAutoOper->getCommandSwitch(), myAutoOper->getShortDescription())
 {
@@ -58,6 +172,13 @@ CommandParser::CommandParser(AutoOperationInterface* myAutoOper) :
     m_volumeMin = m_ciftiMin = -1.0;
 }
 
+CommandParser* CommandParser::cloneParser() const
+{
+    CommandParser* ret = new CommandParser(m_autoOper->clone());
+    ret->m_doProvenance = m_doProvenance;
+    return ret;
+}
+
 void CommandParser::disableProvenance()
 {
     m_doProvenance = false;
@@ -108,6 +229,132 @@ void CommandParser::executeOperation(ProgramParameters& parameters)
     writeOutput(myOutAssoc);
 }
 
+void CommandParser::parsePipelineStep(ProgramParameters& parameters, const AString& stepProvenance, PipelineStep& stepOut)
+{
+    m_inputCiftiOnDiskMap.clear();//the same parser may be used by several steps, don't let one step's inputs affect another's outputs
+    stepOut.m_params.grabNew(m_autoOper->getParameters());
+    stepOut.m_outAssoc.clear();
+    parseComponent(stepOut.m_params.getPointer(), parameters, stepOut.m_outAssoc);
+    parameters.verifyAllParametersProcessed();
+    for (size_t i = 0; i < stepOut.m_outAssoc.size(); ++i)
+    {
+        if (isInMemoryName(stepOut.m_outAssoc[i].m_fileName) && stepOut.m_outAssoc[i].m_param->getType() == OperationParametersEnum::CIFTI)
+        {
+            ((CiftiParameter*)stepOut.m_outAssoc[i].m_param)->m_doOnDiskWrite = false;
+        }
+    }
+    checkOnDiskOutputCollision(stepOut.m_outAssoc);
+    m_inputCiftiOnDiskMap.clear();
+    stepOut.m_inputs.clear();
+    stepOut.m_inputNames.clear();
+    collectInputs(stepOut.m_params.getPointer(), stepOut.m_inputs, stepOut.m_inputNames);
+    stepOut.m_provHelp.m_provenance = stepProvenance;
+    stepOut.m_provHelp.m_doProvenance = m_doProvenance;
+    stepOut.m_provHelp.m_workingDir = QDir::currentPath();
+    vector<AString> versionInfo;
+    ApplicationInformation myInfo;
+    myInfo.getAllInformation(versionInfo);
+    for (int i = 0; i < (int)versionInfo.size(); ++i)
+    {
+        stepOut.m_provHelp.m_versionProvenance += versionInfo[i] + "\n";
+    }
+    stepOut.m_params->prepareProvenance(&stepOut.m_provHelp);
+}
+
+void CommandParser::executePipelineStep(PipelineStep& step)
+{
+    OperationParameters* myAlgParams = step.m_params.getPointer();
+    if (m_autoOper->lazyFileReading())
+    {
+        myAlgParams->checkInputFilesExist();//skips inputs that are already in memory
+    } else {
+        myAlgParams->openAllInputFiles();//in-memory inputs already have their file, so they aren't read
+    }
+    m_autoOper->useParameters(myAlgParams, NULL);
+    vector<AString> uncheckedWarnings = myAlgParams->findUncheckedParams("the command");
+    for (size_t i = 0; i < uncheckedWarnings.size(); ++i)
+    {
+        CaretLogWarning("developer warning: " + uncheckedWarnings[i]);
+    }
+    myAlgParams->closeAllInputFiles();//in-memory inputs are still referenced by the pipeline, so this only drops this step's reference
+    if (m_doProvenance) provenanceAfterOperation(step.m_outAssoc, step.m_provHelp);
+    vector<OutputAssoc> diskOutputs;
+    for (size_t i = 0; i < step.m_outAssoc.size(); ++i)
+    {
+        if (!isInMemoryName(step.m_outAssoc[i].m_fileName) || !isFileParameter(step.m_outAssoc[i].m_param))
+        {
+            diskOutputs.push_back(step.m_outAssoc[i]);
+        }
+    }
+    writeOutput(diskOutputs);
+}
+
+void CommandParser::collectInputs(ParameterComponent* myComponent, vector<AbstractParameter*>& inputsOut, vector<AString>& namesOut)
+{
+    for (size_t i = 0; i < myComponent->m_paramList.size(); ++i)
+    {
+        AbstractParameter* myParam = myComponent->m_paramList[i];
+        if (myParam->getType() == OperationParametersEnum::STRING)
+        {
+            inputsOut.push_back(myParam);
+            namesOut.push_back(((StringParameter*)myParam)->m_parameter);
+        } else if (isFileParameter(myParam)) {
+            inputsOut.push_back(myParam);
+            namesOut.push_back(getParameterFileName(myParam));
+        }
+    }
+    for (size_t i = 0; i < myComponent->m_optionList.size(); ++i)
+    {
+        if (myComponent->m_optionList[i]->m_present)
+        {
+            collectInputs(myComponent->m_optionList[i], inputsOut, namesOut);
+        }
+    }
+    for (size_t i = 0; i < myComponent->m_repeatableOptions.size(); ++i)
+    {
+        for (size_t j = 0; j < myComponent->m_repeatableOptions[i]->m_instances.size(); ++j)
+        {
+            collectInputs(myComponent->m_repeatableOptions[i]->m_instances[j], inputsOut, namesOut);
+        }
+    }
+}
+
+bool CommandParser::isFileParameter(AbstractParameter* myParam)
+{
+    switch (myParam->getType())
+    {
+        case OperationParametersEnum::ANNOTATION:
+        case OperationParametersEnum::BORDER:
+        case OperationParametersEnum::CIFTI:
+        case OperationParametersEnum::FOCI:
+        case OperationParametersEnum::LABEL:
+        case OperationParametersEnum::METRIC:
+        case OperationParametersEnum::SURFACE:
+        case OperationParametersEnum::VOLUME:
+            return true;
+        default:
+            return false;
+    }
+}
+
+AbstractParameter* CommandParser::holdFile(AbstractParameter* from)
+{
+    AbstractParameter* ret = from->cloneAbstractParameter();//clone doesn't copy the file pointer, so share it explicitly
+    shareParameterFile(from, ret);
+    return ret;
+}
+
+void CommandParser::shareFile(AbstractParameter* from, AbstractParameter* to, const AString& name, ProvenanceHelper& provHelp)
+{
+    if (from->getType() != to->getType())
+    {
+        throw CommandException("in-memory file '" + name + "' is of type " + OperationParametersEnum::toName(from->getType()) +
+                               ", but <" + to->m_shortName + "> needs type " + OperationParametersEnum::toName(to->getType()));
+    }
+    shareParameterFile(from, to);
+    provHelp.addToProvenance(getParameterFileMetaData(to), name);
+}
+
 void CommandParser::showParsedOperation(ProgramParameters& parameters)
 {
     CaretPointer<OperationParameters> myAlgParams(m_autoOper->getParameters());//could be an autopointer, but this is safer
@@ -187,7 +434,7 @@ void CommandParser::parseComponent(ParameterComponent* myComponent, ProgramParam
             {
                 ((CiftiParameter*)myComponent->m_paramList[i])->m_filename = nextArg;
                 FileInformation myInfo(nextArg);
-                if (!caret_global_command_options.m_ciftiReadMemory)
+                if (!caret_global_command_options.m_ciftiReadMemory && !isInMemoryName(nextArg))//pipeline in-memory files aren't on disk
                 {
                     m_inputCiftiOnDiskMap[myInfo.getCanonicalFilePath()] = (CiftiParameter*)myComponent->m_paramList[i];//track name and parameter, to additionally check file size to avoid warning for small files
                 }
@@ -780,6 +1027,7 @@ void CommandParser::checkOnDiskOutputCollision(const vector<OutputAssoc>& outAss
             case OperationParametersEnum::CIFTI:
             {
                 CiftiParameter* myCiftiParam = (CiftiParameter*)myParam;
+                if (isInMemoryName(outAssociation[i].m_fileName)) break;
                 FileInformation myInfo(outAssociation[i].m_fileName);
                 map<AString, const CiftiParameter*>::iterator iter = m_inputCiftiOnDiskMap.find(myInfo.getCanonicalFilePath());
                 if (iter != m_inputCiftiOnDiskMap.end())
@@ -800,6 +1048,8 @@ void CommandParser::writeOutput(const vector<OutputAssoc>& outAssociation)
     for (uint32_t i = 0; i < outAssociation.size(); ++i)
     {
         AbstractParameter* myParam = outAssociation[i].m_param;
+        CaretTraceSpan traceSpan("io", "write file");
+        traceSpan.setDetail(outAssociation[i].m_fileName);
         switch (myParam->getType())
         {
             case OperationParametersEnum::BOOL://ignores the name you give the output for now, but what gives primitive type output and how is it used?
@@ -854,8 +1104,10 @@ void CommandParser::writeOutput(const vector<OutputAssoc>& outAssociation)
             case OperationParametersEnum::VOLUME:
             {
                 VolumeFile* myFile = ((VolumeParameter*)myParam)->lazyGet();
-                if (caret_global_command_options.m_volumeScale)
+                if (caret_global_command_options.m_volumeAutoRange)
                 {
+                    myFile->setWritingDataTypeAutoScaling(caret_global_command_options.m_volumeDType);
+                } else if (caret_global_command_options.m_volumeScale) {
                     myFile->setWritingDataTypeAndScaling(caret_global_command_options.m_volumeDType, caret_global_command_options.m_volumeMin, caret_global_command_options.m_volumeMax);
                 } else {
                     myFile->setWritingDataTypeNoScaling(caret_global_command_options.m_volumeDType);
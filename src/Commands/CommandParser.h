@@ -42,11 +42,22 @@ namespace caret {
         int16_t m_ciftiDType, m_volumeDType;
         std::map<AString, const CiftiParameter*> m_inputCiftiOnDiskMap;
         CaretPointer<AutoOperationInterface> m_autoOper;
+    public:
         struct OutputAssoc
         {//how the output is stored is up to the parser, in the GUI it should load into memory without writing to disk
             AString m_fileName;
             AbstractParameter* m_param;
         };
+        ///a command parsed as one step of a pipeline, file arguments starting with '@' are in-memory files shared with other steps
+        struct PipelineStep
+        {
+            CaretPointer<OperationParameters> m_params;
+            std::vector<OutputAssoc> m_outAssoc;
+            std::vector<AbstractParameter*> m_inputs;//file and string inputs, strings are included because some commands take filenames as strings
+            std::vector<AString> m_inputNames;//filename or string value of each input
+            ProvenanceHelper m_provHelp;
+        };
+    private:
         struct CompletionInfo
         {
             bool complete, found;//found is only used for options
@@ -59,6 +70,7 @@ namespace caret {
         void provenanceAfterOperation(const std::vector<OutputAssoc>& outAssociation, ProvenanceHelper& provHelp);
         void checkOnDiskOutputCollision(const std::vector<OutputAssoc>& outAssociation);//ensures on-disk inputs aren't used as on-disk outputs, keeping outputs in-memory when needed
         void writeOutput(const std::vector<OutputAssoc>& outAssociation);
+        void collectInputs(ParameterComponent* myComponent, std::vector<AbstractParameter*>& inputsOut, std::vector<AString>& namesOut);
         AString getIndentString(int desired);
         void addHelpComponent(AString& info, ParameterComponent* myComponent, int curIndent);
         void addHelpOptions(AString& info, ParameterComponent* myAlgParams, int curIndent);
@@ -72,6 +84,8 @@ namespace caret {
         CompletionInfo completionRemainingOptions(ParameterComponent* myComponent, ProgramParameters& parameters, const bool& useExtGlob);
     public:
         CommandParser(AutoOperationInterface* myAutoOper);
+        ///a new parser for the same operation, so pipeline steps don't share parser state
+        CommandParser* cloneParser() const;
         void disableProvenance();
         void executeOperation(ProgramParameters& parameters);
         void showParsedOperation(ProgramParameters& parameters);
@@ -79,6 +93,17 @@ namespace caret {
         AString getHelpInformation(const AString& programName);
         std::vector<AString> getCompatibilitySwitches() const;
         bool takesParameters();
+        
+        ///parse a command for a pipeline, without opening any files
+        void parsePipelineStep(ProgramParameters& parameters, const AString& stepProvenance, PipelineStep& stepOut);
+        ///run a parsed pipeline step, in-memory inputs must already be shared into the step, in-memory outputs are not written
+        void executePipelineStep(PipelineStep& step);
+        static bool isInMemoryName(const AString& name) { return name.startsWith("@"); }
+        static bool isFileParameter(AbstractParameter* myParam);
+        ///make a parameter that holds a reference to the file of a parameter of the same type
+        static AbstractParameter* holdFile(AbstractParameter* from);
+        ///share the file held by one parameter into another input parameter of the same type, adding its provenance to the step
+        static void shareFile(AbstractParameter* from, AbstractParameter* to, const AString& name, ProvenanceHelper& provHelp);
     };
 
 };
@@ -0,0 +1,351 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CommandPipeline.h"
+
+#include "CaretAssert.h"
+#include "CaretException.h"
+#include "CaretLogger.h"
+#include "CaretOMP.h"
+#include "CommandException.h"
+#include "CommandOperationManager.h"
+#include "CommandParser.h"
+#include "FileInformation.h"
+#include "PipelineScript.h"
+#include "ProgramParameters.h"
+
+#include <QFile>
+
+#include <algorithm>
+#include <exception>
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    AString commandText(const PipelineScript::Command& command)
+    {//for provenance, quote arguments that wouldn't survive a shell
+        AString ret = "wb_command";
+        for (size_t i = 0; i < command.m_args.size(); ++i)
+        {
+            const AString& arg = command.m_args[i];
+            if (arg.isEmpty() || arg.contains(' ') || arg.contains('\t') || arg.contains('\'') || arg.contains('"'))
+            {
+                ret += " '" + AString(arg).replace("'", "'\\''") + "'";
+            } else {
+                ret += " " + arg;
+            }
+        }
+        return ret;
+    }
+}
+
+/**
+ * Constructor.
+ */
+CommandPipeline::CommandPipeline()
+: CommandOperation("-pipeline",
+                   "RUN SEVERAL COMMANDS WITH FILES KEPT IN MEMORY")
+{
+    m_doProvenance = true;
+}
+
+/**
+ * Destructor.
+ */
+CommandPipeline::~CommandPipeline()
+{
+}
+
+void CommandPipeline::disableProvenance()
+{
+    m_doProvenance = false;
+}
+
+AString
+CommandPipeline::getHelpInformation(const AString& programName)
+{
+    return "RUN SEVERAL COMMANDS WITH FILES KEPT IN MEMORY\n"
+           "   " + programName + " -pipeline\n"
+           "      <script> - text file of commands to run\n"
+           "\n"
+           "      [-sequential] - run one command at a time, in script order\n"
+           "\n"
+           "   Each line of the script is one command, written as it would be on the\n"
+           "   command line, with or without the leading 'wb_command'.  Arguments are\n"
+           "   split on whitespace, and may be quoted with '...' or \"...\".  A backslash\n"
+           "   at the end of a line continues the command on the next line, and #\n"
+           "   starts a comment.  Global options can't be used inside the script, give\n"
+           "   them before -pipeline instead.\n"
+           "\n"
+           "   A file argument that starts with @, like @smoothed, names a file that is\n"
+           "   kept in memory instead of being written to disk.  Each in-memory name\n"
+           "   must be created as an output by exactly one command, before any command\n"
+           "   that uses it as an input, and must be used with the same file type.\n"
+           "   Outputs with ordinary filenames are written to disk as usual, so only\n"
+           "   the files you name are written.  In-memory files are freed once the last\n"
+           "   command that uses them finishes.\n"
+           "\n"
+           "   Commands that don't depend on each other's outputs are run at the same\n"
+           "   time, each using fewer threads.  A command depends on an earlier one if\n"
+           "   it reads a file (in-memory or on disk) that the earlier command writes,\n"
+           "   or writes a file that the earlier command reads or writes.  Commands\n"
+           "   that read the same in-memory file are run one after another.  A text\n"
+           "   argument that looks like a filename (it has an extension or a\n"
+           "   directory) may be a file the command writes, so commands that give the\n"
+           "   same filename as text are also run one after another.  Use -sequential\n"
+           "   to run the commands strictly in script order.\n"
+           "\n"
+           "   For example:\n"
+           "\n"
+           "   -metric-smoothing midthickness.surf.gii data.func.gii 2 @smooth\n"
+           "   -metric-math 'x * 2' doubled.func.gii -var x @smooth\n"
+           "   -metric-math 'x > 1' mask.func.gii -var x @smooth\n";
+}
+
+/**
+ * Execute the operation.
+ * 
+ * @param parameters
+ *   Parameters for the operation.
+ * @throws CommandException
+ *   If the command failed.
+ * @throws ProgramParametersException
+ *   If there is an error in the parameters.
+ */
+void 
+CommandPipeline::executeOperation(ProgramParameters& parameters)
+{
+    const AString scriptName = parameters.nextString("pipeline script");
+    bool sequential = false;
+    while (parameters.hasNext())
+    {
+        const AString option = parameters.nextString("option");
+        if (option == "-sequential")
+        {
+            sequential = true;
+        } else {
+            throw ProgramParametersException("unrecognized option: '" + option + "'");
+        }
+    }
+    QFile scriptFile(scriptName);
+    if (!scriptFile.open(QIODevice::ReadOnly))
+    {
+        throw CommandException("unable to open pipeline script '" + scriptName + "'");
+    }
+    const QByteArray scriptBytes = scriptFile.readAll();
+    const vector<PipelineScript::Command> commands = PipelineScript::tokenize(string(scriptBytes.constData(), scriptBytes.size()));
+    if (commands.empty())
+    {
+        throw CommandException("pipeline script '" + scriptName + "' has no commands");
+    }
+    
+    //parse everything before running anything, and work out which commands each command must wait for
+    CommandOperationManager* manager = CommandOperationManager::getCommandOperationManager();
+    const int numSteps = (int)commands.size();
+    vector<CaretPointer<CommandParser::PipelineStep> > steps(numSteps);
+    vector<CaretPointer<CommandParser> > parsers(numSteps);//a parser per step, so commands of the same operation can run at the same time
+    vector<vector<PipelineScript::Access> > stepAccesses(numSteps);
+    map<AString, pair<int, AbstractParameter*> > producers;//in-memory name -> creating step and its output parameter
+    map<AString, int> lastAccess;//in-memory name -> last step to create or read it
+    for (int s = 0; s < numSteps; ++s)
+    {
+        const PipelineScript::Command& command = commands[s];
+        const AString linePrefix = "pipeline line " + AString::number(command.m_lineNumber) + ": ";
+        CommandOperation* operation = manager->findCommandOperation(command.m_args[0]);
+        if (operation == NULL)
+        {
+            throw CommandException(linePrefix + "command '" + command.m_args[0] + "' not found");
+        }
+        CommandParser* managerParser = dynamic_cast<CommandParser*>(operation);
+        if (managerParser == NULL)
+        {
+            throw CommandException(linePrefix + "command '" + command.m_args[0] + "' can't be used in a pipeline");
+        }
+        parsers[s].grabNew(managerParser->cloneParser());
+        if (!m_doProvenance) parsers[s]->disableProvenance();
+        ProgramParameters stepParameters;
+        for (size_t i = 1; i < command.m_args.size(); ++i)
+        {
+            stepParameters.addParameter(command.m_args[i]);
+        }
+        steps[s].grabNew(new CommandParser::PipelineStep());
+        try
+        {
+            parsers[s]->parsePipelineStep(stepParameters, commandText(command), *(steps[s]));
+        } catch (const CaretException& e) {
+            throw CommandException(linePrefix + e.whatString());
+        }
+        CommandParser::PipelineStep& step = *(steps[s]);
+        for (size_t i = 0; i < step.m_inputs.size(); ++i)
+        {
+            const AString& name = step.m_inputNames[i];
+            AbstractParameter* myParam = step.m_inputs[i];
+            if (name.isEmpty()) continue;
+            if (CommandParser::isInMemoryName(name) && CommandParser::isFileParameter(myParam))
+            {
+                map<AString, pair<int, AbstractParameter*> >::iterator iter = producers.find(name);
+                if (iter == producers.end())
+                {
+                    throw CommandException(linePrefix + "in-memory file '" + name + "' is used before any command creates it");
+                }
+                if (iter->second.second->getType() != myParam->getType())
+                {
+                    throw CommandException(linePrefix + "in-memory file '" + name + "' is of type " + OperationParametersEnum::toName(iter->second.second->getType()) +
+                                           ", but <" + myParam->m_shortName + "> needs type " + OperationParametersEnum::toName(myParam->getType()));
+                }
+                lastAccess[name] = s;
+                stepAccesses[s].push_back(PipelineScript::Access(name, PipelineScript::MEMORY));
+            } else {
+                PipelineScript::AccessType type = PipelineScript::READ;
+                if (myParam->getType() == OperationParametersEnum::STRING)
+                {//some commands write text files, or take filenames as strings
+                    type = PipelineScript::stringAccessType(myParam->m_description, name);
+                }
+                stepAccesses[s].push_back(PipelineScript::Access(FileInformation(name).getAbsoluteFilePath(), type));
+            }
+        }
+        for (size_t i = 0; i < step.m_outAssoc.size(); ++i)
+        {
+            const AString& name = step.m_outAssoc[i].m_fileName;
+            AbstractParameter* myParam = step.m_outAssoc[i].m_param;
+            if (!CommandParser::isFileParameter(myParam)) continue;
+            if (CommandParser::isInMemoryName(name))
+            {
+                if (producers.find(name) != producers.end())
+                {
+                    throw CommandException(linePrefix + "in-memory file '" + name + "' is created by more than one command");
+                }
+                producers[name] = make_pair(s, myParam);
+                lastAccess[name] = s;
+                stepAccesses[s].push_back(PipelineScript::Access(name, PipelineScript::MEMORY));
+            } else {
+                stepAccesses[s].push_back(PipelineScript::Access(FileInformation(name).getAbsoluteFilePath(), PipelineScript::WRITE));
+            }
+        }
+    }
+    vector<int> wave = PipelineScript::computeWaves(stepAccesses);
+    if (sequential)
+    {//one command per wave, in script order, so side effects and log output aren't reordered
+        for (int s = 0; s < numSteps; ++s)
+        {
+            wave[s] = s;
+        }
+    }
+    for (map<AString, pair<int, AbstractParameter*> >::iterator iter = producers.begin(); iter != producers.end(); ++iter)
+    {
+        if (lastAccess[iter->first] == iter->second.first)
+        {
+            CaretLogWarning("pipeline line " + AString::number(commands[iter->second.first].m_lineNumber) + ": in-memory file '" + iter->first + "' is never used");
+        }
+    }
+    
+    //run the commands one wave at a time, each wave only depends on earlier waves
+    int numWaves = 0;
+    for (int s = 0; s < numSteps; ++s)
+    {
+        numWaves = max(numWaves, wave[s] + 1);
+    }
+    map<AString, CaretPointer<AbstractParameter> > memoryFiles;
+    for (int w = 0; w < numWaves; ++w)
+    {
+        vector<int> waveSteps;
+        for (int s = 0; s < numSteps; ++s)
+        {
+            if (wave[s] == w) waveSteps.push_back(s);
+        }
+        for (size_t i = 0; i < waveSteps.size(); ++i)
+        {//share in-memory inputs before going parallel, the map isn't safe to modify from several threads
+            CommandParser::PipelineStep& step = *(steps[waveSteps[i]]);
+            for (size_t j = 0; j < step.m_inputs.size(); ++j)
+            {
+                const AString& name = step.m_inputNames[j];
+                if (CommandParser::isInMemoryName(name) && CommandParser::isFileParameter(step.m_inputs[j]))
+                {
+                    CaretAssert(memoryFiles.find(name) != memoryFiles.end());
+                    CommandParser::shareFile(memoryFiles[name], step.m_inputs[j], name, step.m_provHelp);
+                }
+            }
+        }
+        const int numWaveSteps = (int)waveSteps.size();
+        int errorStep = -1;
+        AString errorMessage;
+#pragma omp CARET_PARFOR schedule(dynamic, 1) if (numWaveSteps > 1)
+        for (int i = 0; i < numWaveSteps; ++i)
+        {
+            const int s = waveSteps[i];
+            AString message;
+            bool failed = false;
+            try
+            {
+                CaretLogFine("pipeline line " + AString::number(commands[s].m_lineNumber) + ": running " + commands[s].m_args[0]);
+                parsers[s]->executePipelineStep(*(steps[s]));
+            } catch (const CaretException& e) {
+                failed = true;
+                message = e.whatString();
+            } catch (const std::exception& e) {
+                failed = true;
+                message = e.what();
+            }
+            if (failed)
+            {
+#pragma omp critical
+                {
+                    if (errorStep < 0 || s < errorStep)//report the earliest failing command in the script
+                    {
+                        errorStep = s;
+                        errorMessage = "pipeline line " + AString::number(commands[s].m_lineNumber) + ": " + message;
+                    }
+                }
+            }
+        }
+        if (errorStep >= 0)
+        {
+            throw CommandException(errorMessage);
+        }
+        for (size_t i = 0; i < waveSteps.size(); ++i)
+        {
+            const int s = waveSteps[i];
+            CommandParser::PipelineStep& step = *(steps[s]);
+            for (size_t j = 0; j < step.m_outAssoc.size(); ++j)
+            {
+                const AString& name = step.m_outAssoc[j].m_fileName;
+                if (CommandParser::isInMemoryName(name) && CommandParser::isFileParameter(step.m_outAssoc[j].m_param))
+                {
+                    memoryFiles[name].grabNew(CommandParser::holdFile(step.m_outAssoc[j].m_param));
+                }
+            }
+            steps[s].grabNew(NULL);//done with the parameter tree, and its references to files
+        }
+        for (map<AString, CaretPointer<AbstractParameter> >::iterator iter = memoryFiles.begin(); iter != memoryFiles.end(); )
+        {//free in-memory files nothing later will read
+            if (wave[lastAccess[iter->first]] <= w)
+            {
+                memoryFiles.erase(iter++);
+            } else {
+                ++iter;
+            }
+        }
+    }
+}
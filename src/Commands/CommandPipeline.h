@@ -0,0 +1,57 @@
+#ifndef __COMMAND_PIPELINE_H__
+#define __COMMAND_PIPELINE_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+
+#include "CommandOperation.h"
+
+namespace caret {
+
+    /// Command that runs a script of commands in one process, keeping intermediate files in memory.
+    class CommandPipeline : public CommandOperation {
+        
+    public:
+        CommandPipeline();
+        
+        virtual ~CommandPipeline();
+
+        virtual void executeOperation(ProgramParameters& parameters);
+        
+        AString getHelpInformation(const AString& programName);
+        
+        virtual bool takesParameters() { return true; }
+        
+    protected:
+        virtual void disableProvenance();
+        
+    private:
+        
+        CommandPipeline(const CommandPipeline&);
+
+        CommandPipeline& operator=(const CommandPipeline&);
+        
+        bool m_doProvenance;
+    };
+    
+} // namespace
+
+#endif // __COMMAND_PIPELINE_H__
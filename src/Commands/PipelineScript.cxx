@@ -0,0 +1,190 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "PipelineScript.h"
+
+#include "CommandException.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    void finishToken(string& token, bool& inToken, PipelineScript::Command& command)
+    {
+        if (inToken)
+        {
+            command.m_args.push_back(AString::fromStdString(token));
+            token.clear();
+            inToken = false;
+        }
+    }
+}
+
+vector<PipelineScript::Command> PipelineScript::tokenize(const string& text)
+{
+    vector<Command> ret;
+    Command current;
+    int lineNumber = 1;
+    current.m_lineNumber = lineNumber;
+    string token;
+    bool inToken = false;
+    size_t i = 0;
+    const size_t length = text.size();
+    while (i < length)
+    {
+        const char c = text[i];
+        if (c == '\n')
+        {
+            finishToken(token, inToken, current);
+            if (!current.m_args.empty()) ret.push_back(current);
+            current.m_args.clear();
+            ++lineNumber;
+            current.m_lineNumber = lineNumber;
+            ++i;
+        } else if (c == ' ' || c == '\t' || c == '\r') {
+            finishToken(token, inToken, current);
+            ++i;
+        } else if (c == '#' && !inToken) {
+            while (i < length && text[i] != '\n') ++i;
+        } else if (c == '\\') {
+            size_t next = i + 1;
+            if (next < length && text[next] == '\r') ++next;
+            if (next < length && text[next] == '\n')
+            {//line continuation
+                finishToken(token, inToken, current);
+                ++lineNumber;
+                i = next + 1;
+            } else if (i + 1 < length) {
+                token += text[i + 1];
+                inToken = true;
+                i += 2;
+            } else {
+                ++i;
+            }
+        } else if (c == '\'' || c == '"') {
+            const int quoteLine = lineNumber;
+            inToken = true;
+            ++i;
+            while (i < length && text[i] != c)
+            {
+                if (c == '"' && text[i] == '\\' && i + 1 < length && (text[i + 1] == '"' || text[i + 1] == '\\'))
+                {
+                    ++i;
+                } else if (text[i] == '\n') {
+                    ++lineNumber;
+                }
+                token += text[i];
+                ++i;
+            }
+            if (i >= length)
+            {
+                throw CommandException("unterminated quote starting on line " + AString::number(quoteLine));
+            }
+            ++i;
+        } else {
+            token += c;
+            inToken = true;
+            ++i;
+        }
+    }
+    finishToken(token, inToken, current);
+    if (!current.m_args.empty()) ret.push_back(current);
+    for (size_t j = 0; j < ret.size(); ++j)
+    {//allow lines copied from shell scripts
+        if (ret[j].m_args[0] == "wb_command") ret[j].m_args.erase(ret[j].m_args.begin());
+    }
+    for (size_t j = 0; j < ret.size(); )
+    {
+        if (ret[j].m_args.empty())
+        {
+            ret.erase(ret.begin() + j);
+        } else {
+            ++j;
+        }
+    }
+    return ret;
+}
+
+PipelineScript::AccessType PipelineScript::stringAccessType(const AString& description, const AString& value)
+{
+    //commands that write files named by strings fake the output formatting in the description
+    if (description.startsWith("output") || description.startsWith("out -")) return WRITE;
+    //other strings may still be files the command writes, so order commands that name the same file
+    if (value.isEmpty() || value.contains(' ') || value.contains('\t')) return READ;
+    if (value.contains('/') || value.contains('\\')) return WRITE;
+    const int dot = value.lastIndexOf('.');
+    if (dot >= 0 && dot + 1 < value.size() && value[dot + 1].isLetter()) return WRITE;//has an extension, not a number or an expression
+    return READ;
+}
+
+vector<int> PipelineScript::computeWaves(const vector<vector<Access> >& stepAccesses)
+{
+    const int numSteps = (int)stepAccesses.size();
+    vector<int> ret(numSteps, 0);
+    map<AString, int> lastAccess;//in-memory name -> last step to create or read it
+    map<AString, int> lastWriter;//absolute path -> last step that writes it
+    map<AString, vector<int> > readersSinceWrite;//absolute path -> steps that read it since the last write
+    for (int s = 0; s < numSteps; ++s)
+    {
+        set<int> dependsOn;
+        for (size_t i = 0; i < stepAccesses[s].size(); ++i)
+        {
+            const Access& access = stepAccesses[s][i];
+            switch (access.m_type)
+            {
+                case MEMORY:
+                {//readers of an in-memory file take turns, files may cache things while being read
+                    map<AString, int>::iterator iter = lastAccess.find(access.m_name);
+                    if (iter != lastAccess.end()) dependsOn.insert(iter->second);
+                    lastAccess[access.m_name] = s;
+                    break;
+                }
+                case READ:
+                {
+                    map<AString, int>::iterator iter = lastWriter.find(access.m_name);
+                    if (iter != lastWriter.end()) dependsOn.insert(iter->second);
+                    readersSinceWrite[access.m_name].push_back(s);
+                    break;
+                }
+                case WRITE:
+                {
+                    map<AString, int>::iterator iter = lastWriter.find(access.m_name);
+                    if (iter != lastWriter.end()) dependsOn.insert(iter->second);
+                    vector<int>& readers = readersSinceWrite[access.m_name];
+                    dependsOn.insert(readers.begin(), readers.end());
+                    readers.clear();
+                    lastWriter[access.m_name] = s;
+                    break;
+                }
+            }
+        }
+        dependsOn.erase(s);
+        for (set<int>::iterator iter = dependsOn.begin(); iter != dependsOn.end(); ++iter)
+        {
+            ret[s] = max(ret[s], ret[*iter] + 1);
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,70 @@
+#ifndef __PIPELINE_SCRIPT_H__
+#define __PIPELINE_SCRIPT_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "AString.h"
+
+#include <string>
+#include <vector>
+
+namespace caret {
+
+    /// Splits -pipeline scripts into commands, and works out which commands can run at the same time.
+    class PipelineScript
+    {
+    public:
+        ///one command of the script, after removing quoting, comments, and line continuations
+        struct Command
+        {
+            int m_lineNumber;//line the command starts on
+            std::vector<AString> m_args;
+        };
+        
+        enum AccessType
+        {
+            READ,//reads a file on disk
+            WRITE,//writes a file on disk, or might
+            MEMORY//creates or reads an in-memory file
+        };
+        
+        ///one file a command uses
+        struct Access
+        {
+            AString m_name;//absolute path, or in-memory name
+            AccessType m_type;
+            Access(const AString& name, const AccessType type) : m_name(name), m_type(type) { }
+        };
+        
+        ///shell-like splitting: whitespace separates arguments, '...' is literal, "..." allows \" and \\, backslash escapes one character,
+        ///a backslash at the end of a line continues the command, and # at the start of an argument begins a comment
+        static std::vector<Command> tokenize(const std::string& text);
+        
+        ///how a string parameter uses the path it names: strings described as outputs write it, strings that look like filenames might write it
+        static AccessType stringAccessType(const AString& description, const AString& value);
+        
+        ///the wave each command runs in, every command only depends on commands in earlier waves
+        static std::vector<int> computeWaves(const std::vector<std::vector<Access> >& stepAccesses);
+    };
+    
+} // namespace
+
+#endif // __PIPELINE_SCRIPT_H__
@@ -36,6 +36,8 @@
 
 #include "Base64.h"
 
+#include <cstring>
+
 using namespace caret;
 
 //----------------------------------------------------------------------------
@@ -51,6 +53,24 @@ inline static unsigned char Base64EncodeChar(unsigned char c)
   return Base64EncodeTable[c];
 }
 
+//----------------------------------------------------------------------------
+namespace
+{
+    //the two output characters for every 12 bits of input, so a complete triplet takes two lookups
+    struct Base64PairTable
+    {
+        uint16_t pairs[4096];
+        Base64PairTable()
+        {
+            for (int i = 0; i < 4096; ++i)
+            {
+                const unsigned char chars[2] = { Base64EncodeTable[i >> 6], Base64EncodeTable[i & 0x3F] };
+                memcpy(pairs + i, chars, 2);
+            }
+        }
+    };
+}
+
 Base64::Base64() {}
 
 Base64::~Base64() {}
@@ -104,16 +124,19 @@ uint64_t Base64::encode(const unsigned char *input,
                              int32_t mark_end)
 {
   
+  static const Base64PairTable pairTable;
   const unsigned char *ptr = input;
   const unsigned char *end = input + length;
   unsigned char *optr = output;
 
-  // Encode complete triplet
+  // Encode complete triplets, 12 bits at a time
 
-  while ((end - ptr) >= 3)
+  const uint64_t numTriplets = length / 3;
+  for (uint64_t i = 0; i < numTriplets; ++i)
     {
-    Base64::EncodeTriplet(ptr[0], ptr[1], ptr[2], 
-                                      &optr[0], &optr[1], &optr[2], &optr[3]);
+    const uint32_t bits = (uint32_t(ptr[0]) << 16) | (uint32_t(ptr[1]) << 8) | uint32_t(ptr[2]);
+    memcpy(optr, pairTable.pairs + (bits >> 12), 2);
+    memcpy(optr + 2, pairTable.pairs + (bits & 0xFFF), 2);
     ptr += 3;
     optr += 4;
     }
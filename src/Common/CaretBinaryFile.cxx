@@ -28,6 +28,7 @@
 #include "CaretAssert.h"
 #include "CaretBinaryFile.h"
 #include "CaretLogger.h"
+#include "CaretTrace.h"
 #include "DataFileException.h"
 
 #include <QDir>
@@ -135,7 +136,15 @@ void CaretBinaryFile::read(void* dataOut, const int64_t& count, int64_t* numRead
 {
     CaretAssert(count >= 0);//not sure about allowing 0
     if (!getOpenForRead()) throw DataFileException("file is not open for reading");
+    CaretTraceSpan traceSpan("io", "read", 100);//many reads are small, only record the ones that take a while
     m_impl->read(dataOut, count, numRead);
+    if (traceSpan.isActive())
+    {
+        const int64_t bytesRead = (numRead != NULL ? *numRead : count);
+        CaretTrace::addBytesRead(bytesRead);
+        traceSpan.setBytes(bytesRead);
+        traceSpan.setDetail(m_impl->getFilename());
+    }
 }
 
 void CaretBinaryFile::seek(const int64_t& position)
@@ -161,7 +170,14 @@ void CaretBinaryFile::write(const void* dataIn, const int64_t& count)
 {
     CaretAssert(count >= 0);//not sure about allowing 0
     if (!getOpenForWrite()) throw DataFileException("file is not open for writing");
+    CaretTraceSpan traceSpan("io", "write", 100);
     m_impl->write(dataIn, count);
+    if (traceSpan.isActive())
+    {
+        CaretTrace::addBytesWritten(count);
+        traceSpan.setBytes(count);
+        traceSpan.setDetail(m_impl->getFilename());
+    }
 }
 
 #ifdef ZLIB_VERSION
@@ -0,0 +1,159 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CaretConnectedComponents.h"
+#include "CaretOMP.h"
+
+#include <algorithm>
+
+using namespace caret;
+using namespace std;
+
+int64_t CaretConnectedComponents::findRoot(int64_t index)
+{
+    CaretAssert(m_parent[index] != -1);
+    int64_t root = index;
+    while (m_parent[root] != root) root = m_parent[root];
+    while (m_parent[index] != root)//compress the path we walked, so later finds are short
+    {
+        int64_t next = m_parent[index];
+        m_parent[index] = root;
+        index = next;
+    }
+    return root;
+}
+
+int64_t CaretConnectedComponents::findRootConst(int64_t index) const
+{
+    CaretAssert(m_parent[index] != -1);
+    while (m_parent[index] != index) index = m_parent[index];
+    return index;
+}
+
+void CaretConnectedComponents::join(const int64_t a, const int64_t b)
+{
+    int64_t rootA = findRoot(a), rootB = findRoot(b);
+    if (rootA == rootB) return;
+    if (rootA < rootB)//keep the lowest index as the root, so compacting in index order gives flood fill numbering
+    {
+        m_parent[rootB] = rootA;
+    } else {
+        m_parent[rootA] = rootB;
+    }
+}
+
+void CaretConnectedComponents::labelSlab(const int64_t dims[3], const char* mask, const int64_t kStart, const int64_t kEnd)
+{//only looks at lower neighbors inside [kStart, kEnd), so slabs never touch each other's parent entries
+    const int64_t sliceSize = dims[0] * dims[1];
+    for (int64_t k = kStart; k < kEnd; ++k)
+    {
+        for (int64_t j = 0; j < dims[1]; ++j)
+        {
+            int64_t index = dims[0] * (j + dims[1] * k);
+            for (int64_t i = 0; i < dims[0]; ++i, ++index)
+            {
+                if (!mask[index])
+                {
+                    m_parent[index] = -1;
+                    continue;
+                }
+                m_parent[index] = index;
+                if (i > 0 && mask[index - 1]) join(index, index - 1);
+                if (j > 0 && mask[index - dims[0]]) join(index, index - dims[0]);
+                if (k > kStart && mask[index - sliceSize]) join(index, index - sliceSize);
+            }
+        }
+    }
+}
+
+int64_t CaretConnectedComponents::compact(vector<int64_t>& labelsOut)
+{
+    int64_t numElems = (int64_t)m_parent.size();
+    labelsOut.resize(numElems);
+#pragma omp CARET_PARFOR schedule(static) if (numElems > 100000)
+    for (int64_t i = 0; i < numElems; ++i)
+    {
+        labelsOut[i] = (m_parent[i] == -1 ? -1 : findRootConst(i));
+    }
+    int64_t numComponents = 0;
+    for (int64_t i = 0; i < numElems; ++i)
+    {//roots are the lowest index in their component, so the root is always renumbered before its other members
+        if (labelsOut[i] == -1) continue;
+        if (labelsOut[i] == i)
+        {
+            labelsOut[i] = numComponents;
+            ++numComponents;
+        } else {
+            labelsOut[i] = labelsOut[labelsOut[i]];
+        }
+    }
+    return numComponents;
+}
+
+int64_t CaretConnectedComponents::labelGraph(const int64_t* adjStart, const int32_t* adjNeighbors, const int64_t numNodes, const char* mask, vector<int64_t>& labelsOut)
+{
+    m_parent.resize(numNodes);
+    for (int64_t i = 0; i < numNodes; ++i)
+    {
+        m_parent[i] = (mask[i] ? i : -1);
+    }
+    for (int64_t i = 0; i < numNodes; ++i)
+    {
+        if (!mask[i]) continue;
+        for (int64_t n = adjStart[i]; n < adjStart[i + 1]; ++n)
+        {
+            int64_t neighbor = adjNeighbors[n];
+            if (neighbor < i && mask[neighbor]) join(i, neighbor);//each edge only needs to be joined once
+        }
+    }
+    return compact(labelsOut);
+}
+
+int64_t CaretConnectedComponents::labelVolume(const int64_t dims[3], const char* mask, vector<int64_t>& labelsOut)
+{
+    const int64_t sliceSize = dims[0] * dims[1];
+    m_parent.resize(sliceSize * dims[2]);
+    int64_t numSlabs = 1;
+#ifdef CARET_OMP
+    if (!omp_in_parallel())//when the caller is already parallel over frames, don't bother splitting
+    {
+        numSlabs = max((int64_t)1, min((int64_t)omp_get_max_threads(), dims[2]));
+    }
+#endif
+    vector<int64_t> slabStart(numSlabs + 1);
+    for (int64_t s = 0; s <= numSlabs; ++s)
+    {
+        slabStart[s] = dims[2] * s / numSlabs;
+    }
+#pragma omp CARET_PARFOR schedule(static, 1) if (numSlabs > 1)
+    for (int64_t s = 0; s < numSlabs; ++s)
+    {
+        labelSlab(dims, mask, slabStart[s], slabStart[s + 1]);
+    }
+    for (int64_t s = 1; s < numSlabs; ++s)
+    {//second pass: merge labels across the boundary planes between slabs
+        int64_t base = slabStart[s] * sliceSize;
+        for (int64_t i = 0; i < sliceSize; ++i)
+        {
+            if (mask[base + i] && mask[base - sliceSize + i]) join(base + i, base - sliceSize + i);
+        }
+    }
+    return compact(labelsOut);
+}
@@ -0,0 +1,79 @@
+#ifndef __CARET_CONNECTED_COMPONENTS_H__
+#define __CARET_CONNECTED_COMPONENTS_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CaretAssert.h"
+
+#include <vector>
+#include "stdint.h"
+
+namespace caret
+{
+    ///connected component labeling by union-find, for graphs given as compressed sparse row adjacency, and for 3D voxel grids
+    ///components are numbered from 0 in order of their lowest member index, so results match a flood fill seeded in index order
+    class CaretConnectedComponents
+    {
+        std::vector<int64_t> m_parent;//-1 for elements outside the mask, otherwise the root is always the lowest index in the set
+
+        int64_t findRoot(int64_t index);
+        int64_t findRootConst(int64_t index) const;
+        void join(const int64_t a, const int64_t b);
+        void labelSlab(const int64_t dims[3], const char* mask, const int64_t kStart, const int64_t kEnd);
+        int64_t compact(std::vector<int64_t>& labelsOut);
+    public:
+        ///label the masked nodes of a graph, adjStart has numNodes + 1 offsets into adjNeighbors
+        ///unmasked nodes get label -1, returns the number of components
+        int64_t labelGraph(const int64_t* adjStart, const int32_t* adjNeighbors, const int64_t numNodes, const char* mask, std::vector<int64_t>& labelsOut);
+
+        ///label the masked voxels of a frame with face (6-neighbor) connectivity, index is i + dims[0] * (j + dims[1] * k)
+        ///when called outside a parallel region, slabs of the frame are labeled in parallel and then merged across slab boundaries
+        int64_t labelVolume(const int64_t dims[3], const char* mask, std::vector<int64_t>& labelsOut);
+
+        ///gather the members of each component, in increasing index order
+        template <typename T>
+        static void getComponentMembers(const std::vector<int64_t>& labels, const int64_t numComponents, std::vector<std::vector<T> >& membersOut)
+        {
+            membersOut.clear();
+            membersOut.resize(numComponents);
+            std::vector<int64_t> counts(numComponents, 0);
+            int64_t numElems = (int64_t)labels.size();
+            for (int64_t i = 0; i < numElems; ++i)
+            {
+                if (labels[i] >= 0) ++counts[labels[i]];
+            }
+            for (int64_t i = 0; i < numComponents; ++i)
+            {
+                membersOut[i].reserve(counts[i]);
+            }
+            for (int64_t i = 0; i < numElems; ++i)
+            {
+                if (labels[i] >= 0)
+                {
+                    CaretAssert(labels[i] < numComponents);
+                    membersOut[labels[i]].push_back((T)i);
+                }
+            }
+        }
+    };
+}
+
+#endif //__CARET_CONNECTED_COMPONENTS_H__
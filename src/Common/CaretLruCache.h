@@ -0,0 +1,119 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#ifndef __CARET_LRU_CACHE_H__
+#define __CARET_LRU_CACHE_H__
+
+#include "CaretMutex.h"
+
+#include <list>
+#include <map>
+#include <stdint.h>
+#include <utility>
+
+namespace caret {
+    
+    ///thread-safe map that keeps only the most recently used entries, a maximum of 0 disables it
+    template <typename K, typename V>
+    class CaretLruCache
+    {
+        typedef std::list<std::pair<K, V> > EntryList;//most recently used first
+        EntryList m_entries;
+        std::map<K, typename EntryList::iterator> m_lookup;
+        int64_t m_maxEntries;
+        mutable CaretMutex m_mutex;
+        void trim()
+        {
+            while ((int64_t)m_entries.size() > m_maxEntries)
+            {
+                m_lookup.erase(m_entries.back().first);
+                m_entries.pop_back();
+            }
+        }
+    public:
+        CaretLruCache(const int64_t maxEntries = 0) { m_maxEntries = maxEntries; }
+        
+        bool isEnabled() const
+        {
+            CaretMutexLocker locked(&m_mutex);
+            return m_maxEntries > 0;
+        }
+        
+        void setMaximumEntries(const int64_t maxEntries)
+        {
+            CaretMutexLocker locked(&m_mutex);
+            m_maxEntries = maxEntries;
+            if (m_maxEntries < 0) m_maxEntries = 0;
+            trim();
+        }
+        
+        ///copies the value out and marks it as most recently used
+        bool find(const K& key, V& valueOut)
+        {
+            CaretMutexLocker locked(&m_mutex);
+            typename std::map<K, typename EntryList::iterator>::iterator iter = m_lookup.find(key);
+            if (iter == m_lookup.end()) return false;
+            m_entries.splice(m_entries.begin(), m_entries, iter->second);//splice doesn't invalidate the stored iterator
+            valueOut = iter->second->second;
+            return true;
+        }
+        
+        ///replaces any existing value for the key, and drops the least recently used entries if over the limit
+        void insert(const K& key, const V& value)
+        {
+            CaretMutexLocker locked(&m_mutex);
+            if (m_maxEntries <= 0) return;
+            typename std::map<K, typename EntryList::iterator>::iterator iter = m_lookup.find(key);
+            if (iter != m_lookup.end())
+            {
+                m_entries.erase(iter->second);
+                m_lookup.erase(iter);
+            }
+            m_entries.push_front(std::make_pair(key, value));
+            m_lookup[key] = m_entries.begin();
+            trim();
+        }
+        
+        void remove(const K& key)
+        {
+            CaretMutexLocker locked(&m_mutex);
+            typename std::map<K, typename EntryList::iterator>::iterator iter = m_lookup.find(key);
+            if (iter == m_lookup.end()) return;
+            m_entries.erase(iter->second);
+            m_lookup.erase(iter);
+        }
+        
+        void clear()
+        {
+            CaretMutexLocker locked(&m_mutex);
+            m_entries.clear();
+            m_lookup.clear();
+        }
+        
+        int64_t size() const
+        {
+            CaretMutexLocker locked(&m_mutex);
+            return (int64_t)m_entries.size();
+        }
+    };
+    
+}
+
+#endif //__CARET_LRU_CACHE_H__
@@ -22,7 +22,9 @@
 #include "CaretException.h"
 #include "CaretLogger.h"
 #include "CaretMathExpression.h"
+#include "CaretOMP.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace caret;
@@ -39,14 +41,376 @@ CaretMathExpression::CaretMathExpression(const AString& expression)
         throw CaretException("extra characters on end of expression: '" + m_input.mid(m_position) + "'");
     }
     CaretLogFiner("parsed '" + expression + "' as '" + toString() + "'");
+    m_numSlots = 0;
+    compileNode(m_root);
 }
 
+const int64_t CaretMathExpression::BLOCK_SIZE = 1024;//small enough that the slots for a typical expression stay in cache
+
 double CaretMathExpression::evaluate(const vector<float>& variableValues) const
 {
     CaretAssert(variableValues.size() == m_varNames.size());
     return m_root->eval(variableValues);
 }
 
+void CaretMathExpression::evaluate(const vector<const float*>& variableArrays, const int64_t& numElements, float* resultsOut) const
+{
+    CaretAssert(variableArrays.size() == m_varNames.size());
+    CaretAssert(!m_program.empty());
+    if (numElements <= 0) return;
+    const int rootSlot = m_program.back().m_outputSlot;
+    const int64_t numBlocks = (numElements - 1) / BLOCK_SIZE + 1;
+#pragma omp CARET_PAR if (numBlocks > 1)
+    {
+        vector<double> slots(m_numSlots * BLOCK_SIZE);//each thread needs its own scratch space
+#pragma omp CARET_FOR schedule(dynamic)
+        for (int64_t block = 0; block < numBlocks; ++block)
+        {
+            const int64_t start = block * BLOCK_SIZE;
+            const int64_t count = min(BLOCK_SIZE, numElements - start);
+            for (int i = 0; i < (int)m_program.size(); ++i)
+            {
+                evaluateInstruction(m_program[i], variableArrays, start, count, slots.data());
+            }
+            const double* result = slots.data() + rootSlot * BLOCK_SIZE;
+            float* output = resultsOut + start;
+            for (int64_t i = 0; i < count; ++i)
+            {
+                output[i] = (float)result[i];
+            }
+        }
+    }
+}
+
+int CaretMathExpression::compileNode(const MathNode* node)
+{//postfix order, so that the arguments of an instruction are always computed before it
+    if (node->m_type == MathNode::INVALID || (node->m_type == MathNode::FUNC && node->m_function == MathFunctionEnum::INVALID))
+    {
+        throw CaretException("parsing problem in CaretMathExpression");
+    }
+    Instruction myInstruction;
+    myInstruction.m_node = node;
+    for (int i = 0; i < (int)node->m_arguments.size(); ++i)
+    {
+        myInstruction.m_argumentSlots.push_back(compileNode(node->m_arguments[i]));
+    }
+    myInstruction.m_outputSlot = m_numSlots;
+    ++m_numSlots;
+    m_program.push_back(myInstruction);
+    return myInstruction.m_outputSlot;
+}
+
+void CaretMathExpression::evaluateInstruction(const Instruction& instruction, const vector<const float*>& variableArrays,
+                                              const int64_t& start, const int64_t& count, double* slots) const
+{//must give the same results as MathNode::eval(), loops are kept simple so that the compiler can vectorize them
+    const MathNode* node = instruction.m_node;
+    double* ret = slots + instruction.m_outputSlot * BLOCK_SIZE;
+    const int numArgs = (int)instruction.m_argumentSlots.size();
+    vector<const double*> args(numArgs);
+    for (int i = 0; i < numArgs; ++i)
+    {
+        args[i] = slots + instruction.m_argumentSlots[i] * BLOCK_SIZE;
+    }
+    switch (node->m_type)
+    {
+        case MathNode::OR:
+        {
+            CaretAssert(numArgs > 1);
+            for (int64_t j = 0; j < count; ++j) ret[j] = (args[0][j] > 0.0) ? 1.0 : 0.0;
+            for (int i = 1; i < numArgs; ++i)
+            {//no lazy evaluation here, but the arguments have no side effects, so the result is the same
+                const double* arg = args[i];
+                for (int64_t j = 0; j < count; ++j) ret[j] = (ret[j] > 0.0 || arg[j] > 0.0) ? 1.0 : 0.0;
+            }
+            break;
+        }
+        case MathNode::AND:
+        {
+            CaretAssert(numArgs > 1);
+            for (int64_t j = 0; j < count; ++j) ret[j] = (args[0][j] > 0.0) ? 1.0 : 0.0;
+            for (int i = 1; i < numArgs; ++i)
+            {
+                const double* arg = args[i];
+                for (int64_t j = 0; j < count; ++j) ret[j] = (ret[j] > 0.0 && arg[j] > 0.0) ? 1.0 : 0.0;
+            }
+            break;
+        }
+        case MathNode::EQUAL:
+        {
+            CaretAssert(numArgs > 1);
+            CaretAssert((int)node->m_invert.size() == numArgs);
+            for (int64_t j = 0; j < count; ++j) ret[j] = args[0][j];
+            for (int i = 1; i < numArgs; ++i)
+            {
+                const double* arg = args[i];
+                const double equalVal = node->m_invert[i] ? 0.0 : 1.0, notEqualVal = node->m_invert[i] ? 1.0 : 0.0;
+                for (int64_t j = 0; j < count; ++j)
+                {
+                    float adjust = min(abs(ret[j]), abs(arg[j])) / 1000000;//same fudge factor as MathNode::eval()
+                    ret[j] = ((ret[j] >= arg[j] - adjust) && (ret[j] <= arg[j] + adjust)) ? equalVal : notEqualVal;
+                }
+            }
+            break;
+        }
+        case MathNode::GREATERLESS:
+        {
+            CaretAssert(numArgs > 1);
+            CaretAssert((int)node->m_invert.size() == numArgs);
+            CaretAssert((int)node->m_inclusive.size() == numArgs);
+            for (int64_t j = 0; j < count; ++j) ret[j] = args[0][j];
+            for (int i = 1; i < numArgs; ++i)
+            {
+                const double* arg = args[i];
+                if (node->m_inclusive[i])
+                {
+                    if (node->m_invert[i])
+                    {
+                        for (int64_t j = 0; j < count; ++j)
+                        {
+                            float adjust = min(abs(ret[j]), abs(arg[j])) / 1000000;
+                            ret[j] = (ret[j] <= arg[j] + adjust ? 1.0 : 0.0);
+                        }
+                    } else {
+                        for (int64_t j = 0; j < count; ++j)
+                        {
+                            float adjust = min(abs(ret[j]), abs(arg[j])) / 1000000;
+                            ret[j] = (ret[j] >= arg[j] - adjust ? 1.0 : 0.0);
+                        }
+                    }
+                } else {
+                    if (node->m_invert[i])
+                    {
+                        for (int64_t j = 0; j < count; ++j) ret[j] = (ret[j] < arg[j] ? 1.0 : 0.0);
+                    } else {
+                        for (int64_t j = 0; j < count; ++j) ret[j] = (ret[j] > arg[j] ? 1.0 : 0.0);
+                    }
+                }
+            }
+            break;
+        }
+        case MathNode::ADDSUB:
+        {
+            CaretAssert(numArgs > 1);
+            CaretAssert((int)node->m_invert.size() == numArgs);
+            for (int64_t j = 0; j < count; ++j) ret[j] = args[0][j];
+            for (int i = 1; i < numArgs; ++i)
+            {
+                const double* arg = args[i];
+                if (node->m_invert[i])
+                {
+                    for (int64_t j = 0; j < count; ++j) ret[j] -= arg[j];
+                } else {
+                    for (int64_t j = 0; j < count; ++j) ret[j] += arg[j];
+                }
+            }
+            break;
+        }
+        case MathNode::MULTDIV:
+        {
+            CaretAssert(numArgs > 1);
+            CaretAssert((int)node->m_invert.size() == numArgs);
+            for (int64_t j = 0; j < count; ++j) ret[j] = args[0][j];
+            for (int i = 1; i < numArgs; ++i)
+            {
+                const double* arg = args[i];
+                if (node->m_invert[i])
+                {
+                    for (int64_t j = 0; j < count; ++j) ret[j] /= arg[j];
+                } else {
+                    for (int64_t j = 0; j < count; ++j) ret[j] *= arg[j];
+                }
+            }
+            break;
+        }
+        case MathNode::NOT:
+            CaretAssert(numArgs == 1);
+            for (int64_t j = 0; j < count; ++j) ret[j] = (args[0][j] > 0.0) ? 0.0 : 1.0;
+            break;
+        case MathNode::NEGATE:
+            CaretAssert(numArgs == 1);
+            for (int64_t j = 0; j < count; ++j) ret[j] = -args[0][j];
+            break;
+        case MathNode::POW:
+            CaretAssert(numArgs == 2);
+            for (int64_t j = 0; j < count; ++j) ret[j] = pow(args[0][j], args[1][j]);
+            break;
+        case MathNode::FUNC:
+        {
+            const double* arg = args[0];
+            switch (node->m_function)
+            {
+                case MathFunctionEnum::SIN:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = sin(arg[j]);
+                    break;
+                case MathFunctionEnum::COS:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = cos(arg[j]);
+                    break;
+                case MathFunctionEnum::TAN:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = tan(arg[j]);
+                    break;
+                case MathFunctionEnum::ASIN:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = asin(arg[j]);
+                    break;
+                case MathFunctionEnum::ACOS:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = acos(arg[j]);
+                    break;
+                case MathFunctionEnum::ATAN:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = atan(arg[j]);
+                    break;
+                case MathFunctionEnum::SINH:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = sinh(arg[j]);
+                    break;
+                case MathFunctionEnum::COSH:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = cosh(arg[j]);
+                    break;
+                case MathFunctionEnum::TANH:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = tanh(arg[j]);
+                    break;
+                case MathFunctionEnum::ASINH:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j)
+                    {
+                        if (arg[j] > 0)
+                        {
+                            ret[j] = log(arg[j] + sqrt(arg[j] * arg[j] + 1));
+                        } else {
+                            ret[j] = -log(-arg[j] + sqrt(arg[j] * arg[j] + 1));
+                        }
+                    }
+                    break;
+                case MathFunctionEnum::ACOSH:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = log(arg[j] + sqrt(arg[j] * arg[j] - 1));
+                    break;
+                case MathFunctionEnum::ATANH:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = 0.5 * log((1 + arg[j]) / (1 - arg[j]));
+                    break;
+                case MathFunctionEnum::SINC:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j)
+                    {
+                        if (arg[j] == 0.0)
+                        {
+                            ret[j] = 1.0;
+                        } else {
+                            ret[j] = sin(arg[j]) / arg[j];
+                        }
+                    }
+                    break;
+                case MathFunctionEnum::LN:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = log(arg[j]);
+                    break;
+                case MathFunctionEnum::EXP:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = exp(arg[j]);
+                    break;
+                case MathFunctionEnum::LOG:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = log10(arg[j]);
+                    break;
+                case MathFunctionEnum::LOG2:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = log2(arg[j]);
+                    break;
+                case MathFunctionEnum::SQRT:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = sqrt(arg[j]);
+                    break;
+                case MathFunctionEnum::ABS:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = abs(arg[j]);
+                    break;
+                case MathFunctionEnum::FLOOR:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = floor(arg[j]);
+                    break;
+                case MathFunctionEnum::ROUND:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j)
+                    {
+                        if (arg[j] > 0.0)
+                        {
+                            ret[j] = floor(arg[j] + 0.5);
+                        } else {
+                            ret[j] = ceil(arg[j] - 0.5);
+                        }
+                    }
+                    break;
+                case MathFunctionEnum::CEIL:
+                    CaretAssert(numArgs == 1);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = ceil(arg[j]);
+                    break;
+                case MathFunctionEnum::ATAN2:
+                    CaretAssert(numArgs == 2);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = atan2(arg[j], args[1][j]);
+                    break;
+                case MathFunctionEnum::MIN:
+                    CaretAssert(numArgs == 2);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = (arg[j] > args[1][j]) ? args[1][j] : arg[j];
+                    break;
+                case MathFunctionEnum::MAX:
+                    CaretAssert(numArgs == 2);
+                    for (int64_t j = 0; j < count; ++j) ret[j] = (arg[j] < args[1][j]) ? args[1][j] : arg[j];
+                    break;
+                case MathFunctionEnum::MOD:
+                    CaretAssert(numArgs == 2);
+                    for (int64_t j = 0; j < count; ++j)
+                    {
+                        const double second = args[1][j];
+                        if (second == 0.0)
+                        {
+                            ret[j] = 0.0;
+                        } else {
+                            ret[j] = arg[j] - second * floor(arg[j] / second);
+                        }
+                    }
+                    break;
+                case MathFunctionEnum::CLAMP:
+                    CaretAssert(numArgs == 3);
+                    for (int64_t j = 0; j < count; ++j)
+                    {
+                        double temp = arg[j];
+                        if (temp < args[1][j]) temp = args[1][j];
+                        if (temp > args[2][j]) temp = args[2][j];
+                        ret[j] = temp;
+                    }
+                    break;
+                case MathFunctionEnum::INVALID:
+                    CaretAssertMessage(0, "MathNode is type FUNC but INVALID function");//checked in compileNode, can't throw from inside openmp
+                    break;
+            }
+            break;
+        }
+        case MathNode::VAR:
+        {
+            CaretAssertVectorIndex(variableArrays, node->m_varIndex);
+            const float* input = variableArrays[node->m_varIndex] + start;
+            for (int64_t j = 0; j < count; ++j) ret[j] = input[j];
+            break;
+        }
+        case MathNode::CONST:
+        {
+            const double value = node->m_constVal;
+            for (int64_t j = 0; j < count; ++j) ret[j] = value;
+            break;
+        }
+        case MathNode::INVALID:
+            CaretAssertMessage(0, "parsing left INVALID MathNode");
+            break;
+    }
+}
+
 vector<AString> CaretMathExpression::getVarNames() const
 {
     vector<AString> ret(m_varNames.size());
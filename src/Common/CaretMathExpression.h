@@ -63,10 +63,22 @@ class CaretMathExpression
         double eval(const std::vector<float>& values) const;
         AString toString(const std::vector<AString>& varNames, bool addParens = true) const;
     };
+    struct Instruction
+    {//one node of the expression, evaluated for a block of elements at once, arguments are evaluated by earlier instructions
+        const MathNode* m_node;
+        int m_outputSlot;
+        std::vector<int> m_argumentSlots;
+    };
     std::map<AString, int> m_varNames;
     AString m_input;
     int m_position, m_end;
     CaretPointer<MathNode> m_root;
+    std::vector<Instruction> m_program;//nodes in postfix order, for evaluating arrays
+    int m_numSlots;
+    static const int64_t BLOCK_SIZE;
+    int compileNode(const MathNode* node);
+    void evaluateInstruction(const Instruction& instruction, const std::vector<const float*>& variableArrays,
+                             const int64_t& start, const int64_t& count, double* slots) const;
     bool skipWhitespace();
     bool accept(const char& c);
     void expect(const char& c, const int& exprStart);
@@ -87,6 +99,7 @@ public:
     static bool getNamedConstant(const AString& name, double& valueOut);
     CaretMathExpression(const AString& expression);
     double evaluate(const std::vector<float>& variableValues) const;
+    void evaluate(const std::vector<const float*>& variableArrays, const int64_t& numElements, float* resultsOut) const;//evaluates every element of the arrays, multithreaded
     std::vector<AString> getVarNames() const;
     AString toString() const;//the expression, with a lot of parentheses added
 };
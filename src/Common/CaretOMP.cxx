@@ -0,0 +1,55 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CaretOMP.h"
+
+#include "CaretLogger.h"
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    int s_defaultThreads = -1;//what openmp would have used, before any call to setNumThreads
+}
+
+void CaretOMP::setNumThreads(const int& numThreads)
+{
+#ifdef CARET_OMP
+    if (s_defaultThreads < 0) s_defaultThreads = omp_get_max_threads();
+    if (numThreads > 0)
+    {
+        omp_set_num_threads(numThreads);
+    } else {
+        omp_set_num_threads(s_defaultThreads);
+    }
+#else
+    if (numThreads > 1) CaretLogInfo("this build does not use OpenMP, ignoring thread count");
+#endif
+}
+
+int CaretOMP::getMaxThreads()
+{
+#ifdef CARET_OMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
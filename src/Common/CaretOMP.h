@@ -48,4 +48,76 @@
 #define CARET_PARFOR parallel for CARET_PAR_OPTIONS CARET_FOR_OPTIONS
 #define CARET_SINGLE single CARET_SINGLE_OPTIONS
 
+#ifdef __cplusplus
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdint.h>
+#include <utility>
+
+namespace caret
+{
+    ///runtime control of the openmp thread team, for global options, and helpers for NUMA-friendly allocation
+    ///thread binding is in CaretOMPBinding.h, to keep this header free of Qt
+    class CaretOMP
+    {
+        CaretOMP();
+    public:
+        ///buffers smaller than this are initialized by the calling thread, they fit in a few pages anyway
+        static const int64_t FIRST_TOUCH_MIN_BYTES = 4 * 1024 * 1024;
+        
+        ///set the number of threads for parallel regions, 0 restores the default (OMP_NUM_THREADS or number of cores)
+        static void setNumThreads(const int& numThreads);
+        static int getMaxThreads();
+        
+        ///initialize a large array with a static schedule, so each page is first touched (and placed) by the thread that will later use that range
+        template<typename T>
+        static void firstTouch(T* data, const int64_t& count, const T& value = T());
+    };
+    
+    ///allocator that leaves new elements default-initialized instead of zeroed, so that resize() doesn't touch every page on the calling thread
+    ///use with CaretOMP::firstTouch() on the new range, see VolumeBase, MultiDimArray and GiftiDataArray
+    template<typename T>
+    struct CaretFirstTouchAllocator
+    {
+        typedef T value_type;
+        CaretFirstTouchAllocator() { }
+        template<typename U>
+        CaretFirstTouchAllocator(const CaretFirstTouchAllocator<U>&) { }
+        T* allocate(const std::size_t n) { return std::allocator<T>().allocate(n); }
+        void deallocate(T* p, const std::size_t n) { std::allocator<T>().deallocate(p, n); }
+        template<typename U>
+        void construct(U* p) { ::new((void*)p) U; }
+        template<typename U, typename... Args>
+        void construct(U* p, Args&&... args) { ::new((void*)p) U(std::forward<Args>(args)...); }
+        template<typename U>
+        bool operator==(const CaretFirstTouchAllocator<U>&) const { return true; }
+        template<typename U>
+        bool operator!=(const CaretFirstTouchAllocator<U>&) const { return false; }
+    };
+    
+    template<typename T>
+    void CaretOMP::firstTouch(T* data, const int64_t& count, const T& value)
+    {
+#ifdef CARET_OMP
+        if (count * (int64_t)sizeof(T) >= FIRST_TOUCH_MIN_BYTES && !omp_in_parallel() && omp_get_max_threads() > 1)
+        {
+#pragma omp CARET_PARFOR schedule(static)
+            for (int64_t i = 0; i < count; ++i)
+            {
+                data[i] = value;
+            }
+            return;
+        }
+#endif
+        for (int64_t i = 0; i < count; ++i)
+        {
+            data[i] = value;
+        }
+    }
+}
+
+#endif //__cplusplus
+
 #endif //__CARET_OMP_H__
@@ -0,0 +1,233 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CaretOMPBinding.h"
+
+#include "CaretAssert.h"
+#include "CaretLogger.h"
+#include "CaretOMP.h"
+
+#include <QDir>
+#include <QFile>
+#include <QStringList>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    CaretOMPBinding::BindPolicy s_bindPolicy = CaretOMPBinding::BIND_NONE;
+    
+#ifdef __linux__
+    //the cpus the process was started with, so that rebinding (or unbinding) can't shrink the set
+    bool s_haveAllowed = false;
+    cpu_set_t s_allowed;
+    
+    const cpu_set_t& getAllowedCpus()
+    {
+        if (!s_haveAllowed)
+        {
+            CPU_ZERO(&s_allowed);
+            if (sched_getaffinity(0, sizeof(cpu_set_t), &s_allowed) != 0)
+            {
+                for (int i = 0; i < CPU_SETSIZE; ++i) CPU_SET(i, &s_allowed);
+            }
+            s_haveAllowed = true;
+        }
+        return s_allowed;
+    }
+    
+    //parse a sysfs cpu list like "0-7,16-23"
+    bool parseCpuList(const QString& text, cpu_set_t& setOut)
+    {
+        CPU_ZERO(&setOut);
+        QStringList ranges = text.trimmed().split(',');
+        for (int i = 0; i < ranges.size(); ++i)
+        {
+            if (ranges[i].isEmpty()) continue;
+            QStringList ends = ranges[i].split('-');
+            bool ok1 = false, ok2 = true;
+            int first = ends[0].toInt(&ok1), last = first;
+            if (ends.size() > 1) last = ends[1].toInt(&ok2);
+            if (!ok1 || !ok2 || ends.size() > 2 || first < 0 || last < first) return false;
+            for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu)
+            {
+                CPU_SET(cpu, &setOut);
+            }
+        }
+        return true;
+    }
+    
+    //cpus of each NUMA node that this process is allowed to use, nodes without any are skipped
+    vector<cpu_set_t> getNodeCpus()
+    {
+        vector<cpu_set_t> ret;
+        const cpu_set_t& allowed = getAllowedCpus();
+        QDir nodeDir("/sys/devices/system/node");
+        QStringList nodeNames = nodeDir.entryList(QStringList() << "node[0-9]*", QDir::Dirs);
+        for (int i = 0; i < nodeNames.size(); ++i)
+        {
+            QFile listFile(nodeDir.filePath(nodeNames[i] + "/cpulist"));
+            if (!listFile.open(QIODevice::ReadOnly)) continue;
+            cpu_set_t nodeSet;
+            if (!parseCpuList(QString::fromLatin1(listFile.readAll()), nodeSet)) continue;
+            CPU_AND(&nodeSet, &nodeSet, &allowed);
+            if (CPU_COUNT(&nodeSet) > 0) ret.push_back(nodeSet);
+        }
+        return ret;
+    }
+    
+    //the nodes threads are bound to, empty when threads aren't bound, only modified by setBindPolicy
+    vector<cpu_set_t> s_nodeCpus;
+    vector<int> s_closeThreadNode;//for BIND_CLOSE, each node gets as many consecutive threads as it has cpus
+    
+    const cpu_set_t& getThreadMask(const int thread)
+    {
+        if (s_nodeCpus.empty()) return getAllowedCpus();
+        switch (s_bindPolicy)
+        {
+            case CaretOMPBinding::BIND_NONE:
+                break;
+            case CaretOMPBinding::BIND_CLOSE:
+                return s_nodeCpus[s_closeThreadNode[thread % s_closeThreadNode.size()]];
+            case CaretOMPBinding::BIND_SPREAD:
+                return s_nodeCpus[thread % s_nodeCpus.size()];
+        }
+        return getAllowedCpus();
+    }
+#endif
+}
+
+int CaretOMPBinding::getNumNumaNodes()
+{
+#ifdef __linux__
+    int ret = (int)getNodeCpus().size();
+    if (ret > 0) return ret;
+#endif
+    return 1;
+}
+
+bool CaretOMPBinding::setBindPolicy(const BindPolicy& policy)
+{
+#if defined(CARET_OMP) && defined(__linux__)
+    vector<cpu_set_t> nodeCpus = getNodeCpus();
+    s_bindPolicy = policy;
+    s_nodeCpus.clear();
+    s_closeThreadNode.clear();
+    if (policy != BIND_NONE && nodeCpus.size() < 2)
+    {
+        CaretLogInfo("only one NUMA node available, thread binding has no effect");
+        return true;
+    }
+    //NOTE: new threads (including ones openmp creates for a larger team) inherit the mask of the creating thread, which
+    //after binding is the first node, so call this again whenever the number of threads changes
+    //task pool workers are created later and call bindCurrentThread() themselves
+    if (policy != BIND_NONE)
+    {
+        s_nodeCpus = nodeCpus;
+        for (int node = 0; node < (int)nodeCpus.size(); ++node)
+        {
+            for (int i = 0; i < CPU_COUNT(&nodeCpus[node]); ++i) s_closeThreadNode.push_back(node);
+        }
+    }
+    bool failed = false;
+#pragma omp CARET_PAR
+    {
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &getThreadMask(omp_get_thread_num())) != 0)
+        {
+#pragma omp critical
+            failed = true;
+        }
+    }
+    if (failed)
+    {
+        CaretLogWarning("failed to set thread affinity for some threads");
+        return false;
+    }
+    CaretLogInfo("bound " + AString::number(CaretOMP::getMaxThreads()) + " threads to " + AString::number(nodeCpus.size()) + " NUMA nodes, policy " + bindPolicyToString(policy));
+    return true;
+#else
+    s_bindPolicy = policy;
+    if (policy == BIND_NONE) return true;
+    CaretLogWarning("thread binding is not supported on this platform or build, use OMP_PROC_BIND and OMP_PLACES instead");
+    return false;
+#endif
+}
+
+bool CaretOMPBinding::bindCurrentThread(const int& teamThreadIndex)
+{
+#if defined(CARET_OMP) && defined(__linux__)
+    if (s_nodeCpus.empty()) return true;//not bound, the inherited mask is already right
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &getThreadMask(teamThreadIndex)) == 0;
+#else
+    (void)teamThreadIndex;
+    return true;
+#endif
+}
+
+CaretOMPBinding::BindPolicy CaretOMPBinding::getBindPolicy()
+{
+    return s_bindPolicy;
+}
+
+CaretOMPBinding::BindPolicy CaretOMPBinding::stringToBindPolicy(const AString& name, bool* ok)
+{
+    BindPolicy ret = BIND_NONE;
+    bool valid = true;
+    if (name == "NONE")
+    {
+        ret = BIND_NONE;
+    } else if (name == "CLOSE") {
+        ret = BIND_CLOSE;
+    } else if (name == "SPREAD") {
+        ret = BIND_SPREAD;
+    } else {
+        valid = false;
+    }
+    if (ok == NULL)
+    {
+        CaretAssert(valid);
+    } else {
+        *ok = valid;
+    }
+    return ret;
+}
+
+AString CaretOMPBinding::bindPolicyToString(const BindPolicy& policy)
+{
+    switch (policy)
+    {
+        case BIND_NONE:
+            return "NONE";
+        case BIND_CLOSE:
+            return "CLOSE";
+        case BIND_SPREAD:
+            return "SPREAD";
+    }
+    CaretAssert(false);
+    return "";
+}
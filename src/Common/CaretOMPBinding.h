@@ -0,0 +1,52 @@
+#ifndef __CARET_OMP_BINDING_H__
+#define __CARET_OMP_BINDING_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "AString.h"
+
+namespace caret
+{
+    ///binding of the openmp thread team to NUMA nodes, for the -thread-binding global option
+    class CaretOMPBinding
+    {
+        CaretOMPBinding();
+    public:
+        enum BindPolicy
+        {
+            BIND_NONE,//leave thread placement to the OS (or to OMP_PROC_BIND)
+            BIND_CLOSE,//fill one NUMA node before using the next
+            BIND_SPREAD//alternate NUMA nodes, so that memory bandwidth of all nodes is used at low thread counts
+        };
+        
+        ///bind each thread of the team to the cpus of one NUMA node, call again after changing the number of threads
+        static bool setBindPolicy(const BindPolicy& policy);
+        ///bind a thread created outside of the openmp team (such as a task pool worker) as if it were the given thread of the team,
+        ///threads inherit the mask of the thread that creates them, which after binding is a single NUMA node
+        static bool bindCurrentThread(const int& teamThreadIndex);
+        static BindPolicy getBindPolicy();
+        static int getNumNumaNodes();
+        static BindPolicy stringToBindPolicy(const AString& name, bool* ok = NULL);
+        static AString bindPolicyToString(const BindPolicy& policy);
+    };
+}
+
+#endif //__CARET_OMP_BINDING_H__
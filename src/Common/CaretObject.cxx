@@ -25,10 +25,22 @@
 #include "CaretObject.h"
 #undef __CARET_OBJECT_DECLARE_H__
 
+#include "CaretMutex.h"
 #include "SystemUtilities.h"
 
 using namespace caret;
 
+#ifndef NDEBUG
+namespace
+{//objects are also created on task pool and openmp threads, never deleted so that objects destroyed during static destruction can still use it
+    CaretMutex& getTrackerMutex()
+    {
+        static CaretMutex* theMutex = new CaretMutex();
+        return *theMutex;
+    }
+}
+#endif
+
 /**
  * Constructor.
  *
@@ -58,6 +70,7 @@ CaretObject::~CaretObject()
      * Erase returns the number of objects deleted.
      * If zero, then the object has already been deleted.
      */
+    CaretMutexLocker locked(&getTrackerMutex());
     uint64_t numDeleted = CaretObject::allocatedObjects.erase(this);
     if (numDeleted <= 0) {
         std::cerr << "Destructor for a CaretObject called but the object is not allocated "
@@ -81,6 +94,7 @@ CaretObject::initializeMembersCaretObject()
 #ifndef NDEBUG
     SystemBacktrace myBacktrace;
     SystemUtilities::getBackTrace(myBacktrace);
+    CaretMutexLocker locked(&getTrackerMutex());
     CaretObject::allocatedObjects.insert(
                std::make_pair(this,
                               myBacktrace));
@@ -0,0 +1,238 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CaretTaskPool.h"
+
+#include "CaretAssert.h"
+#include "CaretOMP.h"
+#include "CaretOMPBinding.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+struct CaretTaskGroup::State
+{
+    atomic<int> m_pending;
+    atomic<int> m_submitted;//how many tasks this group may run at once, for dividing the openmp threads
+    int m_expected;
+    mutex m_errorMutex;
+    exception_ptr m_error;
+    State(const int& expected) : m_pending(0), m_submitted(0), m_expected(expected) { }
+};
+
+namespace
+{
+    struct Task
+    {
+        function<void()> m_func;
+        shared_ptr<CaretTaskGroup::State> m_group;
+    };
+    
+    struct TaskQueue
+    {//owner pushes and pops at the back, thieves take from the front, where the oldest (usually largest) tasks are
+        mutex m_mutex;
+        deque<Task> m_tasks;
+    };
+    
+    thread_local int t_workerIndex = -1;//-1 for threads that aren't pool workers
+    
+    class TaskPool
+    {
+        int m_numWorkers, m_ompThreads;
+        vector<TaskQueue> m_queues;//one per worker, plus one at the end for tasks from other threads
+        atomic<int> m_queued;
+        mutex m_sleepMutex;
+        condition_variable m_sleepCond;
+        
+        TaskQueue& injectQueue() { return m_queues[m_numWorkers]; }
+        
+        bool popTask(const int& self, Task& taskOut)
+        {
+            if (m_queued.load() == 0) return false;
+            if (self >= 0)
+            {
+                TaskQueue& mine = m_queues[self];
+                lock_guard<mutex> locked(mine.m_mutex);
+                if (!mine.m_tasks.empty())
+                {
+                    taskOut = std::move(mine.m_tasks.back());
+                    mine.m_tasks.pop_back();
+                    --m_queued;
+                    return true;
+                }
+            }
+            const int numQueues = (int)m_queues.size();
+            const int start = (self >= 0 ? self + 1 : m_numWorkers);//other threads check the inject queue first, workers steal from the next one over, so thieves don't all pick on worker 0
+            for (int i = 0; i < numQueues; ++i)
+            {
+                const int which = (start + i) % numQueues;
+                if (which == self) continue;
+                TaskQueue& other = m_queues[which];
+                lock_guard<mutex> locked(other.m_mutex);
+                if (!other.m_tasks.empty())
+                {
+                    taskOut = std::move(other.m_tasks.front());
+                    other.m_tasks.pop_front();
+                    --m_queued;
+                    return true;
+                }
+            }
+            return false;
+        }
+        
+        void execute(Task& task)
+        {
+            CaretTaskGroup::State& group = *(task.m_group);
+#ifdef CARET_OMP
+            const int oldThreads = omp_get_max_threads();
+            const int concurrent = max(1, min(max(group.m_submitted.load(), group.m_expected), m_numWorkers + 1));
+            omp_set_num_threads(max(1, m_ompThreads / concurrent));
+#endif
+            try
+            {
+                task.m_func();
+            } catch (...) {
+                lock_guard<mutex> locked(group.m_errorMutex);
+                if (!group.m_error) group.m_error = current_exception();
+            }
+#ifdef CARET_OMP
+            omp_set_num_threads(oldThreads);
+#endif
+            shared_ptr<CaretTaskGroup::State> keepAlive = task.m_group;
+            task = Task();//release captured objects before the waiter can return
+            if (--(keepAlive->m_pending) == 0)
+            {
+                lock_guard<mutex> locked(m_sleepMutex);//so the waiter can't miss the notify between its check and its wait
+                m_sleepCond.notify_all();
+            }
+        }
+        
+        void workerLoop(const int index)
+        {
+            t_workerIndex = index;
+            CaretOMPBinding::bindCurrentThread(index + 1);//the waiting thread is usually thread 0 of the team, otherwise workers would inherit its single NUMA node
+            Task task;
+            while (true)
+            {
+                if (popTask(index, task))
+                {
+                    execute(task);
+                    continue;
+                }
+                unique_lock<mutex> locked(m_sleepMutex);
+                m_sleepCond.wait(locked, [this]() { return m_queued.load() > 0; });
+            }
+        }
+        
+    public:
+        TaskPool(const int& numThreads) : m_numWorkers(numThreads - 1), m_ompThreads(numThreads), m_queues(numThreads), m_queued(0)
+        {//the waiting thread does work too, so one fewer worker
+            for (int i = 0; i < m_numWorkers; ++i)
+            {
+                thread(&TaskPool::workerLoop, this, i).detach();//workers sleep when idle, and the pool lives until exit
+            }
+        }
+        
+        int getNumThreads() const { return m_numWorkers + 1; }
+        
+        void submit(const function<void()>& func, const shared_ptr<CaretTaskGroup::State>& group)
+        {
+            ++(group->m_pending);
+            ++(group->m_submitted);
+            TaskQueue& target = (t_workerIndex >= 0 ? m_queues[t_workerIndex] : injectQueue());
+            {
+                lock_guard<mutex> locked(target.m_mutex);
+                Task newTask;
+                newTask.m_func = func;
+                newTask.m_group = group;
+                target.m_tasks.push_back(std::move(newTask));
+                ++m_queued;
+            }
+            lock_guard<mutex> locked(m_sleepMutex);
+            m_sleepCond.notify_one();
+        }
+        
+        void wait(CaretTaskGroup::State& group)
+        {
+            Task task;
+            while (group.m_pending.load() > 0)
+            {
+                if (popTask(t_workerIndex, task))
+                {//may belong to another group, that is what keeps nested waits from deadlocking
+                    execute(task);
+                    continue;
+                }
+                unique_lock<mutex> locked(m_sleepMutex);
+                m_sleepCond.wait_for(locked, chrono::milliseconds(10), [this, &group]() { return group.m_pending.load() == 0 || m_queued.load() > 0; });
+            }
+        }
+    };
+    
+    TaskPool& getPool()
+    {
+        static TaskPool* thePool = new TaskPool(CaretOMP::getMaxThreads());//created on first use, so it respects -threads, never deleted because joining threads during static destruction can hang
+        return *thePool;
+    }
+}
+
+CaretTaskGroup::CaretTaskGroup(const int& expectedTasks) : m_state(new State(expectedTasks))
+{
+}
+
+CaretTaskGroup::~CaretTaskGroup()
+{
+    if (m_state->m_pending.load() > 0)
+    {
+        getPool().wait(*m_state);//tasks may reference locals of the scope that is unwinding
+    }
+}
+
+void CaretTaskGroup::run(const function<void()>& task)
+{
+    getPool().submit(task, m_state);
+}
+
+void CaretTaskGroup::wait()
+{
+    getPool().wait(*m_state);
+    exception_ptr error;
+    {
+        lock_guard<mutex> locked(m_state->m_errorMutex);
+        error = m_state->m_error;
+        m_state->m_error = exception_ptr();
+        m_state->m_submitted = 0;//the group can be reused for another batch
+    }
+    if (error) rethrow_exception(error);
+}
+
+int CaretTaskPool::getNumThreads()
+{
+    return getPool().getNumThreads();
+}
@@ -0,0 +1,68 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#ifndef __CARET_TASK_POOL_H__
+#define __CARET_TASK_POOL_H__
+
+#include <functional>
+#include <memory>
+
+namespace caret {
+    
+    /**
+     * A group of coarse tasks (structures, frames, blocks of rows) run on the shared work-stealing pool.
+     * Tasks may create and wait on groups of their own, and may contain openmp loops: a thread that waits
+     * runs queued tasks instead of blocking, and each task's openmp loops get a share of the threads
+     * according to how many tasks of its group can run at once, so nesting doesn't oversubscribe.
+     * The pool uses as many threads as openmp would, so without openmp, tasks run in wait().
+     * With -thread-binding, each worker is bound like the openmp thread with the same number (the waiting thread being 0),
+     * openmp threads started from inside a task on a worker inherit that worker's node.
+     */
+    class CaretTaskGroup
+    {
+    public:
+        struct State;
+    private:
+        std::shared_ptr<State> m_state;
+        CaretTaskGroup(const CaretTaskGroup&);
+        CaretTaskGroup& operator=(const CaretTaskGroup&);
+    public:
+        ///expectedTasks lets the first tasks know how many will share the threads, before the rest are queued
+        CaretTaskGroup(const int& expectedTasks = 0);
+        ~CaretTaskGroup();//waits, but can't throw - call wait() to get exceptions from tasks
+        
+        ///queue a task, it may start immediately on another thread
+        void run(const std::function<void()>& task);
+        
+        ///run queued tasks until all tasks of this group are done, then rethrow the first exception a task threw, if any
+        void wait();
+    };
+    
+    class CaretTaskPool
+    {
+        CaretTaskPool();
+    public:
+        ///number of threads that can run tasks at once, including a waiting thread
+        static int getNumThreads();
+    };
+    
+}
+
+#endif //__CARET_TASK_POOL_H__
@@ -0,0 +1,265 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CaretTrace.h"
+
+#include "CaretAssert.h"
+#include "CaretLogger.h"
+#include "CaretMutex.h"
+
+#include <QByteArray>
+#include <QFile>
+
+#ifndef CARET_OS_WINDOWS
+#include <sys/resource.h>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+atomic<bool> CaretTrace::s_enabled(false);
+
+namespace
+{
+    struct TraceEvent
+    {
+        AString m_name, m_detail;
+        const char* m_category;
+        int64_t m_startTime, m_duration, m_bytes, m_bytesRead, m_bytesWritten, m_peakMemory;
+        int32_t m_threadId;
+    };
+    
+    CaretMutex s_traceMutex;
+    vector<TraceEvent> s_traceEvents;
+    int64_t s_droppedEvents = 0;
+    AString s_traceFileName;
+    chrono::steady_clock::time_point s_traceStart;
+    int32_t s_nextThreadId = 0;
+    atomic<int64_t> s_bytesRead(0), s_bytesWritten(0);
+    thread_local int32_t t_traceThreadId = -1;
+    
+    int64_t getPeakMemoryBytes()
+    {
+#ifdef CARET_OS_WINDOWS
+        return -1;//would need psapi, not worth linking for this
+#else
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#ifdef CARET_OS_MACOSX
+        return usage.ru_maxrss;//bytes on mac
+#else
+        return (int64_t)usage.ru_maxrss * 1024;//kilobytes elsewhere
+#endif
+#endif
+    }
+    
+    AString jsonString(const AString& text)
+    {
+        AString ret = "\"";
+        for (int i = 0; i < text.size(); ++i)
+        {
+            const QChar c = text[i];
+            if (c == '"' || c == '\\')
+            {
+                ret += '\\';
+                ret += c;
+            } else if (c.unicode() < 0x20) {
+                ret += "\\u" + AString::number(c.unicode(), 16).rightJustified(4, '0');
+            } else {
+                ret += c;
+            }
+        }
+        ret += "\"";
+        return ret;
+    }
+    
+    AString megabytes(const int64_t bytes)
+    {
+        return AString::number(bytes / 1048576.0, 'f', 3);
+    }
+}
+
+void CaretTrace::start(const AString& outputFileName)
+{
+    CaretMutexLocker locked(&s_traceMutex);
+    s_traceEvents.clear();
+    s_droppedEvents = 0;
+    s_traceFileName = outputFileName;
+    s_traceStart = chrono::steady_clock::now();
+    s_bytesRead = 0;
+    s_bytesWritten = 0;
+    if (t_traceThreadId < 0) t_traceThreadId = s_nextThreadId++;//so the thread that starts tracing gets the lowest id
+    s_enabled.store(true, memory_order_release);
+}
+
+bool CaretTrace::finish()
+{
+    vector<TraceEvent> events;
+    AString fileName;
+    int64_t droppedEvents = 0;
+    {
+        CaretMutexLocker locked(&s_traceMutex);
+        if (!s_enabled.load(memory_order_relaxed)) return true;
+        s_enabled.store(false, memory_order_relaxed);
+        events.swap(s_traceEvents);
+        droppedEvents = s_droppedEvents;
+        fileName = s_traceFileName;
+    }
+    if (droppedEvents > 0)
+    {
+        CaretLogWarning("trace recorded only the first " + AString::number(MAX_EVENTS) + " spans, " + AString::number(droppedEvents) + " later spans were not recorded");
+    }
+    QFile outFile(fileName);
+    if (!outFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        CaretLogWarning("unable to open trace file '" + fileName + "' for writing");
+        return false;
+    }
+    int32_t maxThread = 0;
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        maxThread = max(maxThread, events[i].m_threadId);
+    }
+    AString text = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    text += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"wb_command\"}}";
+    for (int32_t t = 0; t <= maxThread; ++t)
+    {
+        AString threadName = "main";
+        if (t != 0) threadName = "thread " + AString::number(t);
+        text += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + AString::number(t) + ",\"args\":{\"name\":" + jsonString(threadName) + "}}";
+    }
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        const TraceEvent& event = events[i];
+        const AString common = ",\"pid\":1,\"tid\":" + AString::number(event.m_threadId);
+        const int64_t endTime = event.m_startTime + event.m_duration;
+        text += ",\n{\"name\":" + jsonString(event.m_name) + ",\"cat\":" + jsonString(event.m_category) + ",\"ph\":\"X\",\"ts\":" + AString::number(event.m_startTime) +
+                ",\"dur\":" + AString::number(event.m_duration) + common + ",\"args\":{";
+        AString args;
+        if (!event.m_detail.isEmpty()) args += "\"detail\":" + jsonString(event.m_detail);
+        if (event.m_bytes >= 0)
+        {
+            if (!args.isEmpty()) args += ",";
+            args += "\"bytes\":" + AString::number(event.m_bytes);
+            if (event.m_duration > 0) args += ",\"MB/s\":" + megabytes(event.m_bytes * 1000000 / event.m_duration);
+        }
+        text += args + "}}";
+        //counters show the totals at the end of each span, they are per-process, so use the main thread
+        text += ",\n{\"name\":\"io\",\"ph\":\"C\",\"ts\":" + AString::number(endTime) + ",\"pid\":1,\"tid\":0,\"args\":{\"read MB\":" + megabytes(event.m_bytesRead) +
+                ",\"written MB\":" + megabytes(event.m_bytesWritten) + "}}";
+        if (event.m_peakMemory >= 0)
+        {
+            text += ",\n{\"name\":\"memory\",\"ph\":\"C\",\"ts\":" + AString::number(endTime) + ",\"pid\":1,\"tid\":0,\"args\":{\"peak RSS MB\":" + megabytes(event.m_peakMemory) + "}}";
+        }
+        if (text.size() > (1 << 20))
+        {
+            outFile.write(text.toUtf8());
+            text.clear();
+        }
+    }
+    text += "\n]}\n";
+    outFile.write(text.toUtf8());
+    if (outFile.error() != QFileDevice::NoError)
+    {
+        CaretLogWarning("error writing trace file '" + fileName + "': " + outFile.errorString());
+        return false;
+    }
+    CaretLogInfo("wrote " + AString::number(events.size()) + " trace spans to '" + fileName + "'");
+    return true;
+}
+
+void CaretTrace::addBytesRead(const int64_t bytes)
+{
+    s_bytesRead += bytes;
+}
+
+void CaretTrace::addBytesWritten(const int64_t bytes)
+{
+    s_bytesWritten += bytes;
+}
+
+int64_t CaretTrace::getTimestamp()
+{
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - s_traceStart).count();
+}
+
+int32_t CaretTrace::getThreadId()
+{
+    if (t_traceThreadId < 0)
+    {
+        CaretMutexLocker locked(&s_traceMutex);
+        t_traceThreadId = s_nextThreadId++;
+    }
+    return t_traceThreadId;
+}
+
+void CaretTrace::addSpan(const AString& name, const char* category, const int64_t startTime, const int64_t duration, const AString& detail, const int64_t bytes)
+{
+    TraceEvent event;
+    event.m_name = name;
+    event.m_detail = detail;
+    event.m_category = category;
+    event.m_startTime = startTime;
+    event.m_duration = duration;
+    event.m_bytes = bytes;
+    event.m_bytesRead = s_bytesRead;
+    event.m_bytesWritten = s_bytesWritten;
+    event.m_peakMemory = getPeakMemoryBytes();
+    event.m_threadId = getThreadId();
+    CaretMutexLocker locked(&s_traceMutex);
+    if (!s_enabled.load(memory_order_relaxed)) return;
+    if ((int64_t)s_traceEvents.size() >= MAX_EVENTS)
+    {
+        ++s_droppedEvents;
+        return;
+    }
+    s_traceEvents.push_back(event);
+}
+
+CaretTraceSpan::CaretTraceSpan(const char* category, const char* name, const int64_t minDuration)
+: m_category(category), m_name(name), m_startTime(0), m_minDuration(minDuration), m_bytes(-1)
+{
+    m_active = CaretTrace::isEnabled();
+    if (m_active) m_startTime = CaretTrace::getTimestamp();
+}
+
+CaretTraceSpan::CaretTraceSpan(const char* category, const AString& name, const int64_t minDuration)
+: m_category(category), m_name(NULL), m_startTime(0), m_minDuration(minDuration), m_bytes(-1)
+{
+    m_active = CaretTrace::isEnabled();
+    if (m_active)
+    {
+        m_dynamicName = name;
+        m_startTime = CaretTrace::getTimestamp();
+    }
+}
+
+CaretTraceSpan::~CaretTraceSpan()
+{
+    if (!m_active || !CaretTrace::isEnabled()) return;
+    const int64_t duration = CaretTrace::getTimestamp() - m_startTime;
+    if (duration < m_minDuration) return;
+    CaretAssert(m_name != NULL || !m_dynamicName.isEmpty());
+    CaretTrace::addSpan(m_name != NULL ? AString(m_name) : m_dynamicName, m_category, m_startTime, duration, m_detail, m_bytes);
+}
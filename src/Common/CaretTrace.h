@@ -0,0 +1,96 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#ifndef __CARET_TRACE_H__
+#define __CARET_TRACE_H__
+
+#include "AString.h"
+
+#include <atomic>
+#include <stdint.h>
+
+namespace caret {
+    
+    /**
+     * Records timed spans, bytes read and written, and peak memory, and writes them
+     * as a Chrome trace-event JSON file (load it in chrome://tracing or ui.perfetto.dev).
+     * Recording is off unless started, and spans cost only a flag check when it is off.
+     * At most MAX_EVENTS spans are kept, so a long-running process (-daemon) can't grow without bound.
+     */
+    class CaretTrace
+    {
+        static std::atomic<bool> s_enabled;//written under the trace mutex, read by spans on any thread
+        CaretTrace();
+    public:
+        ///start recording, to be written to the given file by finish()
+        static void start(const AString& outputFileName);
+        
+        ///write the recorded events and stop recording, returns false if the file couldn't be written
+        static bool finish();
+        
+        ///acquire, so that a span that sees recording enabled also sees the start time
+        static bool isEnabled() { return s_enabled.load(std::memory_order_acquire); }
+        
+        ///spans after this many are counted but not recorded
+        static const int64_t MAX_EVENTS = 1000000;
+        
+        static void addBytesRead(const int64_t bytes);
+        
+        static void addBytesWritten(const int64_t bytes);
+        
+        ///microseconds since recording started
+        static int64_t getTimestamp();
+        
+        ///small consecutive number for the calling thread, for the trace's tid field
+        static int32_t getThreadId();
+        
+        ///record a finished span, detail may be empty, and bytes negative if not applicable
+        static void addSpan(const AString& name, const char* category, const int64_t startTime, const int64_t duration, const AString& detail, const int64_t bytes);
+    };
+    
+    ///times its own lifetime as a span, if tracing is enabled
+    class CaretTraceSpan
+    {
+        const char* m_category;
+        const char* m_name;
+        AString m_dynamicName, m_detail;
+        int64_t m_startTime, m_minDuration, m_bytes;
+        bool m_active;
+        CaretTraceSpan(const CaretTraceSpan&);
+        CaretTraceSpan& operator=(const CaretTraceSpan&);
+    public:
+        ///spans shorter than minDuration microseconds aren't recorded, for things that happen very often
+        CaretTraceSpan(const char* category, const char* name, const int64_t minDuration = 0);
+        CaretTraceSpan(const char* category, const AString& name, const int64_t minDuration = 0);
+        ~CaretTraceSpan();
+        
+        ///whether the span is recording, check it before building detail strings
+        bool isActive() const { return m_active; }
+        
+        ///shown in the span's arguments, such as a filename
+        void setDetail(const AString& detail) { m_detail = detail; }
+        
+        ///number of bytes the span processed
+        void setBytes(const int64_t bytes) { m_bytes = bytes; }
+    };
+    
+}
+
+#endif //__CARET_TRACE_H__
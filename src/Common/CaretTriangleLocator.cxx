@@ -0,0 +1,230 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CaretTriangleLocator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace caret;
+using namespace std;
+
+CaretTriangleLocator::CaretTriangleLocator(const float* coordsIn, const int64_t numCoords, const int32_t* trianglesIn, const int64_t numTriangles)
+{
+    m_coords.assign(coordsIn, coordsIn + numCoords * 3);
+    m_triangles.reserve(numTriangles * 3);
+    m_triOrder.reserve(numTriangles);
+    vector<float> centroids(numTriangles * 3, 0.0f);
+    for (int64_t i = 0; i < numTriangles; ++i)
+    {
+        const int32_t* thisTri = trianglesIn + i * 3;
+        if (thisTri[0] < 0 || thisTri[1] < 0 || thisTri[2] < 0 ||
+            thisTri[0] >= numCoords || thisTri[1] >= numCoords || thisTri[2] >= numCoords)
+        {//keep triangle numbering intact, but never put invalid triangles in the tree
+            m_triangles.push_back(-1); m_triangles.push_back(-1); m_triangles.push_back(-1);
+            continue;
+        }
+        m_triangles.push_back(thisTri[0]);
+        m_triangles.push_back(thisTri[1]);
+        m_triangles.push_back(thisTri[2]);
+        for (int j = 0; j < 3; ++j)
+        {
+            centroids[i * 3 + j] = (m_coords[thisTri[0] * 3 + j] + m_coords[thisTri[1] * 3 + j] + m_coords[thisTri[2] * 3 + j]) / 3.0f;
+        }
+        m_triOrder.push_back(i);
+    }
+    if (m_triOrder.empty()) return;
+    m_nodes.reserve(2 * (m_triOrder.size() / NUM_TRIS_LEAF + 1));
+    m_nodes.push_back(Node());
+    buildNode(0, 0, (int64_t)m_triOrder.size(), centroids);
+}
+
+void CaretTriangleLocator::buildNode(const int64_t nodeIndex, const int64_t first, const int64_t count, const std::vector<float>& centroids)
+{
+    float boxMin[3], boxMax[3], centMin[3], centMax[3];
+    for (int j = 0; j < 3; ++j)
+    {
+        boxMin[j] = numeric_limits<float>::max(); boxMax[j] = -numeric_limits<float>::max();
+        centMin[j] = numeric_limits<float>::max(); centMax[j] = -numeric_limits<float>::max();
+    }
+    for (int64_t i = first; i < first + count; ++i)
+    {
+        const int64_t tri = m_triOrder[i];
+        for (int k = 0; k < 3; ++k)
+        {
+            const float* vert = m_coords.data() + m_triangles[tri * 3 + k] * 3;
+            for (int j = 0; j < 3; ++j)
+            {
+                boxMin[j] = min(boxMin[j], vert[j]);
+                boxMax[j] = max(boxMax[j], vert[j]);
+            }
+        }
+        for (int j = 0; j < 3; ++j)
+        {
+            centMin[j] = min(centMin[j], centroids[tri * 3 + j]);
+            centMax[j] = max(centMax[j], centroids[tri * 3 + j]);
+        }
+    }
+    for (int j = 0; j < 3; ++j)
+    {//m_nodes may reallocate during recursion, so don't hold a reference across the recursive calls
+        m_nodes[nodeIndex].m_min[j] = boxMin[j];
+        m_nodes[nodeIndex].m_max[j] = boxMax[j];
+    }
+    int axis = 0;
+    for (int j = 1; j < 3; ++j)
+    {
+        if (centMax[j] - centMin[j] > centMax[axis] - centMin[axis]) axis = j;
+    }
+    if (count <= NUM_TRIS_LEAF || !(centMax[axis] > centMin[axis]))//don't split if all centroids are identical
+    {
+        m_nodes[nodeIndex].m_first = first;
+        m_nodes[nodeIndex].m_count = (int32_t)count;
+        return;
+    }
+    //median split on the longest axis of the centroids, gives a balanced tree
+    const int64_t half = count / 2;
+    nth_element(m_triOrder.begin() + first, m_triOrder.begin() + first + half, m_triOrder.begin() + first + count,
+                [&centroids, axis](const int64_t a, const int64_t b) { return centroids[a * 3 + axis] < centroids[b * 3 + axis]; });
+    const int64_t leftIndex = (int64_t)m_nodes.size();
+    m_nodes.push_back(Node());
+    m_nodes.push_back(Node());
+    m_nodes[nodeIndex].m_first = leftIndex;
+    m_nodes[nodeIndex].m_count = 0;
+    buildNode(leftIndex, first, half, centroids);
+    buildNode(leftIndex + 1, first + half, count - half, centroids);
+}
+
+bool CaretTriangleLocator::boxIntersect(const Node& node, const float start[3], const float invDir[3], const float maxDist, float& entryOut)
+{//slab test
+    float tmin = 0.0f, tmax = maxDist;
+    for (int j = 0; j < 3; ++j)
+    {
+        if (isinf(invDir[j]))
+        {//ray parallel to the slab, don't compute 0 * inf when start is on a slab plane, which is common (coordinates of exactly 0)
+            if (start[j] < node.m_min[j] || start[j] > node.m_max[j]) return false;
+            continue;
+        }
+        float t1 = (node.m_min[j] - start[j]) * invDir[j];
+        float t2 = (node.m_max[j] - start[j]) * invDir[j];
+        if (t1 > t2) swap(t1, t2);
+        t2 += abs(t2) * 4.0f * numeric_limits<float>::epsilon();//rounding must not cull a box the ray only grazes, such as at a triangle edge on the box boundary
+        if (t1 > tmin) tmin = t1;
+        if (t2 < tmax) tmax = t2;
+        if (!(tmin <= tmax)) return false;//also catches NaN
+    }
+    entryOut = tmin;
+    return true;
+}
+
+bool CaretTriangleLocator::triangleIntersect(const int64_t triangle, const float start[3], const float direction[3], TriangleRayHit& hitOut) const
+{//Moller-Trumbore, two-sided
+    const float* v0 = m_coords.data() + m_triangles[triangle * 3] * 3;
+    const float* v1 = m_coords.data() + m_triangles[triangle * 3 + 1] * 3;
+    const float* v2 = m_coords.data() + m_triangles[triangle * 3 + 2] * 3;
+    const double e1[3] = { (double)v1[0] - v0[0], (double)v1[1] - v0[1], (double)v1[2] - v0[2] };
+    const double e2[3] = { (double)v2[0] - v0[0], (double)v2[1] - v0[1], (double)v2[2] - v0[2] };
+    const double pvec[3] = { direction[1] * e2[2] - direction[2] * e2[1],
+                             direction[2] * e2[0] - direction[0] * e2[2],
+                             direction[0] * e2[1] - direction[1] * e2[0] };
+    const double det = e1[0] * pvec[0] + e1[1] * pvec[1] + e1[2] * pvec[2];
+    if (det == 0.0) return false;//ray parallel to the triangle, or degenerate triangle
+    const double invDet = 1.0 / det;
+    const double tvec[3] = { (double)start[0] - v0[0], (double)start[1] - v0[1], (double)start[2] - v0[2] };
+    const double u = (tvec[0] * pvec[0] + tvec[1] * pvec[1] + tvec[2] * pvec[2]) * invDet;
+    if (u < 0.0 || u > 1.0) return false;
+    const double qvec[3] = { tvec[1] * e1[2] - tvec[2] * e1[1],
+                             tvec[2] * e1[0] - tvec[0] * e1[2],
+                             tvec[0] * e1[1] - tvec[1] * e1[0] };
+    const double v = (direction[0] * qvec[0] + direction[1] * qvec[1] + direction[2] * qvec[2]) * invDet;
+    if (v < 0.0 || u + v > 1.0) return false;
+    const double t = (e2[0] * qvec[0] + e2[1] * qvec[1] + e2[2] * qvec[2]) * invDet;
+    if (t < 0.0) return false;
+    hitOut.triangle = triangle;
+    hitOut.distance = (float)t;
+    hitOut.barycentric[0] = (float)(1.0 - u - v);
+    hitOut.barycentric[1] = (float)u;
+    hitOut.barycentric[2] = (float)v;
+    for (int j = 0; j < 3; ++j)
+    {
+        hitOut.xyz[j] = (float)(start[j] + t * direction[j]);
+    }
+    return true;
+}
+
+bool CaretTriangleLocator::closestRayIntersection(const float start[3], const float direction[3], TriangleRayHit& hitOut, const float maxDist,
+                                                  const std::function<bool(const TriangleRayHit&)>& acceptHit) const
+{
+    hitOut = TriangleRayHit();
+    if (m_nodes.empty()) return false;
+    float invDir[3];
+    for (int j = 0; j < 3; ++j)
+    {
+        invDir[j] = 1.0f / direction[j];//division by zero gives inf, which the slab test handles
+    }
+    float bestDist = (maxDist > 0.0f ? maxDist : numeric_limits<float>::infinity());
+    bool found = false;
+    float entry;
+    if (!boxIntersect(m_nodes[0], start, invDir, bestDist, entry)) return false;
+    vector<pair<int64_t, float> > stack;//small, depth of a balanced tree
+    stack.push_back(make_pair((int64_t)0, entry));
+    TriangleRayHit tempHit;
+    while (!stack.empty())
+    {
+        const pair<int64_t, float> cur = stack.back();
+        stack.pop_back();
+        if (cur.second > bestDist) continue;//found something closer since this was pushed
+        const Node& node = m_nodes[cur.first];
+        if (node.m_count > 0)
+        {
+            for (int64_t i = node.m_first; i < node.m_first + node.m_count; ++i)
+            {
+                if (triangleIntersect(m_triOrder[i], start, direction, tempHit) && tempHit.distance <= bestDist)
+                {
+                    if (found && tempHit.distance == bestDist && tempHit.triangle > hitOut.triangle) continue;//deterministic on shared edges
+                    if (acceptHit && !acceptHit(tempHit)) continue;
+                    hitOut = tempHit;
+                    bestDist = tempHit.distance;
+                    found = true;
+                }
+            }
+        } else {
+            float entryLeft, entryRight;
+            const bool hitLeft = boxIntersect(m_nodes[node.m_first], start, invDir, bestDist, entryLeft);
+            const bool hitRight = boxIntersect(m_nodes[node.m_first + 1], start, invDir, bestDist, entryRight);
+            if (hitLeft && hitRight)
+            {//push the farther child first, so the nearer child is searched first
+                if (entryLeft < entryRight)
+                {
+                    stack.push_back(make_pair(node.m_first + 1, entryRight));
+                    stack.push_back(make_pair(node.m_first, entryLeft));
+                } else {
+                    stack.push_back(make_pair(node.m_first, entryLeft));
+                    stack.push_back(make_pair(node.m_first + 1, entryRight));
+                }
+            } else if (hitLeft) {
+                stack.push_back(make_pair(node.m_first, entryLeft));
+            } else if (hitRight) {
+                stack.push_back(make_pair(node.m_first + 1, entryRight));
+            }
+        }
+    }
+    return found;
+}
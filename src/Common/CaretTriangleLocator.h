@@ -0,0 +1,70 @@
+#ifndef __CARET_TRIANGLE_LOCATOR_H__
+#define __CARET_TRIANGLE_LOCATOR_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace caret {
+    
+    struct TriangleRayHit
+    {
+        int64_t triangle;
+        ///distance along the ray, in units of the length of the direction vector
+        float distance;
+        float xyz[3];
+        ///barycentric weights of the triangle's three vertices
+        float barycentric[3];
+        TriangleRayHit() { triangle = -1; distance = -1.0f; }
+    };
+    
+    ///bounding volume hierarchy over the triangles of a mesh, for fast ray picking without rendering
+    class CaretTriangleLocator
+    {
+        struct Node
+        {
+            float m_min[3], m_max[3];
+            int64_t m_first;//first entry in m_triOrder for a leaf, index of left child (right is m_first + 1) for an internal node
+            int32_t m_count;//number of triangles if leaf, 0 if internal
+        };
+        std::vector<Node> m_nodes;
+        std::vector<int64_t> m_triOrder;
+        std::vector<float> m_coords;
+        std::vector<int32_t> m_triangles;
+        static const int NUM_TRIS_LEAF = 8;
+        void buildNode(const int64_t nodeIndex, const int64_t first, const int64_t count, const std::vector<float>& centroids);
+        bool triangleIntersect(const int64_t triangle, const float start[3], const float direction[3], TriangleRayHit& hitOut) const;
+        static bool boxIntersect(const Node& node, const float start[3], const float invDir[3], const float maxDist, float& entryOut);
+        CaretTriangleLocator();
+    public:
+        ///copies the coordinates and triangles, so the mesh can change without affecting the locator
+        CaretTriangleLocator(const float* coordsIn, const int64_t numCoords, const int32_t* trianglesIn, const int64_t numTriangles);
+        ///find the closest intersection with distance >= 0 (and <= maxDist, if maxDist is positive) along the ray, returns false if nothing was hit
+        ///acceptHit can reject intersections (for instance, points removed by clipping planes), in which case farther intersections are found instead
+        bool closestRayIntersection(const float start[3], const float direction[3], TriangleRayHit& hitOut, const float maxDist = -1.0f,
+                                    const std::function<bool(const TriangleRayHit&)>& acceptHit = std::function<bool(const TriangleRayHit&)>()) const;
+        int64_t getNumberOfTriangles() const { return (int64_t)(m_triangles.size() / 3); }
+    };
+}
+
+#endif //__CARET_TRIANGLE_LOCATOR_H__
@@ -18,6 +18,8 @@
  */
 /*LICENSE_END*/
 
+#include <atomic>
+
 #include <QFileInfo>
 
 #include "CaretLogger.h"
@@ -28,6 +30,12 @@
 
 using namespace caret;
 
+/**
+ * Source of modification stamps, shared by all files so that a stamp
+ * is never reused, even by a file created at the address of a deleted file.
+ */
+static std::atomic<int64_t> s_modificationStampCounter(0);
+
 /**
  * Constructor.
  */
@@ -84,6 +92,7 @@ DataFile::copyHelperDataFile(const DataFile& df)
     m_filename = df.m_filename;
     m_fileReadWarnings = df.m_fileReadWarnings;
     m_modifiedFlag = false;
+    m_modificationStamp = ++s_modificationStampCounter;
     m_timeOfLastReadOrWrite = QDateTime();
 }
 
@@ -96,6 +105,7 @@ DataFile::initializeMembersDataFile()
     m_filename = "";
     m_fileReadWarnings.clear();
     m_modifiedFlag = false;
+    m_modificationStamp = ++s_modificationStampCounter;
     m_timeOfLastReadOrWrite = QDateTime();
 }
 
@@ -187,6 +197,7 @@ void
 DataFile::setModified()
 {
     m_modifiedFlag = true;
+    m_modificationStamp = ++s_modificationStampCounter;
 }
 
 /**
@@ -196,6 +207,7 @@ void
 DataFile::clearModified()
 {
     m_modifiedFlag = false;
+    m_modificationStamp = ++s_modificationStampCounter;
     
     /*
      * This method, clearModified(), is called by all file
@@ -204,6 +216,30 @@ DataFile::clearModified()
     setTimeOfLastReadOrWrite();
 }
 
+/**
+ * @return A stamp that changes each time the file is modified
+ * (setModified()) or read or written (clearModified()).  No two files
+ * ever have the same stamp so a cache of data derived from a file
+ * may use the stamp to verify that the cached data is current.
+ */
+int64_t
+DataFile::getModificationStamp() const
+{
+    return m_modificationStamp;
+}
+
+/**
+ * Change the modification stamp without changing the modification status.
+ * Used when content is changed in a way that should not cause the user
+ * to be prompted to save the file (such as dynamically loaded data) but
+ * data derived from the file's content (such as coloring) is no longer valid.
+ */
+void
+DataFile::updateModificationStamp()
+{
+    m_modificationStamp = ++s_modificationStampCounter;
+}
+
 /**
  * Is the object modified?
  * @return true if modified, else false.
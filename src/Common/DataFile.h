@@ -48,6 +48,8 @@ namespace caret {
         
         void setFileNameProtected(const AString& filename);
         
+        void updateModificationStamp();
+        
     public:
         virtual AString getFileName() const;
         
@@ -103,6 +105,8 @@ namespace caret {
         
         bool isModifiedSinceTimeOfLastReadOrWrite() const;
         
+        int64_t getModificationStamp() const;
+        
         virtual std::vector<AString> getChildDataFilePathNames() const;
 
     private:
@@ -123,6 +127,9 @@ namespace caret {
         /** modification status */
         bool m_modifiedFlag;
         
+        /** changes each time the file is modified, read, or written */
+        int64_t m_modificationStamp;
+        
         QDateTime m_timeOfLastReadOrWrite;
     };
     
@@ -167,6 +167,8 @@ void
 EventManager::addEventListener(EventListenerInterface* eventListener,
                                const EventTypeEnum::Enum listenForEventType)
 {
+    CaretMutexLocker locker(&m_listenersMutex);
+    
 #ifdef CONTAINER_VECTOR
     m_eventListeners[listenForEventType].push_back(eventListener);
 #elif CONTAINER_HASH_SET
@@ -191,6 +193,8 @@ void
 EventManager::addProcessedEventListener(EventListenerInterface* eventListener,
                                const EventTypeEnum::Enum listenForEventType)
 {
+    CaretMutexLocker locker(&m_listenersMutex);
+    
 #ifdef CONTAINER_VECTOR
     m_eventProcessedListeners[listenForEventType].push_back(eventListener);
 #elif CONTAINER_HASH_SET
@@ -214,6 +218,8 @@ void
 EventManager::removeEventFromListener(EventListenerInterface* eventListener,
                                   const EventTypeEnum::Enum listenForEventType)
 {
+    CaretMutexLocker locker(&m_listenersMutex);
+    
 #ifdef CONTAINER_VECTOR
     /*
      * Remove from NORMAL listeners
@@ -271,7 +277,7 @@ void
 EventManager::sendEvent(Event* event)
 {   
     EventTypeEnum::Enum eventType = event->getEventType();
-    const AString eventNumberString = AString::number(m_eventIssuedCounter);
+    const AString eventNumberString = AString::number(m_eventIssuedCounter.load());
     const AString eventMessagePrefix = ("Event "
                                         + eventNumberString
                                         + ": "
@@ -306,9 +312,13 @@ EventManager::sendEvent(Event* event)
         /*
          * Get listeners for event.
          */
-        EVENT_LISTENER_CONTAINER listeners = m_eventListeners[eventType];
+        EVENT_LISTENER_CONTAINER listeners;
+        {
+            CaretMutexLocker locker(&m_listenersMutex);
+            listeners = m_eventListeners[eventType];
+        }
         
-        const AString eventNumberString = AString::number(m_eventIssuedCounter);
+        const AString eventNumberString = AString::number(m_eventIssuedCounter.load());
         
         /*
          * Send event to each of the listeners.
@@ -333,7 +343,11 @@ EventManager::sendEvent(Event* event)
             /*
              * Send event to each of the PROCESSED listeners.
              */
-            EVENT_LISTENER_CONTAINER processedListeners = m_eventProcessedListeners[eventType];
+            EVENT_LISTENER_CONTAINER processedListeners;
+            {
+                CaretMutexLocker locker(&m_listenersMutex);
+                processedListeners = m_eventProcessedListeners[eventType];
+            }
             for (EVENT_LISTENER_CONTAINER_ITERATOR iter = processedListeners.begin();
                  iter != processedListeners.end();
                  iter++) {
@@ -576,7 +590,7 @@ EventManager::blockEvent(const EventTypeEnum::Enum eventType,
 int64_t
 EventManager::getEventIssuedCounter() const
 {
-    return m_eventIssuedCounter;
+    return m_eventIssuedCounter.load();
 }
 
 /**
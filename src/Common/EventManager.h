@@ -21,8 +21,10 @@
  */
 /*LICENSE_END*/
 
+#include <atomic>
 #include <stdint.h>
 
+#include "CaretMutex.h"
 #include "CaretObject.h"
 
 #include "EventTypeEnum.h"
@@ -131,8 +133,15 @@ namespace caret {
          */
         EVENT_LISTENER_CONTAINER m_eventProcessedListeners[EventTypeEnum::EVENT_COUNT];
         
-        /** Counter that is incremented each time an event is issued */
-        int64_t m_eventIssuedCounter;
+        /**
+         * Protects the listener containers so that listeners (such as data
+         * files being read by other threads) may be added or removed while
+         * an event is sent.  It is not held while listeners receive events.
+         */
+        mutable CaretMutex m_listenersMutex;
+        
+        /** Counter that is incremented each time an event is issued, events may be sent from any thread */
+        std::atomic<int64_t> m_eventIssuedCounter;
         
         /** A counter for blocking events of each type */
         std::vector<int64_t> m_eventBlockingCounter;
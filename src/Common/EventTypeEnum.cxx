@@ -303,6 +303,10 @@ EventTypeEnum::initialize()
                                      "EVENT_CHART_TWO_OVERLAY_VALIDATE",
                                      "Validate a chart two overlay for validity (it exists)"));
     
+    enumData.push_back(EventTypeEnum(EVENT_CZI_IMAGE_TILE_LOADED,
+                                     "EVENT_CZI_IMAGE_TILE_LOADED",
+                                     "A CZI image tile finished loading in the background"));
+    
     enumData.push_back(EventTypeEnum(EVENT_DATA_FILE_ADD,
                                      "EVENT_DATA_FILE_ADD",
                                      "Add a data file to the Brain"));
@@ -150,6 +150,8 @@ public:
         EVENT_CHART_TWO_LOAD_LINE_SERIES_DATA,
         /** Validate that chart two overlay is valid (it exists). */
         EVENT_CHART_TWO_OVERLAY_VALIDATE,
+        /** A CZI image tile finished loading in the background */
+        EVENT_CZI_IMAGE_TILE_LOADED,
         /** Add a data file into the Brain*/
         EVENT_DATA_FILE_ADD,
         /** Delete a data file from the brain */
@@ -20,6 +20,7 @@
 /*LICENSE_END*/
 
 #include "FastStatistics.h"
+#include "CaretOMP.h"
 #include "CaretPointer.h"
 
 #include <algorithm>
@@ -30,6 +31,143 @@ using namespace caret;
 using namespace std;
 
 const int64_t NUM_BUCKETS_PERCENTILE_HIST = 10000;//10,000 maximum to deal with some outliers outliers until I think of a better fix
+const int64_t STATISTICS_CHUNK_SIZE = 65536;//amount of data per task when processing blocks multithreaded
+
+namespace
+{
+    ///statistics of part of the data that can be combined with those of other parts (other threads, other blocks)
+    struct FastStatisticsPartial
+    {
+        int64_t m_posCount, m_zeroCount, m_negCount, m_infCount, m_negInfCount, m_nanCount, m_absCount;
+        float m_min, m_max;
+        float m_mostPos, m_leastPos, m_leastNeg, m_mostNeg, m_leastAbs, m_mostAbs;
+        double m_sum, m_mean, m_sumSquaredDeviation;//mean and sum of squared deviation from the mean, for combining variances (Chan et al)
+        bool m_first;
+        
+        FastStatisticsPartial()
+        {
+            m_posCount = 0;
+            m_zeroCount = 0;
+            m_negCount = 0;
+            m_infCount = 0;
+            m_negInfCount = 0;
+            m_nanCount = 0;
+            m_absCount = 0;
+            m_min = 0.0f;
+            m_max = 0.0f;
+            m_mostNeg = 0.0f;
+            m_leastNeg = -numeric_limits<float>::max();
+            m_leastPos = numeric_limits<float>::max();
+            m_mostPos = 0.0f;
+            m_leastAbs = numeric_limits<float>::max();
+            m_mostAbs = 0.0f;
+            m_sum = 0.0;
+            m_mean = 0.0;
+            m_sumSquaredDeviation = 0.0;
+            m_first = true;
+        }
+        
+        int64_t getGoodCount() const { return m_negCount + m_zeroCount + m_posCount; }
+        
+        ///statistics of this piece of data only, uses the same tests as FastStatistics::update()
+        void compute(const float* data, const int64_t& dataCount)
+        {
+            *this = FastStatisticsPartial();
+            for (int64_t i = 0; i < dataCount; ++i)
+            {
+                if (data[i] != data[i])
+                {
+                    ++m_nanCount;
+                    continue;
+                }
+                if (data[i] == 0.0f)
+                {
+                    ++m_zeroCount;
+                } else {
+                    if (data[i] < 0.0f)
+                    {
+                        if (data[i] * 2.0f == data[i])
+                        {
+                            ++m_negInfCount;
+                            continue;
+                        }
+                        ++m_negCount;
+                        if (data[i] > m_leastNeg) m_leastNeg = data[i];
+                        if (data[i] < m_mostNeg) m_mostNeg = data[i];
+                        if (-data[i] > m_mostAbs) m_mostAbs = -data[i];
+                        if (-data[i] < m_leastAbs) m_leastAbs = -data[i];
+                    } else {
+                        if (data[i] * 2.0f == data[i])
+                        {
+                            ++m_infCount;
+                            continue;
+                        }
+                        ++m_posCount;
+                        if (data[i] > m_mostPos) m_mostPos = data[i];
+                        if (data[i] < m_leastPos) m_leastPos = data[i];
+                        if (data[i] > m_mostAbs) m_mostAbs = data[i];
+                        if (data[i] < m_leastAbs) m_leastAbs = data[i];
+                    }
+                    ++m_absCount;
+                }
+                if (data[i] > m_max || m_first) m_max = data[i];
+                if (data[i] < m_min || m_first) m_min = data[i];
+                m_sum += data[i];
+                m_first = false;
+            }
+            const int64_t goodCount = getGoodCount();
+            if (goodCount > 0)
+            {
+                m_mean = m_sum / goodCount;
+                for (int64_t i = 0; i < dataCount; ++i)
+                {//this piece is in memory, so use two passes for stability
+                    if (data[i] != data[i]) continue;
+                    if (data[i] != 0.0f && (data[i] * 2.0f == data[i])) continue;
+                    const double deviation = data[i] - m_mean;
+                    m_sumSquaredDeviation += deviation * deviation;
+                }
+            }
+        }
+        
+        void merge(const FastStatisticsPartial& other)
+        {
+            const int64_t myGood = getGoodCount(), otherGood = other.getGoodCount();
+            if (otherGood > 0)
+            {
+                if (myGood > 0)
+                {
+                    const double delta = other.m_mean - m_mean;
+                    const double total = (double)(myGood + otherGood);
+                    m_mean += delta * otherGood / total;
+                    m_sumSquaredDeviation += other.m_sumSquaredDeviation + delta * delta * ((double)myGood * (double)otherGood / total);
+                } else {
+                    m_mean = other.m_mean;
+                    m_sumSquaredDeviation = other.m_sumSquaredDeviation;
+                }
+            }
+            if (!other.m_first)
+            {
+                if (other.m_max > m_max || m_first) m_max = other.m_max;
+                if (other.m_min < m_min || m_first) m_min = other.m_min;
+                m_first = false;
+            }
+            m_posCount += other.m_posCount;
+            m_zeroCount += other.m_zeroCount;
+            m_negCount += other.m_negCount;
+            m_infCount += other.m_infCount;
+            m_negInfCount += other.m_negInfCount;
+            m_nanCount += other.m_nanCount;
+            m_absCount += other.m_absCount;
+            m_mostPos = max(m_mostPos, other.m_mostPos);
+            m_leastPos = min(m_leastPos, other.m_leastPos);
+            m_leastNeg = max(m_leastNeg, other.m_leastNeg);
+            m_mostNeg = min(m_mostNeg, other.m_mostNeg);
+            m_leastAbs = min(m_leastAbs, other.m_leastAbs);
+            m_mostAbs = max(m_mostAbs, other.m_mostAbs);
+            m_sum += other.m_sum;
+        }
+    };
+}
 
 FastStatistics::FastStatistics()
 {
@@ -259,6 +397,138 @@ void FastStatistics::update(const float* data, const int64_t& dataCount, const f
     }
 }
 
+void FastStatistics::update(const StatisticsBlockSource& blockSource)
+{
+    reset();
+    const int64_t numBlocks = blockSource.getNumberOfBlocks();
+    vector<float> block;
+    FastStatisticsPartial total;
+    int64_t dataCount = 0;
+    for (int64_t b = 0; b < numBlocks; ++b)
+    {//first pass: counts, ranges, mean and variance
+        blockSource.getBlock(b, block);
+        const float* data = block.data();
+        const int64_t blockCount = (int64_t)block.size();
+        dataCount += blockCount;
+        const int64_t numChunks = (blockCount + STATISTICS_CHUNK_SIZE - 1) / STATISTICS_CHUNK_SIZE;
+#pragma omp CARET_PAR if (numChunks > 1)
+        {
+            FastStatisticsPartial threadPartial, chunkPartial;
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int64_t c = 0; c < numChunks; ++c)
+            {
+                const int64_t chunkStart = c * STATISTICS_CHUNK_SIZE;
+                chunkPartial.compute(data + chunkStart, min(STATISTICS_CHUNK_SIZE, blockCount - chunkStart));
+                threadPartial.merge(chunkPartial);
+            }
+#pragma omp critical
+            {
+                total.merge(threadPartial);
+            }
+        }
+    }
+    m_posCount = total.m_posCount;
+    m_zeroCount = total.m_zeroCount;
+    m_negCount = total.m_negCount;
+    m_infCount = total.m_infCount;
+    m_negInfCount = total.m_negInfCount;
+    m_nanCount = total.m_nanCount;
+    m_absCount = total.m_absCount;
+    m_min = total.m_min;
+    m_max = total.m_max;
+    m_mostPos = total.m_mostPos;
+    m_leastPos = total.m_leastPos;
+    m_leastNeg = total.m_leastNeg;
+    m_mostNeg = total.m_mostNeg;
+    m_leastAbs = total.m_leastAbs;
+    m_mostAbs = total.m_mostAbs;
+    int64_t totalGood = total.getGoodCount();
+    m_mean = total.m_sum / totalGood;
+    if (totalGood > 0)
+    {
+        m_stdDevPop = sqrt(total.m_sumSquaredDeviation / totalGood);
+        if (totalGood > 1)
+        {
+            m_stdDevSample = sqrt(total.m_sumSquaredDeviation / (totalGood - 1));
+        }
+    }
+    //second pass: percentile histograms, with the same ranges that update() would find
+    int usebuckets = max((int64_t)1, min(NUM_BUCKETS_PERCENTILE_HIST, dataCount));
+    m_negPercentHist.startAccumulating(usebuckets, (m_negCount > 0 ? m_mostNeg : 0.0f), (m_negCount > 0 ? m_leastNeg : 0.0f));
+    m_posPercentHist.startAccumulating(usebuckets, (m_posCount > 0 ? m_leastPos : 0.0f), (m_posCount > 0 ? m_mostPos : 0.0f));
+    m_absPercentHist.startAccumulating(usebuckets, (m_absCount > 0 ? m_leastAbs : 0.0f), (m_absCount > 0 ? m_mostAbs : 0.0f));
+    float negRange[2], posRange[2], absRange[2];
+    m_negPercentHist.getRange(negRange[0], negRange[1]);
+    m_posPercentHist.getRange(posRange[0], posRange[1]);
+    m_absPercentHist.getRange(absRange[0], absRange[1]);
+    for (int64_t b = 0; b < numBlocks; ++b)
+    {
+        blockSource.getBlock(b, block);
+        const float* data = block.data();
+        const int64_t blockCount = (int64_t)block.size();
+        const int64_t numChunks = (blockCount + STATISTICS_CHUNK_SIZE - 1) / STATISTICS_CHUNK_SIZE;
+#pragma omp CARET_PAR if (numChunks > 1)
+        {
+            Histogram negHist(usebuckets), posHist(usebuckets), absHist(usebuckets);
+            negHist.startAccumulating(usebuckets, negRange[0], negRange[1]);
+            posHist.startAccumulating(usebuckets, posRange[0], posRange[1]);
+            absHist.startAccumulating(usebuckets, absRange[0], absRange[1]);
+            vector<float> positives(STATISTICS_CHUNK_SIZE), negatives(STATISTICS_CHUNK_SIZE), absolutes(STATISTICS_CHUNK_SIZE);
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int64_t c = 0; c < numChunks; ++c)
+            {
+                const int64_t chunkStart = c * STATISTICS_CHUNK_SIZE;
+                const int64_t chunkEnd = min(chunkStart + STATISTICS_CHUNK_SIZE, blockCount);
+                int64_t posCount = 0, negCount = 0, absCount = 0;
+                for (int64_t i = chunkStart; i < chunkEnd; ++i)
+                {
+                    if (data[i] != data[i] || data[i] == 0.0f) continue;//skip NaNs and zeros
+                    if (data[i] * 2.0f == data[i]) continue;//skip infs
+                    if (data[i] < 0.0f)
+                    {
+                        negatives[negCount] = data[i];
+                        ++negCount;
+                        absolutes[absCount] = -data[i];
+                    } else {
+                        positives[posCount] = data[i];
+                        ++posCount;
+                        absolutes[absCount] = data[i];
+                    }
+                    ++absCount;
+                }
+                negHist.accumulate(negatives.data(), negCount);
+                posHist.accumulate(positives.data(), posCount);
+                absHist.accumulate(absolutes.data(), absCount);
+            }
+#pragma omp critical
+            {
+                m_negPercentHist.merge(negHist);
+                m_posPercentHist.merge(posHist);
+                m_absPercentHist.merge(absHist);
+            }
+        }
+    }
+    m_negPercentHist.finishAccumulating();
+    m_posPercentHist.finishAccumulating();
+    m_absPercentHist.finishAccumulating();
+    
+    if (m_negCount <= 0)
+    {
+        m_leastNeg = 0.0;
+        m_mostNeg  = 0.0;
+    }
+    if (m_posCount <= 0)
+    {
+        m_leastPos = 0.0;
+        m_mostPos  = 0.0;
+    }
+    if (m_absCount <= 0)
+    {
+        m_leastAbs = 0.0;
+        m_mostAbs  = 0.0;
+    }
+}
+
 float FastStatistics::getApproxNegativePercentile(const float& percent) const
 {
     float rank = percent / 100.0f * m_negCount;//translate to rank
@@ -46,6 +46,9 @@ namespace caret
         
         void update(const float* data, const int64_t& dataCount);
         
+        ///for data too large to have in memory at once, reads each block twice (ranges, then histograms), blocks are processed multithreaded
+        void update(const StatisticsBlockSource& blockSource);
+        
         ///statistics and display are really not that related, so for now, only include a continuous clipping range, excluding the middle from data will do weird things to standard deviation
         void update(const float* data, const int64_t& dataCount, const float& minThreshInclusive, const float& maxThreshInclusive);
         
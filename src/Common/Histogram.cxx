@@ -21,11 +21,16 @@
 
 #include "Histogram.h"
 #include "CaretAssert.h"
+#include "CaretOMP.h"
+
+#include <algorithm>
 #include <cmath>
 
 using namespace caret;
 using namespace std;
 
+const int64_t HISTOGRAM_CHUNK_SIZE = 65536;//amount of data per task when processing blocks multithreaded
+
 Histogram::Histogram(const int& numBuckets)
 {
     resize(numBuckets);
@@ -87,8 +92,119 @@ void Histogram::update(const int& numBuckets, const float* data, const int64_t&
 void Histogram::update(const float* data, const int64_t& dataCount)
 {
     int numBuckets = (int)m_buckets.size();
+    bool first = true;
+    float rangeMin = 0.0f, rangeMax = 0.0f;
+    for (int64_t i = 0; i < dataCount; ++i)
+    {//find range of valid values
+        if (data[i] != data[i]) continue;//skip NaNs
+        if (data[i] != 0.0f && (data[i] * 2.0f == data[i])) continue;//skip infs
+        if (first)
+        {
+            first = false;
+            rangeMin = data[i];
+            rangeMax = data[i];
+        } else {
+            if (data[i] > rangeMax)
+            {
+                rangeMax = data[i];
+            } else if (data[i] < rangeMin) {//skip testing for new minimum if we found a new maximum
+                rangeMin = data[i];
+            }
+        }
+    }
+    startAccumulating(numBuckets, rangeMin, rangeMax);//if no valid data, range is zero, and all counts will be zero
+    accumulate(data, dataCount);
+    finishAccumulating();
+}
+
+void Histogram::update(const int& numBuckets, const StatisticsBlockSource& blockSource)
+{
+    resize(numBuckets);
     reset();
+    const int64_t numBlocks = blockSource.getNumberOfBlocks();
+    vector<float> block;
     bool first = true;
+    float rangeMin = 0.0f, rangeMax = 0.0f;
+    for (int64_t b = 0; b < numBlocks; ++b)
+    {//first pass, find range of valid values
+        blockSource.getBlock(b, block);
+        const float* data = block.data();
+        const int64_t dataCount = (int64_t)block.size();
+#pragma omp CARET_PAR if (dataCount > HISTOGRAM_CHUNK_SIZE)
+        {
+            bool myFirst = true;
+            float myMin = 0.0f, myMax = 0.0f;
+#pragma omp CARET_FOR schedule(static)
+            for (int64_t i = 0; i < dataCount; ++i)
+            {
+                if (data[i] != data[i]) continue;//skip NaNs
+                if (data[i] != 0.0f && (data[i] * 2.0f == data[i])) continue;//skip infs
+                if (myFirst)
+                {
+                    myFirst = false;
+                    myMin = data[i];
+                    myMax = data[i];
+                } else {
+                    if (data[i] > myMax) myMax = data[i];
+                    if (data[i] < myMin) myMin = data[i];
+                }
+            }
+#pragma omp critical
+            {
+                if (!myFirst)
+                {
+                    if (first)
+                    {
+                        first = false;
+                        rangeMin = myMin;
+                        rangeMax = myMax;
+                    } else {
+                        if (myMax > rangeMax) rangeMax = myMax;
+                        if (myMin < rangeMin) rangeMin = myMin;
+                    }
+                }
+            }
+        }
+    }
+    startAccumulating(numBuckets, rangeMin, rangeMax);
+    for (int64_t b = 0; b < numBlocks; ++b)
+    {//second pass, count into buckets
+        blockSource.getBlock(b, block);
+        const float* data = block.data();
+        const int64_t dataCount = (int64_t)block.size();
+        const int64_t numChunks = (dataCount + HISTOGRAM_CHUNK_SIZE - 1) / HISTOGRAM_CHUNK_SIZE;
+#pragma omp CARET_PAR if (numChunks > 1)
+        {
+            Histogram partial(numBuckets);
+            partial.startAccumulating(numBuckets, m_bucketMin, m_bucketMax);
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int64_t c = 0; c < numChunks; ++c)
+            {
+                const int64_t chunkStart = c * HISTOGRAM_CHUNK_SIZE;
+                partial.accumulate(data + chunkStart, min(HISTOGRAM_CHUNK_SIZE, dataCount - chunkStart));
+            }
+#pragma omp critical
+            {
+                merge(partial);
+            }
+        }
+    }
+    finishAccumulating();
+}
+
+void Histogram::startAccumulating(const int& numBuckets, const float& bucketMin, const float& bucketMax)
+{
+    resize(numBuckets);
+    reset();
+    m_bucketMin = bucketMin;
+    m_bucketMax = bucketMax;
+}
+
+void Histogram::accumulate(const float* data, const int64_t& dataCount)
+{
+    const int numBuckets = (int)m_buckets.size();
+    const bool validRange = (m_bucketMax > m_bucketMin);//if range is zero, finishAccumulating() splits the counts among the buckets
+    const float bucketsize = (validRange ? (m_bucketMax - m_bucketMin) / numBuckets : 0.0f);
     for (int64_t i = 0; i < dataCount; ++i)
     {//count value classes
         if (data[i] != data[i])
@@ -119,59 +235,71 @@ void Histogram::update(const float* data, const int64_t& dataCount)
                 }
             }
         }
-        if (first)
+        if (validRange)
         {
-            first = false;
-            m_bucketMin = data[i];
-            m_bucketMax = data[i];
-        } else {
-            if (data[i] > m_bucketMax)
-            {
-                m_bucketMax = data[i];
-            } else if (data[i] < m_bucketMin) {//skip testing for new minimum if we found a new maximum
-                m_bucketMin = data[i];
-            }
+            int bucket = (int)((data[i] - m_bucketMin) / bucketsize);//doesn't really matter whether small negative floats truncate to a 0 integer
+            if (bucket < 0) bucket = 0;//because of this
+            if (bucket >= numBuckets) bucket = numBuckets - 1;
+            CaretAssertVectorIndex(m_buckets, bucket);
+            ++m_buckets[bucket];
         }
     }
-    if (first)
+}
+
+void Histogram::merge(const Histogram& other)
+{
+    CaretAssert(other.m_buckets.size() == m_buckets.size());
+    CaretAssert(other.m_bucketMin == m_bucketMin && other.m_bucketMax == m_bucketMax);
+    int numBuckets = (int)m_buckets.size();
+    for (int i = 0; i < numBuckets; ++i)
     {
-        m_bucketMin = m_bucketMax = 0.0f;
-        return;//our arrays are already zeroed, so just return if no valid data
+        m_buckets[i] += other.m_buckets[i];
     }
-    if (m_bucketMin == m_bucketMax)
+    m_posCount += other.m_posCount;
+    m_zeroCount += other.m_zeroCount;
+    m_negCount += other.m_negCount;
+    m_infCount += other.m_infCount;
+    m_negInfCount += other.m_negInfCount;
+    m_nanCount += other.m_nanCount;
+}
+
+void Histogram::finishAccumulating()
+{
+    int numBuckets = (int)m_buckets.size();
+    float sanity = m_bucketMax + m_bucketMin;
+    if (m_bucketMax <= m_bucketMin || sanity != sanity)
     {
-        int64_t totalValid = m_negCount + m_posCount + m_zeroCount;
-        for (int i = 0; i < numBuckets - 1; ++i)
+        for (int i = 0; i < numBuckets; ++i)
+        {
+            m_display[i] = 0.0f;
+        }
+        m_displayHeightMax = 0.0;
+        if (m_bucketMax == m_bucketMin)
         {
-            m_cumulative[i] = (i + 1) * totalValid / numBuckets;//so, its not particularly useful if our range is zero, but split them evenly among buckets just for kicks
-            if (i == 0)
+            int64_t totalValid = m_negCount + m_posCount + m_zeroCount;
+            for (int i = 0; i < numBuckets - 1; ++i)
             {
-                m_buckets[i] = m_cumulative[i];
+                m_cumulative[i] = (i + 1) * totalValid / numBuckets;//so, its not particularly useful if our range is zero, but split them evenly among buckets just for kicks
+                if (i == 0)
+                {
+                    m_buckets[i] = m_cumulative[i];
+                } else {
+                    m_buckets[i] = m_cumulative[i] - m_cumulative[i - 1];
+                }
+            }//display is zero
+            m_cumulative[numBuckets - 1] = totalValid;//make sure the last one has all of them
+            if (numBuckets > 1)
+            {
+                m_buckets[numBuckets - 1] = m_cumulative[numBuckets - 1] - m_cumulative[numBuckets - 2];
             } else {
-                m_buckets[i] = m_cumulative[i] - m_cumulative[i - 1];
+                m_buckets[numBuckets - 1] = m_cumulative[numBuckets - 1];
             }
-        }//display is already zeroed, so just return
-        m_cumulative[numBuckets - 1] = totalValid;//make sure the last one has all of them
-        if (numBuckets > 1)
-        {
-            m_buckets[numBuckets - 1] = m_cumulative[numBuckets - 1] - m_cumulative[numBuckets - 2];
         } else {
-            m_buckets[numBuckets - 1] = m_cumulative[numBuckets - 1];
+            computeCumulative();
         }
         return;
     }
     float bucketsize = (m_bucketMax - m_bucketMin) / numBuckets;
-    for (int64_t i = 0; i < dataCount; ++i)
-    {//determine histogram
-        if (data[i] != data[i]) continue;//exclude NaN
-        if (data[i] < -1.0f && (data[i] * 2.0f == data[i])) continue;//exclude -inf
-        if (data[i] > 1.0f && (data[i] * 2.0f == data[i])) continue;//exclude inf
-        int bucket = (int)((data[i] - m_bucketMin) / bucketsize);//doesn't really matter whether small negative floats truncate to a 0 integer
-        if (bucket < 0) bucket = 0;//because of this
-        if (bucket >= numBuckets) bucket = numBuckets - 1;
-        CaretAssertVectorIndex(m_buckets, bucket);
-        ++m_buckets[bucket];
-    }
     computeCumulative();
     m_displayHeightMax = 0.0;
     for (int i = 0; i < numBuckets; ++i)
@@ -198,12 +326,62 @@ void Histogram::update(const float* data, const int64_t& dataCount, float mostPo
                        float leastPositiveValueInclusive, float leastNegativeValueInclusive,
                        float mostNegativeValueInclusive, const bool& includeZeroValues)
 {
-    int numBuckets = (int)m_buckets.size();
     reset();
+    sanitizeLimits(mostPositiveValueInclusive, leastPositiveValueInclusive, leastNegativeValueInclusive, mostNegativeValueInclusive);
+    setLimitedRange(mostPositiveValueInclusive, leastPositiveValueInclusive, leastNegativeValueInclusive, mostNegativeValueInclusive, includeZeroValues);
+    accumulateLimited(data, dataCount, mostPositiveValueInclusive, leastPositiveValueInclusive, leastNegativeValueInclusive, mostNegativeValueInclusive, includeZeroValues);
+    finishAccumulating();
+}
+
+void Histogram::update(const int32_t& numBuckets, const StatisticsBlockSource& blockSource, float mostPositiveValueInclusive,
+                       float leastPositiveValueInclusive, float leastNegativeValueInclusive,
+                       float mostNegativeValueInclusive, const bool& includeZeroValues)
+{
+    resize(numBuckets);
+    reset();
+    sanitizeLimits(mostPositiveValueInclusive, leastPositiveValueInclusive, leastNegativeValueInclusive, mostNegativeValueInclusive);
+    setLimitedRange(mostPositiveValueInclusive, leastPositiveValueInclusive, leastNegativeValueInclusive, mostNegativeValueInclusive, includeZeroValues);
+    const int64_t numBlocks = blockSource.getNumberOfBlocks();
+    vector<float> block;
+    for (int64_t b = 0; b < numBlocks; ++b)
+    {//range doesn't depend on the data, so only one pass is needed
+        blockSource.getBlock(b, block);
+        const float* data = block.data();
+        const int64_t dataCount = (int64_t)block.size();
+        const int64_t numChunks = (dataCount + HISTOGRAM_CHUNK_SIZE - 1) / HISTOGRAM_CHUNK_SIZE;
+#pragma omp CARET_PAR if (numChunks > 1)
+        {
+            Histogram partial(numBuckets);
+            partial.startAccumulating(numBuckets, m_bucketMin, m_bucketMax);
+#pragma omp CARET_FOR schedule(dynamic)
+            for (int64_t c = 0; c < numChunks; ++c)
+            {
+                const int64_t chunkStart = c * HISTOGRAM_CHUNK_SIZE;
+                partial.accumulateLimited(data + chunkStart, min(HISTOGRAM_CHUNK_SIZE, dataCount - chunkStart), mostPositiveValueInclusive,
+                                          leastPositiveValueInclusive, leastNegativeValueInclusive, mostNegativeValueInclusive, includeZeroValues);
+            }
+#pragma omp critical
+            {
+                merge(partial);
+            }
+        }
+    }
+    finishAccumulating();
+}
+
+void Histogram::sanitizeLimits(float& mostPositiveValueInclusive, float& leastPositiveValueInclusive,
+                               float& leastNegativeValueInclusive, float& mostNegativeValueInclusive)
+{
     if (mostNegativeValueInclusive > 0.0f) mostNegativeValueInclusive = 0.0f;//sanity check the inputs without asserting
     if (mostPositiveValueInclusive < 0.0f) mostPositiveValueInclusive = 0.0f;
     if (leastNegativeValueInclusive > 0.0f) leastNegativeValueInclusive = 0.0f;
     if (leastPositiveValueInclusive < 0.0f) leastPositiveValueInclusive = 0.0f;
+}
+
+void Histogram::setLimitedRange(const float& mostPositiveValueInclusive, const float& leastPositiveValueInclusive,
+                                const float& leastNegativeValueInclusive, const float& mostNegativeValueInclusive,
+                                const bool& includeZeroValues)
+{
     if ((mostPositiveValueInclusive >= leastPositiveValueInclusive && mostPositiveValueInclusive != 0.0f) || includeZeroValues)
     {
         m_bucketMax = mostPositiveValueInclusive;
@@ -216,9 +394,16 @@ void Histogram::update(const float* data, const int64_t& dataCount, float mostPo
     } else {
         m_bucketMin = leastPositiveValueInclusive;
     }
+}
+
+void Histogram::accumulateLimited(const float* data, const int64_t& dataCount, const float& mostPositiveValueInclusive,
+                                  const float& leastPositiveValueInclusive, const float& leastNegativeValueInclusive,
+                                  const float& mostNegativeValueInclusive, const bool& includeZeroValues)
+{
+    int numBuckets = (int)m_buckets.size();
     float sanity = m_bucketMax + m_bucketMin;
     if (m_bucketMax <= m_bucketMin || sanity != sanity)
-    {//bad input ranges, so collect counts, make a mock histogram if equal, and return (display values will be zeros)
+    {//bad input ranges, so collect counts, finishAccumulating() makes a mock histogram if equal (display values will be zeros)
         int64_t equalCount = 0;
         for (int64_t i = 0; i < dataCount; ++i)
         {
@@ -246,31 +431,14 @@ void Histogram::update(const float* data, const int64_t& dataCount, float mostPo
         {
             if (m_bucketMax == 0.0f)
             {
-                m_zeroCount = equalCount;
+                m_zeroCount += equalCount;
             } else {
                 if (m_bucketMax < 0.0f)
                 {
-                    m_negCount = equalCount;
-                } else {
-                    m_posCount = equalCount;
-                }
-            }
-            for (int i = 0; i < numBuckets - 1; ++i)
-            {
-                m_cumulative[i] = (i + 1) * equalCount / numBuckets;//so, its not particularly useful if our range is zero, but split them evenly among buckets just for kicks
-                if (i == 0)
-                {
-                    m_buckets[i] = m_cumulative[i];
+                    m_negCount += equalCount;
                 } else {
-                    m_buckets[i] = m_cumulative[i] - m_cumulative[i - 1];
+                    m_posCount += equalCount;
                 }
-            }//display is already zeroed, so just return
-            m_cumulative[numBuckets - 1] = equalCount;//make sure the last one has all of them
-            if (numBuckets > 1)
-            {
-                m_buckets[numBuckets - 1] = m_cumulative[numBuckets - 1] - m_cumulative[numBuckets - 2];
-            } else {
-                m_buckets[numBuckets - 1] = m_cumulative[numBuckets - 1];
             }
         }
         return;
@@ -315,15 +483,6 @@ void Histogram::update(const float* data, const int64_t& dataCount, float mostPo
         CaretAssertVectorIndex(m_buckets, bucket);
         ++m_buckets[bucket];
     }
-    computeCumulative();
-    m_displayHeightMax = 0.0;
-    for (int i = 0; i < numBuckets; ++i)
-    {//compute display values by normalizing by bucket size
-        m_display[i] = m_buckets[i] / bucketsize;
-        if (m_display[i] > m_displayHeightMax) {
-            m_displayHeightMax = m_display[i];
-        }
-    }
 }
 
 void Histogram::computeCumulative()
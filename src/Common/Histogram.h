@@ -24,6 +24,8 @@
 #include <vector>
 #include "stdint.h"
 
+#include "StatisticsBlockSource.h"
+
 namespace caret
 {
     
@@ -43,6 +45,25 @@ namespace caret
         
         void computeCumulative();
         
+        static void sanitizeLimits(float& mostPositiveValueInclusive,
+                                   float& leastPositiveValueInclusive,
+                                   float& leastNegativeValueInclusive,
+                                   float& mostNegativeValueInclusive);
+        
+        void setLimitedRange(const float& mostPositiveValueInclusive,
+                             const float& leastPositiveValueInclusive,
+                             const float& leastNegativeValueInclusive,
+                             const float& mostNegativeValueInclusive,
+                             const bool& includeZeroValues);
+        
+        void accumulateLimited(const float* data,
+                               const int64_t& dataCount,
+                               const float& mostPositiveValueInclusive,
+                               const float& leastPositiveValueInclusive,
+                               const float& leastNegativeValueInclusive,
+                               const float& mostNegativeValueInclusive,
+                               const bool& includeZeroValues);
+        
         void update(const float* data,
                     const int64_t& dataCount,
                     float mostPositiveValueInclusive,
@@ -71,6 +92,31 @@ namespace caret
                     float mostNegativeValueInclusive,
                     const bool& includeZeroValues);
         
+        ///statistics of data that doesn't fit in memory, reads each block twice (range, then counts), blocks are processed multithreaded
+        void update(const int& numBuckets, const StatisticsBlockSource& blockSource);
+        
+        ///limited values version for data that doesn't fit in memory, reads each block once
+        void update(const int32_t& numBuckets,
+                    const StatisticsBlockSource& blockSource,
+                    float mostPositiveValueInclusive,
+                    float leastPositiveValueInclusive,
+                    float leastNegativeValueInclusive,
+                    float mostNegativeValueInclusive,
+                    const bool& includeZeroValues);
+        
+        ///for building a histogram in pieces: set the buckets and their range, call accumulate() for each piece of data
+        ///(or merge() other histograms that were started with the same buckets and range), then finishAccumulating()
+        void startAccumulating(const int& numBuckets, const float& bucketMin, const float& bucketMax);
+        
+        ///add data to the counts, values outside the range go into the end buckets
+        void accumulate(const float* data, const int64_t& dataCount);
+        
+        ///add the counts of another histogram with the same buckets and range
+        void merge(const Histogram& other);
+        
+        ///compute cumulative and display values from the counts
+        void finishAccumulating();
+        
         ///get raw counts (useful mathematically)
         const std::vector<int64_t>& getHistogramCounts() const { return m_buckets; }
         
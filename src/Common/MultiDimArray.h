@@ -22,6 +22,7 @@
 /*LICENSE_END*/
 
 #include "CaretAssert.h"
+#include "CaretOMP.h"
 
 #include "stdint.h"
 #include <vector>
@@ -33,7 +34,7 @@ namespace caret
     class MultiDimArray
     {
         std::vector<int64_t> m_dims, m_skip;//always use int64_t for indexes internally
-        std::vector<T> m_data;
+        std::vector<T, CaretFirstTouchAllocator<T> > m_data;//in-memory cifti can be huge, let each thread place its part
         template<typename I>
         int64_t index(const int& fullDims, const std::vector<I>& indexSelect) const;//assume we never need over 2 billion dimensions
     public:
@@ -68,7 +69,9 @@ namespace caret
             m_skip[i] = numElems;
             numElems *= m_dims[i];
         }
+        const int64_t oldSize = (int64_t)m_data.size();
         m_data.resize(numElems);
+        if (numElems > oldSize) CaretOMP::firstTouch(m_data.data() + oldSize, numElems - oldSize, T());
     }
     
     template<typename T>
@@ -21,10 +21,12 @@
 #include "ReductionOperation.h"
 #include "CaretAssert.h"
 #include "CaretException.h"
+#include "CaretOMP.h"
 #include "MathFunctions.h"
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <limits>
 #include <vector>
 
@@ -32,6 +34,12 @@ using namespace caret;
 using namespace std;
 
 float ReductionOperation::reduce(const float* data, const int64_t& numElems, const ReductionEnum::Enum& type)
+{
+    Scratch scratch;
+    return reduce(data, numElems, type, scratch);
+}
+
+float ReductionOperation::reduce(const float* data, const int64_t& numElems, const ReductionEnum::Enum& type, Scratch& scratch)
 {
     CaretAssert(numElems > 0);
     switch (type)
@@ -138,45 +146,11 @@ float ReductionOperation::reduce(const float* data, const int64_t& numElems, con
         }
         case ReductionEnum::MEDIAN:
         {
-            vector<float> dataCopy(numElems);
-            for (int64_t i = 0; i < numElems; ++i) dataCopy[i] = data[i];
-            sort(dataCopy.begin(), dataCopy.end());
-            if ((numElems & 1) == 0)//if even, average middle two
-            {
-                return (dataCopy[numElems / 2 - 1] + dataCopy[numElems / 2]) / 2.0f;
-            } else {
-                return dataCopy[numElems / 2];//otherwise, take the center
-            }
+            scratch.m_values.assign(data, data + numElems);
+            return selectMedian(scratch.m_values.data(), numElems);
         }
         case ReductionEnum::MODE:
-        {
-            vector<float> dataCopy(numElems);
-            for (int64_t i = 0; i < numElems; ++i) dataCopy[i] = data[i];
-            sort(dataCopy.begin(), dataCopy.end());//sort to put same-value next to each other, a hash based map could be faster for large arrays, but oh well
-            int bestCount = 0, curCount = 1;
-            float bestval = -1.0f, curval = dataCopy[0];
-            for (int64_t i = 1; i < numElems; ++i)//search for largest contiguous region
-            {
-                if (dataCopy[i] == curval)
-                {
-                    ++curCount;
-                } else {
-                    if (curCount > bestCount)
-                    {
-                        bestval = curval;
-                        bestCount = curCount;
-                    }
-                    curval = dataCopy[i];
-                    curCount = 1;
-                }
-            }
-            if (curCount > bestCount)
-            {
-                bestval = curval;
-                bestCount = curCount;
-            }
-            return bestval;
-        }
+            return hashMode(data, numElems, scratch);
         case ReductionEnum::COUNT_NONZERO:
         {
             int64_t count = 0;
@@ -269,6 +243,12 @@ float ReductionOperation::reduceExcludeDev(const float* data, const int64_t& num
 }
 
 float ReductionOperation::reduceOnlyNumeric(const float* data, const int64_t& numElems, const ReductionEnum::Enum& type)
+{
+    Scratch scratch;
+    return reduceOnlyNumeric(data, numElems, type, scratch);
+}
+
+float ReductionOperation::reduceOnlyNumeric(const float* data, const int64_t& numElems, const ReductionEnum::Enum& type, Scratch& scratch)
 {
     CaretAssert(numElems > 0);
     switch (type)//special case things that use indices
@@ -310,35 +290,24 @@ float ReductionOperation::reduceOnlyNumeric(const float* data, const int64_t& nu
         default:
             break;
     }
-    vector<float> excluded;
-    excluded.reserve(numElems);
+    vector<float>& excluded = scratch.m_numeric;//separate from the buffer reduce() uses
+    excluded.clear();
     for (int64_t i = 0; i < numElems; ++i)
     {
         if (MathFunctions::isNumeric(data[i])) excluded.push_back(data[i]);
     }
     if (excluded.size() < 1) throw CaretException("all input values to reduceOnlyNumeric were non-numeric");
     if (type == ReductionEnum::SAMPSTDEV && excluded.size() < 2) throw CaretException("SAMPSTDEV requested in reduceOnlyNumeric when only 1 element is numeric");
-    return reduce(excluded.data(), excluded.size(), type);
+    return reduce(excluded.data(), excluded.size(), type, scratch);
 }
 
-namespace
+float ReductionOperation::reduceWeighted(const float* data, const float* weights, const int64_t& numElems, const ReductionEnum::Enum& type)
 {
-    struct ValWeight
-    {//for sorting based only on value, but keeping weight associated
-        float value, weight;
-        ValWeight(float v, float w)
-        {
-            value = v;
-            weight = w;
-        }
-        inline bool operator<(const ValWeight& rhs) const
-        {
-            return value < rhs.value;
-        }
-    };
+    Scratch scratch;
+    return reduceWeighted(data, weights, numElems, type, scratch);
 }
 
-float ReductionOperation::reduceWeighted(const float* data, const float* weights, const int64_t& numElems, const ReductionEnum::Enum& type)
+float ReductionOperation::reduceWeighted(const float* data, const float* weights, const int64_t& numElems, const ReductionEnum::Enum& type, Scratch& scratch)
 {
     CaretAssert(numElems > 0);
     switch (type)
@@ -404,68 +373,29 @@ float ReductionOperation::reduceWeighted(const float* data, const float* weights
         }
         case ReductionEnum::MEDIAN:
         {
-            vector<ValWeight> toSort;
-            toSort.reserve(numElems);
-            for (int i = 0; i < numElems; ++i)
-            {
-                toSort.push_back(ValWeight(data[i], weights[i]));
-            }
-            stable_sort(toSort.begin(), toSort.end());
-            vector<double> weightaccum(numElems);
-            weightaccum[0] = toSort[0].weight;
-            for (int i = 1; i < numElems; ++i)
+            scratch.m_valueWeights.resize(numElems);
+            for (int64_t i = 0; i < numElems; ++i)
             {
-                weightaccum[i] = weightaccum[i - 1] + toSort[i].weight;
-            }
-            double target = weightaccum.back() / 2;
-            int64_t index = (int64_t)(lower_bound(weightaccum.begin(), weightaccum.end(), target) - weightaccum.begin());
-            if (index == numElems) --index;//deal with edge cases from things like negative weights
-            if (numElems > 1 && index < (numElems - 1) && weightaccum[index] == target)//only average on exact equals, according to https://en.wikipedia.org/wiki/Weighted_median
-            {//could instead always interpolate
-                return (toSort[index].value + toSort[index + 1].value) / 2;
-            } else {
-                return toSort[index].value;
+                scratch.m_valueWeights[i].value = data[i];
+                scratch.m_valueWeights[i].weight = weights[i];
+                scratch.m_valueWeights[i].index = i;
             }
+            return weightedSelectMedian(scratch.m_valueWeights.data(), numElems);
         }
         case ReductionEnum::MODE:
-        {
-            vector<ValWeight> toSort;
-            toSort.reserve(numElems);
-            for (int i = 0; i < numElems; ++i)
-            {
-                toSort.push_back(ValWeight(data[i], weights[i]));
-            }
-            stable_sort(toSort.begin(), toSort.end());
-            float bestweight = -numeric_limits<float>::infinity(), curweight = toSort[0].weight;
-            float bestval = toSort[0].value, curval = toSort[0].value;
-            for (int i = 1; i < numElems; ++i)
-            {
-                if (toSort[i].value == curval)
-                {
-                    curweight += toSort[i].weight;
-                } else {
-                    if (curweight > bestweight)
-                    {
-                        bestval = curval;
-                        bestweight = curweight;
-                    }
-                    curval = toSort[i].value;
-                    curweight = toSort[i].weight;
-                }
-            }
-            if (curweight > bestweight)
-            {
-                bestval = curval;
-                bestweight = curweight;
-            }
-            return bestval;
-        }
+            return weightedHashMode(data, weights, numElems, scratch);
     }
     CaretAssertMessage(false, "unhandled reduction type");
     return 0.0f;
 }
 
 float ReductionOperation::reduceWeightedOnlyNumeric(const float* data, const float* weights, const int64_t& numElems, const ReductionEnum::Enum& type)
+{
+    Scratch scratch;
+    return reduceWeightedOnlyNumeric(data, weights, numElems, type, scratch);
+}
+
+float ReductionOperation::reduceWeightedOnlyNumeric(const float* data, const float* weights, const int64_t& numElems, const ReductionEnum::Enum& type, Scratch& scratch)
 {
     CaretAssert(numElems > 0);
     switch (type)
@@ -482,9 +412,9 @@ float ReductionOperation::reduceWeightedOnlyNumeric(const float* data, const flo
         default:
             break;
     }
-    vector<float> excluded, exweights;
-    excluded.reserve(numElems);
-    exweights.reserve(numElems);
+    vector<float>& excluded = scratch.m_numeric, &exweights = scratch.m_numericWeights;
+    excluded.clear();
+    exweights.clear();
     for (int64_t i = 0; i < numElems; ++i)
     {
         if (MathFunctions::isNumeric(data[i]))
@@ -495,7 +425,7 @@ float ReductionOperation::reduceWeightedOnlyNumeric(const float* data, const flo
     }
     if (excluded.size() < 1) throw CaretException("all input values to reduceWeightedOnlyNumeric were non-numeric");
     if (type == ReductionEnum::SAMPSTDEV && excluded.size() < 2) throw CaretException("SAMPSTDEV requested in reduceWeightedOnlyNumeric when only 1 element is numeric");
-    return reduceWeighted(excluded.data(), exweights.data(), excluded.size(), type);
+    return reduceWeighted(excluded.data(), exweights.data(), excluded.size(), type, scratch);
 }
 
 float ReductionOperation::reduceWeightedExcludeDev(const float* data, const float* weights, const int64_t& numElems, const ReductionEnum::Enum& type, const float& numDevBelow, const float& numDevAbove)
@@ -554,6 +484,283 @@ float ReductionOperation::reduceWeightedExcludeDev(const float* data, const floa
     return reduceWeighted(excluded.data(), exweights.data(), excluded.size(), type);
 }
 
+void ReductionOperation::reduceRows(const float* data, const int64_t& numRows, const int64_t& rowLength, const ReductionEnum::Enum& type, float* resultsOut, const bool& onlyNumeric)
+{
+    CaretAssert(rowLength > 0);
+    if (numRows < 1) return;
+    bool failed = false;
+    CaretException failure;
+#pragma omp CARET_PAR
+    {
+        Scratch scratch;//one per thread, reused for every row
+#pragma omp CARET_FOR schedule(dynamic, 64)
+        for (int64_t row = 0; row < numRows; ++row)
+        {
+            try
+            {
+                if (onlyNumeric)
+                {
+                    resultsOut[row] = reduceOnlyNumeric(data + row * rowLength, rowLength, type, scratch);
+                } else {
+                    resultsOut[row] = reduce(data + row * rowLength, rowLength, type, scratch);
+                }
+            } catch (CaretException& e) {//can't throw out of an openmp region
+#pragma omp critical
+                {
+                    if (!failed)
+                    {
+                        failed = true;
+                        failure = e;
+                    }
+                }
+            }
+        }
+    }
+    if (failed) throw failure;
+}
+
+float ReductionOperation::percentile(const float* data, const int64_t& numElems, const float& percent)
+{
+    Scratch scratch;
+    return percentile(data, numElems, percent, scratch);
+}
+
+float ReductionOperation::percentile(const float* data, const int64_t& numElems, const float& percent, Scratch& scratch)
+{
+    CaretAssert(numElems > 0);
+    scratch.m_values.assign(data, data + numElems);
+    return selectPercentile(scratch.m_values.data(), numElems, percent);
+}
+
+float ReductionOperation::selectMedian(float* values, const int64_t& numElems)
+{//nth_element puts the order statistic in place with everything smaller before it, so the lower middle of an even count is the max of the lower half
+    const int64_t half = numElems / 2;
+    nth_element(values, values + half, values + numElems);
+    if ((numElems & 1) == 0)//if even, average middle two
+    {
+        return (*max_element(values, values + half) + values[half]) / 2.0f;
+    } else {
+        return values[half];//otherwise, take the center
+    }
+}
+
+float ReductionOperation::selectPercentile(float* values, const int64_t& numElems, const float& percent)
+{
+    CaretAssert(percent >= 0.0f && percent <= 100.0f);
+    const double index = percent / 100.0 * (numElems - 1);//float can't hold large element indices exactly
+    if (index <= 0) return *min_element(values, values + numElems);
+    if (index >= numElems - 1) return *max_element(values, values + numElems);
+    double ipart, fpart;
+    fpart = modf(index, &ipart);
+    const int64_t lowIndex = (int64_t)ipart;
+    nth_element(values, values + lowIndex, values + numElems);
+    const double lowValue = values[lowIndex], highValue = *min_element(values + lowIndex + 1, values + numElems);
+    return (float)((1.0 - fpart) * lowValue + fpart * highValue);
+}
+
+namespace
+{
+    int64_t hashTableSize(const int64_t& numElems, int& bitsOut)
+    {//at most half full, so probe sequences stay short
+        int64_t ret = 2;
+        bitsOut = 1;
+        while (ret < 2 * numElems)
+        {
+            ret <<= 1;
+            ++bitsOut;
+        }
+        return ret;
+    }
+    
+    inline uint32_t hashKey(const float& value)
+    {
+        float canonical = value;
+        if (canonical == 0.0f) canonical = 0.0f;//-0 compares equal to 0, so count them together
+        uint32_t ret;
+        memcpy(&ret, &canonical, sizeof(float));
+        return ret;
+    }
+    
+    inline int64_t hashSlot(const uint32_t& key, const int& bits)
+    {
+        return (int64_t)((key * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+    }
+}
+
+float ReductionOperation::hashMode(const float* data, const int64_t& numElems, Scratch& scratch)
+{
+    int bits;
+    const int64_t tableSize = hashTableSize(numElems, bits), mask = tableSize - 1;
+    scratch.m_hashKeys.resize(tableSize);
+    scratch.m_hashCounts.assign(tableSize, 0);//count of 0 marks an empty slot
+    for (int64_t i = 0; i < numElems; ++i)
+    {
+        const uint32_t key = hashKey(data[i]);
+        int64_t slot = hashSlot(key, bits);
+        while (scratch.m_hashCounts[slot] != 0 && scratch.m_hashKeys[slot] != key) slot = (slot + 1) & mask;
+        scratch.m_hashKeys[slot] = key;
+        ++scratch.m_hashCounts[slot];
+    }
+    int64_t bestCount = 0;
+    float bestval = -1.0f;
+    for (int64_t slot = 0; slot < tableSize; ++slot)
+    {
+        const int64_t count = scratch.m_hashCounts[slot];
+        if (count == 0) continue;
+        float value;
+        memcpy(&value, &(scratch.m_hashKeys[slot]), sizeof(float));
+        if (count > bestCount || (count == bestCount && value < bestval))//ties go to the lowest value, as with searching sorted values
+        {
+            bestCount = count;
+            bestval = value;
+        }
+    }
+    return bestval;
+}
+
+float ReductionOperation::weightedHashMode(const float* data, const float* weights, const int64_t& numElems, Scratch& scratch)
+{
+    int bits;
+    const int64_t tableSize = hashTableSize(numElems, bits), mask = tableSize - 1;
+    scratch.m_hashKeys.resize(tableSize);
+    scratch.m_hashWeights.resize(tableSize);
+    scratch.m_hashCounts.assign(tableSize, 0);
+    for (int64_t i = 0; i < numElems; ++i)
+    {//weights are summed in input order, same as the stable sort method did
+        const uint32_t key = hashKey(data[i]);
+        int64_t slot = hashSlot(key, bits);
+        while (scratch.m_hashCounts[slot] != 0 && scratch.m_hashKeys[slot] != key) slot = (slot + 1) & mask;
+        if (scratch.m_hashCounts[slot] == 0)
+        {
+            scratch.m_hashKeys[slot] = key;
+            scratch.m_hashWeights[slot] = weights[i];
+        } else {
+            scratch.m_hashWeights[slot] += weights[i];
+        }
+        ++scratch.m_hashCounts[slot];
+    }
+    bool first = true;
+    float bestweight = 0.0f, bestval = 0.0f;
+    for (int64_t slot = 0; slot < tableSize; ++slot)
+    {
+        if (scratch.m_hashCounts[slot] == 0) continue;
+        const float weight = scratch.m_hashWeights[slot];
+        float value;
+        memcpy(&value, &(scratch.m_hashKeys[slot]), sizeof(float));
+        if (first || weight > bestweight || (weight == bestweight && value < bestval))
+        {
+            first = false;
+            bestweight = weight;
+            bestval = value;
+        }
+    }
+    return bestval;
+}
+
+float ReductionOperation::weightedSortMedian(Scratch::ValueWeight* items, const int64_t& numElems)
+{
+    stable_sort(items, items + numElems, [](const Scratch::ValueWeight& lhs, const Scratch::ValueWeight& rhs) { return lhs.value < rhs.value; });
+    vector<double> weightaccum(numElems);
+    weightaccum[0] = items[0].weight;
+    for (int64_t i = 1; i < numElems; ++i)
+    {
+        weightaccum[i] = weightaccum[i - 1] + items[i].weight;
+    }
+    double target = weightaccum.back() / 2;
+    int64_t index = (int64_t)(lower_bound(weightaccum.begin(), weightaccum.end(), target) - weightaccum.begin());
+    if (index == numElems) --index;//deal with edge cases from things like negative weights
+    if (numElems > 1 && index < (numElems - 1) && weightaccum[index] == target)//only average on exact equals, according to https://en.wikipedia.org/wiki/Weighted_median
+    {//could instead always interpolate
+        return (items[index].value + items[index + 1].value) / 2;
+    } else {
+        return items[index].value;
+    }
+}
+
+float ReductionOperation::weightedSelectMedian(Scratch::ValueWeight* items, const int64_t& numElems)
+{//weighted quickselect: find the first value in sorted order whose cumulative weight reaches half the total, without sorting
+    double total = 0.0;
+    for (int64_t i = 0; i < numElems; ++i)
+    {
+        if (items[i].weight < 0.0f) return weightedSortMedian(items, numElems);//cumulative weight isn't monotonic, so keep the old behavior
+        total += items[i].weight;
+    }
+    const double target = total / 2;
+    int64_t lo = 0, hi = numElems;//the answer is in [lo, hi)
+    double below = 0.0;//total weight of the elements that sort before lo
+    float nextValue = 0.0f;//smallest value at or after hi, valid when hi < numElems
+    while (hi - lo > 16)
+    {
+        float a = items[lo].value, b = items[lo + (hi - lo) / 2].value, c = items[hi - 1].value;
+        float pivot = max(min(a, b), min(max(a, b), c));//median of three
+        int64_t lt = lo, i = lo, gt = hi;//three-way partition: [lo, lt) < pivot, [lt, gt) == pivot, [gt, hi) > pivot
+        double lessWeight = 0.0, equalWeight = 0.0;
+        while (i < gt)
+        {
+            if (items[i].value < pivot)
+            {
+                lessWeight += items[i].weight;
+                swap(items[i], items[lt]);
+                ++lt;
+                ++i;
+            } else if (items[i].value > pivot) {
+                --gt;
+                swap(items[i], items[gt]);
+            } else {
+                equalWeight += items[i].weight;
+                ++i;
+            }
+        }
+        if (lt > lo && below + lessWeight >= target)
+        {
+            hi = lt;
+            nextValue = pivot;
+            continue;
+        }
+        if (below + lessWeight + equalWeight >= target || gt == hi)
+        {//put the values equal to the pivot in their original order, so zero weights are handled like a stable sort would
+            sort(items + lt, items + gt, [](const Scratch::ValueWeight& lhs, const Scratch::ValueWeight& rhs) { return lhs.index < rhs.index; });
+            double accum = below + lessWeight;
+            int64_t index = lt;
+            for (; index < gt; ++index)
+            {
+                accum += items[index].weight;
+                if (accum >= target) break;
+            }
+            if (index == gt - 1 && accum == target && gt < numElems)//only average on exact equals, as below
+            {
+                float next = nextValue;
+                if (gt < hi) next = min_element(items + gt, items + hi, [](const Scratch::ValueWeight& lhs, const Scratch::ValueWeight& rhs) { return lhs.value < rhs.value; })->value;
+                return (pivot + next) / 2;
+            }
+            return pivot;
+        }
+        below += lessWeight + equalWeight;
+        lo = gt;
+    }
+    for (int64_t i = lo + 1; i < hi; ++i)
+    {//insertion sort doesn't allocate, the partitioning above reordered ties, so also compare original index
+        Scratch::ValueWeight temp = items[i];
+        int64_t j = i;
+        for (; j > lo && (temp.value < items[j - 1].value || (temp.value == items[j - 1].value && temp.index < items[j - 1].index)); --j) items[j] = items[j - 1];
+        items[j] = temp;
+    }
+    double accum = below;
+    for (int64_t index = lo; index < hi; ++index)
+    {
+        accum += items[index].weight;
+        if (accum >= target)
+        {
+            if (accum == target && index < numElems - 1)//only average on exact equals, as above
+            {
+                return (items[index].value + (index + 1 < hi ? items[index + 1].value : nextValue)) / 2;
+            }
+            return items[index].value;
+        }
+    }
+    return items[hi - 1].value;//rounding error, the target is at the end
+}
+
 bool ReductionOperation::isLengthOneReasonable(const ReductionEnum::Enum& type)
 {
     switch(type)
@@ -24,11 +24,29 @@
 #include "AString.h"
 #include "ReductionEnum.h"
 
+#include <stdint.h>
+#include <vector>
+
 namespace caret {
     
     class ReductionOperation
     {
     public:
+        ///reusable memory for reductions that need to copy or reorder the data (MEDIAN, MODE, percentiles)
+        ///use one per thread, so that reducing many sets of values doesn't allocate on every call
+        class Scratch
+        {
+            struct ValueWeight
+            {
+                float value, weight;
+                int64_t index;//to break ties the same way a stable sort would
+            };
+            std::vector<float> m_values, m_numeric, m_numericWeights, m_hashWeights;
+            std::vector<ValueWeight> m_valueWeights;
+            std::vector<uint32_t> m_hashKeys;
+            std::vector<int64_t> m_hashCounts;
+            friend class ReductionOperation;
+        };
         static float reduce(const float* data, const int64_t& numElems, const ReductionEnum::Enum& type);
         ///reduce, with exclusion based on number of standard deviations
         static float reduceExcludeDev(const float* data, const int64_t& numElems, const ReductionEnum::Enum& type, const float& numDevBelow, const float& numDevAbove);
@@ -37,8 +55,25 @@ namespace caret {
         static float reduceWeighted(const float* data, const float* weights, const int64_t& numElems, const ReductionEnum::Enum& type);
         static float reduceWeightedExcludeDev(const float* data, const float* weights, const int64_t& numElems, const ReductionEnum::Enum& type, const float& numDevBelow, const float& numDevAbove);
         static float reduceWeightedOnlyNumeric(const float* data, const float* weights, const int64_t& numElems, const ReductionEnum::Enum& type);
+        ///versions that use the provided scratch memory instead of allocating
+        static float reduce(const float* data, const int64_t& numElems, const ReductionEnum::Enum& type, Scratch& scratch);
+        static float reduceOnlyNumeric(const float* data, const int64_t& numElems, const ReductionEnum::Enum& type, Scratch& scratch);
+        static float reduceWeighted(const float* data, const float* weights, const int64_t& numElems, const ReductionEnum::Enum& type, Scratch& scratch);
+        static float reduceWeightedOnlyNumeric(const float* data, const float* weights, const int64_t& numElems, const ReductionEnum::Enum& type, Scratch& scratch);
+        ///reduce each of numRows contiguous rows of rowLength values, multithreaded with one scratch per thread
+        static void reduceRows(const float* data, const int64_t& numRows, const int64_t& rowLength, const ReductionEnum::Enum& type, float* resultsOut, const bool& onlyNumeric = false);
+        ///value at a percentile (0 to 100), interpolating between the closest two values, without sorting
+        static float percentile(const float* data, const int64_t& numElems, const float& percent);
+        static float percentile(const float* data, const int64_t& numElems, const float& percent, Scratch& scratch);
         static bool isLengthOneReasonable(const ReductionEnum::Enum& type);
         static AString getHelpInfo();
+    private:
+        static float selectMedian(float* values, const int64_t& numElems);
+        static float selectPercentile(float* values, const int64_t& numElems, const float& percent);
+        static float hashMode(const float* data, const int64_t& numElems, Scratch& scratch);
+        static float weightedSelectMedian(Scratch::ValueWeight* items, const int64_t& numElems);
+        static float weightedSortMedian(Scratch::ValueWeight* items, const int64_t& numElems);
+        static float weightedHashMode(const float* data, const float* weights, const int64_t& numElems, Scratch& scratch);
     };
     
 }
@@ -0,0 +1,45 @@
+#ifndef __STATISTICS_BLOCK_SOURCE_H__
+#define __STATISTICS_BLOCK_SOURCE_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <vector>
+#include "stdint.h"
+
+namespace caret
+{
+    
+    ///interface for data that is too large to have in memory all at once, so that FastStatistics and Histogram can read it in blocks
+    class StatisticsBlockSource
+    {
+    public:
+        virtual ~StatisticsBlockSource() { }
+        
+        ///number of blocks in the data
+        virtual int64_t getNumberOfBlocks() const = 0;
+        
+        ///replace the contents of dataOut with the block, blocks may be requested more than once, but only from one thread at a time
+        virtual void getBlock(const int64_t& blockIndex, std::vector<float>& dataOut) const = 0;
+    };
+    
+}
+
+#endif //__STATISTICS_BLOCK_SOURCE_H__
@@ -18,6 +18,7 @@
  */
 /*LICENSE_END*/
 
+#include <algorithm>
 #include <limits>
 #include <set>
 
@@ -66,11 +67,65 @@
 #include "NodeAndVoxelColoring.h"
 #include "PaletteColorMapping.h"
 #include "SparseVolumeIndexer.h"
+#include "StatisticsBlockSource.h"
 #include "VolumeGraphicsPrimitiveManager.h"
 
 using namespace caret;
 
-
+namespace {
+    /**
+     * Provides a CIFTI file's data in blocks of rows so that statistics
+     * for all of the file's data do not require all of the data in memory.
+     */
+    class CiftiRowBlockSource : public StatisticsBlockSource {
+    public:
+        CiftiRowBlockSource(const CiftiFile* ciftiFile)
+        : m_ciftiFile(ciftiFile) {
+            CaretAssert(m_ciftiFile);
+            m_numberOfRows    = m_ciftiFile->getNumberOfRows();
+            m_numberOfColumns = m_ciftiFile->getNumberOfColumns();
+            
+            /* about 64MB of data per block */
+            const int64_t maximumBlockElements = 16 * 1024 * 1024;
+            m_rowsPerBlock = std::max(static_cast<int64_t>(1),
+                                      maximumBlockElements / std::max(static_cast<int64_t>(1), m_numberOfColumns));
+        }
+        
+        int64_t getNumberOfBlocks() const override {
+            if ((m_numberOfRows <= 0)
+                || (m_numberOfColumns <= 0)) {
+                return 0;
+            }
+            return ((m_numberOfRows + m_rowsPerBlock - 1) / m_rowsPerBlock);
+        }
+        
+        void getBlock(const int64_t& blockIndex,
+                      std::vector<float>& dataOut) const override {
+            const int64_t firstRow = blockIndex * m_rowsPerBlock;
+            const int64_t numRows  = std::min(m_rowsPerBlock,
+                                              m_numberOfRows - firstRow);
+            dataOut.resize(numRows * m_numberOfColumns);
+            for (int64_t iRow = 0; iRow < numRows; iRow++) {
+                m_ciftiFile->getRow(&dataOut[iRow * m_numberOfColumns],
+                                    firstRow + iRow);
+            }
+        }
+        
+        /** @return Number of elements in the file */
+        int64_t getNumberOfElements() const {
+            return (m_numberOfRows * m_numberOfColumns);
+        }
+        
+    private:
+        const CiftiFile* m_ciftiFile;
+        
+        int64_t m_numberOfRows;
+        
+        int64_t m_numberOfColumns;
+        
+        int64_t m_rowsPerBlock;
+    };
+}
     
 /**
  * \class caret::CiftiMappableDataFile 
@@ -2753,12 +2808,14 @@ const FastStatistics*
 CiftiMappableDataFile::getFileFastStatistics()
 {
     if (m_fileFastStatistics == NULL) {
-        std::vector<float> fileData;
-        getFileData(fileData);
-        if ( ! fileData.empty()) {
+        /*
+         * Rows are read in blocks, so the file's data is never all in memory
+         */
+        CaretAssert(m_ciftiFile);
+        const CiftiRowBlockSource blockSource(m_ciftiFile);
+        if (blockSource.getNumberOfElements() > 0) {
             m_fileFastStatistics.grabNew(new FastStatistics());
-            m_fileFastStatistics->update(&fileData[0],
-                                         fileData.size());
+            m_fileFastStatistics->update(blockSource);
         }
     }
     
@@ -2788,16 +2845,14 @@ CiftiMappableDataFile::getFileHistogram()
         updateHistogramFlag = true;
     }
     if (updateHistogramFlag) {
-        std::vector<float> fileData;
-        getFileData(fileData);
-        
-        if ( ! fileData.empty()) {
+        CaretAssert(m_ciftiFile);
+        const CiftiRowBlockSource blockSource(m_ciftiFile);
+        if (blockSource.getNumberOfElements() > 0) {
             if (m_fileHistogram == NULL) {
                 m_fileHistogram.grabNew(new Histogram(numberOfBuckets));
             }
             m_fileHistogram->update(numberOfBuckets,
-                                    &fileData[0],
-                                    fileData.size());
+                                    blockSource);
             m_fileHistogramNumberOfBuckets = numberOfBuckets;
         }
     }
@@ -2847,15 +2902,14 @@ CiftiMappableDataFile::getFileHistogram(const float mostPositiveValueInclusive,
     }
     
     if (updateHistogramFlag) {
-        std::vector<float> fileData;
-        getFileData(fileData);
-        if ( ! fileData.empty()) {
+        CaretAssert(m_ciftiFile);
+        const CiftiRowBlockSource blockSource(m_ciftiFile);
+        if (blockSource.getNumberOfElements() > 0) {
             if (m_fileHistorgramLimitedValues == NULL) {
                 m_fileHistorgramLimitedValues.grabNew(new Histogram());
             }
             m_fileHistorgramLimitedValues->update(numberOfBuckets,
-                                                  &fileData[0],
-                                                  fileData.size(),
+                                                  blockSource,
                                                   mostPositiveValueInclusive,
                                                   leastPositiveValueInclusive,
                                                   leastNegativeValueInclusive,
@@ -29,14 +29,17 @@
 
 #include <QImage>
 #include <QImageWriter>
+#include <QThread>
 
 #include "BackgroundAndForegroundColors.h"
 #include "BoundingBox.h"
 #include "CaretAssert.h"
 #include "CaretLogger.h"
+#include "CaretMutex.h"
 #include "CaretPreferences.h"
 #include "CziImage.h"
 #include "CziImageLoaderMultiResolution.h"
+#include "CziImageTileCache.h"
 #include "CziUtilities.h"
 #include "DataFileContentInformation.h"
 #include "DataFileException.h"
@@ -65,6 +68,32 @@ using namespace caret;
 
 static bool cziDebugFlag(false);
 
+namespace {
+    /*
+     * The libCZI file stream seeks and then reads so it cannot be
+     * shared by threads.  This stream serializes the reads so that
+     * tiles can be decoded by more than one thread.
+     */
+    class LockingStream : public libCZI::IStream {
+    public:
+        LockingStream(const std::shared_ptr<libCZI::IStream>& stream)
+        : m_stream(stream) { }
+        
+        virtual void Read(std::uint64_t offset,
+                          void* pv,
+                          std::uint64_t size,
+                          std::uint64_t* ptrBytesRead) override {
+            CaretMutexLocker locker(&m_mutex);
+            m_stream->Read(offset, pv, size, ptrBytesRead);
+        }
+        
+    private:
+        std::shared_ptr<libCZI::IStream> m_stream;
+        
+        CaretMutex m_mutex;
+    };
+}
+
 /**
  * \class caret::CziImageFile
  * \brief A Zeiss CZI image file
@@ -100,6 +129,11 @@ CziImageFile::CziImageFile()
 CziImageFile::~CziImageFile()
 {
     EventManager::get()->removeAllEventsFromListener(this);
+    
+    /*
+     * Wait for tiles that are decoding before the reader is destroyed
+     */
+    m_tileCache.reset();
 }
 
 /**
@@ -112,6 +146,8 @@ CziImageFile::resetPrivate()
     
     m_errorMessage.clear();
     
+    m_tileCache.reset();
+    
     EventCaretPreferencesGet prefsEvent;
     EventManager::get()->sendEvent(prefsEvent.getPointer());
     CaretPreferences* prefs = prefsEvent.getCaretPreferences();
@@ -343,12 +379,13 @@ CziImageFile::readFile(const AString& filename)
         /*
          * If file does not exist, a std::exception is thrown
          */
-        m_stream = libCZI::CreateStreamFromFile(filename.toStdWString().c_str());
-        if ( ! m_stream) {
+        std::shared_ptr<libCZI::IStream> fileStream(libCZI::CreateStreamFromFile(filename.toStdWString().c_str()));
+        if ( ! fileStream) {
             m_errorMessage = "Creating stream for reading CZI file failed.";
             m_status = Status::ERRORED;
             return;
         }
+        m_stream.reset(new LockingStream(fileStream));
         
         m_reader = libCZI::CreateCZIReader();
         if ( ! m_reader) {
@@ -429,6 +466,8 @@ CziImageFile::readFile(const AString& filename)
             return;
         }
         
+        m_tileCache.reset(new CziImageTileCache(this));
+        
         /*
          * File is now open
          */
@@ -858,12 +897,56 @@ CziImageFile::zoomToMatchPixelDimension(const QRectF& regionOfInterestToRead,
  *    Pointer to CziImage or NULL if there is an error.
  */
 CziImage*
+CziImageFile::readFromCziImageFile(const ImageDataFormat imageDataFormat,
+                                   const AString& imageName,
+                                   const int32_t channelIndex,
+                                   const QRectF& regionOfInterest,
+                                   const QRectF& frameRegionOfInterest,
+                                   const int64_t outputImageWidthHeightMaximum,
+                                   AString& errorMessageOut)
+{
+    return readFromCziImageFile(imageDataFormat,
+                                imageName,
+                                channelIndex,
+                                regionOfInterest,
+                                frameRegionOfInterest,
+                                outputImageWidthHeightMaximum,
+                                getPreferencesImageBackgroundFloatRGB(),
+                                errorMessageOut);
+}
+
+/**
+ * Read the specified SCALED region from the CZI file into an image of the given width and height.
+ * Does not access preferences or send events so it may be called from threads
+ * other than the GUI thread (the stream serializes reading from the file).
+ * @param imageDataFormat
+ *     Format of image data QImage or CZI Bitmap data
+ * @param imageName
+ *     Name of image that may be used when debugging
+ * @param channelIndex
+ *    Index of channel.  Use Zero for all channels.  This parameter is ignored if there
+ *    is only one channel in the file.
+ * @param regionOfInterest
+ *    Region of interest to read from file.  Origin is in top left.
+ * @param frameRegionOfInterest
+ *    Region of interest of the frame or all frames
+ * @param outputImageWidthHeightMaximum
+ *    Maximum width and height of output image
+ * @param backgroundRGB
+ *    Background color for regions without image data
+ * @param errorMessageOut
+ *    Contains information about any errors
+ * @return
+ *    Pointer to CziImage or NULL if there is an error.
+ */
+CziImage*
 CziImageFile::readFromCziImageFile(const ImageDataFormat imageDataFormat,
                                    const AString& imageName,
                                    const int32_t channelIndex,
                                    const QRectF& regionOfInterestIn,
                                    const QRectF& frameRegionOfInterest,
                                    const int64_t outputImageWidthHeightMaximum,
+                                   const std::array<float, 3>& backgroundRGB,
                                    AString& errorMessageOut)
 {
     errorMessageOut.clear();
@@ -876,12 +959,17 @@ CziImageFile::readFromCziImageFile(const ImageDataFormat imageDataFormat,
     libCZI::CDimCoordinate coordinate;
     coordinate.Set(libCZI::DimensionIndex::C, 0);
     
-    const std::array<float, 3> prefBackRGB = getPreferencesImageBackgroundFloatRGB();
+    /*
+     * Sub-blocks are decoded by multiple threads (the stream serializes file reads)
+     */
+    const int maxDecodeThreads(std::max(1, QThread::idealThreadCount()));
+    
     libCZI::ISingleChannelScalingTileAccessor::Options scstaOptions;
     scstaOptions.Clear();
-    scstaOptions.backGroundColor.r = prefBackRGB[0];
-    scstaOptions.backGroundColor.g = prefBackRGB[1];
-    scstaOptions.backGroundColor.b = prefBackRGB[2];
+    scstaOptions.backGroundColor.r = backgroundRGB[0];
+    scstaOptions.backGroundColor.g = backgroundRGB[1];
+    scstaOptions.backGroundColor.b = backgroundRGB[2];
+    scstaOptions.maxDecodeThreads  = maxDecodeThreads;
     
     float zoomToRead(1.0);
     QRectF regionOfInterest(regionOfInterestIn);
@@ -951,6 +1039,10 @@ CziImageFile::readFromCziImageFile(const ImageDataFormat imageDataFormat,
         int index = 0;  /* index counting only the active channels */
         std::map<int, int> activeChNoToChIdx;   /* we need to keep track which 'active channels" corresponds to which channel index */
         
+        libCZI::ISingleChannelScalingTileAccessor::Options channelOptions;
+        channelOptions.Clear();
+        channelOptions.maxDecodeThreads = maxDecodeThreads;
+        
         libCZI::CDisplaySettingsHelper::EnumEnabledChannels(m_displaySettings.get(),
                                                             [&](int chIdx)->bool
                                                             {
@@ -958,7 +1050,7 @@ CziImageFile::readFromCziImageFile(const ImageDataFormat imageDataFormat,
             actvChBms.emplace_back(m_scalingTileAccessor->Get(intRectROI,
                                                               &planeCoord,
                                                               zoomToRead,
-                                                              nullptr));
+                                                              &channelOptions));
             activeChNoToChIdx[chIdx] = index++;
             return true;
         });
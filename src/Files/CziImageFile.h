@@ -54,6 +54,7 @@ namespace caret {
     class CziImage;
     class CziImageLoaderBase;
     class CziImageLoaderMultiResolution;
+    class CziImageTileCache;
     class GraphicsObjectToWindowTransform;
     class Matrix4x4;
     class RectangleTransform;
@@ -380,6 +381,15 @@ namespace caret {
                                        const int64_t outputImageWidthHeightMaximum,
                                        AString& errorMessageOut);
         
+        CziImage* readFromCziImageFile(const ImageDataFormat imageDataFormat,
+                                       const AString& imageName,
+                                       const int32_t channelIndex,
+                                       const QRectF& regionOfInterest,
+                                       const QRectF& frameRegionOfInterest,
+                                       const int64_t outputImageWidthHeightMaximum,
+                                       const std::array<float, 3>& backgroundRGB,
+                                       AString& errorMessageOut);
+        
         enum class QImagePixelFormat {
             RGB,
             RGBA
@@ -438,6 +448,9 @@ namespace caret {
         
         std::shared_ptr<libCZI::IDisplaySettings> m_displaySettings;
         
+        /** Cache of tiles read from the file; destroyed before the reader and accessors */
+        std::unique_ptr<CziImageTileCache> m_tileCache;
+        
         CziSceneInfo m_allFramesPyramidInfo;
         
         std::vector<CziSceneInfo> m_cziScenePyramidInfos;
@@ -470,6 +483,7 @@ namespace caret {
 
         friend class CziImage;
         friend class CziImageLoaderMultiResolution;
+        friend class CziImageTileCache;
         
     };
     
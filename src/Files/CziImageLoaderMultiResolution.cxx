@@ -24,6 +24,7 @@
 #undef __CZI_IMAGE_LOADER_MULTI_RESOLUTION_DECLARE__
 
 #include <algorithm>
+#include <cmath>
 
 #include "CaretAssert.h"
 #include "CaretLogger.h"
@@ -37,6 +38,12 @@
 using namespace caret;
 
 static const bool cziDebugFlag(false);
+
+/*
+ * Centers of tiles are on a grid with spacing of the pyramid layer's
+ * reading width/height divided by this value
+ */
+static const float tileGridDivisions(4.0f);
     
 /**
  * \class caret::CziImageLoaderMultiResolution
@@ -147,6 +154,13 @@ CziImageLoaderMultiResolution::updateImage(const CziImage* cziImage,
         m_reloadImageFlag  = true;
         m_frameChangedFlag = true;
         if (cziDebugFlag) std::cout << "Reload image due to frame change" << std::endl;
+        
+        /*
+         * Try again to read tiles that failed
+         */
+        if (m_cziImageFile->m_tileCache) {
+            m_cziImageFile->m_tileCache->clearFailedTiles();
+        }
     }
     if ((resolutionChangeMode != m_previousResolutionChangeMode)
         || (manualPyramidLayerIndex != m_previousManualPyramidLayerIndex)) {
@@ -164,6 +178,13 @@ CziImageLoaderMultiResolution::updateImage(const CziImage* cziImage,
         m_reloadImageFlag = true;
     }
     
+    if (m_waitingForTileFlag) {
+        /*
+         * Tile may have finished loading in the background
+         */
+        m_reloadImageFlag = true;
+    }
+    
     const CziImageFile::CziSceneInfo& cziSceneInfo = (allFramesFlag
                                                    ? m_cziImageFile->m_allFramesPyramidInfo
                                                    : m_cziImageFile->m_cziScenePyramidInfos[frameIndex]);
@@ -226,21 +247,16 @@ CziImageLoaderMultiResolution::updateImage(const CziImage* cziImage,
     }
     
     if (m_reloadImageFlag) {
-        CziImage* newImage(loadImageForPyrmaidLayer(cziImage,
-                                                    cziSceneInfo,
-                                                    transform,
-                                                    resolutionChangeMode,
-                                                    coordinateMode,
-                                                    channelIndex,
-                                                    zoomLayerIndex));
-        if (newImage != NULL) {
-            if (newImage != m_cziImage.get()) {
-                m_cziImage.reset(newImage);
-            }
-        }
-        else {
-            m_cziImage.reset();
-        }
+        /*
+         * Image may be shared with the file's tile cache and other tabs
+         */
+        m_cziImage = loadImageForPyrmaidLayer(cziImage,
+                                              cziSceneInfo,
+                                              transform,
+                                              resolutionChangeMode,
+                                              coordinateMode,
+                                              channelIndex,
+                                              zoomLayerIndex);
     }
     
     m_previousFrameIndex              = frameIndex;
@@ -261,6 +277,15 @@ void
 CziImageLoaderMultiResolution::forceImageReloading()
 {
     m_forceImageReloadFlag = true;
+    
+    /*
+     * Cached tiles may have been read with different preferences (background color)
+     */
+    if (m_cziImageFile != NULL) {
+        if (m_cziImageFile->m_tileCache) {
+            m_cziImageFile->m_tileCache->clear();
+        }
+    }
 }
 
 /**
@@ -750,7 +775,7 @@ CziImageLoaderMultiResolution::isReloadForPanZoom(const CziImage* cziImage,
  * @param pyramidLayerIndexIn
  *    Index of the pyramid layer
  */
-CziImage*
+std::shared_ptr<CziImage>
 CziImageLoaderMultiResolution::loadImageForPyrmaidLayer(const CziImage* oldCziImage,
                                                         const CziImageFile::CziSceneInfo& cziSceneInfo,
                                                         const GraphicsObjectToWindowTransform* transform,
@@ -759,7 +784,7 @@ CziImageLoaderMultiResolution::loadImageForPyrmaidLayer(const CziImage* oldCziIm
                                                         const int32_t channelIndex,
                                                         const int32_t pyramidLayerIndexIn)
 {
-    CziImage* cziImageOut(NULL);
+    std::shared_ptr<CziImage> cziImageOut;
     switch (coordinateMode) {
         case MediaDisplayCoordinateModeEnum::PIXEL:
             cziImageOut = loadImageForPyrmaidLayerForPixelCoords(oldCziImage,
@@ -798,7 +823,7 @@ CziImageLoaderMultiResolution::loadImageForPyrmaidLayer(const CziImage* oldCziIm
  * @param pyramidLayerIndexIn
  *    Index of the pyramid layer
  */
-CziImage*
+std::shared_ptr<CziImage>
 CziImageLoaderMultiResolution::loadImageForPyrmaidLayerForPixelCoords(const CziImage* oldCziImage,
                                                                       const CziImageFile::CziSceneInfo& cziSceneInfo,
                                                                       const GraphicsObjectToWindowTransform* transform,
@@ -852,26 +877,16 @@ CziImageLoaderMultiResolution::loadImageForPyrmaidLayerForPixelCoords(const CziI
     
     CaretAssert(rectToLoad.isValid());
     
+    /*
+     * Region read for the pyramid layer is centered on a grid so that
+     * small pans reuse the same cached tile
+     */
     CaretAssertVectorIndex(allPyramidLayers, pyramidLayerIndex);
-    const auto& selectedPyramidLayer(allPyramidLayers[pyramidLayerIndex]);
-    if ((selectedPyramidLayer.m_logicalWidthForImageReading == cziSceneInfo.m_logicalRectangle.width())
-        && (selectedPyramidLayer.m_logicalHeightForImageReading == cziSceneInfo.m_logicalRectangle.height())) {
-        rectToLoad = cziSceneInfo.m_logicalRectangle;
-        if (cziDebugFlag) std::cout << "Load full resolution" << std::endl;
-    }
-    else {
-        const float widthToLoad(selectedPyramidLayer.m_logicalWidthForImageReading);
-        const float heightToLoad(selectedPyramidLayer.m_logicalHeightForImageReading);
-        
-        const QPointF centerXY(rectToLoad.center());
-        const float rectX(centerXY.x() - (widthToLoad / 2.0));
-        const float rectY(centerXY.y() - (heightToLoad / 2.0));
-        if (cziDebugFlag) std::cout << "Rect to load before pyramid size: " << CziUtilities::qRectToString(rectToLoad) << std::endl;
-        rectToLoad.setRect(rectX, rectY, widthToLoad, heightToLoad);
-        if (cziDebugFlag) std::cout << "             after pyramid size: " << CziUtilities::qRectToString(rectToLoad) << std::endl;
-        rectToLoad = rectToLoad.intersected(cziSceneInfo.m_logicalRectangle);
-        if (cziDebugFlag) std::cout << "             after clip: " << CziUtilities::qRectToString(rectToLoad) << std::endl;
-    }
+    const CziImageTileCache::TileRequest tileRequest(createTileRequest(cziSceneInfo,
+                                                                       channelIndex,
+                                                                       pyramidLayerIndex,
+                                                                       rectToLoad.center()));
+    rectToLoad = tileRequest.m_logicalRect;
     
     const bool expandFlag(false);
     if (expandFlag) {
@@ -915,29 +930,25 @@ CziImageLoaderMultiResolution::loadImageForPyrmaidLayerForPixelCoords(const CziI
             /*
              * Continue using image
              */
-            return const_cast<CziImage*>(oldCziImage);
+            if (oldCziImage == m_cziImage.get()) {
+                m_waitingForTileFlag = false;
+                return m_cziImage;
+            }
         }
     }
     
     ElapsedTimer timer;
     timer.start();
     
-    const AString cziName(cziSceneInfo.getName()
-                          + " PyramidLayer="
-                          + AString::number(pyramidLayerIndex));
     if (cziDebugFlag) std::cout << "Loading pyramid index=" << pyramidLayerIndex << ", rect=" << CziUtilities::qRectToString(rectToLoad) << std::endl;
     AString errorMessage;
-    CziImage* cziImageOut = m_cziImageFile->readFromCziImageFile(s_imageDataFormatForReading,
-                                                                 cziName,
-                                                                 channelIndex,
-                                                                 rectToLoad,
-                                                                 cziSceneInfo.m_logicalRectangle,
-                                                                 m_cziImageFile->getPreferencesImageDimension(),
-                                                                 errorMessage);
+    std::shared_ptr<CziImage> cziImageOut(loadTile(tileRequest,
+                                                   cziSceneInfo,
+                                                   errorMessage));
     
     if (cziDebugFlag) std::cout << "Time to load CZI Image: (ms): " << timer.getElapsedTimeMilliseconds() << std::endl;
     
-    if (cziImageOut == NULL) {
+    if ( ! cziImageOut) {
         CaretLogSevere("Loading Pyramid level="
                        + AString::number(pyramidLayerIndex)
                        + " for frame(scene) index="
@@ -972,7 +983,7 @@ CziImageLoaderMultiResolution::loadImageForPyrmaidLayerForPixelCoords(const CziI
  * @param pyramidLayerIndexIn
  *    Index of the pyramid layer
  */
-CziImage*
+std::shared_ptr<CziImage>
 CziImageLoaderMultiResolution::loadImageForPyrmaidLayerForPlaneCoords(const CziImage* oldCziImage,
                                                                       const CziImageFile::CziSceneInfo& cziSceneInfo,
                                                                       const GraphicsObjectToWindowTransform* transform,
@@ -1030,26 +1041,16 @@ CziImageLoaderMultiResolution::loadImageForPyrmaidLayerForPlaneCoords(const CziI
      */
     QRectF logicalRectToLoad = m_cziImageFile->planeRectToLogicalRect(planeRectToLoad);
     
+    /*
+     * Region read for the pyramid layer is centered on a grid so that
+     * small pans reuse the same cached tile
+     */
     CaretAssertVectorIndex(allPyramidLayers, pyramidLayerIndex);
-    const auto& selectedPyramidLayer(allPyramidLayers[pyramidLayerIndex]);
-    if ((selectedPyramidLayer.m_logicalWidthForImageReading == cziSceneInfo.m_logicalRectangle.width())
-        && (selectedPyramidLayer.m_logicalHeightForImageReading == cziSceneInfo.m_logicalRectangle.height())) {
-        logicalRectToLoad = cziSceneInfo.m_logicalRectangle;
-        if (cziDebugFlag) std::cout << "Load full resolution" << std::endl;
-    }
-    else {
-        const float widthToLoad(selectedPyramidLayer.m_logicalWidthForImageReading);
-        const float heightToLoad(selectedPyramidLayer.m_logicalHeightForImageReading);
-        
-        const QPointF centerXY(logicalRectToLoad.center());
-        const float rectX(centerXY.x() - (widthToLoad / 2.0));
-        const float rectY(centerXY.y() - (heightToLoad / 2.0));
-        if (cziDebugFlag) std::cout << "Rect to load before pyramid size: " << CziUtilities::qRectToString(logicalRectToLoad) << std::endl;
-        logicalRectToLoad.setRect(rectX, rectY, widthToLoad, heightToLoad);
-        if (cziDebugFlag) std::cout << "             after pyramid size: " << CziUtilities::qRectToString(logicalRectToLoad) << std::endl;
-        logicalRectToLoad = logicalRectToLoad.intersected(cziSceneInfo.m_logicalRectangle);
-        if (cziDebugFlag) std::cout << "             after clip: " << CziUtilities::qRectToString(logicalRectToLoad) << std::endl;
-    }
+    const CziImageTileCache::TileRequest tileRequest(createTileRequest(cziSceneInfo,
+                                                                       channelIndex,
+                                                                       pyramidLayerIndex,
+                                                                       logicalRectToLoad.center()));
+    logicalRectToLoad = tileRequest.m_logicalRect;
     
     const bool expandFlag(false);
     if (expandFlag) {
@@ -1093,7 +1094,10 @@ CziImageLoaderMultiResolution::loadImageForPyrmaidLayerForPlaneCoords(const CziI
             /*
              * Continue using image
              */
-            return const_cast<CziImage*>(oldCziImage);
+            if (oldCziImage == m_cziImage.get()) {
+                m_waitingForTileFlag = false;
+                return m_cziImage;
+            }
         }
     }
     
@@ -1101,22 +1105,15 @@ CziImageLoaderMultiResolution::loadImageForPyrmaidLayerForPlaneCoords(const CziI
     timer.start();
     
     
-    const AString cziName(cziSceneInfo.getName()
-                          + " PyramidLayer="
-                          + AString::number(pyramidLayerIndex));
     if (cziDebugFlag) std::cout << "Loading pyramid index=" << pyramidLayerIndex << ", rect=" << CziUtilities::qRectToString(logicalRectToLoad) << std::endl;
     AString errorMessage;
-    CziImage* cziImageOut = m_cziImageFile->readFromCziImageFile(s_imageDataFormatForReading,
-                                                                 cziName,
-                                                                 channelIndex,
-                                                                 logicalRectToLoad,
-                                                                 cziSceneInfo.m_logicalRectangle,
-                                                                 m_cziImageFile->getPreferencesImageDimension(),
-                                                                 errorMessage);
+    std::shared_ptr<CziImage> cziImageOut(loadTile(tileRequest,
+                                                   cziSceneInfo,
+                                                   errorMessage));
     
     if (cziDebugFlag) std::cout << "Time to load CZI Image: (ms): " << timer.getElapsedTimeMilliseconds() << std::endl;
     
-    if (cziImageOut == NULL) {
+    if ( ! cziImageOut) {
         CaretLogSevere("Loading Pyramid level="
                        + AString::number(pyramidLayerIndex)
                        + " for frame(scene) index="
@@ -1151,7 +1148,7 @@ CziImageLoaderMultiResolution::loadImageForPyrmaidLayerForPlaneCoords(const CziI
  * @param pyramidLayerIndexIn
  *    Index of the pyramid layer
  */
-CziImage*
+std::shared_ptr<CziImage>
 CziImageLoaderMultiResolution::loadImageForPyrmaidLayerForStereotaxicCoords(const CziImage* oldCziImage,
                                                                             const CziImageFile::CziSceneInfo& cziSceneInfo,
                                                                             const GraphicsObjectToWindowTransform* transform,
@@ -1209,26 +1206,16 @@ CziImageLoaderMultiResolution::loadImageForPyrmaidLayerForStereotaxicCoords(cons
      */
     QRectF logicalRectToLoad = m_cziImageFile->stereotaxicRectToLogicalRect(stereotaxicRectToLoad);
     
+    /*
+     * Region read for the pyramid layer is centered on a grid so that
+     * small pans reuse the same cached tile
+     */
     CaretAssertVectorIndex(allPyramidLayers, pyramidLayerIndex);
-    const auto& selectedPyramidLayer(allPyramidLayers[pyramidLayerIndex]);
-    if ((selectedPyramidLayer.m_logicalWidthForImageReading == cziSceneInfo.m_logicalRectangle.width())
-        && (selectedPyramidLayer.m_logicalHeightForImageReading == cziSceneInfo.m_logicalRectangle.height())) {
-        logicalRectToLoad = cziSceneInfo.m_logicalRectangle;
-        if (cziDebugFlag) std::cout << "Load full resolution" << std::endl;
-    }
-    else {
-        const float widthToLoad(selectedPyramidLayer.m_logicalWidthForImageReading);
-        const float heightToLoad(selectedPyramidLayer.m_logicalHeightForImageReading);
-        
-        const QPointF centerXY(logicalRectToLoad.center());
-        const float rectX(centerXY.x() - (widthToLoad / 2.0));
-        const float rectY(centerXY.y() - (heightToLoad / 2.0));
-        if (cziDebugFlag) std::cout << "Rect to load before pyramid size: " << CziUtilities::qRectToString(logicalRectToLoad) << std::endl;
-        logicalRectToLoad.setRect(rectX, rectY, widthToLoad, heightToLoad);
-        if (cziDebugFlag) std::cout << "             after pyramid size: " << CziUtilities::qRectToString(logicalRectToLoad) << std::endl;
-        logicalRectToLoad = logicalRectToLoad.intersected(cziSceneInfo.m_logicalRectangle);
-        if (cziDebugFlag) std::cout << "             after clip: " << CziUtilities::qRectToString(logicalRectToLoad) << std::endl;
-    }
+    const CziImageTileCache::TileRequest tileRequest(createTileRequest(cziSceneInfo,
+                                                                       channelIndex,
+                                                                       pyramidLayerIndex,
+                                                                       logicalRectToLoad.center()));
+    logicalRectToLoad = tileRequest.m_logicalRect;
     
     const bool expandFlag(false);
     if (expandFlag) {
@@ -1266,7 +1253,10 @@ CziImageLoaderMultiResolution::loadImageForPyrmaidLayerForStereotaxicCoords(cons
             /*
              * Continue using image
              */
-            return const_cast<CziImage*>(oldCziImage);
+            if (oldCziImage == m_cziImage.get()) {
+                m_waitingForTileFlag = false;
+                return m_cziImage;
+            }
         }
     }
     
@@ -1274,22 +1264,15 @@ CziImageLoaderMultiResolution::loadImageForPyrmaidLayerForStereotaxicCoords(cons
     timer.start();
     
     
-    const AString cziName(cziSceneInfo.getName()
-                          + " PyramidLayer="
-                          + AString::number(pyramidLayerIndex));
     if (cziDebugFlag) std::cout << "Loading pyramid index=" << pyramidLayerIndex << ", rect=" << CziUtilities::qRectToString(logicalRectToLoad) << std::endl;
     AString errorMessage;
-    CziImage* cziImageOut = m_cziImageFile->readFromCziImageFile(s_imageDataFormatForReading,
-                                                                 cziName,
-                                                                 channelIndex,
-                                                                 logicalRectToLoad,
-                                                                 cziSceneInfo.m_logicalRectangle,
-                                                                 m_cziImageFile->getPreferencesImageDimension(),
-                                                                 errorMessage);
+    std::shared_ptr<CziImage> cziImageOut(loadTile(tileRequest,
+                                                   cziSceneInfo,
+                                                   errorMessage));
     
     if (cziDebugFlag) std::cout << "Time to load CZI Image: (ms): " << timer.getElapsedTimeMilliseconds() << std::endl;
     
-    if (cziImageOut == NULL) {
+    if ( ! cziImageOut) {
         CaretLogSevere("Loading Pyramid level="
                        + AString::number(pyramidLayerIndex)
                        + " for frame(scene) index="
@@ -1307,3 +1290,204 @@ CziImageLoaderMultiResolution::loadImageForPyrmaidLayerForStereotaxicCoords(cons
     
     return cziImageOut;
 }
+
+/**
+ * Create a request for reading the tile of a pyramid layer that contains the given position.
+ * The center of the tile is snapped to a grid so that small pans use the same tile.
+ * @param cziSceneInfo
+ *    CZI scene info (pyramid layers) for image selection
+ * @param channelIndex
+ *    Index of channel.
+ * @param pyramidLayerIndex
+ *    Index of the pyramid layer
+ * @param logicalCenter
+ *    Center of region for reading in logical coordinates
+ * @return The tile request
+ */
+CziImageTileCache::TileRequest
+CziImageLoaderMultiResolution::createTileRequest(const CziImageFile::CziSceneInfo& cziSceneInfo,
+                                                 const int32_t channelIndex,
+                                                 const int32_t pyramidLayerIndex,
+                                                 const QPointF& logicalCenter) const
+{
+    CaretAssertVectorIndex(cziSceneInfo.m_pyramidLayers, pyramidLayerIndex);
+    const auto& pyramidLayer(cziSceneInfo.m_pyramidLayers[pyramidLayerIndex]);
+    
+    int64_t tileColumn(0);
+    int64_t tileRow(0);
+    QRectF logicalRect;
+    if ((pyramidLayer.m_logicalWidthForImageReading == cziSceneInfo.m_logicalRectangle.width())
+        && (pyramidLayer.m_logicalHeightForImageReading == cziSceneInfo.m_logicalRectangle.height())) {
+        logicalRect = cziSceneInfo.m_logicalRectangle;
+        if (cziDebugFlag) std::cout << "Load full resolution" << std::endl;
+    }
+    else {
+        const float widthToLoad(pyramidLayer.m_logicalWidthForImageReading);
+        const float heightToLoad(pyramidLayer.m_logicalHeightForImageReading);
+        
+        const float gridStepX(std::max(widthToLoad / tileGridDivisions, 1.0f));
+        const float gridStepY(std::max(heightToLoad / tileGridDivisions, 1.0f));
+        tileColumn = static_cast<int64_t>(std::floor(logicalCenter.x() / gridStepX));
+        tileRow    = static_cast<int64_t>(std::floor(logicalCenter.y() / gridStepY));
+        
+        const float centerX((tileColumn + 0.5f) * gridStepX);
+        const float centerY((tileRow + 0.5f) * gridStepY);
+        logicalRect.setRect(centerX - (widthToLoad / 2.0),
+                            centerY - (heightToLoad / 2.0),
+                            widthToLoad,
+                            heightToLoad);
+        if (cziDebugFlag) std::cout << "             tile rect: " << CziUtilities::qRectToString(logicalRect) << std::endl;
+        logicalRect = logicalRect.intersected(cziSceneInfo.m_logicalRectangle);
+        if (cziDebugFlag) std::cout << "             after clip: " << CziUtilities::qRectToString(logicalRect) << std::endl;
+    }
+    
+    const int32_t imageDimension(m_cziImageFile->getPreferencesImageDimension());
+    
+    CziImageTileCache::TileRequest tileRequest;
+    tileRequest.m_key = CziImageTileCache::TileKey(cziSceneInfo.m_sceneIndex,
+                                                   pyramidLayerIndex,
+                                                   channelIndex,
+                                                   imageDimension,
+                                                   tileColumn,
+                                                   tileRow);
+    tileRequest.m_imageName = (cziSceneInfo.getName()
+                               + " PyramidLayer="
+                               + AString::number(pyramidLayerIndex));
+    tileRequest.m_logicalRect      = logicalRect;
+    tileRequest.m_frameLogicalRect = cziSceneInfo.m_logicalRectangle;
+    tileRequest.m_outputImageWidthHeightMaximum = imageDimension;
+    tileRequest.m_backgroundRGB    = m_cziImageFile->getPreferencesImageBackgroundFloatRGB();
+    
+    return tileRequest;
+}
+
+/**
+ * Get a tile from the file's tile cache.  When background loading is enabled and the
+ * tile is not cached, the tile is queued for loading and the current image (or a lower
+ * resolution tile) is returned until the tile is available.  Otherwise, the tile is
+ * read immediately.
+ * @param tileRequest
+ *    Describes the tile
+ * @param cziSceneInfo
+ *    CZI scene info (pyramid layers) for image selection
+ * @param errorMessageOut
+ *    Contains information about any errors
+ * @return The image or invalid pointer if reading failed
+ */
+std::shared_ptr<CziImage>
+CziImageLoaderMultiResolution::loadTile(const CziImageTileCache::TileRequest& tileRequest,
+                                        const CziImageFile::CziSceneInfo& cziSceneInfo,
+                                        AString& errorMessageOut)
+{
+    errorMessageOut.clear();
+    m_waitingForTileFlag = false;
+    
+    CziImageTileCache* tileCache(m_cziImageFile->m_tileCache.get());
+    if (tileCache == NULL) {
+        errorMessageOut = "CZI file is not open";
+        return std::shared_ptr<CziImage>();
+    }
+    
+    if (CziImageTileCache::isBackgroundLoadingEnabled()) {
+        std::shared_ptr<CziImage> image(tileCache->getTile(tileRequest.m_key));
+        bool waitingFlag(false);
+        if ( ! image) {
+            /*
+             * While the tile loads, display the current image or
+             * a lower resolution tile of the same frame and channel
+             */
+            if (m_cziImage
+                && m_cziImageTileKey.isSameImageSource(tileRequest.m_key)) {
+                image = m_cziImage;
+            }
+            else {
+                image = tileCache->getCoarserTile(tileRequest.m_key,
+                                                  tileRequest.m_logicalRect.center());
+            }
+            if (image
+                && ( ! tileCache->isTileFailed(tileRequest.m_key))) {
+                tileCache->requestTile(tileRequest,
+                                       false);
+                waitingFlag = true;
+            }
+        }
+        
+        if (image) {
+            m_cziImageTileKey    = tileRequest.m_key;
+            m_waitingForTileFlag = waitingFlag;
+            if ( ! m_waitingForTileFlag) {
+                prefetchTiles(tileRequest,
+                              cziSceneInfo);
+            }
+            return image;
+        }
+    }
+    
+    /*
+     * Nothing to display so read the tile now
+     */
+    std::shared_ptr<CziImage> image(tileCache->loadTile(tileRequest,
+                                                        errorMessageOut));
+    if (image) {
+        m_cziImageTileKey = tileRequest.m_key;
+        prefetchTiles(tileRequest,
+                      cziSceneInfo);
+    }
+    return image;
+}
+
+/**
+ * Queue the tiles that are likely to be displayed next for loading in the background:
+ * the tile at the next higher resolution pyramid layer (zooming in) and the
+ * neighboring tiles in the same layer (panning).
+ * @param tileRequest
+ *    The tile that is displayed
+ * @param cziSceneInfo
+ *    CZI scene info (pyramid layers) for image selection
+ */
+void
+CziImageLoaderMultiResolution::prefetchTiles(const CziImageTileCache::TileRequest& tileRequest,
+                                             const CziImageFile::CziSceneInfo& cziSceneInfo)
+{
+    if ( ! CziImageTileCache::isBackgroundLoadingEnabled()) {
+        return;
+    }
+    CziImageTileCache* tileCache(m_cziImageFile->m_tileCache.get());
+    CaretAssert(tileCache);
+    
+    const CziImageTileCache::TileKey& key(tileRequest.m_key);
+    const int32_t layerIndex(key.getPyramidLayerIndex());
+    
+    const int32_t finerLayerIndex(layerIndex + 1);
+    if (finerLayerIndex < static_cast<int32_t>(cziSceneInfo.m_pyramidLayers.size())) {
+        tileCache->requestTile(createTileRequest(cziSceneInfo,
+                                                 key.getChannelIndex(),
+                                                 finerLayerIndex,
+                                                 tileRequest.m_logicalRect.center()),
+                               true);
+    }
+    
+    /*
+     * No neighbors when the layer is read as one tile
+     */
+    if (tileRequest.m_logicalRect == cziSceneInfo.m_logicalRectangle) {
+        return;
+    }
+    
+    CaretAssertVectorIndex(cziSceneInfo.m_pyramidLayers, layerIndex);
+    const auto& pyramidLayer(cziSceneInfo.m_pyramidLayers[layerIndex]);
+    const float gridStepX(std::max(pyramidLayer.m_logicalWidthForImageReading / tileGridDivisions, 1.0f));
+    const float gridStepY(std::max(pyramidLayer.m_logicalHeightForImageReading / tileGridDivisions, 1.0f));
+    const int64_t neighborOffsets[4][2] { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+    for (const auto& offset : neighborOffsets) {
+        const QPointF neighborCenter((key.getTileColumn() + offset[0] + 0.5f) * gridStepX,
+                                     (key.getTileRow() + offset[1] + 0.5f) * gridStepY);
+        if (cziSceneInfo.m_logicalRectangle.contains(neighborCenter)) {
+            tileCache->requestTile(createTileRequest(cziSceneInfo,
+                                                     key.getChannelIndex(),
+                                                     layerIndex,
+                                                     neighborCenter),
+                                   true);
+        }
+    }
+}
@@ -27,6 +27,7 @@
 
 #include "CziImageFile.h"
 #include "CziImageLoaderBase.h"
+#include "CziImageTileCache.h"
 #include "MediaDisplayCoordinateModeEnum.h"
 
 namespace caret {
@@ -74,35 +75,47 @@ namespace caret {
                                 const GraphicsObjectToWindowTransform* transform,
                                 const MediaDisplayCoordinateModeEnum::Enum coordinateMode) const;
         
-        CziImage* loadImageForPyrmaidLayer(const CziImage* oldCziImage,
-                                           const CziImageFile::CziSceneInfo& cziSceneInfo,
-                                           const GraphicsObjectToWindowTransform* transform,
-                                           const CziImageResolutionChangeModeEnum::Enum resolutionChangeMode,
-                                           const MediaDisplayCoordinateModeEnum::Enum coordinateMode,
-                                           const int32_t channelIndex,
-                                           const int32_t pyramidLayerIndex);
-
-        CziImage* loadImageForPyrmaidLayerForPixelCoords(const CziImage* oldCziImage,
-                                                         const CziImageFile::CziSceneInfo& cziSceneInfo,
-                                                         const GraphicsObjectToWindowTransform* transform,
-                                                         const CziImageResolutionChangeModeEnum::Enum resolutionChangeMode,
-                                                         const int32_t channelIndex,
-                                                         const int32_t pyramidLayerIndex);
-
-        CziImage* loadImageForPyrmaidLayerForPlaneCoords(const CziImage* oldCziImage,
-                                                         const CziImageFile::CziSceneInfo& cziSceneInfo,
-                                                         const GraphicsObjectToWindowTransform* transform,
-                                                         const CziImageResolutionChangeModeEnum::Enum resolutionChangeMode,
+        std::shared_ptr<CziImage> loadImageForPyrmaidLayer(const CziImage* oldCziImage,
+                                                           const CziImageFile::CziSceneInfo& cziSceneInfo,
+                                                           const GraphicsObjectToWindowTransform* transform,
+                                                           const CziImageResolutionChangeModeEnum::Enum resolutionChangeMode,
+                                                           const MediaDisplayCoordinateModeEnum::Enum coordinateMode,
+                                                           const int32_t channelIndex,
+                                                           const int32_t pyramidLayerIndex);
+
+        std::shared_ptr<CziImage> loadImageForPyrmaidLayerForPixelCoords(const CziImage* oldCziImage,
+                                                                         const CziImageFile::CziSceneInfo& cziSceneInfo,
+                                                                         const GraphicsObjectToWindowTransform* transform,
+                                                                         const CziImageResolutionChangeModeEnum::Enum resolutionChangeMode,
+                                                                         const int32_t channelIndex,
+                                                                         const int32_t pyramidLayerIndex);
+
+        std::shared_ptr<CziImage> loadImageForPyrmaidLayerForPlaneCoords(const CziImage* oldCziImage,
+                                                                         const CziImageFile::CziSceneInfo& cziSceneInfo,
+                                                                         const GraphicsObjectToWindowTransform* transform,
+                                                                         const CziImageResolutionChangeModeEnum::Enum resolutionChangeMode,
+                                                                         const int32_t channelIndex,
+                                                                         const int32_t pyramidLayerIndex);
+        
+        std::shared_ptr<CziImage> loadImageForPyrmaidLayerForStereotaxicCoords(const CziImage* oldCziImage,
+                                                                               const CziImageFile::CziSceneInfo& cziSceneInfo,
+                                                                               const GraphicsObjectToWindowTransform* transform,
+                                                                               const CziImageResolutionChangeModeEnum::Enum resolutionChangeMode,
+                                                                               const int32_t channelIndex,
+                                                                               const int32_t pyramidLayerIndex);
+
+        CziImageTileCache::TileRequest createTileRequest(const CziImageFile::CziSceneInfo& cziSceneInfo,
                                                          const int32_t channelIndex,
-                                                         const int32_t pyramidLayerIndex);
+                                                         const int32_t pyramidLayerIndex,
+                                                         const QPointF& logicalCenter) const;
+        
+        std::shared_ptr<CziImage> loadTile(const CziImageTileCache::TileRequest& tileRequest,
+                                           const CziImageFile::CziSceneInfo& cziSceneInfo,
+                                           AString& errorMessageOut);
+        
+        void prefetchTiles(const CziImageTileCache::TileRequest& tileRequest,
+                           const CziImageFile::CziSceneInfo& cziSceneInfo);
         
-        CziImage* loadImageForPyrmaidLayerForStereotaxicCoords(const CziImage* oldCziImage,
-                                                               const CziImageFile::CziSceneInfo& cziSceneInfo,
-                                                               const GraphicsObjectToWindowTransform* transform,
-                                                               const CziImageResolutionChangeModeEnum::Enum resolutionChangeMode,
-                                                               const int32_t channelIndex,
-                                                               const int32_t pyramidLayerIndex);
-
         QRectF getViewportLogicalCoordinates(const GraphicsObjectToWindowTransform* transform,
                                              const MediaDisplayCoordinateModeEnum::Enum coordinateMode) const;
         
@@ -144,6 +157,12 @@ namespace caret {
         
         bool m_frameChangedFlag = false;
         
+        /** Key of the tile displayed or, if waiting, the tile being loaded in the background */
+        CziImageTileCache::TileKey m_cziImageTileKey;
+        
+        /** True if a lower resolution or previous image is displayed while a tile loads in the background */
+        bool m_waitingForTileFlag = false;
+        
         /*
          * Note CZI_BITMAP does not support alpha channel that is needed for distance/masking file alpha values.
          * If QImage is used, gluBuild2DMipmaps() will crash when the Mesa3D library is used.  This may be due to
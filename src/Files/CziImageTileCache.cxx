@@ -0,0 +1,542 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#define __CZI_IMAGE_TILE_CACHE_DECLARE__
+#include "CziImageTileCache.h"
+#undef __CZI_IMAGE_TILE_CACHE_DECLARE__
+
+#include <algorithm>
+#include <tuple>
+
+#include <QCoreApplication>
+#include <QRunnable>
+#include <QThread>
+
+#include "CaretAssert.h"
+#include "CaretLogger.h"
+#include "CziImage.h"
+#include "CziImageFile.h"
+#include "EventCziImageTileLoaded.h"
+#include "EventManager.h"
+
+using namespace caret;
+
+/**
+ * \class caret::CziImageTileCache
+ * \brief Least recently used cache of CZI image tiles with background decoding
+ * \ingroup Files
+ *
+ * A tile is the image read for one pyramid layer around a position in the
+ * scene that is snapped to a grid, so small pans reuse the same tile.  Tiles
+ * may be read synchronously with loadTile() or queued with requestTile() for
+ * decoding by a pool of threads.  When a requested tile finishes decoding,
+ * an EventCziImageTileLoaded is sent on the GUI thread so that graphics
+ * are redrawn with the new tile.
+ *
+ * Tiles are only added to and removed from the cache on the GUI thread since
+ * deleting an image may delete its OpenGL texture.  Decoding threads place
+ * finished tiles in a separate list that is moved into the cache the next time
+ * the cache is accessed.
+ */
+
+/**
+ * \class caret::CziImageTileCache::TileDecodeTask
+ * \brief Reads one tile from the CZI file in a thread pool thread
+ */
+class CziImageTileCache::TileDecodeTask : public QRunnable {
+public:
+    TileDecodeTask(CziImageTileCache* tileCache,
+                   const TileRequest& request,
+                   const int64_t generation,
+                   const bool prefetchFlag)
+    : m_tileCache(tileCache),
+    m_request(request),
+    m_generation(generation),
+    m_prefetchFlag(prefetchFlag) { }
+    
+    void run() override {
+        AString errorMessage;
+        CziImage* image(m_tileCache->readTile(m_request,
+                                              errorMessage));
+        if (image == NULL) {
+            CaretLogWarning("Background loading of CZI tile "
+                            + m_request.m_key.toString()
+                            + " failed: "
+                            + errorMessage);
+        }
+        m_tileCache->tileDecoded(m_request.m_key,
+                                 m_generation,
+                                 image,
+                                 m_prefetchFlag);
+    }
+    
+private:
+    CziImageTileCache* m_tileCache;
+    
+    const TileRequest m_request;
+    
+    const int64_t m_generation;
+    
+    const bool m_prefetchFlag;
+};
+
+/**
+ * Constructor.
+ * @param cziImageFile
+ *    The CZI file from which tiles are read
+ */
+CziImageTileCache::CziImageTileCache(CziImageFile* cziImageFile)
+: CaretObject(),
+m_cziImageFile(cziImageFile)
+{
+    CaretAssert(m_cziImageFile);
+    
+    /*
+     * Leave a core for the GUI thread
+     */
+    m_threadPool.setMaxThreadCount(std::max(1, std::min(QThread::idealThreadCount() - 1,
+                                                        4)));
+}
+
+/**
+ * Destructor.  Waits for any tiles that are decoding.
+ */
+CziImageTileCache::~CziImageTileCache()
+{
+    m_threadPool.clear();
+    m_threadPool.waitForDone();
+}
+
+/**
+ * Enable or disable background loading.  When disabled (the default, as in wb_command),
+ * requested tiles are not decoded in the background and images are read synchronously.
+ * @param enabled
+ *    New status
+ */
+void
+CziImageTileCache::setBackgroundLoadingEnabled(const bool enabled)
+{
+    s_backgroundLoadingEnabled = enabled;
+}
+
+/**
+ * @return True if tiles may be decoded in the background
+ */
+bool
+CziImageTileCache::isBackgroundLoadingEnabled()
+{
+    return s_backgroundLoadingEnabled;
+}
+
+/**
+ * @return The tile for the given key, or an invalid pointer if it is not in the cache.
+ * Only call from the GUI thread.
+ * @param key
+ *    Key of the tile
+ */
+std::shared_ptr<CziImage>
+CziImageTileCache::getTile(const TileKey& key)
+{
+    moveDecodedTilesToCache();
+    
+    auto iter = m_tiles.find(key);
+    if (iter == m_tiles.end()) {
+        return std::shared_ptr<CziImage>();
+    }
+    
+    /*
+     * Now the most recently used tile
+     */
+    m_lruKeys.splice(m_lruKeys.begin(),
+                     m_lruKeys,
+                     iter->second.m_lruIterator);
+    return iter->second.m_image;
+}
+
+/**
+ * Find a cached tile from a lower resolution pyramid layer of the same scene and channel
+ * that contains the given position.  Used for display while a finer tile is loading.
+ * @param key
+ *    Key of the tile that is loading
+ * @param logicalCenter
+ *    Center of the region being viewed in logical coordinates
+ * @return The finest such tile, or an invalid pointer if there is none
+ */
+std::shared_ptr<CziImage>
+CziImageTileCache::getCoarserTile(const TileKey& key,
+                                  const QPointF& logicalCenter)
+{
+    moveDecodedTilesToCache();
+    
+    std::shared_ptr<CziImage> bestImage;
+    int32_t bestLayerIndex(-1);
+    for (const auto& keyTile : m_tiles) {
+        const TileKey& tileKey(keyTile.first);
+        if (tileKey.isSameImageSource(key)
+            && (tileKey.getPyramidLayerIndex() < key.getPyramidLayerIndex())
+            && (tileKey.getPyramidLayerIndex() > bestLayerIndex)) {
+            if (keyTile.second.m_image->getImageDataLogicalRect().contains(logicalCenter)) {
+                bestImage      = keyTile.second.m_image;
+                bestLayerIndex = tileKey.getPyramidLayerIndex();
+            }
+        }
+    }
+    
+    return bestImage;
+}
+
+/**
+ * Read a tile synchronously if it is not in the cache.  Only call from the GUI thread.
+ * @param request
+ *    Describes the tile
+ * @param errorMessageOut
+ *    Contains information about any errors
+ * @return The tile, or an invalid pointer if reading failed
+ */
+std::shared_ptr<CziImage>
+CziImageTileCache::loadTile(const TileRequest& request,
+                            AString& errorMessageOut)
+{
+    errorMessageOut.clear();
+    
+    std::shared_ptr<CziImage> image(getTile(request.m_key));
+    if ( ! image) {
+        if (isTileFailed(request.m_key)) {
+            errorMessageOut = ("Reading of CZI tile "
+                               + request.m_key.toString()
+                               + " failed previously");
+            return image;
+        }
+        image.reset(readTile(request,
+                             errorMessageOut));
+        if (image) {
+            addTile(request.m_key,
+                    image);
+        }
+        else {
+            CaretMutexLocker locker(&m_mutex);
+            m_failedKeys.insert(request.m_key);
+        }
+    }
+    return image;
+}
+
+/**
+ * Queue a tile for decoding in the background if it is not cached or already queued.
+ * Only call from the GUI thread.
+ * @param request
+ *    Describes the tile
+ * @param prefetchFlag
+ *    True if the tile is not yet needed for display (neighbor or next pyramid layer).
+ *    Prefetches have lower priority and graphics are not updated when they finish.
+ */
+void
+CziImageTileCache::requestTile(const TileRequest& request,
+                               const bool prefetchFlag)
+{
+    if ( ! s_backgroundLoadingEnabled) {
+        return;
+    }
+    
+    moveDecodedTilesToCache();
+    if (m_tiles.find(request.m_key) != m_tiles.end()) {
+        return;
+    }
+    
+    int64_t generation(0);
+    {
+        CaretMutexLocker locker(&m_mutex);
+        if (m_pendingKeys.find(request.m_key) != m_pendingKeys.end()) {
+            return;
+        }
+        if (m_failedKeys.find(request.m_key) != m_failedKeys.end()) {
+            return;
+        }
+        if (prefetchFlag
+            && (static_cast<int32_t>(m_pendingKeys.size()) >= s_maximumNumberOfPendingPrefetches)) {
+            return;
+        }
+        m_pendingKeys.insert(request.m_key);
+        generation = m_generation;
+    }
+    
+    /*
+     * Thread pool deletes the task after it runs
+     */
+    m_threadPool.start(new TileDecodeTask(this,
+                                          request,
+                                          generation,
+                                          prefetchFlag),
+                       (prefetchFlag ? 0 : 1));
+}
+
+/**
+ * @return True if the tile is queued or decoding
+ * @param key
+ *    Key of the tile
+ */
+bool
+CziImageTileCache::isTilePending(const TileKey& key) const
+{
+    CaretMutexLocker locker(&m_mutex);
+    return (m_pendingKeys.find(key) != m_pendingKeys.end());
+}
+
+/**
+ * @return True if reading the tile failed.  Failed tiles are not read again
+ * until clearFailedTiles() or clear() is called.
+ * @param key
+ *    Key of the tile
+ */
+bool
+CziImageTileCache::isTileFailed(const TileKey& key) const
+{
+    CaretMutexLocker locker(&m_mutex);
+    return (m_failedKeys.find(key) != m_failedKeys.end());
+}
+
+/**
+ * Forget tiles that failed to read so that they are tried again
+ * (such as when a different frame is displayed).
+ */
+void
+CziImageTileCache::clearFailedTiles()
+{
+    CaretMutexLocker locker(&m_mutex);
+    m_failedKeys.clear();
+}
+
+/**
+ * Remove all tiles, forget failed tiles, and discard any tiles that are decoding.  Only call from the GUI thread.
+ */
+void
+CziImageTileCache::clear()
+{
+    m_threadPool.clear();
+    {
+        CaretMutexLocker locker(&m_mutex);
+        ++m_generation;
+        m_pendingKeys.clear();
+        m_failedKeys.clear();
+        m_decodedTiles.clear();
+    }
+    m_tiles.clear();
+    m_lruKeys.clear();
+}
+
+/**
+ * Read a tile from the CZI file.  May be called from any thread.
+ * @param request
+ *    Describes the tile
+ * @param errorMessageOut
+ *    Contains information about any errors
+ * @return The image, or NULL if reading failed
+ */
+CziImage*
+CziImageTileCache::readTile(const TileRequest& request,
+                            AString& errorMessageOut)
+{
+    return m_cziImageFile->readFromCziImageFile(CziImageFile::ImageDataFormat::CZI_BITMAP,
+                                                request.m_imageName,
+                                                request.m_key.getChannelIndex(),
+                                                request.m_logicalRect,
+                                                request.m_frameLogicalRect,
+                                                request.m_outputImageWidthHeightMaximum,
+                                                request.m_backgroundRGB,
+                                                errorMessageOut);
+}
+
+/**
+ * Add a tile to the cache, removing least recently used tiles if the cache is full
+ * @param key
+ *    Key of the tile
+ * @param image
+ *    Image for the tile
+ */
+void
+CziImageTileCache::addTile(const TileKey& key,
+                           std::shared_ptr<CziImage>& image)
+{
+    CaretAssert(image);
+    auto iter = m_tiles.find(key);
+    if (iter != m_tiles.end()) {
+        iter->second.m_image = image;
+        m_lruKeys.splice(m_lruKeys.begin(),
+                         m_lruKeys,
+                         iter->second.m_lruIterator);
+        return;
+    }
+    
+    m_lruKeys.push_front(key);
+    CachedTile cachedTile;
+    cachedTile.m_image       = image;
+    cachedTile.m_lruIterator = m_lruKeys.begin();
+    m_tiles.insert(std::make_pair(key,
+                                  cachedTile));
+    
+    /*
+     * Images still displayed by a loader are kept alive by the loader's pointer
+     */
+    while (static_cast<int32_t>(m_tiles.size()) > s_maximumNumberOfTiles) {
+        m_tiles.erase(m_lruKeys.back());
+        m_lruKeys.pop_back();
+    }
+}
+
+/**
+ * Move tiles finished by decoding threads into the cache
+ */
+void
+CziImageTileCache::moveDecodedTilesToCache()
+{
+    std::vector<std::pair<TileKey, std::shared_ptr<CziImage>>> decodedTiles;
+    {
+        CaretMutexLocker locker(&m_mutex);
+        if (m_decodedTiles.empty()) {
+            return;
+        }
+        decodedTiles.swap(m_decodedTiles);
+    }
+    
+    for (auto& keyImage : decodedTiles) {
+        addTile(keyImage.first,
+                keyImage.second);
+    }
+}
+
+/**
+ * Called by a decoding thread when a tile is finished
+ * @param key
+ *    Key of the tile
+ * @param generation
+ *    Value of the generation when the tile was requested.  If the cache
+ *    was cleared since then, the tile is discarded.
+ * @param image
+ *    The image (NULL if reading failed)
+ * @param prefetchFlag
+ *    True if the tile was prefetched
+ */
+void
+CziImageTileCache::tileDecoded(const TileKey& key,
+                               const int64_t generation,
+                               CziImage* image,
+                               const bool prefetchFlag)
+{
+    /*
+     * Image has not been drawn (no OpenGL textures) so it may be deleted in this thread
+     */
+    std::shared_ptr<CziImage> imagePointer(image);
+    {
+        CaretMutexLocker locker(&m_mutex);
+        if (generation != m_generation) {
+            return;
+        }
+        m_pendingKeys.erase(key);
+        if (imagePointer) {
+            m_decodedTiles.push_back(std::make_pair(key,
+                                                    imagePointer));
+        }
+        else {
+            m_failedKeys.insert(key);
+        }
+    }
+    
+    if (prefetchFlag
+        || ( ! imagePointer)) {
+        return;
+    }
+    
+    /*
+     * Events must be sent on the GUI thread
+     */
+    QCoreApplication* application(QCoreApplication::instance());
+    if (application != NULL) {
+        QMetaObject::invokeMethod(application,
+                                  []() {
+                                      EventManager::get()->sendEvent(EventCziImageTileLoaded().getPointer());
+                                  },
+                                  Qt::QueuedConnection);
+    }
+}
+
+/**
+ * @return True if this key is less than the other key
+ * @param rhs
+ *    The other key
+ */
+bool
+CziImageTileCache::TileKey::operator<(const TileKey& rhs) const
+{
+    return (std::tie(m_sceneIndex, m_pyramidLayerIndex, m_channelIndex, m_imageDimension, m_tileColumn, m_tileRow)
+            < std::tie(rhs.m_sceneIndex, rhs.m_pyramidLayerIndex, rhs.m_channelIndex, rhs.m_imageDimension, rhs.m_tileColumn, rhs.m_tileRow));
+}
+
+/**
+ * @return True if this key is equal to the other key
+ * @param rhs
+ *    The other key
+ */
+bool
+CziImageTileCache::TileKey::operator==(const TileKey& rhs) const
+{
+    return (std::tie(m_sceneIndex, m_pyramidLayerIndex, m_channelIndex, m_imageDimension, m_tileColumn, m_tileRow)
+            == std::tie(rhs.m_sceneIndex, rhs.m_pyramidLayerIndex, rhs.m_channelIndex, rhs.m_imageDimension, rhs.m_tileColumn, rhs.m_tileRow));
+}
+
+/**
+ * @return True if the other key is for the same scene, channel, and image dimension
+ * (but possibly a different pyramid layer or position)
+ * @param rhs
+ *    The other key
+ */
+bool
+CziImageTileCache::TileKey::isSameImageSource(const TileKey& rhs) const
+{
+    return ((m_sceneIndex == rhs.m_sceneIndex)
+            && (m_channelIndex == rhs.m_channelIndex)
+            && (m_imageDimension == rhs.m_imageDimension));
+}
+
+/**
+ * @return Description of the key for debugging
+ */
+AString
+CziImageTileCache::TileKey::toString() const
+{
+    return ("scene=" + AString::number(m_sceneIndex)
+            + " layer=" + AString::number(m_pyramidLayerIndex)
+            + " channel=" + AString::number(m_channelIndex)
+            + " dimension=" + AString::number(m_imageDimension)
+            + " column=" + AString::number(m_tileColumn)
+            + " row=" + AString::number(m_tileRow));
+}
+
+/**
+ * Get a description of this object's content.
+ * @return String describing this object's content.
+ */
+AString 
+CziImageTileCache::toString() const
+{
+    return ("CziImageTileCache with "
+            + AString::number(static_cast<int64_t>(m_tiles.size()))
+            + " tiles");
+}
+
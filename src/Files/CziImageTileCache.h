@@ -0,0 +1,213 @@
+#ifndef __CZI_IMAGE_TILE_CACHE_H__
+#define __CZI_IMAGE_TILE_CACHE_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+
+#include <array>
+#include <list>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <QPointF>
+#include <QRectF>
+#include <QThreadPool>
+
+#include "CaretMutex.h"
+#include "CaretObject.h"
+
+namespace caret {
+
+    class CziImage;
+    class CziImageFile;
+    
+    class CziImageTileCache : public CaretObject {
+        
+    public:
+        /**
+         * Identifies a tile: a region read from one pyramid layer of a scene (or all scenes)
+         */
+        class TileKey {
+        public:
+            TileKey() { }
+            
+            TileKey(const int32_t sceneIndex,
+                    const int32_t pyramidLayerIndex,
+                    const int32_t channelIndex,
+                    const int32_t imageDimension,
+                    const int64_t tileColumn,
+                    const int64_t tileRow)
+            : m_sceneIndex(sceneIndex),
+            m_pyramidLayerIndex(pyramidLayerIndex),
+            m_channelIndex(channelIndex),
+            m_imageDimension(imageDimension),
+            m_tileColumn(tileColumn),
+            m_tileRow(tileRow) { }
+            
+            bool operator<(const TileKey& rhs) const;
+            
+            bool operator==(const TileKey& rhs) const;
+            
+            bool isSameImageSource(const TileKey& rhs) const;
+            
+            int32_t getSceneIndex() const { return m_sceneIndex; }
+            
+            int32_t getPyramidLayerIndex() const { return m_pyramidLayerIndex; }
+            
+            int32_t getChannelIndex() const { return m_channelIndex; }
+            
+            int64_t getTileColumn() const { return m_tileColumn; }
+            
+            int64_t getTileRow() const { return m_tileRow; }
+            
+            AString toString() const;
+            
+        private:
+            int32_t m_sceneIndex = -2;
+            
+            int32_t m_pyramidLayerIndex = -1;
+            
+            int32_t m_channelIndex = -2;
+            
+            int32_t m_imageDimension = 0;
+            
+            int64_t m_tileColumn = 0;
+            
+            int64_t m_tileRow = 0;
+        };
+        
+        /**
+         * Everything needed to read a tile, gathered on the GUI thread
+         */
+        class TileRequest {
+        public:
+            TileKey m_key;
+            
+            AString m_imageName;
+            
+            QRectF m_logicalRect;
+            
+            QRectF m_frameLogicalRect;
+            
+            int64_t m_outputImageWidthHeightMaximum = 2048;
+            
+            std::array<float, 3> m_backgroundRGB { { 0.0f, 0.0f, 0.0f } };
+        };
+        
+        CziImageTileCache(CziImageFile* cziImageFile);
+        
+        virtual ~CziImageTileCache();
+        
+        CziImageTileCache(const CziImageTileCache&) = delete;
+
+        CziImageTileCache& operator=(const CziImageTileCache&) = delete;
+        
+        std::shared_ptr<CziImage> getTile(const TileKey& key);
+        
+        std::shared_ptr<CziImage> getCoarserTile(const TileKey& key,
+                                                 const QPointF& logicalCenter);
+        
+        std::shared_ptr<CziImage> loadTile(const TileRequest& request,
+                                           AString& errorMessageOut);
+        
+        void requestTile(const TileRequest& request,
+                         const bool prefetchFlag);
+        
+        bool isTilePending(const TileKey& key) const;
+        
+        bool isTileFailed(const TileKey& key) const;
+        
+        void clearFailedTiles();
+        
+        void clear();
+        
+        static void setBackgroundLoadingEnabled(const bool enabled);
+        
+        static bool isBackgroundLoadingEnabled();
+
+        // ADD_NEW_METHODS_HERE
+
+        virtual AString toString() const;
+        
+    private:
+        class TileDecodeTask;
+        
+        struct CachedTile {
+            std::shared_ptr<CziImage> m_image;
+            
+            std::list<TileKey>::iterator m_lruIterator;
+        };
+        
+        CziImage* readTile(const TileRequest& request,
+                           AString& errorMessageOut);
+        
+        void addTile(const TileKey& key,
+                     std::shared_ptr<CziImage>& image);
+        
+        void moveDecodedTilesToCache();
+        
+        void tileDecoded(const TileKey& key,
+                         const int64_t generation,
+                         CziImage* image,
+                         const bool prefetchFlag);
+        
+        CziImageFile* m_cziImageFile;
+        
+        QThreadPool m_threadPool;
+        
+        /** protects m_pendingKeys, m_failedKeys, m_decodedTiles, and m_generation, which are used by decoding threads */
+        mutable CaretMutex m_mutex;
+        
+        std::set<TileKey> m_pendingKeys;
+        
+        /** tiles that could not be read, so they are not read again on every redraw */
+        std::set<TileKey> m_failedKeys;
+        
+        std::vector<std::pair<TileKey, std::shared_ptr<CziImage>>> m_decodedTiles;
+        
+        int64_t m_generation = 0;
+        
+        /** tiles are only added and removed on the GUI thread since deleting an image may delete OpenGL textures */
+        std::map<TileKey, CachedTile> m_tiles;
+        
+        /** most recently used tile at the front */
+        std::list<TileKey> m_lruKeys;
+        
+        static bool s_backgroundLoadingEnabled;
+        
+        static const int32_t s_maximumNumberOfTiles;
+        
+        static const int32_t s_maximumNumberOfPendingPrefetches;
+        
+        // ADD_NEW_MEMBERS_HERE
+
+    };
+    
+#ifdef __CZI_IMAGE_TILE_CACHE_DECLARE__
+    bool CziImageTileCache::s_backgroundLoadingEnabled = false;
+    const int32_t CziImageTileCache::s_maximumNumberOfTiles = 48;
+    const int32_t CziImageTileCache::s_maximumNumberOfPendingPrefetches = 8;
+#endif // __CZI_IMAGE_TILE_CACHE_DECLARE__
+
+} // namespace
+#endif  //__CZI_IMAGE_TILE_CACHE_H__
@@ -0,0 +1,56 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#define __EVENT_CZI_IMAGE_TILE_LOADED_DECLARE__
+#include "EventCziImageTileLoaded.h"
+#undef __EVENT_CZI_IMAGE_TILE_LOADED_DECLARE__
+
+#include "CaretAssert.h"
+#include "EventTypeEnum.h"
+
+using namespace caret;
+
+
+    
+/**
+ * \class caret::EventCziImageTileLoaded 
+ * \brief Sent on the GUI thread after a CZI image tile finishes loading in the background
+ * \ingroup Files
+ *
+ * Listeners should redraw graphics so that the new tile replaces the
+ * lower resolution image that was displayed while it was loading.
+ */
+
+/**
+ * Constructor.
+ */
+EventCziImageTileLoaded::EventCziImageTileLoaded()
+: Event(EventTypeEnum::EVENT_CZI_IMAGE_TILE_LOADED)
+{
+    
+}
+
+/**
+ * Destructor.
+ */
+EventCziImageTileLoaded::~EventCziImageTileLoaded()
+{
+}
+
@@ -23,6 +23,7 @@
 #include "CaretAssert.h"
 #include "CaretHeap.h"
 #include "CaretMutex.h"
+#include "CaretTrace.h"
 #include "FastStatistics.h"
 #include "SurfaceFile.h"
 #include "TopologyHelper.h"
@@ -35,6 +36,7 @@ using namespace std;
 
 GeodesicHelperBase::GeodesicHelperBase(const SurfaceFile* surfaceIn, const float* correctedAreas)
 {
+    CaretTraceSpan traceSpan("helper", "geodesic helper setup");
     CaretPointer<TopologyHelperBase> topoBase(new TopologyHelperBase(surfaceIn));
     TopologyHelper topoHelpIn(topoBase);//leave this building one privately, to not introduce even worse dependencies regarding SurfaceFile
     m_corrAreaSmallestFactor = 1.0f;
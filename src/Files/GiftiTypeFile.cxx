@@ -1111,6 +1111,11 @@ GiftiTypeFile::getMapIndexFromUniqueID(const AString& uniqueID) const
 void
 GiftiTypeFile::updateScalarColoringForMap(const int32_t mapIndex)
 {
+    /*
+     * Invalidates any cached coloring of the file's data
+     */
+    updateModificationStamp();
+    
     invalidateHistogramChartColoring();
     if ((mapIndex >= 0)
         && (mapIndex < getNumberOfMaps())) {
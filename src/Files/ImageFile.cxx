@@ -27,6 +27,7 @@
 #include <QImage>
 #include <QImageReader>
 #include <QImageWriter>
+#include <QMargins>
 #include <QTime>
 
 #define __IMAGE_FILE_DECLARE__
@@ -47,9 +48,11 @@
 #include "EventManager.h"
 #include "FileInformation.h"
 #include "GiftiMetaData.h"
+#include "GraphicsObjectToWindowTransform.h"
 #include "GraphicsUtilitiesOpenGL.h"
 #include "GraphicsPrimitiveV3fT2f.h"
 #include "ImageCaptureDialogSettings.h"
+#include "ImageFilePyramid.h"
 #include "Matrix4x4.h"
 #include "MathFunctions.h"
 #include "RectangleTransform.h"
@@ -62,6 +65,27 @@ using namespace caret;
 
 static bool imageDebugFlag = false;
 
+/**
+ * Region of a pyramid layer that is drawn in a tab and overlay
+ */
+class ImageFile::PyramidRegion {
+public:
+    /** Index of the pyramid layer */
+    int32_t m_layerIndex = -1;
+    
+    /** Coordinate mode used when region was loaded */
+    MediaDisplayCoordinateModeEnum::Enum m_coordinateMode = MediaDisplayCoordinateModeEnum::PIXEL;
+    
+    /** Pixel coordinates (of the image) of the region */
+    QRectF m_logicalRect;
+    
+    /** Pixels of the region; must exist as long as the primitive since texture uses its pixels */
+    QImage m_image;
+    
+    /** Primitive with image as texture */
+    std::unique_ptr<GraphicsPrimitiveV3fT2f> m_graphicsPrimitive;
+};
+
 /**
  * Constructor.
  */
@@ -82,7 +106,7 @@ ImageFile::initializeMembersImageFile()
     m_controlPointFile.grabNew(new ControlPointFile());
     m_fileMetaData.grabNew(new GiftiMetaData());
     m_image = new QImage();
-    m_graphicsPrimitive.reset();
+    resetPyramid();
     m_featuresImageGraphicsPrimitive.reset();
     m_pixelPrimitiveVertexStartIndex = -1;
     m_pixelPrimitiveVertexCount      = -1;
@@ -116,7 +140,9 @@ ImageFile::ImageFile(const ImageFile& imageFile)
         /*CaretAssertMessage(0, "Need to implement copy contructor for ControlPointFile.");*/
         //m_controlPointFile.grabNew(new ControlPointFile(*imageFile.m_controlPointFile));
     }
-    m_graphicsPrimitive.reset();
+    resetPyramid();
+    m_pyramidRegionFileName      = imageFile.m_pyramidRegionFileName;
+    m_pyramidRegionFileImageSize = imageFile.m_pyramidRegionFileImageSize;
     m_featuresImageGraphicsPrimitive.reset();
     
     m_pixelPrimitiveVertexStartIndex = imageFile.m_pixelPrimitiveVertexStartIndex;;
@@ -245,6 +271,7 @@ ImageFile::ImageFile(const int imageWidth,
  */
 ImageFile::~ImageFile()
 {
+    resetPyramid();
     if (m_image != NULL) {
         delete m_image;
         m_image = NULL;
@@ -368,6 +395,7 @@ ImageFile::setFromQImage(const QImage& qimage)
         delete m_image;
     }
     m_image = new QImage(qimage);
+    resetPyramid();
     readFileMetaDataFromQImage();
     this->setModified();
 }
@@ -754,13 +782,26 @@ ImageFile::readFile(const AString& filename)
     
     this->setFileName(filename);
     
-    if ( ! m_image->load(filename)) {
+    QImageReader reader(filename);
+    const QSize fileImageSize(reader.size());
+    const QSize readImageSize(getReadImageSize(reader,
+                                               filename));
+    if (readImageSize != fileImageSize) {
+        reader.setScaledSize(readImageSize);
+    }
+    *m_image = reader.read();
+    if (m_image->isNull()) {
         clear();
         throw DataFileException(filename + "Unable to load file.");
     }
-    
-    m_image = limitImageDimensions(m_image,
-                                   filename);
+    if ((readImageSize != fileImageSize)
+        && reader.supportsOption(QImageIOHandler::ClipRect)) {
+        /*
+         * Pyramid reads higher resolution regions from the file
+         */
+        m_pyramidRegionFileName      = filename;
+        m_pyramidRegionFileImageSize = fileImageSize;
+    }
     
     /*
      * Format must be RGB or ARGB for compatibility with OpenGL
@@ -773,62 +814,78 @@ ImageFile::readFile(const AString& filename)
 }
 
 /**
- * Limit the dimensions of an the image
- * @param image
- *    Image that is limited in dimensions
+ * In the GUI, an image that is too big for an OpenGL texture is read at a reduced size,
+ * as the full resolution image may use a very large amount of memory.  If the file
+ * format can read regions of the image, the size is a layer of the image's pyramid
+ * and higher resolution regions are read from the file when drawn zoomed in.
+ * Otherwise, the image is limited to the maximum texture dimension.
+ * @param reader
+ *    Reader for the image file
  * @param filename
  *    Name of image file
  * @return
- *    Original image or new image that is resized version of original image
+ *    Size for reading the image
  */
-QImage*
-ImageFile::limitImageDimensions(QImage* image,
-                                const AString& filename)
+QSize
+ImageFile::getReadImageSize(QImageReader& reader,
+                            const AString& filename)
 {
-    QImage* imageOut(image);
+    const QSize fileImageSize(reader.size());
+    if ( ! fileImageSize.isValid()) {
+        return fileImageSize;
+    }
     
-    if ( ! image->isNull()) {
-        switch (ApplicationInformation::getApplicationType()) {
-            case ApplicationTypeEnum::APPLICATION_TYPE_COMMAND_LINE:
-                break;
-            case ApplicationTypeEnum::APPLICATION_TYPE_GRAPHICAL_USER_INTERFACE:
-            {
-                const int32_t width(image->width());
-                const int32_t height(image->height());
-                const int32_t maxDim(GraphicsUtilitiesOpenGL::getTextureWidthHeightMaximumDimension());
-                if ((width > maxDim)
-                    || (height > maxDim)) {
-                    QImage newImage;
-                    if (width > height) {
-                        newImage = image->scaledToWidth(maxDim);
-                    }
-                    else {
-                        newImage = image->scaledToHeight(maxDim);
-                    }
-                    if ( ! newImage.isNull()) {
-                        delete image;
-                        imageOut = new QImage(newImage);
-                        CaretLogWarning("Rescaled image "
-                                        + filename
-                                        + " from size ("
-                                        + AString::number(width)
-                                        + ", "
-                                        + AString::number(height)
-                                        + ") to ("
-                                        + AString::number(imageOut->width())
-                                        + ", "
-                                        + AString::number(imageOut->height())
-                                        + ")");
-                    }
-                }
-            }
-                break;
-            case ApplicationTypeEnum::APPLICATION_TYPE_INVALID:
-                break;
-        }
+    switch (ApplicationInformation::getApplicationType()) {
+        case ApplicationTypeEnum::APPLICATION_TYPE_COMMAND_LINE:
+            return fileImageSize;
+            break;
+        case ApplicationTypeEnum::APPLICATION_TYPE_GRAPHICAL_USER_INTERFACE:
+            break;
+        case ApplicationTypeEnum::APPLICATION_TYPE_INVALID:
+            return fileImageSize;
+            break;
     }
     
-    return imageOut;
+    const int32_t maxDim(GraphicsUtilitiesOpenGL::getTextureWidthHeightMaximumDimension());
+    if ((maxDim <= 0)
+        || ((fileImageSize.width() <= maxDim)
+            && (fileImageSize.height() <= maxDim))) {
+        return fileImageSize;
+    }
+    
+    QSize readSize;
+    if (reader.supportsOption(QImageIOHandler::ClipRect)) {
+        readSize = ImageFilePyramid::getLayerSizeForMaximumDimension(fileImageSize,
+                                                                     maxDim);
+        CaretLogInfo("Reading image "
+                     + filename
+                     + " of size ("
+                     + AString::number(fileImageSize.width())
+                     + ", "
+                     + AString::number(fileImageSize.height())
+                     + ") at size ("
+                     + AString::number(readSize.width())
+                     + ", "
+                     + AString::number(readSize.height())
+                     + "), higher resolution regions are read when zoomed in");
+    }
+    else {
+        readSize = fileImageSize.scaled(maxDim,
+                                        maxDim,
+                                        Qt::KeepAspectRatio);
+        CaretLogWarning("Rescaled image "
+                        + filename
+                        + " from size ("
+                        + AString::number(fileImageSize.width())
+                        + ", "
+                        + AString::number(fileImageSize.height())
+                        + ") to ("
+                        + AString::number(readSize.width())
+                        + ", "
+                        + AString::number(readSize.height())
+                        + ")");
+    }
+    return readSize;
 }
 
 /**
@@ -851,6 +908,7 @@ ImageFile::insertImage(const QImage& otherImage,
                            *m_image,
                            x,
                            y);
+    resetPyramid();
     this->setModified();
 }
 
@@ -1122,6 +1180,14 @@ ImageFile::writeFile(const AString& filename)
         writer.setCompression(1);
     }
     
+    /*
+     * Higher resolution regions can no longer be read from a file that is replaced
+     */
+    if ( ! m_pyramidRegionFileName.isEmpty()
+        && (FileInformation(filename).getAbsoluteFilePath() == FileInformation(m_pyramidRegionFileName).getAbsoluteFilePath())) {
+        resetPyramid();
+    }
+    
     writeFileMetaDataToQImage();
     
     if ( ! writer.write(*m_image)) {
@@ -1162,6 +1228,7 @@ ImageFile::resizeToWidth(const int32_t width)
     CaretAssert(m_image);
     *m_image = m_image->scaledToWidth(width,
                                       Qt::SmoothTransformation);
+    resetPyramid();
     
     *m_fileMetaData = fileMetaDataCopy;
 }
@@ -1181,6 +1248,7 @@ ImageFile::resizeToHeight(const int32_t height)
     CaretAssert(m_image);
     *m_image = m_image->scaledToHeight(height,
                                        Qt::SmoothTransformation);
+    resetPyramid();
     
     *m_fileMetaData = fileMetaDataCopy;
 }
@@ -1203,6 +1271,7 @@ ImageFile::resizeToMaximumWidth(const int32_t maximumWidth)
         GiftiMetaData fileMetaDataCopy(*m_fileMetaData);
         *m_image = m_image->scaledToWidth(maximumWidth,
                                           Qt::SmoothTransformation);
+        resetPyramid();
         *m_fileMetaData = fileMetaDataCopy;
     }
 }
@@ -1225,6 +1294,7 @@ ImageFile::resizeToMaximumHeight(const int32_t maximumHeight)
         GiftiMetaData fileMetaDataCopy(*m_fileMetaData);
         *m_image = m_image->scaledToHeight(maximumHeight,
                                           Qt::SmoothTransformation);
+        resetPyramid();
         *m_fileMetaData = fileMetaDataCopy;
     }
 }
@@ -1466,6 +1536,11 @@ ImageFile::setPixelRGBA(const int32_t /*tabIndex*/,
                         const uint8_t pixelRGBA[4])
 {
     if (m_image != NULL) {
+        /*
+         * Reset before modifying so that the pyramid's shared copy
+         * of the pixels does not force a copy of the image
+         */
+        resetPyramid();
         const int64_t pixelI(pixelLogicalIndex.getI());
         const int64_t pixelJ(pixelLogicalIndex.getJ());
         m_image->setPixelColor(pixelI, pixelJ, QColor(pixelRGBA[0],
@@ -1494,6 +1569,7 @@ ImageFile::setPixelRGBA(const int32_t /*tabIndex*/,
                         const uint8_t pixelRGBA[4])
 {
     if (m_image != NULL) {
+        resetPyramid();
         const int64_t pixelI(pixelIndex.getI());
         const int64_t pixelJ(pixelIndex.getJ());
         m_image->setPixelColor(pixelI, pixelJ, QColor(pixelRGBA[0],
@@ -1525,6 +1601,7 @@ ImageFile::setPixelRGBA(const int32_t /*tabIndex*/,
                         const uint8_t pixelRGBA[4])
 {
     if (m_image != NULL) {
+        resetPyramid();
         m_image->setPixelColor(pixelI, pixelJ, QColor(pixelRGBA[0],
                                                       pixelRGBA[1],
                                                       pixelRGBA[2],
@@ -1564,6 +1641,7 @@ ImageFile::setPixelRowRGBA(const int32_t rowIndex,
         return;
     }
     
+    resetPyramid();
     uint8_t* rowByteColor(m_image->scanLine(rowIndex));
     uint32_t* rowIntColor((uint32_t*)rowByteColor);
     switch (m_image->format()) {
@@ -1779,6 +1857,8 @@ ImageFile::setImageFromByteArray(const QByteArray& byteArray,
                                             format.toLatin1().data());
     }
     
+    resetPyramid();
+    
     if ( ! successFlag) {
         CaretLogSevere(getFileName()
                        + " Failed to create image from byte array.");
@@ -2004,6 +2084,285 @@ ImageFile::getGraphicsPrimitiveForFeaturesImageDrawing() const
     return m_featuresImageGraphicsPrimitive.get();
 }
 
+/**
+ * Update the region of the image that is loaded for drawing in a tab and overlay.
+ * A large image is drawn using a region of the layer of the image's pyramid
+ * that matches the current zoom (the same criteria used for CZI images) so that
+ * texture size remains limited.  Small images are always drawn in full.
+ *
+ * @param tabIndex
+ *    Index of tab where image is drawn
+ * @param overlayIndex
+ *    Index of overlay
+ * @param coordinateMode
+ *    Coordinate mode (pixel or plane)
+ * @param transform
+ *    Transforms from/to viewport and model coordinates
+ */
+void
+ImageFile::updateImageForDrawingInTab(const int32_t tabIndex,
+                                      const int32_t overlayIndex,
+                                      const MediaDisplayCoordinateModeEnum::Enum coordinateMode,
+                                      const GraphicsObjectToWindowTransform* transform)
+{
+    const std::pair<int32_t, int32_t> tabOverlayKey(tabIndex, overlayIndex);
+    
+    const ImageFilePyramid* pyramid(getPyramid());
+    if ((pyramid == NULL)
+        || (transform == NULL)
+        || ( ! transform->isValid())) {
+        m_pyramidRegions.erase(tabOverlayKey);
+        return;
+    }
+    
+    /*
+     * Compute pixel height of the image when drawn in the window.
+     * The size of the image, in pixels when drawn, determines the pyramid layer.
+     */
+    float imageBottomLeftWindow[3];
+    float imageTopLeftWindow[3];
+    switch (coordinateMode) {
+        case MediaDisplayCoordinateModeEnum::PIXEL:
+        {
+            const float imageBottomLeftPixel[3] { 0.0, static_cast<float>(getHeight()), 0.0 };
+            const float imageTopLeftPixel[3] { 0.0, 0.0, 0.0 };
+            transform->transformPoint(imageBottomLeftPixel, imageBottomLeftWindow);
+            transform->transformPoint(imageTopLeftPixel, imageTopLeftWindow);
+        }
+            break;
+        case MediaDisplayCoordinateModeEnum::PLANE:
+        {
+            if ( ! isPlaneXyzSupported()) {
+                m_pyramidRegions.erase(tabOverlayKey);
+                return;
+            }
+            const Vector3D imageBottomLeftPlane(getPlaneXyzBottomLeft());
+            const Vector3D imageTopLeftPlane(getPlaneXyzTopLeft());
+            transform->transformPoint(imageBottomLeftPlane, imageBottomLeftWindow);
+            transform->transformPoint(imageTopLeftPlane, imageTopLeftWindow);
+        }
+            break;
+    }
+    const float drawnPixelHeight(std::fabs(imageTopLeftWindow[1] - imageBottomLeftWindow[1]));
+    const int32_t layerIndex(pyramid->getLayerIndexForDrawnHeight(drawnPixelHeight));
+    
+    const QRectF imageLogicalRect(0, 0, getWidth(), getHeight());
+    const QRectF viewportLogicalRect(getViewportLogicalRect(coordinateMode,
+                                                            transform).intersected(imageLogicalRect));
+    
+    std::unique_ptr<PyramidRegion>& region(m_pyramidRegions[tabOverlayKey]);
+    if (region) {
+        if (viewportLogicalRect.isEmpty()) {
+            /*
+             * Image is not in viewport, keep what is loaded
+             */
+            return;
+        }
+        if ((region->m_layerIndex == layerIndex)
+            && (region->m_coordinateMode == coordinateMode)
+            && region->m_logicalRect.contains(viewportLogicalRect)) {
+            return;
+        }
+    }
+    
+    /*
+     * Load all of a layer that is small enough for a texture.  Otherwise,
+     * load a region of the layer centered on a grid so that small pans
+     * of the image do not require loading a new region.
+     */
+    QRectF logicalRectToLoad(imageLogicalRect);
+    const QSize layerSize(pyramid->getLayerSize(layerIndex));
+    if ((layerSize.width() > s_pyramidMaximumRegionDimension)
+        || (layerSize.height() > s_pyramidMaximumRegionDimension)) {
+        const float regionWidth(s_pyramidMaximumRegionDimension
+                                * (imageLogicalRect.width() / layerSize.width()));
+        const float regionHeight(s_pyramidMaximumRegionDimension
+                                 * (imageLogicalRect.height() / layerSize.height()));
+        const float gridDivisions(4.0);
+        const float gridX(regionWidth / gridDivisions);
+        const float gridY(regionHeight / gridDivisions);
+        const QPointF center(viewportLogicalRect.isEmpty()
+                             ? imageLogicalRect.center()
+                             : viewportLogicalRect.center());
+        const float centerX(std::round(center.x() / gridX) * gridX);
+        const float centerY(std::round(center.y() / gridY) * gridY);
+        logicalRectToLoad = QRectF(centerX - (regionWidth / 2.0),
+                                   centerY - (regionHeight / 2.0),
+                                   regionWidth,
+                                   regionHeight);
+        if ( ! logicalRectToLoad.contains(viewportLogicalRect)) {
+            /*
+             * Viewport is larger than a region (very large window)
+             */
+            logicalRectToLoad = logicalRectToLoad.united(viewportLogicalRect);
+        }
+        logicalRectToLoad = logicalRectToLoad.intersected(imageLogicalRect);
+    }
+    
+    std::unique_ptr<PyramidRegion> newRegion(new PyramidRegion());
+    newRegion->m_layerIndex     = layerIndex;
+    newRegion->m_coordinateMode = coordinateMode;
+    newRegion->m_image = pyramid->getLayerRegion(layerIndex,
+                                                 logicalRectToLoad,
+                                                 newRegion->m_logicalRect);
+    if (newRegion->m_image.isNull()) {
+        m_pyramidRegions.erase(tabOverlayKey);
+        return;
+    }
+    newRegion->m_graphicsPrimitive.reset(createGraphicsPrimitive(newRegion->m_image,
+                                                                 newRegion->m_logicalRect));
+    
+    if (imageDebugFlag) {
+        std::cout << "Loaded pyramid layer " << layerIndex
+        << " region (" << newRegion->m_image.width() << ", " << newRegion->m_image.height()
+        << ") for " << getFileNameNoPath() << std::endl;
+    }
+    
+    region = std::move(newRegion);
+}
+
+/**
+ * @return Pixel coordinates (of the image) of the viewport
+ * @param coordinateMode
+ *    Coordinate mode (pixel or plane)
+ * @param transform
+ *    Transforms from/to viewport and model coordinates
+ */
+QRectF
+ImageFile::getViewportLogicalRect(const MediaDisplayCoordinateModeEnum::Enum coordinateMode,
+                                  const GraphicsObjectToWindowTransform* transform) const
+{
+    /*
+     * Enlarge the viewport a little bit so that new image data is
+     * loaded just before the edge of the loaded region is panned
+     * into the viewport.
+     */
+    const std::array<float, 4> viewportArray(transform->getViewport());
+    QRectF viewport(viewportArray[0],
+                    viewportArray[1],
+                    viewportArray[2],
+                    viewportArray[3]);
+    const float mv(10);
+    const QMarginsF margins(mv, mv, mv, mv);
+    viewport = viewport.marginsAdded(margins);
+    
+    /*
+     * 'inverseTransformPoint()' transforms from window coordinates to
+     * pixel coordinates (PIXEL) or plane coordinates (PLANE)
+     */
+    std::vector<Vector3D> viewportCorners;
+    for (const QPointF& windowXY : { viewport.topLeft(), viewport.topRight(),
+                                     viewport.bottomLeft(), viewport.bottomRight() }) {
+        Vector3D xyz;
+        transform->inverseTransformPoint(windowXY.x(),
+                                         windowXY.y(),
+                                         0.0,
+                                         xyz);
+        viewportCorners.push_back(xyz);
+    }
+    
+    BoundingBox boundingBox;
+    boundingBox.resetForUpdate();
+    for (const Vector3D& xyz : viewportCorners) {
+        switch (coordinateMode) {
+            case MediaDisplayCoordinateModeEnum::PIXEL:
+                boundingBox.update(xyz[0], xyz[1], 0.0);
+                break;
+            case MediaDisplayCoordinateModeEnum::PLANE:
+            {
+                PixelLogicalIndex pixelLogicalIndex;
+                planeXyzToLogicalPixelIndex(xyz,
+                                            pixelLogicalIndex);
+                boundingBox.update(pixelLogicalIndex.getI(), pixelLogicalIndex.getJ(), 0.0);
+            }
+                break;
+        }
+    }
+    
+    return QRectF(boundingBox.getMinX(),
+                  boundingBox.getMinY(),
+                  boundingBox.getDifferenceX(),
+                  boundingBox.getDifferenceY());
+}
+
+/**
+ * @return The pyramid for the image or NULL if the image is small and does not use a pyramid.
+ * The pyramid is created when first needed.
+ */
+const ImageFilePyramid*
+ImageFile::getPyramid() const
+{
+    if (m_image == NULL) {
+        return NULL;
+    }
+    if ((m_image->width() <= s_pyramidMinimumImageDimension)
+        && (m_image->height() <= s_pyramidMinimumImageDimension)
+        && m_pyramidRegionFileName.isEmpty()) {
+        return NULL;
+    }
+    
+    if ( ! m_pyramid) {
+        /*
+         * Format must be RGB or ARGB for compatibility with OpenGL
+         */
+        verifyFormatCompatibleWithOpenGL();
+        if (m_pyramidRegionFileName.isEmpty()) {
+            m_pyramid.reset(new ImageFilePyramid(*m_image));
+        }
+        else {
+            m_pyramid.reset(new ImageFilePyramid(*m_image,
+                                                 m_pyramidRegionFileName,
+                                                 m_pyramidRegionFileImageSize));
+        }
+        if (imageDebugFlag) {
+            std::cout << getFileNameNoPath() << " " << m_pyramid->toString() << std::endl;
+        }
+    }
+    return m_pyramid.get();
+}
+
+/**
+ * Reset the pyramid and any primitives that use its images.  Must be
+ * called when the image is replaced or modified.  Since the image no
+ * longer matches its file, higher resolution regions are no longer
+ * read from the file.
+ */
+void
+ImageFile::resetPyramid() const
+{
+    m_graphicsPrimitive.reset();
+    m_pyramidRegions.clear();
+    m_pyramid.reset();
+    m_pyramidRegionFileName.clear();
+    m_pyramidRegionFileImageSize = QSize();
+}
+
+/**
+ * @return Primitive for the pyramid region loaded for the tab and overlay or NULL if not available
+ * @param tabIndex
+ *    Index of tab where image is drawn
+ * @param overlayIndex
+ *    Index of overlay
+ * @param coordinateMode
+ *    Coordinate mode (pixel or plane)
+ */
+GraphicsPrimitiveV3fT2f*
+ImageFile::getPyramidRegionPrimitive(const int32_t tabIndex,
+                                     const int32_t overlayIndex,
+                                     const MediaDisplayCoordinateModeEnum::Enum coordinateMode) const
+{
+    const auto iter(m_pyramidRegions.find(std::make_pair(tabIndex,
+                                                         overlayIndex)));
+    if (iter != m_pyramidRegions.end()) {
+        const PyramidRegion* region(iter->second.get());
+        CaretAssert(region);
+        if (region->m_coordinateMode == coordinateMode) {
+            return region->m_graphicsPrimitive.get();
+        }
+    }
+    return NULL;
+}
+
 /**
  * @return The graphics primitive for drawing the image as a texture in media drawing model.
  * @param tabIndex
@@ -2012,60 +2371,89 @@ ImageFile::getGraphicsPrimitiveForFeaturesImageDrawing() const
  *    Index of overlay
  */
 GraphicsPrimitiveV3fT2f*
-ImageFile::getGraphicsPrimitiveForMediaDrawing(const int32_t /*tabIndex*/,
-                                               const int32_t /*overlayIndex*/) const
+ImageFile::getGraphicsPrimitiveForMediaDrawing(const int32_t tabIndex,
+                                               const int32_t overlayIndex) const
 {
     if (m_image == NULL) {
         return NULL;
     }
     
-    if (m_graphicsPrimitive == NULL) {
-        GraphicsPrimitiveV3fT2f* primitive(createGraphicsPrimitive());
-        m_graphicsPrimitive.reset(primitive);
+    GraphicsPrimitiveV3fT2f* primitive(getPyramidRegionPrimitive(tabIndex,
+                                                                 overlayIndex,
+                                                                 MediaDisplayCoordinateModeEnum::PIXEL));
+    if (primitive == NULL) {
+        if (m_graphicsPrimitive == NULL) {
+            m_graphicsPrimitive.reset(createGraphicsPrimitive());
+        }
+        primitive = m_graphicsPrimitive.get();
     }
     CaretAssert(m_pixelPrimitiveVertexStartIndex >= 0);
     CaretAssert(m_pixelPrimitiveVertexCount > 0);
-    m_graphicsPrimitive->setDrawArrayIndicesSubset(m_pixelPrimitiveVertexStartIndex,
-                                                   m_pixelPrimitiveVertexCount);
-    return m_graphicsPrimitive.get();
+    primitive->setDrawArrayIndicesSubset(m_pixelPrimitiveVertexStartIndex,
+                                         m_pixelPrimitiveVertexCount);
+    return primitive;
 }
 
 /**
- * @return A new graphics primitive for loaded data for both coordinate types
+ * @return A new graphics primitive for the entire image for both coordinate types.
+ * If the image is too big for OpenGL texture limits, the largest layer of the image's
+ * pyramid that fits is used.
  */
 GraphicsPrimitiveV3fT2f*
 ImageFile::createGraphicsPrimitive() const
 {
     /*
-     * If image is too big for OpenGL texture limits, scale image to acceptable size
+     * Format must be RGB or ARGB for compatibility with OpenGL
      */
+    verifyFormatCompatibleWithOpenGL();
+    
+    const QRectF imageLogicalRect(0, 0, getWidth(), getHeight());
+    
     const int32_t maxTextureWidthHeight = GraphicsUtilitiesOpenGL::getTextureWidthHeightMaximumDimension();
     if (maxTextureWidthHeight > 0) {
-        const int32_t excessWidth(m_image->width() - maxTextureWidthHeight);
-        const int32_t excessHeight(m_image->height() - maxTextureWidthHeight);
-        if ((excessWidth > 0)
-            || (excessHeight > 0)) {
-            if (excessWidth > excessHeight) {
-                CaretLogWarning(getFileName()
-                                + " is too big for texture.  Maximum width/height is: "
-                                + AString::number(maxTextureWidthHeight)
-                                + " Image Width: "
-                                + AString::number(m_image->width())
-                                + " Image Height: "
-                                + AString::number(m_image->height()));
+        if ((m_image->width() > maxTextureWidthHeight)
+            || (m_image->height() > maxTextureWidthHeight)) {
+            const ImageFilePyramid* pyramid(getPyramid());
+            if (pyramid != NULL) {
+                const int32_t layerIndex(pyramid->getLayerIndexForMaximumDimension(maxTextureWidthHeight));
+                const QImage& layerImage(pyramid->getLayerImage(layerIndex));
+                if ( ! layerImage.isNull()) {
+                    return createGraphicsPrimitive(layerImage,
+                                                   imageLogicalRect);
+                }
             }
+            CaretLogWarning(getFileName()
+                            + " is too big for texture.  Maximum width/height is: "
+                            + AString::number(maxTextureWidthHeight)
+                            + " Image Width: "
+                            + AString::number(m_image->width())
+                            + " Image Height: "
+                            + AString::number(m_image->height()));
         }
     }
     
-    /*
-     * Format must be RGB or ARGB for compatibility with OpenGL
-     */
-    verifyFormatCompatibleWithOpenGL();
-    
+    return createGraphicsPrimitive(*m_image,
+                                   imageLogicalRect);
+}
+
+/**
+ * @return A new graphics primitive for both coordinate types that draws the given image
+ * as a texture.  The primitive always covers the entire image and texture coordinates
+ * outside of the image's region are drawn transparent.
+ *
+ * @param image
+ *    Image used for the texture.  It must remain valid as long as the primitive exists.
+ * @param imageLogicalRect
+ *    Pixel coordinates (of the image) of the region covered by the image
+ */
+GraphicsPrimitiveV3fT2f*
+ImageFile::createGraphicsPrimitive(const QImage& image,
+                                   const QRectF& imageLogicalRect) const
+{
     const std::array<float, 4> textureBorderColorRGBA { 0.0, 0.0, 0.0, 0.0 };
     
     GraphicsTextureSettings::PixelFormatType pixelFormat(GraphicsTextureSettings::PixelFormatType::BGRA);
-    switch (m_image->format()) {
+    switch (image.format()) {
         case QImage::Format_RGB32:  /* Contains alpha that is always 255 */
             pixelFormat = GraphicsTextureSettings::PixelFormatType::BGRX;
             break;
@@ -2095,20 +2483,40 @@ ImageFile::createGraphicsPrimitive() const
         magFilter = GraphicsTextureMagnificationFilterEnum::LINEAR;
         minFilter = GraphicsTextureMinificationFilterEnum::LINEAR_MIPMAP_LINEAR;
     }
+    
+    const float minX = 0;
+    const float maxX = getWidth();
+    const float minY = 0;
+    const float maxY = getHeight();
+    
+    /*
+     * Texture coordinates are outside [0, 1] when the image covers
+     * only a region of the full image and the border (transparent)
+     * color is used outside of the region.
+     */
+    const bool fullImageFlag((imageLogicalRect.left() <= minX)
+                             && (imageLogicalRect.right() >= maxX)
+                             && (imageLogicalRect.top() <= minY)
+                             && (imageLogicalRect.bottom() >= maxY));
+    const GraphicsTextureSettings::WrappingType wrappingType(fullImageFlag
+                                                             ? GraphicsTextureSettings::WrappingType::CLAMP
+                                                             : GraphicsTextureSettings::WrappingType::CLAMP_TO_BORDER);
+    
     /*
      * Compress texture if image is large and compression is enabled
      */
-    const GraphicsTextureSettings::CompressionType textureCompressionType(isImageTextureCompressed()
+    const GraphicsTextureSettings::CompressionType textureCompressionType((fullImageFlag
+                                                                           && isImageTextureCompressed())
                                                                           ? GraphicsTextureSettings::CompressionType::ENABLED
                                                                           : GraphicsTextureSettings::CompressionType::DISABLED);
-    GraphicsTextureSettings textureSettings(m_image->constBits(),
-                                            m_image->width(),
-                                            m_image->height(),
+    GraphicsTextureSettings textureSettings(image.constBits(),
+                                            image.width(),
+                                            image.height(),
                                             1, /* slices */
                                             GraphicsTextureSettings::DimensionType::FLOAT_STR_2D,
                                             pixelFormat,
                                             GraphicsTextureSettings::PixelOrigin::TOP_LEFT,
-                                            GraphicsTextureSettings::WrappingType::CLAMP,
+                                            wrappingType,
                                             GraphicsTextureSettings::MipMappingType::ENABLED,
                                             textureCompressionType,
                                             magFilter,
@@ -2117,30 +2525,27 @@ ImageFile::createGraphicsPrimitive() const
     GraphicsPrimitiveV3fT2f* primitive = GraphicsPrimitive::newPrimitiveV3fT2f(GraphicsPrimitive::PrimitiveType::OPENGL_TRIANGLE_STRIP,
                                                                                textureSettings);
     
+    const float minTextureS((minX - imageLogicalRect.left()) / imageLogicalRect.width());
+    const float maxTextureS((maxX - imageLogicalRect.left()) / imageLogicalRect.width());
+    const float minTextureT((minY - imageLogicalRect.top()) / imageLogicalRect.height());
+    const float maxTextureT((maxY - imageLogicalRect.top()) / imageLogicalRect.height());
+    
     /*
      * Create a primitive for PIXEL coordinates
      *
      * Coordinates at EDGE of the pixels
-     */
-    const float minX = 0;
-    const float maxX = getWidth();
-    const float minY = 0;
-    const float maxY = getHeight();
-    
-    /*
+     *
      * A Triangle Strip (consisting of two triangles) is used
      * for drawing the image.
      * The order of the vertices in the triangle strip is
      * Top Left, Bottom Left, Top Right, Bottom Right.
      * ORIGIN IS AT TOP LEFT
      */
-    const float minTextureST(0.0);
-    const float maxTextureST(1.0);
     m_pixelPrimitiveVertexStartIndex = primitive->getNumberOfVertices();
-    primitive->addVertex(minX, minY, minTextureST, minTextureST);  /* Top Left */
-    primitive->addVertex(minX, maxY, minTextureST, maxTextureST);  /* Bottom Left */
-    primitive->addVertex(maxX, minY, maxTextureST, minTextureST);  /* Top Right */
-    primitive->addVertex(maxX, maxY, maxTextureST, maxTextureST);  /* Bottom Right */
+    primitive->addVertex(minX, minY, minTextureS, minTextureT);  /* Top Left */
+    primitive->addVertex(minX, maxY, minTextureS, maxTextureT);  /* Bottom Left */
+    primitive->addVertex(maxX, minY, maxTextureS, minTextureT);  /* Top Right */
+    primitive->addVertex(maxX, maxY, maxTextureS, maxTextureT);  /* Bottom Right */
     m_pixelPrimitiveVertexCount = (primitive->getNumberOfVertices()
                                    - m_pixelPrimitiveVertexStartIndex);
     
@@ -2155,17 +2560,15 @@ ImageFile::createGraphicsPrimitive() const
          * Top Left, Bottom Left, Top Right, Bottom Right.
          * ORIGIN IS AT TOP LEFT
          */
-        const float minTextureST(0.0);
-        const float maxTextureST(1.0);
         const Vector3D coordinateTopLeft(getPlaneXyzTopLeft());
         const Vector3D coordinateTopRight(getPlaneXyzTopRight());
         const Vector3D coordinateBottomLeft(getPlaneXyzBottomLeft());
         const Vector3D coordinateBottomRight(getPlaneXyzBottomRight());
         m_planePrimitiveVertexStartIndex = primitive->getNumberOfVertices();
-        primitive->addVertex(coordinateTopLeft[0],     coordinateTopLeft[1],     minTextureST, minTextureST);  /* Top Left */
-        primitive->addVertex(coordinateBottomLeft[0],  coordinateBottomLeft[1],  minTextureST, maxTextureST);  /* Bottom Left */
-        primitive->addVertex(coordinateTopRight[0],    coordinateTopRight[1],    maxTextureST, minTextureST);  /* Top Right */
-        primitive->addVertex(coordinateBottomRight[0], coordinateBottomRight[1], maxTextureST, maxTextureST);  /* Bottom Right */
+        primitive->addVertex(coordinateTopLeft[0],     coordinateTopLeft[1],     minTextureS, minTextureT);  /* Top Left */
+        primitive->addVertex(coordinateBottomLeft[0],  coordinateBottomLeft[1],  minTextureS, maxTextureT);  /* Bottom Left */
+        primitive->addVertex(coordinateTopRight[0],    coordinateTopRight[1],    maxTextureS, minTextureT);  /* Top Right */
+        primitive->addVertex(coordinateBottomRight[0], coordinateBottomRight[1], maxTextureS, maxTextureT);  /* Bottom Right */
         m_planePrimitiveVertexCount = (primitive->getNumberOfVertices()
                                        - m_planePrimitiveVertexStartIndex);
     }
@@ -2703,8 +3106,8 @@ ImageFile::findPixelNearestStereotaxicXYZ(const Vector3D& xyz,
  *    Index of overlay
  */
 GraphicsPrimitiveV3fT2f*
-ImageFile::getGraphicsPrimitiveForPlaneXyzDrawing(const int32_t /*tabIndex*/,
-                                                  const int32_t /*overlayIndex*/) const
+ImageFile::getGraphicsPrimitiveForPlaneXyzDrawing(const int32_t tabIndex,
+                                                  const int32_t overlayIndex) const
 {
     if (m_image == NULL) {
         return NULL;
@@ -2714,15 +3117,20 @@ ImageFile::getGraphicsPrimitiveForPlaneXyzDrawing(const int32_t /*tabIndex*/,
         return NULL;
     }
     
-    if (m_graphicsPrimitive == NULL) {
-        GraphicsPrimitiveV3fT2f* primitive(createGraphicsPrimitive());
-        m_graphicsPrimitive.reset(primitive);
+    GraphicsPrimitiveV3fT2f* primitive(getPyramidRegionPrimitive(tabIndex,
+                                                                 overlayIndex,
+                                                                 MediaDisplayCoordinateModeEnum::PLANE));
+    if (primitive == NULL) {
+        if (m_graphicsPrimitive == NULL) {
+            m_graphicsPrimitive.reset(createGraphicsPrimitive());
+        }
+        primitive = m_graphicsPrimitive.get();
     }
     CaretAssert(m_planePrimitiveVertexStartIndex >= 0);
     CaretAssert(m_planePrimitiveVertexCount > 0);
-    m_graphicsPrimitive->setDrawArrayIndicesSubset(m_planePrimitiveVertexStartIndex,
-                                                   m_planePrimitiveVertexCount);
-    return m_graphicsPrimitive.get();
+    primitive->setDrawArrayIndicesSubset(m_planePrimitiveVertexStartIndex,
+                                         m_planePrimitiveVertexCount);
+    return primitive;
 }
 
 /**
@@ -22,20 +22,25 @@
 #define __IMAGE_FILE_H__
 
 #include <array>
+#include <map>
 #include <memory>
 
 #include <QRect>
+#include <QSize>
 
 #include "MediaFile.h"
 #include "CaretPointer.h"
 
 class QColor;
 class QImage;
+class QImageReader;
 
 namespace caret {
     class ControlPointFile;
     class ControlPoint3D;
+    class GraphicsObjectToWindowTransform;
     class GraphicsPrimitiveV3fT2f;
+    class ImageFilePyramid;
     class RectangleTransform;
     class VolumeFile;
     
@@ -213,6 +218,11 @@ public:
 
     virtual GraphicsPrimitiveV3fT2f* getGraphicsPrimitiveForFeaturesImageDrawing() const;
     
+    void updateImageForDrawingInTab(const int32_t tabIndex,
+                                    const int32_t overlayIndex,
+                                    const MediaDisplayCoordinateModeEnum::Enum coordinateMode,
+                                    const GraphicsObjectToWindowTransform* transform);
+    
     virtual GraphicsPrimitiveV3fT2f* getGraphicsPrimitiveForMediaDrawing(const int32_t tabIndex,
                                                                          const int32_t overlayIndex) const override; 
     
@@ -280,9 +290,9 @@ private:
                             const int positionX,
                             const int positionY);
     
-    static QImage* limitImageDimensions(QImage* image,
-                                        const AString& filename);
-
+    static QSize getReadImageSize(QImageReader& reader,
+                                  const AString& filename);
+    
     void readFileMetaDataFromQImage();
     
     void writeFileMetaDataToQImage() const;
@@ -291,8 +301,22 @@ private:
     
     void verifyFormatCompatibleWithOpenGL() const;
     
+    const ImageFilePyramid* getPyramid() const;
+    
+    void resetPyramid() const;
+    
+    QRectF getViewportLogicalRect(const MediaDisplayCoordinateModeEnum::Enum coordinateMode,
+                                  const GraphicsObjectToWindowTransform* transform) const;
+    
+    GraphicsPrimitiveV3fT2f* getPyramidRegionPrimitive(const int32_t tabIndex,
+                                                       const int32_t overlayIndex,
+                                                       const MediaDisplayCoordinateModeEnum::Enum coordinateMode) const;
+    
     GraphicsPrimitiveV3fT2f* createGraphicsPrimitive() const;
     
+    GraphicsPrimitiveV3fT2f* createGraphicsPrimitive(const QImage& image,
+                                                     const QRectF& imageLogicalRect) const;
+    
     mutable QImage* m_image;
     
     mutable CaretPointer<GiftiMetaData> m_fileMetaData;
@@ -311,12 +335,32 @@ private:
     
     mutable int32_t m_planePrimitiveVertexCount = -1;
     
+    /** Multi-resolution pyramid, created when a large image is first drawn */
+    mutable std::unique_ptr<ImageFilePyramid> m_pyramid;
+    
+    /** When the image was read at a reduced size, file from which the pyramid reads higher resolution regions (empty if none) */
+    mutable AString m_pyramidRegionFileName;
+    
+    /** Full resolution size of the image in the pyramid region file */
+    mutable QSize m_pyramidRegionFileImageSize;
+    
+    class PyramidRegion;
+    
+    /** Region of a pyramid layer loaded for drawing in a tab and overlay */
+    mutable std::map<std::pair<int32_t, int32_t>, std::unique_ptr<PyramidRegion>> m_pyramidRegions;
+    
     static const AString SCENE_VERSION_NUMBER;
 
+    static const int32_t s_pyramidMinimumImageDimension;
+    
+    static const int32_t s_pyramidMaximumRegionDimension;
+
 };
 
 #ifdef __IMAGE_FILE_DECLARE__
     const AString ImageFile::SCENE_VERSION_NUMBER = "SCENE_VERSION_NUMBER";
+    const int32_t ImageFile::s_pyramidMinimumImageDimension = 4096;
+    const int32_t ImageFile::s_pyramidMaximumRegionDimension = 2048;
 #endif // __IMAGE_FILE_DECLARE__
 
 } // namespace
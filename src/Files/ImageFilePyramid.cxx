@@ -0,0 +1,386 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#define __IMAGE_FILE_PYRAMID_DECLARE__
+#include "ImageFilePyramid.h"
+#undef __IMAGE_FILE_PYRAMID_DECLARE__
+
+#include <algorithm>
+#include <cmath>
+
+#include <QImageReader>
+
+#include "CaretAssert.h"
+#include "CaretLogger.h"
+
+using namespace caret;
+
+/**
+ * \class caret::ImageFilePyramid
+ * \brief Multi-resolution pyramid of an image file's image
+ * \ingroup Files
+ *
+ * Each layer is half the width and height of the next higher resolution
+ * layer.  As in a CZI file, layer zero has the lowest resolution and the
+ * last layer is the full resolution image.  Lower resolution layers are
+ * created by downsampling when first requested so that drawing a large
+ * image zoomed out uses a small texture instead of the full image.
+ *
+ * A very large image is read at a reduced size.  When its file format can
+ * read regions, layers with higher resolution than the reduced image are
+ * never held in memory, only the regions being drawn are read from the file.
+ */
+
+/**
+ * Constructor for a pyramid whose full resolution layer is the image.
+ * @param image
+ *    The image.  Pixel data is shared with (not copied from) this image.
+ */
+ImageFilePyramid::ImageFilePyramid(const QImage& image)
+: CaretObject(),
+m_image(image)
+{
+    if (m_image.isNull()) {
+        return;
+    }
+    
+    createLayerSizes(m_image.size());
+    m_imageLayerIndex = getFullResolutionLayerIndex();
+}
+
+/**
+ * Constructor for a pyramid of an image that was read at a reduced size.
+ * @param image
+ *    The image, its size must be one of the layer sizes of the full resolution image.
+ *    Pixel data is shared with (not copied from) this image.
+ * @param regionFileName
+ *    Name of the file that regions of the higher resolution layers are read from
+ * @param regionFileImageSize
+ *    Full resolution size of the image in the file
+ */
+ImageFilePyramid::ImageFilePyramid(const QImage& image,
+                                   const AString& regionFileName,
+                                   const QSize& regionFileImageSize)
+: CaretObject(),
+m_image(image),
+m_regionFileName(regionFileName)
+{
+    if (m_image.isNull()) {
+        return;
+    }
+    
+    createLayerSizes(regionFileImageSize);
+    const auto iter(std::find(m_layerSizes.begin(),
+                              m_layerSizes.end(),
+                              m_image.size()));
+    if (iter != m_layerSizes.end()) {
+        m_imageLayerIndex = std::distance(m_layerSizes.begin(),
+                                          iter);
+    }
+    else {
+        CaretLogWarning("Image size does not match a pyramid layer of "
+                        + regionFileName
+                        + ", higher resolutions will not be read from the file");
+        createLayerSizes(m_image.size());
+        m_imageLayerIndex = getFullResolutionLayerIndex();
+    }
+}
+
+/**
+ * Create the sizes of the layers.
+ * @param fullResolutionSize
+ *    Size of the full resolution layer
+ */
+void
+ImageFilePyramid::createLayerSizes(const QSize& fullResolutionSize)
+{
+    m_layerSizes.clear();
+    QSize layerSize(fullResolutionSize);
+    m_layerSizes.push_back(layerSize);
+    while (std::max(layerSize.width(), layerSize.height()) > s_minimumLayerDimension) {
+        layerSize = getNextLowerResolutionLayerSize(layerSize);
+        m_layerSizes.push_back(layerSize);
+    }
+    std::reverse(m_layerSizes.begin(),
+                 m_layerSizes.end());
+    
+    m_layerImages.clear();
+    m_layerImages.resize(m_layerSizes.size());
+}
+
+/**
+ * @return Size of the layer with half the resolution of a layer
+ * @param layerSize
+ *    Size of the layer
+ */
+QSize
+ImageFilePyramid::getNextLowerResolutionLayerSize(const QSize& layerSize)
+{
+    return QSize(std::max(1, (layerSize.width() + 1) / 2),
+                 std::max(1, (layerSize.height() + 1) / 2));
+}
+
+/**
+ * @return Size of the highest resolution pyramid layer of an image whose
+ * width and height do not exceed the maximum.
+ * @param fullResolutionSize
+ *    Size of the full resolution image
+ * @param maximumWidthHeight
+ *    The maximum width and height
+ */
+QSize
+ImageFilePyramid::getLayerSizeForMaximumDimension(const QSize& fullResolutionSize,
+                                                  const int32_t maximumWidthHeight)
+{
+    QSize layerSize(fullResolutionSize);
+    while ((std::max(layerSize.width(), layerSize.height()) > maximumWidthHeight)
+           && (std::max(layerSize.width(), layerSize.height()) > 1)) {
+        layerSize = getNextLowerResolutionLayerSize(layerSize);
+    }
+    return layerSize;
+}
+
+/**
+ * Destructor.
+ */
+ImageFilePyramid::~ImageFilePyramid()
+{
+}
+
+/**
+ * @return Number of layers in the pyramid (zero if image is invalid)
+ */
+int32_t
+ImageFilePyramid::getNumberOfLayers() const
+{
+    return m_layerSizes.size();
+}
+
+/**
+ * @return Index of the full resolution layer
+ */
+int32_t
+ImageFilePyramid::getFullResolutionLayerIndex() const
+{
+    return (getNumberOfLayers() - 1);
+}
+
+/**
+ * @return Width and height of the given layer
+ * @param layerIndex
+ *    Index of the layer
+ */
+QSize
+ImageFilePyramid::getLayerSize(const int32_t layerIndex) const
+{
+    CaretAssertVectorIndex(m_layerSizes, layerIndex);
+    return m_layerSizes[layerIndex];
+}
+
+/**
+ * Find the lowest resolution layer that is at least as tall as the image is when drawn
+ * (same criteria used for selecting CZI pyramid layers).
+ * @param drawnPixelHeight
+ *    Height, in window pixels, of the full image when drawn
+ * @return Index of the layer
+ */
+int32_t
+ImageFilePyramid::getLayerIndexForDrawnHeight(const float drawnPixelHeight) const
+{
+    const int32_t numLayers(getNumberOfLayers());
+    for (int32_t i = 0; i < numLayers; i++) {
+        if (drawnPixelHeight < m_layerSizes[i].height()) {
+            return i;
+        }
+    }
+    return getFullResolutionLayerIndex();
+}
+
+/**
+ * @return Index of the highest resolution layer whose width and height do not exceed the maximum
+ * (lowest resolution layer if no layer is small enough)
+ * @param maximumWidthHeight
+ *    The maximum width and height
+ */
+int32_t
+ImageFilePyramid::getLayerIndexForMaximumDimension(const int32_t maximumWidthHeight) const
+{
+    int32_t layerIndex(0);
+    const int32_t numLayers(getNumberOfLayers());
+    for (int32_t i = 0; i < numLayers; i++) {
+        if ((m_layerSizes[i].width() <= maximumWidthHeight)
+            && (m_layerSizes[i].height() <= maximumWidthHeight)) {
+            layerIndex = i;
+        }
+    }
+    return layerIndex;
+}
+
+/**
+ * @return Image for the given layer, created by downsampling the next higher resolution layer
+ * if it does not yet exist.  Layers with higher resolution than the image are only
+ * available as regions, the image is returned for them.
+ * @param layerIndex
+ *    Index of the layer
+ */
+const QImage&
+ImageFilePyramid::getLayerImage(const int32_t layerIndex) const
+{
+    if (layerIndex >= m_imageLayerIndex) {
+        CaretAssert(layerIndex == m_imageLayerIndex);
+        return m_image;
+    }
+    
+    CaretAssertVectorIndex(m_layerImages, layerIndex);
+    if (m_layerImages[layerIndex].isNull()) {
+        const QImage& higherResolutionImage(getLayerImage(layerIndex + 1));
+        /*
+         * Smooth scaling may change the format so convert back to the
+         * format of the image (compatible with OpenGL)
+         */
+        m_layerImages[layerIndex] = higherResolutionImage.scaled(m_layerSizes[layerIndex],
+                                                                 Qt::IgnoreAspectRatio,
+                                                                 Qt::SmoothTransformation).convertToFormat(m_image.format());
+        if (m_layerImages[layerIndex].isNull()) {
+            CaretLogSevere("Failed to create image pyramid layer "
+                           + AString::number(layerIndex));
+        }
+    }
+    return m_layerImages[layerIndex];
+}
+
+/**
+ * Copy a region of a layer.  The region is expanded to whole pixels of the layer.
+ * @param layerIndex
+ *    Index of the layer
+ * @param logicalRect
+ *    The region in logical pixel coordinates (pixels of the image)
+ * @param logicalRectOut
+ *    Output with the region, in logical pixel coordinates, that is
+ *    covered by the returned image
+ * @return Image containing the region (null if region does not overlap image)
+ */
+QImage
+ImageFilePyramid::getLayerRegion(const int32_t layerIndex,
+                                 const QRectF& logicalRect,
+                                 QRectF& logicalRectOut) const
+{
+    logicalRectOut = QRectF();
+    
+    if (m_image.isNull()) {
+        return QImage();
+    }
+    
+    const QSize layerSize(getLayerSize(layerIndex));
+    const float scaleX(static_cast<float>(layerSize.width()) / m_image.width());
+    const float scaleY(static_cast<float>(layerSize.height()) / m_image.height());
+    const int32_t left(std::max(0, static_cast<int32_t>(std::floor(logicalRect.left() * scaleX))));
+    const int32_t top(std::max(0, static_cast<int32_t>(std::floor(logicalRect.top() * scaleY))));
+    const int32_t right(std::min(layerSize.width(), static_cast<int32_t>(std::ceil(logicalRect.right() * scaleX))));
+    const int32_t bottom(std::min(layerSize.height(), static_cast<int32_t>(std::ceil(logicalRect.bottom() * scaleY))));
+    if ((right <= left)
+        || (bottom <= top)) {
+        return QImage();
+    }
+    const QRect layerRect(left,
+                          top,
+                          right - left,
+                          bottom - top);
+    
+    QImage regionImage;
+    if (layerIndex > m_imageLayerIndex) {
+        regionImage = readLayerRegionFromFile(layerIndex,
+                                              layerRect);
+    }
+    else {
+        const QImage& layerImage(getLayerImage(layerIndex));
+        if ( ! layerImage.isNull()) {
+            regionImage = layerImage.copy(layerRect);
+        }
+    }
+    if (regionImage.isNull()) {
+        return QImage();
+    }
+    
+    logicalRectOut.setCoords(left / scaleX,
+                             top / scaleY,
+                             right / scaleX,
+                             bottom / scaleY);
+    return regionImage;
+}
+
+/**
+ * Read a region of a layer from the file.  Only the region is decoded
+ * when the file format supports it.
+ * @param layerIndex
+ *    Index of the layer, must be higher resolution than the image
+ * @param layerRect
+ *    The region in pixels of the layer
+ * @return Image containing the region (null if reading fails)
+ */
+QImage
+ImageFilePyramid::readLayerRegionFromFile(const int32_t layerIndex,
+                                          const QRect& layerRect) const
+{
+    CaretAssert( ! m_regionFileName.isEmpty());
+    
+    QImageReader reader(m_regionFileName);
+    if (layerIndex == getFullResolutionLayerIndex()) {
+        reader.setClipRect(layerRect);
+    }
+    else {
+        reader.setScaledSize(getLayerSize(layerIndex));
+        reader.setScaledClipRect(layerRect);
+    }
+    
+    QImage regionImage(reader.read());
+    if (regionImage.isNull()) {
+        CaretLogWarning("Failed to read region of image pyramid layer "
+                        + AString::number(layerIndex)
+                        + " from "
+                        + m_regionFileName
+                        + ": "
+                        + reader.errorString());
+        return QImage();
+    }
+    
+    /*
+     * Same format as the image (compatible with OpenGL)
+     */
+    return regionImage.convertToFormat(m_image.format());
+}
+
+/**
+ * Get a description of this object's content.
+ * @return String describing this object's content.
+ */
+AString 
+ImageFilePyramid::toString() const
+{
+    AString s("ImageFilePyramid layers:");
+    for (const auto& size : m_layerSizes) {
+        s.append(" "
+                 + AString::number(size.width())
+                 + "x"
+                 + AString::number(size.height()));
+    }
+    return s;
+}
+
@@ -0,0 +1,108 @@
+#ifndef __IMAGE_FILE_PYRAMID_H__
+#define __IMAGE_FILE_PYRAMID_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+
+#include <vector>
+
+#include <QImage>
+#include <QRect>
+#include <QRectF>
+#include <QSize>
+
+#include "CaretObject.h"
+
+namespace caret {
+
+    class ImageFilePyramid : public CaretObject {
+        
+    public:
+        ImageFilePyramid(const QImage& image);
+        
+        ImageFilePyramid(const QImage& image,
+                         const AString& regionFileName,
+                         const QSize& regionFileImageSize);
+        
+        virtual ~ImageFilePyramid();
+        
+        ImageFilePyramid(const ImageFilePyramid&) = delete;
+
+        ImageFilePyramid& operator=(const ImageFilePyramid&) = delete;
+        
+        int32_t getNumberOfLayers() const;
+        
+        int32_t getFullResolutionLayerIndex() const;
+        
+        QSize getLayerSize(const int32_t layerIndex) const;
+        
+        int32_t getLayerIndexForDrawnHeight(const float drawnPixelHeight) const;
+        
+        int32_t getLayerIndexForMaximumDimension(const int32_t maximumWidthHeight) const;
+        
+        const QImage& getLayerImage(const int32_t layerIndex) const;
+        
+        QImage getLayerRegion(const int32_t layerIndex,
+                              const QRectF& logicalRect,
+                              QRectF& logicalRectOut) const;
+
+        static QSize getLayerSizeForMaximumDimension(const QSize& fullResolutionSize,
+                                                     const int32_t maximumWidthHeight);
+
+        // ADD_NEW_METHODS_HERE
+
+        virtual AString toString() const;
+        
+    private:
+        void createLayerSizes(const QSize& fullResolutionSize);
+        
+        QImage readLayerRegionFromFile(const int32_t layerIndex,
+                                       const QRect& layerRect) const;
+        
+        static QSize getNextLowerResolutionLayerSize(const QSize& layerSize);
+        
+        /** Shares (does not copy) pixels of the image file's image, its size defines logical pixel coordinates */
+        const QImage m_image;
+        
+        /** File from which regions of layers with higher resolution than the image are read (empty if none) */
+        const AString m_regionFileName;
+        
+        /** Index zero is lowest resolution, last index is full resolution */
+        std::vector<QSize> m_layerSizes;
+        
+        /** Index of the layer that is the image, layers above it are only read as regions from the file */
+        int32_t m_imageLayerIndex = -1;
+        
+        /** Lower resolution layers are created when first needed */
+        mutable std::vector<QImage> m_layerImages;
+        
+        static const int32_t s_minimumLayerDimension;
+        
+        // ADD_NEW_MEMBERS_HERE
+
+    };
+    
+#ifdef __IMAGE_FILE_PYRAMID_DECLARE__
+    const int32_t ImageFilePyramid::s_minimumLayerDimension = 256;
+#endif // __IMAGE_FILE_PYRAMID_DECLARE__
+
+} // namespace
+#endif  //__IMAGE_FILE_PYRAMID_H__
@@ -0,0 +1,296 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "MetricGradientObject.h"
+
+#include "CaretAssert.h"
+#include "CaretLogger.h"
+#include "CaretOMP.h"
+#include "CaretPointer.h"
+#include "FloatMatrix.h"
+#include "MathFunctions.h"
+#include "SurfaceFile.h"
+#include "TopologyHelper.h"
+#include "Vector3D.h"
+
+#include <cmath>
+
+using namespace std;
+using namespace caret;
+
+MetricGradientObject::MetricGradientObject(SurfaceFile* mySurf, const float* roiData, const bool& avgNormals, const float* corrAreas)
+{
+    CaretAssert(mySurf != NULL);
+    int32_t numNodes = mySurf->getNumberOfNodes();
+    const float* myNormals = NULL;
+    vector<float> avgNormalStorage;
+    if (avgNormals)
+    {
+        avgNormalStorage = mySurf->computeAverageNormals();
+        myNormals = avgNormalStorage.data();
+    } else {
+        mySurf->computeNormals();
+        myNormals = mySurf->getNormalData();
+    }
+    vector<float> sqrtCorrAreas;//same logic as GeodesicHelper
+    vector<float> sqrtVertAreas;
+    const float* vertAreas = NULL;
+    vector<float> areaData;
+    if (corrAreas != NULL)
+    {
+        sqrtCorrAreas.resize(numNodes);
+        mySurf->computeNodeAreas(sqrtVertAreas);
+        for (int i = 0; i < numNodes; ++i)
+        {
+            sqrtCorrAreas[i] = sqrt(corrAreas[i]);
+            sqrtVertAreas[i] = sqrt(sqrtVertAreas[i]);
+        }
+        vertAreas = corrAreas;
+    } else {
+        mySurf->computeNodeAreas(areaData);
+        vertAreas = areaData.data();
+    }
+    const float* myCoords = mySurf->getCoordinateData();
+    CaretPointer<TopologyHelper> myTopoHelp = mySurf->getTopologyHelper();
+    m_start.resize(numNodes + 1);
+    m_start[0] = 0;
+    for (int32_t i = 0; i < numNodes; ++i)
+    {//only within-roi neighbors of within-roi vertices get entries
+        int64_t count = 0;
+        if (roiData == NULL || roiData[i] > 0.0f)
+        {
+            int32_t numNeigh;
+            const int32_t* myNeighbors = myTopoHelp->getNodeNeighbors(i, numNeigh);
+            for (int32_t j = 0; j < numNeigh; ++j)
+            {
+                if (roiData == NULL || roiData[myNeighbors[j]] > 0.0f) ++count;
+            }
+        }
+        m_start[i + 1] = m_start[i] + count;
+    }
+    m_neighbors.resize(m_start[numNodes]);
+    m_weights.resize(m_start[numNodes] * 3, 0.0f);
+    m_centerWeights.resize(numNodes * 3, 0.0f);
+    m_valid.resize(numNodes, 0);
+    bool haveWarned = false, haveFailed = false;//print warning or failure messages only once
+#pragma omp CARET_PAR
+    {
+        CaretPointer<TopologyHelper> myThreadTopoHelp = mySurf->getTopologyHelper();//this stores and reuses helpers, so each thread can have one
+        vector<float> regressX, regressY, fallbackX, fallbackY;
+#pragma omp CARET_FOR schedule(dynamic)
+        for (int32_t i = 0; i < numNodes; ++i)
+        {
+            if (roiData != NULL && roiData[i] <= 0.0f) continue;
+            int32_t numNeigh;
+            int32_t i3 = i * 3;
+            const int32_t* myNeighbors = myThreadTopoHelp->getNodeNeighbors(i, numNeigh);
+            Vector3D myNormal = Vector3D(myNormals + i3).normal();//should already be normalized, but just in case
+            Vector3D myCoord = myCoords + i3;
+            Vector3D somevec, xhat, yhat;
+            somevec[2] = 0.0;
+            if (abs(myNormal[0]) > abs(myNormal[1]))
+            {//generate a vector not parallel to normal
+                somevec[0] = 0.0;
+                somevec[1] = 1.0;
+            } else {
+                somevec[0] = 1.0;
+                somevec[1] = 0.0;
+            }
+            xhat = myNormal.cross(somevec).normal();
+            yhat = myNormal.cross(xhat).normal();//xhat, yhat are orthogonal unit vectors describing a coord system with k = surface normal
+            const int64_t base = m_start[i];
+            const int neighCount = (int)(m_start[i + 1] - base);//count within-roi neighbors, not simply surface neighbors
+            regressX.resize(neighCount);
+            regressY.resize(neighCount);
+            fallbackX.resize(neighCount);
+            fallbackY.resize(neighCount);
+            int entry = 0;
+            for (int32_t j = 0; j < numNeigh; ++j)
+            {
+                int32_t whichNode = myNeighbors[j];
+                if (roiData != NULL && roiData[whichNode] <= 0.0f) continue;
+                m_neighbors[base + entry] = whichNode;
+                Vector3D neighCoord = myCoords + whichNode * 3;
+                somevec = neighCoord - myCoord;
+                float origMag = somevec.length();//save the original length
+                float unrollMag = origMag;
+                float opposite = somevec.dot(myNormal);//check for division by close to zero
+                if (abs(opposite) > 0.035f * origMag)//do not do unrolling on very small angles - this is ~2 degrees
+                {
+                    unrollMag = origMag * asin(opposite / origMag) * origMag / opposite;
+                }
+                if (corrAreas != NULL)
+                {
+                    unrollMag *= (sqrtCorrAreas[i] + sqrtCorrAreas[whichNode]) / (sqrtVertAreas[i] + sqrtVertAreas[whichNode]);
+                }
+                float xmag = xhat.dot(somevec);//dot product to get the direction in 2d
+                float ymag = yhat.dot(somevec);
+                float mag2d = sqrt(xmag * xmag + ymag * ymag);//get the new magnitude, to divide out
+                regressX[entry] = xmag * unrollMag / mag2d;//normalize the 2d vector and multiply by unrolled length
+                regressY[entry] = ymag * unrollMag / mag2d;
+                fallbackX[entry] = xmag / (unrollMag * mag2d);//difference divided by distance gives point estimate of gradient magnitude, also normalize the 2d vector
+                fallbackY[entry] = ymag / (unrollMag * mag2d);
+                ++entry;
+            }
+            CaretAssert(entry == neighCount);
+            bool done = false;
+            if (neighCount >= 2)
+            {//regression is A'A x = A'b with b the value differences, so solve with all of A' as the right hand side to get the operator
+                FloatMatrix myRegress = FloatMatrix::zeros(3, 3 + neighCount);
+                for (int e = 0; e < neighCount; ++e)
+                {
+                    float area = vertAreas[m_neighbors[base + e]];//weighted by vertex area
+                    myRegress[0][0] += regressX[e] * regressX[e] * area;
+                    myRegress[0][1] += regressX[e] * regressY[e] * area;
+                    myRegress[0][2] += regressX[e] * area;
+                    myRegress[1][1] += regressY[e] * regressY[e] * area;
+                    myRegress[1][2] += regressY[e] * area;
+                    myRegress[2][2] += area;
+                    myRegress[0][3 + e] = regressX[e] * area;
+                    myRegress[1][3 + e] = regressY[e] * area;
+                    myRegress[2][3 + e] = area;
+                }
+                myRegress[1][0] = myRegress[0][1];//complete the symmetric elements
+                myRegress[2][0] = myRegress[0][2];
+                myRegress[2][1] = myRegress[1][2];
+                myRegress[2][2] += vertAreas[i];//include center (metric and coord differences will be zero, so this is all that is needed)
+                FloatMatrix myRref = myRegress.reducedRowEchelon();
+                float sanity = 0.0f;
+                for (int e = 0; e < neighCount; ++e)
+                {
+                    Vector3D weight = xhat * myRref[0][3 + e] + yhat * myRref[1][3 + e];
+                    m_weights[(base + e) * 3] = weight[0];
+                    m_weights[(base + e) * 3 + 1] = weight[1];
+                    m_weights[(base + e) * 3 + 2] = weight[2];
+                    sanity += weight[0] + weight[1] + weight[2];
+                }
+                done = MathFunctions::isNumeric(sanity);
+            }
+            if (neighCount > 0 && !done)
+            {
+                if (roiData == NULL)
+                {//don't issue this warning with an ROI, because it is somewhat expected
+#pragma omp critical
+                    {
+                        if (!haveWarned)
+                        {
+                            haveWarned = true;
+                            CaretLogWarning("WARNING: gradient calculation found a NaN/inf with regression method for at least vertex " + AString::number(i));
+                        }
+                    }
+                }
+                float totalWeight = 0.0f;
+                for (int e = 0; e < neighCount; ++e)
+                {
+                    totalWeight += vertAreas[m_neighbors[base + e]];
+                }
+                float sanity = 0.0f;
+                for (int e = 0; e < neighCount; ++e)
+                {//point estimate of gradient times normalized projected direction, weighted average over neighbors
+                    Vector3D weight = (xhat * fallbackX[e] + yhat * fallbackY[e]) * (vertAreas[m_neighbors[base + e]] / totalWeight);
+                    m_weights[(base + e) * 3] = weight[0];
+                    m_weights[(base + e) * 3 + 1] = weight[1];
+                    m_weights[(base + e) * 3 + 2] = weight[2];
+                    sanity += weight[0] + weight[1] + weight[2];
+                }
+                done = MathFunctions::isNumeric(sanity);
+            }
+            if (!done)
+            {
+                if (roiData == NULL)
+                {//don't warn with an roi, they can be strange
+#pragma omp critical
+                    {
+                        if (!haveFailed)
+                        {
+                            haveFailed = true;
+                            CaretLogWarning("Failed to compute gradient for at least vertex " + AString::number(i) +
+                            " with standard and fallback methods, outputting ZERO, check your surface for disconnected vertices or other strangeness");
+                        }
+                    }
+                }
+                continue;
+            }
+            for (int e = 0; e < neighCount; ++e)
+            {//weights multiply value differences, so the center value gets the negative of their sum
+                m_centerWeights[i3] -= m_weights[(base + e) * 3];
+                m_centerWeights[i3 + 1] -= m_weights[(base + e) * 3 + 1];
+                m_centerWeights[i3 + 2] -= m_weights[(base + e) * 3 + 2];
+            }
+            m_valid[i] = 1;
+        }
+    }
+}
+
+bool MetricGradientObject::gradientColumn(const float* data, float* magnitudeOut, float* vectorsOut) const
+{
+    CaretAssert(data != NULL && magnitudeOut != NULL);
+    const int32_t numNodes = getNumberOfNodes();
+    bool allNumeric = true;
+#pragma omp CARET_PAR
+    {
+        bool threadNumeric = true;
+#pragma omp CARET_FOR schedule(static, 1024)
+        for (int32_t i = 0; i < numNodes; ++i)
+        {
+            float grad[3] = { 0.0f, 0.0f, 0.0f };
+            float magnitude = 0.0f;
+            if (m_valid[i])
+            {
+                const float* center = m_centerWeights.data() + i * 3;
+                float value = data[i];
+                grad[0] = center[0] * value;
+                grad[1] = center[1] * value;
+                grad[2] = center[2] * value;
+                const int64_t end = m_start[i + 1];
+                for (int64_t e = m_start[i]; e < end; ++e)
+                {
+                    const float* weight = m_weights.data() + e * 3;
+                    float neighValue = data[m_neighbors[e]];
+                    grad[0] += weight[0] * neighValue;
+                    grad[1] += weight[1] * neighValue;
+                    grad[2] += weight[2] * neighValue;
+                }
+                magnitude = sqrt(grad[0] * grad[0] + grad[1] * grad[1] + grad[2] * grad[2]);
+                if (!MathFunctions::isNumeric(magnitude))
+                {
+                    threadNumeric = false;
+                    magnitude = 0.0f;
+                    grad[0] = 0.0f;
+                    grad[1] = 0.0f;
+                    grad[2] = 0.0f;
+                }
+            }
+            magnitudeOut[i] = magnitude;
+            if (vectorsOut != NULL)
+            {
+                vectorsOut[i] = grad[0];//split them up far, so that they can be set to columns easily
+                vectorsOut[numNodes + i] = grad[1];
+                vectorsOut[numNodes * 2 + i] = grad[2];
+            }
+        }
+        if (!threadNumeric)
+        {
+#pragma omp critical
+            allNumeric = false;
+        }
+    }
+    return allNumeric;
+}
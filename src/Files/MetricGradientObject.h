@@ -0,0 +1,61 @@
+#ifndef __METRIC_GRADIENT_OBJECT_H__
+#define __METRIC_GRADIENT_OBJECT_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+//NOTE: the regression gradient used by AlgorithmMetricGradient is linear in the data for a fixed surface and ROI, so this object solves the
+//      per-vertex regressions once into a sparse 3-row operator, and then each column only needs a sparse multiply.  Use this when taking
+//      the gradient of many columns with the same ROI, for a single column, AlgorithmMetricGradient is simpler.
+//
+//NOTE: this object contains no mutable members, multiple threads can call gradientColumn on the same instance concurrently,
+//      as long as they don't use the same output arrays.
+
+#include "stdint.h"
+#include "stddef.h"
+#include <vector>
+
+namespace caret {
+    
+    class SurfaceFile;
+    
+    class MetricGradientObject
+    {
+    public:
+        ///roiData and corrAreas are per-vertex arrays, NULL means no roi, or use the surface's vertex areas
+        MetricGradientObject(SurfaceFile* mySurf, const float* roiData = NULL, const bool& avgNormals = false, const float* corrAreas = NULL);
+        
+        ///compute the gradient magnitude of one column, and the gradient vectors if vectorsOut isn't NULL (all X, then all Y, then all Z)
+        ///returns false if any vertex gave a non-numeric gradient (those vertices are output as zero)
+        bool gradientColumn(const float* data, float* magnitudeOut, float* vectorsOut = NULL) const;
+        
+        int32_t getNumberOfNodes() const { return (int32_t)m_valid.size(); }
+    private:
+        std::vector<int64_t> m_start;//CSR offsets into m_neighbors, per vertex
+        std::vector<int32_t> m_neighbors;
+        std::vector<float> m_weights;//3 per neighbor entry, gradient = sum of weight * neighbor value
+        std::vector<float> m_centerWeights;//3 per vertex, weight of the vertex's own value
+        std::vector<char> m_valid;//false for vertices outside the roi, or where both the regression and the fallback failed, these output zero
+        MetricGradientObject();
+    };
+    
+}
+
+#endif //__METRIC_GRADIENT_OBJECT_H__
@@ -22,6 +22,7 @@
 
 #include "CaretAssert.h"
 #include "CaretException.h"
+#include "CaretTrace.h"
 #include "SurfaceFile.h"
 #include "MetricFile.h"
 #include "GeodesicHelper.h"
@@ -39,11 +40,13 @@ MetricSmoothingObject::MetricSmoothingObject(const SurfaceFile* mySurf, const fl
     {
         throw CaretException("roi number of nodes doesn't match the surface");
     }
+    CaretTraceSpan traceSpan("helper", "smoothing weights");
     precomputeWeights(mySurf, kernel, myRoi, myMethod, nodeAreas);
 }
 
 void MetricSmoothingObject::smoothColumn(const MetricFile* metricIn, const int& whichColumn, MetricFile* columnOut, const MetricFile* roi, const bool& fixZeros) const
 {
+    CaretTraceSpan traceSpan("kernel", "smooth column");
     CaretAssert(metricIn != NULL);
     CaretAssert(columnOut != NULL);
     if (metricIn->getNumberOfNodes() != (int32_t)m_weightLists.size())
@@ -73,6 +76,7 @@ void MetricSmoothingObject::smoothColumn(const MetricFile* metricIn, const int&
 
 void MetricSmoothingObject::smoothColumn(const MetricFile* metricIn, const int& whichColumn, MetricFile* metricOut, const int& whichOutColumn, const MetricFile* roi, const int& whichRoiColumn, const bool& fixZeros) const
 {
+    CaretTraceSpan traceSpan("kernel", "smooth column");
     CaretAssert(metricIn != NULL);
     CaretAssert(metricOut != NULL);
     if (metricIn->getNumberOfNodes() != (int32_t)m_weightLists.size())
@@ -110,6 +114,7 @@ void MetricSmoothingObject::smoothColumn(const MetricFile* metricIn, const int&
 
 void MetricSmoothingObject::smoothMetric(const MetricFile* metricIn, MetricFile* metricOut, const MetricFile* roi, const bool& fixZeros) const
 {
+    CaretTraceSpan traceSpan("kernel", "smooth metric");
     CaretAssert(metricIn != NULL);
     CaretAssert(metricOut != NULL);
     int32_t numCols = metricIn->getNumberOfColumns();
@@ -40,6 +40,7 @@
 #include "LabelSelectionItem.h"
 #include "LabelSelectionItemModel.h"
 #include "Palette.h"
+#include "PaletteColorLookupTable.h"
 #include "PaletteColorMapping.h"
 #include "MathFunctions.h"
 #include "TabDrawingInfo.h"
@@ -201,6 +202,13 @@ NodeAndVoxelColoring::colorScalarsWithPalettePrivate(const FastStatistics* stati
                              rgbaNegativeOne);
     const bool rgbaNegativeOneValid = (rgbaNegativeOne[3] > 0.0);
     
+    /*
+     * Lookup table avoids searching the palette for most values
+     */
+    const std::shared_ptr<const PaletteColorLookupTable> colorLookupTable = palette->getColorLookupTable(interpolateFlag);
+    const PaletteColorLookupTable* lookupTable = colorLookupTable.get();
+    CaretAssert(lookupTable);
+    
     /*
      * Color all scalars.
      */
@@ -298,9 +306,12 @@ NodeAndVoxelColoring::colorScalarsWithPalettePrivate(const FastStatistics* stati
              * Color scalar using palette
              */
             float rgba[4];
-            palette->getPaletteColor(normalValue,
-                                     interpolateFlag,
-                                     rgba);
+            if ( ! lookupTable->getColor(normalValue,
+                                         rgba)) {
+                palette->getPaletteColor(normalValue,
+                                         interpolateFlag,
+                                         rgba);
+            }
             if (rgba[3] > 0.0f) {
                 rgbaOut[0] = rgba[0];
                 rgbaOut[1] = rgba[1];
@@ -38,12 +38,14 @@
 #include "EventSurfaceColoringInvalidate.h"
 #include "GiftiFile.h"
 #include "GiftiMetaDataXmlElements.h"
+#include "GraphicsOpenGLSurfaceBuffers.h"
 #include "GraphicsPrimitiveV3fN3fC4f.h"
 #include "MathFunctions.h"
 #include "Matrix4x4.h"
 #include "Vector3D.h"
 
 #include "CaretPointLocator.h"
+#include "CaretTriangleLocator.h"
 #include "GeodesicHelper.h"
 #include "PlainTextStringBuilder.h"
 #include "SignedDistanceHelper.h"
@@ -534,6 +536,10 @@ SurfaceFile::initializeMembersSurfaceFile()
 void 
 SurfaceFile::copyHelperSurfaceFile(const SurfaceFile& /*sf*/)
 {
+    if (m_openGLSurfaceBuffers) {
+        m_openGLSurfaceBuffers->invalidateGeometry();
+        m_openGLSurfaceBuffers->removeAllColors();
+    }
     this->validateDataArraysAfterReading();
 }
 
@@ -594,6 +600,9 @@ SurfaceFile::computeNormals()
         return;
     }
     m_normalsComputed = true;
+    if (m_openGLSurfaceBuffers) {
+        m_openGLSurfaceBuffers->invalidateGeometry();
+    }
     int32_t numCoords = this->getNumberOfNodes();
     if (numCoords > 0) {
         this->normalVectors.resize(numCoords * 3);
@@ -883,6 +892,10 @@ CaretPointer<SignedDistanceHelper> SurfaceFile::getSignedDistanceHelper() const
 
 void SurfaceFile::invalidateHelpers()
 {
+    if (m_openGLSurfaceBuffers)
+    {
+        m_openGLSurfaceBuffers->invalidateGeometry();//geometry changed, so reload coordinates and triangles when next drawn
+    }
     if (m_geoBase != NULL)
     {
         CaretMutexLocker myLock(&m_geoHelperMutex);//make this function threadsafe
@@ -909,6 +922,11 @@ void SurfaceFile::invalidateHelpers()
         CaretMutexLocker myLock3(&m_locatorMutex);
         m_locator.grabNew(NULL);
     }
+    if (m_triLocator != NULL)
+    {
+        CaretMutexLocker myLock5(&m_triLocatorMutex);
+        m_triLocator.grabNew(NULL);
+    }
 }
 
 /**
@@ -1205,6 +1223,8 @@ SurfaceFile::applyMatrix(const Matrix4x4& matrix)
         }
     }
     
+    invalidateNormals();
+    invalidateHelpers();
     computeNormals();
     
     setModified();
@@ -1404,6 +1424,19 @@ CaretPointer<const CaretPointLocator> SurfaceFile::getPointLocator() const
     return m_locator;
 }
 
+CaretPointer<const CaretTriangleLocator> SurfaceFile::getTriangleLocator() const
+{
+    if (m_triLocator == NULL)
+    {
+        CaretMutexLocker myLock(&m_triLocatorMutex);
+        if (m_triLocator == NULL)
+        {
+            m_triLocator.grabNew(new CaretTriangleLocator(getCoordinateData(), getNumberOfNodes(), trianglePointer, getNumberOfTriangles()));
+        }
+    }
+    return m_triLocator;
+}
+
 void SurfaceFile::clearCachedHelpers() const
 {
     {
@@ -1428,6 +1461,10 @@ void SurfaceFile::clearCachedHelpers() const
         CaretMutexLocker locked(&m_locatorMutex);
         m_locator.grabNew(NULL);
     }
+    {
+        CaretMutexLocker locked(&m_triLocatorMutex);
+        m_triLocator.grabNew(NULL);
+    }
 }
 
 /**
@@ -1571,6 +1608,10 @@ SurfaceFile::invalidateNodeColoringForBrowserTabs()
     m_surfaceGraphicsPrimitives.clear();
     m_surfaceMontageGraphicsPrimitives.clear();
     m_wholeBrainGraphicsPrimitives.clear();
+    
+    if (m_openGLSurfaceBuffers) {
+        m_openGLSurfaceBuffers->removeAllColors();
+    }
 }
 
 /**
@@ -1591,6 +1632,10 @@ SurfaceFile::allocateSurfaceNodeColoringForBrowserTab(const int32_t browserTabIn
     
     const uint64_t numberOfComponentsRGBA = this->getNumberOfNodes() * 4;
     if (this->surfaceNodeColoringForBrowserTabs[browserTabIndex].size() != numberOfComponentsRGBA) {
+        if (m_openGLSurfaceBuffers
+            && ( ! this->surfaceNodeColoringForBrowserTabs[browserTabIndex].empty())) {
+            m_openGLSurfaceBuffers->removeColors(&this->surfaceNodeColoringForBrowserTabs[browserTabIndex][0]);//resizing may move the colors
+        }
         if (zeroizeColorsFlag) {
             this->surfaceNodeColoringForBrowserTabs[browserTabIndex].resize(numberOfComponentsRGBA, 0.0);
         }
@@ -1618,6 +1663,10 @@ SurfaceFile::allocateSurfaceMontageNodeColoringForBrowserTab(const int32_t brows
     
     const uint64_t numberOfComponentsRGBA = this->getNumberOfNodes() * 4;
     if (this->surfaceMontageNodeColoringForBrowserTabs[browserTabIndex].size() != numberOfComponentsRGBA) {
+        if (m_openGLSurfaceBuffers
+            && ( ! this->surfaceMontageNodeColoringForBrowserTabs[browserTabIndex].empty())) {
+            m_openGLSurfaceBuffers->removeColors(&this->surfaceMontageNodeColoringForBrowserTabs[browserTabIndex][0]);//resizing may move the colors
+        }
         if (zeroizeColorsFlag) {
             this->surfaceMontageNodeColoringForBrowserTabs[browserTabIndex].resize(numberOfComponentsRGBA, 0.0);
         }
@@ -1645,6 +1694,10 @@ SurfaceFile::allocateWholeBrainNodeColoringForBrowserTab(const int32_t browserTa
     
     const uint64_t numberOfComponentsRGBA = this->getNumberOfNodes() * 4;
     if (this->wholeBrainNodeColoringForBrowserTabs[browserTabIndex].size() != numberOfComponentsRGBA) {
+        if (m_openGLSurfaceBuffers
+            && ( ! this->wholeBrainNodeColoringForBrowserTabs[browserTabIndex].empty())) {
+            m_openGLSurfaceBuffers->removeColors(&this->wholeBrainNodeColoringForBrowserTabs[browserTabIndex][0]);//resizing may move the colors
+        }
         if (zeroizeColorsFlag) {
             this->wholeBrainNodeColoringForBrowserTabs[browserTabIndex].resize(numberOfComponentsRGBA, 0.0);
         }
@@ -1704,6 +1757,11 @@ SurfaceFile::setSurfaceNodeColoringRgbaForBrowserTab(const int32_t browserTabInd
         && (browserTabIndex < static_cast<int32_t>(m_surfaceGraphicsPrimitives.size()))) {
         m_surfaceGraphicsPrimitives[browserTabIndex].reset();
     }
+    
+    if (m_openGLSurfaceBuffers
+        && ( ! rgba.empty())) {
+        m_openGLSurfaceBuffers->invalidateColors(&rgba[0]);
+    }
 }
 
 /**
@@ -1756,6 +1814,11 @@ SurfaceFile::setSurfaceMontageNodeColoringRgbaForBrowserTab(const int32_t browse
         && (browserTabIndex < static_cast<int32_t>(m_surfaceMontageGraphicsPrimitives.size()))) {
         m_surfaceMontageGraphicsPrimitives[browserTabIndex].reset();
     }
+    
+    if (m_openGLSurfaceBuffers
+        && ( ! rgba.empty())) {
+        m_openGLSurfaceBuffers->invalidateColors(&rgba[0]);
+    }
 }
 
 
@@ -1808,6 +1871,11 @@ SurfaceFile::setWholeBrainNodeColoringRgbaForBrowserTab(const int32_t browserTab
         && (browserTabIndex < static_cast<int32_t>(m_wholeBrainGraphicsPrimitives.size()))) {
         m_wholeBrainGraphicsPrimitives[browserTabIndex].reset();
     }
+    
+    if (m_openGLSurfaceBuffers
+        && ( ! rgba.empty())) {
+        m_openGLSurfaceBuffers->invalidateColors(&rgba[0]);
+    }
 }
 
 /**
@@ -1920,6 +1988,21 @@ SurfaceFile::getWholeBrainGraphicsPrimitiveForBrowserTab(const int32_t browserTa
     return primitiveOut;
 }
 
+/**
+ * @return The OpenGL buffers for drawing this surface.  Coordinates,
+ * normal vectors, and triangles are kept in the buffers until the
+ * geometry changes and each tab's coloring is reloaded only when
+ * the coloring is invalidated.
+ */
+GraphicsOpenGLSurfaceBuffers*
+SurfaceFile::getOpenGLSurfaceBuffers()
+{
+    if ( ! m_openGLSurfaceBuffers) {
+        m_openGLSurfaceBuffers.reset(new GraphicsOpenGLSurfaceBuffers());
+    }
+    return m_openGLSurfaceBuffers.get();
+}
+
 /**
  * Receive an event.
  * 
@@ -37,11 +37,13 @@ namespace caret {
 
     class BoundingBox;
     class CaretPointLocator;
+    class CaretTriangleLocator;
     class DescriptiveStatistics;
     class FastStatistics;
     class GeodesicHelper;
     class GeodesicHelperBase;
     class GiftiDataArray;
+    class GraphicsOpenGLSurfaceBuffers;
     class GraphicsPrimitiveV3fN3fC4f;
     class Matrix4x4;
     class PlainTextStringBuilder;
@@ -142,6 +144,8 @@ namespace caret {
         
         CaretPointer<const CaretPointLocator> getPointLocator() const;
         
+        CaretPointer<const CaretTriangleLocator> getTriangleLocator() const;
+        
         void clearCachedHelpers() const;
         
         const BoundingBox* getBoundingBox() const;
@@ -191,6 +195,8 @@ namespace caret {
         
         GraphicsPrimitiveV3fN3fC4f* getWholeBrainGraphicsPrimitiveForBrowserTab(const int32_t browserTabIndex);
         
+        GraphicsOpenGLSurfaceBuffers* getOpenGLSurfaceBuffers();
+        
         
         void invalidateNormals();
         
@@ -283,6 +289,11 @@ namespace caret {
          */
         std::vector<std::unique_ptr<GraphicsPrimitiveV3fN3fC4f>> m_wholeBrainGraphicsPrimitives;
         
+        /**
+         * OpenGL buffers containing geometry and coloring for drawing
+         */
+        std::unique_ptr<GraphicsOpenGLSurfaceBuffers> m_openGLSurfaceBuffers;
+        
         
         /** Points to memory containing the coordinates. */
         float* coordinatePointer;
@@ -333,12 +344,15 @@ namespace caret {
         ///used to search for the closest point in the surface
         mutable CaretPointer<CaretPointLocator> m_locator;
         
+        ///used to find the triangle hit by a ray, for identification without rendering
+        mutable CaretPointer<CaretTriangleLocator> m_triLocator;
+        
         ///used to track when the surface file gets changed
         void invalidateHelpers();
         
         mutable BoundingBox* boundingBox;
         
-        mutable CaretMutex m_topoHelperMutex, m_geoHelperMutex, m_locatorMutex, m_distHelperMutex;
+        mutable CaretMutex m_topoHelperMutex, m_geoHelperMutex, m_locatorMutex, m_distHelperMutex, m_triLocatorMutex;
     };
 
 } // namespace
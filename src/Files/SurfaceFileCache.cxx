@@ -0,0 +1,102 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "SurfaceFileCache.h"
+
+#include "CaretLogger.h"
+#include "CaretLruCache.h"
+#include "FileInformation.h"
+#include "SurfaceFile.h"
+
+#include <QDateTime>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    struct CachedSurface
+    {
+        CaretPointer<SurfaceFile> m_surface;
+        int64_t m_fileSize;
+        QDateTime m_modified;//reread when the file changes on disk
+    };
+    
+    CaretLruCache<AString, CachedSurface> s_surfaceCache;
+}
+
+/**
+ * Set the maximum number of surfaces kept, 0 disables the cache.
+ */
+void
+SurfaceFileCache::setMaximumEntries(const int64_t maxEntries)
+{
+    s_surfaceCache.setMaximumEntries(maxEntries);
+}
+
+bool
+SurfaceFileCache::isEnabled()
+{
+    return s_surfaceCache.isEnabled();
+}
+
+/**
+ * Read a surface, or return the cached one if the file hasn't changed since it was read.
+ * Remote files are always read.
+ */
+CaretPointer<SurfaceFile>
+SurfaceFileCache::readSurface(const AString& filename)
+{
+    FileInformation myInfo(filename);
+    if (!s_surfaceCache.isEnabled() || !myInfo.isLocalFile() || !myInfo.exists())
+    {//let readFile() report missing files
+        CaretPointer<SurfaceFile> ret(new SurfaceFile());
+        ret->readFile(filename);
+        return ret;
+    }
+    const AString key = myInfo.getCanonicalFilePath();
+    const int64_t fileSize = myInfo.size();
+    const QDateTime modified = myInfo.getLastModified();
+    CachedSurface entry;
+    if (s_surfaceCache.find(key, entry))
+    {
+        if (entry.m_fileSize == fileSize && entry.m_modified == modified)
+        {
+            CaretLogFine("using cached surface '" + key + "'");
+            return entry.m_surface;
+        }
+        s_surfaceCache.remove(key);
+    }
+    entry.m_surface.grabNew(new SurfaceFile());
+    entry.m_surface->readFile(filename);
+    entry.m_fileSize = fileSize;
+    entry.m_modified = modified;
+    s_surfaceCache.insert(key, entry);
+    return entry.m_surface;
+}
+
+/**
+ * Drop all cached surfaces.
+ */
+void
+SurfaceFileCache::clear()
+{
+    s_surfaceCache.clear();
+}
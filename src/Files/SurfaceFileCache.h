@@ -0,0 +1,60 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#ifndef __SURFACE_FILE_CACHE_H__
+#define __SURFACE_FILE_CACHE_H__
+
+#include "AString.h"
+#include "CaretPointer.h"
+
+namespace caret {
+
+    class SurfaceFile;
+    
+    /**
+     * Keeps recently read surfaces, and the topology and geodesic helpers
+     * they build, for processes that run many commands (see wb_command -daemon).
+     * Disabled (0 entries) by default, cached surfaces are shared between
+     * commands, so they must not be modified.
+     */
+    class SurfaceFileCache {
+        
+    public:
+        static void setMaximumEntries(const int64_t maxEntries);
+        
+        static bool isEnabled();
+        
+        static CaretPointer<SurfaceFile> readSurface(const AString& filename);
+        
+        static void clear();
+        
+    private:
+        SurfaceFileCache();
+        
+        virtual ~SurfaceFileCache();
+        
+        SurfaceFileCache(const SurfaceFileCache&);
+
+        SurfaceFileCache& operator=(const SurfaceFileCache&);
+        
+    };
+    
+} // namespace
+#endif  //__SURFACE_FILE_CACHE_H__
@@ -28,7 +28,9 @@
 #include "CaretAssert.h"
 #include "CaretException.h"
 #include "CaretLogger.h"
+#include "CaretLruCache.h"
 #include "CaretOMP.h"
+#include "CaretTrace.h"
 #include "FastStatistics.h"
 #include "GeodesicHelper.h"
 #include "SignedDistanceHelper.h"
@@ -36,6 +38,9 @@
 #include "TopologyHelper.h"
 #include "Vector3D.h"
 
+#include <QByteArray>
+#include <QCryptographicHash>
+
 #include <algorithm>
 #include <set>
 #include <map>
@@ -43,9 +48,63 @@
 using namespace std;
 using namespace caret;
 
+namespace
+{
+    //weights are shared between copies of a helper, so the cache holds them without copying
+    CaretLruCache<QByteArray, SurfaceResamplingHelper> s_helperCache;
+    
+    void addToKey(QCryptographicHash& hasher, const void* data, const int64_t numBytes)
+    {
+        if (data == NULL)
+        {
+            hasher.addData(QByteArray("null"));
+        } else {
+            hasher.addData(QByteArray::fromRawData((const char*)data, numBytes));
+        }
+    }
+    
+    void addSurfaceToKey(QCryptographicHash& hasher, const SurfaceFile* surface)
+    {
+        const int64_t numNodes = surface->getNumberOfNodes(), numTriangles = surface->getNumberOfTriangles();
+        addToKey(hasher, &numNodes, sizeof(numNodes));
+        addToKey(hasher, &numTriangles, sizeof(numTriangles));
+        addToKey(hasher, surface->getCoordinateData(), numNodes * 3 * sizeof(float));
+        if (numTriangles > 0) addToKey(hasher, surface->getTriangle(0), numTriangles * 3 * sizeof(int32_t));
+    }
+    
+    //the key is a hash of everything the weights depend on, so it doesn't matter where the inputs came from
+    QByteArray resamplingCacheKey(const SurfaceResamplingMethodEnum::Enum& myMethod, const SurfaceFile* currentSphere, const SurfaceFile* newSphere,
+                                  const float* currentAreas, const float* newAreas, const float* currentRoi, const bool allowNonSphere)
+    {
+        QCryptographicHash hasher(QCryptographicHash::Sha1);
+        const int32_t options[2] = { (int32_t)myMethod, allowNonSphere ? 1 : 0 };
+        addToKey(hasher, options, sizeof(options));
+        addSurfaceToKey(hasher, currentSphere);
+        addSurfaceToKey(hasher, newSphere);
+        addToKey(hasher, currentAreas, currentSphere->getNumberOfNodes() * sizeof(float));
+        addToKey(hasher, newAreas, newSphere->getNumberOfNodes() * sizeof(float));
+        addToKey(hasher, currentRoi, currentSphere->getNumberOfNodes() * sizeof(float));
+        return hasher.result();
+    }
+}
+
 SurfaceResamplingHelper::SurfaceResamplingHelper(const SurfaceResamplingMethodEnum::Enum& myMethod, const SurfaceFile* currentSphere, const SurfaceFile* newSphere,
                                                  const float* currentAreas, const float* newAreas, const float* currentRoi, const bool allowNonSphere)
 {
+    CaretTraceSpan traceSpan("helper", "resampling weights");
+    QByteArray cacheKey;
+    if (s_helperCache.isEnabled())
+    {
+        cacheKey = resamplingCacheKey(myMethod, currentSphere, newSphere, currentAreas, newAreas, currentRoi, allowNonSphere);
+        SurfaceResamplingHelper cached;
+        if (s_helperCache.find(cacheKey, cached))
+        {
+            CaretLogFine("using cached resampling weights");
+            traceSpan.setDetail("cached");
+            *this = cached;
+            return;
+        }
+    }
     m_nonsphereAllowed = allowNonSphere;
     SurfaceFile currentSphereMod, newSphereMod;
     const SurfaceFile* useCurrent = currentSphere, *useNew = newSphere;
@@ -70,6 +129,15 @@ SurfaceResamplingHelper::SurfaceResamplingHelper(const SurfaceResamplingMethodEn
             computeWeightsBarycentric(useCurrent, useNew, currentRoi);
             break;
     }
+    if (!cacheKey.isEmpty())
+    {
+        s_helperCache.insert(cacheKey, *this);
+    }
+}
+
+void SurfaceResamplingHelper::setCacheEntries(const int64_t maxEntries)
+{
+    s_helperCache.setMaximumEntries(maxEntries);
 }
 
 void SurfaceResamplingHelper::resampleNormal(const float* input, float* output, const float& invalidVal) const
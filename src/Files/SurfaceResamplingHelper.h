@@ -66,6 +66,9 @@ namespace caret {
         ///get the ROI of nodes that have data within the input ROI
         void getResampleValidROI(float* output) const;
         
+        ///keep the weights of recently computed helpers, for processes that run many commands, 0 (the default) disables it
+        static void setCacheEntries(const int64_t maxEntries);
+        
         ///resample a cut surface - not something you will apply multiple times, so static method
         static void resampleCutSurface(const SurfaceFile* cutSurfaceIn, const SurfaceFile* curSphere, const SurfaceFile* newSphere, SurfaceFile* surfaceOut);
     };
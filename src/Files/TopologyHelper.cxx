@@ -21,6 +21,7 @@
 #include "SurfaceFile.h"
 #include "TopologyHelper.h"
 #include "CaretAssert.h"
+#include <algorithm>
 #include <cmath>
 
 using namespace caret;
@@ -280,6 +281,22 @@ const int32_t* TopologyHelper::getNodeNeighbors(const int32_t nodeNum, int32_t&
     return m_nodeInfo[nodeNum].m_neighbors.data();
 }
 
+void TopologyHelper::getNeighborAdjacency(vector<int64_t>& startOut, vector<int32_t>& neighborsOut) const
+{
+    startOut.resize(m_numNodes + 1);
+    startOut[0] = 0;
+    for (int32_t i = 0; i < m_numNodes; ++i)
+    {
+        startOut[i + 1] = startOut[i] + (int64_t)m_nodeInfo[i].m_neighbors.size();
+    }
+    neighborsOut.resize(startOut[m_numNodes]);
+    for (int32_t i = 0; i < m_numNodes; ++i)
+    {
+        const vector<int32_t>& neighbors = m_nodeInfo[i].m_neighbors;
+        copy(neighbors.begin(), neighbors.end(), neighborsOut.begin() + startOut[i]);
+    }
+}
+
 int32_t TopologyHelper::getNodeNumberOfNeighbors(const int32_t nodeNum) const
 {
     CaretAssertVectorIndex(m_nodeInfo, nodeNum);
@@ -154,6 +154,9 @@ namespace caret {
         /// containing the neighbors.
         const int32_t* getNodeNeighbors(const int32_t nodeNum, int32_t& numNeighborsOut) const;
         
+        ///get all neighbor lists as compressed sparse row adjacency, neighbors of node i are in [startOut[i], startOut[i + 1])
+        void getNeighborAdjacency(std::vector<int64_t>& startOut, std::vector<int32_t>& neighborsOut) const;
+        
         ///get the edges of a node
         const std::vector<int32_t>& getNodeEdges(const int32_t nodeNum) const;
 
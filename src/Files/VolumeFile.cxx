@@ -103,6 +103,7 @@ GroupAndNameHierarchyUserInterface()
         m_chartingEnabledForTab[i] = false;
     }
     m_writingDoScale = false;
+    m_writingAutoScale = false;
     m_writingDType = NIFTI_TYPE_FLOAT32;
     m_minScalingVal = -1.0;//unused, but make them consistent
     m_maxScalingVal = 1.0;
@@ -122,6 +123,7 @@ GroupAndNameHierarchyUserInterface()
         m_chartingEnabledForTab[i] = false;
     }
     m_writingDoScale = false;
+    m_writingAutoScale = false;
     m_writingDType = NIFTI_TYPE_FLOAT32;
     m_minScalingVal = -1.0;//unused, but make them consistent
     m_maxScalingVal = 1.0;
@@ -142,6 +144,7 @@ GroupAndNameHierarchyUserInterface()
     }
     if (templateHeader != NULL) m_header.grabNew(templateHeader->clone());
     m_writingDoScale = false;
+    m_writingAutoScale = false;
     m_writingDType = NIFTI_TYPE_FLOAT32;
     m_minScalingVal = -1.0;//unused, but make them consistent
     m_maxScalingVal = 1.0;
@@ -261,6 +264,7 @@ VolumeFile::clear()
     m_lazyInitializedDynamicConnectivityFile.reset();
 
     m_writingDoScale = false;
+    m_writingAutoScale = false;
     m_writingDType = NIFTI_TYPE_FLOAT32;
     m_minScalingVal = -1.0;//unused, but make them consistent
     m_maxScalingVal = 1.0;
@@ -447,8 +451,26 @@ VolumeFile::writeFile(const AString& filename)
                 break;
         }
     } else {
-        if (m_writingDoScale)
+        if (m_writingAutoScale)
         {
+            const vector<int64_t> myDims = getDimensions();
+            const int64_t frameSize = myDims[0] * myDims[1] * myDims[2];
+            float dataMin = numeric_limits<float>::max(), dataMax = -numeric_limits<float>::max();
+            for (int64_t b = 0; b < myDims[3]; ++b)
+            {
+                for (int64_t c = 0; c < myDims[4]; ++c)
+                {
+                    const float* frame = getFrame(b, c);
+                    for (int64_t i = 0; i < frameSize; ++i)
+                    {
+                        if (frame[i] - frame[i] != 0.0f) continue;//NaN or inf
+                        dataMin = min(dataMin, frame[i]);
+                        dataMax = max(dataMax, frame[i]);
+                    }
+                }
+            }
+            outHeader.setDataTypeAndDataRange(m_writingDType, dataMin, dataMax);
+        } else if (m_writingDoScale) {
             outHeader.setDataTypeAndScaleRange(m_writingDType, m_minScalingVal, m_maxScalingVal);
         } else {
             outHeader.setDataType(m_writingDType);
@@ -480,6 +502,7 @@ void VolumeFile::setWritingDataTypeNoScaling(const int16_t& type)
 {
     m_writingDType = type;//could do some validation here
     m_writingDoScale = false;
+    m_writingAutoScale = false;
     m_minScalingVal = -1.0;
     m_maxScalingVal = 1.0;
 }
@@ -488,10 +511,20 @@ void VolumeFile::setWritingDataTypeAndScaling(const int16_t& type, const double&
 {
     m_writingDType = type;//could do some validation here
     m_writingDoScale = true;
+    m_writingAutoScale = false;
     m_minScalingVal = minval;
     m_maxScalingVal = maxval;
 }
 
+void VolumeFile::setWritingDataTypeAutoScaling(const int16_t& type)
+{
+    m_writingDType = type;
+    m_writingDoScale = true;
+    m_writingAutoScale = true;
+    m_minScalingVal = -1.0;//found when writing
+    m_maxScalingVal = 1.0;
+}
+
 bool VolumeFile::hasGoodSpatialInformation() const
 {
     if (m_header != NULL)
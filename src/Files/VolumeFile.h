@@ -141,7 +141,7 @@ namespace caret {
 
         int16_t m_writingDType;
 
-        bool m_writingDoScale;
+        bool m_writingDoScale, m_writingAutoScale;
 
         double m_minScalingVal, m_maxScalingVal;
         
@@ -224,6 +224,7 @@ namespace caret {
         ///data type and scaling options
         void setWritingDataTypeNoScaling(const int16_t& type = NIFTI_TYPE_FLOAT32);
         void setWritingDataTypeAndScaling(const int16_t& type, const double& minval, const double& maxval);
+        void setWritingDataTypeAutoScaling(const int16_t& type);//integer types are scaled to the range of the data
 
         bool isEmpty() const { return VolumeBase::isEmpty(); }
         
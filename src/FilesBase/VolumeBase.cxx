@@ -369,7 +369,9 @@ void VolumeBase::VolumeStorage::reinitialize(int64_t dims[5])
     {
         m_mult[i] = m_mult[i - 1] * m_dimensions[i];
     }
+    const int64_t oldSize = (int64_t)m_data.size();
     m_data.resize(m_mult[4]);
+    if (m_mult[4] > oldSize) CaretOMP::firstTouch(m_data.data() + oldSize, m_mult[4] - oldSize, 0.0f);
 }
 
 VolumeBase::VolumeStorage::VolumeStorage(int64_t dims[5])
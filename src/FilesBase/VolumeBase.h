@@ -25,6 +25,7 @@
 #include "stdint.h"
 #include <vector>
 #include "CaretAssert.h"
+#include "CaretOMP.h"
 #include "CaretPointer.h"
 #include "VolumeMappableInterface.h"
 #include "VolumeSpace.h"
@@ -48,7 +49,7 @@ namespace caret {
     {
         class VolumeStorage
         {
-            std::vector<float> m_data;
+            std::vector<float, CaretFirstTouchAllocator<float> > m_data;//first touched in parallel, so large volumes are spread over NUMA nodes
             int64_t m_dimensions[5];//store internally as 4d+component
             int64_t m_mult[5];//precalculated multipliers for getIndex/getValue/setValue - NOTE: [0] is for index[1], [4] is the entire size of the data
             VolumeStorage(const VolumeStorage& rhs);//deny copy, assignment for now
@@ -19,6 +19,7 @@
 /*LICENSE_END*/
 
 #include <algorithm>
+#include <climits>
 #include <fstream>
 #include <ostream>
 #include <limits>
@@ -43,6 +44,8 @@
 #include "SystemUtilities.h"
 #include "XmlWriter.h"
 
+#include "zlib.h"
+
 using namespace caret;
 
 /**
@@ -353,7 +356,9 @@ GiftiDataArray::allocateData()
        //
        //  Allocate the needed memory
        //
+       const int64_t oldSize = (int64_t)data.size();
        data.resize(dataSizeInBytes);
+       if (dataSizeInBytes > oldSize) CaretOMP::firstTouch(data.data() + oldSize, dataSizeInBytes - oldSize, (uint8_t)0);
    }
    else {
       data.clear();
@@ -588,6 +593,37 @@ GiftiDataArray::readFromText(const AString text,
                              const AString& externalFileNameForReading,
                              const int64_t externalFileOffsetForReading,
                              const bool isReadOnlyMetaData)
+{
+    const std::string textString = text.toStdString();
+    readFromBytes(textString.c_str(),
+                  textString.size(),
+                  dataEndianForReading,
+                  arraySubscriptingOrderForReading,
+                  dataTypeForReading,
+                  dimensionsForReading,
+                  encodingForReading,
+                  externalFileNameForReading,
+                  externalFileOffsetForReading,
+                  isReadOnlyMetaData);
+}
+
+/**
+ * read a GIFTI data array from the bytes of its Data element.
+ * The base64 encodings are decoded directly into the array's storage.
+ * text must be followed by a byte that is not a base64 character
+ * (such as the '<' of the end tag, or a null terminator).
+ */
+void 
+GiftiDataArray::readFromBytes(const char* text,
+                              const int64_t textLength,
+                              const GiftiEndianEnum::Enum dataEndianForReading,
+                              const GiftiArrayIndexingOrderEnum::Enum arraySubscriptingOrderForReading,
+                              const NiftiDataTypeEnum::Enum dataTypeForReading,
+                              const std::vector<int64_t>& dimensionsForReading,
+                              const GiftiEncodingEnum::Enum encodingForReading,
+                              const AString& externalFileNameForReading,
+                              const int64_t externalFileOffsetForReading,
+                              const bool isReadOnlyMetaData)
 {
    const NiftiDataTypeEnum::Enum requiredDataType = dataType;
    dataType = dataTypeForReading;
@@ -613,7 +649,7 @@ GiftiDataArray::readFromText(const AString text,
       switch (encoding) {
           case GiftiEncodingEnum::ASCII:
             {
-                std::istringstream stream(text.toStdString());
+                std::istringstream stream(std::string(text, textLength));
                 
                switch (dataType) {
                   case NiftiDataTypeEnum::NIFTI_TYPE_FLOAT32:
@@ -659,7 +695,7 @@ GiftiDataArray::readFromText(const AString text,
                // Decode the Base64 data using VTK's algorithm
                //
                const uint64_t numDecoded =
-                     Base64::decode((const unsigned char*)(text.toStdString().c_str()),
+                     Base64::decode((const unsigned char*)text,
                                                 data.size(),
                                                 &data[0]);
                if (numDecoded != data.size()) {
@@ -681,32 +717,14 @@ GiftiDataArray::readFromText(const AString text,
           case GiftiEncodingEnum::GZIP_BASE64_BINARY:
             {
                //
-               // Decode the Base64 data using VTK's algorithm
-               //
-               std::vector<unsigned char> dataBuffer(text.size() - text.size() / 4 + 10);//generous constant to make up for integer rounding
-               //const char* textChars = text.toLatin1().constData();
-               const uint64_t numDecoded =
-                     Base64::decode((unsigned char*)text.toStdString().c_str(),
-                                                dataBuffer.size(),
-                                                dataBuffer.data());
-               if (numDecoded == 0) {
-                   std::ostringstream str;
-                   str << "Decoding of GZip Base64 Binary data failed."
-                   << "Decoded " << AString::number(numDecoded).toStdString() << " bytes but should be "
-                   << AString::number(static_cast<int>(data.size())).toStdString() << " bytes.";
-                   throw GiftiException(AString::fromStdString(str.str()));
-               }
-               
-               
+               // Decode the Base64 data in blocks and inflate each block
+               // straight into the array, so neither the decoded nor the
+               // compressed data needs a buffer the size of the array
                //
-               // Uncompress the data using VTK's algorithm
-               // 
-                DataCompressZLib compressor;
-                const uint64_t uncompressedDataLength = 
-                                   compressor.uncompressData(dataBuffer.data(),
-                                                          numDecoded,
-                                                          (unsigned char*)&data[0],
-                                                          data.size());
+               const uint64_t uncompressedDataLength = decodeGzipBase64(text,
+                                                                        textLength,
+                                                                        &data[0],
+                                                                        data.size());
                if (uncompressedDataLength != data.size()) {
                   std::ostringstream str;
                   str << "Decompression of Binary data failed.\n"
@@ -815,6 +833,74 @@ GiftiDataArray::readFromText(const AString text,
    setModified();
 }
 
+/**
+ * Decode gzipped base64 text, inflating each decoded block as it is produced.
+ * Decoding stops at padding or at the first character that is not base64,
+ * the same as decoding the whole text at once.
+ *
+ * @return
+ *    Number of bytes written to output, or 0 if the data could not be
+ *    uncompressed or would not fit in output.
+ */
+uint64_t
+GiftiDataArray::decodeGzipBase64(const char* text,
+                                 const int64_t textLength,
+                                 unsigned char* output,
+                                 const uint64_t outputLength)
+{
+    const int64_t BLOCK_CHARS = 65536;//must be a multiple of 4
+    std::vector<unsigned char> block(BLOCK_CHARS / 4 * 3);
+    
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.next_in = Z_NULL;
+    stream.avail_in = 0;
+    if (inflateInit(&stream) != Z_OK) {
+        return 0;
+    }
+    stream.next_out = output;
+    stream.avail_out = 0;
+    
+    int64_t position = 0;
+    bool inputEnded = false;
+    int status = Z_OK;
+    while (status != Z_STREAM_END) {
+        if ((stream.avail_in == 0) && (inputEnded == false)) {
+            int64_t numChars = std::min(BLOCK_CHARS, textLength - position);
+            numChars -= numChars % 4;
+            uint64_t numDecoded = 0;
+            if (numChars > 0) {
+                numDecoded = Base64::decode((const unsigned char*)(text + position),
+                                            0,
+                                            block.data(),
+                                            numChars);
+                position += numChars;
+            }
+            if (numDecoded < static_cast<uint64_t>(numChars / 4 * 3) || numChars <= 0) {
+                inputEnded = true;
+            }
+            stream.next_in = block.data();
+            stream.avail_in = static_cast<uInt>(numDecoded);
+        }
+        if (stream.avail_out == 0) {//avail_out is only 32 bits, so give zlib the output in pieces
+            const uint64_t outputRemaining = outputLength - (stream.next_out - output);
+            if (outputRemaining == 0) break;
+            stream.avail_out = static_cast<uInt>(std::min(outputRemaining, static_cast<uint64_t>(UINT_MAX)));
+        }
+        status = inflate(&stream, Z_NO_FLUSH);
+        if (status == Z_BUF_ERROR && inputEnded == false) continue;//needs more input
+        if ((status != Z_OK) && (status != Z_STREAM_END)) break;
+    }
+    const uint64_t numWritten = stream.next_out - output;
+    inflateEnd(&stream);
+    if (status != Z_STREAM_END) {
+        return 0;
+    }
+    return numWritten;
+}
+
 /**
  * convert array indexing order of data.
  */
@@ -892,7 +978,7 @@ GiftiDataArray::convertArrayIndexingOrder()
                 //
                 // Copy the data
                 //
-                std::vector<uint8_t> dataCopy = data;
+                std::vector<uint8_t> dataCopy(data.begin(), data.end());
 
                 switch (arraySubscriptingOrder)
                 {
@@ -998,6 +1084,57 @@ GiftiDataArray::convertArrayIndexingOrder()
     }
 }
 
+/**
+ * Encode the data as the text of its Data element.  Only reads the
+ * data, so different data arrays may be encoded at the same time.
+ * @param encodingForWriting
+ *    Must be BASE64_BINARY or GZIP_BASE64_BINARY.
+ * @param textOut
+ *    Output containing the base64 text.
+ * @throws GiftiException
+ *    If the encoding is not a base64 encoding or compression fails.
+ */
+void
+GiftiDataArray::encodeDataAsText(const GiftiEncodingEnum::Enum encodingForWriting,
+                                 std::vector<char>& textOut) const
+{
+    textOut.clear();
+    if (data.empty()) {
+        return;
+    }
+    const unsigned char* binaryData = &data[0];
+    uint64_t binaryLength = data.size();
+    std::vector<unsigned char> compressedDataBuffer;
+    switch (encodingForWriting) {
+        case GiftiEncodingEnum::BASE64_BINARY:
+            break;
+        case GiftiEncodingEnum::GZIP_BASE64_BINARY:
+        {
+            DataCompressZLib compressor;
+            const uint64_t compressedDataBufferLength = compressor.getMaximumCompressionSpace(data.size());
+            compressedDataBuffer.resize(compressedDataBufferLength);
+            binaryLength = compressor.compressData(&data[0],
+                                                   data.size(),
+                                                   compressedDataBuffer.data(),
+                                                   compressedDataBufferLength);
+            if (binaryLength == 0) {
+                throw GiftiException("Compression of data array failed.");
+            }
+            binaryData = compressedDataBuffer.data();
+            break;
+        }
+        default:
+            throw GiftiException("PROGRAMMER ERROR: encoding data array as text with non-base64 encoding "
+                                 + GiftiEncodingEnum::toName(encodingForWriting));
+    }
+    textOut.resize(((binaryLength + 2) / 3) * 4);
+    const uint64_t textLength = Base64::encode(binaryData,
+                                               binaryLength,
+                                               (unsigned char*)textOut.data());
+    CaretAssert(textLength == textOut.size());
+    textOut.resize(textLength);
+}
+
 /**
  * write the data as XML.
  * @param stream
@@ -1006,11 +1143,15 @@ GiftiDataArray::convertArrayIndexingOrder()
  *    Stream for external binary file.
  * @param encodingForWriting
  *    GIFTI encoding used when writing the data.
+ * @param encodedText
+ *    If not NULL, the text from encodeDataAsText() with the same encoding,
+ *    which is written instead of encoding the data here.
  */
 void 
 GiftiDataArray::writeAsXML(std::ostream& stream, 
                            std::ostream* externalBinaryOutputStream,
-                           GiftiEncodingEnum::Enum encodingForWriting) 
+                           GiftiEncodingEnum::Enum encodingForWriting,
+                           const std::vector<char>* encodedText) 
                                                
 {
     this->encoding = encodingForWriting;
@@ -1167,66 +1308,23 @@ GiftiDataArray::writeAsXML(std::ostream& stream,
          }
          break;
        case GiftiEncodingEnum::BASE64_BINARY:
+       case GiftiEncodingEnum::GZIP_BASE64_BINARY:
          {
             //
-            // Encode the data with VTK's Base64 algorithm
+            // Compress (if gzip) and encode with Base64, unless already done
             //
-            const uint64_t bufferLength = static_cast<uint64_t>(data.size() * 1.5);
-            char* buffer = new char[bufferLength];
-            const uint64_t compressedLength =
-               Base64::encode(&data[0],
-                                          data.size(),
-                                          (unsigned char*)buffer);
-            if (compressedLength >= bufferLength) {
-               throw GiftiException(
-                     "Base64 encoding buffer length ("
-                     + AString::number(bufferLength)
-                     + ") is too small but needs to be "
-                                    + AString::number(compressedLength));
+            std::vector<char> localText;
+            if (encodedText == NULL) {
+                encodeDataAsText(encoding, localText);
+                encodedText = &localText;
             }
-            buffer[compressedLength] = '\0';
             
             //
             // Write the data  MUST BE NO space around data
             //
-            xmlWriter.writeElementNoSpace(GiftiXmlElements::TAG_DATA, buffer);
-            
-            //
-            // Free memory
-            //
-            delete[] buffer;
-         }
-         break;
-       case GiftiEncodingEnum::GZIP_BASE64_BINARY:
-         {
-            //
-            // Compress the data with VTK's ZLIB algorithm
-            //
-             DataCompressZLib compressor;
-             uint64_t compressedDataBufferLength =
-                              compressor.getMaximumCompressionSpace(data.size());
-            std::vector<unsigned char> compressedDataBuffer(compressedDataBufferLength);
-            uint64_t compressedDataLength =
-                          compressor.compressData(&data[0], 
-                                               data.size(),
-                                               compressedDataBuffer.data(),
-                                               compressedDataBufferLength);
-            
-            //
-            // Encode the data with VTK's Base64 algorithm
-            //
-            std::vector<unsigned char> buffer(compressedDataLength + compressedDataLength / 3 + 10);//generous constant for partial bytes, integer rounding, and possible "=" formatting
-            const uint64_t compressedLength =
-               Base64::encode(compressedDataBuffer.data(),
-                                          compressedDataLength,
-                                          buffer.data());
-            buffer[compressedLength] = '\0';
-            
-             //
-             // Write the data  MUST BE NO space around data
-             //
-             xmlWriter.writeElementNoSpace(GiftiXmlElements::TAG_DATA, (char*)buffer.data());
-             
+            xmlWriter.writeElementNoSpace(GiftiXmlElements::TAG_DATA,
+                                          encodedText->data(),
+                                          encodedText->size());
          }
          break;
        case GiftiEncodingEnum::EXTERNAL_FILE_BINARY:
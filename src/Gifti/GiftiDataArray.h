@@ -30,6 +30,7 @@
 #include <stdint.h>
 
 #include "CaretObject.h"
+#include "CaretOMP.h"
 #include "CaretPointer.h"
 #include "DescriptiveStatistics.h"
 #include "FastStatistics.h"
@@ -123,10 +124,27 @@ namespace caret {
                           const int64_t externalFileOffsetForReading,
                           const bool isReadOnlyMetaData);
         
+        // read a data array from the bytes of its Data element, without copying them
+        void readFromBytes(const char* text,
+                           const int64_t textLength,
+                           const GiftiEndianEnum::Enum dataEndianForReading,
+                           const GiftiArrayIndexingOrderEnum::Enum arraySubscriptingOrderForReading,
+                           const NiftiDataTypeEnum::Enum dataTypeForReading,
+                           const std::vector<int64_t>& dimensionsForReading,
+                           const GiftiEncodingEnum::Enum encodingForReading,
+                           const AString& externalFileNameForReading,
+                           const int64_t externalFileOffsetForReading,
+                           const bool isReadOnlyMetaData);
+        
+        // encode the data as the text of its Data element, for the base64 encodings
+        void encodeDataAsText(const GiftiEncodingEnum::Enum encodingForWriting,
+                              std::vector<char>& textOut) const;
+        
         // write the data as XML
         void writeAsXML(std::ostream& stream, 
                         std::ostream* externalBinaryOutputStream,
-                        GiftiEncodingEnum::Enum encodingForWriting);
+                        GiftiEncodingEnum::Enum encodingForWriting,
+                        const std::vector<char>* encodedText = NULL);
         
         /// get endian
         GiftiEndianEnum::Enum getEndian() const { return endian; }
@@ -326,8 +344,14 @@ namespace caret {
         /// convert array indexing order of data
         void convertArrayIndexingOrder();
         
-        /// the data
-        std::vector<uint8_t> data;
+        // decode gzipped base64 text directly into the output, returns the number of bytes uncompressed
+        static uint64_t decodeGzipBase64(const char* text,
+                                         const int64_t textLength,
+                                         unsigned char* output,
+                                         const uint64_t outputLength);
+        
+        /// the data, first touched in parallel when large
+        std::vector<uint8_t, CaretFirstTouchAllocator<uint8_t> > data;
         
         /// size of one data type element
         uint32_t dataTypeSize;
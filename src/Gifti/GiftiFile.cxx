@@ -22,6 +22,7 @@
 #include <memory>
 #include <set>
 #include <sstream>
+#include <vector>
 
 #include "CaretAssert.h"
 #include "CaretLogger.h"
@@ -847,10 +848,47 @@ GiftiFile::readFile(const AString& filename)
     this->clear();
     this->setFileName(filename);
     
-    GiftiFileSaxReader saxReader(this);
+    /*
+     * Keep the raw bytes of a local file so that base64 data arrays can be
+     * decoded directly from them, in parallel, instead of from the parser's
+     * copy of the element text.
+     */
+    std::vector<char> fileBytes;
+    if ((getReadMetaDataOnlyFlag() == false)
+        && (DataFile::isFileOnNetwork(filename) == false)) {
+        QFile file(filename);
+        if (file.open(QFile::ReadOnly)) {
+            const qint64 numBytes = file.size();
+            fileBytes.resize(numBytes + 1);
+            if (file.read(fileBytes.data(), numBytes) != numBytes) {
+                fileBytes.clear();
+            }
+            else {
+                fileBytes[numBytes] = '\0';
+            }
+        }
+    }
+    
     std::unique_ptr<XmlSaxParser> parser(XmlSaxParser::createXmlParser());
     try {
-        parser->parseFile(filename, &saxReader);
+        bool dataDecoded = false;
+        if (fileBytes.empty() == false) {
+            GiftiFileSaxReader saxReader(this);
+            saxReader.setFileBytes(fileBytes.data(), fileBytes.size() - 1);
+            parser->parseFile(filename, &saxReader);
+            dataDecoded = saxReader.decodeDeferredDataArrays();
+            if (dataDecoded == false) {
+                CaretLogFine("Data elements of "
+                             + filename
+                             + " could not be located in the file bytes, reading element text instead");
+                this->clear();
+                this->setFileName(filename);
+            }
+        }
+        if (dataDecoded == false) {
+            GiftiFileSaxReader saxReader(this);
+            parser->parseFile(filename, &saxReader);
+        }
     }
     catch (const XmlSaxParserException& e) {
         clear();
@@ -927,9 +965,11 @@ GiftiFile::writeFile(const AString& filename)
         //
         // Write the data arrays
         //
+        std::vector<GiftiDataArray*> dataArraysToWrite;
         for (int i = 0; i < numberOfDataArrays; i++) {
-            giftiFileWriter.writeDataArray(this->getDataArray(i));
+            dataArraysToWrite.push_back(this->getDataArray(i));
         }
+        giftiFileWriter.writeDataArrays(dataArraysToWrite);
         
         //
         // Finish writing the file
@@ -18,9 +18,12 @@
  */
 /*LICENSE_END*/
 
+#include <cctype>
+#include <cstring>
 #include <sstream>
 
 #include "CaretLogger.h"
+#include "CaretOMP.h"
 #include "FileInformation.h"
 #include "GiftiEndianEnum.h"
 #include "GiftiLabel.h"
@@ -35,6 +38,7 @@
 #include "XmlException.h"
 
 using namespace caret;
+using namespace std;
 
 /**
  * constructor.
@@ -50,6 +54,12 @@ GiftiFileSaxReader::GiftiFileSaxReader(GiftiFile* giftiFileIn)
     this->labelTableSaxReader = NULL;
     this->metaDataSaxReader = NULL;
     this->dataArrayDataHasBeenRead = false;
+    this->fileBytes = NULL;
+    this->fileNumBytes = 0;
+    this->dataElementCount = 0;
+    this->currentDataPayload = -1;
+    this->currentDataPayloadCharacters = 0;
+    this->dataPayloadMismatch = false;
 }
 
 /**
@@ -138,6 +148,22 @@ GiftiFileSaxReader::startElement(const AString& namespaceURI,
          }
          else if (qName == GiftiXmlElements::TAG_DATA) {
             this->state = STATE_DATA_ARRAY_DATA;
+            
+            //
+            // Base64 data is left in the file bytes and decoded after parsing
+            //
+            this->currentDataPayload = -1;
+            if (this->fileBytes != NULL) {
+                if ((this->encodingForReadingArrayData == GiftiEncodingEnum::BASE64_BINARY)
+                    || (this->encodingForReadingArrayData == GiftiEncodingEnum::GZIP_BASE64_BINARY)) {
+                    if (this->dataElementCount < static_cast<int64_t>(this->dataPayloads.size())
+                        && this->dataPayloads[this->dataElementCount].first >= 0) {
+                        this->currentDataPayload = this->dataElementCount;
+                        this->currentDataPayloadCharacters = 0;
+                    }
+                }
+            }
+            this->dataElementCount++;
          }
          else if (qName == GiftiXmlElements::TAG_COORDINATE_TRANSFORMATION_MATRIX) {
             this->state = STATE_DATA_ARRAY_MATRIX;
@@ -260,7 +286,29 @@ GiftiFileSaxReader::endElement(const AString& namespaceURI,
          }
          break;
       case STATE_DATA_ARRAY_DATA:
-           this->processArrayData();
+           if (this->currentDataPayload >= 0) {
+               /*
+                * The parser must have seen exactly the bytes that will be decoded
+                */
+               const pair<int64_t, int64_t>& payload = this->dataPayloads[this->currentDataPayload];
+               if (this->currentDataPayloadCharacters != (payload.second - payload.first)) {
+                   this->dataPayloadMismatch = true;
+               }
+               DeferredDataArray deferred;
+               deferred.dataArray = this->dataArray.getPointer();
+               deferred.payloadIndex = this->currentDataPayload;
+               deferred.endian = this->endianForReadingArrayData;
+               deferred.arraySubscriptingOrder = this->arraySubscriptingOrderForReadingArrayData;
+               deferred.dataType = this->dataTypeForReadingArrayData;
+               deferred.dimensions = this->dimensionsForReadingArrayData;
+               deferred.encoding = this->encodingForReadingArrayData;
+               this->deferredDataArrays.push_back(deferred);
+               this->dataArrayDataHasBeenRead = true;
+               this->currentDataPayload = -1;
+           }
+           else {
+               this->processArrayData();
+           }
            break;
       case STATE_DATA_ARRAY_MATRIX:
          this->matrix = NULL;
@@ -543,6 +591,9 @@ GiftiFileSaxReader::characters(const char* ch)
     else if (this->labelTableSaxReader != NULL) {
         this->labelTableSaxReader->characters(ch);
     }
+    else if (this->currentDataPayload >= 0) {
+        this->currentDataPayloadCharacters += strlen(ch);
+    }
     else {
         elementText += ch;
     }
@@ -594,5 +645,176 @@ GiftiFileSaxReader::startDocument()
 void 
 GiftiFileSaxReader::endDocument()
 {
+    if (this->fileBytes != NULL) {
+        if (this->dataElementCount != static_cast<int64_t>(this->dataPayloads.size())) {
+            this->dataPayloadMismatch = true;
+        }
+    }
+}
+
+/**
+ * Give the reader the raw bytes of the file being parsed.  The text of
+ * base64 encoded Data elements is then not collected while parsing; instead
+ * it is decoded straight from these bytes by decodeDeferredDataArrays().
+ * The bytes must stay valid until then, and must be followed by a null
+ * terminator.
+ */
+void
+GiftiFileSaxReader::setFileBytes(const char* bytes,
+                                 const int64_t numBytes)
+{
+    this->fileBytes = bytes;
+    this->fileNumBytes = numBytes;
+    findDataPayloads(bytes, numBytes, this->dataPayloads);
+}
+
+/**
+ * Decode the data arrays that were deferred while parsing, in parallel.
+ *
+ * @return
+ *    False if the Data elements seen by the parser did not match the ones
+ *    found in the file bytes, in which case the file must be read again
+ *    without file bytes.
+ * @throws XmlSaxParserException
+ *    If decoding a data array fails.
+ */
+bool
+GiftiFileSaxReader::decodeDeferredDataArrays()
+{
+    if (this->dataPayloadMismatch) {
+        this->deferredDataArrays.clear();
+        return false;
+    }
+    const int64_t numDeferred = static_cast<int64_t>(this->deferredDataArrays.size());
+    const bool readMetaDataOnly = this->giftiFile->getReadMetaDataOnlyFlag();
+    int64_t errorIndex = -1;
+    AString errorMessage;
+#pragma omp CARET_PARFOR schedule(dynamic)
+    for (int64_t i = 0; i < numDeferred; ++i) {
+        const DeferredDataArray& deferred = this->deferredDataArrays[i];
+        const pair<int64_t, int64_t>& payload = this->dataPayloads[deferred.payloadIndex];
+        try {
+            deferred.dataArray->readFromBytes(this->fileBytes + payload.first,
+                                              payload.second - payload.first,
+                                              deferred.endian,
+                                              deferred.arraySubscriptingOrder,
+                                              deferred.dataType,
+                                              deferred.dimensions,
+                                              deferred.encoding,
+                                              "",
+                                              0,
+                                              readMetaDataOnly);
+        }
+        catch (const GiftiException& e) {
+#pragma omp critical
+            {
+                if ((errorIndex < 0) || (i < errorIndex)) {//report the first array in the file that failed
+                    errorIndex = i;
+                    errorMessage = e.whatString();
+                }
+            }
+        }
+    }
+    this->deferredDataArrays.clear();
+    if (errorIndex >= 0) {
+        throw XmlSaxParserException(errorMessage);
+    }
+    return true;
+}
+
+/**
+ * Find the text of every Data element in the raw bytes of a GIFTI file,
+ * skipping comments, CDATA sections, and other markup.  A Data element
+ * whose text is not plain characters (contains an entity reference or
+ * markup) gets a start of -1, since its bytes differ from its text.
+ */
+void
+GiftiFileSaxReader::findDataPayloads(const char* bytes,
+                                     const int64_t numBytes,
+                                     vector<pair<int64_t, int64_t> >& payloadsOut)
+{
+    payloadsOut.clear();
+    const string dataTag = "<" + GiftiXmlElements::TAG_DATA.toStdString();
+    const string dataEndTag = "</" + GiftiXmlElements::TAG_DATA.toStdString();
+    const char* end = bytes + numBytes;
+    const char* ptr = bytes;
+    while (ptr < end) {
+        ptr = (const char*)memchr(ptr, '<', end - ptr);
+        if (ptr == NULL) break;
+        const int64_t remaining = end - ptr;
+        const char* closer = NULL;//text that ends the markup starting at ptr
+        if (remaining >= 4 && strncmp(ptr, "<!--", 4) == 0) {
+            closer = "-->";
+        }
+        else if (remaining >= 9 && strncmp(ptr, "<![CDATA[", 9) == 0) {
+            closer = "]]>";
+        }
+        else if (remaining >= 2 && strncmp(ptr, "<?", 2) == 0) {
+            closer = "?>";
+        }
+        if (closer != NULL) {
+            const int64_t closerLength = strlen(closer);
+            const char* search = ptr + 2;
+            while (true) {
+                search = (const char*)memchr(search, closer[0], end - search);
+                if (search == NULL || end - search < closerLength) return;
+                if (strncmp(search, closer, closerLength) == 0) break;
+                ++search;
+            }
+            ptr = search + closerLength;
+            continue;
+        }
+        
+        //
+        // Ordinary tag, find its end while skipping quoted attribute values and DOCTYPE internal subsets
+        //
+        const bool isDataTag = (remaining > (int64_t)dataTag.size()
+                                && strncmp(ptr, dataTag.c_str(), dataTag.size()) == 0
+                                && (ptr[dataTag.size()] == '>' || ptr[dataTag.size()] == '/' || isspace((unsigned char)ptr[dataTag.size()])));
+        char quote = 0;
+        int bracketDepth = 0;
+        const char* tagEnd = ptr + 1;
+        for (; tagEnd < end; ++tagEnd) {
+            const char c = *tagEnd;
+            if (quote != 0) {
+                if (c == quote) quote = 0;
+            }
+            else if (c == '"' || c == '\'') {
+                quote = c;
+            }
+            else if (c == '[') {
+                ++bracketDepth;
+            }
+            else if (c == ']') {
+                --bracketDepth;
+            }
+            else if (c == '>' && bracketDepth <= 0) {
+                break;
+            }
+        }
+        if (tagEnd >= end) return;
+        if (isDataTag) {
+            if (tagEnd[-1] == '/') {//empty element
+                payloadsOut.push_back(make_pair((int64_t)(tagEnd + 1 - bytes), (int64_t)(tagEnd + 1 - bytes)));
+            }
+            else {
+                const char* textStart = tagEnd + 1;
+                const char* textEnd = (const char*)memchr(textStart, '<', end - textStart);
+                if (textEnd == NULL) return;
+                const bool endsWithEndTag = (end - textEnd > (int64_t)dataEndTag.size()
+                                             && strncmp(textEnd, dataEndTag.c_str(), dataEndTag.size()) == 0
+                                             && (textEnd[dataEndTag.size()] == '>' || isspace((unsigned char)textEnd[dataEndTag.size()])));
+                if (endsWithEndTag && memchr(textStart, '&', textEnd - textStart) == NULL) {
+                    payloadsOut.push_back(make_pair((int64_t)(textStart - bytes), (int64_t)(textEnd - bytes)));
+                }
+                else {
+                    payloadsOut.push_back(make_pair((int64_t)-1, (int64_t)-1));
+                }
+                ptr = textEnd;//continue at the markup following the text
+                continue;
+            }
+        }
+        ptr = tagEnd + 1;
+    }
 }
 
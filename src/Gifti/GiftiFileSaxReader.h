@@ -23,6 +23,8 @@
 /*LICENSE_END*/
 
 #include <stack>
+#include <utility>
+#include <vector>
 #include <AString.h>
 #include <stdint.h>
 
@@ -74,6 +76,16 @@ namespace caret {
         
         void endDocument();
         
+        // give the reader the raw bytes of the file so base64 data can be decoded from them
+        void setFileBytes(const char* bytes, const int64_t numBytes);
+        
+        // decode the data arrays whose base64 data was left in the raw file bytes
+        bool decodeDeferredDataArrays();
+        
+        // find the byte ranges of the text of each Data element
+        static void findDataPayloads(const char* bytes,
+                                     const int64_t numBytes,
+                                     std::vector<std::pair<int64_t, int64_t> >& payloadsOut);
         
     protected:
         /// file reading states
@@ -162,6 +174,41 @@ namespace caret {
         
         /// tracks if data has been read since external binary may not have DATA tag
         bool dataArrayDataHasBeenRead;
+        
+        /// a data array whose base64 data is decoded after parsing
+        struct DeferredDataArray {
+            GiftiDataArray* dataArray;
+            int64_t payloadIndex;
+            GiftiEndianEnum::Enum endian;
+            GiftiArrayIndexingOrderEnum::Enum arraySubscriptingOrder;
+            NiftiDataTypeEnum::Enum dataType;
+            std::vector<int64_t> dimensions;
+            GiftiEncodingEnum::Enum encoding;
+        };
+        
+        /// raw bytes of the file, NULL when data is decoded from the element text
+        const char* fileBytes;
+        
+        /// number of raw bytes of the file
+        int64_t fileNumBytes;
+        
+        /// byte range (start, end) of the text of each Data element, start is -1 if it can't be used directly
+        std::vector<std::pair<int64_t, int64_t> > dataPayloads;
+        
+        /// number of Data elements started
+        int64_t dataElementCount;
+        
+        /// payload used by the current Data element, -1 when collecting element text
+        int64_t currentDataPayload;
+        
+        /// characters received for the current deferred Data element
+        int64_t currentDataPayloadCharacters;
+        
+        /// data arrays waiting to be decoded
+        std::vector<DeferredDataArray> deferredDataArrays;
+        
+        /// the parser's view of a Data element didn't match the raw bytes
+        bool dataPayloadMismatch;
     };
 
 } // namespace
@@ -26,6 +26,7 @@
 #include "GiftiFileWriter.h"
 #undef __GIFTI_FILE_WRITER_DECLARE__
 
+#include "CaretTaskPool.h"
 #include "FileInformation.h"
 #include "GiftiDataArray.h"
 #include "GiftiXmlElements.h"
@@ -44,7 +45,7 @@ using namespace caret;
  * GiftiDataArrayFile's writeFile() method should be used for writing a file.
  * This class can be used to incrementally write a file.  After constructing
  * an object of this class, call start(), call writeDataArray() for each
- * data array, and lastly call finish().
+ * data array (or writeDataArrays() for several), and lastly call finish().
  */
 /**
  * Constructor.
@@ -179,6 +180,86 @@ GiftiFileWriter::start(const int numberOfDataArrays,
  */
 void 
 GiftiFileWriter::writeDataArray(GiftiDataArray* gda)
+{
+    this->writeDataArray(gda, NULL);
+}
+
+/**
+ * Write GIFTI Data Arrays, in order.  With the base64 encodings, the
+ * arrays are compressed and encoded into memory concurrently, in batches
+ * limited by memory, and each batch is then written in order.
+ *
+ * @param dataArrays - The data arrays.
+ * @throws GiftiException - If an error occurs.
+ */
+void
+GiftiFileWriter::writeDataArrays(const std::vector<GiftiDataArray*>& dataArrays)
+{
+    this->verifyOpened();
+    
+    const int64_t numArrays = static_cast<int64_t>(dataArrays.size());
+    if ((this->encoding != GiftiEncodingEnum::BASE64_BINARY)
+        && (this->encoding != GiftiEncodingEnum::GZIP_BASE64_BINARY)) {
+        for (int64_t i = 0; i < numArrays; i++) {
+            this->writeDataArray(dataArrays[i], NULL);
+        }
+        return;
+    }
+    
+    /*
+     * Base64 text is 4/3 the size of the data (less when gzipped), bound the
+     * data encoded at once so that large files don't double in memory.
+     */
+    const int64_t maximumBatchBytes = 512 * 1024 * 1024;
+    const int64_t maximumBatchArrays = 4 * CaretTaskPool::getNumThreads();
+    std::vector<std::vector<char> > encodedTexts;
+    int64_t batchStart = 0;
+    while (batchStart < numArrays) {
+        int64_t batchEnd = batchStart;
+        int64_t batchBytes = 0;
+        while ((batchEnd < numArrays)
+               && (batchEnd - batchStart < maximumBatchArrays)
+               && ((batchEnd == batchStart) || (batchBytes < maximumBatchBytes))) {
+            batchBytes += dataArrays[batchEnd]->getDataSizeInBytes();
+            batchEnd++;
+        }
+        encodedTexts.clear();
+        encodedTexts.resize(batchEnd - batchStart);
+        try {
+            CaretTaskGroup encodeTasks((int)(batchEnd - batchStart));
+            for (int64_t i = batchStart; i < batchEnd; i++) {
+                const GiftiDataArray* gda = dataArrays[i];
+                std::vector<char>* textOut = &encodedTexts[i - batchStart];
+                const GiftiEncodingEnum::Enum myEncoding = this->encoding;
+                encodeTasks.run([gda, textOut, myEncoding]() {
+                    gda->encodeDataAsText(myEncoding, *textOut);
+                });
+            }
+            encodeTasks.wait();
+        }
+        catch (const GiftiException& e) {
+            this->closeFiles();
+            throw e;
+        }
+        for (int64_t i = batchStart; i < batchEnd; i++) {
+            std::vector<char>& text = encodedTexts[i - batchStart];
+            this->writeDataArray(dataArrays[i], &text);
+            std::vector<char>().swap(text);//free each array's text once written
+        }
+        batchStart = batchEnd;
+    }
+}
+
+/**
+ * Write a GIFTI Data Array.
+ *
+ * @param gda - The data array.
+ * @param encodedText - The data already encoded for the file's encoding, or NULL.
+ * @throws GiftiException - If an error occurs.
+ */
+void
+GiftiFileWriter::writeDataArray(GiftiDataArray* gda,
+                                const std::vector<char>* encodedText)
 {
     this->verifyOpened();
     
@@ -221,7 +302,8 @@ GiftiFileWriter::writeDataArray(GiftiDataArray* gda)
         //
         gda->writeAsXML(*this->xmlFileOutputStream, 
                         this->externalFileOutputStream,
-                        this->encoding);
+                        this->encoding,
+                        encodedText);
         
         //
         // Increment counter of data arrays written
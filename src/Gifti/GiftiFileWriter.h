@@ -22,6 +22,7 @@
 /*LICENSE_END*/
 
 #include <fstream>
+#include <vector>
 
 #include "CaretObject.h"
 #include "GiftiFile.h"
@@ -47,6 +48,8 @@ namespace caret {
                    GiftiLabelTable* labelTable);
         void writeDataArray(GiftiDataArray* gda);
         
+        void writeDataArrays(const std::vector<GiftiDataArray*>& dataArrays);
+        
         void finish();
         
         long getMaximumExternalFileSize() const;
@@ -62,6 +65,9 @@ namespace caret {
         
         void verifyOpened();
         
+        void writeDataArray(GiftiDataArray* gda,
+                            const std::vector<char>* encodedText);
+        
         void removeExternalFiles();
         
         AString getExternalFileNamePrefix() const;
@@ -0,0 +1,390 @@
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#define __GRAPHICS_OPEN_G_L_SURFACE_BUFFERS_DECLARE__
+#include "GraphicsOpenGLSurfaceBuffers.h"
+#undef __GRAPHICS_OPEN_G_L_SURFACE_BUFFERS_DECLARE__
+
+#include "CaretAssert.h"
+#include "CaretLogger.h"
+#include "EventGraphicsOpenGLCreateBufferObject.h"
+#include "EventManager.h"
+#include "GraphicsOpenGLBufferObject.h"
+
+using namespace caret;
+
+
+    
+/**
+ * \class caret::GraphicsOpenGLSurfaceBuffers 
+ * \brief Persistent OpenGL buffer objects for drawing a surface's triangles.
+ * \ingroup Graphics
+ *
+ * The coordinates, normal vectors, and triangles are loaded into buffer
+ * objects once and remain on the graphics card until the surface's
+ * geometry changes.  Each set of vertex coloring (a surface may be
+ * colored differently in each tab and in surface montage / whole brain)
+ * has its own color buffer that is reloaded only when that coloring
+ * is invalidated.  This avoids sending all of the surface's vertex data
+ * to OpenGL every time the surface is drawn.
+ */
+
+/**
+ * Constructor.
+ */
+GraphicsOpenGLSurfaceBuffers::GraphicsOpenGLSurfaceBuffers()
+: CaretObject()
+{
+    
+}
+
+/**
+ * Destructor.
+ */
+GraphicsOpenGLSurfaceBuffers::~GraphicsOpenGLSurfaceBuffers()
+{
+    deleteBuffers();
+}
+
+/**
+ * Delete all of the buffer objects.  Buffer objects
+ * are deleted later in the OpenGL context in which
+ * they were created.
+ */
+void
+GraphicsOpenGLSurfaceBuffers::deleteBuffers()
+{
+    m_coordinateBufferObject.reset();
+    m_normalVectorBufferObject.reset();
+    m_triangleBufferObject.reset();
+    m_colorBuffers.clear();
+    m_numberOfVertices   = 0;
+    m_numberOfTriangles  = 0;
+    m_geometryValidFlag  = false;
+    m_openglContextPointer = NULL;
+}
+
+/**
+ * Invalidate the coordinates, normal vectors, and triangles
+ * so that they are reloaded the next time the surface is drawn.
+ */
+void
+GraphicsOpenGLSurfaceBuffers::invalidateGeometry()
+{
+    m_geometryValidFlag = false;
+}
+
+/**
+ * Invalidate one set of vertex coloring.
+ *
+ * @param rgba
+ *     The memory containing the coloring that has changed.
+ */
+void
+GraphicsOpenGLSurfaceBuffers::invalidateColors(const float* rgba)
+{
+    std::map<const float*, ColorBuffer>::iterator iter = m_colorBuffers.find(rgba);
+    if (iter != m_colorBuffers.end()) {
+        iter->second.m_validFlag = false;
+    }
+}
+
+/**
+ * Invalidate all vertex coloring.  The color buffer objects are
+ * retained so that they may be reused when new coloring is loaded.
+ */
+void
+GraphicsOpenGLSurfaceBuffers::invalidateAllColors()
+{
+    for (auto& iter : m_colorBuffers) {
+        iter.second.m_validFlag = false;
+    }
+}
+
+/**
+ * Remove the color buffer for one set of vertex coloring.  Must be
+ * called before the memory containing the coloring is freed or moved,
+ * as other coloring may later be allocated at the same address.
+ *
+ * @param rgba
+ *     The memory containing the coloring.
+ */
+void
+GraphicsOpenGLSurfaceBuffers::removeColors(const float* rgba)
+{
+    m_colorBuffers.erase(rgba);
+}
+
+/**
+ * Remove the color buffers for all vertex coloring.  Must be called
+ * when the memory containing the coloring is freed or moved.
+ */
+void
+GraphicsOpenGLSurfaceBuffers::removeAllColors()
+{
+    m_colorBuffers.clear();
+}
+
+/**
+ * @return A new buffer object or NULL if creation failed.
+ */
+GraphicsOpenGLBufferObject*
+GraphicsOpenGLSurfaceBuffers::createBufferObject() const
+{
+    EventGraphicsOpenGLCreateBufferObject createEvent;
+    EventManager::get()->sendEvent(createEvent.getPointer());
+    GraphicsOpenGLBufferObject* bufferObject = createEvent.getOpenGLBufferObject();
+    if (bufferObject != NULL) {
+        if (bufferObject->getBufferObjectName() == 0) {
+            delete bufferObject;
+            bufferObject = NULL;
+        }
+    }
+    
+    return bufferObject;
+}
+
+/**
+ * Load the coordinates, normal vectors, and triangles into buffer objects.
+ *
+ * @return True if the buffers were loaded, else false.
+ */
+bool
+GraphicsOpenGLSurfaceBuffers::loadGeometryBuffers(const int32_t numberOfVertices,
+                                                  const float* xyz,
+                                                  const float* normals,
+                                                  const int32_t numberOfTriangles,
+                                                  const int32_t* triangles)
+{
+    if ( ! m_coordinateBufferObject) {
+        m_coordinateBufferObject.reset(createBufferObject());
+    }
+    if ( ! m_normalVectorBufferObject) {
+        m_normalVectorBufferObject.reset(createBufferObject());
+    }
+    if ( ! m_triangleBufferObject) {
+        m_triangleBufferObject.reset(createBufferObject());
+    }
+    if (( ! m_coordinateBufferObject)
+        || ( ! m_normalVectorBufferObject)
+        || ( ! m_triangleBufferObject)) {
+        return false;
+    }
+    
+    const GLsizeiptr vertexSizeBytes = static_cast<GLsizeiptr>(numberOfVertices) * 3 * sizeof(float);
+    glBindBuffer(GL_ARRAY_BUFFER,
+                 m_coordinateBufferObject->getBufferObjectName());
+    glBufferData(GL_ARRAY_BUFFER,
+                 vertexSizeBytes,
+                 (const GLvoid*)xyz,
+                 GL_STATIC_DRAW);
+    
+    glBindBuffer(GL_ARRAY_BUFFER,
+                 m_normalVectorBufferObject->getBufferObjectName());
+    glBufferData(GL_ARRAY_BUFFER,
+                 vertexSizeBytes,
+                 (const GLvoid*)normals,
+                 GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER,
+                 0);
+    
+    const GLsizeiptr triangleSizeBytes = static_cast<GLsizeiptr>(numberOfTriangles) * 3 * sizeof(int32_t);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
+                 m_triangleBufferObject->getBufferObjectName());
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                 triangleSizeBytes,
+                 (const GLvoid*)triangles,
+                 GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
+                 0);
+    
+    m_numberOfVertices  = numberOfVertices;
+    m_numberOfTriangles = numberOfTriangles;
+    m_geometryValidFlag = true;
+    
+    /*
+     * Color buffers are sized by number of vertices
+     */
+    invalidateAllColors();
+    
+    return true;
+}
+
+/**
+ * Get the color buffer for the given coloring, loading the colors
+ * if they have changed since the last time they were loaded.
+ *
+ * @param numberOfVertices
+ *     Number of vertices.
+ * @param rgba
+ *     RGBA coloring for the vertices.
+ * @return
+ *     The color buffer or NULL if it could not be created.
+ */
+GraphicsOpenGLBufferObject*
+GraphicsOpenGLSurfaceBuffers::loadColorBuffer(const int32_t numberOfVertices,
+                                              const float* rgba)
+{
+    ColorBuffer& colorBuffer = m_colorBuffers[rgba];
+    if ( ! colorBuffer.m_bufferObject) {
+        colorBuffer.m_bufferObject.reset(createBufferObject());
+        if ( ! colorBuffer.m_bufferObject) {
+            m_colorBuffers.erase(rgba);
+            return NULL;
+        }
+        colorBuffer.m_validFlag = false;
+    }
+    
+    if ( ! colorBuffer.m_validFlag) {
+        const GLsizeiptr colorSizeBytes = static_cast<GLsizeiptr>(numberOfVertices) * 4 * sizeof(float);
+        glBindBuffer(GL_ARRAY_BUFFER,
+                     colorBuffer.m_bufferObject->getBufferObjectName());
+        glBufferData(GL_ARRAY_BUFFER,
+                     colorSizeBytes,
+                     (const GLvoid*)rgba,
+                     GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER,
+                     0);
+        colorBuffer.m_validFlag = true;
+    }
+    
+    return colorBuffer.m_bufferObject.get();
+}
+
+/**
+ * Draw the surface triangles using the buffer objects.  Buffers are
+ * (re)loaded as needed.  If the coloring is NULL, the caller is expected
+ * to have set the current OpenGL color.
+ *
+ * @param openglContextPointer
+ *     Pointer to the current OpenGL context (sharing group).
+ * @param numberOfVertices
+ *     Number of vertices.
+ * @param xyz
+ *     Coordinates of the vertices.
+ * @param normals
+ *     Normal vectors of the vertices.
+ * @param numberOfTriangles
+ *     Number of triangles.
+ * @param triangles
+ *     Vertex indices of the triangles.
+ * @param rgba
+ *     RGBA coloring for the vertices (may be NULL).  Its color buffer is
+ *     reused until invalidateColors() or removeColors() is called for it.
+ * @return
+ *     True if the surface was drawn, false if buffers are not available
+ *     in which case the caller should draw the surface with another method.
+ */
+bool
+GraphicsOpenGLSurfaceBuffers::draw(void* openglContextPointer,
+                                   const int32_t numberOfVertices,
+                                   const float* xyz,
+                                   const float* normals,
+                                   const int32_t numberOfTriangles,
+                                   const int32_t* triangles,
+                                   const float* rgba)
+{
+    if ((openglContextPointer == NULL)
+        || (numberOfVertices <= 0)
+        || (numberOfTriangles <= 0)) {
+        return false;
+    }
+    CaretAssert(xyz);
+    CaretAssert(normals);
+    CaretAssert(triangles);
+    
+    /*
+     * Buffers are only valid in the context in which they were created
+     */
+    if (openglContextPointer != m_openglContextPointer) {
+        deleteBuffers();
+        m_openglContextPointer = openglContextPointer;
+    }
+    
+    if (( ! m_geometryValidFlag)
+        || (numberOfVertices != m_numberOfVertices)
+        || (numberOfTriangles != m_numberOfTriangles)) {
+        if ( ! loadGeometryBuffers(numberOfVertices,
+                                   xyz,
+                                   normals,
+                                   numberOfTriangles,
+                                   triangles)) {
+            CaretLogWarning("Failed to create OpenGL buffers for surface drawing");
+            deleteBuffers();
+            return false;
+        }
+    }
+    
+    GraphicsOpenGLBufferObject* colorBufferObject = NULL;
+    if (rgba != NULL) {
+        colorBufferObject = loadColorBuffer(numberOfVertices,
+                                            rgba);
+        if (colorBufferObject == NULL) {
+            return false;
+        }
+    }
+    
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER,
+                 m_coordinateBufferObject->getBufferObjectName());
+    glVertexPointer(3, GL_FLOAT, 0, (GLvoid*)0);
+    
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glBindBuffer(GL_ARRAY_BUFFER,
+                 m_normalVectorBufferObject->getBufferObjectName());
+    glNormalPointer(GL_FLOAT, 0, (GLvoid*)0);
+    
+    if (colorBufferObject != NULL) {
+        glEnableClientState(GL_COLOR_ARRAY);
+        glBindBuffer(GL_ARRAY_BUFFER,
+                     colorBufferObject->getBufferObjectName());
+        glColorPointer(4, GL_FLOAT, 0, (GLvoid*)0);
+    }
+    
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
+                 m_triangleBufferObject->getBufferObjectName());
+    glDrawElements(GL_TRIANGLES,
+                   (3 * m_numberOfTriangles),
+                   GL_UNSIGNED_INT,
+                   (GLvoid*)0);
+    
+    glBindBuffer(GL_ARRAY_BUFFER,
+                 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,
+                 0);
+    
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    
+    return true;
+}
+
+/**
+ * Get a description of this object's content.
+ * @return String describing this object's content.
+ */
+AString 
+GraphicsOpenGLSurfaceBuffers::toString() const
+{
+    return "GraphicsOpenGLSurfaceBuffers";
+}
+
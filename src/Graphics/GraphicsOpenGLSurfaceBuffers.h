@@ -0,0 +1,119 @@
+#ifndef __GRAPHICS_OPEN_G_L_SURFACE_BUFFERS_H__
+#define __GRAPHICS_OPEN_G_L_SURFACE_BUFFERS_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026 Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include <map>
+#include <memory>
+
+#include "CaretObject.h"
+#include "CaretOpenGLInclude.h"
+
+namespace caret {
+
+    class GraphicsOpenGLBufferObject;
+    
+    class GraphicsOpenGLSurfaceBuffers : public CaretObject {
+        
+    public:
+        GraphicsOpenGLSurfaceBuffers();
+        
+        virtual ~GraphicsOpenGLSurfaceBuffers();
+        
+        void invalidateGeometry();
+        
+        void invalidateColors(const float* rgba);
+        
+        void invalidateAllColors();
+        
+        void removeColors(const float* rgba);
+        
+        void removeAllColors();
+        
+        bool draw(void* openglContextPointer,
+                  const int32_t numberOfVertices,
+                  const float* xyz,
+                  const float* normals,
+                  const int32_t numberOfTriangles,
+                  const int32_t* triangles,
+                  const float* rgba);
+        
+        // ADD_NEW_METHODS_HERE
+
+        virtual AString toString() const;
+        
+    private:
+        /**
+         * Color buffer for one set of vertex coloring (one tab / view type of a surface)
+         */
+        class ColorBuffer {
+        public:
+            std::unique_ptr<GraphicsOpenGLBufferObject> m_bufferObject;
+            
+            /** True if the buffer contains the current colors */
+            bool m_validFlag = false;
+        };
+        
+        GraphicsOpenGLSurfaceBuffers(const GraphicsOpenGLSurfaceBuffers&);
+
+        GraphicsOpenGLSurfaceBuffers& operator=(const GraphicsOpenGLSurfaceBuffers&);
+        
+        void deleteBuffers();
+        
+        GraphicsOpenGLBufferObject* createBufferObject() const;
+        
+        bool loadGeometryBuffers(const int32_t numberOfVertices,
+                                 const float* xyz,
+                                 const float* normals,
+                                 const int32_t numberOfTriangles,
+                                 const int32_t* triangles);
+        
+        GraphicsOpenGLBufferObject* loadColorBuffer(const int32_t numberOfVertices,
+                                                    const float* rgba);
+        
+        /** Context in which the buffers were created */
+        void* m_openglContextPointer = NULL;
+        
+        std::unique_ptr<GraphicsOpenGLBufferObject> m_coordinateBufferObject;
+        
+        std::unique_ptr<GraphicsOpenGLBufferObject> m_normalVectorBufferObject;
+        
+        std::unique_ptr<GraphicsOpenGLBufferObject> m_triangleBufferObject;
+        
+        /** Color buffers keyed by the memory containing the vertex colors, the owner of that memory must call removeColors() before freeing or moving it */
+        std::map<const float*, ColorBuffer> m_colorBuffers;
+        
+        int32_t m_numberOfVertices = 0;
+        
+        int32_t m_numberOfTriangles = 0;
+        
+        bool m_geometryValidFlag = false;
+        
+        // ADD_NEW_MEMBERS_HERE
+
+    };
+    
+#ifdef __GRAPHICS_OPEN_G_L_SURFACE_BUFFERS_DECLARE__
+    // <PLACE DECLARATIONS OF STATIC MEMBERS HERE>
+#endif // __GRAPHICS_OPEN_G_L_SURFACE_BUFFERS_DECLARE__
+
+} // namespace
+#endif  //__GRAPHICS_OPEN_G_L_SURFACE_BUFFERS_H__
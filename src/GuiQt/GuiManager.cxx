@@ -62,6 +62,7 @@
 #include "CursorDisplayScoped.h"
 #include "CursorManager.h"
 #include "CustomViewDialog.h"
+#include "CziImageTileCache.h"
 #include "DataFileException.h"
 #include "DataToolTipsManager.h"
 #include "ElapsedTimer.h"
@@ -369,9 +370,16 @@ GuiManager::initializeGuiManager()
      */
     m_dataToolTipsEnabledAction = NULL;
     
+    /*
+     * Load CZI image tiles in the background so the GUI stays responsive
+     * when panning and zooming
+     */
+    CziImageTileCache::setBackgroundLoadingEnabled(true);
+    
     EventManager::get()->addEventListener(this, EventTypeEnum::EVENT_ALERT_USER);
     EventManager::get()->addEventListener(this, EventTypeEnum::EVENT_ANNOTATION_GET_DRAWN_IN_WINDOW);
     EventManager::get()->addEventListener(this, EventTypeEnum::EVENT_BROWSER_WINDOW_NEW);
+    EventManager::get()->addEventListener(this, EventTypeEnum::EVENT_CZI_IMAGE_TILE_LOADED);
     EventManager::get()->addEventListener(this, EventTypeEnum::EVENT_GRAPHICS_PAINT_SOON_ALL_WINDOWS);
     EventManager::get()->addEventListener(this, EventTypeEnum::EVENT_GRAPHICS_PAINT_SOON_ONE_WINDOW);
     EventManager::get()->addEventListener(this, EventTypeEnum::EVENT_HELP_VIEWER_DISPLAY);
@@ -1516,6 +1524,13 @@ GuiManager::receiveEvent(Event* event)
                                preferredMaxHeight);
         bbw->resize(w, h);
     }
+    else if (event->getEventType() == EventTypeEnum::EVENT_CZI_IMAGE_TILE_LOADED) {
+        /*
+         * Redraw so that the new tile replaces the lower resolution image
+         */
+        EventManager::get()->sendEvent(EventGraphicsPaintSoonAllWindows().getPointer());
+        event->setEventProcessed();
+    }
     else if ((event->getEventType() == EventTypeEnum::EVENT_GRAPHICS_PAINT_SOON_ALL_WINDOWS)
              || (event->getEventType() == EventTypeEnum::EVENT_GRAPHICS_PAINT_SOON_ONE_WINDOW)) {
         for (auto overlayEditor : m_overlaySettingsEditors) {
@@ -711,6 +711,37 @@ void NiftiHeader::setDataTypeAndScaleRange(const int16_t& type, const double& mi
     }
 }
 
+void NiftiHeader::setDataTypeAndDataRange(const int16_t& type, const double& dataMin, const double& dataMax)
+{
+    switch (type)
+    {
+        case NIFTI_TYPE_RGB24:
+        case NIFTI_TYPE_FLOAT32:
+        case NIFTI_TYPE_COMPLEX64:
+        case NIFTI_TYPE_FLOAT64:
+        case NIFTI_TYPE_COMPLEX128:
+        case NIFTI_TYPE_FLOAT128:
+        case NIFTI_TYPE_COMPLEX256:
+            setDataType(type);//floating point doesn't need a range
+            clearDataScaling();
+            return;
+        default:
+            break;
+    }
+    if (!(MathFunctions::isNumeric(dataMin) && MathFunctions::isNumeric(dataMax)) || dataMin > dataMax)
+    {//no finite values to fit
+        setDataType(type);
+        clearDataScaling();
+        return;
+    }
+    if (dataMin == dataMax)
+    {//constant data would give a zero scale, which means unscaled
+        setDataTypeAndScaleRange(type, dataMin - 1.0, dataMax + 1.0);
+        return;
+    }
+    setDataTypeAndScaleRange(type, dataMin, dataMax);
+}
+
 int NiftiHeader::getNumComponents() const
 {
     switch (getDataType())
@@ -76,6 +76,7 @@ namespace caret
         void clearDataScaling();
         void setDataScaling(const double& mult, const double& offset);
         void setDataTypeAndScaleRange(const int16_t& type, const double& minval, const double& maxval);
+        void setDataTypeAndDataRange(const int16_t& type, const double& dataMin, const double& dataMax);//scale integer types to fit the range found in the data
         
         ///get the FSL "scale" space
         std::vector<std::vector<float> > getFSLSpace() const;
@@ -32,6 +32,7 @@
 
 #include <cmath>
 #include <limits>
+#include <type_traits>
 #include <vector>
 
 namespace caret
@@ -51,6 +52,10 @@ namespace caret
         void convertWrite(TO* out, const FROM* in, const int64_t& count);//for writing to file
         template<typename TO, typename FROM>
         static TO clamp(const FROM& in);//deal with integer cast being undefined when converting from outside range
+        template<typename TO>
+        static void quantizeFloats(TO* out, const float* in, const int64_t& count, const double& mult, const double& offset);//fast path for writing 8 and 16 bit types
+        template<typename FROM>
+        static void dequantizeToFloats(float* out, const FROM* in, const int64_t& count, const double& mult, const double& offset);//fast path for reading them
     public:
         void openRead(const QString& filename);
         void writeNew(const QString& filename, const NiftiHeader& header, const int& version = 1, const bool& withRead = false, const bool& swapEndian = false);
@@ -220,6 +225,11 @@ namespace caret
         }
         double mult, offset;
         bool doScale = m_header.getDataScaling(mult, offset);
+        if (std::is_same<TO, float>::value && std::numeric_limits<FROM>::is_integer && sizeof(FROM) <= 2)
+        {//small integer types are the usual compact storage, double is plenty for them and lets the compiler vectorize
+            dequantizeToFloats((float*)out, in, count, mult, offset);
+            return;
+        }
         if (std::numeric_limits<TO>::is_integer)//do round to nearest when integer output type
         {
             if (doScale)
@@ -255,6 +265,12 @@ namespace caret
     {
         double mult, offset;
         bool doScale = m_header.getDataScaling(mult, offset);
+        if (std::numeric_limits<TO>::is_integer && sizeof(TO) <= 2 && std::is_same<FROM, float>::value)
+        {//writing scaled 8 or 16 bit output from float is the common quantizing case
+            quantizeFloats(out, (const float*)in, count, mult, offset);
+            if (m_header.isSwapped()) ByteSwapping::swapArray(out, count);
+            return;
+        }
         if (std::numeric_limits<TO>::is_integer)//do round to nearest when integer output type
         {//TODO: what about NaN?
             if (doScale)
@@ -301,6 +317,41 @@ namespace caret
         }//*/
         return (TO)in;
     }
+    
+    template<typename TO>
+    void NiftiIO::quantizeFloats(TO* out, const float* in, const int64_t& count, const double& mult, const double& offset)
+    {//same as clamp(floor(0.5 + (in - offset) / mult)), but the main loop is written without branches or long double so it vectorizes
+        const double low = std::numeric_limits<TO>::lowest(), high = std::numeric_limits<TO>::max();
+        const double nanShifted = 0.5 - offset / mult;//write NaN as whatever is closest to 0
+        for (int64_t i = 0; i < count; ++i)
+        {
+            double shifted = ((double)in[i] - offset) / mult + 0.5;
+            shifted = (shifted == shifted) ? shifted : nanShifted;
+            shifted = (shifted > low) ? shifted : low;
+            shifted = (shifted < high) ? shifted : high;
+            out[i] = (TO)((int32_t)(shifted + 65536.0) - 65536);//truncating a positive number is floor, and 8 and 16 bit ranges are within +/-65536
+        }
+        //double rounding can put a value that is almost exactly halfway between steps on the other side than long double does,
+        //so redo those the slow way, the tolerance is generous compared to the rounding error of the subtraction, division and addition
+        const double tolerance = 16.0 * std::numeric_limits<double>::epsilon(), absOffset = std::abs(offset), absMult = std::abs(mult);
+        for (int64_t i = 0; i < count; ++i)
+        {
+            const double shifted = ((double)in[i] - offset) / mult + 0.5;
+            if (std::abs(shifted - std::floor(shifted + 0.5)) <= tolerance * ((std::abs((double)in[i]) + absOffset) / absMult + std::abs(shifted)))
+            {
+                out[i] = clamp<TO, long double>(std::floor(0.5l + ((long double)in[i] - offset) / mult));
+            }
+        }
+    }
+    
+    template<typename FROM>
+    void NiftiIO::dequantizeToFloats(float* out, const FROM* in, const int64_t& count, const double& mult, const double& offset)
+    {
+        for (int64_t i = 0; i < count; ++i)
+        {
+            out[i] = (float)(offset + mult * (double)in[i]);
+        }
+    }
 }
 
 #endif //__NIFTI_IO_H__
@@ -28,11 +28,173 @@
 #include "MathFunctions.h"
 
 #include <algorithm>
+#include <cmath>
+#include <list>
 #include <vector>
 
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    ///running weighted sums for every element of a chunk of rows, updated one file at a time, so that mean, standard deviation and count take one pass
+    ///sums use Neumaier (improved Kahan) compensation so that many files don't lose precision
+    ///the sums for variance are of values shifted by the first value seen at each element, to avoid the cancellation of the naive sum of squares
+    class StreamingWeightedStats
+    {
+        bool m_doVariance;
+        vector<double> m_sum, m_sumComp, m_weight, m_weightComp;
+        vector<double> m_shift, m_shiftedSum, m_shiftedSumComp, m_shiftedSumSq, m_shiftedSumSqComp, m_weightSq;
+        vector<int64_t> m_count;
+        
+        static void compensatedAdd(double& sum, double& comp, const double& value)
+        {
+            double t = sum + value;
+            if (abs(sum) >= abs(value))
+            {
+                comp += (sum - t) + value;
+            } else {
+                comp += (value - t) + sum;
+            }
+            sum = t;
+        }
+    public:
+        StreamingWeightedStats(const int64_t& numElements, const bool& doVariance)
+        {
+            m_doVariance = doVariance;
+            m_sum.resize(numElements, 0.0);
+            m_sumComp = m_sum;
+            m_weight = m_sum;
+            m_weightComp = m_sum;
+            m_count.resize(numElements, 0);
+            if (m_doVariance)
+            {
+                m_shift = m_sum;
+                m_shiftedSum = m_sum;
+                m_shiftedSumComp = m_sum;
+                m_shiftedSumSq = m_sum;
+                m_shiftedSumSqComp = m_sum;
+                m_weightSq = m_sum;
+            }
+        }
+        
+        ///memory used per element, for chunk size computations
+        static int64_t getBytesPerElement(const bool& doVariance)
+        {
+            if (doVariance) return sizeof(double) * 10 + sizeof(int64_t);
+            return sizeof(double) * 4 + sizeof(int64_t);
+        }
+        
+        void add(const int64_t& element, const float& value, const float& weight)
+        {
+            compensatedAdd(m_sum[element], m_sumComp[element], double(weight) * value);
+            compensatedAdd(m_weight[element], m_weightComp[element], weight);
+            if (m_doVariance)
+            {
+                if (m_count[element] == 0)
+                {
+                    m_shift[element] = value;
+                }
+                double shifted = double(value) - m_shift[element];
+                compensatedAdd(m_shiftedSum[element], m_shiftedSumComp[element], weight * shifted);
+                compensatedAdd(m_shiftedSumSq[element], m_shiftedSumSqComp[element], weight * shifted * shifted);
+                m_weightSq[element] += double(weight) * weight;
+            }
+            ++m_count[element];
+        }
+        
+        float getMean(const int64_t& element) const
+        {
+            double weight = m_weight[element] + m_weightComp[element];
+            if (weight == 0.0) return 0.0f;
+            return float((m_sum[element] + m_sumComp[element]) / weight);
+        }
+        
+        float getStdev(const int64_t& element, const bool& sample) const
+        {
+            CaretAssert(m_doVariance);
+            double weight = m_weight[element] + m_weightComp[element];
+            if (weight == 0.0) return 0.0f;
+            double shiftedSum = m_shiftedSum[element] + m_shiftedSumComp[element];
+            double residSq = (m_shiftedSumSq[element] + m_shiftedSumSqComp[element]) - shiftedSum * shiftedSum / weight;
+            double denom = weight;
+            if (sample)
+            {
+                denom = weight - m_weightSq[element] / weight;//reliability weights, gives n - 1 when unweighted
+            }
+            if (!(denom > 0.0) || !(residSq > 0.0)) return 0.0f;
+            return float(sqrt(residSq / denom));
+        }
+        
+        int64_t getCount(const int64_t& element) const
+        {
+            return m_count[element];
+        }
+    };
+    
+    ///keeps at most a fixed number of the on-disk input files open, reopening closed ones when they are needed again, so that averaging
+    ///many files doesn't run out of file handles - when there are few enough files, nothing is ever closed
+    class InputFilePool
+    {
+        vector<CiftiFile*> m_files;
+        vector<AString> m_fileNames;//empty for files that are never closed
+        list<int64_t> m_openOrder;//least recently used first, only files that can be closed
+        vector<list<int64_t>::iterator> m_openPosition;
+        vector<bool> m_isOpen;
+        int64_t m_maxOpen;
+    public:
+        InputFilePool(const int64_t& maxOpen) : m_maxOpen(maxOpen) { }
+        
+        ///files must be added in order, reopenName should be empty for files that must stay open (in memory, or something else has a reference into them)
+        void addFile(CiftiFile* file, const AString& reopenName, const bool& isOpen)
+        {
+            int64_t index = (int64_t)m_files.size();
+            m_files.push_back(file);
+            m_fileNames.push_back(reopenName);
+            m_isOpen.push_back(isOpen);
+            m_openPosition.push_back(m_openOrder.end());
+            if (isOpen && !reopenName.isEmpty())
+            {
+                m_openPosition[index] = m_openOrder.insert(m_openOrder.end(), index);
+                if ((int64_t)m_openOrder.size() > m_maxOpen)
+                {
+                    closeLeastRecent();
+                }
+            }
+        }
+        
+        void closeLeastRecent()
+        {
+            CaretAssert(!m_openOrder.empty());
+            int64_t toClose = m_openOrder.front();
+            m_openOrder.pop_front();
+            m_openPosition[toClose] = m_openOrder.end();
+            m_files[toClose]->close();
+            m_isOpen[toClose] = false;
+        }
+        
+        ///not thread safe, get all files for a parallel section before starting it
+        CiftiFile* get(const int64_t& index)
+        {
+            CaretAssert(index >= 0 && index < (int64_t)m_files.size());
+            if (m_fileNames[index].isEmpty()) return m_files[index];
+            if (m_isOpen[index])
+            {
+                m_openOrder.splice(m_openOrder.end(), m_openOrder, m_openPosition[index]);
+            } else {
+                if ((int64_t)m_openOrder.size() >= m_maxOpen)
+                {
+                    closeLeastRecent();
+                }
+                m_files[index]->openFile(m_fileNames[index]);
+                m_isOpen[index] = true;
+                m_openPosition[index] = m_openOrder.insert(m_openOrder.end(), index);
+            }
+            return m_files[index];
+        }
+    };
+}
+
 AString OperationCiftiAverage::getCommandSwitch()
 {
     return "-cifti-average";
@@ -62,11 +224,21 @@ OperationParameters* OperationCiftiAverage::getParameters()
     OptionalParameter* memLimitOpt = ret->createOptionalParameter(4, "-mem-limit", "restrict memory used for file reading efficiency");
     memLimitOpt->addDoubleParameter(1, "limit-GB", "memory limit in gigabytes");
     
+    OptionalParameter* stdevOpt = ret->createOptionalParameter(5, "-stdev", "also output the standard deviation across files");
+    stdevOpt->addCiftiOutputParameter(1, "stdev-out", "output cifti file for the standard deviation");
+    stdevOpt->createOptionalParameter(2, "-sample", "use the sample standard deviation instead of the population standard deviation");
+    
+    OptionalParameter* countOpt = ret->createOptionalParameter(6, "-count", "also output the number of files used at each element");
+    countOpt->addCiftiOutputParameter(1, "count-out", "output cifti file for the count");
+    
     ret->setHelpText(
         AString("Averages cifti files together.  ") +
         "Files without -weight specified are given a weight of 1.  " +
         "If -exclude-outliers is specified, at each element, the data across all files is taken as a set, its unweighted mean and sample standard deviation are found, " +
-        "and values outside the specified number of standard deviations are excluded from the (potentially weighted) average at that element."
+        "and values outside the specified number of standard deviations are excluded from the (potentially weighted) average at that element.\n\n" +
+        "The -stdev and -count outputs are computed in the same pass as the average, using the same weights and exclusions.  " +
+        "With weights, the sample standard deviation treats the weights as reliability weights.  " +
+        "Non-numeric values are not used, and elements with no usable values are output as zero."
     );
     return ret;
 }
@@ -102,6 +274,24 @@ void OperationCiftiAverage::useParameters(OperationParameters* myParams, Progres
             throw OperationException("memory limit must be positive");
         }
     }
+    const bool doStdev = myParams->getOptionalParameter(5)->m_present;
+    const bool sampleStdev = doStdev && myParams->getOptionalParameter(5)->getOptionalParameter(2)->m_present;
+    const int64_t numFiles = int64_t(myInstances.size());
+    vector<float> fileWeights(numFiles, 1.0f);
+    for (int64_t i = 0; i < numFiles; ++i)
+    {
+        OptionalParameter* weightOpt = myInstances[i]->getOptionalParameter(1);
+        if (weightOpt->m_present)
+        {
+            fileWeights[i] = float(weightOpt->getDouble(1));
+        }
+    }
+    //files are read concurrently in groups, to keep several reads in flight
+    //our build/processing setup seems to bottleneck on lots of multithreaded memory allocation, so limit to 4 threads for now
+    int numReadThreads = 1;
+#ifdef CARET_OMP
+    numReadThreads = min(4, omp_get_max_threads());
+#endif
     const CiftiXML& firstXML = myInstances[0]->getCifti(1)->getCiftiXML();
     vector<int64_t> firstdims = firstXML.getDimensions();
     int64_t totalRows = 1;
@@ -118,10 +308,11 @@ void OperationCiftiAverage::useParameters(OperationParameters* myParams, Progres
         if (memLimitGB > 0.0f)
         {
             int64_t chunkMaxBytes = int64_t(memLimitGB * (1<<30));
-            int64_t computeBytes = sizeof(double) * 2;//accum and weight accum (because exclude non-numeric)
+            //running sums, plus the rows of each file being read at the same time
+            int64_t computeBytes = StreamingWeightedStats::getBytesPerElement(doStdev) + sizeof(float) * numReadThreads;
             if (exclude)
             {//exclude needs to load some rows from all files, but can then compute one output row at a time
-                computeBytes = sizeof(float) * myInstances.size();//exclusion needs to measure across *files*, so we need to cache some rows from all files before we can start computing any output
+                computeBytes = sizeof(float) * numFiles;//exclusion needs to measure across *files*, so we need to cache some rows from all files before we can start computing any output
             }//also, weights with exclusion needs to be tracked per element
             for (size_t i = 0; i < firstdims.size(); ++i)
             {
@@ -129,7 +320,7 @@ void OperationCiftiAverage::useParameters(OperationParameters* myParams, Progres
             }
             if (exclude)
             {//add the "one row at a time" output computation memory for completeness
-                computeBytes += sizeof(double) * 2 * firstdims[0];
+                computeBytes += StreamingWeightedStats::getBytesPerElement(doStdev) * firstdims[0] * numReadThreads;
             }
             int64_t numPasses = (computeBytes - 1) / chunkMaxBytes + 1;
             chunkRows = (totalRows - 1) / numPasses + 1;
@@ -141,13 +332,16 @@ void OperationCiftiAverage::useParameters(OperationParameters* myParams, Progres
         }
     }
     CaretAssert(chunkRows > 0);
+    //with many inputs, close files after checking them, and reopen them as needed, to avoid running out of file handles
+    const int64_t maxOpenFiles = 256;
+    const bool limitOpenFiles = (numFiles > maxOpenFiles);
+    vector<AString> reopenNames(numFiles);
     exception_ptr exPtr;
     int64_t exceptedFile = -1;
     //NOTE: throwing inside omp parallel causes an uninformative abort, so catch, skip the rest, and rethrow later
-    //our build/processing setup seems to bottleneck on lots of multithreaded memory allocation, so limit to 4 threads for now
     //windows compiler doesn't like unsigned omp loop variables
-#pragma omp CARET_PARFOR schedule(dynamic) num_threads(min(4, omp_get_max_threads()))
-    for (int64_t i = 1; i < int64_t(myInstances.size()); ++i)
+#pragma omp CARET_PARFOR schedule(dynamic) num_threads(numReadThreads)
+    for (int64_t i = 1; i < numFiles; ++i)
     {//don't delete the first one, we have a live reference to it
         if (exceptedFile > -1) continue;//"abort" checking any more files
         try
@@ -157,11 +351,17 @@ void OperationCiftiAverage::useParameters(OperationParameters* myParams, Progres
             {
                 throw OperationException("cifti file '" + thisCifti->getFileName() + "' does not match the first input");
             }
-            thisCifti->getCiftiXML().getFileMetaData()->clear();//don't need the metadata anymore, so free its memory too
-            //HACK: don't need the info in the XML anymore, so free the memory
-            for (size_t i = 0; i < thisCifti->getDimensions().size(); ++i)
-            {//since this is a hack, probably not a good idea to add a convenience function to do this loop
-                thisCifti->forgetMapping(i);
+            if (limitOpenFiles && !thisCifti->isInMemory())
+            {
+                reopenNames[i] = thisCifti->getFileName();
+                thisCifti->close();
+            } else {
+                thisCifti->getCiftiXML().getFileMetaData()->clear();//don't need the metadata anymore, so free its memory too
+                //HACK: don't need the info in the XML anymore, so free the memory
+                for (size_t i = 0; i < thisCifti->getDimensions().size(); ++i)
+                {//since this is a hack, probably not a good idea to add a convenience function to do this loop
+                    thisCifti->forgetMapping(i);
+                }
             }
         } catch (...) {
 #pragma omp critical
@@ -178,135 +378,166 @@ void OperationCiftiAverage::useParameters(OperationParameters* myParams, Progres
     {
         rethrow_exception(exPtr);
     }
-    CiftiFile* ciftiOut = myParams->getOutputCifti(1);//need to get it after all the inputs in order for provenance to work with lazy loading
+    if (limitOpenFiles && !myInstances[0]->getCifti(1)->isInMemory() && chunkRows < totalRows)
+    {
+        CaretLogInfo("more than " + AString::number(maxOpenFiles) + " input files, so some files are reopened for every chunk of rows, a larger -mem-limit makes fewer chunks");
+    }
+    InputFilePool filePool(maxOpenFiles);
+    for (int64_t i = 0; i < numFiles; ++i)
+    {
+        filePool.addFile(myInstances[i]->getCifti(1), reopenNames[i], reopenNames[i].isEmpty());
+    }
+    //need to get outputs after all the inputs in order for provenance to work with lazy loading
+    CiftiFile* ciftiOut = myParams->getOutputCifti(1);
     ciftiOut->setCiftiXML(firstXML);
-    if (!exclude)
+    CiftiFile* stdevOut = NULL;
+    if (doStdev)
+    {
+        stdevOut = myParams->getOptionalParameter(5)->getOutputCifti(1);
+        stdevOut->setCiftiXML(firstXML);
+    }
+    CiftiFile* countOut = NULL;
+    OptionalParameter* countOpt = myParams->getOptionalParameter(6);
+    if (countOpt->m_present)
+    {
+        countOut = countOpt->getOutputCifti(1);
+        countOut->setCiftiXML(firstXML);
+    }
+    const int64_t rowLength = firstdims[0];
+    MultiDimIterator<int64_t> iter = ciftiOut->getIteratorOverRows();
+    for (int64_t chunkStart = 0; chunkStart < totalRows; chunkStart += chunkRows)
     {
-        vector<float> scratchRow(firstdims[0], 0.0f);
-        MultiDimIterator<int64_t> iter = ciftiOut->getIteratorOverRows();
-        for (int64_t chunkStart = 0; chunkStart < totalRows; chunkStart += chunkRows)
+        vector<MultiDimIterator<int64_t> > rowIndices;
+        for (int64_t i = chunkStart; i < chunkStart + chunkRows && i < totalRows; ++i)
+        {
+            rowIndices.push_back(iter);
+            ++iter;
+        }
+        const int64_t numChunkRows = int64_t(rowIndices.size());
+        const int64_t chunkElements = numChunkRows * rowLength;
+        //without exclusion, only the group of files being read needs to be in memory, with exclusion, all files
+        const int64_t numBuffers = (exclude ? numFiles : numReadThreads);
+        vector<vector<float> > fileRows(numBuffers, vector<float>(chunkElements));
+        StreamingWeightedStats stats(exclude ? 0 : chunkElements, doStdev);
+        //when files must be reopened, alternate the direction on each chunk, so the files still open from the previous chunk are used first
+        const bool reverseFiles = limitOpenFiles && ((chunkStart / chunkRows) % 2 == 1);
+        const int64_t numGroups = (numFiles - 1) / numReadThreads + 1;
+        for (int64_t groupIndex = 0; groupIndex < numGroups; ++groupIndex)
         {
-            vector<MultiDimIterator<int64_t> > rowIndices;
-            for (int64_t i = chunkStart; i < chunkStart + chunkRows && i < totalRows; ++i)
+            const int64_t groupStart = (reverseFiles ? numGroups - 1 - groupIndex : groupIndex) * numReadThreads;
+            const int64_t groupEnd = min(groupStart + numReadThreads, numFiles);
+            const int64_t groupSize = groupEnd - groupStart;
+            vector<CiftiFile*> groupFiles(groupSize);
+            for (int64_t n = 0; n < groupSize; ++n)
             {
-                rowIndices.push_back(iter);
-                ++iter;
+                const int64_t i = (reverseFiles ? groupEnd - 1 - n : groupStart + n);
+                groupFiles[i - groupStart] = filePool.get(i);//opening files isn't thread safe
             }
-            vector<vector<double> > accum(rowIndices.size(), vector<double>(firstdims[0], 0.0));
-            vector<vector<double> > weightAccum = accum;
-            for (size_t i = 0; i < myInstances.size(); ++i)
+            //read the chunk from each file in the group in parallel, different files don't share anything
+#pragma omp CARET_PARFOR schedule(dynamic) num_threads(numReadThreads)
+            for (int64_t i = groupStart; i < groupEnd; ++i)
             {
-                CiftiFile* thisCifti = myInstances[i]->getCifti(1);
-                float thisWeight = 1.0f;
-                OptionalParameter* weightOpt = myInstances[i]->getOptionalParameter(1);
-                if (weightOpt->m_present)
+                if (exceptedFile > -1) continue;
+                try
                 {
-                    thisWeight = float(weightOpt->getDouble(1));
-                }
-                for (size_t j = 0; j < rowIndices.size(); ++j)
-                {
-                    thisCifti->getRow(scratchRow.data(), *(rowIndices[j]));
-                    for (int64_t k = 0; k < firstdims[0]; ++k)
+                    float* buffer = fileRows[exclude ? i : i - groupStart].data();
+                    for (int64_t j = 0; j < numChunkRows; ++j)
+                    {
+                        groupFiles[i - groupStart]->getRow(buffer + j * rowLength, *(rowIndices[j]));
+                    }
+                } catch (...) {
+#pragma omp critical
                     {
-                        if (MathFunctions::isNumeric(scratchRow[k]))
+                        if (exceptedFile < 0 || i < exceptedFile)
                         {
-                            accum[j][k] += thisWeight * scratchRow[k];
-                            weightAccum[j][k] += thisWeight;
+                            exceptedFile = i;
+                            exPtr = current_exception();
                         }
                     }
                 }
             }
-            for (size_t j = 0; j < rowIndices.size(); ++j)
+            if (exceptedFile > -1)
             {
-                for (int64_t k = 0; k < firstdims[0]; ++k)
+                rethrow_exception(exPtr);
+            }
+            if (!exclude)
+            {//accumulate in the order files are visited, so the result doesn't depend on the number of threads
+#pragma omp CARET_PARFOR schedule(static)
+                for (int64_t k = 0; k < chunkElements; ++k)
                 {
-                    if (weightAccum[j][k] != 0.0)
+                    for (int64_t n = 0; n < groupSize; ++n)
                     {
-                        scratchRow[k] = float(accum[j][k] / weightAccum[j][k]);
-                    } else {
-                        scratchRow[k] = 0.0f;
+                        const int64_t i = (reverseFiles ? groupEnd - 1 - n : groupStart + n);
+                        float thisVal = fileRows[i - groupStart][k];
+                        if (MathFunctions::isNumeric(thisVal))
+                        {
+                            stats.add(k, thisVal, fileWeights[i]);
+                        }
                     }
                 }
-                ciftiOut->setRow(scratchRow.data(), *(rowIndices[j]));
             }
         }
-    } else {
-        MultiDimIterator<int64_t> iter = ciftiOut->getIteratorOverRows();
-        for (int64_t chunkStart = 0; chunkStart < totalRows; chunkStart += chunkRows)
+        vector<float> outRows(chunkElements), stdevRows, countRows;
+        if (stdevOut != NULL) stdevRows.resize(chunkElements);
+        if (countOut != NULL) countRows.resize(chunkElements);
+        if (!exclude)
         {
-            vector<MultiDimIterator<int64_t> > rowIndices;
-            for (int64_t i = chunkStart; i < chunkStart + chunkRows && i < totalRows; ++i)
+            for (int64_t k = 0; k < chunkElements; ++k)
             {
-                rowIndices.push_back(iter);
-                ++iter;
+                outRows[k] = stats.getMean(k);
+                if (stdevOut != NULL) stdevRows[k] = stats.getStdev(k, sampleStdev);
+                if (countOut != NULL) countRows[k] = stats.getCount(k);
             }
-            //chunk x files x rowlength
-            vector<vector<vector<float> > > scratchRows(rowIndices.size(), vector<vector<float> >(myInstances.size(), vector<float>(firstdims[0])));
-            //parallel probably won't help here, and will hurt on spinning disks
-            for (size_t i = 0; i < myInstances.size(); ++i)
+        } else {
+#pragma omp CARET_PARFOR schedule(dynamic)
+            for (int64_t j = 0; j < numChunkRows; ++j)
             {
-                CiftiFile* thisCifti = myInstances[i]->getCifti(1);
-                for (size_t j = 0; j < rowIndices.size(); ++j)
-                {
-                    thisCifti->getRow(scratchRows[j][i].data(), *(rowIndices[j]));
-                }
-            }
-            for (size_t j = 0; j < rowIndices.size(); ++j)
-            {
-                vector<double> accum(firstdims[0], 0.0), weightAccum(firstdims[0], 0.0);
-                for (int64_t k = 0; k < firstdims[0]; ++k)
+                StreamingWeightedStats rowStats(rowLength, doStdev);
+                for (int64_t k = 0; k < rowLength; ++k)
                 {
+                    const int64_t element = j * rowLength + k;
                     double thisAccum = 0.0;
                     int64_t numeric = 0;
-                    for (size_t i = 0; i < myInstances.size(); ++i)
+                    for (int64_t i = 0; i < numFiles; ++i)
                     {
-                        if (MathFunctions::isNumeric(scratchRows[j][i][k]))
+                        if (MathFunctions::isNumeric(fileRows[i][element]))
                         {
-                            thisAccum += scratchRows[j][i][k];
+                            thisAccum += fileRows[i][element];
                             ++numeric;
                         }
                     }
                     float thisMean = float(thisAccum / numeric);
                     thisAccum = 0.0;
-                    for (size_t i = 0; i < myInstances.size(); ++i)
+                    for (int64_t i = 0; i < numFiles; ++i)
                     {
-                        if (MathFunctions::isNumeric(scratchRows[j][i][k]))
+                        if (MathFunctions::isNumeric(fileRows[i][element]))
                         {
-                            float tempf = scratchRows[j][i][k] - thisMean;
+                            float tempf = fileRows[i][element] - thisMean;
                             thisAccum += tempf * tempf;
                         }
                     }
                     float thisStdev = float(sqrt(thisAccum / (numeric - 1)));
                     float cutoffLow = thisMean - sigmaBelow * thisStdev;
                     float cutoffHigh = thisMean + sigmaAbove * thisStdev;
-                    for (size_t i = 0; i < myInstances.size(); ++i)
+                    for (int64_t i = 0; i < numFiles; ++i)
                     {
-                        float thisVal = scratchRows[j][i][k];
-                        float thisWeight = 1.0f;
-                        OptionalParameter* weightOpt = myInstances[i]->getOptionalParameter(1);
-                        if (weightOpt->m_present)
-                        {
-                            thisWeight = float(weightOpt->getDouble(1));
-                        }
+                        float thisVal = fileRows[i][element];
                         if (MathFunctions::isNumeric(thisVal) && (numeric <= 1 || (thisVal > cutoffLow && thisVal < cutoffHigh)))//don't allow too-few numeric to make the exclusion go NaN
                         {
-                            accum[k] += thisWeight * thisVal;
-                            weightAccum[k] += thisWeight;
+                            rowStats.add(k, thisVal, fileWeights[i]);
                         }
                     }
+                    outRows[element] = rowStats.getMean(k);
+                    if (stdevOut != NULL) stdevRows[element] = rowStats.getStdev(k, sampleStdev);
+                    if (countOut != NULL) countRows[element] = rowStats.getCount(k);
                 }
-                vector<float> outRow(firstdims[0]);
-                for (int64_t k = 0; k < firstdims[0]; ++k)
-                {
-                    if (weightAccum[k] != 0.0)
-                    {
-                        outRow[k] = accum[k] / weightAccum[k];
-                    } else {
-                        outRow[k] = 0.0f;
-                    }
-                }
-                ciftiOut->setRow(outRow.data(), *(rowIndices[j]));
             }
         }
+        for (int64_t j = 0; j < numChunkRows; ++j)
+        {
+            ciftiOut->setRow(outRows.data() + j * rowLength, *(rowIndices[j]));
+            if (stdevOut != NULL) stdevOut->setRow(stdevRows.data() + j * rowLength, *(rowIndices[j]));
+            if (countOut != NULL) countOut->setRow(countRows.data() + j * rowLength, *(rowIndices[j]));
+        }
     }
 }
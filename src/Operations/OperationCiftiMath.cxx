@@ -28,6 +28,7 @@
 #include "CiftiXML.h"
 #include "MultiDimIterator.h"
 
+#include <algorithm>
 #include <iostream>
 
 using namespace caret;
@@ -240,13 +241,21 @@ void OperationCiftiMath::useParameters(OperationParameters* myParams, ProgressOb
     }
     if (outXML.getNumberOfDimensions() < 1) throw OperationException("output must have at least 1 dimension");
     myCiftiOut->setCiftiXML(outXML);
-    vector<float> values(numVars), scratchRow(outDims[0]);
-    vector<vector<float> > inputRows(numVars);
+    vector<float> scratchRow(outDims[0]);
+    vector<vector<float> > inputRows(numVars), selectedRows(numVars);//selectedRows is for select along row, the selected value repeated to the output row length
+    vector<const float*> rowPointers(numVars);
     vector<vector<int64_t> > loadedRow(numVars);//to detect and prevent rereading the same row
     for (int v = 0; v < numVars; ++v)
     {
         inputRows[v].resize(varCiftiFiles[v]->getCiftiXML().getDimensionLength(CiftiXML::ALONG_ROW));
         loadedRow[v].resize(varCiftiFiles[v]->getCiftiXML().getNumberOfDimensions() - 1, -1);//we always load a full row, so ignore first dim
+        if (selectInfo[v][0] == -1)
+        {
+            rowPointers[v] = inputRows[v].data();
+        } else {
+            selectedRows[v].resize(outDims[0]);
+            rowPointers[v] = selectedRows[v].data();
+        }
     }
     for (MultiDimIterator<int64_t> iter(vector<int64_t>(outDims.begin() + 1, outDims.end())); !iter.atEnd(); ++iter)
     {
@@ -272,24 +281,22 @@ void OperationCiftiMath::useParameters(OperationParameters* myParams, ProgressOb
             if (needToLoad)
             {
                 varCiftiFiles[v]->getRow(inputRows[v].data(), loadedRow[v]);
+                if (selectInfo[v][0] != -1)//now we check for select along row
+                {
+                    fill(selectedRows[v].begin(), selectedRows[v].end(), inputRows[v][selectInfo[v][0]]);
+                }
             }
         }
-        for (int j = 0; j < outDims[0]; ++j)
+        myExpr.evaluate(rowPointers, outDims[0], scratchRow.data());
+        if (nanfix)
         {
-            for (int v = 0; v < numVars; ++v)//now we check for select along row
+            for (int j = 0; j < outDims[0]; ++j)
             {
-                if (selectInfo[v][0] == -1)
+                if (scratchRow[j] != scratchRow[j])
                 {
-                    values[v] = inputRows[v][j];
-                } else {
-                    values[v] = inputRows[v][selectInfo[v][0]];
+                    scratchRow[j] = nanfixval;
                 }
             }
-            scratchRow[j] = (float)myExpr.evaluate(values);
-            if (nanfix && scratchRow[j] != scratchRow[j])
-            {
-                scratchRow[j] = nanfixval;
-            }
         }
         myCiftiOut->setRow(scratchRow.data(), *iter);
     }
@@ -24,6 +24,7 @@
 #include "CaretAssert.h"
 #include "CaretPointer.h"
 #include "CaretCommandGlobalOptions.h"
+#include "CaretOMP.h"
 #include "CiftiFile.h"
 
 #include <algorithm>
@@ -402,7 +403,6 @@ void OperationCiftiMerge::useParameters(OperationParameters* myParams, ProgressO
     ciftiOut->setCiftiXML(outXML);
     if (direction == CiftiXML::ALONG_ROW)
     {
-        int64_t curRowIndex = 0;
         int64_t chunkRows = -1;//invalid value
         //checking first cifti for "in memory" should catch both -cifti-read-memory and possible future GUI-based operation
         int64_t numRows = 1;
@@ -429,64 +429,106 @@ void OperationCiftiMerge::useParameters(OperationParameters* myParams, ProgressO
         }
         CaretAssert(chunkRows > 0);
         vector<vector<float> > outRows(chunkRows, vector<float>(numOutIndices));
-        vector<float> scratchRow(scratchRowLength);
+        vector<int64_t> fileOutStart(numInputs + 1, 0);//where the columns from each file start in an output row, so files can be read independently
+        for (int i = 0; i < numInputs; ++i)
+        {
+            const CiftiXML& thisXML = myInputs[i]->getCifti(1)->getCiftiXML();
+            const vector<ParameterComponent*>& columnOpts = myInputs[i]->getRepeatableParameterInstances(2);
+            int64_t thisWidth = 0;
+            if (columnOpts.size() > 0)
+            {
+                for (int j = 0; j < (int)columnOpts.size(); ++j)
+                {
+                    OptionalParameter* upToOpt = columnOpts[j]->getOptionalParameter(2);
+                    if (upToOpt->m_present)
+                    {
+                        thisWidth += thisXML.getMap(CiftiXML::ALONG_ROW)->getIndexFromNumberOrName(upToOpt->getString(1)) -
+                                     thisXML.getMap(CiftiXML::ALONG_ROW)->getIndexFromNumberOrName(columnOpts[j]->getString(1)) + 1;
+                    } else {
+                        thisWidth += 1;
+                    }
+                }
+            } else {
+                thisWidth = thisXML.getDimensionLength(CiftiXML::ALONG_ROW);
+            }
+            fileOutStart[i + 1] = fileOutStart[i] + thisWidth;
+        }
+        CaretAssert(fileOutStart[numInputs] == numOutIndices);
         auto outputIterator = ciftiOut->getIteratorOverRows(); //starts at beginning
         for (int64_t chunkStart = 0; chunkStart < numRows; chunkStart += chunkRows)
         {
             int64_t chunkEnd = min(chunkStart + chunkRows, numRows);
-            int64_t chunkRowIndex = 0; //track position within the row, to update while looping through input files
+            //each file fills its own columns of the chunk, so several files can be read at once rather than serializing on merge order
+#pragma omp CARET_PARFOR schedule(dynamic) num_threads(min(4, omp_get_max_threads()))
             for (int i = 0; i < numInputs; ++i)
             {
-                auto inputIterator = outputIterator; //start wherever we don't yet have output for
-                const CiftiFile* ciftiIn = myInputs[i]->getCifti(1);
-                const CiftiXML& thisXML = ciftiIn->getCiftiXML();
-                const vector<ParameterComponent*>& columnOpts = myInputs[i]->getRepeatableParameterInstances(2);
-                int numColumnOpts = (int)columnOpts.size();
-                for (int64_t chunkIndex = 0; chunkIndex < chunkEnd - chunkStart; ++chunkIndex)
+                if (exceptedFile > -1) continue;
+                try
                 {
-                    curRowIndex = chunkRowIndex;
-                    if (numColumnOpts > 0)
+                    vector<float> scratchRow(scratchRowLength);
+                    auto inputIterator = outputIterator; //start wherever we don't yet have output for
+                    const CiftiFile* ciftiIn = myInputs[i]->getCifti(1);
+                    const CiftiXML& thisXML = ciftiIn->getCiftiXML();
+                    const vector<ParameterComponent*>& columnOpts = myInputs[i]->getRepeatableParameterInstances(2);
+                    int numColumnOpts = (int)columnOpts.size();
+                    for (int64_t chunkIndex = 0; chunkIndex < chunkEnd - chunkStart; ++chunkIndex)
                     {
-                        auto inputSelect = *inputIterator;
-                        inputSelect.erase(inputSelect.begin() + (thisXML.getNumberOfDimensions() - 1), inputSelect.end()); //deal with files that are missing a dimension
-                        ciftiIn->getRow(scratchRow.data(), inputSelect); //get a row and...
-                        ++inputIterator; //advance
-                        for (int j = 0; j < numColumnOpts; ++j)
+                        int64_t curRowIndex = fileOutStart[i];
+                        if (numColumnOpts > 0)
                         {
-                            int64_t initialRowIndex = thisXML.getMap(CiftiXML::ALONG_ROW)->getIndexFromNumberOrName(columnOpts[j]->getString(1));//this function has the 1-indexing convention built in
-                            OptionalParameter* upToOpt = columnOpts[j]->getOptionalParameter(2);//we already checked that these strings give a valid index
-                            if (upToOpt->m_present)
+                            auto inputSelect = *inputIterator;
+                            inputSelect.erase(inputSelect.begin() + (thisXML.getNumberOfDimensions() - 1), inputSelect.end()); //deal with files that are missing a dimension
+                            ciftiIn->getRow(scratchRow.data(), inputSelect); //get a row and...
+                            ++inputIterator; //advance
+                            for (int j = 0; j < numColumnOpts; ++j)
                             {
-                                int64_t finalRowIndex = thisXML.getMap(CiftiXML::ALONG_ROW)->getIndexFromNumberOrName(upToOpt->getString(1));//ditto
-                                bool reverse = upToOpt->getOptionalParameter(2)->m_present;
-                                if (reverse)
+                                int64_t initialRowIndex = thisXML.getMap(CiftiXML::ALONG_ROW)->getIndexFromNumberOrName(columnOpts[j]->getString(1));//this function has the 1-indexing convention built in
+                                OptionalParameter* upToOpt = columnOpts[j]->getOptionalParameter(2);//we already checked that these strings give a valid index
+                                if (upToOpt->m_present)
                                 {
-                                    for (int64_t c = finalRowIndex; c >= initialRowIndex; --c)
+                                    int64_t finalRowIndex = thisXML.getMap(CiftiXML::ALONG_ROW)->getIndexFromNumberOrName(upToOpt->getString(1));//ditto
+                                    bool reverse = upToOpt->getOptionalParameter(2)->m_present;
+                                    if (reverse)
                                     {
-                                        outRows[chunkIndex][curRowIndex] = scratchRow[c];
-                                        ++curRowIndex;
+                                        for (int64_t c = finalRowIndex; c >= initialRowIndex; --c)
+                                        {
+                                            outRows[chunkIndex][curRowIndex] = scratchRow[c];
+                                            ++curRowIndex;
+                                        }
+                                    } else {
+                                        for (int64_t c = initialRowIndex; c <= finalRowIndex; ++c)
+                                        {
+                                            outRows[chunkIndex][curRowIndex] = scratchRow[c];
+                                            ++curRowIndex;
+                                        }
                                     }
                                 } else {
-                                    for (int64_t c = initialRowIndex; c <= finalRowIndex; ++c)
-                                    {
-                                        outRows[chunkIndex][curRowIndex] = scratchRow[c];
-                                        ++curRowIndex;
-                                    }
+                                    outRows[chunkIndex][curRowIndex] = scratchRow[initialRowIndex];
+                                    ++curRowIndex;
                                 }
-                            } else {
-                                outRows[chunkIndex][curRowIndex] = scratchRow[initialRowIndex];
-                                ++curRowIndex;
                             }
+                        } else {
+                            ciftiIn->getRow(outRows[chunkIndex].data() + curRowIndex, *inputIterator); //get a row and...
+                            ++inputIterator; //advance
+                            curRowIndex += thisXML.getDimensionLength(CiftiXML::ALONG_ROW);
+                        }
+                        CaretAssert(curRowIndex == fileOutStart[i + 1]);
+                    }
+                } catch (...) {
+#pragma omp critical
+                    {
+                        if (exceptedFile < 0 || i < exceptedFile)
+                        {
+                            exceptedFile = i;
+                            exPtr = current_exception();
                         }
-                    } else {
-                        ciftiIn->getRow(outRows[chunkIndex].data() + curRowIndex, *inputIterator); //get a row and...
-                        ++inputIterator; //advance
-                        curRowIndex += thisXML.getDimensionLength(CiftiXML::ALONG_ROW);
                     }
                 }
-                chunkRowIndex = curRowIndex;//done with chunk for this file, update position within row for next file
             }
-            CaretAssert(curRowIndex == numOutIndices);
+            if (exceptedFile > -1)
+            {
+                rethrow_exception(exPtr);
+            }
             for (int64_t row = chunkStart; row < chunkEnd; ++row)
             {
                 int64_t chunkIndex = row - chunkStart;
@@ -119,13 +119,7 @@ namespace
             }
         }
         if (toUse.empty()) throw OperationException("roi is empty");
-        sort(toUse.begin(), toUse.end());
-        const float index = percent / 100.0f * (toUse.size() - 1);
-        if (index <= 0) return toUse[0];
-        if (index >= toUse.size() - 1) return toUse.back();
-        float ipart, fpart;
-        fpart = modf(index, &ipart);
-        return (1.0f - fpart) * toUse[(int)ipart] + fpart * toUse[((int)ipart) + 1];
+        return ReductionOperation::percentile(toUse.data(), toUse.size(), percent);
     }
 }
 
@@ -19,6 +19,7 @@
  */
 /*LICENSE_END*/
 
+#include <algorithm>
 #include <cstdio>
 #include <fstream>
 
@@ -33,6 +34,8 @@
 #include <QDir>
 #include <QImage>
 #include <QColor>
+#include <QRegularExpression>
+#include <QtConcurrent/QtConcurrent>
 
 
 #include "Brain.h"
@@ -143,6 +146,10 @@ OperationShowScene::getParameters()
     connDbOpt->addStringParameter(1, "Username", "Connectome DB Username");
     connDbOpt->addStringParameter(2, "Password", "Connectome DB Password");
     
+    ParameterComponent* batchSceneOpt = ret->createRepeatableParameter(10, "-batch-scene", "Render an additional scene (or scenes)");
+    batchSceneOpt->addStringParameter(1, "scene-name-number-or-pattern", "name, number (starting at one), range of numbers (3-7), or name pattern "
+                                      "with wildcards ('*' and '?') of the scene(s)");
+    
     AString helpText("DEPRECATED: this command may be removed in a future release, use -scene-capture-image.\n\n"
                      "Render content of browser windows displayed in a scene "
                      "into image file(s).  The image file name should be "
@@ -152,6 +159,13 @@ OperationShowScene::getParameters()
                      "into the image name: \"capture_01.png\", \"capture_02.png\" "
                      "etc.\n"
                      "\n"
+                     "Use the \"-batch-scene\" option to render more than one scene\n"
+                     "from the scene file.  The scenes are rendered in the order\n"
+                     "given and data files that are used by consecutive scenes are\n"
+                     "read once.  When more than one scene is rendered, the number\n"
+                     "of the scene is inserted into the image name:\n"
+                     "\"capture_scene03.png\" or \"capture_scene03_01.png\".\n"
+                     "\n"
                      "If the scene references files in the Connectome Database,\n"
                      "the \"-conn-db-login\" option is available for providing the \n"
                      "username and password.  If this options is not specified, \n"
@@ -288,34 +302,146 @@ OperationShowScene::useParameters(OperationParameters* myParams,
                                                      password);
 
     /*
-     * Read the scene file and load the scene
+     * Read the scene file and find the scenes that are rendered
      */
     SceneFile sceneFile;
     sceneFile.readFile(sceneFileName);
-    Scene* scene = sceneFile.getSceneWithName(sceneNameOrNumber);
-    if (scene == NULL) {
-        bool valid = false;
-        const int32_t sceneIndexStartAtOne = sceneNameOrNumber.toInt(&valid);
-        if (valid) {
-            const int32_t sceneIndex = sceneIndexStartAtOne - 1;
-            if ((sceneIndex >= 0)
-                && (sceneIndex < sceneFile.getNumberOfScenes())) {
-                scene = sceneFile.getSceneAtIndex(sceneIndex);
-            }
-            else {
-                throw OperationException("Scene index is invalid");
-            }
-        }
-        else {
-            throw OperationException("Scene name is invalid");
-        }
+    
+    std::vector<AString> sceneNamesNumbersOrPatterns;
+    sceneNamesNumbersOrPatterns.push_back(sceneNameOrNumber);
+    const std::vector<ParameterComponent*>& batchSceneInstances = myParams->getRepeatableParameterInstances(10);
+    for (const auto batchScene : batchSceneInstances) {
+        sceneNamesNumbersOrPatterns.push_back(batchScene->getString(1));
     }
+    const std::vector<std::pair<int32_t, Scene*>> scenesToRender = getScenesForRendering(&sceneFile,
+                                                                                         sceneNamesNumbersOrPatterns);
+    CaretAssert( ! scenesToRender.empty());
+    const int32_t numberOfScenes = static_cast<int32_t>(scenesToRender.size());
     
     /*
      * Enable voxel coloring since it is defaulted off for commands
      */
     VolumeFile::setVoxelColoringEnabled(true);
     
+    /*
+     * One Mesa Context is used for all scenes and windows.  Textures and
+     * buffers created for data files remain valid when a later scene
+     * uses the same data files.
+     */
+    const int depthBits = 16;
+    const int stencilBits = 0;
+    const int accumBits = 0;
+    OSMesaContext mesaContext = OSMesaCreateContextExt(OSMESA_RGBA,
+                                                       depthBits,
+                                                       stencilBits,
+                                                       accumBits,
+                                                       NULL);
+    if (mesaContext == 0) {
+        throw OperationException("Creating Mesa Context failed.");
+    }
+    
+    /*
+     * Images are written by other threads while the next window or scene
+     * is rendered.
+     */
+    std::vector<ImageWriteResult> imageWriteResults;
+    
+    try {
+        for (int32_t iScene = 0; iScene < numberOfScenes; iScene++) {
+            CaretAssertVectorIndex(scenesToRender, iScene);
+            const int32_t sceneIndex = scenesToRender[iScene].first;
+            Scene* scene = scenesToRender[iScene].second;
+            
+            /*
+             * When more than one scene is rendered, the number of the
+             * scene is inserted into the image name: "capture_scene03.png".
+             */
+            AString sceneImageFileName(imageFileName);
+            if (numberOfScenes > 1) {
+                sceneImageFileName = insertIntoImageFileName(imageFileName,
+                                                             QString("_scene%1").arg((int)(sceneIndex + 1),
+                                                                                     2, // width
+                                                                                     10, // base
+                                                                                     QChar('0'))); // fill character
+                CaretLogInfo("Rendering scene "
+                             + AString::number(sceneIndex + 1)
+                             + " \""
+                             + scene->getName()
+                             + "\"");
+            }
+            
+            renderScene(scene,
+                        sceneImageFileName,
+                        userImageWidth,
+                        userImageHeight,
+                        useWindowSizeForImageSizeFlag,
+                        useWindowSizeParam->m_optionSwitch,
+                        doNotUseSceneColorsFlag,
+                        mapYokingGroup,
+                        mapYokingMapIndex,
+                        mesaContext,
+                        imageWriteResults);
+            
+            myProgress.reportProgress(static_cast<float>(iScene + 1)
+                                      / static_cast<float>(numberOfScenes));
+        }
+    }
+    catch (...) {
+        waitForImagesToFinishWriting(imageWriteResults);
+        OSMesaDestroyContext(mesaContext);
+        throw;
+    }
+    
+    OSMesaDestroyContext(mesaContext);
+    
+    const AString imageWriteErrorMessage = waitForImagesToFinishWriting(imageWriteResults);
+    if ( ! imageWriteErrorMessage.isEmpty()) {
+        throw OperationException(imageWriteErrorMessage);
+    }
+}
+
+/**
+ * Render the browser windows in a scene into image files.
+ *
+ * @param scene
+ *     Scene that is restored and rendered.
+ * @param imageFileName
+ *     Name of image file (window number is inserted if more than one window).
+ * @param userImageWidth
+ *     Width of image from the command line.
+ * @param userImageHeight
+ *     Height of image from the command line.
+ * @param useWindowSizeForImageSizeFlag
+ *     If true, use the window size from the scene for the image size.
+ * @param useWindowSizeSwitch
+ *     Command line switch for using the window size (for messages).
+ * @param doNotUseSceneColorsFlag
+ *     If true, do not use foreground and background colors from the scene.
+ * @param mapYokingGroup
+ *     Map yoking group that overrides selected map index.
+ * @param mapYokingMapIndex
+ *     Map index for the map yoking group.
+ * @param mesaContextPointer
+ *     The Mesa Context used for rendering.
+ * @param imageWriteResultsOut
+ *     Results of the images that are being written asynchronously.
+ */
+void
+OperationShowScene::renderScene(Scene* scene,
+                                const AString& imageFileName,
+                                const int32_t userImageWidth,
+                                const int32_t userImageHeight,
+                                const bool useWindowSizeForImageSizeFlag,
+                                const AString& useWindowSizeSwitch,
+                                const bool doNotUseSceneColorsFlag,
+                                const MapYokingGroupEnum::Enum mapYokingGroup,
+                                const int32_t mapYokingMapIndex,
+                                void* mesaContextPointer,
+                                std::vector<ImageWriteResult>& imageWriteResultsOut)
+{
+    CaretAssert(scene);
+    OSMesaContext mesaContext = static_cast<OSMesaContext>(mesaContextPointer);
+    
     SceneAttributes sceneAttributes(SceneTypeEnum::SCENE_TYPE_FULL,
                                     scene);
     
@@ -411,7 +537,7 @@ OperationShowScene::useParameters(OperationParameters* myParams,
                 if ((imageWidth <= 0)
                     || (imageHeight <= 0)) {
                     const QString msg("Option "
-                                      + useWindowSizeParam->m_optionSwitch
+                                      + useWindowSizeSwitch
                                       + " is used but window size not found in scene and width="
                                       + QString::number(imageWidth)
                                       + " height="
@@ -423,7 +549,7 @@ OperationShowScene::useParameters(OperationParameters* myParams,
                 
                 if ( ! missingWindowMessageHasBeenDisplayed) {
                     const QString msg("Option \""
-                                      + useWindowSizeParam->m_optionSwitch
+                                      + useWindowSizeSwitch
                                       + "\" is used but window size not found in scene.\n"
                                       "   Scene was created prior to implementation of this option.\n"
                                       "   Image size will be width="
@@ -457,21 +583,6 @@ OperationShowScene::useParameters(OperationParameters* myParams,
         const int windowWidth  = windowViewport[2];
         const int windowHeight = windowViewport[3];
         
-        //
-        // Create the Mesa Context
-        //
-        const int depthBits = 16;
-        const int stencilBits = 0;
-        const int accumBits = 0;
-        OSMesaContext mesaContext = OSMesaCreateContextExt(OSMESA_RGBA,
-                                                           depthBits,
-                                                           stencilBits,
-                                                           accumBits,
-                                                           NULL);
-        if (mesaContext == 0) {
-            throw ("Creating Mesa Context failed.");
-        }
-        
         //
         // Allocate image buffer
         //
@@ -601,7 +712,8 @@ OperationShowScene::useParameters(OperationParameters* myParams,
                                outputImageIndex,
                                imageBuffer,
                                imageWidth,
-                               imageHeight);
+                               imageHeight,
+                               imageWriteResultsOut);
                     
                     for (std::vector<BrainOpenGLViewportContent*>::iterator vpIter = viewports.begin();
                          vpIter != viewports.end();
@@ -662,21 +774,21 @@ OperationShowScene::useParameters(OperationParameters* myParams,
                        outputImageIndex,
                        imageBuffer,
                        imageWidth,
-                       imageHeight);
+                       imageHeight,
+                       imageWriteResultsOut);
         }
         
         /*
-         * Free image memory and Mesa context
+         * Free image memory, images were copied when writing started
          */
         delete[] imageBuffer;
-        OSMesaDestroyContext(mesaContext);
     }
     
     /*
      * Print error messages
      */
     if ( ! sceneErrorMessage.isEmpty()) {
-        std::cerr << "ERRORS loading scene, output image may be incorrect." << std::endl;
+        std::cerr << "ERRORS loading scene \"" << scene->getName() << "\", output image may be incorrect." << std::endl;
         std::cerr << sceneErrorMessage << std::endl;
     }
 }
@@ -866,7 +978,146 @@ OperationShowScene::createBrainOpenGL()
 #endif // HAVE_OSMESA
 
 /**
- * Write the image data to a Image File.
+ * Insert text into the name of an image file immediately before
+ * the file's extension.  If there is no extension, the text and
+ * a PNG extension are appended.
+ *
+ * @param imageFileName
+ *     Name of image file.
+ * @param text
+ *     Text inserted into the name.
+ * @return
+ *     Image file name containing the text.
+ */
+AString
+OperationShowScene::insertIntoImageFileName(const AString& imageFileName,
+                                            const AString& text)
+{
+    AString outputName(imageFileName);
+    const int dotOffset = outputName.lastIndexOf(".");
+    if (dotOffset >= 0) {
+        outputName.insert(dotOffset,
+                          text);
+    }
+    else {
+        outputName += (text
+                       + ".png");
+    }
+    return outputName;
+}
+
+/**
+ * Find the scenes for rendering.  Each entry is the name of a scene,
+ * the number of a scene (starting at one), a range of scene numbers
+ * ("3-7"), or a name pattern containing wildcards ('*' and '?').
+ * A scene is rendered once even if it is matched by more than one entry.
+ *
+ * @param sceneFile
+ *     The scene file.
+ * @param sceneNamesNumbersOrPatterns
+ *     Names, numbers, ranges, or patterns identifying scenes.
+ * @return
+ *     Index and pointer of scenes in the order they should be rendered.
+ * @throw OperationException
+ *     If an entry does not match any scenes.
+ */
+std::vector<std::pair<int32_t, Scene*>>
+OperationShowScene::getScenesForRendering(SceneFile* sceneFile,
+                                          const std::vector<AString>& sceneNamesNumbersOrPatterns)
+{
+    CaretAssert(sceneFile);
+    
+    const int32_t numberOfScenes = sceneFile->getNumberOfScenes();
+    std::vector<int32_t> sceneIndices;
+    
+    for (const auto& nameNumberOrPattern : sceneNamesNumbersOrPatterns) {
+        std::vector<int32_t> matchingIndices;
+        
+        /*
+         * An exact scene name has priority over numbers and patterns
+         */
+        for (int32_t i = 0; i < numberOfScenes; i++) {
+            if (sceneFile->getSceneAtIndex(i)->getName() == nameNumberOrPattern) {
+                matchingIndices.push_back(i);
+                break;
+            }
+        }
+        
+        if (matchingIndices.empty()) {
+            bool validFirstFlag(false);
+            bool validLastFlag(false);
+            int32_t firstNumber(-1);
+            int32_t lastNumber(-1);
+            const QStringList rangeList(nameNumberOrPattern.split('-'));
+            if (rangeList.size() == 1) {
+                firstNumber = rangeList.at(0).trimmed().toInt(&validFirstFlag);
+                lastNumber  = firstNumber;
+                validLastFlag = validFirstFlag;
+            }
+            else if (rangeList.size() == 2) {
+                firstNumber = rangeList.at(0).trimmed().toInt(&validFirstFlag);
+                lastNumber  = rangeList.at(1).trimmed().toInt(&validLastFlag);
+            }
+            
+            if (validFirstFlag
+                && validLastFlag) {
+                if ((firstNumber < 1)
+                    || (lastNumber > numberOfScenes)
+                    || (firstNumber > lastNumber)) {
+                    throw OperationException("Scene index is invalid: "
+                                             + nameNumberOrPattern);
+                }
+                for (int32_t i = firstNumber; i <= lastNumber; i++) {
+                    matchingIndices.push_back(i - 1);
+                }
+            }
+            else if (nameNumberOrPattern.contains('*')
+                     || nameNumberOrPattern.contains('?')) {
+                /*
+                 * NOTE: QRegularExpression::wildcardToRegularExpression() added in Qt 5.12
+                 */
+                QString reText(QRegularExpression::escape(nameNumberOrPattern));
+                reText.replace("\\*", ".*");
+                reText.replace("\\?", ".");
+                const QRegularExpression regularExpression("^" + reText + "$");
+                if ( ! regularExpression.isValid()) {
+                    throw OperationException("Scene name pattern is invalid: "
+                                             + nameNumberOrPattern);
+                }
+                for (int32_t i = 0; i < numberOfScenes; i++) {
+                    if (regularExpression.match(sceneFile->getSceneAtIndex(i)->getName()).hasMatch()) {
+                        matchingIndices.push_back(i);
+                    }
+                }
+            }
+        }
+        
+        if (matchingIndices.empty()) {
+            throw OperationException("Scene name is invalid or matches no scenes: "
+                                     + nameNumberOrPattern);
+        }
+        
+        for (const auto index : matchingIndices) {
+            if (std::find(sceneIndices.begin(),
+                          sceneIndices.end(),
+                          index) == sceneIndices.end()) {
+                sceneIndices.push_back(index);
+            }
+        }
+    }
+    
+    std::vector<std::pair<int32_t, Scene*>> scenesOut;
+    for (const auto index : sceneIndices) {
+        scenesOut.push_back(std::make_pair(index,
+                                           sceneFile->getSceneAtIndex(index)));
+    }
+    return scenesOut;
+}
+
+/**
+ * Write the image data to a Image File.  The image data is copied
+ * and the file is written by another thread so that rendering may
+ * continue while the image is encoded.
  *
  * @param imageFileName
  *     Name of image file.
@@ -878,44 +1129,87 @@ OperationShowScene::createBrainOpenGL()
  *     width of image.
  * @param imageHeight
  *     height of image.
+ * @param imageWriteResultsOut
+ *     The result of writing the image is added to this.
  */
 void
 OperationShowScene::writeImage(const AString& imageFileName,
                                const int32_t imageIndex,
                                const unsigned char* imageContent,
                                const int32_t imageWidth,
-                               const int32_t imageHeight)
+                               const int32_t imageHeight,
+                               std::vector<ImageWriteResult>& imageWriteResultsOut)
 {
     /*
      * Create name of image
      */
-    QString outputName(imageFileName);
+    AString outputName(imageFileName);
     if (imageIndex >= 0) {
         const AString imageNumber = QString("_%1").arg((int)(imageIndex + 1),
                                                        2, // width
                                                        10, // base
                                                        QChar('0')); // fill character
-        const int dotOffset = outputName.lastIndexOf(".");
-        if (dotOffset >= 0) {
-            outputName.insert(dotOffset,
-                              imageNumber);
-        }
-        else {
-            outputName += (imageNumber
-                           + ".png");
-        }
+        outputName = insertIntoImageFileName(imageFileName,
+                                             imageNumber);
     }
     
+    ImageWriteResult result;
+    result.m_imageFile.reset(new ImageFile(imageContent,
+                                           imageWidth,
+                                           imageHeight,
+                                           ImageFile::IMAGE_DATA_ORIGIN_AT_BOTTOM));
+    result.m_future = QtConcurrent::run(&OperationShowScene::writeImageFile,
+                                        result.m_imageFile.get(),
+                                        outputName);
+    imageWriteResultsOut.push_back(result);
+}
+
+/**
+ * Write an image file.  Called from another thread.
+ *
+ * @param imageFile
+ *     The image file.
+ * @param imageFileName
+ *     Name for the image file.
+ * @return
+ *     Empty string if successful, else an error message.
+ */
+AString
+OperationShowScene::writeImageFile(ImageFile* imageFile,
+                                   const AString imageFileName)
+{
+    CaretAssert(imageFile);
     try {
-        ImageFile imageFile(imageContent,
-                            imageWidth,
-                            imageHeight,
-                            ImageFile::IMAGE_DATA_ORIGIN_AT_BOTTOM);
-        imageFile.writeFile(outputName);
+        imageFile->writeFile(imageFileName);
     }
     catch (const DataFileException& dfe) {
-        throw OperationException(dfe);
+        return dfe.whatString();
+    }
+    return "";
+}
+
+/**
+ * Wait for all images to finish writing.
+ *
+ * @param imageWriteResults
+ *     Results of images that are being written (cleared by this method).
+ * @return
+ *     Empty string if all images were written, else error messages.
+ */
+AString
+OperationShowScene::waitForImagesToFinishWriting(std::vector<ImageWriteResult>& imageWriteResults)
+{
+    AString errorMessage;
+    for (auto& result : imageWriteResults) {
+        result.m_future.waitForFinished();
+        const AString msg = result.m_future.result();
+        if ( ! msg.isEmpty()) {
+            errorMessage.appendWithNewLine(msg);
+        }
     }
+    imageWriteResults.clear();
+    
+    return errorMessage;
 }
 
 /**
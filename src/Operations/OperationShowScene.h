@@ -21,12 +21,21 @@
  */
 /*LICENSE_END*/
 
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <QFuture>
 
 #include "AbstractOperation.h"
+#include "MapYokingGroupEnum.h"
 
 namespace caret {
 
     class BrainOpenGLFixedPipeline;
+    class ImageFile;
+    class Scene;
+    class SceneFile;
     
     class OperationShowScene : public AbstractOperation {
 
@@ -45,13 +54,46 @@ namespace caret {
         static AString getCommandNotAvailableMessage(const AString& commandSwitch);
         
     private:
+        /**
+         * An image file that is being written by another thread
+         */
+        struct ImageWriteResult {
+            std::shared_ptr<ImageFile> m_imageFile;
+            
+            QFuture<AString> m_future;
+        };
+        
         static BrainOpenGLFixedPipeline* createBrainOpenGL();
         
+        static std::vector<std::pair<int32_t, Scene*>> getScenesForRendering(SceneFile* sceneFile,
+                                                                             const std::vector<AString>& sceneNamesNumbersOrPatterns);
+        
+        static void renderScene(Scene* scene,
+                                const AString& imageFileName,
+                                const int32_t userImageWidth,
+                                const int32_t userImageHeight,
+                                const bool useWindowSizeForImageSizeFlag,
+                                const AString& useWindowSizeSwitch,
+                                const bool doNotUseSceneColorsFlag,
+                                const MapYokingGroupEnum::Enum mapYokingGroup,
+                                const int32_t mapYokingMapIndex,
+                                void* mesaContextPointer,
+                                std::vector<ImageWriteResult>& imageWriteResultsOut);
+        
+        static AString insertIntoImageFileName(const AString& imageFileName,
+                                               const AString& text);
+        
         static void writeImage(const AString& imageFileName,
                                   const int32_t imageIndex,
                                   const unsigned char* imageContent,
                                   const int32_t imageWidth,
-                                  const int32_t imageHeight);
+                                  const int32_t imageHeight,
+                                  std::vector<ImageWriteResult>& imageWriteResultsOut);
+        
+        static AString writeImageFile(ImageFile* imageFile,
+                                      const AString imageFileName);
+        
+        static AString waitForImagesToFinishWriting(std::vector<ImageWriteResult>& imageWriteResults);
         
         static void estimateGraphicsSize(const SceneClass* windowSceneClass,
                                          float& estimatedWidthOut,
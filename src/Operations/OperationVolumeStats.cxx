@@ -115,13 +115,7 @@ namespace
             }
         }
         if (toUse.empty()) throw OperationException("roi contains no voxels");
-        sort(toUse.begin(), toUse.end());
-        const double index = percent / 100.0f * (toUse.size() - 1);
-        if (index <= 0) return toUse[0];
-        if (index >= toUse.size() - 1) return toUse.back();
-        double ipart, fpart;
-        fpart = modf(index, &ipart);
-        return (1.0f - fpart) * toUse[(int64_t)ipart] + fpart * toUse[((int64_t)ipart) + 1];
+        return ReductionOperation::percentile(toUse.data(), toUse.size(), percent);
     }
 }
 
@@ -22,6 +22,7 @@
 #include "OperationException.h"
 
 #include "CaretHeap.h"
+#include "ReductionOperation.h"
 #include "VolumeFile.h"
 
 #include <cmath>
@@ -249,14 +250,7 @@ namespace
             case PERCENTILE:
             {
                 CaretAssert(argument >= 0.0f && argument <= 100.0f);//same as unweighted
-                vector<float> sortCopy(useData, useData + numUse);
-                sort(sortCopy.begin(), sortCopy.end());
-                const double index = argument / 100.0f * (sortCopy.size() - 1);
-                if (index <= 0) return sortCopy[0];
-                if (index >= sortCopy.size() - 1) return sortCopy.back();
-                double ipart, fpart;
-                fpart = modf(index, &ipart);
-                return (1.0f - fpart) * sortCopy[(int64_t)ipart] + fpart * sortCopy[((int64_t)ipart) + 1];
+                return ReductionOperation::percentile(useData, numUse, argument);
             }
         }
         CaretAssert(false);//make sure execution never actually reaches end of function
@@ -24,6 +24,7 @@
 //make it easy to use these in an algorithm class, don't just forward declare them
 #include "ProgressObject.h"
 #include "CaretAssert.h"
+#include "CaretTrace.h"
 #include "OperationParameters.h"
 
 #include "StructureEnum.h"
@@ -74,6 +75,7 @@ namespace caret {
         virtual bool takesParameters() = 0;
         virtual bool lazyFileReading() = 0;
         virtual std::vector<AString> getCompatibilitySwitches() const = 0;
+        virtual AutoOperationInterface* clone() const = 0;
         virtual ~AutoOperationInterface();
     };
 
@@ -84,12 +86,17 @@ namespace caret {
     {
         TemplateAutoOperation() { }
         OperationParameters* getParameters() { return T::getParameters(); }
-        void useParameters(OperationParameters* a, ProgressObject* b) { T::useParameters(a, b); }
+        void useParameters(OperationParameters* a, ProgressObject* b)
+        {
+            CaretTraceSpan traceSpan("operation", T::getCommandSwitch());
+            T::useParameters(a, b);
+        }
         AString getCommandSwitch() { return T::getCommandSwitch(); }
         AString getShortDescription() { return T::getShortDescription(); }
         bool takesParameters() { return T::takesParameters(); }
         bool lazyFileReading() { return T::lazyFileReading(); }
         std::vector<AString> getCompatibilitySwitches() const { return T::getCompatibilitySwitches(); }
+        AutoOperationInterface* clone() const { return new TemplateAutoOperation<T>(); }
     };
 
 }
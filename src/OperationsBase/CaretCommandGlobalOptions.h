@@ -34,6 +34,7 @@ namespace caret {
         int16_t m_volumeDType = NIFTI_TYPE_FLOAT32;
         int16_t m_ciftiDType = NIFTI_TYPE_FLOAT32;
         bool m_volumeScale = false, m_ciftiScale = false;
+        bool m_volumeAutoRange = false, m_ciftiAutoRange = false;//takes priority over the scale ranges
         float m_volumeMin = -1.0f, m_volumeMax = -1.0f;//these values won't get used, but don't leave them uninitialized
         float m_ciftiMin = -1.0f, m_ciftiMax = -1.0f;
     };
@@ -27,12 +27,14 @@
 #include "AnnotationFile.h"
 #include "BorderFile.h"
 #include "CaretDataFileHelper.h"
+#include "CaretTrace.h"
 #include "CiftiFile.h"
 #include "FociFile.h"
 #include "LabelFile.h"
 #include "MetricFile.h"
 #include "ProgramParametersException.h"
 #include "SurfaceFile.h"
+#include "SurfaceFileCache.h"
 #include "VolumeFile.h"
 
 using namespace std;
@@ -742,6 +744,8 @@ AnnotationFile* ParameterComponent::getAnnotation(const int32_t key)
     AnnotationParameter* myParam = (AnnotationParameter*)getInputParameter(key, OperationParametersEnum::ANNOTATION);
     if (myParam->m_parameter == NULL)
     {
+        CaretTraceSpan traceSpan("io", "read file");
+        traceSpan.setDetail(myParam->m_filename);
         try
         {
             myParam->lazyGet()->readFile(myParam->m_filename);
@@ -758,6 +762,8 @@ BorderFile* ParameterComponent::getBorder(const int32_t key)
     BorderParameter* myParam = (BorderParameter*)getInputParameter(key, OperationParametersEnum::BORDER);
     if (myParam->m_parameter == NULL)
     {
+        CaretTraceSpan traceSpan("io", "read file");
+        traceSpan.setDetail(myParam->m_filename);
         try
         {
             myParam->lazyGet()->readFile(myParam->m_filename);
@@ -774,6 +780,8 @@ CiftiFile* ParameterComponent::getCifti(const int32_t key)
     CiftiParameter* myParam = (CiftiParameter*)getInputParameter(key, OperationParametersEnum::CIFTI);
     if (myParam->m_parameter == NULL)
     {
+        CaretTraceSpan traceSpan("io", "read file");
+        traceSpan.setDetail(myParam->m_filename);
         try
         {
             myParam->lazyGet()->openFile(myParam->m_filename);
@@ -794,6 +802,8 @@ FociFile* ParameterComponent::getFoci(const int32_t key)
     FociParameter* myParam = (FociParameter*)getInputParameter(key, OperationParametersEnum::FOCI);
     if (myParam->m_parameter == NULL)
     {
+        CaretTraceSpan traceSpan("io", "read file");
+        traceSpan.setDetail(myParam->m_filename);
         try
         {
             myParam->lazyGet()->readFile(myParam->m_filename);
@@ -810,6 +820,8 @@ LabelFile* ParameterComponent::getLabel(const int32_t key)
     LabelParameter* myParam = (LabelParameter*)getInputParameter(key, OperationParametersEnum::LABEL);
     if (myParam->m_parameter == NULL)
     {
+        CaretTraceSpan traceSpan("io", "read file");
+        traceSpan.setDetail(myParam->m_filename);
         try
         {
             myParam->lazyGet()->readFile(myParam->m_filename);
@@ -826,6 +838,8 @@ MetricFile* ParameterComponent::getMetric(const int32_t key)
     MetricParameter* myParam = (MetricParameter*)getInputParameter(key, OperationParametersEnum::METRIC);
     if (myParam->m_parameter == NULL)
     {
+        CaretTraceSpan traceSpan("io", "read file");
+        traceSpan.setDetail(myParam->m_filename);
         try
         {
             myParam->lazyGet()->readFile(myParam->m_filename);
@@ -842,9 +856,16 @@ SurfaceFile* ParameterComponent::getSurface(const int32_t key)
     SurfaceParameter* myParam = (SurfaceParameter*)getInputParameter(key, OperationParametersEnum::SURFACE);
     if (myParam->m_parameter == NULL)
     {
+        CaretTraceSpan traceSpan("io", "read file");
+        traceSpan.setDetail(myParam->m_filename);
         try
         {
-            myParam->lazyGet()->readFile(myParam->m_filename);
+            if (SurfaceFileCache::isEnabled())
+            {//long-running processes share surfaces (and their helpers) between commands
+                myParam->m_parameter = SurfaceFileCache::readSurface(myParam->m_filename);
+            } else {
+                myParam->lazyGet()->readFile(myParam->m_filename);
+            }
             m_provHelper->addToProvenance(myParam->m_parameter->getFileMetaData(), myParam->m_filename);
         } catch (const bad_alloc&) {
             throw DataFileException(myParam->m_filename, CaretDataFileHelper::createBadAllocExceptionMessage(myParam->m_filename));
@@ -858,6 +879,8 @@ VolumeFile* ParameterComponent::getVolume(const int32_t key)
     VolumeParameter* myParam = (VolumeParameter*)getInputParameter(key, OperationParametersEnum::VOLUME);
     if (myParam->m_parameter == NULL)
     {
+        CaretTraceSpan traceSpan("io", "read file");
+        traceSpan.setDetail(myParam->m_filename);
         try
         {
             myParam->lazyGet()->readFile(myParam->m_filename);
@@ -891,8 +914,10 @@ CiftiFile* ParameterComponent::getOutputCifti(const int32_t key)
         {
             thisCifti->setWritingFile(myParam->m_filename);
         }
-        if (caret_global_command_options.m_ciftiScale)
+        if (caret_global_command_options.m_ciftiAutoRange)
         {
+            thisCifti->setWritingDataTypeAutoScaling(caret_global_command_options.m_ciftiDType);
+        } else if (caret_global_command_options.m_ciftiScale) {
             thisCifti->setWritingDataTypeAndScaling(caret_global_command_options.m_ciftiDType, caret_global_command_options.m_ciftiMin, caret_global_command_options.m_ciftiMax);
         } else {
             thisCifti->setWritingDataTypeNoScaling(caret_global_command_options.m_ciftiDType);
@@ -418,7 +418,7 @@ namespace caret {
             m_doOnDiskWrite = true;//NOTE: on-disk writing, like cifti, needs special checks for overwriting inputs
             m_collidingParam = NULL;
         }
-        void checkExists() { if (!QFile::exists(m_filename)) throw DataFileException(m_filename, "file does not exist"); }
+        void checkExists() { if (m_parameter == NULL && !QFile::exists(m_filename)) throw DataFileException(m_filename, "file does not exist"); }//a file that is already in memory doesn't need to exist on disk
         T* lazyGet() { if (m_parameter == NULL) { m_parameter.grabNew(new T()); } return m_parameter; }
     };
     
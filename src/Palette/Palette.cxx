@@ -24,6 +24,7 @@
 #include "CaretAssert.h"
 #define __PALETTE_DEFINE__
 #include "Palette.h"
+#include "PaletteColorLookupTable.h"
 #undef __PALETTE_DEFINE__
 
 #include "PaletteScalarAndColor.h"
@@ -652,6 +653,36 @@ Palette::getInvertedPalette() const
     return m_invertedPalette.get();
 }
 
+/**
+ * Get a lookup table for fast coloring of normalized values with this palette.
+ * The table is created when first requested and recreated if the palette's
+ * scalars or colors have changed since the table was created.
+ *
+ * @param interpolateColorFlag
+ *     Interpolation status of the palette coloring.
+ * @return
+ *     The color lookup table.
+ */
+std::shared_ptr<const PaletteColorLookupTable>
+Palette::getColorLookupTable(const bool interpolateColorFlag) const
+{
+    CaretMutexLocker locker(&m_colorLookupTableMutex);
+    
+    std::shared_ptr<const PaletteColorLookupTable>& table = m_colorLookupTables[interpolateColorFlag ? 1 : 0];
+    if (table) {
+        if ( ! table->isValidForPalette(this,
+                                        interpolateColorFlag)) {
+            table.reset();
+        }
+    }
+    if ( ! table) {
+        table.reset(new PaletteColorLookupTable(this,
+                                                interpolateColorFlag));
+    }
+    
+    return table;
+}
+
 /**
  * @return Name of the default palette.
  */
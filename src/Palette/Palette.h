@@ -26,12 +26,14 @@
 #include <vector>
 
 #include "CaretAssert.h"
+#include "CaretMutex.h"
 #include "CaretObject.h"
 #include "TracksModificationInterface.h"
 
 
 namespace caret {
 
+    class PaletteColorLookupTable;
     class PaletteScalarAndColor;
 
     /**
@@ -97,6 +99,8 @@ namespace caret {
                              const bool interpolateColorFlag,
                              float rgbaOut[4]) const;
         
+        std::shared_ptr<const PaletteColorLookupTable> getColorLookupTable(const bool interpolateColorFlag) const;
+        
         void setModified();
         
         void clearModified();
@@ -147,6 +151,12 @@ namespace caret {
         
         /** The inverted palette with negative inverted separate from positive */
         mutable std::unique_ptr<Palette> m_noneSeparateInvertedPalette;
+        
+        /** Lazily created color lookup tables, [0] not interpolated, [1] interpolated */
+        mutable std::shared_ptr<const PaletteColorLookupTable> m_colorLookupTables[2];
+        
+        /** Protects the color lookup tables */
+        mutable CaretMutex m_colorLookupTableMutex;
     };
 
     
@@ -0,0 +1,151 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#define __PALETTE_COLOR_LOOKUP_TABLE_DECLARE__
+#include "PaletteColorLookupTable.h"
+#undef __PALETTE_COLOR_LOOKUP_TABLE_DECLARE__
+
+#include "Palette.h"
+#include "PaletteScalarAndColor.h"
+
+using namespace caret;
+
+
+    
+/**
+ * \class caret::PaletteColorLookupTable 
+ * \brief Lookup table of colors for normalized values in a palette.
+ * \ingroup Palette
+ *
+ * The range of normalized values, -1.0 to 1.0, is split into
+ * NUMBER_OF_ENTRIES entries.  The palette's colors are evaluated at the
+ * edges of each entry.  Within an entry that does not contain any of the
+ * palette's scalars, the palette's color is constant (not interpolated)
+ * or linear (interpolated) so interpolating between the edge colors 
+ * produces the same color as Palette::getPaletteColor().  Entries that
+ * contain a palette scalar are marked so that the caller uses
+ * Palette::getPaletteColor() for those values.
+ */
+
+/**
+ * Constructor.
+ *
+ * @param palette
+ *     Palette used to create the table.
+ * @param interpolateColorFlag
+ *     Interpolation status of the palette coloring.
+ */
+PaletteColorLookupTable::PaletteColorLookupTable(const Palette* palette,
+                                                 const bool interpolateColorFlag)
+: CaretObject(),
+m_interpolateColorFlag(interpolateColorFlag)
+{
+    CaretAssert(palette);
+    
+    createPaletteSignature(palette,
+                           m_paletteSignature);
+    
+    const int32_t numberOfEdges = NUMBER_OF_ENTRIES + 1;
+    const float entryWidth = 2.0f / NUMBER_OF_ENTRIES;
+    m_edgeColors.resize(numberOfEdges * 4);
+    for (int32_t i = 0; i < numberOfEdges; i++) {
+        const float value = -1.0f + (i * entryWidth);
+        palette->getPaletteColor(value,
+                                 interpolateColorFlag,
+                                 &m_edgeColors[i * 4]);
+    }
+    
+    /*
+     * An entry is linear if it does not contain any of the palette's
+     * scalars (including at the entry's edges)
+     */
+    m_entryIsLinear.resize(NUMBER_OF_ENTRIES, 1);
+    const int32_t numScalars = palette->getNumberOfScalarsAndColors();
+    for (int32_t i = 0; i < numScalars; i++) {
+        const float scalar = palette->getScalarAndColor(i)->getScalar();
+        const float position = (scalar + 1.0f) * (NUMBER_OF_ENTRIES / 2.0f);
+        const int32_t firstIndex = static_cast<int32_t>(position) - 1;
+        const int32_t lastIndex  = static_cast<int32_t>(position) + 1;
+        for (int32_t j = firstIndex; j <= lastIndex; j++) {
+            if ((j >= 0)
+                && (j < NUMBER_OF_ENTRIES)) {
+                m_entryIsLinear[j] = 0;
+            }
+        }
+    }
+}
+
+/**
+ * Destructor.
+ */
+PaletteColorLookupTable::~PaletteColorLookupTable()
+{
+}
+
+/**
+ * @return True if this table was created from a palette with the same scalars
+ * and colors as the given palette and the same interpolation status.
+ *
+ * @param palette
+ *     Palette for testing.
+ * @param interpolateColorFlag
+ *     Interpolation status of the palette coloring.
+ */
+bool
+PaletteColorLookupTable::isValidForPalette(const Palette* palette,
+                                           const bool interpolateColorFlag) const
+{
+    if (interpolateColorFlag != m_interpolateColorFlag) {
+        return false;
+    }
+    
+    std::vector<float> signature;
+    createPaletteSignature(palette,
+                           signature);
+    return (signature == m_paletteSignature);
+}
+
+/**
+ * Create a signature containing the palette's scalars and colors.
+ *
+ * @param palette
+ *     The palette.
+ * @param signatureOut
+ *     Output containing the signature.
+ */
+void
+PaletteColorLookupTable::createPaletteSignature(const Palette* palette,
+                                                std::vector<float>& signatureOut)
+{
+    CaretAssert(palette);
+    
+    const int32_t numScalars = palette->getNumberOfScalarsAndColors();
+    signatureOut.clear();
+    signatureOut.reserve(numScalars * 6);
+    for (int32_t i = 0; i < numScalars; i++) {
+        const PaletteScalarAndColor* psac = palette->getScalarAndColor(i);
+        const float* rgba = psac->getColor();
+        signatureOut.push_back(psac->getScalar());
+        signatureOut.push_back(rgba[0]);
+        signatureOut.push_back(rgba[1]);
+        signatureOut.push_back(rgba[2]);
+        signatureOut.push_back(rgba[3]);
+        signatureOut.push_back(psac->isNoneColor() ? 1.0f : 0.0f);
+    }
+}
@@ -0,0 +1,114 @@
+#ifndef __PALETTE_COLOR_LOOKUP_TABLE_H__
+#define __PALETTE_COLOR_LOOKUP_TABLE_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2014  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <stdint.h>
+#include <vector>
+
+#include "CaretAssert.h"
+#include "CaretObject.h"
+
+namespace caret {
+
+    class Palette;
+    
+    class PaletteColorLookupTable : public CaretObject {
+        
+    public:
+        PaletteColorLookupTable(const Palette* palette,
+                                const bool interpolateColorFlag);
+        
+        virtual ~PaletteColorLookupTable();
+        
+        PaletteColorLookupTable(const PaletteColorLookupTable&) = delete;
+
+        PaletteColorLookupTable& operator=(const PaletteColorLookupTable&) = delete;
+        
+        bool isValidForPalette(const Palette* palette,
+                               const bool interpolateColorFlag) const;
+        
+        /**
+         * Get the color for a normalized value using the lookup table.
+         *
+         * @param normalizedValue
+         *     Normalized value ranging from -1.0 to 1.0.
+         * @param rgbaOut
+         *     Output containing the color.
+         * @return
+         *     True if the color was set.  False if the value is in an entry
+         *     that contains a change in the palette's colors, in which case
+         *     the color must be obtained from Palette::getPaletteColor().
+         */
+        inline bool getColor(const float normalizedValue,
+                             float rgbaOut[4]) const {
+            float position = (normalizedValue + 1.0f) * (NUMBER_OF_ENTRIES / 2.0f);
+            /* clamp before converting to int, which is undefined for NaN and out of range values, NaN goes to 0 */
+            if ( ! (position >= 0.0f)) position = 0.0f;
+            if (position > static_cast<float>(NUMBER_OF_ENTRIES)) position = static_cast<float>(NUMBER_OF_ENTRIES);
+            int32_t index = static_cast<int32_t>(position);
+            if (index >= NUMBER_OF_ENTRIES) index = NUMBER_OF_ENTRIES - 1;
+            if ( ! m_entryIsLinear[index]) {
+                return false;
+            }
+            
+            const float weightAbove = position - index;
+            const float weightBelow = 1.0f - weightAbove;
+            const int32_t i4 = index * 4;
+            CaretAssertVectorIndex(m_edgeColors, i4 + 7);
+            rgbaOut[0] = (weightBelow * m_edgeColors[i4])     + (weightAbove * m_edgeColors[i4 + 4]);
+            rgbaOut[1] = (weightBelow * m_edgeColors[i4 + 1]) + (weightAbove * m_edgeColors[i4 + 5]);
+            rgbaOut[2] = (weightBelow * m_edgeColors[i4 + 2]) + (weightAbove * m_edgeColors[i4 + 6]);
+            rgbaOut[3] = m_edgeColors[i4 + 3];
+            return true;
+        }
+
+        /** Number of entries in the lookup table */
+        static const int32_t NUMBER_OF_ENTRIES;
+        
+        // ADD_NEW_METHODS_HERE
+
+    private:
+        static void createPaletteSignature(const Palette* palette,
+                                           std::vector<float>& signatureOut);
+        
+        /** Colors at the edges of each entry, (NUMBER_OF_ENTRIES + 1) * 4 elements */
+        std::vector<float> m_edgeColors;
+        
+        /** True if the color is linear (no change in palette scalar) within the entry */
+        std::vector<uint8_t> m_entryIsLinear;
+        
+        /** Scalars and colors of palette used to verify the palette has not changed */
+        std::vector<float> m_paletteSignature;
+        
+        /** Interpolation status used to create the table */
+        const bool m_interpolateColorFlag;
+        
+        // ADD_NEW_MEMBERS_HERE
+
+    };
+    
+#ifdef __PALETTE_COLOR_LOOKUP_TABLE_DECLARE__
+    const int32_t PaletteColorLookupTable::NUMBER_OF_ENTRIES = 4096;
+#endif // __PALETTE_COLOR_LOOKUP_TABLE_DECLARE__
+
+} // namespace
+#endif  //__PALETTE_COLOR_LOOKUP_TABLE_H__
@@ -18,6 +18,7 @@
  */
 /*LICENSE_END*/
 
+#include <atomic>
 #include <cmath>
 #include <sstream>
 
@@ -46,6 +47,11 @@
 
 using namespace caret;
 
+/**
+ * Source of modification stamps, shared by all palette color mappings
+ */
+static std::atomic<int64_t> s_modificationStampCounter(0);
+
 
 /**
  * Constructor.
@@ -165,6 +171,7 @@ PaletteColorMapping::copyHelper(const PaletteColorMapping& pcm,
     this->thresholdOutlineDrawingMode = pcm.thresholdOutlineDrawingMode;
     this->thresholdOutlineDrawingColor = pcm.thresholdOutlineDrawingColor;
     
+    this->m_modificationStamp = ++s_modificationStampCounter;
     this->clearModified();
 }
 
@@ -287,6 +294,7 @@ PaletteColorMapping::initializeMembersPaletteColorMapping()
     this->thresholdOutlineDrawingMode = PaletteThresholdOutlineDrawingModeEnum::OFF;
     this->thresholdOutlineDrawingColor = CaretColorEnum::WHITE;
     this->modifiedStatus = PaletteModifiedStatusEnum::UNMODIFIED;
+    this->m_modificationStamp = ++s_modificationStampCounter;
 }
 
 /**
@@ -1796,6 +1804,7 @@ void
 PaletteColorMapping::setModified()
 {
     this->modifiedStatus = PaletteModifiedStatusEnum::MODIFIED;
+    this->m_modificationStamp = ++s_modificationStampCounter;
 }
 
 /**
@@ -1839,6 +1848,19 @@ void
 PaletteColorMapping::setSceneModified()
 {
     this->modifiedStatus = PaletteModifiedStatusEnum::MODIFIED_BY_SHOW_SCENE;
+    this->m_modificationStamp = ++s_modificationStampCounter;
+}
+
+/**
+ * @return A stamp that changes whenever the content of this palette color
+ * mapping changes.  Stamps are unique among all palette color mappings
+ * so the stamp may be used to verify that coloring derived from this
+ * palette color mapping is current.
+ */
+int64_t
+PaletteColorMapping::getModificationStamp() const
+{
+    return this->m_modificationStamp;
 }
 
 /**
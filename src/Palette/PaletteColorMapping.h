@@ -288,6 +288,8 @@ namespace caret {
         
         PaletteModifiedStatusEnum::Enum getModifiedStatus() const;
         
+        int64_t getModificationStamp() const;
+        
         void mapDataToPaletteNormalizedValues(const FastStatistics* statistics,
                                               const float* dataValues,
                                               float* normalizedValuesOut,
@@ -397,6 +399,9 @@ namespace caret {
         /**Tracks modification, DO NOT copy */
         PaletteModifiedStatusEnum::Enum modifiedStatus;
         
+        /**Changes whenever content changes, DO NOT copy */
+        int64_t m_modificationStamp;
+        
         /** keeps missing palettes from being logged more than once */
         static std::set<AString> s_missingPaletteNames;
     };
@@ -0,0 +1,105 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "BenchData.h"
+
+#include "AlgorithmSurfaceCreateSphere.h"
+#include "CiftiFile.h"
+#include "SurfaceFile.h"
+#include "VolumeFile.h"
+
+#include <QDir>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+void BenchData::createSphere(const int& numVertices, SurfaceFile* sphereOut)
+{
+    AlgorithmSurfaceCreateSphere(NULL, numVertices, sphereOut);
+}
+
+void BenchData::createDenseTimeseries(const int64_t& numVertices, const int64_t& numTimepoints, CiftiFile* ciftiOut, const unsigned int& seed)
+{
+    CiftiBrainModelsMap denseMap;
+    denseMap.addSurfaceModel(numVertices, StructureEnum::CORTEX_LEFT);
+    CiftiSeriesMap seriesMap;
+    seriesMap.setUnit(CiftiSeriesMap::SECOND);
+    seriesMap.setStart(0.0f);
+    seriesMap.setStep(0.72f);
+    seriesMap.setLength(numTimepoints);
+    CiftiXML myXML;
+    myXML.setNumberOfDimensions(2);
+    myXML.setMap(CiftiXML::ALONG_COLUMN, denseMap);
+    myXML.setMap(CiftiXML::ALONG_ROW, seriesMap);
+    ciftiOut->setCiftiXML(myXML);
+    mt19937 generator(seed);
+    normal_distribution<float> noise(0.0f, 1.0f);
+    vector<float> row(numTimepoints);
+    for (int64_t i = 0; i < numVertices; ++i)
+    {
+        for (int64_t t = 0; t < numTimepoints; ++t)
+        {
+            row[t] = 100.0f + noise(generator);
+        }
+        ciftiOut->setRow(row.data(), i);
+    }
+}
+
+void BenchData::createVolume(const int64_t& dimension, const int64_t& numFrames, VolumeFile* volumeOut, const unsigned int& seed)
+{
+    vector<int64_t> dims(3, dimension);
+    if (numFrames > 1) dims.push_back(numFrames);
+    vector<vector<float> > sform(3, vector<float>(4, 0.0f));
+    for (int i = 0; i < 3; ++i)
+    {
+        sform[i][i] = 2.0f;
+        sform[i][3] = -dimension + 1.0f;//center the voxel grid on the origin
+    }
+    volumeOut->reinitialize(dims, sform);
+    mt19937 generator(seed);
+    normal_distribution<float> noise(0.0f, 0.1f);
+    const float freq = 6.2831853f / dimension;
+    vector<float> frame(dimension * dimension * dimension);
+    for (int64_t b = 0; b < numFrames; ++b)
+    {
+        int64_t index = 0;
+        for (int64_t k = 0; k < dimension; ++k)
+        {
+            for (int64_t j = 0; j < dimension; ++j)
+            {
+                for (int64_t i = 0; i < dimension; ++i)
+                {
+                    frame[index] = sin(freq * i + b) * cos(freq * j) + sin(freq * k) + noise(generator);
+                    ++index;
+                }
+            }
+        }
+        volumeOut->setFrame(frame.data(), b);
+    }
+}
+
+AString BenchData::getTempFileName(const AString& name)
+{
+    return QDir::temp().filePath("wb_bench_" + name);
+}
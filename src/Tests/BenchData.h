@@ -0,0 +1,49 @@
+#ifndef __BENCH_DATA_H__
+#define __BENCH_DATA_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "AString.h"
+
+#include <stdint.h>
+
+namespace caret {
+
+   class CiftiFile;
+   class SurfaceFile;
+   class VolumeFile;
+
+   ///synthetic inputs for benchmarks, deterministic for a given seed so that runs are comparable
+   class BenchData
+   {
+      BenchData();
+   public:
+      ///icosahedral sphere of radius 100, numVertices is rounded to the nearest valid subdivision
+      static void createSphere(const int& numVertices, SurfaceFile* sphereOut);
+      ///in-memory dense timeseries on a left cortex surface, gaussian noise
+      static void createDenseTimeseries(const int64_t& numVertices, const int64_t& numTimepoints, CiftiFile* ciftiOut, const unsigned int& seed = 1);
+      ///2mm isotropic cube volume centered on the origin, smooth signal plus noise
+      static void createVolume(const int64_t& dimension, const int64_t& numFrames, VolumeFile* volumeOut, const unsigned int& seed = 1);
+      ///path in the system temporary directory, for kernels that need to hit the disk
+      static AString getTempFileName(const AString& name);
+   };
+
+}
+#endif //__BENCH_DATA_H__
@@ -0,0 +1,73 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "BenchInterface.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    double secondsSince(const chrono::steady_clock::time_point& start)
+    {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+}
+
+void BenchInterface::measure(const AString& kernel, const function<void()>& func, const double itemsPerCall)
+{
+    const double minTotalSeconds = (m_quick ? 0.05 : 1.0);
+    const int minReps = (m_quick ? 1 : 5), maxReps = (m_quick ? 3 : 1000);
+    func();//warm up caches, lazily built helpers, etc
+    vector<double> times;
+    chrono::steady_clock::time_point total = chrono::steady_clock::now();
+    while ((int)times.size() < minReps || ((int)times.size() < maxReps && secondsSince(total) < minTotalSeconds))
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        func();
+        times.push_back(secondsSince(start));
+    }
+    sort(times.begin(), times.end());
+    BenchResult result;
+    result.m_benchmark = m_identifier;
+    result.m_kernel = kernel;
+    result.m_repetitions = (int)times.size();
+    size_t half = times.size() / 2;
+    double median = (times.size() % 2 == 1 ? times[half] : (times[half - 1] + times[half]) / 2.0);
+    result.m_medianMs = median * 1000.0;
+    result.m_minMs = times[0] * 1000.0;
+    result.m_itemsPerSecond = 0.0;
+    if (itemsPerCall > 0.0 && median > 0.0) result.m_itemsPerSecond = itemsPerCall / median;
+    m_results.push_back(result);
+    cout << setw(14) << left << m_identifier.toStdString() << setw(30) << kernel.toStdString() << right
+         << setw(12) << fixed << setprecision(3) << result.m_medianMs << " ms (min " << result.m_minMs << ", " << result.m_repetitions << " reps)";
+    if (result.m_itemsPerSecond > 0.0) cout << ", " << setprecision(0) << result.m_itemsPerSecond << " items/s";
+    cout << endl;
+    cout.unsetf(ios::floatfield);
+}
+
+BenchInterface::~BenchInterface()
+{
+}
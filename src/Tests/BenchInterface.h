@@ -0,0 +1,67 @@
+#ifndef __BENCH_INTERFACE_H__
+#define __BENCH_INTERFACE_H__
+
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "AString.h"
+
+#include <functional>
+#include <vector>
+
+namespace caret {
+
+   struct BenchResult
+   {
+      AString m_benchmark, m_kernel;
+      double m_medianMs, m_minMs;
+      int m_repetitions;
+      double m_itemsPerSecond;//0 when the kernel has no natural unit of work
+   };
+
+   class BenchInterface
+   {
+      AString m_identifier;
+      bool m_quick;
+      std::vector<BenchResult> m_results;
+      BenchInterface();//deny construction without arguments
+      BenchInterface& operator=(const BenchInterface& right);//deny assignment
+   protected:
+      BenchInterface(const AString& identifier)
+      {
+         m_identifier = identifier;
+         m_quick = false;
+      }
+      ///run the kernel once untimed, then repeatedly until enough time has passed, and record median and minimum time per call
+      void measure(const AString& kernel, const std::function<void()>& func, const double itemsPerCall = 0.0);
+      ///small problem sizes and short timing windows, for smoke testing
+      bool isQuick() const { return m_quick; }
+   public:
+      const AString& getIdentifier() const
+      {
+         return m_identifier;
+      }
+      void setQuick(const bool quick) { m_quick = quick; }
+      const std::vector<BenchResult>& getResults() const { return m_results; }
+      virtual void execute() = 0;//override this, generate data and call measure() for each kernel
+      virtual ~BenchInterface();
+   };
+
+}
+#endif //__BENCH_INTERFACE_H__
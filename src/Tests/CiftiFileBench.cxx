@@ -0,0 +1,68 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "CiftiFileBench.h"
+
+#include "BenchData.h"
+#include "CiftiFile.h"
+
+#include <QFile>
+
+#include <random>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+CiftiFileBench::CiftiFileBench(const AString& identifier) : BenchInterface(identifier)
+{
+}
+
+void CiftiFileBench::execute()
+{
+    const int64_t numVertices = (isQuick() ? 2562 : 32492), numTimepoints = (isQuick() ? 50 : 400);
+    CiftiFile dtseries;
+    BenchData::createDenseTimeseries(numVertices, numTimepoints, &dtseries);
+    const AString fileName = BenchData::getTempFileName("cifti.dtseries.nii");
+    const double bytes = 4.0 * numVertices * numTimepoints;
+    measure("write dtseries (bytes)", [&]() { dtseries.writeFile(fileName); }, bytes);
+    vector<float> row(numTimepoints);
+    measure("read dtseries (bytes)", [&]()
+    {
+        CiftiFile reader(fileName);
+        for (int64_t i = 0; i < numVertices; ++i)
+        {
+            reader.getRow(row.data(), i);
+        }
+    }, bytes);
+    CiftiFile onDisk(fileName);
+    mt19937 generator(1);
+    uniform_int_distribution<int64_t> pickRow(0, numVertices - 1);
+    const int numRandomRows = 1000;
+    measure("random row reads (rows)", [&]()
+    {
+        for (int i = 0; i < numRandomRows; ++i)
+        {
+            onDisk.getRow(row.data(), pickRow(generator));
+        }
+    }, numRandomRows);
+    onDisk.close();
+    QFile::remove(fileName);
+}
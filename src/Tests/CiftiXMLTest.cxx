@@ -0,0 +1,100 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "CiftiXMLTest.h"
+
+#include "CaretException.h"
+#include "CiftiXML.h"
+
+using namespace caret;
+using namespace std;
+
+CiftiXMLTest::CiftiXMLTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void CiftiXMLTest::execute()
+{
+    const int64_t dims[3] = { 4, 5, 6 };
+    const float sform[12] = { 2.0f, 0.0f, 0.0f, -4.0f,
+                              0.0f, 2.0f, 0.0f, -5.0f,
+                              0.0f, 0.0f, 2.0f, -6.0f };
+    CiftiBrainModelsMap myMap;
+    myMap.setVolumeSpace(VolumeSpace(dims, sform));
+    vector<int64_t> leftNodes;
+    for (int64_t i = 0; i < 10; ++i) leftNodes.push_back(i);//every vertex in order, doesn't need a lookup
+    myMap.addSurfaceModel(10, StructureEnum::CORTEX_LEFT, leftNodes);
+    vector<int64_t> rightNodes;
+    rightNodes.push_back(7);
+    rightNodes.push_back(2);
+    rightNodes.push_back(5);
+    myMap.addSurfaceModel(8, StructureEnum::CORTEX_RIGHT, rightNodes);
+    vector<int64_t> voxels;
+    voxels.push_back(1); voxels.push_back(2); voxels.push_back(3);
+    voxels.push_back(3); voxels.push_back(4); voxels.push_back(5);
+    myMap.addVolumeModel(StructureEnum::THALAMUS_LEFT, voxels);
+    vector<int64_t> badVoxels;
+    badVoxels.push_back(0); badVoxels.push_back(0); badVoxels.push_back(0);
+    badVoxels.push_back(3); badVoxels.push_back(4); badVoxels.push_back(5);//reuses a thalamus voxel
+    bool threw = false;
+    try
+    {
+        myMap.addVolumeModel(StructureEnum::THALAMUS_RIGHT, badVoxels);
+    } catch (CaretException&) {
+        threw = true;
+    }
+    if (!threw) setFailed("adding a volume model that reuses a voxel didn't throw");
+    if (myMap.getIndexForVoxel(0, 0, 0) != -1) setFailed("failed volume model left a voxel in the lookup");
+    if (myMap.getIndexForVoxel(3, 4, 5) != 14) setFailed("failed volume model changed an existing voxel's index");
+    if (myMap.getIndexForNode(4, StructureEnum::CORTEX_LEFT) != 4) setFailed("wrong index for vertex in full surface model");
+    if (myMap.getIndexForNode(5, StructureEnum::CORTEX_RIGHT) != 12) setFailed("wrong index for vertex in partial surface model");
+    if (myMap.getIndexForNode(3, StructureEnum::CORTEX_RIGHT) != -1) setFailed("unused vertex in partial surface model has an index");
+    CiftiXML myXML;
+    myXML.setNumberOfDimensions(2);
+    myXML.setMap(CiftiXML::ALONG_ROW, myMap);
+    myXML.setMap(CiftiXML::ALONG_COLUMN, myMap);
+    QString text = myXML.writeXMLToString();
+    CiftiXML readXML;
+    readXML.readXML(text);
+    if (readXML != myXML) setFailed("brain models changed when written and read back");
+    const CiftiBrainModelsMap& readMap = readXML.getBrainModelsMap(CiftiXML::ALONG_COLUMN);
+    if (readMap.getIndexForNode(7, StructureEnum::CORTEX_RIGHT) != 10) setFailed("wrong index for vertex after reading");
+    if (readMap.getIndexForVoxel(1, 2, 3) != 13) setFailed("wrong index for voxel after reading");
+    int32_t vertexStart = text.indexOf("7 2 5");//the tokenizer should reject what toLongLong would reject
+    if (vertexStart < 0)
+    {
+        setFailed("couldn't find vertex list in written XML");
+        return;
+    }
+    const char* badLists[3] = { "7 2x 5", "7 -2 5", "7 99999999999999999999 5" };
+    for (int i = 0; i < 3; ++i)
+    {
+        QString badText = text;
+        badText.replace(vertexStart, 5, badLists[i]);
+        CiftiXML badXML;
+        threw = false;
+        try
+        {
+            badXML.readXML(badText);
+        } catch (CaretException&) {
+            threw = true;
+        }
+        if (!threw) setFailed("vertex list '" + AString(badLists[i]) + "' didn't cause an error");
+    }
+}
@@ -0,0 +1,125 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "ConnectedComponentsTest.h"
+
+#include "CaretConnectedComponents.h"
+
+#include <cstdlib>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    ///reference labeling: flood fill seeded in index order, which is the numbering the engine promises
+    int64_t floodFill(const vector<vector<int64_t> >& neighbors, const vector<char>& mask, vector<int64_t>& labelsOut)
+    {
+        int64_t numElems = (int64_t)mask.size();
+        labelsOut.assign(numElems, -1);
+        int64_t numComponents = 0;
+        vector<int64_t> stack;
+        for (int64_t i = 0; i < numElems; ++i)
+        {
+            if (!mask[i] || labelsOut[i] != -1) continue;
+            labelsOut[i] = numComponents;
+            stack.push_back(i);
+            while (!stack.empty())
+            {
+                int64_t cur = stack.back();
+                stack.pop_back();
+                for (size_t n = 0; n < neighbors[cur].size(); ++n)
+                {
+                    int64_t neigh = neighbors[cur][n];
+                    if (mask[neigh] && labelsOut[neigh] == -1)
+                    {
+                        labelsOut[neigh] = numComponents;
+                        stack.push_back(neigh);
+                    }
+                }
+            }
+            ++numComponents;
+        }
+        return numComponents;
+    }
+}
+
+ConnectedComponentsTest::ConnectedComponentsTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void ConnectedComponentsTest::execute()
+{
+    const int64_t dims[3] = { 23, 17, 31 };
+    const int64_t frameSize = dims[0] * dims[1] * dims[2];
+    vector<vector<int64_t> > neighbors(frameSize);
+    for (int64_t k = 0; k < dims[2]; ++k)
+    {
+        for (int64_t j = 0; j < dims[1]; ++j)
+        {
+            for (int64_t i = 0; i < dims[0]; ++i)
+            {
+                int64_t index = i + dims[0] * (j + dims[1] * k);
+                if (i > 0) neighbors[index].push_back(index - 1);
+                if (i < dims[0] - 1) neighbors[index].push_back(index + 1);
+                if (j > 0) neighbors[index].push_back(index - dims[0]);
+                if (j < dims[1] - 1) neighbors[index].push_back(index + dims[0]);
+                if (k > 0) neighbors[index].push_back(index - dims[0] * dims[1]);
+                if (k < dims[2] - 1) neighbors[index].push_back(index + dims[0] * dims[1]);
+            }
+        }
+    }
+    vector<int64_t> adjStart(frameSize + 1, 0);
+    vector<int32_t> adjNeighbors;
+    for (int64_t i = 0; i < frameSize; ++i)
+    {
+        adjNeighbors.insert(adjNeighbors.end(), neighbors[i].begin(), neighbors[i].end());
+        adjStart[i + 1] = (int64_t)adjNeighbors.size();
+    }
+    CaretConnectedComponents myComponents;
+    const int fillPercents[] = { 0, 20, 35, 50, 80, 100 };//around the percolation threshold is the hardest case for merging
+    for (int trial = 0; trial < (int)(sizeof(fillPercents) / sizeof(fillPercents[0])); ++trial)
+    {
+        vector<char> mask(frameSize);
+        for (int64_t i = 0; i < frameSize; ++i)
+        {
+            mask[i] = ((rand() % 100) < fillPercents[trial] ? 1 : 0);
+        }
+        vector<int64_t> expected, graphLabels, volumeLabels;
+        int64_t expectedCount = floodFill(neighbors, mask, expected);
+        int64_t graphCount = myComponents.labelGraph(adjStart.data(), adjNeighbors.data(), frameSize, mask.data(), graphLabels);
+        int64_t volumeCount = myComponents.labelVolume(dims, mask.data(), volumeLabels);
+        if (graphCount != expectedCount) setFailed("graph labeling found " + AString::number(graphCount) + " components, expected " + AString::number(expectedCount));
+        if (volumeCount != expectedCount) setFailed("volume labeling found " + AString::number(volumeCount) + " components, expected " + AString::number(expectedCount));
+        if (graphLabels != expected) setFailed("graph labels differ from flood fill at fill percent " + AString::number(fillPercents[trial]));
+        if (volumeLabels != expected) setFailed("volume labels differ from flood fill at fill percent " + AString::number(fillPercents[trial]));
+        vector<vector<int32_t> > members;
+        CaretConnectedComponents::getComponentMembers(volumeLabels, volumeCount, members);
+        int64_t totalMembers = 0;
+        for (int64_t c = 0; c < (int64_t)members.size(); ++c)
+        {
+            totalMembers += (int64_t)members[c].size();
+            if (members[c].empty() || expected[members[c][0]] != c) setFailed("component members out of order");
+        }
+        int64_t maskCount = 0;
+        for (int64_t i = 0; i < frameSize; ++i) maskCount += mask[i];
+        if (totalMembers != maskCount) setFailed("component members don't cover the mask");
+    }
+}
@@ -0,0 +1,60 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "DotBench.h"
+
+#include "dot_wrapper.h"
+
+#include <random>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+DotBench::DotBench(const AString& identifier) : BenchInterface(identifier)
+{
+}
+
+void DotBench::execute()
+{
+    const int length = (isQuick() ? 10000 : 1000000), numCalls = 100;
+    mt19937 generator(1);
+    uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    vector<float> first(length), second(length);
+    for (int i = 0; i < length; ++i)
+    {
+        first[i] = dist(generator);
+        second[i] = dist(generator);
+    }
+    volatile double sink = 0.0;//keep the compiler from discarding the calls
+    vector<DotSIMDEnum::Enum> impls = DotSIMDEnum::getAllEnums();
+    for (size_t i = 0; i < impls.size(); ++i)
+    {
+        if (impls[i] == DOT_AUTO || dot_set_impl(impls[i]) != impls[i]) continue;//not supported on this cpu or build
+        measure("dsdot " + DotSIMDEnum::toName(impls[i]) + " (elements)", [&]()
+        {
+            for (int j = 0; j < numCalls; ++j)
+            {
+                sink = sink + dsdot(first.data(), second.data(), length);
+            }
+        }, (double)length * numCalls);
+    }
+    dot_set_impl(DOT_AUTO);
+}
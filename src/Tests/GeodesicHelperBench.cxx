@@ -0,0 +1,66 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "GeodesicHelperBench.h"
+
+#include "BenchData.h"
+#include "GeodesicHelper.h"
+#include "SurfaceFile.h"
+
+#include <random>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+GeodesicHelperBench::GeodesicHelperBench(const AString& identifier) : BenchInterface(identifier)
+{
+}
+
+void GeodesicHelperBench::execute()
+{
+    SurfaceFile sphere;
+    BenchData::createSphere(isQuick() ? 2562 : 32492, &sphere);
+    const int numNodes = sphere.getNumberOfNodes();
+    measure("build base (vertices)", [&]() { GeodesicHelperBase tempBase(&sphere); }, numNodes);
+    CaretPointer<GeodesicHelperBase> myBase(new GeodesicHelperBase(&sphere));
+    GeodesicHelper myHelp(myBase);
+    mt19937 generator(1);
+    uniform_int_distribution<int> pickNode(0, numNodes - 1);
+    vector<float> dists;
+    vector<int32_t> nodes;
+    const int numRegions = 100;
+    measure("20mm neighborhoods (queries)", [&]()
+    {
+        for (int i = 0; i < numRegions; ++i)
+        {
+            myHelp.getNodesToGeoDist(pickNode(generator), 20.0f, nodes, dists);
+        }
+    }, numRegions);
+    const int numFull = 5;
+    vector<float> fullDists(numNodes);
+    measure("whole surface (queries)", [&]()
+    {
+        for (int i = 0; i < numFull; ++i)
+        {
+            myHelp.getGeoFromNode(pickNode(generator), fullDists.data());
+        }
+    }, numFull);
+}
@@ -0,0 +1,138 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "GiftiReadTest.h"
+
+#include "Base64.h"
+#include "GiftiDataArray.h"
+#include "GiftiFile.h"
+#include "GiftiFileSaxReader.h"
+
+#include <QDir>
+#include <QFile>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+GiftiReadTest::GiftiReadTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void GiftiReadTest::execute()
+{
+    //Data elements hidden in comments, CDATA, or attribute values must not be found, and text that isn't plain characters must not be used directly
+    const string document = "<?xml version=\"1.0\"?>\n<GIFTI Version=\"1.0\" Note='<Data>'><!-- <Data>abcd</Data> -->"
+                            "<MetaData><MD><Name><![CDATA[<Data>efgh</Data>]]></Name></MD></MetaData>"
+                            "<DataArray><Data>ijkl</Data></DataArray>"
+                            "<DataArray><Data/></DataArray>"
+                            "<DataArray><Data>mn&amp;op</Data></DataArray>"
+                            "<DataArray><Data><![CDATA[qrst]]></Data></DataArray>"
+                            "<DataArray><Data >uvwx</Data ></DataArray></GIFTI>";
+    vector<pair<int64_t, int64_t> > payloads;
+    GiftiFileSaxReader::findDataPayloads(document.c_str(), (int64_t)document.size(), payloads);
+    if (payloads.size() != 5)
+    {
+        setFailed("found " + AString::number((int64_t)payloads.size()) + " Data elements, expected 5");
+    } else {
+        if (document.substr(payloads[0].first, payloads[0].second - payloads[0].first) != "ijkl") setFailed("wrong text for first Data element");
+        if (payloads[1].first < 0 || payloads[1].first != payloads[1].second) setFailed("empty Data element not found as empty");
+        if (payloads[2].first != -1) setFailed("Data element with entity reference should not be used directly");
+        if (payloads[3].first != -1) setFailed("Data element with CDATA should not be used directly");
+        if (document.substr(payloads[4].first, payloads[4].second - payloads[4].first) != "uvwx") setFailed("wrong text for last Data element");
+    }
+
+    //the base64 encoder must agree with the decoder for every length of the final partial triplet
+    for (int length = 0; length < 64; ++length)
+    {
+        vector<unsigned char> bytes(length), encoded(((length + 2) / 3) * 4 + 1), decoded(length + 3);
+        for (int i = 0; i < length; ++i) bytes[i] = (unsigned char)(rand() & 0xFF);
+        uint64_t encodedLength = Base64::encode(bytes.data(), length, encoded.data());
+        if (encodedLength != encoded.size() - 1)
+        {
+            setFailed("base64 encoding of " + AString::number(length) + " bytes has length " + AString::number(encodedLength));
+            continue;
+        }
+        uint64_t decodedLength = Base64::decode(encoded.data(), length, decoded.data(), encodedLength);
+        if (decodedLength != (uint64_t)length || !equal(bytes.begin(), bytes.end(), decoded.begin()))
+        {
+            setFailed("base64 round trip of " + AString::number(length) + " bytes differs");
+        }
+    }
+
+    //round trip several arrays through every internal encoding, so the deferred decoding of multiple arrays is exercised
+    const int64_t numNodes = 10000, numArrays = 6;
+    vector<vector<float> > values(numArrays, vector<float>(numNodes));
+    for (int64_t a = 0; a < numArrays; ++a)
+    {
+        for (int64_t i = 0; i < numNodes; ++i)
+        {
+            values[a][i] = (rand() % 4 == 0 ? rand() / (float)RAND_MAX : 0.0f);//mostly zero, so gzip has something to compress
+        }
+    }
+    const GiftiEncodingEnum::Enum encodings[] = { GiftiEncodingEnum::ASCII, GiftiEncodingEnum::BASE64_BINARY, GiftiEncodingEnum::GZIP_BASE64_BINARY };
+    const AString outFile = QDir::tempPath() + "/wb_gifti_read_test.func.gii";
+    for (int e = 0; e < 3; ++e)
+    {
+        GiftiFile writer;
+        vector<int64_t> dims(1, numNodes);
+        for (int64_t a = 0; a < numArrays; ++a)
+        {
+            GiftiDataArray* myArray = new GiftiDataArray(NiftiIntentEnum::NIFTI_INTENT_NONE, NiftiDataTypeEnum::NIFTI_TYPE_FLOAT32, dims, encodings[e]);
+            float* data = myArray->getDataPointerFloat();
+            for (int64_t i = 0; i < numNodes; ++i) data[i] = values[a][i];
+            writer.addDataArray(myArray);
+        }
+        writer.setEncodingForWriting(encodings[e]);
+        writer.writeFile(outFile);
+        GiftiFile reader;
+        reader.readFile(outFile);
+        if (reader.getNumberOfDataArrays() != numArrays)
+        {
+            setFailed("read " + AString::number(reader.getNumberOfDataArrays()) + " arrays with encoding " + GiftiEncodingEnum::toName(encodings[e]));
+            continue;
+        }
+        for (int64_t a = 0; a < numArrays; ++a)
+        {
+            const GiftiDataArray* myArray = reader.getDataArray(a);
+            if (myArray->getTotalNumberOfElements() != numNodes)
+            {
+                setFailed("wrong array size with encoding " + GiftiEncodingEnum::toName(encodings[e]));
+                continue;
+            }
+            const float* data = myArray->getDataPointerFloat();
+            for (int64_t i = 0; i < numNodes; ++i)
+            {
+                float tolerance = (encodings[e] == GiftiEncodingEnum::ASCII ? 0.0001f : 0.0f);//ascii is written as decimal text
+                if (abs(data[i] - values[a][i]) > tolerance)
+                {
+                    setFailed("array " + AString::number(a) + " differs after reading with encoding " + GiftiEncodingEnum::toName(encodings[e]));
+                    break;
+                }
+            }
+        }
+    }
+    QFile::remove(outFile);
+}
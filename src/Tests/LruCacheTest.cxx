@@ -0,0 +1,55 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "LruCacheTest.h"
+
+#include "CaretLruCache.h"
+
+using namespace caret;
+using namespace std;
+
+LruCacheTest::LruCacheTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void LruCacheTest::execute()
+{
+    CaretLruCache<int, int> myCache;
+    int value = -1;
+    myCache.insert(1, 10);
+    if (myCache.size() != 0 || myCache.find(1, value)) setFailed("disabled cache stored an entry");
+    myCache.setMaximumEntries(3);
+    myCache.insert(1, 10);
+    myCache.insert(2, 20);
+    myCache.insert(3, 30);
+    if (!myCache.find(1, value) || value != 10) setFailed("cache lost an entry before it was full");
+    myCache.insert(4, 40);//2 is now the least recently used
+    if (myCache.size() != 3) setFailed("cache has " + AString::number(myCache.size()) + " entries, expected 3");
+    if (myCache.find(2, value)) setFailed("cache kept the least recently used entry");
+    if (!myCache.find(1, value) || !myCache.find(3, value) || !myCache.find(4, value)) setFailed("cache evicted a recently used entry");
+    myCache.insert(3, 33);
+    if (!myCache.find(3, value) || value != 33) setFailed("inserting an existing key didn't replace its value");
+    if (myCache.size() != 3) setFailed("replacing a value changed the number of entries");
+    myCache.remove(3);
+    if (myCache.find(3, value) || myCache.size() != 2) setFailed("removed entry is still in the cache");
+    myCache.setMaximumEntries(1);//4 was used most recently
+    if (myCache.size() != 1 || !myCache.find(4, value) || value != 40) setFailed("shrinking the cache kept the wrong entry");
+    myCache.clear();
+    if (myCache.size() != 0 || myCache.find(4, value)) setFailed("cleared cache still has entries");
+}
@@ -0,0 +1,69 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "MathExpressionBench.h"
+
+#include "CaretAssert.h"
+#include "CaretMathExpression.h"
+
+#include <random>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+MathExpressionBench::MathExpressionBench(const AString& identifier) : BenchInterface(identifier)
+{
+}
+
+void MathExpressionBench::execute()
+{
+    const int64_t numElements = (isQuick() ? 65536 : 4194304);
+    CaretMathExpression myExpr("sin(x) * y + exp(-abs(x - y)) / 2 + (x > y) * clamp(y, -0.5, 0.5)");
+    vector<AString> varNames = myExpr.getVarNames();
+    CaretAssert(varNames.size() == 2);
+    mt19937 generator(1);
+    uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    vector<vector<float> > inputs(varNames.size(), vector<float>(numElements));
+    vector<const float*> inputPointers(varNames.size());
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        for (int64_t j = 0; j < numElements; ++j)
+        {
+            inputs[i][j] = dist(generator);
+        }
+        inputPointers[i] = inputs[i].data();
+    }
+    vector<float> results(numElements);
+    measure("array evaluate (elements)", [&]() { myExpr.evaluate(inputPointers, numElements, results.data()); }, numElements);
+    const int64_t numScalar = numElements / 16;
+    vector<float> scalarVars(varNames.size());
+    measure("scalar evaluate (elements)", [&]()
+    {
+        for (int64_t j = 0; j < numScalar; ++j)
+        {
+            for (size_t i = 0; i < inputs.size(); ++i)
+            {
+                scalarVars[i] = inputs[i][j];
+            }
+            results[j] = (float)myExpr.evaluate(scalarVars);
+        }
+    }, numScalar);
+}
@@ -55,4 +55,33 @@ void MathExpressionTest::execute()
     {
         setFailed("output value incorrect, expected " + AString::number(correctresult) + ", got " + AString::number(testresult));
     }
+    CaretMathExpression arrayExpr("(a > 0.5 || !(b <= -1)) * min(a, b) - mod(a * 7, 3) + (a == b) + clamp(b, -2, 2) ^ 2");
+    vector<AString> arrayNames = arrayExpr.getVarNames();
+    if (arrayNames.size() != 2) setFailed("incorrect number of variables found in array expression");
+    const int64_t numElements = 3000;//more than one block
+    vector<vector<float> > arrays(2, vector<float>(numElements));
+    vector<const float*> arrayPointers(2);
+    for (int64_t i = 0; i < numElements; ++i)
+    {
+        arrays[0][i] = (i % 37) * 0.25f - 3.0f;
+        arrays[1][i] = ((i * 7) % 41) * 0.125f - 2.5f;
+        if (i % 11 == 0) arrays[1][i] = arrays[0][i];
+    }
+    arrayPointers[0] = arrays[0].data();
+    arrayPointers[1] = arrays[1].data();
+    vector<float> arrayResults(numElements);
+    arrayExpr.evaluate(arrayPointers, numElements, arrayResults.data());
+    vector<float> elementVars(2);
+    for (int64_t i = 0; i < numElements; ++i)
+    {
+        elementVars[0] = arrays[0][i];
+        elementVars[1] = arrays[1][i];
+        float elementResult = (float)arrayExpr.evaluate(elementVars);
+        if (elementResult != arrayResults[i])
+        {
+            setFailed("array evaluation differs from single evaluation at element " + AString::number(i) + ", expected " +
+                      AString::number(elementResult) + ", got " + AString::number(arrayResults[i]));
+            break;
+        }
+    }
 }
@@ -23,6 +23,10 @@
 #include "MultiDimIterator.h"
 #include "NiftiIO.h"
 
+#include <QDir>
+#include <QFile>
+
+#include <cmath>
 #include <vector>
 
 using namespace std;
@@ -159,3 +163,100 @@ void NiftiHeaderTest::writeNifti2Header(AString filename, NiftiHeader &header)
     myFile.open(filename, CaretBinaryFile::WRITE_TRUNCATE);
     header.write(myFile, 2);
 }
+
+//Tests for writing compact scaled integer types
+
+NiftiScalingTest::NiftiScalingTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void NiftiScalingTest::execute()
+{
+    testScaledRoundTrip(NIFTI_TYPE_INT16, false);
+    testScaledRoundTrip(NIFTI_TYPE_INT16, true);
+    testScaledRoundTrip(NIFTI_TYPE_UINT8, false);
+    testScaledRoundTrip(NIFTI_TYPE_INT32, false);//doesn't use the 8 and 16 bit fast path
+    testScaledTies();
+}
+
+void NiftiScalingTest::testScaledRoundTrip(const int16_t& type, const bool& swapEndian)
+{
+    const int64_t numValues = 1000;
+    vector<float> values(numValues);
+    for (int64_t i = 0; i < numValues; ++i)
+    {
+        values[i] = -2.0f + 5.0f * i / (numValues - 1);
+    }
+    NiftiHeader header;
+    header.setDimensions(vector<int64_t>(3, 10));
+    header.setDataTypeAndDataRange(type, -2.0, 3.0);
+    const bool testNaN = (type != NIFTI_TYPE_INT32);//NaN to other integer types is still undefined
+    if (testNaN) values[10] = NAN;
+    values[20] = 7.0f;//outside the range, should clamp
+    values[30] = -INFINITY;
+    double mult = 1.0, offset = 0.0;
+    if (!header.getDataScaling(mult, offset))
+    {
+        setFailed("integer type with a data range didn't get scaling");
+        return;
+    }
+    AString filename = QDir::temp().filePath("wb_test_niftiscaling.nii");
+    vector<float> readBack(numValues);
+    {
+        NiftiIO myIO;
+        myIO.writeNew(filename, header, 1, true, swapEndian);
+        myIO.writeData(values.data(), 3, vector<int64_t>());
+        myIO.readData(readBack.data(), 3, vector<int64_t>());
+        myIO.close();
+    }
+    QFile::remove(filename);
+    const double tolerance = mult * 0.5001;
+    for (int64_t i = 0; i < numValues; ++i)
+    {
+        double expected = values[i];
+        if (i == 10 && testNaN) expected = 0.0;//NaN is written as the closest to 0
+        if (i == 20) expected = 3.0;
+        if (i == 30) expected = -2.0;
+        if (abs(readBack[i] - expected) > tolerance)
+        {
+            setFailed("value " + AString::number(i) + " of type " + AString::number(type) + (swapEndian ? " (swapped)" : "") +
+                      " read back as " + AString::number(readBack[i]) + ", expected " + AString::number(expected));
+            return;
+        }
+    }
+}
+
+void NiftiScalingTest::testScaledTies()
+{//values exactly halfway between steps must round the same way as (in - offset) / mult in long double
+    const int64_t numValues = 1000;
+    const double mult = 0.1, offset = 0.0;
+    vector<float> values(numValues);
+    for (int64_t i = 0; i < numValues; ++i)
+    {
+        values[i] = 0.25f + 0.5f * (i - numValues / 2);//0.25, 0.75, ... are ties for a scale of 0.1
+    }
+    NiftiHeader header;
+    header.setDimensions(vector<int64_t>(3, 10));
+    header.setDataType(NIFTI_TYPE_INT16);
+    header.setDataScaling(mult, offset);
+    AString filename = QDir::temp().filePath("wb_test_niftiscalingties.nii");
+    vector<float> readBack(numValues);
+    {
+        NiftiIO myIO;
+        myIO.writeNew(filename, header, 2, true, false);//nifti-2 so the scale stays a double
+        myIO.writeData(values.data(), 3, vector<int64_t>());
+        myIO.readData(readBack.data(), 3, vector<int64_t>());
+        myIO.close();
+    }
+    QFile::remove(filename);
+    for (int64_t i = 0; i < numValues; ++i)
+    {
+        const double stored = (double)std::floor(0.5l + ((long double)values[i] - offset) / mult);
+        const float expected = (float)(offset + mult * stored);
+        if (readBack[i] != expected)
+        {
+            setFailed("tie value " + AString::number(values[i]) + " read back as " + AString::number(readBack[i]) + ", expected " + AString::number(expected));
+            return;
+        }
+    }
+}
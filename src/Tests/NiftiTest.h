@@ -44,6 +44,15 @@ public:
     void writeNifti2Header(AString filename, NiftiHeader &header);
 };
 
+class NiftiScalingTest : public TestInterface
+{
+public:
+    NiftiScalingTest(const AString& identifier);
+    virtual void execute();
+    void testScaledRoundTrip(const int16_t& type, const bool& swapEndian);
+    void testScaledTies();
+};
+
 
 }
 
@@ -0,0 +1,103 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "PaletteLookupTest.h"
+
+#include "Palette.h"
+#include "PaletteColorLookupTable.h"
+#include "PaletteFile.h"
+
+#include <cmath>
+#include <limits>
+
+using namespace caret;
+using namespace std;
+
+PaletteLookupTest::PaletteLookupTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void PaletteLookupTest::execute()
+{
+    //every default palette, with and without interpolation, must give the same colors from the table as from the palette
+    PaletteFile myFile;
+    const int32_t numPalettes = myFile.getNumberOfPalettes();
+    if (numPalettes < 1)
+    {
+        setFailed("no default palettes");
+        return;
+    }
+    const int32_t numSamples = 20001;//not a multiple of the table size, so samples land inside entries as well as on edges
+    const float tolerance = 0.0001f;
+    for (int32_t p = 0; p < numPalettes; ++p)
+    {
+        const Palette* myPalette = myFile.getPalette(p);
+        for (int interp = 0; interp < 2; ++interp)
+        {
+            const bool interpolateFlag = (interp == 1);
+            std::shared_ptr<const PaletteColorLookupTable> myTable = myPalette->getColorLookupTable(interpolateFlag);
+            if (myTable == NULL)
+            {
+                setFailed("no lookup table for palette " + myPalette->getName());
+                continue;
+            }
+            int64_t numLookedUp = 0;
+            for (int32_t i = 0; i < numSamples; ++i)
+            {
+                const float value = -1.0f + (2.0f * i) / (numSamples - 1);
+                float lutColor[4], paletteColor[4];
+                if (!myTable->getColor(value, lutColor)) continue;
+                ++numLookedUp;
+                myPalette->getPaletteColor(value, interpolateFlag, paletteColor);
+                for (int c = 0; c < 4; ++c)
+                {
+                    if (abs(lutColor[c] - paletteColor[c]) > tolerance)
+                    {
+                        setFailed("palette " + myPalette->getName() + (interpolateFlag ? " (interpolated)" : "") + " lookup color differs at "
+                                  + AString::number(value) + ": " + AString::number(lutColor[c]) + " vs " + AString::number(paletteColor[c]));
+                        break;
+                    }
+                }
+            }
+            if (numLookedUp < numSamples / 2)
+            {
+                setFailed("palette " + myPalette->getName() + " falls back to the palette for most values");
+            }
+            //values outside the table must be clamped, not converted to out of range indices
+            const float oddValues[] = { numeric_limits<float>::quiet_NaN(), numeric_limits<float>::infinity(), -numeric_limits<float>::infinity(),
+                                        1.0e30f, -1.0e30f, 1.0f, -1.0f };
+            for (int i = 0; i < (int)(sizeof(oddValues) / sizeof(oddValues[0])); ++i)
+            {
+                float lutColor[4];
+                if (myTable->getColor(oddValues[i], lutColor))
+                {
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        if (!(lutColor[c] >= 0.0f && lutColor[c] <= 1.0f))
+                        {
+                            setFailed("palette " + myPalette->getName() + " gave invalid color for out of range value " + AString::number(oddValues[i]));
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,112 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "PipelineScriptTest.h"
+
+#include "CaretException.h"
+#include "PipelineScript.h"
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    AString joinArgs(const PipelineScript::Command& command)
+    {
+        AString ret;
+        for (size_t i = 0; i < command.m_args.size(); ++i)
+        {
+            if (i != 0) ret += "|";
+            ret += command.m_args[i];
+        }
+        return ret;
+    }
+    
+    typedef PipelineScript::Access Access;
+}
+
+PipelineScriptTest::PipelineScriptTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void PipelineScriptTest::execute()
+{
+    const string script =
+        "# comment line\n"
+        "wb_command -metric-math 'x * 2' out.func.gii -var x @in\n"
+        "-cifti-label-export-table \"in \\\"1\\\".dlabel.nii\" 1 \\\n"
+        "    table.txt # trailing comment\n"
+        "\n"
+        "-volume-label-import vol.nii table.txt a\\ b.nii\n";
+    vector<PipelineScript::Command> commands = PipelineScript::tokenize(script);
+    if (commands.size() != 3)
+    {
+        setFailed("script tokenized into " + AString::number(commands.size()) + " commands, expected 3");
+    } else {
+        const AString expected[3] = { "-metric-math|x * 2|out.func.gii|-var|x|@in",
+                                      "-cifti-label-export-table|in \"1\".dlabel.nii|1|table.txt",
+                                      "-volume-label-import|vol.nii|table.txt|a b.nii" };
+        const int expectedLines[3] = { 2, 3, 6 };
+        for (int i = 0; i < 3; ++i)
+        {
+            if (joinArgs(commands[i]) != expected[i]) setFailed("command " + AString::number(i) + " tokenized as '" + joinArgs(commands[i]) + "', expected '" + expected[i] + "'");
+            if (commands[i].m_lineNumber != expectedLines[i]) setFailed("command " + AString::number(i) + " starts on line " + AString::number(commands[i].m_lineNumber) +
+                                                                        ", expected " + AString::number(expectedLines[i]));
+        }
+    }
+    bool threw = false;
+    try
+    {
+        PipelineScript::tokenize("-metric-math 'x * 2\n");
+    } catch (CaretException&) {
+        threw = true;
+    }
+    if (!threw) setFailed("unterminated quote didn't throw");
+    
+    //string parameters, with the descriptions the commands actually use
+    if (PipelineScript::stringAccessType("output - the output text file", "table.txt") != PipelineScript::WRITE) setFailed("string described as an output isn't a writer");
+    if (PipelineScript::stringAccessType("text file containing the values and names for labels", "table.txt") != PipelineScript::WRITE) setFailed("filename string isn't ordered with other uses of the file");
+    if (PipelineScript::stringAccessType("the number or name of the label map to use", "1") != PipelineScript::READ) setFailed("map number string is treated as a file write");
+    if (PipelineScript::stringAccessType("the structure", "CORTEX_LEFT") != PipelineScript::READ) setFailed("structure name string is treated as a file write");
+    if (PipelineScript::stringAccessType("the expression", "x > 0.5") != PipelineScript::READ) setFailed("expression string is treated as a file write");
+    
+    vector<vector<Access> > accesses(7);
+    //export a label table to a text file, then import it: the text file is only named by string parameters
+    accesses[0].push_back(Access("/data/in.dlabel.nii", PipelineScript::READ));
+    accesses[0].push_back(Access("/data/table.txt", PipelineScript::stringAccessType("output - the output text file", "table.txt")));
+    accesses[1].push_back(Access("/data/vol.nii", PipelineScript::READ));
+    accesses[1].push_back(Access("/data/table.txt", PipelineScript::stringAccessType("text file containing the values and names for labels", "table.txt")));
+    accesses[1].push_back(Access("/data/label.nii", PipelineScript::WRITE));
+    //independent of the above
+    accesses[2].push_back(Access("/data/in.dlabel.nii", PipelineScript::READ));
+    accesses[2].push_back(Access("@mem", PipelineScript::MEMORY));
+    //readers of an in-memory file take turns
+    accesses[3].push_back(Access("@mem", PipelineScript::MEMORY));
+    accesses[4].push_back(Access("@mem", PipelineScript::MEMORY));
+    accesses[4].push_back(Access("/data/label.nii", PipelineScript::READ));
+    //two readers of a file can run together, overwriting it waits for both
+    accesses[5].push_back(Access("/data/label.nii", PipelineScript::READ));
+    accesses[6].push_back(Access("/data/label.nii", PipelineScript::WRITE));
+    vector<int> waves = PipelineScript::computeWaves(accesses);
+    const int expectedWaves[7] = { 0, 1, 0, 1, 2, 2, 3 };
+    for (int i = 0; i < 7; ++i)
+    {
+        if (waves[i] != expectedWaves[i]) setFailed("step " + AString::number(i) + " scheduled in wave " + AString::number(waves[i]) + ", expected " + AString::number(expectedWaves[i]));
+    }
+}
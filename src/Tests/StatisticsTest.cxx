@@ -23,10 +23,28 @@
 
 #include "FastStatistics.h"
 #include "DescriptiveStatistics.h"
+#include "StatisticsBlockSource.h"
 
 using namespace caret;
 using namespace std;
 
+namespace
+{
+    class VectorBlockSource : public StatisticsBlockSource
+    {
+        const vector<float>& m_data;
+        int64_t m_blockSize;
+    public:
+        VectorBlockSource(const vector<float>& data, const int64_t& blockSize) : m_data(data), m_blockSize(blockSize) { }
+        int64_t getNumberOfBlocks() const { return ((int64_t)m_data.size() + m_blockSize - 1) / m_blockSize; }
+        void getBlock(const int64_t& blockIndex, vector<float>& dataOut) const
+        {
+            int64_t start = blockIndex * m_blockSize, end = min((int64_t)m_data.size(), start + m_blockSize);
+            dataOut.assign(m_data.begin() + start, m_data.begin() + end);
+        }
+    };
+}
+
 StatisticsTest::StatisticsTest(const AString& identifier) : TestInterface(identifier)
 {
 }
@@ -76,4 +94,23 @@ void StatisticsTest::execute()
     {
         setFailed(AString("mismatch in 90% negative percentile, full: ") + AString::number(myFullStats.getNegativePercentile(90.0f)) + ", fast: " + AString::number(myFastStats.getApproxNegativePercentile(90.0f)));
     }
+    VectorBlockSource myBlocks(myData, 100003);//blocks don't evenly divide the data
+    FastStatistics myBlockStats;
+    myBlockStats.update(myBlocks);
+    if (abs(myBlockStats.getMean() - myFastStats.getMean()) > exacttolerance || abs(myBlockStats.getSampleStdDev() - myFastStats.getSampleStdDev()) > exacttolerance)
+    {
+        setFailed(AString("mismatch in block statistics, mean: ") + AString::number(myBlockStats.getMean()) + ", stddev: " + AString::number(myBlockStats.getSampleStdDev()));
+    }
+    if (myBlockStats.getMin() != myFastStats.getMin() || myBlockStats.getMax() != myFastStats.getMax() ||
+        myBlockStats.getApproxPositivePercentile(90.0f) != myFastStats.getApproxPositivePercentile(90.0f) ||
+        myBlockStats.getApproxNegativePercentile(90.0f) != myFastStats.getApproxNegativePercentile(90.0f))
+    {
+        setFailed("mismatch in block statistics range or percentiles");
+    }
+    Histogram myHist(100, myData.data(), NUM_ELEMENTS), myBlockHist;
+    myBlockHist.update(100, myBlocks);
+    if (myHist.getHistogramCounts() != myBlockHist.getHistogramCounts())
+    {
+        setFailed("mismatch in block histogram");
+    }
 }
@@ -0,0 +1,70 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "SurfaceResamplingBench.h"
+
+#include "BenchData.h"
+#include "SurfaceFile.h"
+#include "SurfaceResamplingHelper.h"
+
+#include <random>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+SurfaceResamplingBench::SurfaceResamplingBench(const AString& identifier) : BenchInterface(identifier)
+{
+}
+
+void SurfaceResamplingBench::execute()
+{
+    SurfaceFile currentSphere, newSphere;
+    BenchData::createSphere(isQuick() ? 2562 : 40962, &currentSphere);
+    BenchData::createSphere(isQuick() ? 642 : 32492, &newSphere);
+    const int currentNodes = currentSphere.getNumberOfNodes(), newNodes = newSphere.getNumberOfNodes();
+    vector<float> currentAreas, newAreas;
+    currentSphere.computeNodeAreas(currentAreas);
+    newSphere.computeNodeAreas(newAreas);
+    measure("barycentric weights (vertices)", [&]()
+    {
+        SurfaceResamplingHelper weights(SurfaceResamplingMethodEnum::BARYCENTRIC, &currentSphere, &newSphere);
+    }, newNodes);
+    measure("adap bary area weights (vertices)", [&]()
+    {
+        SurfaceResamplingHelper weights(SurfaceResamplingMethodEnum::ADAP_BARY_AREA, &currentSphere, &newSphere, currentAreas.data(), newAreas.data());
+    }, newNodes);
+    SurfaceResamplingHelper myHelp(SurfaceResamplingMethodEnum::ADAP_BARY_AREA, &currentSphere, &newSphere, currentAreas.data(), newAreas.data());
+    const int numColumns = 100;
+    mt19937 generator(1);
+    normal_distribution<float> noise(0.0f, 1.0f);
+    vector<float> input(currentNodes * numColumns), output(newNodes * numColumns);
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        input[i] = noise(generator);
+    }
+    measure("resample columns (columns)", [&]()
+    {
+        for (int i = 0; i < numColumns; ++i)
+        {
+            myHelp.resampleNormal(input.data() + i * currentNodes, output.data() + i * newNodes);
+        }
+    }, numColumns);
+}
@@ -0,0 +1,136 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "TaskPoolTest.h"
+
+#include "CaretException.h"
+#include "CaretTaskPool.h"
+
+#include <atomic>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    const int NUM_TASKS = 1000;
+    
+    int countNotOnce(const vector<atomic<int> >& runCounts)
+    {
+        int ret = 0;
+        for (size_t i = 0; i < runCounts.size(); ++i)
+        {
+            if (runCounts[i].load() != 1) ++ret;
+        }
+        return ret;
+    }
+}
+
+TaskPoolTest::TaskPoolTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void TaskPoolTest::execute()
+{
+    if (CaretTaskPool::getNumThreads() < 1) setFailed("task pool has no threads");
+    
+    //every task runs exactly once, and reusing the group after wait() runs only the new tasks
+    {
+        vector<atomic<int> > runCounts(NUM_TASKS);
+        for (int i = 0; i < NUM_TASKS; ++i) runCounts[i] = 0;
+        CaretTaskGroup myGroup(NUM_TASKS);
+        for (int i = 0; i < NUM_TASKS; ++i)
+        {
+            myGroup.run([&runCounts, i]() { ++runCounts[i]; });
+        }
+        myGroup.wait();
+        int bad = countNotOnce(runCounts);
+        if (bad != 0) setFailed(AString::number(bad) + " tasks didn't run exactly once");
+        for (int i = 0; i < NUM_TASKS; ++i) runCounts[i] = 0;
+        for (int i = 0; i < NUM_TASKS; ++i)
+        {
+            myGroup.run([&runCounts, i]() { ++runCounts[i]; });
+        }
+        myGroup.wait();
+        bad = countNotOnce(runCounts);
+        if (bad != 0) setFailed(AString::number(bad) + " tasks didn't run exactly once when reusing a group");
+    }
+    
+    //tasks that wait on nested groups, with more outer tasks than threads so every thread ends up waiting inside a task
+    {
+        const int numOuter = 4 * CaretTaskPool::getNumThreads() + 3, numInner = 50;
+        vector<atomic<int> > runCounts(numOuter * numInner);
+        for (size_t i = 0; i < runCounts.size(); ++i) runCounts[i] = 0;
+        CaretTaskGroup outerGroup(numOuter);
+        for (int i = 0; i < numOuter; ++i)
+        {
+            outerGroup.run([&runCounts, i, numInner]()
+            {
+                CaretTaskGroup innerGroup(numInner);
+                for (int j = 0; j < numInner; ++j)
+                {
+                    innerGroup.run([&runCounts, i, j, numInner]()
+                    {
+                        CaretTaskGroup leafGroup;//waiting on a group with a single task, from inside a nested task
+                        leafGroup.run([&runCounts, i, j, numInner]() { ++runCounts[i * numInner + j]; });
+                        leafGroup.wait();
+                    });
+                }
+                innerGroup.wait();
+            });
+        }
+        outerGroup.wait();
+        const int bad = countNotOnce(runCounts);
+        if (bad != 0) setFailed(AString::number(bad) + " nested tasks didn't run exactly once");
+    }
+    
+    //an exception from a task is rethrown by wait(), after the other tasks finish, and doesn't stay with the group
+    {
+        vector<atomic<int> > runCounts(NUM_TASKS);
+        for (int i = 0; i < NUM_TASKS; ++i) runCounts[i] = 0;
+        CaretTaskGroup myGroup(NUM_TASKS);
+        for (int i = 0; i < NUM_TASKS; ++i)
+        {
+            myGroup.run([&runCounts, i]()
+            {
+                ++runCounts[i];
+                if (i == NUM_TASKS / 2) throw CaretException("task failed");
+            });
+        }
+        bool caught = false;
+        try
+        {
+            myGroup.wait();
+        } catch (CaretException& e) {
+            caught = true;
+            if (e.whatString() != "task failed") setFailed("wait() rethrew the wrong exception: " + e.whatString());
+        }
+        if (!caught) setFailed("wait() didn't rethrow the exception from a task");
+        const int bad = countNotOnce(runCounts);
+        if (bad != 0) setFailed(AString::number(bad) + " tasks didn't run exactly once when one threw");
+        myGroup.run([]() { });
+        try
+        {
+            myGroup.wait();
+        } catch (CaretException&) {
+            setFailed("exception from a task was rethrown again after reusing the group");
+        }
+    }
+}
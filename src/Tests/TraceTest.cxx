@@ -0,0 +1,112 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+#include "TraceTest.h"
+
+#include "CaretTrace.h"
+
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <set>
+
+using namespace caret;
+using namespace std;
+
+TraceTest::TraceTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void TraceTest::execute()
+{
+    {
+        CaretTraceSpan notRecorded("test", "before start");
+    }
+    const AString fileName = QDir::temp().filePath("wb_trace_test.json");
+    CaretTrace::start(fileName);
+    {
+        CaretTraceSpan outer("test", "outer");
+        {
+            CaretTraceSpan inner("test", AString("inner \"quoted\""));
+            inner.setDetail("back\\slash");
+            inner.setBytes(4096);
+            CaretTrace::addBytesRead(4096);
+        }
+        CaretTraceSpan tooShort("test", "too short", 60000000);//a minute, so it is never recorded
+    }
+    if (!CaretTrace::finish())
+    {
+        setFailed("unable to write trace file");
+        return;
+    }
+    {
+        CaretTraceSpan notRecorded("test", "after finish");
+    }
+    QFile traceFile(fileName);
+    if (!traceFile.open(QIODevice::ReadOnly))
+    {
+        setFailed("trace file wasn't created");
+        return;
+    }
+    QJsonParseError parseError;
+    QJsonDocument myDoc = QJsonDocument::fromJson(traceFile.readAll(), &parseError);
+    traceFile.close();
+    QFile::remove(fileName);
+    if (myDoc.isNull())
+    {
+        setFailed("trace file is not valid JSON: " + parseError.errorString());
+        return;
+    }
+    QJsonArray events = myDoc.object()["traceEvents"].toArray();
+    set<AString> spanNames;
+    double innerStart = -1.0, innerEnd = -1.0, outerStart = -1.0, outerEnd = -1.0;
+    bool sawReadCounter = false;
+    for (int i = 0; i < events.size(); ++i)
+    {
+        QJsonObject event = events[i].toObject();
+        const AString phase = event["ph"].toString(), name = event["name"].toString();
+        if (phase == "X")
+        {
+            spanNames.insert(name);
+            const double start = event["ts"].toDouble(), end = start + event["dur"].toDouble();
+            if (name == "outer")
+            {
+                outerStart = start;
+                outerEnd = end;
+            } else if (name == "inner \"quoted\"") {
+                innerStart = start;
+                innerEnd = end;
+                QJsonObject args = event["args"].toObject();
+                if (args["detail"].toString() != "back\\slash") setFailed("span detail was not preserved");
+                if (args["bytes"].toDouble() != 4096) setFailed("span bytes were not preserved");
+            }
+        } else if (phase == "C" && name == "io") {
+            if (event["args"].toObject()["read MB"].toDouble() > 0.0) sawReadCounter = true;
+        }
+    }
+    if (spanNames.size() != 2 || spanNames.count("outer") != 1 || spanNames.count("inner \"quoted\"") != 1)
+    {
+        setFailed("trace has " + AString::number(spanNames.size()) + " distinct spans, expected only outer and inner");
+    }
+    if (innerStart < outerStart || innerEnd > outerEnd) setFailed("inner span is not inside outer span");
+    if (!sawReadCounter) setFailed("bytes read counter is missing");
+}
@@ -0,0 +1,249 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "TriangleLocatorTest.h"
+
+#include "CaretTriangleLocator.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <utility>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+namespace
+{
+    //unit sphere from a subdivided icosahedron
+    void makeIcosphere(const int subdivisions, vector<float>& coordsOut, vector<int32_t>& trianglesOut)
+    {
+        const float phi = (1.0f + sqrt(5.0f)) / 2.0f;
+        const float baseCoords[12][3] = { { -1, phi, 0 }, { 1, phi, 0 }, { -1, -phi, 0 }, { 1, -phi, 0 },
+                                          { 0, -1, phi }, { 0, 1, phi }, { 0, -1, -phi }, { 0, 1, -phi },
+                                          { phi, 0, -1 }, { phi, 0, 1 }, { -phi, 0, -1 }, { -phi, 0, 1 } };
+        const int32_t baseTriangles[20][3] = { { 0, 11, 5 }, { 0, 5, 1 }, { 0, 1, 7 }, { 0, 7, 10 }, { 0, 10, 11 },
+                                               { 1, 5, 9 }, { 5, 11, 4 }, { 11, 10, 2 }, { 10, 7, 6 }, { 7, 1, 8 },
+                                               { 3, 9, 4 }, { 3, 4, 2 }, { 3, 2, 6 }, { 3, 6, 8 }, { 3, 8, 9 },
+                                               { 4, 9, 5 }, { 2, 4, 11 }, { 6, 2, 10 }, { 8, 6, 7 }, { 9, 8, 1 } };
+        coordsOut.clear();
+        trianglesOut.clear();
+        for (int i = 0; i < 12; ++i)
+        {
+            const float norm = sqrt(baseCoords[i][0] * baseCoords[i][0] + baseCoords[i][1] * baseCoords[i][1] + baseCoords[i][2] * baseCoords[i][2]);
+            for (int j = 0; j < 3; ++j) coordsOut.push_back(baseCoords[i][j] / norm);
+        }
+        for (int i = 0; i < 20; ++i)
+        {
+            for (int j = 0; j < 3; ++j) trianglesOut.push_back(baseTriangles[i][j]);
+        }
+        for (int s = 0; s < subdivisions; ++s)
+        {
+            map<pair<int32_t, int32_t>, int32_t> midpoints;
+            vector<int32_t> newTriangles;
+            for (size_t t = 0; t < trianglesOut.size(); t += 3)
+            {
+                int32_t mid[3];
+                for (int e = 0; e < 3; ++e)
+                {
+                    const int32_t a = trianglesOut[t + e], b = trianglesOut[t + (e + 1) % 3];
+                    const pair<int32_t, int32_t> key(min(a, b), max(a, b));
+                    map<pair<int32_t, int32_t>, int32_t>::iterator iter = midpoints.find(key);
+                    if (iter != midpoints.end())
+                    {
+                        mid[e] = iter->second;
+                        continue;
+                    }
+                    float point[3];
+                    for (int j = 0; j < 3; ++j) point[j] = (coordsOut[a * 3 + j] + coordsOut[b * 3 + j]) / 2.0f;
+                    const float norm = sqrt(point[0] * point[0] + point[1] * point[1] + point[2] * point[2]);
+                    mid[e] = (int32_t)(coordsOut.size() / 3);
+                    for (int j = 0; j < 3; ++j) coordsOut.push_back(point[j] / norm);
+                    midpoints[key] = mid[e];
+                }
+                const int32_t v0 = trianglesOut[t], v1 = trianglesOut[t + 1], v2 = trianglesOut[t + 2];
+                const int32_t subTris[4][3] = { { v0, mid[0], mid[2] }, { v1, mid[1], mid[0] }, { v2, mid[2], mid[1] }, { mid[0], mid[1], mid[2] } };
+                for (int k = 0; k < 4; ++k)
+                {
+                    for (int j = 0; j < 3; ++j) newTriangles.push_back(subTris[k][j]);
+                }
+            }
+            trianglesOut.swap(newTriangles);
+        }
+    }
+    
+    //two-sided Moller-Trumbore against every triangle, returns the closest distance >= 0, or -1 if nothing is hit
+    double bruteForceClosest(const vector<float>& coords, const vector<int32_t>& triangles, const float start[3], const float direction[3], vector<double>& hitDistancesOut)
+    {
+        const int64_t numTriangles = (int64_t)(triangles.size() / 3);
+        hitDistancesOut.assign(numTriangles, -1.0);
+        double best = -1.0;
+        for (int64_t t = 0; t < numTriangles; ++t)
+        {
+            const float* v0 = coords.data() + triangles[t * 3] * 3;
+            const float* v1 = coords.data() + triangles[t * 3 + 1] * 3;
+            const float* v2 = coords.data() + triangles[t * 3 + 2] * 3;
+            double e1[3], e2[3], tvec[3];
+            for (int j = 0; j < 3; ++j)
+            {
+                e1[j] = (double)v1[j] - v0[j];
+                e2[j] = (double)v2[j] - v0[j];
+                tvec[j] = (double)start[j] - v0[j];
+            }
+            const double pvec[3] = { direction[1] * e2[2] - direction[2] * e2[1], direction[2] * e2[0] - direction[0] * e2[2], direction[0] * e2[1] - direction[1] * e2[0] };
+            const double det = e1[0] * pvec[0] + e1[1] * pvec[1] + e1[2] * pvec[2];
+            if (det == 0.0) continue;
+            const double u = (tvec[0] * pvec[0] + tvec[1] * pvec[1] + tvec[2] * pvec[2]) / det;
+            if (u < 0.0 || u > 1.0) continue;
+            const double qvec[3] = { tvec[1] * e1[2] - tvec[2] * e1[1], tvec[2] * e1[0] - tvec[0] * e1[2], tvec[0] * e1[1] - tvec[1] * e1[0] };
+            const double v = (direction[0] * qvec[0] + direction[1] * qvec[1] + direction[2] * qvec[2]) / det;
+            if (v < 0.0 || u + v > 1.0) continue;
+            const double dist = (e2[0] * qvec[0] + e2[1] * qvec[1] + e2[2] * qvec[2]) / det;
+            if (dist < 0.0) continue;
+            hitDistancesOut[t] = dist;
+            if (best < 0.0 || dist < best) best = dist;
+        }
+        return best;
+    }
+}
+
+TriangleLocatorTest::TriangleLocatorTest(const AString& identifier) : TestInterface(identifier)
+{
+}
+
+void TriangleLocatorTest::execute()
+{
+    vector<float> coords;
+    vector<int32_t> triangles;
+    makeIcosphere(3, coords, triangles);//1280 triangles, enough for several levels of the tree
+    const int64_t numTriangles = (int64_t)(triangles.size() / 3);
+    CaretTriangleLocator myLocator(coords.data(), (int64_t)(coords.size() / 3), triangles.data(), numTriangles);
+    if (myLocator.getNumberOfTriangles() != numTriangles)
+    {
+        setFailed("locator has wrong number of triangles");
+        return;
+    }
+    vector<pair<vector<float>, vector<float> > > rays;//start, direction
+    for (int i = 0; i < 300; ++i)
+    {//random rays from outside aimed near the center, some of them pass beside the sphere
+        vector<float> start(3), target(3), direction(3);
+        for (int j = 0; j < 3; ++j)
+        {
+            start[j] = 4.0f * (rand() / (float)RAND_MAX - 0.5f) * 2.0f;
+            target[j] = 1.5f * (rand() / (float)RAND_MAX - 0.5f) * 2.0f;
+            direction[j] = target[j] - start[j];
+        }
+        rays.push_back(make_pair(start, direction));
+    }
+    for (int i = 0; i < 50; ++i)
+    {//rays from inside, the triangles are hit from behind
+        vector<float> start(3), direction(3);
+        for (int j = 0; j < 3; ++j)
+        {
+            start[j] = 0.5f * (rand() / (float)RAND_MAX - 0.5f);
+            direction[j] = rand() / (float)RAND_MAX - 0.5f;
+        }
+        rays.push_back(make_pair(start, direction));
+    }
+    for (int64_t t = 0; t < numTriangles; t += 7)
+    {//rays through edge midpoints and vertices, which are shared by several triangles
+        const float* v0 = coords.data() + triangles[t * 3] * 3;
+        const float* v1 = coords.data() + triangles[t * 3 + 1] * 3;
+        vector<float> edgeTarget(3), start(3), direction(3);
+        for (int j = 0; j < 3; ++j) edgeTarget[j] = (v0[j] + v1[j]) / 2.0f;
+        for (int j = 0; j < 3; ++j)
+        {
+            start[j] = edgeTarget[j] * 3.0f;
+            direction[j] = edgeTarget[j] - start[j];
+        }
+        rays.push_back(make_pair(start, direction));
+        for (int j = 0; j < 3; ++j)
+        {
+            start[j] = v0[j] * 3.0f;
+            direction[j] = v0[j] - start[j];
+        }
+        rays.push_back(make_pair(start, direction));
+    }
+    const float axisStarts[6][3] = { { 5, 0, 0 }, { -5, 0, 0 }, { 0, 5, 0 }, { 0, -5, 0 }, { 0, 0, 5 }, { 0, 0, -5 } };
+    for (int i = 0; i < 6; ++i)
+    {//axis-aligned, so some inverse direction components are infinite
+        vector<float> start(axisStarts[i], axisStarts[i] + 3), direction(3);
+        for (int j = 0; j < 3; ++j) direction[j] = -start[j];
+        rays.push_back(make_pair(start, direction));
+    }
+    {//rays that miss: pointing away, and passing beside the sphere
+        const float missRays[3][6] = { { 2, 0, 0, 1, 0, 0 }, { 0, 3, 0, 0, 1, 1 }, { 1.1f, 1.1f, -5, 0, 0, 1 } };
+        for (int i = 0; i < 3; ++i)
+        {
+            rays.push_back(make_pair(vector<float>(missRays[i], missRays[i] + 3), vector<float>(missRays[i] + 3, missRays[i] + 6)));
+        }
+    }
+    int numHits = 0;
+    vector<double> hitDistances;
+    for (size_t r = 0; r < rays.size(); ++r)
+    {
+        const float* start = rays[r].first.data();
+        const float* direction = rays[r].second.data();
+        const double expected = bruteForceClosest(coords, triangles, start, direction, hitDistances);
+        TriangleRayHit myHit;
+        const bool found = myLocator.closestRayIntersection(start, direction, myHit);
+        const AString rayString = "ray " + AString::number((int64_t)r) + " (" + AString::number(start[0]) + ", " + AString::number(start[1]) + ", " + AString::number(start[2]) + ")";
+        if (found != (expected >= 0.0))
+        {
+            setFailed(rayString + (found ? " hit a triangle, but brute force found none" : " missed, but brute force found a hit"));
+            continue;
+        }
+        if (!found) continue;
+        ++numHits;
+        if (myHit.triangle < 0 || myHit.triangle >= numTriangles)
+        {
+            setFailed(rayString + " returned invalid triangle " + AString::number(myHit.triangle));
+            continue;
+        }
+        if (abs(myHit.distance - expected) > 1e-5 * (1.0 + expected))
+        {
+            setFailed(rayString + " hit at distance " + AString::number(myHit.distance) + ", brute force closest is " + AString::number(expected));
+        }
+        const double triDist = hitDistances[myHit.triangle];//on edges and vertices, any of the triangles at the closest distance is correct
+        if (triDist < 0.0 || abs(triDist - expected) > 1e-5 * (1.0 + expected))
+        {
+            setFailed(rayString + " returned triangle " + AString::number(myHit.triangle) + ", which is not at the closest distance");
+        }
+        for (int j = 0; j < 3; ++j)
+        {
+            if (abs(myHit.xyz[j] - (start[j] + myHit.distance * direction[j])) > 1e-4f)
+            {
+                setFailed(rayString + " hit point is not on the ray");
+                break;
+            }
+        }
+    }
+    if (numHits < (int)rays.size() / 2)
+    {
+        setFailed("too few rays hit the sphere, the test rays are wrong");
+    }
+    {//maxDist must exclude farther hits
+        const float start[3] = { 0, 0, 5 }, direction[3] = { 0, 0, -1 };
+        TriangleRayHit myHit;
+        if (myLocator.closestRayIntersection(start, direction, myHit, 3.0f)) setFailed("hit found beyond maxDist");
+        if (!myLocator.closestRayIntersection(start, direction, myHit, 4.5f)) setFailed("hit not found within maxDist");
+    }
+}
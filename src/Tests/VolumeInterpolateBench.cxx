@@ -0,0 +1,62 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+#include "VolumeInterpolateBench.h"
+
+#include "BenchData.h"
+#include "VolumeFile.h"
+
+#include <random>
+#include <vector>
+
+using namespace caret;
+using namespace std;
+
+VolumeInterpolateBench::VolumeInterpolateBench(const AString& identifier) : BenchInterface(identifier)
+{
+}
+
+void VolumeInterpolateBench::execute()
+{
+    const int64_t dimension = (isQuick() ? 32 : 128);
+    const int numPoints = (isQuick() ? 10000 : 1000000);
+    VolumeFile myVol;
+    BenchData::createVolume(dimension, 1, &myVol);
+    mt19937 generator(1);
+    uniform_real_distribution<float> dist(-(float)dimension + 2.0f, (float)dimension - 2.0f);//inside the volume, away from the edges
+    vector<float> coords(numPoints * 3), values(numPoints);
+    for (size_t i = 0; i < coords.size(); ++i)
+    {
+        coords[i] = dist(generator);
+    }
+    const VolumeFile::InterpType methods[3] = { VolumeFile::ENCLOSING_VOXEL, VolumeFile::TRILINEAR, VolumeFile::CUBIC };
+    const char* names[3] = { "enclosing voxel (points)", "trilinear (points)", "cubic (points)" };
+    for (int m = 0; m < 3; ++m)
+    {
+        const VolumeFile::InterpType method = methods[m];
+        measure(names[m], [&]()
+        {
+            for (int i = 0; i < numPoints; ++i)
+            {
+                values[i] = myVol.interpolateValue(coords.data() + i * 3, method);
+            }
+        }, numPoints);
+    }
+}
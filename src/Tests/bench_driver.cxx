@@ -0,0 +1,268 @@
+/*LICENSE_START*/
+/*
+ *  Copyright (C) 2026  Washington University School of Medicine
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+/*LICENSE_END*/
+
+//program for running benchmarks on synthetic data, optionally saving or comparing against a baseline
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+
+#include "BenchInterface.h"
+#include "CaretCommandLine.h"
+#include "CaretException.h"
+#include "CaretHttpManager.h"
+#include "CaretOMP.h"
+#include "SessionManager.h"
+
+//benchmarks
+#include "CiftiFileBench.h"
+#include "DotBench.h"
+#include "GeodesicHelperBench.h"
+#include "MathExpressionBench.h"
+#include "SurfaceResamplingBench.h"
+#include "VolumeInterpolateBench.h"
+
+using namespace std;
+using namespace caret;
+
+namespace
+{
+    void freeBenchList(vector<BenchInterface*>& mylist)
+    {
+        for (int i = 0; i < (int)mylist.size(); ++i)
+        {
+            delete mylist[i];
+        }
+    }
+    
+    void printUsage(const vector<BenchInterface*>& mybenches)
+    {
+        cout << "usage: bench_driver [-quick] [-json <output.json>] [-compare <baseline.json> [-tolerance <fraction>]] <benchmark>..." << endl;
+        cout << "   -quick: small inputs and short timing, for checking that benchmarks still run" << endl;
+        cout << "   -json: write the results to a file, which can later be used as a baseline" << endl;
+        cout << "   -compare: compare median times against a saved baseline, fail if any kernel is slower" << endl;
+        cout << "   -tolerance: fractional slowdown allowed before failing, default 0.1" << endl;
+        cout << "benchmarks (or 'all'):" << endl;
+        for (int i = 0; i < (int)mybenches.size(); ++i)
+        {
+            cout << "   " << mybenches[i]->getIdentifier() << endl;
+        }
+    }
+    
+    AString resultKey(const AString& benchmark, const AString& kernel)
+    {
+        return benchmark + "/" + kernel;
+    }
+    
+    QJsonObject resultsToJson(const vector<BenchResult>& results, const bool quick)
+    {
+        QJsonObject ret;
+        ret["format"] = "wb_bench";
+        ret["version"] = 1;
+        ret["date"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+        ret["host"] = QSysInfo::machineHostName();
+        ret["os"] = QSysInfo::prettyProductName();
+        ret["cpu_arch"] = QSysInfo::currentCpuArchitecture();
+        int threads = 1;
+#ifdef CARET_OMP
+        threads = omp_get_max_threads();
+#endif
+        ret["threads"] = threads;
+        ret["quick"] = quick;
+        QJsonArray resultArray;
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            QJsonObject thisResult;
+            thisResult["benchmark"] = results[i].m_benchmark;
+            thisResult["kernel"] = results[i].m_kernel;
+            thisResult["median_ms"] = results[i].m_medianMs;
+            thisResult["min_ms"] = results[i].m_minMs;
+            thisResult["repetitions"] = results[i].m_repetitions;
+            thisResult["items_per_second"] = results[i].m_itemsPerSecond;
+            resultArray.append(thisResult);
+        }
+        ret["results"] = resultArray;
+        return ret;
+    }
+    
+    QJsonObject readJson(const AString& fileName)
+    {
+        QFile myFile(fileName);
+        if (!myFile.open(QIODevice::ReadOnly)) throw CaretException("failed to open baseline file '" + fileName + "'");
+        QJsonParseError parseError;
+        QJsonDocument myDoc = QJsonDocument::fromJson(myFile.readAll(), &parseError);
+        if (myDoc.isNull() || !myDoc.isObject()) throw CaretException("failed to parse baseline file '" + fileName + "': " + parseError.errorString());
+        QJsonObject ret = myDoc.object();
+        if (ret["format"].toString() != "wb_bench") throw CaretException("file '" + fileName + "' is not a bench_driver results file");
+        return ret;
+    }
+    
+    void writeJson(const AString& fileName, const QJsonObject& toWrite)
+    {
+        QFile myFile(fileName);
+        if (!myFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) throw CaretException("failed to open output file '" + fileName + "'");
+        myFile.write(QJsonDocument(toWrite).toJson());
+    }
+    
+    //returns number of kernels slower than the baseline by more than the tolerance
+    int compareToBaseline(const vector<BenchResult>& results, const QJsonObject& baseline, const double tolerance, const bool quick)
+    {
+        if (baseline["quick"].toBool() != quick)
+        {
+            cout << "warning: baseline was " << (quick ? "not " : "") << "run with -quick, sizes will differ" << endl;
+        }
+        map<AString, double> baseMedians;
+        QJsonArray baseResults = baseline["results"].toArray();
+        for (int i = 0; i < baseResults.size(); ++i)
+        {
+            QJsonObject thisResult = baseResults[i].toObject();
+            baseMedians[resultKey(thisResult["benchmark"].toString(), thisResult["kernel"].toString())] = thisResult["median_ms"].toDouble();
+        }
+        int slowerCount = 0;
+        cout << endl << "comparison to baseline from " << baseline["date"].toString().toStdString() << " (tolerance " << tolerance * 100.0 << "%):" << endl;
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const AString key = resultKey(results[i].m_benchmark, results[i].m_kernel);
+            cout << setw(44) << left << key.toStdString() << right;
+            map<AString, double>::const_iterator iter = baseMedians.find(key);
+            if (iter == baseMedians.end() || iter->second <= 0.0)
+            {
+                cout << "  not in baseline" << endl;
+                continue;
+            }
+            const double ratio = results[i].m_medianMs / iter->second;
+            cout << fixed << setprecision(3) << setw(12) << iter->second << " ms -> " << setw(12) << results[i].m_medianMs << " ms  x" << setprecision(2) << ratio;
+            cout.unsetf(ios::floatfield);
+            if (ratio > 1.0 + tolerance)
+            {
+                ++slowerCount;
+                cout << "  SLOWER";
+            } else if (ratio < 1.0 / (1.0 + tolerance)) {
+                cout << "  faster";
+            }
+            cout << endl;
+        }
+        return slowerCount;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int ret = 0;
+    {
+        QCoreApplication myApp(argc, argv);
+        caret_global_commandLine_init(argc, argv);
+        SessionManager::createSessionManager(ApplicationTypeEnum::APPLICATION_TYPE_COMMAND_LINE);
+        vector<BenchInterface*> mybenches;
+        mybenches.push_back(new CiftiFileBench("ciftifile"));
+        mybenches.push_back(new DotBench("dotsimd"));
+        mybenches.push_back(new GeodesicHelperBench("geohelp"));
+        mybenches.push_back(new MathExpressionBench("mathexpression"));
+        mybenches.push_back(new SurfaceResamplingBench("resample"));
+        mybenches.push_back(new VolumeInterpolateBench("volumeinterp"));
+        bool quick = false;
+        AString jsonOut, baselineName;
+        double tolerance = 0.1;
+        vector<AString> selected;
+        for (int i = 1; i < argc; ++i)
+        {
+            AString thisArg(argv[i]);
+            bool ok = true;
+            if (thisArg == "-quick")
+            {
+                quick = true;
+            } else if (thisArg == "-json" && i + 1 < argc) {
+                jsonOut = argv[++i];
+            } else if (thisArg == "-compare" && i + 1 < argc) {
+                baselineName = argv[++i];
+            } else if (thisArg == "-tolerance" && i + 1 < argc) {
+                tolerance = AString(argv[++i]).toDouble(&ok);
+                if (tolerance < 0.0) ok = false;
+            } else if (thisArg.startsWith("-")) {
+                ok = false;
+            } else {
+                selected.push_back(thisArg);
+            }
+            if (!ok)
+            {
+                cout << "invalid argument: " << thisArg << endl;
+                selected.clear();
+                break;
+            }
+        }
+        if (selected.empty())
+        {
+            printUsage(mybenches);
+            freeBenchList(mybenches);
+            return 1;
+        }
+        try
+        {
+            QJsonObject baseline;
+            if (!baselineName.isEmpty()) baseline = readJson(baselineName);//check it before spending time on benchmarks
+            vector<BenchResult> results;
+            for (size_t i = 0; i < selected.size(); ++i)
+            {
+                bool found = false;
+                for (int j = 0; j < (int)mybenches.size(); ++j)
+                {
+                    if (mybenches[j]->getIdentifier() == selected[i] || "all" == selected[i])
+                    {
+                        found = true;
+                        mybenches[j]->setQuick(quick);
+                        const size_t previous = mybenches[j]->getResults().size();//in case a benchmark was named twice
+                        mybenches[j]->execute();
+                        const vector<BenchResult>& benchResults = mybenches[j]->getResults();
+                        results.insert(results.end(), benchResults.begin() + previous, benchResults.end());
+                    }
+                }
+                if (!found) throw CaretException("unknown benchmark '" + selected[i] + "'");
+            }
+            if (!jsonOut.isEmpty()) writeJson(jsonOut, resultsToJson(results, quick));
+            if (!baselineName.isEmpty())
+            {
+                int slowerCount = compareToBaseline(results, baseline, tolerance, quick);
+                if (slowerCount != 0)
+                {
+                    cout << "Total of " << slowerCount << " kernels slower than baseline!" << endl;
+                    ret = 1;
+                }
+            }
+        } catch (CaretException& e) {
+            cout << "Benchmark failed, exception: " << e.whatString() << endl;
+            ret = 1;
+        }
+        freeBenchList(mybenches);
+        SessionManager::deleteSessionManager();
+        CaretHttpManager::deleteHttpManager();
+        myApp.processEvents();
+    }
+    return ret;
+}
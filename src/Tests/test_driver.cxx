@@ -34,19 +34,28 @@
 
 //tests
 #include "CiftiFileTest.h"
+#include "CiftiXMLTest.h"
+#include "ConnectedComponentsTest.h"
 #include "DotTest.h"
 #include "GeodesicHelperTest.h"
+#include "GiftiReadTest.h"
 #include "HttpTest.h"
 #include "HeapTest.h"
 #include "LookupTest.h"
+#include "LruCacheTest.h"
 #include "MathExpressionTest.h"
 #include "NiftiTest.h"
+#include "PaletteLookupTest.h"
+#include "PipelineScriptTest.h"
 #include "PointerTest.h"
 #include "ProgressTest.h"
 #include "QuatTest.h"
 #include "StatisticsTest.h"
+#include "TaskPoolTest.h"
 #include "TimerTest.h"
 #include "TopologyHelperTest.h"
+#include "TraceTest.h"
+#include "TriangleLocatorTest.h"
 #include "VolumeFileTest.h"
 #include "XnatTest.h"
 
@@ -70,20 +79,30 @@ int main(int argc, char** argv)
         SessionManager::createSessionManager(ApplicationTypeEnum::APPLICATION_TYPE_COMMAND_LINE);
         vector<TestInterface*> mytests;
         mytests.push_back(new CiftiFileTest("ciftifile"));
+        mytests.push_back(new CiftiXMLTest("ciftixml"));
+        mytests.push_back(new ConnectedComponentsTest("connectedcomponents"));
         mytests.push_back(new DotTest("dotsimd"));
         mytests.push_back(new GeodesicHelperTest("geohelp"));
+        mytests.push_back(new GiftiReadTest("giftiread"));
         mytests.push_back(new HeapTest("heap"));
         mytests.push_back(new HttpTest("http"));
         mytests.push_back(new LookupTest("lookup"));
+        mytests.push_back(new LruCacheTest("lrucache"));
         mytests.push_back(new MathExpressionTest("mathexpression"));
         mytests.push_back(new NiftiFileTest("niftifile"));
         mytests.push_back(new NiftiHeaderTest("niftiheader"));
+        mytests.push_back(new NiftiScalingTest("niftiscaling"));
+        mytests.push_back(new PaletteLookupTest("palettelookup"));
+        mytests.push_back(new PipelineScriptTest("pipelinescript"));
         mytests.push_back(new PointerTest("pointer"));
         mytests.push_back(new ProgressTest("progress"));
         mytests.push_back(new QuatTest("quaternion"));
         mytests.push_back(new StatisticsTest("statistics"));
+        mytests.push_back(new TaskPoolTest("taskpool"));
         mytests.push_back(new TimerTest("timer"));
         mytests.push_back(new TopologyHelperTest("topohelp"));
+        mytests.push_back(new TraceTest("trace"));
+        mytests.push_back(new TriangleLocatorTest("trianglelocator"));
         mytests.push_back(new VolumeFileTest("volumefile"));
         mytests.push_back(new XnatTest("xnat"));
         if (argc < 2)
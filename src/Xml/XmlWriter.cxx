@@ -296,6 +296,31 @@ XmlWriter::writeElementNoSpace(const AString& localName, const AString& text) {
    this->writeTextToOutputStream("</" + localName + ">\n");
 }
 
+/**
+ * Write an element with no spacing between start and end tags, where
+ * the text is plain ASCII that needs no escaping (such as base64).  The
+ * text is written as is, without conversion to a string.
+ *
+ * @param localName - local name of tag to write.
+ * @param text - text to write.
+ * @param length - number of characters of text.
+ * @throws XmlAttributes if an I/O error occurs.
+ */
+void
+XmlWriter::writeElementNoSpace(const AString& localName, const char* text, const int64_t length) {
+   this->writeIndentation();
+   this->writeTextToOutputStream("<" + localName + ">");
+   switch (this->outputStreamType) {
+       case OUTPUT_STREAM_Q_TEXT_STREAM:
+           *qTextStreamWriter << QLatin1String(text, length);
+           break;
+       case OUTPUT_STREAM_STD_OUTPUT_STREAM:
+           stdOutputStreamWriter->write(text, length);
+           break;
+   }
+   this->writeTextToOutputStream("</" + localName + ">\n");
+}
+
 /**
  * Writes a start tag to the output.
  *